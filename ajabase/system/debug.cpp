@@ -1450,6 +1450,8 @@ static void InitStatKeyNames (void)
 	gStatKeyToStr[AJA_DebugStat_HEVCSendMessage]			= "HEVCMsg";
 	gStatKeyToStr[AJA_DebugStat_ACXferRPCEncode]			= "ACXferRPCEnc";
 	gStatKeyToStr[AJA_DebugStat_ACXferRPCDecode]			= "ACXferRPCDec";
+	gStatKeyToStr[AJA_DebugStat_RegCacheHit]				= "RegCacheHit";
+	gStatKeyToStr[AJA_DebugStat_RegCacheMiss]				= "RegCacheMiss";
 	gStatKeyToStrReady = true;
 	assert(gStatKeyToStr.size() == size_t(AJA_DebugStat_NUM_STATS));	//	Be sure all are here
 }
@@ -247,6 +247,8 @@ typedef enum _AJADebugStats
 	AJA_DebugStat_HEVCSendMessage,
 	AJA_DebugStat_ACXferRPCEncode,
 	AJA_DebugStat_ACXferRPCDecode,
+	AJA_DebugStat_RegCacheHit,
+	AJA_DebugStat_RegCacheMiss,
 	AJA_DebugStat_NUM_STATS
 } AJADebugStats;
 ///@}
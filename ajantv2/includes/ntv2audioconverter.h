@@ -0,0 +1,233 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2audioconverter.h
+	@brief		Declares the NTV2AudioConverter and NTV2AudioChannelMatrix classes.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2AUDIOCONVERTER_H
+#define NTV2AUDIOCONVERTER_H
+
+#include "ajaexport.h"
+#include "ntv2publicinterface.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/**
+	@brief	Identifies a host audio sample format.
+**/
+typedef enum
+{
+	NTV2_AUDIO_SAMPLE_FORMAT_S32,		///< @brief	Signed 24-bit samples left-justified in 32-bit words (the device's native format)
+	NTV2_AUDIO_SAMPLE_FORMAT_S24,		///< @brief	Signed 24-bit samples packed into 3 bytes (little-endian)
+	NTV2_AUDIO_SAMPLE_FORMAT_S16,		///< @brief	Signed 16-bit samples (native-endian)
+	NTV2_AUDIO_SAMPLE_FORMAT_F32,		///< @brief	32-bit float samples, nominally in the range [-1.0, +1.0)
+	NTV2_AUDIO_SAMPLE_FORMAT_INVALID
+} NTV2AudioSampleFormat;
+
+#define NTV2_IS_VALID_AUDIO_SAMPLE_FORMAT(__f__)	((__f__) >= NTV2_AUDIO_SAMPLE_FORMAT_S32 && (__f__) < NTV2_AUDIO_SAMPLE_FORMAT_INVALID)
+
+AJAExport std::string NTV2AudioSampleFormatToString (const NTV2AudioSampleFormat inFormat, const bool inCompactDisplay = false);
+
+
+/**
+	@brief	A matrix of gains that routes and/or mixes a number of input audio channels into a number of output audio
+			channels. Each output channel is the sum of every input channel multiplied by its gain. A matrix whose rows
+			each have at most one non-zero gain of exactly 1.0 is a pure routing (see IsRouting), and is applied
+			without any arithmetic on the samples.
+**/
+class AJAExport NTV2AudioChannelMatrix
+{
+	public:
+		/**
+			@brief	Constructs me with all gains set to zero.
+			@param[in]	inNumOutputs	Specifies the number of output channels.
+			@param[in]	inNumInputs		Specifies the number of input channels.
+		**/
+		explicit					NTV2AudioChannelMatrix (const ULWord inNumOutputs = 0, const ULWord inNumInputs = 0);
+
+		/**
+			@return		A matrix that passes the given number of channels straight through.
+			@param[in]	inNumChannels	Specifies the number of channels.
+		**/
+		static NTV2AudioChannelMatrix	Identity (const ULWord inNumChannels);
+
+		/**
+			@return		A routing matrix built from a channel map.
+			@param[in]	inChannelMap	Specifies, for each output channel, the zero-based input channel to take it from,
+										or -1 for silence.
+			@param[in]	inNumInputs		Specifies the number of input channels.
+		**/
+		static NTV2AudioChannelMatrix	FromChannelMap (const std::vector<int> & inChannelMap, const ULWord inNumInputs);
+
+		/**
+			@return		A matrix that downmixes 5.1 (L, R, C, LFE, Ls, Rs) to stereo (ITU-R BS.775: center and surrounds
+						at -3dB, LFE discarded).
+			@param[in]	inNumInputs		Specifies the number of input channels. Defaults to 6.
+			@param[in]	inFirstInput	Specifies the zero-based input channel that carries "L". Defaults to zero.
+		**/
+		static NTV2AudioChannelMatrix	Downmix51ToStereo (const ULWord inNumInputs = 6, const ULWord inFirstInput = 0);
+
+		/**
+			@brief		Sets the gain from one input channel to one output channel.
+			@param[in]	inOutput	Specifies the zero-based output channel.
+			@param[in]	inInput		Specifies the zero-based input channel.
+			@param[in]	inGain		Specifies the linear gain.
+			@return		True if successful;  otherwise false.
+		**/
+		bool						SetGain (const ULWord inOutput, const ULWord inInput, const float inGain);
+		float						GetGain (const ULWord inOutput, const ULWord inInput) const;	///< @return	The gain from the given input to the given output (or zero if out of range).
+		inline ULWord				GetNumOutputs (void) const	{return mNumOutputs;}	///< @return	The number of output channels.
+		inline ULWord				GetNumInputs (void) const	{return mNumInputs;}	///< @return	The number of input channels.
+		inline bool					IsValid (void) const		{return mNumOutputs && mNumInputs;}	///< @return	True if I have at least one input and one output.
+		bool						IsRouting (void) const;		///< @return	True if every output is either silent or an exact copy of one input.
+		bool						IsIdentity (void) const;	///< @return	True if I'm square, and every output is an exact copy of the same-numbered input.
+
+		/**
+			@return		The input channel that feeds the given output in a pure routing, or -1 if the output is silent
+						(or I'm not a pure routing).
+			@param[in]	inOutput	Specifies the zero-based output channel.
+		**/
+		int							GetSource (const ULWord inOutput) const;
+
+		/**
+			@return		A pointer to the given output channel's gains (one per input channel), or NULL if out of range.
+			@param[in]	inOutput	Specifies the zero-based output channel.
+		**/
+		inline const float *		GetRow (const ULWord inOutput) const	{return inOutput < mNumOutputs ? &mGains[size_t(inOutput) * mNumInputs] : AJA_NULL;}
+		std::ostream &				Print (std::ostream & oss) const;
+
+	private:
+		ULWord				mNumOutputs;
+		ULWord				mNumInputs;
+		std::vector<float>	mGains;		///< @brief	Row-major:  one row of mNumInputs gains per output
+};	//	NTV2AudioChannelMatrix
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2AudioChannelMatrix & inObj)	{return inObj.Print(oss);}
+
+
+/**
+	@brief	Converts audio between the device's interleaved 24-in-32 format (as found in AUTOCIRCULATE_TRANSFER::acAudioBuffer,
+			or read via CNTV2Card::DMAReadAudio) and a host format -- interleaved or planar, 32-bit, packed 24-bit or 16-bit
+			integer, or 32-bit float -- while routing and/or mixing channels through an NTV2AudioChannelMatrix.
+			-	FromDevice converts device audio to the host format. The matrix maps device channels (inputs) to host
+				channels (outputs).
+			-	ToDevice converts host audio to the device format. The matrix maps host channels (inputs) to device
+				channels (outputs).
+			Planar host buffers hold each channel's samples contiguously, one plane after another, each plane being the
+			number of sample frames converted. When reducing resolution (e.g. to 16-bit), or when mixing, TPDF dither can
+			be applied (see SetDither).
+	@note	This class is not thread-safe (the dither generator has state). Use one instance per stream and direction.
+**/
+class AJAExport NTV2AudioConverter
+{
+	public:
+		/**
+			@brief	Constructs me for a pass-through of 16 device channels to interleaved 32-bit host audio.
+		**/
+									NTV2AudioConverter ();
+		virtual						~NTV2AudioConverter ()	{}
+
+		/**
+			@name	Configuration
+		**/
+		///@{
+		/**
+			@brief		Sets the number of channels in each device sample frame, and resets my matrix to a pass-through.
+			@param[in]	inNumChannels	Specifies the number of device channels (e.g. 6, 8 or 16). Defaults to 16.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool				SetDeviceChannels (const ULWord inNumChannels);
+
+		/**
+			@brief		Sets the host sample format and layout.
+			@param[in]	inFormat	Specifies the host sample format.
+			@param[in]	inIsPlanar	Specify true for planar host buffers;  false for interleaved (the default).
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool				SetHostFormat (const NTV2AudioSampleFormat inFormat, const bool inIsPlanar = false);
+
+		/**
+			@brief		Sets the channel routing/mixing matrix.
+			@param[in]	inMatrix	Specifies the matrix. For FromDevice, it must have as many inputs as device channels;
+									for ToDevice, it must have as many outputs as device channels.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool				SetChannelMatrix (const NTV2AudioChannelMatrix & inMatrix);
+
+		/**
+			@brief		Enables or disables TPDF dither when converting to a host integer format with fewer than 24 bits,
+						or when the matrix mixes channels. Enabled by default.
+			@param[in]	inEnable	Specify true to enable dither.
+		**/
+		virtual inline void			SetDither (const bool inEnable)		{mDither = inEnable;}
+		///@}
+
+		/**
+			@name	Conversion
+		**/
+		///@{
+		/**
+			@brief		Converts device audio to host audio.
+			@param[in]	inDeviceAudio		Specifies the device audio buffer (interleaved 24-in-32).
+			@param[in]	inNumSampleFrames	Specifies the number of sample frames to convert.
+			@param		outHostAudio		Specifies the host buffer to receive the converted audio. Must be at least
+											GetHostByteCount(inNumSampleFrames) bytes.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool				FromDevice (const NTV2Buffer & inDeviceAudio, const ULWord inNumSampleFrames, NTV2Buffer & outHostAudio);
+
+		/**
+			@brief		Converts the audio captured by an AutoCirculate transfer to host audio.
+			@param[in]	inXfer				Specifies the AUTOCIRCULATE_TRANSFER that completed successfully.
+			@param		outHostAudio		Specifies the host buffer to receive the converted audio.
+			@param[out]	outNumSampleFrames	Receives the number of sample frames converted.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool				FromDevice (const AUTOCIRCULATE_TRANSFER & inXfer, NTV2Buffer & outHostAudio, ULWord & outNumSampleFrames);
+
+		/**
+			@brief		Converts host audio to device audio.
+			@param[in]	inHostAudio			Specifies the host audio buffer.
+			@param[in]	inNumSampleFrames	Specifies the number of sample frames to convert.
+			@param		outDeviceAudio		Specifies the device audio buffer to receive the converted audio (e.g.
+											AUTOCIRCULATE_TRANSFER::acAudioBuffer). Must be at least
+											GetDeviceByteCount(inNumSampleFrames) bytes.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool				ToDevice (const NTV2Buffer & inHostAudio, const ULWord inNumSampleFrames, NTV2Buffer & outDeviceAudio);
+		///@}
+
+		/**
+			@name	Inquiry
+		**/
+		///@{
+		virtual inline ULWord		GetDeviceChannels (void) const	{return mDeviceChannels;}	///< @return	The number of device channels.
+		virtual inline NTV2AudioSampleFormat	GetHostFormat (void) const	{return mHostFormat;}	///< @return	The host sample format.
+		virtual inline bool			IsPlanar (void) const			{return mIsPlanar;}			///< @return	True if host buffers are planar.
+		virtual inline const NTV2AudioChannelMatrix &	GetChannelMatrix (void) const	{return mMatrix;}	///< @return	My channel matrix.
+		virtual ULWord				GetHostChannels (const bool inFromDevice = true) const;		///< @return	The number of host channels for the given direction.
+		virtual ULWord				GetHostByteCount (const ULWord inNumSampleFrames, const bool inFromDevice = true) const;	///< @return	The host buffer size needed for the given number of sample frames.
+		virtual inline ULWord		GetDeviceByteCount (const ULWord inNumSampleFrames) const	{return inNumSampleFrames * mDeviceChannels * 4;}	///< @return	The device buffer size for the given number of sample frames.
+		static ULWord				GetBytesPerSample (const NTV2AudioSampleFormat inFormat);	///< @return	The size of one sample in the given format, in bytes.
+		virtual std::ostream &		Print (std::ostream & oss) const;
+		///@}
+
+	private:
+		float		NextDither (void);	///< @brief	Returns the next TPDF dither value, in LSBs (-1.0 .. +1.0)
+		void		StoreHostChannel (const int32_t * pIn, const ULWord inStride, const ULWord inNumFrames, UByte * pOut, const ULWord inOutStride);	///< @brief	Converts one routed device channel (or silence if pIn is NULL) to one host channel
+
+		ULWord					mDeviceChannels;	///< @brief	Channels per device sample frame
+		NTV2AudioSampleFormat	mHostFormat;		///< @brief	Host sample format
+		bool					mIsPlanar;			///< @brief	Planar host layout?
+		bool					mDither;			///< @brief	Dither enabled?
+		uint32_t				mDitherState;		///< @brief	Dither noise generator state
+		NTV2AudioChannelMatrix	mMatrix;			///< @brief	Channel routing/mixing matrix
+		std::vector<float>		mFrame;				///< @brief	Scratch:  one mixed sample frame
+};	//	NTV2AudioConverter
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2AudioConverter & inObj)	{return inObj.Print(oss);}
+
+#endif	//	NTV2AUDIOCONVERTER_H
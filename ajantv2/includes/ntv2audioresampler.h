@@ -0,0 +1,149 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2audioresampler.h
+	@brief		Declares the NTV2AudioResampler class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2AUDIORESAMPLER_H
+#define NTV2AUDIORESAMPLER_H
+
+#include "ajaexport.h"
+#include "ntv2publicinterface.h"
+#include <iostream>
+#include <vector>
+
+
+/**
+	@brief	A stateful, high-quality asynchronous sample-rate converter for multichannel interleaved audio in the
+			24-in-32 layout used by AJA devices (i.e. 24-bit signed samples left-justified in 32-bit words).
+			It uses a polyphase Kaiser-windowed sinc filter with linear interpolation between phases, and keeps its
+			filter history between calls, so successive blocks join without discontinuities (clicks).
+			The conversion ratio can be steered continuously (in parts-per-million) while running -- either directly
+			(see SetRatioAdjustment), or by feeding back the fill level of a downstream buffer (see UpdateBufferLevel),
+			which compensates for drift between a source clock and the device's reference clock.
+	@note	This class is not thread-safe. Use one instance per stream.
+	@see	NTV2AudioStream, NTV2ClockCorrelator
+**/
+class AJAExport NTV2AudioResampler
+{
+	public:
+		/**
+			@brief	Constructs me.
+			@param[in]	inNumChannels	Specifies the number of interleaved channels per sample frame. Defaults to 16.
+			@param[in]	inHalfTaps		Specifies the number of filter taps on each side of the interpolation point.
+										Larger values give a sharper anti-aliasing filter at higher CPU cost. Defaults to 8
+										(a 16-tap filter), which costs well under 1% of one core for 16 channels at 48kHz.
+			@param[in]	inNumPhases		Specifies the number of filter phases in the coefficient table. Defaults to 256.
+		**/
+		explicit				NTV2AudioResampler (const ULWord inNumChannels = 16, const ULWord inHalfTaps = 8, const ULWord inNumPhases = 256);
+		virtual					~NTV2AudioResampler ()	{}
+
+		/**
+			@brief		Sets the nominal input and output sample rates, and redesigns the filter if needed.
+						Also discards any buffered audio, and clears any ratio adjustment.
+			@param[in]	inInputRate		Specifies the input sample rate, in Hz (e.g. 44100).
+			@param[in]	inOutputRate	Specifies the output sample rate, in Hz (e.g. 48000).
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			SetRates (const double inInputRate, const double inOutputRate);
+
+		virtual void			Reset (void);	///< @brief	Discards all buffered audio, and clears the ratio adjustment and feedback state.
+
+		/**
+			@name	Conversion
+		**/
+		///@{
+		/**
+			@brief		Consumes all of the given input sample frames, and produces as many output sample frames as can be
+						computed (up to the given maximum). Input that cannot yet be converted is retained for the next call.
+			@param[in]	pInSamples			Points to the interleaved input samples. May be NULL if inNumInFrames is zero.
+			@param[in]	inNumInFrames		Specifies the number of input sample frames.
+			@param[out]	pOutSamples			Points to the buffer to receive the interleaved output samples.
+			@param[in]	inMaxOutFrames		Specifies the capacity of the output buffer, in sample frames.
+			@return		The number of output sample frames produced.
+		**/
+		virtual ULWord			Process (const int32_t * pInSamples, const ULWord inNumInFrames, int32_t * pOutSamples, const ULWord inMaxOutFrames);
+
+		/**
+			@brief		Same as above, but for NTV2Buffers.
+			@param[in]	inInput			Specifies the host buffer containing the input samples.
+			@param[in]	inNumInFrames	Specifies the number of input sample frames. Must fit in the input buffer.
+			@param		outOutput		Specifies the host buffer to receive the output samples.
+			@param[out]	outNumOutFrames	Receives the number of output sample frames produced.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			Process (const NTV2Buffer & inInput, const ULWord inNumInFrames, NTV2Buffer & outOutput, ULWord & outNumOutFrames);
+		///@}
+
+		/**
+			@name	Drift Compensation
+		**/
+		///@{
+		/**
+			@brief		Directly adjusts the conversion ratio.
+			@param[in]	inPPM	Specifies the adjustment, in parts-per-million. Positive values consume input faster
+								(producing fewer output samples per input sample). Clamped to +/- the maximum adjustment.
+		**/
+		virtual void			SetRatioAdjustment (const double inPPM);
+
+		/**
+			@brief		Sets the parameters for buffer-level feedback (see UpdateBufferLevel).
+			@param[in]	inTargetFrames	Specifies the desired downstream buffer fill level, in sample frames.
+			@param[in]	inMaxPPM		Specifies the maximum ratio adjustment, in parts-per-million. Defaults to 1000.
+			@param[in]	inGain			Specifies the loop gain, in PPM per sample frame of error. Defaults to 0.05.
+		**/
+		virtual void			SetBufferTarget (const ULWord inTargetFrames, const double inMaxPPM = 1000.0, const double inGain = 0.05);
+
+		/**
+			@brief		Steers the conversion ratio toward keeping a downstream buffer (e.g. the device's playout ring) at
+						the target fill level, using a proportional-integral controller. Call this once per block.
+			@param[in]	inQueuedFrames	Specifies the current fill level of the downstream buffer, in sample frames.
+		**/
+		virtual void			UpdateBufferLevel (const ULWord inQueuedFrames);
+		///@}
+
+		/**
+			@name	Inquiry
+		**/
+		///@{
+		virtual inline ULWord	GetNumChannels (void) const		{return mNumChannels;}	///< @return	The number of channels per sample frame.
+		virtual inline double	GetInputRate (void) const		{return mInputRate;}	///< @return	The nominal input sample rate.
+		virtual inline double	GetOutputRate (void) const		{return mOutputRate;}	///< @return	The nominal output sample rate.
+		virtual inline double	GetRatioAdjustment (void) const	{return mAdjustPPM;}	///< @return	The current ratio adjustment, in PPM.
+		virtual double			GetEffectiveRatio (void) const;	///< @return	The current output-to-input sample rate ratio, including the adjustment.
+		virtual ULWord			GetBufferedFrames (void) const;	///< @return	The number of input sample frames buffered and not yet fully consumed.
+		virtual inline ULWord	GetLatencyFrames (void) const	{return mHalfTaps;}		///< @return	The filter's group delay, in input sample frames.
+		virtual std::ostream &	Print (std::ostream & oss) const;
+		///@}
+
+	protected:
+		virtual void			DesignFilter (void);	///< @brief	Computes the coefficient table for the current rates.
+
+	private:
+		typedef std::vector<float>	FloatArray;
+
+		ULWord		mNumChannels;	///< @brief	Channels per sample frame
+		ULWord		mHalfTaps;		///< @brief	Taps on each side of the interpolation point
+		ULWord		mNumPhases;		///< @brief	Filter phases in the coefficient table
+		double		mInputRate;		///< @brief	Nominal input rate
+		double		mOutputRate;	///< @brief	Nominal output rate
+		double		mNominalStep;	///< @brief	Input frames per output frame, without adjustment
+		double		mStep;			///< @brief	Input frames per output frame, with adjustment
+		ULWord		mBase;			///< @brief	Position of the next output frame, in whole input frames relative to mHistory's start
+		double		mFraction;		///< @brief	Position of the next output frame, fractional part (kept apart from mBase, so that
+									///<		its precision doesn't depend on how far into mHistory it is, or on the block sizes)
+		double		mAdjustPPM;		///< @brief	Current ratio adjustment
+		double		mMaxPPM;		///< @brief	Ratio adjustment limit
+		double		mGain;			///< @brief	Feedback loop gain, in PPM per frame of error
+		double		mIntegral;		///< @brief	Feedback integrator state, in PPM
+		ULWord		mTargetFrames;	///< @brief	Feedback target buffer level
+		FloatArray	mCoeffs;		///< @brief	Coefficient table: (mNumPhases + 1) rows of (2 * mHalfTaps) taps
+		FloatArray	mHistory;		///< @brief	Buffered input samples, interleaved, normalized to [-1.0, +1.0)
+		FloatArray	mTaps;			///< @brief	Scratch:  interpolated coefficients for the current output frame
+		FloatArray	mAccum;			///< @brief	Scratch:  per-channel accumulators
+};	//	NTV2AudioResampler
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2AudioResampler & inObj)	{return inObj.Print(oss);}
+
+#endif	//	NTV2AUDIORESAMPLER_H
@@ -0,0 +1,180 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2audiostream.h
+	@brief		Declares the NTV2AudioStream class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2AUDIOSTREAM_H
+#define NTV2AUDIOSTREAM_H
+
+#include "ntv2card.h"
+#include <iostream>
+
+
+/**
+	@brief	Streams audio samples to or from an Audio System's device ring buffer using plain (non-AutoCirculate) DMA.
+			It owns the host-side ring cursor, and hides the device ring's wrap point: a transfer that straddles the wrap
+			is automatically split into two DMAs. All sizes are expressed in sample frames, where a sample frame is one
+			4-byte sample for each of the Audio System's channels (e.g. 64 bytes for 16 channels, 32 bytes for 8 channels).
+			-	In capture mode, the device's write head (CNTV2Card::ReadAudioLastIn) is compared with my read cursor to
+				determine how many samples are available. An <b>overrun</b> is detected if the reader falls behind by
+				(nearly) an entire ring's worth of samples, in which case the cursor is re-synchronized to the write head.
+			-	In playout mode, my write cursor is compared with the device's play head (CNTV2Card::ReadAudioLastOut) to
+				determine how many samples are queued. An <b>underrun</b> is detected if the play head passes the write cursor,
+				in which case the cursor is re-synchronized to lead the play head by the playout lead (see SetPlayoutLead).
+			Transfers go directly into (or out of) the caller's NTV2Buffer -- at any byte offset -- without any intermediate
+			copy, which suits low-latency audio-follow-video.
+	@note	This class is not thread-safe. Use one instance per Audio System per direction.
+	@see	CNTV2Card::DMAReadAudio, CNTV2Card::DMAWriteAudio, \ref audiooperation
+**/
+class AJAExport NTV2AudioStream
+{
+	public:
+		/**
+			@brief	Constructs me.
+			@param	inDevice		Specifies the open device to use. It must outlive me.
+			@param[in]	inAudioSystem	Specifies the Audio System of interest.
+			@param[in]	inIsCapture		Specify true for capture (device-to-host);  false for playout (host-to-device).
+		**/
+								NTV2AudioStream (CNTV2Card & inDevice, const NTV2AudioSystem inAudioSystem, const bool inIsCapture);
+		virtual					~NTV2AudioStream ()		{}
+
+		/**
+			@brief		Queries the Audio System's current configuration (number of channels, buffer size, sample rate),
+						and positions my cursor: for capture, at the current write head;  for playout, at the start of the
+						ring if output is stopped, or at the play head plus the playout lead if it's running.
+			@return		True if successful;  otherwise false.
+			@note		Call this again after changing the Audio System's channel count or buffer size.
+		**/
+		virtual bool			Initialize (void);
+
+		/**
+			@brief		Re-positions my cursor as described in NTV2AudioStream::Initialize, without re-querying the configuration.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			Reset (void);
+
+		/**
+			@brief		Requires transfers to be a whole multiple of the given number of sample frames (e.g. 128 for
+						downstream processing that works in 128-sample blocks). Reads deliver the largest multiple of this
+						many sample frames that are available, leaving the remainder for next time.
+			@param[in]	inSampleFrames	Specifies the granularity. Zero or one means no restriction (the default).
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			SetSampleGranularity (const ULWord inSampleFrames);
+
+		/**
+			@brief		Specifies how far ahead of the play head my write cursor is re-positioned after an underrun (or at
+						Initialize/Reset time if output is running).
+			@param[in]	inSampleFrames	Specifies the playout lead, in sample frames. Defaults to 4800 (100ms @ 48kHz).
+		**/
+		virtual inline void		SetPlayoutLead (const ULWord inSampleFrames)	{mPlayoutLead = inSampleFrames;}
+
+		/**
+			@name	Capture
+		**/
+		///@{
+		/**
+			@brief		Answers with the number of sample frames that are ready to be read.
+			@param[out]	outSampleFrames		Receives the number of sample frames available.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			GetAvailableSamples (ULWord & outSampleFrames);
+
+		/**
+			@brief		Reads as many available sample frames as will fit into the given host buffer, directly via DMA.
+			@param		inOutBuffer			Specifies the host buffer to receive the samples.
+			@param[out]	outSampleFrames		Receives the number of sample frames actually read (possibly zero).
+			@param[in]	inMaxSampleFrames	Optionally limits the number of sample frames to read. Zero (the default)
+											means read as many as will fit.
+			@param[in]	inByteOffset		Optionally specifies where in the host buffer to start writing. Defaults to zero.
+			@return		True if successful (even if no samples were available);  otherwise false.
+		**/
+		virtual bool			Read (NTV2Buffer & inOutBuffer, ULWord & outSampleFrames, const ULWord inMaxSampleFrames = 0,
+										const ULWord inByteOffset = 0);
+		///@}
+
+		/**
+			@name	Playout
+		**/
+		///@{
+		/**
+			@brief		Answers with the number of sample frames that have been written but not yet played.
+			@param[out]	outSampleFrames		Receives the number of sample frames queued for playout.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			GetQueuedSamples (ULWord & outSampleFrames);
+
+		/**
+			@brief		Writes the given number of sample frames from the host buffer into the device ring, directly via DMA.
+			@param[in]	inBuffer			Specifies the host buffer containing the samples.
+			@param[in]	inSampleFrames		Specifies the number of sample frames to write. Must not exceed the ring capacity.
+			@param[in]	inByteOffset		Optionally specifies where in the host buffer to start reading. Defaults to zero.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			Write (const NTV2Buffer & inBuffer, const ULWord inSampleFrames, const ULWord inByteOffset = 0);
+		///@}
+
+		/**
+			@name	Inquiry
+		**/
+		///@{
+		virtual inline bool		IsCapture (void) const				{return mIsCapture;}		///< @return	True if I'm a capture stream.
+		virtual inline bool		IsInitialized (void) const			{return mRingBytes > 0;}	///< @return	True if I've been successfully initialized.
+		virtual inline ULWord	GetNumChannels (void) const			{return mNumChannels;}		///< @return	The number of audio channels per sample frame.
+		virtual inline ULWord	GetBytesPerSampleFrame (void) const	{return mNumChannels * 4;}	///< @return	The size of a sample frame, in bytes.
+		virtual inline ULWord	GetRingByteCount (void) const		{return mRingBytes;}		///< @return	The usable size of the device ring, in bytes.
+		virtual inline ULWord	GetRingSampleFrames (void) const	{return mNumChannels ? mRingBytes / GetBytesPerSampleFrame() : 0;}	///< @return	The ring capacity, in sample frames.
+		virtual inline ULWord	GetCursor (void) const				{return mCursor;}			///< @return	My cursor, as a byte offset into the ring.
+		virtual inline ULWord64	GetTotalSampleFrames (void) const	{return mTotalSamples;}		///< @return	Total sample frames transferred since Initialize.
+		virtual inline ULWord	GetNumOverruns (void) const			{return mNumOverruns;}		///< @return	Number of capture overruns since Initialize.
+		virtual inline ULWord	GetNumUnderruns (void) const		{return mNumUnderruns;}		///< @return	Number of playout underruns since Initialize.
+		virtual std::ostream &	Print (std::ostream & oss) const;
+		///@}
+
+		/**
+			@brief		Computes the forward distance from one ring offset to another.
+			@param[in]	inFrom		The starting byte offset.
+			@param[in]	inTo		The ending byte offset.
+			@param[in]	inRingBytes	The ring size, in bytes.
+			@return		The number of bytes from "inFrom" forward to "inTo", accounting for the wrap.
+		**/
+		static ULWord			RingDistance (const ULWord inFrom, const ULWord inTo, const ULWord inRingBytes);
+
+		/**
+			@brief		Splits a ring transfer at the wrap point.
+			@param[in]	inOffset		The starting byte offset in the ring.
+			@param[in]	inByteCount		The number of bytes to transfer (must not exceed the ring size).
+			@param[in]	inRingBytes		The ring size, in bytes.
+			@param[out]	outFirstBytes	Receives the number of bytes to transfer starting at "inOffset".
+			@param[out]	outSecondBytes	Receives the number of bytes to transfer starting at the beginning of the ring (zero if no wrap).
+		**/
+		static void				SplitAtWrap (const ULWord inOffset, const ULWord inByteCount, const ULWord inRingBytes,
+											ULWord & outFirstBytes, ULWord & outSecondBytes);
+
+	protected:
+		virtual bool			ReadHead (ULWord & outHead);	///< @brief	Reads the device's write head (capture) or play head (playout).
+		virtual bool			TransferChunk (const ULWord inRingOffset, ULWord * pHostBuffer, const ULWord inByteCount);	///< @brief	Performs one DMA to/from the ring.
+
+	private:
+		CNTV2Card &				mDevice;		///< @brief	My device
+		const NTV2AudioSystem	mAudioSystem;	///< @brief	My Audio System
+		const bool				mIsCapture;		///< @brief	Capture or playout?
+		ULWord					mNumChannels;	///< @brief	Channels per sample frame
+		ULWord					mRingBytes;		///< @brief	Usable ring size (wrap address)
+		ULWord					mCaptureOffset;	///< @brief	Offset to capture buffer from top of Audio System buffer
+		double					mSampleRate;	///< @brief	Samples per second
+		ULWord					mGranularity;	///< @brief	Transfer granularity, in sample frames
+		ULWord					mPlayoutLead;	///< @brief	Playout lead after underrun, in sample frames
+		ULWord					mCursor;		///< @brief	Ring byte offset of next read/write
+		ULWord					mLastQueued;	///< @brief	Playout:  queued bytes after last write (underrun detection)
+		uint64_t				mLastAccessUS;	///< @brief	Capture:  host time of last read, in microseconds (overrun detection)
+		ULWord64				mTotalSamples;	///< @brief	Total sample frames transferred
+		ULWord					mNumOverruns;	///< @brief	Overrun count
+		ULWord					mNumUnderruns;	///< @brief	Underrun count
+};	//	NTV2AudioStream
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2AudioStream & inObj)	{return inObj.Print(oss);}
+
+#endif	//	NTV2AUDIOSTREAM_H
@@ -21,6 +21,7 @@
 #include "ntv2utils.h"
 #include "ntv2devicecapabilities.h"
 
+class NTV2LatencyTimeline;
 
 /**
 	@brief	I interrogate and control an AJA video/audio capture/playout device.
@@ -2947,6 +2948,17 @@ public:
 	**/
 	AJA_VIRTUAL bool	WaitForOutputVerticalInterrupt (const NTV2Channel inChannel = NTV2_CHANNEL1, UWord inRepeatCount = 1);
 
+	/**
+		@brief		Efficiently sleeps the calling thread/process until the next output VBI for the given channel, then
+					answers with the registers and AutoCirculate status that the given snapshot asks for, as they were
+					right after the VBI -- all in one driver call.
+		@param[in]	inChannel		Specifies the FrameStore of interest as an ::NTV2Channel (a zero-based index number).
+		@param[in,out]	inOutSnapshot	Specifies the registers and AutoCirculate channels of interest, and receives their values.
+		@return		True if successful; otherwise false. A <b>false</b> result usually indicates the wait timed out.
+		@see		CNTV2DriverInterface::WaitForInterruptSnapshot, NTV2InterruptSnapshot, \ref vidop-fldfrmint
+	**/
+	AJA_VIRTUAL bool	WaitForOutputVerticalInterrupt (const NTV2Channel inChannel, NTV2InterruptSnapshot & inOutSnapshot);
+
 	/**
 		@brief		Efficiently sleeps the calling thread/process until the next output VBI for the given field and output
 					channel.
@@ -2990,6 +3002,17 @@ public:
 	**/
 	AJA_VIRTUAL bool	WaitForInputVerticalInterrupt (const NTV2Channel inChannel = NTV2_CHANNEL1, UWord inRepeatCount = 1);
 
+	/**
+		@brief		Efficiently sleeps the calling thread/process until the next input VBI for the given channel, then
+					answers with the registers and AutoCirculate status that the given snapshot asks for, as they were
+					right after the VBI -- all in one driver call.
+		@param[in]	inChannel		Specifies the FrameStore of interest as an ::NTV2Channel (a zero-based index number).
+		@param[in,out]	inOutSnapshot	Specifies the registers and AutoCirculate channels of interest, and receives their values.
+		@return		True if successful; otherwise false. A <b>false</b> result usually indicates the wait timed out.
+		@see		CNTV2DriverInterface::WaitForInterruptSnapshot, NTV2InterruptSnapshot, \ref vidop-fldfrmint
+	**/
+	AJA_VIRTUAL bool	WaitForInputVerticalInterrupt (const NTV2Channel inChannel, NTV2InterruptSnapshot & inOutSnapshot);
+
 	/**
 		@brief		Efficiently sleeps the calling thread/process until the next input VBI for the given field and input
 					channel.
@@ -3382,6 +3405,25 @@ public:
 	**/
 	AJA_VIRTUAL bool	FindUnallocatedFrames (const UWord inFrameCount, LWord & outStartFrame, LWord & outEndFrame,
 												const NTV2Channel inFrameStore = NTV2_CHANNEL_INVALID);
+
+	/**
+		@brief		Enables or disables per-frame latency instrumentation of CNTV2Card::AutoCirculateTransfer and the DMA functions.
+					When enabled, each transfer appends an NTV2LatencyRecord (VBI, submit, DMA start/end, anc post-processing and
+					return times, plus the pertinent ::FRAME_STAMP fields) into a lock-free ring for its channel.
+		@param[in]	inEnable		Specify true to enable recording;  false to disable it and discard all recorded data.
+		@param[in]	inCapacity		Specifies the number of records to retain per channel. Defaults to 1024.
+		@return		True if successful;  otherwise false.
+		@note		Do not enable or disable this while other threads are transferring data using this CNTV2Card instance.
+		@see		CNTV2Card::GetLatencyTimeline, NTV2LatencyTimeline
+	**/
+	AJA_VIRTUAL bool	SetLatencyTimelineEnable (const bool inEnable, const ULWord inCapacity = 1024);	//	New in SDK 17.1
+
+	/**
+		@return		A pointer to my NTV2LatencyTimeline, or NULL if latency instrumentation isn't enabled.
+					Use it to retrieve records, percentile summaries, or a Chrome trace-event JSON dump.
+		@see		CNTV2Card::SetLatencyTimelineEnable
+	**/
+	AJA_VIRTUAL inline NTV2LatencyTimeline * GetLatencyTimeline (void) const	{return mLatencyTimeline;}	//	New in SDK 17.1
 	///@}
 
 	/**
@@ -3494,10 +3536,55 @@ public:
 		@brief			Writes the given sequence of NTV2RegInfo's.
 		@param[in]		inRegWrites		Specifies the sequence of NTV2RegInfo's to be written.
 		@return			True if all registers were written successfully; otherwise false.
-		@note			This operation is not guaranteed to be performed atomically.
+		@note			This operation is not guaranteed to be performed atomically. The writes are sent in order, in NTV2SetRegisters
+						messages of up to ::NTV2_MAX_NUM_SETREGS registers each, as drivers reject bigger ones.
+		@note			If the calling thread has a register write transaction open (see BeginRegisterWrites), the writes
+						are added to it, and won't reach the device until it's committed.
 	**/
 	AJA_VIRTUAL bool	WriteRegisters (const NTV2RegisterWrites & inRegWrites);
 
+	/**
+		@brief			Opens a register write transaction on the calling thread. Until it's committed or aborted, WriteRegister
+						and WriteRegisters calls made on this thread -- including those made by other CNTV2Card functions (e.g.
+						SetVideoFormat, Connect, SetSDITransmitEnable) -- are held in the transaction instead of being sent to the
+						device. Writes to configuration registers are coalesced (masked writes to the same register are merged
+						into one), and everything is sent to the device at CommitRegisterWrites (see its notes).
+						ReadRegister calls made on this thread see the pending values.
+		@return			True if successful;  false if another thread has a transaction open on this device.
+		@note			A configuration register write is merged into the earlier pending write to the same register, which
+						means it can reach the device ahead of configuration writes to other registers that were made before it.
+						Writes are never merged across a write to a non-configuration (e.g. status or trigger) register, so
+						the order of configuration writes relative to those is always kept.
+		@note			Transactions nest:  only the outermost CommitRegisterWrites sends the writes to the device.
+		@note			Operations that don't go through WriteRegister (e.g. AutoCirculate, DMA, BankSelectWriteRegister)
+						aren't held, and will take effect before the transaction's writes.
+		@see			CNTV2RegisterWriteTransaction, CommitRegisterWrites, AbortRegisterWrites
+	**/
+	AJA_VIRTUAL bool	BeginRegisterWrites (void);
+
+	/**
+		@brief			Commits the calling thread's register write transaction. If it's the outermost one, sends all of its
+						writes to the device, in order, by calling WriteRegisters.
+		@param[in]		inAtNextVBI		Specify true to wait for the next output vertical interrupt before sending, so all of
+										the writes land early in the same frame. Defaults to false.
+		@param[in]		inChannel		Specifies the output channel whose vertical interrupt is waited for. Defaults to ::NTV2_CHANNEL1.
+		@return			True if successful;  otherwise false.
+		@note			If the vertical interrupt wait fails, the writes are still sent (immediately), but false is returned.
+		@note			Drivers reject ::NTV2SetRegisters messages of more than ::NTV2_MAX_NUM_SETREGS registers, so a bigger
+						(coalesced) transaction is sent in several messages. The device applies each message atomically, but
+						not the transaction as a whole, and with inAtNextVBI, later messages may land in a later frame.
+	**/
+	AJA_VIRTUAL bool	CommitRegisterWrites (const bool inAtNextVBI = false, const NTV2Channel inChannel = NTV2_CHANNEL1);
+
+	/**
+		@brief			Discards the calling thread's register write transaction (including any outer nesting levels).
+		@return			True if successful;  false if the calling thread has no transaction open.
+	**/
+	AJA_VIRTUAL bool	AbortRegisterWrites (void);
+
+	AJA_VIRTUAL inline bool		IsRegisterWriteTransactionOpen (void) const		{return RegWriteTxnIsOpen();}		///< @return	True if the calling thread has a register write transaction open.
+	AJA_VIRTUAL inline ULWord	GetNumPendingRegisterWrites (void) const		{return RegWriteTxnNumPending();}	///< @return	The number of (coalesced) writes held in the calling thread's register write transaction.
+
 	/**
 		@brief			Writes the given set of registers to the bank specified at position 0.
 		@param[in]		inBankSelect	Specifies the bank select register.
@@ -3910,6 +3997,26 @@ public:
 	AJA_VIRTUAL bool	Download12BitLUTToHW (const UWordSequence & inRedLUT, const UWordSequence & inGreenLUT, const UWordSequence & inBlueLUT,
 										const NTV2Channel inLUT, const int inBank);
 
+	/**
+		@brief		Double-buffered LUT update:  writes the given tables into the bank of the given LUT that isn't currently
+					being output, then switches the LUT's output to that bank with a single register write, so the new
+					tables take effect all at once without tearing.
+		@param[in]	inRedLUT	The Red LUT, a std::vector of UWord values.
+		@param[in]	inGreenLUT	The Green LUT, a std::vector of UWord values.
+		@param[in]	inBlueLUT	The Blue LUT, a std::vector of UWord values.
+		@param[in]	inLUT		Specifies the LUT of interest, expressed as an ::NTV2Channel (a zero-based index number).
+		@param[in]	in12Bit		Specify true to write 12-bit (4096-entry) tables (see CNTV2Card::Download12BitLUTToHW),
+								or false to write 10-bit (1024-entry) tables (see CNTV2Card::DownloadLUTToHW). Defaults to false.
+		@param[in]	inAtNextVBI	Specify true to switch banks right after the next output vertical interrupt of the channel
+								having the same index as the LUT (the default), or false to switch immediately.
+		@return		True if successful;	 otherwise false.
+		@note		Calling this again for the same LUT flips back to the other bank.
+		@note		If the vertical interrupt wait fails, the banks aren't switched (the new tables are left in the inactive
+					bank), and false is returned.
+	**/
+	AJA_VIRTUAL bool	DownloadLUTToInactiveBank (const UWordSequence & inRedLUT, const UWordSequence & inGreenLUT, const UWordSequence & inBlueLUT,
+												const NTV2Channel inLUT, const bool in12Bit = false, const bool inAtNextVBI = true);
+
 	/**
 		@brief		Enables or disables the given LUT.
 		@param[in]	inEnable	Specify true to enable, or false to disable.
@@ -3935,7 +4042,8 @@ public:
 	AJA_VIRTUAL bool		Load12BitLUTTables (const NTV2DoubleArray & inRedLUT, const NTV2DoubleArray & inGreenLUT, const NTV2DoubleArray & inBlueLUT);
 
 	/**
-		@brief		Writes the LUT tables.
+		@brief		Writes the LUT tables. All three tables are sent to the device in one CNTV2Card::WriteRegisters call (which
+					splits them into as few NTV2SetRegisters messages as the driver accepts).
 		@param[in]	inRedLUT		The Red LUT, a std::vector of unsigned 10-bit integer values.
 		@param[in]	inGreenLUT		The Green LUT, a std::vector of unsigned 10-bit integer values.
 		@param[in]	inBlueLUT		The Blue LUT, a std::vector of unsigned 10-bit integer values.
@@ -4323,6 +4431,35 @@ public:
 	**/
 	AJA_VIRTUAL bool	ApplySignalRoute (const NTV2XptConnections & inConnections, const bool inReplace = false);
 
+	/**
+		@brief		Changes the device's widget routing to match the given routing table, writing only the crosspoint
+					select registers that need to change, all in one CNTV2Card::WriteRegisters call.
+		@return		True if successful; otherwise false.
+		@param[in]	inRouter		Specifies the CNTV2SignalRouter that contains the routing to be applied to the device.
+		@param[in]	inReplace		If true, also disconnects any widget inputs that are connected on the device, but not
+									in the given routing table. If false, those connections are left alone. Defaults to false.
+		@details	Unlike ApplySignalRoute, this reads the device's current connections once (see CNTV2Card::GetConnections),
+					uses CNTV2SignalRouter::Compare to find the connections to be added, changed or removed, and merges
+					them into one masked write per affected crosspoint select register. Since connections that don't
+					change are never touched, and inReplace doesn't call CNTV2Card::ClearRouting first, a live route
+					never passes through an all-disconnected state. If the device has a crosspoint connect ROM, every
+					new or changed connection is validated against it first (see CNTV2Card::CanConnect), and if any
+					is unsupported, nothing is written.
+		@see		\ref ntv2signalrouting, CNTV2SignalRouter, CNTV2Card::ApplySignalRoute
+	**/
+	AJA_VIRTUAL bool	ApplySignalRouteDelta (const CNTV2SignalRouter & inRouter, const bool inReplace = false);
+
+	/**
+		@brief		Changes the device's widget routing to match the given routing connections, writing only the crosspoint
+					select registers that need to change, all in one CNTV2Card::WriteRegisters call.
+		@return		True if successful; otherwise false.
+		@param[in]	inConnections	Specifies the routing connections to be applied to the device.
+		@param[in]	inReplace		If true, also disconnects any widget inputs that are connected on the device, but not
+									in the given connections. If false, those connections are left alone. Defaults to false.
+		@see		\ref ntv2signalrouting, CNTV2Card::ApplySignalRouteDelta
+	**/
+	AJA_VIRTUAL bool	ApplySignalRouteDelta (const NTV2XptConnections & inConnections, const bool inReplace = false);
+
 	/**
 		@brief		Removes the given widget routing connections from the AJA device.
 		@return		True if successful; otherwise false.
@@ -6546,9 +6683,50 @@ private:
 	AJA_VIRTUAL bool	IsMultiFormatActive (void); ///< @return	True if the device supports the multi format feature and it's enabled; otherwise false.
 	AJA_VIRTUAL bool	CopyVideoFormat(const NTV2Channel inSrc, const NTV2Channel inFirst, const NTV2Channel inLast);
 	class DeviceCapabilities	mDevCap;
+	NTV2LatencyTimeline *		mLatencyTimeline;	///< @brief	Latency instrumentation (NULL if disabled)
 };	//	CNTV2Card
 
 
+/**
+	@brief	Opens a register write transaction on a CNTV2Card for as long as it's in scope (see CNTV2Card::BeginRegisterWrites).
+			If it isn't committed by the time it goes out of scope (e.g. due to an early return or an exception), its writes
+			are discarded.
+	@code
+		{
+			CNTV2RegisterWriteTransaction txn(device);
+			device.SetVideoFormat(NTV2_FORMAT_1080p_5994_A, false, false, NTV2_CHANNEL1);
+			device.SetFrameBufferFormat(NTV2_CHANNEL1, NTV2_FBF_10BIT_YCBCR);
+			device.Connect(NTV2_XptSDIOut1Input, NTV2_XptFrameBuffer1YUV);
+			txn.Commit(true);	//	One NTV2SetRegisters message, sent right after the next VBI
+		}
+	@endcode
+**/
+class CNTV2RegisterWriteTransaction
+{
+	public:
+		explicit inline	CNTV2RegisterWriteTransaction (CNTV2Card & inDevice)	:	mDevice(inDevice), mIsOpen(inDevice.BeginRegisterWrites())	{}
+		inline			~CNTV2RegisterWriteTransaction ()	{if (mIsOpen) mDevice.AbortRegisterWrites();}
+
+		/**
+			@brief		Commits the transaction (see CNTV2Card::CommitRegisterWrites).
+			@return		True if successful;  otherwise false.
+		**/
+		inline bool		Commit (const bool inAtNextVBI = false, const NTV2Channel inChannel = NTV2_CHANNEL1)
+						{	if (!mIsOpen) return false;
+							mIsOpen = false;
+							return mDevice.CommitRegisterWrites(inAtNextVBI, inChannel);
+						}
+		inline bool		Abort (void)	{if (!mIsOpen) return false;  mIsOpen = false;  return mDevice.AbortRegisterWrites();}	///< @brief	Discards the transaction.
+		inline bool		IsOpen (void) const		{return mIsOpen;}	///< @return	True if the transaction was opened and hasn't yet been committed or aborted.
+
+	private:
+		CNTV2RegisterWriteTransaction (const CNTV2RegisterWriteTransaction & inObj);				//	Not copyable
+		CNTV2RegisterWriteTransaction & operator = (const CNTV2RegisterWriteTransaction & inRHS);	//	Not assignable
+		CNTV2Card &	mDevice;
+		bool		mIsOpen;
+};	//	CNTV2RegisterWriteTransaction
+
+
 typedef CNTV2Card	CNTV2Device;	///< @brief Instances of this class are able to interrogate and control an NTV2 AJA video/audio capture/playout device.
 #if !defined(NTV2_DEPRECATE_16_2)
 	typedef CNTV2Card	CNTV2Status;			///< @deprecated	Use CNTV2Card instead.
@@ -0,0 +1,184 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2clockcorrelator.h
+	@brief		Declares the NTV2ClockFit and NTV2ClockCorrelator classes.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2CLOCKCORRELATOR_H
+#define NTV2CLOCKCORRELATOR_H
+
+#include "ajaexport.h"
+#include "ntv2publicinterface.h"
+#include "ajabase/system/lock.h"
+#include <iostream>
+
+
+/**
+	@brief	A filtered (exponentially-weighted least-squares) linear model that maps one monotonic clock ("X") to
+			another ("Y"), i.e. Y = offset + slope * X. Samples are (X,Y) pairs that were captured at (roughly) the same
+			instant. Sample statistics are kept relative to the most recent sample, so the model remains numerically
+			stable regardless of how large the clock values get. Gross outliers (e.g. a late wakeup) are rejected;
+			a sustained run of outliers is treated as a clock discontinuity, and the model restarts.
+	@note	This class is not thread-safe. See NTV2ClockCorrelator for a thread-safe aggregate.
+**/
+class AJAExport NTV2ClockFit
+{
+	public:
+		/**
+			@brief	Constructs me.
+			@param[in]	inNominalSlope		Specifies the expected Y/X ratio, which is used until enough samples have been
+											collected to estimate it. Defaults to 1.0 (i.e. both clocks tick at the same rate).
+			@param[in]	inTimeConstant		Specifies the filter time constant, in samples. Larger values track drift more
+											slowly but reject more jitter. Defaults to 64.
+		**/
+		explicit				NTV2ClockFit (const double inNominalSlope = 1.0, const ULWord inTimeConstant = 64);
+
+		void					Reset (void);	///< @brief	Forgets all samples, reverting to the nominal slope.
+
+		/**
+			@brief		Ingests a new (X,Y) sample.
+			@param[in]	inX		The X clock value.
+			@param[in]	inY		The Y clock value that was sampled at (roughly) the same time as X.
+			@return		True if the sample was accepted into the model;  false if it was rejected as an outlier.
+		**/
+		bool					AddSample (const int64_t inX, const int64_t inY);
+
+		int64_t					XToY (const int64_t inX) const;	///< @return	The Y clock value corresponding to the given X value.
+		int64_t					YToX (const int64_t inY) const;	///< @return	The X clock value corresponding to the given Y value.
+		inline double			Slope (void) const			{return mSlope;}			///< @return	The current Y/X slope estimate.
+		inline double			DriftPPM (void) const		{return (mSlope / mNominalSlope - 1.0) * 1000000.0;}	///< @return	Deviation of slope from nominal, in parts per million.
+		double					JitterRMS (void) const;		///< @return	The RMS of the sample residuals (in Y units).
+		inline ULWord			NumSamples (void) const		{return mNumSamples;}		///< @return	Number of samples accepted since the last reset.
+		inline ULWord			NumOutliers (void) const	{return mNumOutliers;}		///< @return	Number of samples rejected since construction.
+		inline ULWord			NumResets (void) const		{return mNumResets;}		///< @return	Number of discontinuity restarts since construction.
+		inline bool				IsValid (void) const		{return mNumSamples > 0;}	///< @return	True if at least one sample was accepted.
+		inline bool				IsLocked (void) const		{return mNumSamples >= kMinLockSamples;}	///< @return	True if the slope estimate is trustworthy.
+		std::ostream &			Print (std::ostream & oss) const;
+
+		static const ULWord		kMinLockSamples = 8;	///< @brief	Number of samples needed before the slope estimate is used and outliers are rejected.
+		static const ULWord		kMaxOutlierRun	= 8;	///< @brief	Number of consecutive outliers that will trigger a restart.
+
+	private:
+		int64_t		mAnchorX;		///< @brief	X value of the most recent accepted sample (statistics origin)
+		int64_t		mAnchorY;		///< @brief	Y value of the most recent accepted sample (statistics origin)
+		double		mSumW;			///< @brief	Sum of sample weights
+		double		mSumX;			///< @brief	Weighted sum of X, relative to mAnchorX
+		double		mSumY;			///< @brief	Weighted sum of Y, relative to mAnchorY
+		double		mSumXX;			///< @brief	Weighted sum of X squared
+		double		mSumXY;			///< @brief	Weighted sum of X times Y
+		double		mSumRR;			///< @brief	Weighted sum of squared residuals
+		double		mOffsetY;		///< @brief	Model Y at mAnchorX, relative to mAnchorY
+		double		mSlope;			///< @brief	Current slope estimate
+		double		mNominalSlope;	///< @brief	Expected slope
+		double		mDecay;			///< @brief	Per-sample weight decay factor
+		ULWord		mNumSamples;	///< @brief	Accepted sample count since reset
+		ULWord		mNumOutliers;	///< @brief	Rejected sample count
+		ULWord		mOutlierRun;	///< @brief	Consecutive rejected sample count
+		ULWord		mNumResets;		///< @brief	Discontinuity restart count
+};	//	NTV2ClockFit
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2ClockFit & inFit)	{return inFit.Print(oss);}
+
+
+/**
+	@brief	Per-device clock correlation service. Maintains filtered linear models that relate...
+			-	the device's 10MHz audio clock (e.g. FRAME_STAMP::acAudioClockTimeStamp) to the host clock used by
+				the driver to stamp frames (e.g. FRAME_STAMP::acFrameTime, in 100-nanosecond units);
+			-	the driver's host time stamps to the host's monotonic clock (AJATime::GetSystemNanoseconds, in 100-nanosecond
+				units), which on some platforms differ (e.g. wall-clock vs. monotonic);
+			-	the VBI (vertical interrupt) count to the driver's host time stamps (i.e. the VBI cadence).
+			The models are updated by calling AddFrameStamp (e.g. after every CNTV2Card::AutoCirculateTransfer or
+			CNTV2Card::AutoCirculateGetFrameStamp) and/or AddInterrupt (e.g. after every CNTV2Card::WaitForOutputVerticalInterrupt),
+			none of which perform any register reads or driver calls. Once populated, all conversions are O(1) arithmetic.
+	@note	All host times are expressed in 100-nanosecond units. All public methods are thread-safe.
+**/
+class AJAExport NTV2ClockCorrelator
+{
+	public:
+		/**
+			@brief	Constructs me.
+			@param[in]	inTimeConstant	Specifies the filter time constant, in samples. Defaults to 64.
+		**/
+		explicit				NTV2ClockCorrelator (const ULWord inTimeConstant = 64);
+
+		void					Reset (void);	///< @brief	Forgets everything, reverting all models to their initial state.
+
+		/**
+			@brief		Specifies the nominal frame rate, which is needed to derive the VBI cadence from frame stamps.
+			@param[in]	inFrameRate		Specifies the frame rate of interest.
+			@note		Changing the frame rate resets the VBI model.
+		**/
+		void					SetFrameRate (const NTV2FrameRate inFrameRate);
+
+		/**
+			@brief		Ingests the time stamps from the given FRAME_STAMP.
+			@param[in]	inFrameStamp	Specifies the FRAME_STAMP (e.g. AUTOCIRCULATE_TRANSFER::acTransferStatus.acFrameStamp).
+			@param[in]	inMonoTime		Optionally specifies the host monotonic time (in 100-nanosecond units) when the stamp was
+										retrieved from the driver. Defaults to zero, which samples the host monotonic clock now.
+										Specify -1 to skip updating the host-stamp-to-monotonic model.
+			@return		True if at least one of the stamp's clock pairs was accepted;  otherwise false.
+		**/
+		bool					AddFrameStamp (const FRAME_STAMP & inFrameStamp, const int64_t inMonoTime = 0);
+
+		/**
+			@brief		Ingests a single device-to-host clock sample.
+			@param[in]	inAudioClock	The device 10MHz audio clock value.
+			@param[in]	inHostTime		The driver host time stamp (100-nanosecond units) captured at the same time.
+			@return		True if accepted;  otherwise false.
+		**/
+		bool					AddClockPair (const ULWord64 inAudioClock, const int64_t inHostTime);
+
+		/**
+			@brief		Ingests a vertical interrupt (VBI) sample.
+			@param[in]	inVBICount		The interrupt count (e.g. from CNTV2Card::GetOutputVerticalInterruptCount).
+			@param[in]	inHostTime		The driver host time stamp (100-nanosecond units) of that VBI.
+			@return		True if accepted;  otherwise false.
+		**/
+		bool					AddInterrupt (const ULWord inVBICount, const int64_t inHostTime);
+
+		/**
+			@name	Conversions
+		**/
+		///@{
+		int64_t					AudioClockToHost (const ULWord64 inAudioClock) const;	///< @return	The host time (100ns units) that corresponds to the given device audio clock value.
+		ULWord64				HostToAudioClock (const int64_t inHostTime) const;		///< @return	The device audio clock value that corresponds to the given host time.
+		int64_t					HostToMono (const int64_t inHostTime) const;			///< @return	The host monotonic time that corresponds to the given driver host time stamp.
+		int64_t					MonoToHost (const int64_t inMonoTime) const;			///< @return	The driver host time stamp that corresponds to the given host monotonic time.
+		int64_t					AudioClockToMono (const ULWord64 inAudioClock) const	{return HostToMono(AudioClockToHost(inAudioClock));}	///< @return	The host monotonic time for the given device audio clock value.
+		int64_t					VBIToHost (const ULWord inVBICount) const;				///< @return	The host time of the given VBI (extrapolated if necessary).
+		ULWord					HostToVBI (const int64_t inHostTime) const;				///< @return	The most recent VBI count at or before the given host time.
+		int64_t					NextVBIHostTime (const int64_t inHostTime) const;		///< @return	The host time of the first VBI following the given host time.
+		///@}
+
+		/**
+			@name	Inquiry
+		**/
+		///@{
+		double					AudioClockDriftPPM (void) const;	///< @return	The device audio clock drift relative to the host clock, in parts per million.
+		double					VBIPeriod (void) const;				///< @return	The measured VBI period, in 100ns units (or nominal if not yet locked).
+		bool					IsLocked (void) const;				///< @return	True if the audio-clock-to-host model has locked.
+		NTV2ClockFit			AudioClockModel (void) const;		///< @return	A copy of the device-audio-clock-to-host model.
+		NTV2ClockFit			HostToMonoModel (void) const;		///< @return	A copy of the host-stamp-to-monotonic model.
+		NTV2ClockFit			VBIModel (void) const;				///< @return	A copy of the VBI-count-to-host model.
+		std::ostream &			Print (std::ostream & oss) const;
+		///@}
+
+	private:
+		bool					AddVBITimeLocked (const int64_t inHostTime);
+
+	private:
+		mutable AJALock		mLock;				///< @brief	Guards all my members
+		NTV2ClockFit		mAudioToHost;		///< @brief	X=device audio clock, Y=driver host time
+		NTV2ClockFit		mHostToMono;		///< @brief	X=driver host time, Y=host monotonic time
+		NTV2ClockFit		mVBIToHost;			///< @brief	X=VBI count, Y=driver host time
+		ULWord				mTimeConstant;		///< @brief	Filter time constant
+		double				mNominalVBIPeriod;	///< @brief	Nominal VBI period (100ns units), or zero if unknown
+		int64_t				mLastVBIHostTime;	///< @brief	Most recent VBI host time derived from a frame stamp
+		ULWord				mSynthVBICount;		///< @brief	VBI count synthesized from frame stamps
+		bool				mHaveVBICounts;		///< @brief	True if AddInterrupt was called (disables VBI synthesis)
+};	//	NTV2ClockCorrelator
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2ClockCorrelator & inObj)	{return inObj.Print(oss);}
+
+#endif	//	NTV2CLOCKCORRELATOR_H
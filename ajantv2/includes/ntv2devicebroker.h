@@ -0,0 +1,206 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2devicebroker.h
+	@brief		Declares the NTV2DeviceBroker and NTV2BrokerClient classes.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2DEVICEBROKER_H
+#define NTV2DEVICEBROKER_H
+
+#include "ntv2tcprpc.h"
+
+#define	kNTV2BrokerParamName			"Name"			///< @brief	NTV2DeviceBroker config parameter:  the broker name that clients connect to (required)
+#define	kNTV2BrokerParamSnapshotRegs	"SnapshotRegs"	///< @brief	NTV2DeviceBroker config parameter:  number of registers (from zero) considered for the shared snapshot
+
+struct NTV2BrokerShared;	//	Shared memory layout -- private to ntv2devicebroker.cpp
+
+
+/**
+	@brief	Describes a channel reserved through an NTV2DeviceBroker.
+**/
+struct AJAExport NTV2BrokerReservation
+{
+	NTV2Channel		channel;		///< @brief	The reserved channel
+	std::string		owner;			///< @brief	The owner's name, as given to NTV2BrokerClient::ReserveChannel
+	ULWord			appType;		///< @brief	The owner's application type (four-CC), as given to NTV2BrokerClient::ReserveChannel
+	uint64_t		processID;		///< @brief	The owner's process ID
+	ULWord			connectionID;	///< @brief	The owner's broker connection ID
+
+	NTV2BrokerReservation ()	: channel(NTV2_CHANNEL_INVALID), owner(), appType(0), processID(0), connectionID(0)	{}
+};
+
+typedef std::vector<NTV2BrokerReservation>		NTV2BrokerReservations;
+
+AJAExport std::ostream & operator << (std::ostream & oss, const NTV2BrokerReservation & inReservation);
+
+
+/**
+	@brief	Owns an open device, and shares it with any number of local processes that open "ntv2broker://<name>",
+			so they don't each repeat device discovery and register polling:
+			@code
+				CNTV2Card device;
+				device.Open(0);
+				NTV2ConfigParams config;
+				config.insert(kNTV2BrokerParamName, "capture");
+				NTV2DeviceBroker broker(device, config);
+				broker.Start();		//	Other processes can now open "ntv2broker://capture"
+			@endcode
+			-	Clients talk to the broker over a Unix domain socket (loopback TCP on Windows), using the
+				NTV2TCPServer protocol (pipelined requests, batched register I/O, etc.).
+			-	Once per output vertical interrupt (or every 50 msec if none occur), the broker reads the device's
+				configuration registers into a shared memory snapshot, and clients answer register reads from it
+				without any round trip or system call. A client's own writes are always read back from the device
+				until the snapshot catches up. Volatile registers (status, counters, etc.) and registers that have
+				side-effects when read (see CNTV2DeviceSnapshot::HasReadSideEffects) aren't in the snapshot, so
+				reading them always goes to the device.
+			-	Clients reserve channels through the broker. A reservation is released when its client releases it,
+				disconnects or dies, so there's no need to poll CNTV2Card::AcquireStreamForApplication. Clients can
+				wait for a channel to become free.
+	@note	There's no access control beyond file system permissions on the socket and shared memory.
+**/
+class AJAExport NTV2DeviceBroker : public NTV2TCPServer
+{
+	public:
+		/**
+			@brief		Constructs me to share the given device.
+			@param[in]	inDevice	Specifies the open device to share. It must outlive me.
+			@param[in]	inConfig	Specifies my configuration, which must include ::kNTV2BrokerParamName.
+		**/
+						NTV2DeviceBroker (CNTV2Card & inDevice, const NTV2ConfigParams & inConfig);
+		virtual			~NTV2DeviceBroker ();	///< @brief	My destructor. Stops me.
+
+		/**
+			@brief		Publishes the shared register snapshot, and starts accepting clients.
+			@return		True if successful;  otherwise false.
+		**/
+		bool			Start (void);
+		virtual void	Stop (void);	///< @brief	Disconnects all clients, releases all reservations and withdraws the snapshot.
+
+		inline const std::string &	GetName (void) const		{return mName;}		///< @return	My broker name.
+		ULWord64					GetSnapshotCount (void) const;					///< @return	The number of times I've refreshed the snapshot.
+		NTV2BrokerReservations		GetReservations (void) const;					///< @return	The current channel reservations.
+		virtual std::string			Endpoint (void) const;
+		virtual std::ostream &		Print (std::ostream & oss) const;
+
+		static std::string			SocketPath (const std::string & inName);		///< @return	The Unix domain socket path for the given broker name.
+		static std::string			SharedName (const std::string & inName);		///< @return	The shared memory name for the given broker name.
+		static bool					IsLegalName (const std::string & inName);		///< @return	True if the given broker name is legal (letters, digits, '-', '_' and '.').
+
+	protected:
+		virtual int		OpenListenSocket (UWord & outPort);
+		virtual bool	HandleRequest (const ULWord inConnectionID, const UWord inOpcode, const NTV2_RPC_BLOB_TYPE & inRequest, NTV2_RPC_BLOB_TYPE & outResponse);
+		virtual bool	IsBlockingRequest (const UWord inOpcode) const;
+		virtual void	ConnectionClosed (const ULWord inConnectionID);
+
+	private:
+		NTV2DeviceBroker (const NTV2DeviceBroker & inObj);					//	Not copyable
+		NTV2DeviceBroker & operator = (const NTV2DeviceBroker & inRHS);		//	Not assignable
+		bool			Reserve (const ULWord inConnectionID, const NTV2BrokerReservation & inRequest, const ULWord inTimeoutMs, std::string & outOwner);
+		void			RefreshThread (void);
+		void			RefreshSnapshot (void);
+		static void		RefreshThreadStatic (AJAThread * pThread, void * pContext);
+
+	private:
+		typedef std::map<NTV2Channel, NTV2BrokerReservation>	BrokerReservationMap;
+		std::string				mName;			///< @brief	My broker name
+		NTV2BrokerShared *		mpShared;		///< @brief	Shared snapshot (or NULL)
+		NTV2RegisterReads		mSnapshotRegs;	///< @brief	Registers to snapshot
+		AJAThread				mRefresher;		///< @brief	Refreshes the snapshot
+		bool					mQuitRefresh;	///< @brief	Tells mRefresher to quit
+		bool					mOwnSocket;		///< @brief	True if I created the Unix domain socket file
+		mutable AJALock			mResLock;		///< @brief	Guards mReservations
+		AJAEvent				mReleased;		///< @brief	Signaled when a reservation is released
+		BrokerReservationMap	mReservations;	///< @brief	Current reservations
+};	//	NTV2DeviceBroker
+
+
+/**
+	@brief	An NTV2TCPClient that operates a device owned by an NTV2DeviceBroker in another (or the same) process.
+			NTV2RPCClientAPI::CreateClient instantiates it for the ::kLegalSchemeNTV2Broker URL scheme:
+			@code
+				CNTV2Card device;
+				if (device.Open("ntv2broker://capture"))
+				{
+					NTV2BrokerClient * pBroker (NTV2BrokerClient::FromDevice(device));
+					if (pBroker  &&  pBroker->ReserveChannel(NTV2_CHANNEL2, "monitor", 1000))
+						...
+				}
+			@endcode
+			Configuration register reads are answered from the broker's shared snapshot, so they may be up to one
+			frame old, except for registers this client has written since the snapshot's last refresh. Other register
+			reads go to the device. DMA and AutoCirculate
+			transfers go through a ::kNTV2TCPDefaultSharedMB shared memory segment, unless the URL query's
+			::kQParamTCPSharedMem parameter specifies otherwise (e.g. "ntv2broker://capture/?shm=0").
+**/
+class AJAExport NTV2BrokerClient : public NTV2TCPClient
+{
+	public:
+		/**
+			@brief		Instantiates a new client.
+			@param[in]	inParams	Specifies the connect parameters. ::kConnectParamHost specifies the broker name.
+			@return		A pointer to the new instance, or nullptr upon failure.
+		**/
+		static NTV2BrokerClient *	Create (const NTV2ConnectParams & inParams);
+		static NTV2BrokerClient *	FromDevice (CNTV2Card & inDevice);	///< @return	The given device's broker client, or nullptr if it wasn't opened through a broker.
+		virtual						~NTV2BrokerClient ();
+
+		virtual std::string			Name (void) const;
+
+		/**
+			@name	Channel Reservations
+		**/
+		///@{
+		/**
+			@brief		Reserves the given channel for my exclusive use, until I release it or disconnect.
+			@param[in]	inChannel		Specifies the channel to reserve.
+			@param[in]	inOwner			Specifies my name, as reported to other clients.
+			@param[in]	inTimeoutMs		Optionally specifies how long to wait for another client to release the channel.
+										Defaults to zero (don't wait).
+			@param[in]	inAppType		Optionally specifies my application type (four-CC). Defaults to zero.
+			@return		True if reserved (or already reserved by me);  otherwise false.
+		**/
+		bool			ReserveChannel (const NTV2Channel inChannel, const std::string & inOwner, const ULWord inTimeoutMs = 0, const ULWord inAppType = 0);
+		bool			ReleaseChannel (const NTV2Channel inChannel);					///< @brief	Releases my reservation of the given channel. @return	True if successful.
+		bool			GetReservations (NTV2BrokerReservations & outReservations);	///< @brief	Answers with all current reservations. @return	True if successful.
+		///@}
+
+		/**
+			@name	Register Snapshot
+		**/
+		///@{
+		inline bool		HasSnapshot (void) const		{return mpShared ? true : false;}	///< @return	True if I'm attached to the broker's register snapshot.
+		ULWord64		GetSnapshotCount (void) const;		///< @return	The number of times the broker has refreshed the snapshot.
+		ULWord64		GetSnapshotTime (void) const;		///< @return	The time of the last refresh (AJATime::GetSystemMicroseconds clock).
+		ULWord			GetSnapshotRegCount (void) const;	///< @return	The number of registers (from zero) considered for the snapshot.
+		/**
+			@brief		Reads a register value from the broker's snapshot, without any round trip or system call.
+			@param[in]	inRegNum	Specifies the register.
+			@param[out]	outValue	Receives the register value, as of the last snapshot refresh.
+			@return		True if successful;  false if the register isn't in the snapshot.
+		**/
+		bool			ReadSnapshot (const ULWord inRegNum, ULWord & outValue) const;
+		///@}
+
+	protected:
+						NTV2BrokerClient (const NTV2ConnectParams & inParams);
+		virtual bool	NTV2OpenRemote (void);
+		virtual bool	NTV2CloseRemote (void);
+		virtual int		ConnectSocket (void);
+		virtual bool	ReadLocalRegister (const ULWord inRegNum, ULWord & outValue);
+		virtual void	RegistersWritten (const NTV2RegisterWrites & inWrites);
+
+	private:
+		NTV2BrokerClient (const NTV2BrokerClient & inObj);					//	Not copyable
+		NTV2BrokerClient & operator = (const NTV2BrokerClient & inRHS);		//	Not assignable
+		bool			MapSnapshot (void);
+		void			UnmapSnapshot (void);
+
+	private:
+		typedef std::map<ULWord, ULWord>	RegSequenceMap;
+		NTV2BrokerShared *	mpShared;		///< @brief	Broker's shared snapshot (or NULL)
+		AJALock				mWrittenLock;	///< @brief	Guards mWritten
+		RegSequenceMap		mWritten;		///< @brief	Registers I wrote, mapped to the snapshot sequence that will include them
+};	//	NTV2BrokerClient
+
+#endif	//	NTV2DEVICEBROKER_H
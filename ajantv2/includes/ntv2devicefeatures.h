@@ -21,6 +21,9 @@
 #include "ajatypes.h"
 #include "ntv2enums.h"
 #if defined(__CPLUSPLUS__) || defined(__cplusplus)
+	#if !defined(NTV2_BUILDING_DRIVER)
+		#include <string>
+	#endif
 #elif !defined(NTV2_BUILDING_DRIVER)
 	#define false (0)
 	#define true (!false)
@@ -261,6 +264,27 @@ typedef enum _NTV2EnumsID
 //	The script writes the implementations into 'ntv2devicefeatures.hpp', and the declarations into 'ntv2devicefeatures.hh'...
 #include "ntv2devicefeatures.hh"
 
+#define	NTV2_DEVICE_FEATURE_WORDS(__nBits__)	(((__nBits__) + 31) / 32)
+
+/**
+	@brief	One row of the device feature table. It answers every generated NTV2DeviceCanDo..., NTV2DeviceGetNum...
+			(etc.) function for one device:  bool features are bits in ::bools, numeric features are in ::nums, and
+			the supported items are bitsets indexed by item value. The column order is private to the SDK, so use
+			::NTV2DeviceFeatureRowToString and ::NTV2DeviceFeatureRowFromString to exchange rows between processes.
+**/
+typedef struct NTV2DeviceFeatureRow
+{
+	ULWord	deviceID;			///< @brief	The NTV2DeviceID this row describes
+	ULWord	bools			[NTV2_DEVICE_FEATURE_WORDS(NTV2_DEVICE_FEATURE_NUM_BOOLS)];		///< @brief	Bool features
+	ULWord	nums			[NTV2_DEVICE_FEATURE_NUM_NUMS];									///< @brief	Numeric features
+	ULWord	conversionModes	[NTV2_DEVICE_FEATURE_WORDS(NTV2_NUM_CONVERSIONMODES)];			///< @brief	Supported NTV2ConversionModes
+	ULWord	dskModes		[NTV2_DEVICE_FEATURE_WORDS(NTV2_DSKModeMax)];					///< @brief	Supported NTV2DSKModes
+	ULWord	pixelFormats	[NTV2_DEVICE_FEATURE_WORDS(NTV2_FBF_NUMFRAMEBUFFERFORMATS)];	///< @brief	Supported NTV2PixelFormats
+	ULWord	inputSources	[NTV2_DEVICE_FEATURE_WORDS(NTV2_NUM_INPUTSOURCES)];				///< @brief	Supported NTV2InputSources
+	ULWord	videoFormats	[NTV2_DEVICE_FEATURE_WORDS(NTV2_MAX_NUM_VIDEO_FORMATS)];		///< @brief	Supported NTV2VideoFormats
+	ULWord	widgets			[NTV2_DEVICE_FEATURE_WORDS(NTV2_WgtModuleTypeCount)];			///< @brief	Supported NTV2WidgetIDs
+} NTV2DeviceFeatureRow;
+
 #if defined(__cplusplus) && defined(NTV2_BUILDING_DRIVER)
 extern "C"
 {
@@ -355,6 +379,29 @@ AJAExport NTV2AudioSystem NTV2DeviceGetAudioMixerSystem(const NTV2DeviceID inDev
 AJAExport NTV2AudioSystem NTV2DeviceGetHostAudioSystem(const NTV2DeviceID inDeviceID);	///< @return	The NTV2AudioSystem used for host audio support for the given device (or NTV2_AUDIOSYSTEM_INVALID if there is no host audio system).
 AJAExport bool NTV2DeviceROMHasBankSelect (const NTV2DeviceID inDeviceID);	///< @return	True if the device has SPI flash that incorporates bank selection.
 
+#if (defined(__CPLUSPLUS__) || defined(__cplusplus)) && !defined(NTV2_BUILDING_DRIVER)
+	/**
+		@name	Device Feature Table
+		@brief	Remote and simulated devices can publish their own feature rows. A published row overrides the SDK's
+				built-in row (if any) for its device ID, and answers all of the NTV2DeviceCanDo..., NTV2DeviceGetNum...
+				(etc.) functions for that device ID until it's unpublished.
+	**/
+	///@{
+	AJAExport bool NTV2DeviceGetFeatureRow (const NTV2DeviceID inDeviceID, NTV2DeviceFeatureRow & outRow);	///< @brief	Copies the given device's (published or built-in) feature row. @return	True if successful; false if there's no row for the device.
+	AJAExport bool NTV2DevicePublishFeatureRow (const NTV2DeviceFeatureRow & inRow);	///< @brief	Publishes the given feature row, replacing any previously published for its device ID. @return	True if successful.
+	AJAExport bool NTV2DeviceUnpublishFeatureRow (const NTV2DeviceID inDeviceID);	///< @brief	Withdraws the feature row published for the given device ID. @return	True if successful; false if none was published.
+	AJAExport std::string NTV2DeviceFeatureRowToString (const NTV2DeviceFeatureRow & inRow);	///< @return	The given feature row as text, one "name=value" line per feature.
+	/**
+		@brief		Parses a feature row from text produced by ::NTV2DeviceFeatureRowToString. Unrecognized names are
+					ignored, and features that aren't mentioned are left false/zero/unsupported.
+		@param[in]	inStr		Specifies the text to parse.
+		@param[out]	outRow		Receives the feature row.
+		@return		True if successful;  false if the text has no "DeviceID" line, or a malformed value.
+	**/
+	AJAExport bool NTV2DeviceFeatureRowFromString (const std::string & inStr, NTV2DeviceFeatureRow & outRow);
+	///@}
+#endif	//	C++ && !NTV2_BUILDING_DRIVER
+
 #if defined(__cplusplus) && defined(NTV2_BUILDING_DRIVER)
 }
 #endif
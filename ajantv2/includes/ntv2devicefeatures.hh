@@ -906,7 +906,9 @@ AJAExport bool NTV2DeviceCanDoVideoFormat (const NTV2DeviceID inDeviceID, const
 	@param[in]	inWidgetID		Specifies the NTV2WidgetID.
 **/
 AJAExport bool NTV2DeviceCanDoWidget (const NTV2DeviceID inDeviceID, const NTV2WidgetID inWidgetID);
-#define NTV2DEVICEFEATURES_HH
+
+#define	NTV2_DEVICE_FEATURE_NUM_BOOLS	96	///< @brief	The number of bool columns in an NTV2DeviceFeatureRow
+#define	NTV2_DEVICE_FEATURE_NUM_NUMS	47	///< @brief	The number of numeric columns in an NTV2DeviceFeatureRow
 
 #if defined(__cplusplus) && defined(NTV2_BUILDING_DRIVER)
 }
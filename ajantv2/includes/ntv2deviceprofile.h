@@ -0,0 +1,199 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2deviceprofile.h
+	@brief		Declares the NTV2DeviceProfile class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2DEVICEPROFILE_H
+#define NTV2DEVICEPROFILE_H
+
+#include "ajaexport.h"
+#include "ajatypes.h"
+#include "ntv2publicinterface.h"
+#include "ntv2devicefeatures.h"
+#include "ntv2signalrouter.h"	//	NTV2PossibleConnections
+#include <iostream>
+#include <string>
+#include <map>
+
+class CNTV2DriverInterface;
+
+typedef std::map<ULWord, ULWordSet>		NTV2SupportedItemsMap;		///< @brief	Supported items, keyed by ::NTV2EnumsID
+typedef NTV2SupportedItemsMap::const_iterator	NTV2SupportedItemsMapConstIter;
+typedef std::map<ULWord, std::string>	NTV2RegisterNameMap;		///< @brief	Register display names, keyed by register number
+typedef NTV2RegisterNameMap::const_iterator		NTV2RegisterNameMapConstIter;
+
+
+/**
+	@brief	Everything that CNTV2DriverInterface::IsSupported, CNTV2DriverInterface::GetNumSupported and
+			CNTV2DriverInterface::GetSupportedItems answer for a device, plus its register names (from
+			CNTV2RegisterExpert) and its crosspoint route ROM, all in one object that can be encoded into a
+			single blob, sent to another host, written to disk, and applied to a device in one call.
+			-	Make one from an open device (SetFromDevice), or from just an ::NTV2DeviceID (SetFromDeviceID).
+				The latter lacks register-based features and route ROM, since there's no device to read them from.
+			-	CNTV2DriverInterface::RefreshDeviceCapabilities uses profiles to fill the capability cache of remote
+				and software devices without sending a query for each feature:  it first looks in the on-disk cache
+				(keyed by device ID and firmware version), then asks the remote host for the device's profile in one
+				request (see NTV2RPCClientAPI::NTV2GetDeviceProfileRemote), caching it on disk for next time.
+	@code
+		CNTV2Card device;
+		...
+		NTV2DeviceProfile profile;
+		if (profile.SetFromDevice(device))
+			profile.WriteToFile("kona5.ntv2profile");
+		...
+		NTV2DeviceProfile offline;
+		if (offline.ReadFromFile("kona5.ntv2profile"))
+			cout << offline.GetNumSupported(kDeviceGetNumVideoChannels) << " channels" << endl;
+	@endcode
+**/
+class AJAExport NTV2DeviceProfile
+{
+	public:
+		NTV2DeviceProfile ();					///< @brief	Constructs me empty.
+		void				Clear (void);		///< @brief	Makes me empty.
+		inline bool			IsEmpty (void) const	{return mDeviceID == DEVICE_ID_NOTFOUND;}	///< @return	True if I'm empty.
+
+		/**
+			@name	Creation
+		**/
+		///@{
+		/**
+			@brief		Replaces my contents with everything that's known about the given open device.
+			@param[in]	inDevice	Specifies the open device.
+			@return		True if successful;  otherwise false.
+		**/
+		bool				SetFromDevice (CNTV2DriverInterface & inDevice);
+
+		/**
+			@brief		Replaces my contents with the features the SDK knows for the given device model.
+						Register-based features, the route ROM and the firmware version are omitted.
+			@param[in]	inDeviceID	Specifies the device model.
+			@return		True if successful;  otherwise false.
+		**/
+		bool				SetFromDeviceID (const NTV2DeviceID inDeviceID);
+
+		/**
+			@brief		Reads the given device's firmware version.
+			@param[in]	inDevice	Specifies the open device.
+			@param[out]	outVersion	Receives the firmware version (see GetFirmwareVersion).
+			@return		True if successful;  otherwise false.
+		**/
+		static bool			ReadFirmwareVersion (CNTV2DriverInterface & inDevice, ULWord64 & outVersion);
+
+		/**
+			@return		The firmware version (see GetFirmwareVersion) for the given register values.
+			@param[in]	inBitfileDate	Specifies the ::kRegBitfileDate value.
+			@param[in]	inBitfileTime	Specifies the ::kRegBitfileTime value.
+			@param[in]	inDMAControl	Specifies the ::kRegDMAControl value.
+		**/
+		static ULWord64		MakeFirmwareVersion (const ULWord inBitfileDate, const ULWord inBitfileTime, const ULWord inDMAControl);
+		///@}
+
+		/**
+			@name	Encoding & Files
+		**/
+		///@{
+		bool				Encode (NTV2_RPC_BLOB_TYPE & outBlob) const;		///< @brief	Appends my encoded contents to the given blob.
+		bool				Decode (const NTV2_RPC_BLOB_TYPE & inBlob);			///< @brief	Replaces my contents with the given blob's contents.
+		bool				WriteToFile (const std::string & inFilePath) const;	///< @brief	Writes my encoded contents into the given file.
+		bool				ReadFromFile (const std::string & inFilePath);		///< @brief	Replaces my contents with the given file's contents.
+		///@}
+
+		/**
+			@name	On-Disk Cache
+		**/
+		///@{
+		/**
+			@brief		Writes me into the on-disk cache. Profiles with no firmware version aren't cached, since
+						there's nothing to tell one firmware build from another.
+			@return		True if successful;  otherwise false.
+		**/
+		bool				SaveToCache (void) const;
+
+		/**
+			@brief		Replaces my contents with those of the cached profile for the given device and firmware version.
+			@param[in]	inDeviceID			Specifies the device model.
+			@param[in]	inFirmwareVersion	Specifies the firmware version (see GetFirmwareVersion).
+			@return		True if successful;  otherwise false.
+		**/
+		bool				LoadFromCache (const NTV2DeviceID inDeviceID, const ULWord64 inFirmwareVersion);
+
+		/**
+			@return		The path to the cache file for the given device and firmware version, or empty if caching is disabled.
+			@param[in]	inDeviceID			Specifies the device model.
+			@param[in]	inFirmwareVersion	Specifies the firmware version (see GetFirmwareVersion).
+		**/
+		static std::string	GetCacheFilePath (const NTV2DeviceID inDeviceID, const ULWord64 inFirmwareVersion);
+
+		/**
+			@brief		Changes the folder that holds cached profiles. Caching is disabled by default.
+			@param[in]	inFolderPath	Specifies the path to an existing folder. Specify an empty string to disable caching.
+			@note		Cached profiles are trusted when opening a remote device, so use a folder that only the current user
+						can write to (not a shared temporary folder).
+		**/
+		static void			SetCacheFolder (const std::string & inFolderPath);
+		static std::string	GetCacheFolder (void);	///< @return	The folder that holds cached profiles (empty if caching is disabled).
+		///@}
+
+		/**
+			@name	Inquiry
+		**/
+		///@{
+		inline NTV2DeviceID	GetDeviceID (void) const			{return mDeviceID;}	///< @return	The device model I describe.
+		/**
+			@return		The firmware version I was made from:  the ::kRegBitfileDate BCD date in bits 63-32, the
+						::kRegBitfileTime BCD time in bits 31-8, and the ::kRegDMAControl firmware revision in bits 7-0.
+						Zero if unknown.
+		**/
+		inline ULWord64		GetFirmwareVersion (void) const		{return mFirmwareVersion;}
+		bool				IsSupported (const NTV2BoolParamID inParamID) const;			///< @return	The given boolean feature's value (false if unknown).
+		ULWord				GetNumSupported (const NTV2NumericParamID inParamID) const;	///< @return	The given numeric feature's value (zero if unknown).
+		ULWordSet			GetSupportedItems (const NTV2EnumsID inEnumsID) const;		///< @return	The given supported items (empty if unknown).
+		bool				GetBoolParam (const ULWord inParamID, ULWord & outValue) const;		///< @return	True if I know the given boolean feature.
+		bool				GetNumericParam (const ULWord inParamID, ULWord & outValue) const;	///< @return	True if I know the given numeric feature.
+		bool				GetSupportedItems (const NTV2EnumsID inEnumsID, ULWordSet & outItems) const;	///< @return	True if I know the given supported items.
+		inline const NTV2RegisterValueMap &		GetBoolParams (void) const		{return mBools;}	///< @return	Every boolean feature I know, keyed by ::NTV2BoolParamID.
+		inline const NTV2RegisterValueMap &		GetNumericParams (void) const	{return mNums;}		///< @return	Every numeric feature I know, keyed by ::NTV2NumericParamID.
+		inline const NTV2SupportedItemsMap &	GetSupportedItemsMap (void) const	{return mEnums;}	///< @return	Every supported item set I know, keyed by ::NTV2EnumsID.
+		inline const NTV2RegisterNameMap &		GetRegisterNames (void) const	{return mRegNames;}	///< @return	My register names, keyed by register number.
+		std::string			GetRegisterName (const ULWord inRegNum) const;	///< @return	The given register's name (or empty if unknown).
+		inline const NTV2RegReads &	GetRouteROM (void) const	{return mRouteROM;}	///< @return	My crosspoint route ROM registers (empty if unknown).
+		/**
+			@brief		Answers with the implemented crosspoint connections, as obtained from my route ROM.
+			@param[out]	outConnections	Receives the legal implemented connections/routes.
+			@return		True if successful;  otherwise false.
+		**/
+		bool				GetPossibleConnections (NTV2PossibleConnections & outConnections) const;
+		std::ostream &		Print (std::ostream & oss) const;
+		bool				operator == (const NTV2DeviceProfile & inRHS) const;
+		inline bool			operator != (const NTV2DeviceProfile & inRHS) const	{return !(*this == inRHS);}
+		///@}
+
+		/**
+			@name	Changing
+		**/
+		///@{
+		inline void			SetDeviceID (const NTV2DeviceID inDeviceID)		{mDeviceID = inDeviceID;}
+		inline void			SetFirmwareVersion (const ULWord64 inVersion)	{mFirmwareVersion = inVersion;}
+		inline void			SetBoolParam (const ULWord inParamID, const ULWord inValue)		{mBools[inParamID] = inValue;}
+		inline void			SetNumericParam (const ULWord inParamID, const ULWord inValue)	{mNums[inParamID] = inValue;}
+		inline void			SetSupportedItems (const NTV2EnumsID inEnumsID, const ULWordSet & inItems)	{mEnums[ULWord(inEnumsID)] = inItems;}
+		inline void			SetRegisterNames (const NTV2RegisterNameMap & inNames)	{mRegNames = inNames;}
+		inline void			SetRouteROM (const NTV2RegReads & inROMRegs)			{mRouteROM = inROMRegs;}
+		///@}
+
+	private:
+		NTV2DeviceID			mDeviceID;			///< @brief	Device model
+		ULWord64				mFirmwareVersion;	///< @brief	Firmware date, time & revision (zero if unknown)
+		NTV2RegisterValueMap	mBools;				///< @brief	Boolean features, keyed by NTV2BoolParamID
+		NTV2RegisterValueMap	mNums;				///< @brief	Numeric features, keyed by NTV2NumericParamID
+		NTV2SupportedItemsMap	mEnums;				///< @brief	Supported items, keyed by NTV2EnumsID
+		NTV2RegisterNameMap		mRegNames;			///< @brief	Register names, keyed by register number
+		NTV2RegReads			mRouteROM;			///< @brief	Crosspoint route ROM registers & values
+};	//	NTV2DeviceProfile
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2DeviceProfile & inObj)	{return inObj.Print(oss);}
+
+#endif	//	NTV2DEVICEPROFILE_H
@@ -13,9 +13,12 @@
 	#include "ntv2audiodefines.h"
 #endif	//	!defined(NTV2_DEPRECATE_17_1)
 #include "ntv2card.h"
+#include "ajabase/pnp/pnp.h"
 #include <vector>
 #include <algorithm>
 
+class AJAThread;
+
 //#define VIRTUAL_DEVICES_SUPPORT		0
 
 #if defined(VIRTUAL_DEVICES_SUPPORT)
@@ -307,6 +310,34 @@ public:
 	**/
 	static bool			IsLegalSerialNumber (const std::string & inStr);	//	New in SDK 16.0
 
+	/**
+		@brief		Specifies if scanning the host should probe its devices in parallel, and reuse what was discovered
+					about devices whose index, serial number and firmware haven't changed since the last scan.
+		@note		This also enables CNTV2DriverInterface::SetDiscoveryCache, so that opening any device
+					whose serial number and firmware were already seen skips feature discovery.
+		@param[in]	inParallel	Specify true to probe in parallel and reuse discoveries;  otherwise false (the default).
+	**/
+	static void			SetParallelScan (const bool inParallel);
+	static bool			IsParallelScan (void);	///< @return	True if scans probe devices in parallel and reuse discoveries;  otherwise false.
+
+	/**
+		@brief		Specifies if the lookup functions (e.g. GetDeviceAtIndex, GetFirstDeviceWithID, etc.) should use the
+					result of the last scan instead of rescanning the host every time. When enabled, the host is only
+					rescanned when HotplugCallback reports a change (or if it hasn't been scanned yet).
+		@param[in]	inEnable	Specify true to rescan only upon hotplug;  otherwise false (the default).
+	**/
+	static void			SetHotplugRefresh (const bool inEnable);
+	static bool			GetHotplugRefresh (void);	///< @return	True if the host is only rescanned upon hotplug;  otherwise false.
+
+	/**
+		@brief		An ::AJAPnpCallback that rescans the host when a device is added, removed, goes on-line or off-line,
+					or wakes up. Install it into an AJAPnp instance, typically along with SetHotplugRefresh.
+					With SetParallelScan enabled, the rescan only does full discovery for new or changed devices.
+		@param[in]	inMessage	Specifies the plug-and-play event.
+		@param[in]	inRefCon	Unused.
+	**/
+	static void			HotplugCallback (AJAPnpMessage inMessage, void * inRefCon);
+
 #if !defined(NTV2_DEPRECATE_17_1)
 	static NTV2_DEPRECATED_f(bool IsLegalDecimalNumber (const std::string & inStr, const size_t maxLen = 2)); ///< @deprecated	Use aja::is_legal_decimal_number instead
 	static NTV2_DEPRECATED_f(uint64_t IsLegalHexSerialNumber (const std::string & inStr)); ///< @deprecated	Use aja::is_legal_hex_serial_number instead
@@ -339,6 +370,8 @@ public:
 											NTV2DeviceInfoList & outDevicesRemoved);
 private:
 	static void		SetAudioAttributes (NTV2DeviceInfo & inDeviceInfo, CNTV2Card & inDevice);
+	static bool		ProbeDevice (const UWord inDeviceIndex, NTV2DeviceInfo & outDeviceInfo);	//	False if no device at this index
+	static void		ProbeThread (AJAThread * pThread, void * pContext);
 #if defined(VIRTUAL_DEVICES_SUPPORT)
 	static bool		GetSerialToVirtualDeviceMap(NTV2SerialToVirtualDevices & outSerialToVirtualDevMap);
 	static bool 	GetCP2ConfigPath(string & outCP2ConfigPath);
@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2devicesnapshot.h
+	@brief		Declares the CNTV2DeviceSnapshot class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2DEVICESNAPSHOT_H
+#define NTV2DEVICESNAPSHOT_H
+
+#include "ntv2card.h"
+
+
+/**
+	@brief	A read-only CNTV2Card that answers from a snapshot of a device's registers, captured with one bulk
+			CNTV2DriverInterface::ReadRegisters call (one ::NTV2GetRegisters message). Since every CNTV2Card "Get"
+			function reads its registers through ReadRegister, any of them (e.g. GetVideoFormat, GetFrameBufferFormat,
+			GetMode, GetInputVideoFormat, GetSDITRSError, etc.) can be called on the snapshot, and their answers are
+			consistent with each other, having been sampled at the same instant. This makes refreshing a status display
+			for an entire device cost a single driver call.
+			-	Register writes, DMA, interrupt waits and driver messages all fail.
+			-	Reading a register that wasn't captured fails (and so does the getter that asked for it).
+			-	Call Refresh to re-sample the same registers from the same device.
+	@code
+		CNTV2Card device;
+		...
+		CNTV2DeviceSnapshot snapshot;
+		if (snapshot.Capture(device))
+			for (NTV2Channel ch(NTV2_CHANNEL1);  ch < NTV2_CHANNEL4;  ch = NTV2Channel(ch+1))
+			{
+				NTV2VideoFormat vf;  NTV2PixelFormat pf;
+				snapshot.GetVideoFormat(vf, ch);
+				snapshot.GetFrameBufferFormat(ch, pf);
+				...
+			}
+	@endcode
+**/
+class AJAExport CNTV2DeviceSnapshot : public CNTV2Card
+{
+	public:
+								CNTV2DeviceSnapshot ();		///< @brief	Constructs me empty (and closed).
+		AJA_VIRTUAL				~CNTV2DeviceSnapshot ();	///< @brief	My destructor.
+
+		/**
+			@name	Capture
+		**/
+		///@{
+		/**
+			@brief		Captures the given registers from the given device.
+			@param[in]	inDevice	Specifies the open device to sample. It must outlive me if Refresh is to be called.
+			@param[in]	inRegNums	Optionally specifies the registers to capture. Defaults to empty, which captures
+									all of the device's registers, including virtual registers (see DefaultRegisters).
+			@return		True if successful;  otherwise false.
+		**/
+		AJA_VIRTUAL bool		Capture (CNTV2Card & inDevice, const NTV2RegNumSet & inRegNums = NTV2RegNumSet());
+
+		/**
+			@brief		Re-samples the same registers from the same device as the last successful Capture.
+			@return		True if successful;  otherwise false.
+		**/
+		AJA_VIRTUAL bool		Refresh (void);
+
+		/**
+			@brief		Replaces my contents with the given register values (e.g. previously obtained from
+						GetRegisterValues, or from a support log), without any device involvement.
+			@param[in]	inRegValues		Specifies the register values. Must include ::kRegBoardID.
+			@return		True if successful;  otherwise false.
+		**/
+		AJA_VIRTUAL bool		SetRegisterValues (const NTV2RegisterValueMap & inRegValues);
+
+		/**
+			@return		The registers captured by default for the given device:  all of its real and virtual registers
+						(but not its crosspoint ROM, nor any register that has side-effects when read:  the flash data-out
+						register, and the serial port receive-data registers).
+			@param[in]	inDeviceID	Specifies the device of interest.
+		**/
+		static NTV2RegNumSet	DefaultRegisters (const NTV2DeviceID inDeviceID);
+
+		/**
+			@return		True if reading the given register changes the device's state (e.g. pops a byte from a FIFO).
+			@param[in]	inRegNum	Specifies the register of interest.
+		**/
+		static bool				HasReadSideEffects (const ULWord inRegNum);
+		///@}
+
+		/**
+			@name	Inquiry
+		**/
+		///@{
+		AJA_VIRTUAL inline const NTV2RegisterValueMap &	GetRegisterValues (void) const	{return mRegValues;}	///< @return	The captured register values.
+		AJA_VIRTUAL inline size_t	GetNumRegisters (void) const		{return mRegValues.size();}	///< @return	The number of registers captured.
+		AJA_VIRTUAL inline uint64_t	GetCaptureTime (void) const			{return mCaptureTime;}		///< @return	When the registers were sampled, in AJATime::GetSystemMicroseconds units (or zero if never).
+		AJA_VIRTUAL inline uint64_t	GetCaptureDuration (void) const		{return mCaptureDuration;}	///< @return	How long the capture took, in microseconds.
+		///@}
+
+		/**
+			@name	Overrides
+		**/
+		///@{
+		AJA_VIRTUAL bool		ReadRegister (const ULWord inRegNum, ULWord & outValue, const ULWord inMask = 0xFFFFFFFF, const ULWord inShift = 0);	///< @brief	Answers from the snapshot.
+		AJA_VIRTUAL bool		ReadRegisters (NTV2RegisterReads & inOutValues);	///< @brief	Answers from the snapshot.
+		AJA_VIRTUAL bool		WriteRegister (const ULWord inRegNum, const ULWord inValue, const ULWord inMask = 0xFFFFFFFF, const ULWord inShift = 0);	///< @brief	Always fails.
+		AJA_VIRTUAL bool		NTV2Message (NTV2_HEADER * pInMessage);	///< @brief	Always fails.
+		AJA_VIRTUAL bool		WaitForInterrupt (const INTERRUPT_ENUMS eInterrupt, const ULWord timeOutMs = 68);	///< @brief	Always fails.
+		AJA_VIRTUAL bool		Open (const UWord inDeviceIndex);			///< @brief	Always fails. Use Capture instead.
+		AJA_VIRTUAL bool		Open (const std::string & inURLSpec);		///< @brief	Always fails. Use Capture instead.
+		AJA_VIRTUAL bool		Close (void);	///< @brief	Discards my contents, and forgets my device.
+		///@}
+
+	private:
+		CNTV2DeviceSnapshot (const CNTV2DeviceSnapshot & inObj);				//	Not copyable
+		CNTV2DeviceSnapshot & operator = (const CNTV2DeviceSnapshot & inRHS);	//	Not assignable
+
+		CNTV2Card *				mpDevice;			///< @brief	The device I last captured (not owned)
+		NTV2RegNumSet			mRegNums;			///< @brief	The registers I last captured
+		NTV2RegisterValueMap	mRegValues;			///< @brief	The captured register values
+		uint64_t				mCaptureTime;		///< @brief	When the last capture started
+		uint64_t				mCaptureDuration;	///< @brief	How long the last capture took
+};	//	CNTV2DeviceSnapshot
+
+#endif	//	NTV2DEVICESNAPSHOT_H
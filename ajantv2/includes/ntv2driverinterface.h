@@ -15,9 +15,7 @@
 #include "ntv2publicinterface.h"
 #include "ntv2utils.h"
 #include "ntv2devicefeatures.h"
-#if defined(NTV2_WRITEREG_PROFILING)	//	Register Write Profiling
-	#include "ajabase/system/lock.h"
-#endif	//	NTV2_WRITEREG_PROFILING		Register Write Profiling
+#include "ajabase/system/lock.h"
 #include <string>
 
 //	Check consistent use of AJA_USE_CPLUSPLUS11 and NTV2_USE_CPLUSPLUS11
@@ -54,6 +52,24 @@ typedef struct
 } PACKAGE_INFO_STRUCT, *PPACKAGE_INFO_STRUCT;
 
 
+/**
+	@brief	Describes how the shadow register cache treats a register (see CNTV2DriverInterface::SetRegisterCacheEnable).
+**/
+typedef enum
+{
+	NTV2_REGCACHE_VOLATILE,		///< @brief	Always read from the device (status, counters, interrupt and timecode registers, etc.)
+	NTV2_REGCACHE_CONFIG,		///< @brief	Cached until written, flushed, or the next vertical interrupt (or maximum age) passes
+	NTV2_REGCACHE_STATIC,		///< @brief	Cached until explicitly flushed (e.g. device ID, firmware date/version)
+	NTV2_REGCACHE_INVALID
+} NTV2RegCacheClass;
+
+class NTV2RegCache;	//	Private to ntv2driverinterface.cpp
+class NTV2RegWriteTxn;	//	Private to ntv2driverinterface.cpp
+class NTV2DevCapsCache;	//	Private to ntv2driverinterface.cpp
+class NTV2DriverTrace;	//	See ntv2drivertrace.h
+class NTV2DeviceProfile;	//	See ntv2deviceprofile.h
+
+
 /**
 	@brief	I'm the base class that undergirds the platform-specific derived classes (from which ::CNTV2Card is ultimately derived).
 **/
@@ -80,6 +96,16 @@ class AJAExport CNTV2DriverInterface
 		static void				SetOverlappedMode (const bool inOverlapMode);
 		static bool				GetOverlappedMode (void);	///< @return	True if local devices will be opened in overlapped mode; otherwise false. (New in SDK 16.0)
 
+		/**
+			@brief		Specifies if opening a local device should reuse the features discovered the last time a device with
+						the same serial number and firmware was opened by this process, instead of re-discovering them.
+			@note		CNTV2DeviceScanner::SetParallelScan enables this.
+			@param[in]	inEnable	Specify true to reuse discovered features;  otherwise use false (the default).
+		**/
+		static void				SetDiscoveryCache (const bool inEnable);
+		static bool				GetDiscoveryCache (void);	///< @return	True if local devices reuse previously discovered features; otherwise false.
+		static void				ClearDiscoveryCache (void);	///< @brief	Forgets all previously discovered features.
+
 	/**
 		@name	Construction, destruction, assignment
 	**/
@@ -236,6 +262,84 @@ class AJAExport CNTV2DriverInterface
 		AJA_VIRTUAL inline bool	RestoreHardwareProcampRegisters (void) {return false;}
 	///@}
 
+	/**
+		@name	Shadow Register Cache
+	**/
+	///@{
+		/**
+			@brief		Enables or disables my shadow register cache. When enabled, ReadRegister and ReadRegisters answer
+						from a host-side copy of ::NTV2_REGCACHE_CONFIG and ::NTV2_REGCACHE_STATIC registers, which is
+						updated by WriteRegister and CNTV2Card::WriteRegisters. Config entries go stale when a vertical
+						interrupt is received (see WaitForInterrupt) or when they reach the given maximum age, whichever
+						comes first. Volatile registers are always read from the device. Disabled by default.
+			@param[in]	inEnable			Specify true to enable the cache (discarding its contents);  false to disable it.
+			@param[in]	inMaxAgeMicrosecs	Optionally specifies the maximum age of a config entry, in microseconds.
+											Defaults to 20000 (about one frame at 50Hz). Zero means no age limit.
+			@return		True if successful;  otherwise false.
+			@note		Register writes made by other processes, or by the driver itself, are not seen by the cache
+						until its config entries go stale. Don't enable it if that matters to you.
+		**/
+		AJA_VIRTUAL bool	SetRegisterCacheEnable (const bool inEnable, const ULWord inMaxAgeMicrosecs = 20000);
+		AJA_VIRTUAL bool	IsRegisterCacheEnabled (void) const;	///< @return	True if my shadow register cache is enabled.
+
+		/**
+			@brief		Discards the contents of my shadow register cache.
+			@param[in]	inIncludeStatic		Specify true to also discard ::NTV2_REGCACHE_STATIC entries. Defaults to false.
+		**/
+		AJA_VIRTUAL void	FlushRegisterCache (const bool inIncludeStatic = false);
+
+		/**
+			@brief		Overrides the cache classification of a given register.
+			@param[in]	inRegNum	Specifies the register number of interest.
+			@param[in]	inClass		Specifies its new classification.
+			@return		True if successful;  otherwise false.
+		**/
+		AJA_VIRTUAL bool	SetRegisterCacheClass (const ULWord inRegNum, const NTV2RegCacheClass inClass);
+		AJA_VIRTUAL NTV2RegCacheClass	GetRegisterCacheClass (const ULWord inRegNum) const;	///< @return	The current cache classification of the given register.
+
+		/**
+			@brief		Answers with the hit and miss tallies of my shadow register cache since it was last enabled.
+						(These are also tallied in the ::AJA_DebugStat_RegCacheHit and ::AJA_DebugStat_RegCacheMiss stats.)
+			@param[out]	outHits		Receives the number of register reads answered from the cache.
+			@param[out]	outMisses	Receives the number of cacheable register reads that went to the device.
+			@return		True if the cache is enabled;  otherwise false.
+		**/
+		AJA_VIRTUAL bool	GetRegisterCacheStats (ULWord64 & outHits, ULWord64 & outMisses) const;
+
+		/**
+			@return		The default cache classification of the given register, based on its CNTV2RegisterExpert classes.
+			@param[in]	inRegNum	Specifies the register number of interest.
+		**/
+		static NTV2RegCacheClass	DefaultRegisterCacheClass (const ULWord inRegNum);
+	///@}
+
+	/**
+		@name	Driver Transaction Tracing
+	**/
+	///@{
+		/**
+			@brief		Enables or disables tracing of my driver transactions (register reads and writes, messages, DMA,
+						AutoCirculate and interrupt waits). When enabled, each transaction's arguments, start time, duration
+						and result are recorded into a lock-free ring for the calling thread (see NTV2DriverTrace).
+						Disabled by default, in which case the overhead is a NULL pointer test per transaction.
+			@param[in]	inEnable	Specify true to enable tracing;  false to disable it (discarding all records).
+			@param[in]	inCapacity	Optionally specifies the number of records to retain per thread. Defaults to 4096.
+			@return		True if successful;  otherwise false.
+			@note		Other threads may still be recording into the trace being disabled or replaced (by a larger one),
+						so it's retired rather than deleted, and freed when I'm destroyed. Re-enabling reuses the most
+						recently retired trace, if it's big enough, so toggling tracing doesn't accumulate memory.
+			@see		CNTV2DriverInterface::GetDriverTrace, NTV2DriverTrace
+		**/
+		AJA_VIRTUAL bool	SetDriverTraceEnable (const bool inEnable, const ULWord inCapacity = 4096);	//	New in SDK 17.1
+
+		/**
+			@return		A pointer to my NTV2DriverTrace, or NULL if tracing isn't enabled.
+						Use it to get the records, latency statistics, or a Chrome trace-event (timeline) export.
+			@see		CNTV2DriverInterface::SetDriverTraceEnable
+		**/
+		AJA_VIRTUAL inline NTV2DriverTrace *	GetDriverTrace (void) const	{return mpDriverTrace;}	//	New in SDK 17.1
+	///@}
+
 	/**
 		@name	DMA Transfer
 	**/
@@ -331,6 +435,33 @@ class AJAExport CNTV2DriverInterface
 
 		AJA_VIRTUAL bool	WaitForInterrupt (const INTERRUPT_ENUMS eInterrupt, const ULWord timeOutMs = 68);
 
+		/**
+			@brief		Waits until any of several interrupts happens, then answers with those that fired, their interrupt
+						counts, and the time of their most recent interrupt. This lets one thread service several channels
+						(e.g. all capture and playout VBIs) instead of blocking one thread per interrupt.
+			@param[in,out]	inOutWaitSet	Specifies the interrupts to wait on. Receives which of them fired, and their counts and times.
+											Interrupts that happened since the previous wait with the same set are reported immediately.
+			@param[in]	inTimeoutMs		Specifies the maximum time to wait, in milliseconds. Defaults to 68.
+			@return		True if any interrupt fired;  false upon timeout or failure.
+			@note		Devices and drivers without native support are polled (see GetInterruptCount) every millisecond,
+						in which case the times are when the poll noticed the interrupt.
+		**/
+		AJA_VIRTUAL bool	WaitForAnyInterrupt (NTV2InterruptWaitSet & inOutWaitSet, const ULWord inTimeoutMs = 68);
+
+		/**
+			@brief		Waits for the given interrupt, then answers with the registers and AutoCirculate status requested by
+						the given snapshot, as they were right after the interrupt. This replaces a WaitForInterrupt call
+						followed by ReadRegisters and AutoCirculate status calls with a single driver call.
+			@param[in]	inInterrupt		Specifies the interrupt to wait for.
+			@param[in,out]	inOutSnapshot	Specifies the registers and AutoCirculate channels to capture. Receives their values,
+											the interrupt count and time, and whether they were all captured before another
+											interrupt happened (see NTV2InterruptSnapshot::IsCoherent).
+			@param[in]	inTimeoutMs		Specifies the maximum time to wait, in milliseconds. Defaults to 68.
+			@return		True if the interrupt happened and everything was captured;  false upon timeout or failure.
+			@note		Devices and drivers without native support wait with WaitForInterrupt, then read the values.
+		**/
+		AJA_VIRTUAL bool	WaitForInterruptSnapshot (const INTERRUPT_ENUMS inInterrupt, NTV2InterruptSnapshot & inOutSnapshot, const ULWord inTimeoutMs = 68);
+
 		AJA_VIRTUAL HANDLE	GetInterruptEvent (const INTERRUPT_ENUMS eInterruptType);
 		/**
 			@brief		Answers with the number of interrupt events that I successfully waited for.
@@ -443,6 +574,33 @@ class AJAExport CNTV2DriverInterface
 			@see		vidop-features
 		**/
 		AJA_VIRTUAL ULWordSet	GetSupportedItems (const NTV2EnumsID inEnumsID);	//	New in SDK 17.0
+
+		/**
+			@brief		Re-queries and re-caches every device feature answered by IsSupported, GetNumSupported and
+						GetSupportedItems. This happens automatically when the device is opened. Call it again after anything
+						that changes the device's firmware while it's open (e.g. CNTV2Card::LoadDynamicDevice does this).
+			@return		True if successful;  otherwise false.
+			@note		For remote/software devices, the cache is filled from the device's NTV2DeviceProfile, taken from
+						the on-disk profile cache if it's enabled (see NTV2DeviceProfile::SetCacheFolder), otherwise requested from the remote host in one call. If
+						neither is available, features are cached on first use instead, to avoid sending hundreds of
+						queries to the remote host when opening.
+		**/
+		AJA_VIRTUAL bool		RefreshDeviceCapabilities (void);
+
+		/**
+			@brief		Answers with everything that's known about my device's features, register names and route ROM.
+			@param[out]	outProfile	Receives the NTV2DeviceProfile.
+			@return		True if successful;  otherwise false.
+		**/
+		AJA_VIRTUAL bool		GetDeviceProfile (NTV2DeviceProfile & outProfile);
+
+		/**
+			@brief		Fills my capability cache with the features in the given NTV2DeviceProfile, so that IsSupported,
+						GetNumSupported and GetSupportedItems answer from it.
+			@param[in]	inProfile	Specifies the NTV2DeviceProfile. It must describe my device model.
+			@return		True if successful;  otherwise false.
+		**/
+		AJA_VIRTUAL bool		ApplyDeviceProfile (const NTV2DeviceProfile & inProfile);
 	///@}
 
 		// stream channel operations
@@ -569,6 +727,7 @@ class AJAExport CNTV2DriverInterface
 		AJA_VIRTUAL bool				ReadRP188Registers (const NTV2Channel inChannel, RP188_STRUCT * pRP188Data);
 		AJA_VIRTUAL inline std::string	GetHostName (void) const	{return IsRemote() ? _pRPCAPI->Name() : "";}	///< @return	String containing the remote device host name (if any).
 		AJA_VIRTUAL inline bool			IsRemote (void) const		{return _pRPCAPI ? true : false;}	///< @return	True if I'm connected to a non-local or non-physical device;  otherwise false.
+		AJA_VIRTUAL inline NTV2RPCAPI *	GetRPCAPI (void) const		{return _pRPCAPI;}	///< @return	My remote or software device interface, if any (e.g. for subclass-specific services);  otherwise NULL.
 		/**
 			@return		String containing remote device description.
 		**/
@@ -638,6 +797,9 @@ class AJAExport CNTV2DriverInterface
 		AJA_VIRTUAL bool	ParseFlashHeader (BITFILE_INFO_STRUCT & outBitfileInfo);
 		AJA_VIRTUAL bool	GetBoolParam (const ULWord inParamID,  ULWord & outValue);	//	New in SDK 17.0
 		AJA_VIRTUAL bool	GetNumericParam (const ULWord inParamID,  ULWord & outValue);	//	New in SDK 17.0
+		AJA_VIRTUAL bool	QueryBoolParam (const ULWord inParamID,  ULWord & outValue, const NTV2DeviceID inDeviceID);	///< @brief	Answers a boolean device feature without consulting the capability cache.
+		AJA_VIRTUAL bool	QueryNumericParam (const ULWord inParamID,  ULWord & outValue, const NTV2DeviceID inDeviceID);	///< @brief	Answers a numeric device feature without consulting the capability cache.
+		AJA_VIRTUAL ULWordSet	QuerySupportedItems (const NTV2EnumsID inEnumsID, const NTV2DeviceID inDeviceID);	///< @brief	Answers the supported items without consulting the capability cache.
 
 		/**
 			@brief		Answers with the NTV2RegInfo of the register associated with the given boolean (i.e., "Can Do") device feature.
@@ -666,6 +828,56 @@ class AJAExport CNTV2DriverInterface
 		AJA_VIRTUAL void	FinishOpen (void);
 		AJA_VIRTUAL bool	ReadFlashULWord (const ULWord inAddress, ULWord & outValue, const ULWord inRetryCount = 1000);
 
+		/**
+			@brief		Attempts to answer a register read from my shadow register cache.
+			@param[in]	inRegNum		Specifies the register number of interest.
+			@param[out]	outValue		Receives the masked and shifted register value if it was cached.
+			@param[in]	inMask			Specifies the bit mask.
+			@param[in]	inShift			Specifies the right shift.
+			@param[out]	outCacheable	Receives true if the register is cacheable (or has a pending register write transaction
+										write), in which case the caller should read the entire register from the device
+										(no mask or shift), then call RegCacheFill.
+			@return		True if the value was served from the cache (or pending register write transaction);  otherwise false.
+		**/
+		AJA_VIRTUAL bool	RegCacheRead (const ULWord inRegNum, ULWord & outValue, const ULWord inMask, const ULWord inShift, bool & outCacheable);
+
+		/**
+			@brief		Records an entire register value that was read from the device (if cacheable), overlays any pending
+						register write transaction bits, then applies the caller's mask and shift to it.
+			@param[in]	inReadOK		Specifies the result of the device read.
+			@param[in]	inCacheable		Specifies the "outCacheable" result from RegCacheRead.
+			@param[in]	inRegNum		Specifies the register number of interest.
+			@param		inOutValue		Specifies the entire register value, and receives the masked and shifted value.
+			@param[in]	inMask			Specifies the caller's bit mask.
+			@param[in]	inShift			Specifies the caller's right shift.
+			@return		The given "inReadOK" value.
+		**/
+		AJA_VIRTUAL bool	RegCacheFill (const bool inReadOK, const bool inCacheable, const ULWord inRegNum, ULWord & inOutValue, const ULWord inMask, const ULWord inShift);
+		AJA_VIRTUAL bool	RegCacheWriteThrough (const bool inWriteOK, const ULWord inRegNum, const ULWord inValue, const ULWord inMask = 0xFFFFFFFF, const ULWord inShift = 0);	///< @brief	Updates (or invalidates) the cache after a register write. Returns inWriteOK.
+
+		/**
+			@brief		Opens (or nests) a register write transaction on the calling thread (see CNTV2Card::BeginRegisterWrites).
+			@return		True if successful;  false if another thread has one open.
+		**/
+		AJA_VIRTUAL bool	RegWriteTxnBegin (void);
+
+		/**
+			@brief		Closes one nesting level of the calling thread's register write transaction.
+			@param[in]	inCommit	Specify true to commit;  false to abort (which discards the entire transaction).
+			@param[out]	outWrites	Receives the coalesced writes to be sent to the device, but only when the outermost
+									level is committed. Otherwise it's cleared.
+			@return		True if successful;  false if the calling thread has no transaction open.
+		**/
+		AJA_VIRTUAL bool	RegWriteTxnEnd (const bool inCommit, NTV2RegisterWrites & outWrites);
+
+		/**
+			@brief		If the calling thread has a register write transaction open, coalesces the given write into it.
+			@return		True if the write was taken by the transaction (and must not go to the device);  otherwise false.
+		**/
+		AJA_VIRTUAL bool	RegWriteTxnIntercept (const ULWord inRegNum, const ULWord inValue, const ULWord inMask, const ULWord inShift);
+		AJA_VIRTUAL bool	RegWriteTxnIsOpen (void) const;			///< @return	True if the calling thread has a register write transaction open.
+		AJA_VIRTUAL ULWord	RegWriteTxnNumPending (void) const;		///< @return	The number of coalesced writes in the calling thread's register write transaction.
+
 
 	//	PRIVATE TYPES
 	protected:
@@ -686,6 +898,12 @@ class AJAExport CNTV2DriverInterface
 		NTV2RPCAPI *		_pRPCAPI;				///< @brief	Points to remote or software device interface; otherwise NULL for local physical device.
 		_EventHandles		mInterruptEventHandles;	///< @brief	For subscribing to each possible event, one for each interrupt type
 		_EventCounts		mEventCounts;			///< @brief	My event tallies, one for each interrupt type. Note that these
+		NTV2RegCache *		mpRegCache;				///< @brief	My shadow register cache, if enabled;  otherwise NULL
+		NTV2RegWriteTxn *	mpRegWriteTxn;			///< @brief	My register write transaction state, once one has been opened;  otherwise NULL
+		NTV2DevCapsCache *	mpDevCaps;				///< @brief	My cached device features, once I've been opened;  otherwise NULL
+		NTV2DriverTrace *	mpDriverTrace;			///< @brief	My driver transaction trace, if enabled;  otherwise NULL
+		std::vector<NTV2DriverTrace*>	mRetiredDriverTraces;	///< @brief	Traces replaced by SetDriverTraceEnable, kept until I'm destroyed
+		AJALock				mDriverTraceLock;		///< @brief	Serializes SetDriverTraceEnable calls (guards mRetiredDriverTraces)
 #if defined(NTV2_WRITEREG_PROFILING)
 		NTV2RegisterWrites	mRegWrites;				///< @brief	Stores WriteRegister data
 		mutable AJALock		mRegWritesLock;			///< @brief	Guard mutex for mRegWrites
@@ -0,0 +1,214 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2drivertrace.h
+	@brief		Declares the NTV2DriverTrace class, and its NTV2DriverTraceRecord, NTV2DriverTraceStats and NTV2DriverTraceScope helpers.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2DRIVERTRACE_H
+#define NTV2DRIVERTRACE_H
+
+#include "ajaexport.h"
+#include "ajatypes.h"
+#include "ntv2publicinterface.h"
+#include "ajabase/system/lock.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/**
+	@brief	Identifies the kind of driver transaction an NTV2DriverTraceRecord describes,
+			and the meaning of its three NTV2DriverTraceRecord::fArgs values.
+**/
+typedef enum
+{
+	NTV2_TRACE_READ_REGISTER,		///< @brief	ReadRegister:  register number, mask, value read
+	NTV2_TRACE_WRITE_REGISTER,		///< @brief	WriteRegister:  register number, mask, value written
+	NTV2_TRACE_MESSAGE,				///< @brief	NTV2Message:  message type (four-CC), message size, 0
+	NTV2_TRACE_DMA_READ,			///< @brief	DmaTransfer device-to-host:  DMA engine, frame number, byte count
+	NTV2_TRACE_DMA_WRITE,			///< @brief	DmaTransfer host-to-device:  DMA engine, frame number, byte count
+	NTV2_TRACE_DMA_P2P,				///< @brief	Peer-to-peer DmaTransfer:  DMA engine, frame number, byte count
+	NTV2_TRACE_AUTOCIRCULATE,		///< @brief	AutoCirculate:  ::AUTO_CIRC_COMMAND, ::NTV2Crosspoint (channel spec), 0
+	NTV2_TRACE_WAIT_INTERRUPT,		///< @brief	WaitForInterrupt:  ::INTERRUPT_ENUMS, timeout (msecs), 0
+	NTV2_TRACE_WAIT_ANY_INTERRUPT,	///< @brief	WaitForAnyInterrupt:  interrupt mask, timeout (msecs), fired mask
+	NTV2_TRACE_WAIT_INTERRUPT_SNAPSHOT,	///< @brief	WaitForInterruptSnapshot:  ::INTERRUPT_ENUMS, timeout (msecs), nonzero if coherent
+	NTV2_TRACE_INTERRUPT_COUNT,		///< @brief	GetInterruptCount:  ::INTERRUPT_ENUMS, 0, count
+	NTV2_TRACE_NUM_OPS
+} NTV2DriverTraceOp;
+
+#define NTV2_IS_VALID_TRACE_OP(__op__)	((__op__) >= NTV2_TRACE_READ_REGISTER && (__op__) < NTV2_TRACE_NUM_OPS)
+
+AJAExport std::string NTV2DriverTraceOpToString (const NTV2DriverTraceOp inOp);
+
+
+/**
+	@brief	Describes a single driver transaction. All times are host monotonic clock values
+			(AJATime::GetSystemNanoseconds), in nanoseconds.
+**/
+struct AJAExport NTV2DriverTraceRecord
+{
+	uint64_t			fSequence;	///< @brief	Record number (per thread ring)
+	NTV2DriverTraceOp	fOp;		///< @brief	Kind of transaction
+	uint64_t			fThreadID;	///< @brief	Calling thread (AJAThread::GetThreadId)
+	ULWord64			fArgs[3];	///< @brief	Argument summary (see ::NTV2DriverTraceOp)
+	uint64_t			fStart;		///< @brief	When the transaction started, in host monotonic nanoseconds
+	uint64_t			fDuration;	///< @brief	How long it took, in nanoseconds
+	bool				fSuccess;	///< @brief	True if it succeeded
+
+	explicit inline		NTV2DriverTraceRecord (const NTV2DriverTraceOp inOp = NTV2_TRACE_NUM_OPS, const ULWord64 inArg0 = 0,
+												const ULWord64 inArg1 = 0, const ULWord64 inArg2 = 0)
+							:	fSequence(0), fOp(inOp), fThreadID(0), fStart(0), fDuration(0), fSuccess(false)
+						{
+							fArgs[0] = inArg0;  fArgs[1] = inArg1;  fArgs[2] = inArg2;
+						}
+	std::string			ArgsString (void) const;	///< @return	A human-readable rendition of my arguments.
+	std::ostream &		Print (std::ostream & oss) const;
+};
+typedef std::vector<NTV2DriverTraceRecord>	NTV2DriverTraceRecords;
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2DriverTraceRecord & inObj)	{return inObj.Print(oss);}
+
+
+/**
+	@brief	Latency statistics for one kind of driver transaction, computed from every retained record
+			(unlike the ::AJADebug stat timers, which only keep the most recent few samples).
+**/
+struct AJAExport NTV2DriverTraceStats
+{
+	NTV2DriverTraceOp	fOp;			///< @brief	Kind of transaction
+	ULWord				fCount;			///< @brief	Number of records
+	ULWord				fNumFailures;	///< @brief	Number of failed transactions
+	uint64_t			fTotal;			///< @brief	Total duration, in nanoseconds
+	uint64_t			fP50;			///< @brief	Median duration, in nanoseconds
+	uint64_t			fP99;			///< @brief	99th percentile duration, in nanoseconds
+	uint64_t			fMax;			///< @brief	Maximum duration, in nanoseconds
+	explicit			NTV2DriverTraceStats (const NTV2DriverTraceOp inOp = NTV2_TRACE_NUM_OPS);
+	std::ostream &		Print (std::ostream & oss) const;
+};
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2DriverTraceStats & inObj)	{return inObj.Print(oss);}
+
+
+/**
+	@brief	Opt-in tracing of every driver transaction (register read/write, message, DMA, AutoCirculate and interrupt
+			wait) made through a CNTV2DriverInterface. Enable it by calling CNTV2DriverInterface::SetDriverTraceEnable.
+			Each calling thread records into its own fixed-capacity ring, so recording is lock-free and allocation-free
+			(except for the very first record on each thread). When tracing is disabled, the only cost is a NULL pointer test.
+			Reading (GetRecords, GetStats, WriteChromeTrace) may be done at any time from any thread. Records that are
+			overwritten while being read are skipped.
+**/
+class AJAExport NTV2DriverTrace
+{
+	public:
+		/**
+			@brief	Constructs me.
+			@param[in]	inCapacity	Specifies the number of records to retain per thread. Rounded up to a power of two.
+		**/
+		explicit				NTV2DriverTrace (const ULWord inCapacity = 4096);
+		virtual					~NTV2DriverTrace ();
+
+		/**
+			@brief		Appends the given record to the calling thread's ring. Lock-free.
+			@param[in]	inRecord	The record to append.
+		**/
+		virtual void			Record (const NTV2DriverTraceRecord & inRecord);
+
+		virtual void			Reset (void);	///< @brief	Discards all recorded data.
+		virtual inline ULWord	GetCapacity (void) const	{return mCapacity;}	///< @return	The number of records retained per thread.
+		virtual ULWord			GetNumThreads (void) const;	///< @return	The number of threads that have recorded anything.
+
+		/**
+			@brief		Answers with a copy of every record currently retained, from all threads, in order of start time.
+			@param[out]	outRecords	Receives the records.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			GetRecords (NTV2DriverTraceRecords & outRecords) const;
+
+		/**
+			@brief		Computes latency statistics for the given kind of transaction.
+			@param[in]	inOp		The kind of transaction of interest.
+			@param[out]	outStats	Receives the statistics.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			GetStats (const NTV2DriverTraceOp inOp, NTV2DriverTraceStats & outStats) const;
+
+		/**
+			@brief		Prints latency statistics for every kind of transaction that has any records.
+			@param		oss		The output stream to receive the statistics.
+			@return		A reference to the output stream.
+		**/
+		virtual std::ostream &	Print (std::ostream & oss) const;
+
+		/**
+			@brief		Writes every retained record as Chrome trace-event JSON (viewable in chrome://tracing or Perfetto).
+						Each thread appears as a separate track, and each transaction as a separate slice.
+			@param		oss		The output stream to receive the JSON.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			WriteChromeTrace (std::ostream & oss) const;
+
+		/**
+			@brief		Writes every retained record as Chrome trace-event JSON into the given file.
+			@param[in]	inFilePath	Path to the file to be written.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			WriteChromeTrace (const std::string & inFilePath) const;
+
+	private:
+		struct Ring;
+		Ring *		GetRing (void);
+
+		//	Do not copy!
+								NTV2DriverTrace (const NTV2DriverTrace & inObj);
+		NTV2DriverTrace &		operator = (const NTV2DriverTrace & inRHS);
+
+		enum		{kMaxRings = 64};				///< @brief	Threads past this many share the overflow ring
+		ULWord		mCapacity;						///< @brief	Records per ring (power of 2)
+		Ring * volatile	mRings[kMaxRings + 1];		///< @brief	One ring per thread, plus the overflow ring
+		mutable AJALock	mLock;						///< @brief	Serializes ring creation
+};	//	NTV2DriverTrace
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2DriverTrace & inObj)	{return inObj.Print(oss);}
+
+
+/**
+	@brief	Records an NTV2DriverTraceRecord for a driver transaction for the duration of its scope.
+			Does nothing (and costs next to nothing) if the given trace pointer is NULL. The transaction is
+			recorded as a failure unless Done is called with true.
+**/
+class AJAExport NTV2DriverTraceScope
+{
+	public:
+		/**
+			@brief	Starts timing a transaction.
+			@param[in]	pInTrace	Points to the NTV2DriverTrace to record into. If NULL, I do nothing.
+			@param[in]	inOp		Specifies the kind of transaction.
+			@param[in]	inArg0		Specifies the first argument (see ::NTV2DriverTraceOp).
+			@param[in]	inArg1		Specifies the second argument.
+			@param[in]	inArg2		Specifies the third argument.
+			@param[in]	pInArg2		Optionally points to the third argument, if it's not known until the transaction finishes
+									(e.g. a register value that's read). It's sampled when I'm destroyed.
+		**/
+		inline				NTV2DriverTraceScope (NTV2DriverTrace * pInTrace, const NTV2DriverTraceOp inOp, const ULWord64 inArg0 = 0,
+												const ULWord64 inArg1 = 0, const ULWord64 inArg2 = 0, const ULWord * pInArg2 = AJA_NULL)
+								:	mpTrace(pInTrace), mpArg2(pInArg2)
+							{
+								if (mpTrace)
+									Begin(inOp, inArg0, inArg1, inArg2);
+							}
+		inline				~NTV2DriverTraceScope ()				{if (mpTrace) End();}
+		inline bool			Done (const bool inSuccess)				{if (mpTrace) mRecord.fSuccess = inSuccess;  return inSuccess;}	///< @brief	Records the outcome, and returns it.
+		inline void			SetArg (const int inNdx, const ULWord64 inValue)	{if (mpTrace && inNdx >= 0 && inNdx < 3) mRecord.fArgs[inNdx] = inValue;}	///< @brief	Changes an argument.
+	private:
+		void				Begin (const NTV2DriverTraceOp inOp, const ULWord64 inArg0, const ULWord64 inArg1, const ULWord64 inArg2);
+		void				End (void);
+		NTV2DriverTraceScope (const NTV2DriverTraceScope & inObj);				//	Not copyable
+		NTV2DriverTraceScope & operator = (const NTV2DriverTraceScope & inRHS);	//	Not assignable
+	private:
+		NTV2DriverTrace *		mpTrace;
+		const ULWord *			mpArg2;
+		NTV2DriverTraceRecord	mRecord;
+};	//	NTV2DriverTraceScope
+
+#endif	//	NTV2DRIVERTRACE_H
@@ -0,0 +1,231 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2latencytimeline.h
+	@brief		Declares the NTV2LatencyTimeline class, and its NTV2LatencyRecord and NTV2LatencySummary helpers.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2LATENCYTIMELINE_H
+#define NTV2LATENCYTIMELINE_H
+
+#include "ajaexport.h"
+#include "ntv2publicinterface.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/**
+	@brief	Identifies the per-frame events recorded in an NTV2LatencyRecord.
+**/
+typedef enum
+{
+	NTV2_LATENCY_VBI,			///< @brief	The VBI at which the frame was captured or went on-air (derived from FRAME_STAMP::acFrameTime)
+	NTV2_LATENCY_SUBMIT,		///< @brief	The caller entered the SDK transfer function
+	NTV2_LATENCY_DMA_START,		///< @brief	The SDK called the driver (stamped on the host just before the driver call, not by the DMA engine)
+	NTV2_LATENCY_DMA_END,		///< @brief	The driver returned
+	NTV2_LATENCY_ANC_DONE,		///< @brief	The SDK finished ancillary data/timecode post-processing
+	NTV2_LATENCY_RETURN,		///< @brief	The SDK returned to the caller
+	NTV2_LATENCY_NUM_EVENTS
+} NTV2LatencyEvent;
+
+#define NTV2_IS_VALID_LATENCY_EVENT(__e__)	((__e__) >= NTV2_LATENCY_VBI && (__e__) < NTV2_LATENCY_NUM_EVENTS)
+
+/**
+	@brief	Identifies the kind of operation an NTV2LatencyRecord describes.
+**/
+typedef enum
+{
+	NTV2_LATENCY_KIND_AC_CAPTURE,	///< @brief	CNTV2Card::AutoCirculateTransfer on an input channel
+	NTV2_LATENCY_KIND_AC_PLAYOUT,	///< @brief	CNTV2Card::AutoCirculateTransfer on an output channel
+	NTV2_LATENCY_KIND_DMA_READ,		///< @brief	Non-AutoCirculate DMA read (device-to-host)
+	NTV2_LATENCY_KIND_DMA_WRITE,	///< @brief	Non-AutoCirculate DMA write (host-to-device)
+	NTV2_LATENCY_KIND_INVALID
+} NTV2LatencyKind;
+
+AJAExport std::string NTV2LatencyEventToString (const NTV2LatencyEvent inEvent);
+AJAExport std::string NTV2LatencyKindToString (const NTV2LatencyKind inKind);
+
+
+/**
+	@brief	Describes the timeline of a single frame transfer. All times are host monotonic clock values
+			(AJATime::GetSystemNanoseconds), in nanoseconds. Zero means "not recorded".
+**/
+struct AJAExport NTV2LatencyRecord
+{
+	uint64_t		fSequence;						///< @brief	Monotonically increasing record number (per timeline ring)
+	NTV2LatencyKind	fKind;							///< @brief	Kind of transfer
+	NTV2Channel		fChannel;						///< @brief	AutoCirculate channel (or NTV2_CHANNEL_INVALID for plain DMA)
+	ULWord			fFrame;							///< @brief	Device frame buffer number
+	ULWord			fByteCount;						///< @brief	Number of video bytes transferred
+	bool			fSuccess;						///< @brief	True if the transfer succeeded
+	uint64_t		fTimes[NTV2_LATENCY_NUM_EVENTS];///< @brief	Event times, in host monotonic nanoseconds
+	LWord64			fFrameTime;						///< @brief	FRAME_STAMP::acFrameTime (driver host clock, 100ns units)
+	LWord64			fCurrentTime;					///< @brief	FRAME_STAMP::acCurrentTime (driver host clock, 100ns units)
+	ULWord64		fAudioClockTimeStamp;			///< @brief	FRAME_STAMP::acAudioClockTimeStamp (10MHz ticks)
+	ULWord			fCurrentFrame;					///< @brief	FRAME_STAMP::acCurrentFrame
+	ULWord			fDroppedFrames;					///< @brief	AUTOCIRCULATE_TRANSFER_STATUS::acFramesDropped
+
+	explicit	NTV2LatencyRecord (const NTV2LatencyKind inKind = NTV2_LATENCY_KIND_INVALID, const NTV2Channel inChannel = NTV2_CHANNEL_INVALID);
+	void		Stamp (const NTV2LatencyEvent inEvent);		///< @brief	Records the current host monotonic time for the given event.
+	static uint64_t	Now (void);								///< @return	The current host monotonic time, in nanoseconds.
+
+	/**
+		@brief		Copies the time stamps of interest from the given FRAME_STAMP, and derives the NTV2_LATENCY_VBI event time.
+		@param[in]	inFrameStamp	The FRAME_STAMP that the driver returned.
+		@note		Call this after NTV2_LATENCY_DMA_END has been stamped. Because the driver samples FRAME_STAMP::acCurrentTime
+					immediately before returning, the VBI time is found by subtracting (acCurrentTime - acFrameTime) from the
+					NTV2_LATENCY_DMA_END time, which avoids any need to correlate the driver's clock with the host monotonic clock.
+	**/
+	void		SetFrameStamp (const FRAME_STAMP & inFrameStamp);
+
+	/**
+		@return		The elapsed time, in nanoseconds, between the two given events, or -1 if either wasn't recorded.
+	**/
+	int64_t		Elapsed (const NTV2LatencyEvent inFrom, const NTV2LatencyEvent inTo) const;
+	std::ostream &	Print (std::ostream & oss) const;
+};
+typedef std::vector<NTV2LatencyRecord>	NTV2LatencyRecords;
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2LatencyRecord & inObj)	{return inObj.Print(oss);}
+
+
+/**
+	@brief	Percentile summary of a single timeline stage (i.e. the interval between two NTV2LatencyEvents).
+**/
+struct AJAExport NTV2LatencyStage
+{
+	NTV2LatencyEvent	fFrom;		///< @brief	Starting event
+	NTV2LatencyEvent	fTo;		///< @brief	Ending event
+	ULWord				fCount;		///< @brief	Number of records having both events
+	uint64_t			fP50;		///< @brief	Median, in nanoseconds
+	uint64_t			fP99;		///< @brief	99th percentile, in nanoseconds
+	uint64_t			fMax;		///< @brief	Maximum, in nanoseconds
+	NTV2LatencyStage (const NTV2LatencyEvent inFrom = NTV2_LATENCY_SUBMIT, const NTV2LatencyEvent inTo = NTV2_LATENCY_RETURN);
+};
+typedef std::vector<NTV2LatencyStage>	NTV2LatencyStages;
+
+/**
+	@brief	Percentile summary of all recorded stages for one channel.
+**/
+struct AJAExport NTV2LatencySummary
+{
+	NTV2Channel			fChannel;		///< @brief	The channel (or NTV2_CHANNEL_INVALID for plain DMA)
+	ULWord				fNumRecords;	///< @brief	Number of records summarized
+	ULWord				fNumFailures;	///< @brief	Number of failed transfers
+	NTV2LatencyStages	fStages;		///< @brief	Per-stage statistics
+	NTV2LatencySummary () : fChannel(NTV2_CHANNEL_INVALID), fNumRecords(0), fNumFailures(0)	{}
+	std::ostream &	Print (std::ostream & oss) const;
+};
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2LatencySummary & inObj)	{return inObj.Print(oss);}
+
+
+/**
+	@brief	Opt-in per-frame latency instrumentation for AutoCirculate capture/playout and DMA transfers.
+			Enable it by calling CNTV2Card::SetLatencyTimelineEnable. Thereafter, CNTV2Card::AutoCirculateTransfer and the
+			CNTV2Card DMA functions append an NTV2LatencyRecord for every transfer into a fixed-capacity ring per channel.
+			Recording is lock-free (and allocation-free), and may be done concurrently from any number of threads.
+			Reading (GetRecords, GetSummary, WriteChromeTrace) may be done at any time from any thread. Records that are
+			overwritten while being read are skipped.
+**/
+class AJAExport NTV2LatencyTimeline
+{
+	public:
+		/**
+			@brief	Constructs me.
+			@param[in]	inCapacity	Specifies the number of records to retain per channel. Rounded up to a power of two.
+		**/
+		explicit				NTV2LatencyTimeline (const ULWord inCapacity = 1024);
+		virtual					~NTV2LatencyTimeline ();
+
+		/**
+			@brief		Appends the given record to the ring for its channel. Lock-free.
+			@param[in]	inRecord	The record to append. Records having an invalid channel go into the DMA ring.
+		**/
+		virtual void			Record (const NTV2LatencyRecord & inRecord);
+
+		virtual void			Reset (void);	///< @brief	Discards all recorded data.
+		virtual inline ULWord	GetCapacity (void) const	{return mCapacity;}	///< @return	The number of records retained per channel.
+
+		/**
+			@brief		Answers with a copy of the records currently retained for the given channel, oldest first.
+			@param[in]	inChannel	The channel of interest. Specify NTV2_CHANNEL_INVALID for non-AutoCirculate DMA.
+			@param[out]	outRecords	Receives the records.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			GetRecords (const NTV2Channel inChannel, NTV2LatencyRecords & outRecords) const;
+
+		/**
+			@brief		Computes p50/p99/max statistics for each timeline stage of the given channel.
+			@param[in]	inChannel	The channel of interest. Specify NTV2_CHANNEL_INVALID for non-AutoCirculate DMA.
+			@param[out]	outSummary	Receives the summary.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			GetSummary (const NTV2Channel inChannel, NTV2LatencySummary & outSummary) const;
+
+		/**
+			@brief		Prints a summary of every channel that has any records.
+			@param		oss		The output stream to receive the summary.
+			@return		A reference to the output stream.
+		**/
+		virtual std::ostream &	Print (std::ostream & oss) const;
+
+		/**
+			@brief		Writes every retained record as Chrome trace-event JSON (viewable in chrome://tracing or Perfetto).
+						Each channel appears as a separate track, and each stage of every frame as a separate slice.
+			@param		oss		The output stream to receive the JSON.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			WriteChromeTrace (std::ostream & oss) const;
+
+		/**
+			@brief		Writes every retained record as Chrome trace-event JSON into the given file.
+			@param[in]	inFilePath	Path to the file to be written.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool			WriteChromeTrace (const std::string & inFilePath) const;
+
+		/**
+			@return		The default stages that GetSummary reports on.
+		**/
+		static NTV2LatencyStages	DefaultStages (void);
+
+	private:
+		struct Ring;
+		Ring *		GetRing (const NTV2Channel inChannel) const;
+
+		//	Do not copy!
+								NTV2LatencyTimeline (const NTV2LatencyTimeline & inObj);
+		NTV2LatencyTimeline &	operator = (const NTV2LatencyTimeline & inRHS);
+
+		ULWord		mCapacity;							///< @brief	Records per ring (power of 2)
+		Ring *		mRings[NTV2_MAX_NUM_CHANNELS + 1];	///< @brief	One ring per channel, plus one for plain DMA
+};	//	NTV2LatencyTimeline
+
+inline std::ostream & operator << (std::ostream & oss, const NTV2LatencyTimeline & inObj)	{return inObj.Print(oss);}
+
+
+/**
+	@brief	Records an NTV2LatencyRecord for a plain DMA transfer for the duration of its scope.
+			Does nothing (and builds no record) if the given timeline pointer is NULL.
+	@note	The SDK has no pre-processing for plain DMA, so NTV2_LATENCY_DMA_START is the same as NTV2_LATENCY_SUBMIT:
+			both are stamped when I'm constructed, just before the driver is called. Likewise, NTV2_LATENCY_DMA_END and
+			NTV2_LATENCY_RETURN are both stamped when I'm destroyed.
+**/
+class AJAExport NTV2LatencyScope
+{
+	public:
+		NTV2LatencyScope (NTV2LatencyTimeline * pInTimeline, const bool inIsRead, const ULWord inFrame, const ULWord inByteCount);
+		~NTV2LatencyScope ();
+		inline bool		Done (const bool inSuccess)		{mSuccess = inSuccess;  return inSuccess;}	///< @brief	Records the outcome, and returns it.
+	private:
+		NTV2LatencyTimeline *	mpTimeline;
+		bool					mIsRead;
+		bool					mSuccess;
+		ULWord					mFrame;
+		ULWord					mByteCount;
+		uint64_t				mStartTime;
+};	//	NTV2LatencyScope
+
+#endif	//	NTV2LATENCYTIMELINE_H
@@ -21,6 +21,8 @@ typedef std::vector<NTV2DeviceIDSerialPair>		NTV2DeviceIDSerialPairs;	///< @brie
 typedef NTV2DeviceIDSerialPairs::iterator		NTV2DeviceIDSerialPairsIter;
 typedef NTV2DeviceIDSerialPairs::const_iterator	NTV2DeviceIDSerialPairsConstIter;
 
+class NTV2DeviceProfile;	//	See ntv2deviceprofile.h
+
 //	Supported NTV2ConnectParams:
 #define	kConnectParamScheme		"Scheme"		///< @brief	URL scheme
 #define	kConnectParamHost		"Host"			///< @brief	DNS name, IPv4 or sw device DLL name
@@ -42,6 +44,9 @@ typedef NTV2DeviceIDSerialPairs::const_iterator	NTV2DeviceIDSerialPairsConstIter
 //	Local URL schemes:
 #define	kLegalSchemeNTV2		"ntv2"
 #define	kLegalSchemeNTV2Local	"ntv2local"
+#define	kLegalSchemeNTV2Sim		"ntv2sim"		///< @brief	Software-simulated device (see ::NTV2SimulatedDevice)
+#define	kLegalSchemeNTV2TCP		"ntv2tcp"		///< @brief	Device served by an ::NTV2TCPServer (see ::NTV2TCPClient)
+#define	kLegalSchemeNTV2Broker	"ntv2broker"	///< @brief	Device shared by a local ::NTV2DeviceBroker (see ::NTV2BrokerClient)
 
 //	Exported Function Names:
 #define	kFuncNameCreateClient	"CreateClient"			///< @brief	Create an NTV2RPCClientAPI instance
@@ -299,6 +304,7 @@ class AJAExport NTV2RPCClientAPI : public NTV2RPCBase
 		virtual bool	NTV2WriteRegisterRemote	(const ULWord regNum, const ULWord regValue, const ULWord regMask, const ULWord regShift);
 		virtual bool	NTV2AutoCirculateRemote	(AUTOCIRCULATE_DATA & autoCircData);
 		virtual bool	NTV2WaitForInterruptRemote	(const INTERRUPT_ENUMS eInterrupt, const ULWord timeOutMs);
+		virtual bool	NTV2WaitForAnyInterruptRemote	(NTV2InterruptWaitSet & inOutWaitSet, const ULWord timeOutMs);	///< @brief	See CNTV2DriverInterface::WaitForAnyInterrupt. (Unimplemented by default)
 		virtual	bool	NTV2DMATransferRemote		(const NTV2DMAEngine inDMAEngine,	const bool inIsRead,
 													const ULWord inFrameNumber,			NTV2Buffer & inOutBuffer,
 													const ULWord inCardOffsetBytes,		const ULWord inNumSegments,
@@ -314,6 +320,7 @@ class AJAExport NTV2RPCClientAPI : public NTV2RPCBase
 		virtual bool	NTV2GetBoolParamRemote (const ULWord inParamID,  ULWord & outValue);	//	New in SDK 17.0
 		virtual bool	NTV2GetNumericParamRemote (const ULWord inParamID,  ULWord & outValue);	//	New in SDK 17.0
 		virtual bool	NTV2GetSupportedRemote (const ULWord inEnumsID, ULWordSet & outSupported);	//	New in SDK 17.0
+		virtual bool	NTV2GetDeviceProfileRemote (NTV2DeviceProfile & outProfile);	///< @brief	Answers every device feature at once. (Unimplemented by default)
 		///@}
 
 		/**
@@ -3810,6 +3810,9 @@ typedef enum _INTERRUPT_ENUMS_
 											||	(__e__) == eOutput7		\
 											||	(__e__) == eOutput8 )
 
+#define NTV2_INTERRUPT_SNAPSHOT_MAX_REGISTERS		64	//	Registers captured by one CNTV2DriverInterface::WaitForInterruptSnapshot call
+#define NTV2_INTERRUPT_SNAPSHOT_MAX_AUTOCIRCULATE	8	//	AutoCirculate channels captured by one CNTV2DriverInterface::WaitForInterruptSnapshot call
+
 
 // Some Mac only ENUMS that had to be moved over to get Win/Linux code to compile,
 // so these are only used by the Mac.
@@ -3922,6 +3925,83 @@ typedef enum
 		@return		An NTV2AudioSystemSet having the specified contiguous range of NTV2AudioSystems.
 	**/
 	AJAExport NTV2AudioSystemSet NTV2MakeAudioSystemSet (const NTV2AudioSystem inFirstAudioSystem, const UWord inCount = 1);	//	New in SDK 16.2
+
+	/**
+		@brief	A set of interrupt sources to wait on all at once (see CNTV2DriverInterface::WaitForAnyInterrupt), which
+				also receives which of them fired, their interrupt counts, and the time of their most recent interrupt.
+				A source fires when its interrupt count changes from what it was at the end of the previous wait
+				(or, for newly-added sources, at the start of the wait), so no interrupt is lost between waits.
+		@code
+			NTV2InterruptWaitSet waitSet;
+			waitSet.Add(eOutput1).Add(eInput1).Add(eInput2);
+			while (device.WaitForAnyInterrupt(waitSet))
+			{
+				if (waitSet.HasFired(eInput1))
+					CaptureFrame(NTV2_CHANNEL1, waitSet.GetTime(eInput1));
+				if (waitSet.HasFired(eInput2))
+					CaptureFrame(NTV2_CHANNEL2, waitSet.GetTime(eInput2));
+				if (waitSet.HasFired(eOutput1))
+					PlayFrame(NTV2_CHANNEL1);
+			}
+		@endcode
+	**/
+	class AJAExport NTV2InterruptWaitSet
+	{
+		public:
+			NTV2InterruptWaitSet ();	///< @brief	Constructs me empty.
+
+			/**
+				@name	Sources
+			**/
+			///@{
+			NTV2InterruptWaitSet &	Add (const INTERRUPT_ENUMS inInterrupt);	///< @brief	Adds the given interrupt source, if valid. @return	A reference to me.
+			NTV2InterruptWaitSet &	Remove (const INTERRUPT_ENUMS inInterrupt);	///< @brief	Removes the given interrupt source. @return	A reference to me.
+			void					Clear (void);								///< @brief	Removes all interrupt sources and results.
+			inline bool				Contains (const INTERRUPT_ENUMS inInterrupt) const	{return (mMask & Bit(inInterrupt)) != 0;}	///< @return	True if I contain the given interrupt source.
+			inline bool				IsEmpty (void) const			{return !mMask;}		///< @return	True if I have no interrupt sources.
+			inline ULWord64			GetMask (void) const			{return mMask;}			///< @return	My interrupt sources, one bit per ::INTERRUPT_ENUMS value.
+			std::vector<INTERRUPT_ENUMS>	GetSources (void) const;					///< @return	My interrupt sources, in ascending order.
+			///@}
+
+			/**
+				@name	Results of the last wait
+			**/
+			///@{
+			inline bool				HasFired (const INTERRUPT_ENUMS inInterrupt) const	{return (mFiredMask & Bit(inInterrupt)) != 0;}	///< @return	True if the given interrupt source fired during the last wait.
+			inline ULWord64			GetFiredMask (void) const		{return mFiredMask;}	///< @return	The interrupt sources that fired during the last wait, one bit per ::INTERRUPT_ENUMS value.
+			std::vector<INTERRUPT_ENUMS>	GetFired (void) const;						///< @return	The interrupt sources that fired during the last wait, in ascending order.
+			ULWord64				GetCount (const INTERRUPT_ENUMS inInterrupt) const;	///< @return	The given source's interrupt count as of the last wait, or zero if unknown.
+			ULWord64				GetTime (const INTERRUPT_ENUMS inInterrupt) const;	///< @return	The time of the given source's most recent interrupt (100ns units, same clock as FRAME_STAMP), or zero if unknown.
+			///@}
+
+			/**
+				@name	For CNTV2DriverInterface implementations
+			**/
+			///@{
+			inline bool				HasBaseline (const INTERRUPT_ENUMS inInterrupt) const	{return (mBaselineMask & Bit(inInterrupt)) != 0;}	///< @return	True if GetCount holds the given source's count from a previous wait.
+			inline ULWord64			GetBaselineMask (void) const	{return mBaselineMask;}	///< @return	The sources whose counts are known from a previous wait.
+			void					StartWait (void);		///< @brief	Clears my fired sources before a wait.
+			/**
+				@brief		Records a source's interrupt count and time. If the count differs from the count recorded by a previous
+							wait, the source is marked as fired.
+				@param[in]	inInterrupt		Specifies the interrupt source.
+				@param[in]	inCount			Specifies the source's current interrupt count.
+				@param[in]	inTime			Specifies the time of the source's most recent interrupt (100ns units), or zero if unknown.
+				@return		True if the source fired.
+			**/
+			bool					SetResult (const INTERRUPT_ENUMS inInterrupt, const ULWord64 inCount, const ULWord64 inTime);
+			///@}
+
+		private:
+			static inline ULWord64	Bit (const INTERRUPT_ENUMS inInterrupt)	{return NTV2_IS_VALID_INTERRUPT_ENUM(inInterrupt) ? ULWord64(1) << inInterrupt : 0;}
+			ULWord64	mMask;							///< @brief	Sources to wait on
+			ULWord64	mFiredMask;						///< @brief	Sources that fired during the last wait
+			ULWord64	mBaselineMask;					///< @brief	Sources whose mCounts are valid
+			ULWord64	mCounts[eNumInterruptTypes];	///< @brief	Per-source interrupt count as of the last wait
+			ULWord64	mTimes[eNumInterruptTypes];		///< @brief	Per-source time of most recent interrupt
+	};	//	NTV2InterruptWaitSet
+
+	AJAExport std::ostream & operator << (std::ostream & oss, const NTV2InterruptWaitSet & inObj);	///< @brief	Streams the given NTV2InterruptWaitSet in human-readable form.
 #endif	//	!defined (NTV2_BUILDING_DRIVER)
 
 
@@ -5502,6 +5582,9 @@ typedef enum
 													(_x_) == NTV2_TYPE_AJASTREAMCHANNEL	||	\
 													(_x_) == NTV2_TYPE_AJASTREAMBUFFER)
 
+		#define NTV2_MAX_NUM_SETREGS			(4096 / (4 * sizeof(ULWord)))	///< @brief Most registers one NTV2SetRegisters message can write (drivers limit its NTV2RegInfo array to a 4KB page)
+		#define NTV2_MAX_NUM_GETREGS			(4096 / sizeof(ULWord))			///< @brief Most registers one NTV2GetRegisters message can read (drivers limit each of its arrays to a 4KB page)
+
 		//	NTV2Buffer FLAGS
 		#define NTV2Buffer_ALLOCATED				BIT(0)		///< @brief Allocated using Allocate function?
 		#define NTV2Buffer_PAGE_ALIGNED				BIT(1)		///< @brief Allocated page-aligned?
@@ -7506,6 +7589,8 @@ typedef enum
 				NTV2_RPC_CODEC_DECLS
 				NTV2_IS_STRUCT_VALID_IMPL(mHeader,mTrailer)
 
+				friend class NTV2TCPClient;		//	Fills in my results from a remote register batch
+
 				NTV2_BEGIN_PRIVATE
 					inline explicit				NTV2GetRegisters (const NTV2GetRegisters & inObj)	:	mHeader(0xFEFEFEFE, 0), mInRegisters(0), mOutGoodRegisters(0), mOutValues(0)
 																									{(void) inObj;}					///< @brief You cannot construct an NTV2GetRegisters from another.
@@ -9228,6 +9313,85 @@ typedef enum
 				@return The ostream being used.
 			**/
 			AJAExport inline std::ostream & operator << (std::ostream & inOutStream, const NTV2BufferLock & inObj)	{return inObj.Print (inOutStream);}
+
+			typedef std::set <NTV2Crosspoint>				NTV2CrosspointSet;			///< @brief A set of distinct NTV2Crosspoint values.
+
+			/**
+				@brief	A bundle of registers and AutoCirculate channels to capture as soon as an interrupt fires, and the values
+						captured by the last wait (see CNTV2DriverInterface::WaitForInterruptSnapshot). Per-frame code that
+						needs a few status registers and its AutoCirculate status after each VBI gets them all from the wait
+						itself, instead of following every wait with ReadRegister and AutoCirculateGetStatus calls.
+				@code
+					NTV2InterruptSnapshot snapshot;
+					snapshot.AddRegister(kRegInput1FrameBuffer).AddAutoCirculate(NTV2CROSSPOINT_INPUT1);
+					while (device.WaitForInputVerticalInterrupt(NTV2_CHANNEL1, snapshot))
+					{
+						AUTOCIRCULATE_STATUS acStatus;
+						ULWord frameNum (0);
+						if (snapshot.GetAutoCirculateStatus(NTV2CROSSPOINT_INPUT1, acStatus)
+							&&  snapshot.GetRegisterValue(kRegInput1FrameBuffer, frameNum))
+								TrackFrame(acStatus, frameNum, snapshot.IsCoherent());
+					}
+				@endcode
+			**/
+			class AJAExport NTV2InterruptSnapshot
+			{
+				public:
+					NTV2InterruptSnapshot ();	///< @brief	Constructs me empty.
+
+					/**
+						@name	What to capture
+					**/
+					///@{
+					NTV2InterruptSnapshot &	AddRegister (const ULWord inRegNum);			///< @brief	Adds the given register, unless I'm full (see ::NTV2_INTERRUPT_SNAPSHOT_MAX_REGISTERS). @return	A reference to me.
+					NTV2InterruptSnapshot &	AddRegisters (const NTV2RegNumSet & inRegNums);	///< @brief	Adds the given registers, until I'm full. @return	A reference to me.
+					NTV2InterruptSnapshot &	AddAutoCirculate (const NTV2Crosspoint inCrosspoint);	///< @brief	Adds the given AutoCirculate channel, if valid, unless I'm full (see ::NTV2_INTERRUPT_SNAPSHOT_MAX_AUTOCIRCULATE). @return	A reference to me.
+					void					Clear (void);									///< @brief	Removes all registers, AutoCirculate channels and results.
+					inline const NTV2RegNumSet &		GetRegisters (void) const		{return mRegNums;}		///< @return	The registers I capture.
+					inline const NTV2CrosspointSet &	GetAutoCirculates (void) const	{return mCrosspoints;}	///< @return	The AutoCirculate channels I capture.
+					///@}
+
+					/**
+						@name	Results of the last wait
+					**/
+					///@{
+					bool					GetRegisterValue (const ULWord inRegNum, ULWord & outValue) const;	///< @brief	Answers with the given register's captured value. @return	True if it was captured.
+					inline const NTV2RegisterValueMap &	GetRegisterValues (void) const	{return mValues;}	///< @return	All captured register values.
+					bool					GetAutoCirculateStatus (const NTV2Crosspoint inCrosspoint, AUTOCIRCULATE_STATUS & outStatus) const;	///< @brief	Answers with the given AutoCirculate channel's captured status. @return	True if it was captured.
+					inline INTERRUPT_ENUMS	GetInterrupt (void) const		{return mInterrupt;}	///< @return	The interrupt that was waited on.
+					inline ULWord64			GetInterruptCount (void) const	{return mCount;}		///< @return	The interrupt count when the values were captured.
+					inline ULWord64			GetInterruptTime (void) const	{return mTime;}			///< @return	The time of the interrupt (100ns units, same clock as FRAME_STAMP), or when the wait returned if the driver can't tell.
+					/**
+						@return		True if no further interrupt of the same kind happened while the values were being captured,
+									i.e. they all describe the same frame (or field). If false, they may straddle two frames, or the
+									driver couldn't tell (e.g. remote devices, which can't report interrupt counts).
+					**/
+					inline bool				IsCoherent (void) const			{return mCoherent;}
+					///@}
+
+					/**
+						@name	For CNTV2DriverInterface implementations
+					**/
+					///@{
+					void					StartCapture (const INTERRUPT_ENUMS inInterrupt);	///< @brief	Discards my results before a wait on the given interrupt.
+					void					SetRegisterValue (const ULWord inRegNum, const ULWord inValue);	///< @brief	Records the given register's captured value.
+					bool					SetAutoCirculateStatus (const AUTOCIRCULATE_STATUS & inStatus);	///< @brief	Records the captured status of its AutoCirculate channel. @return	True if successful.
+					void					SetInterrupt (const ULWord64 inCount, const ULWord64 inTime, const bool inCoherent);	///< @brief	Records the interrupt count and time, and whether the capture was coherent.
+					///@}
+
+				private:
+					typedef std::map <NTV2Crosspoint, AUTOCIRCULATE_STATUS>	ACStatusMap;
+					NTV2RegNumSet			mRegNums;		///< @brief	Registers to capture
+					NTV2CrosspointSet		mCrosspoints;	///< @brief	AutoCirculate channels to capture
+					NTV2RegisterValueMap	mValues;		///< @brief	Captured register values
+					ACStatusMap				mStatuses;		///< @brief	Captured AutoCirculate status
+					INTERRUPT_ENUMS			mInterrupt;		///< @brief	Interrupt waited on
+					ULWord64				mCount;			///< @brief	Interrupt count at capture
+					ULWord64				mTime;			///< @brief	Interrupt time
+					bool					mCoherent;		///< @brief	No interrupt happened during capture?
+			};	//	NTV2InterruptSnapshot
+
+			AJAExport std::ostream & operator << (std::ostream & oss, const NTV2InterruptSnapshot & inObj);	///< @brief	Streams the given NTV2InterruptSnapshot in human-readable form.
 		#endif	//	!defined (NTV2_BUILDING_DRIVER)
 
 		#if defined (AJAMac)
@@ -0,0 +1,138 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2registerpreset.h
+	@brief		Declares the NTV2RegisterPreset class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2REGISTERPRESET_H
+#define NTV2REGISTERPRESET_H
+
+#include "ntv2devicesnapshot.h"
+
+
+/**
+	@brief	A recallable device setup ("scene" or "show preset"), compiled from register writes recorded with
+			CNTV2DriverInterface::StartRecordRegisterWrites and CNTV2DriverInterface::GetRecordedRegisterWrites.
+			Recalling it is much faster than re-running the configuration code that produced the recording:
+			-	Compile collapses the recording into at most one masked write per configuration register, the same way
+				a register write transaction does (see CNTV2Card::BeginRegisterWrites). Writes to status, counter and
+				side-effect registers, and zero-mask writes, are kept as recorded, in order.
+			-	Apply reads the live values of those registers from the device in one bulk read, drops every write that
+				wouldn't change anything, waits for the next output vertical interrupt, and sends what's left in a single
+				CNTV2Card::WriteRegisters call (one ::NTV2SetRegisters message).
+			-	Save and Load persist it in a compact binary file.
+	@code
+		//	Record the setup once...
+		device.StartRecordRegisterWrites(true);	//	Record without writing
+		ConfigureShowPresetA(device);
+		device.StopRecordRegisterWrites();
+		NTV2RegisterWrites recording;
+		device.GetRecordedRegisterWrites(recording);
+		NTV2RegisterPreset preset;
+		preset.Compile(recording, device.GetDeviceID());
+		preset.Save("presetA.ntv2preset");
+
+		//	Recall it later...
+		NTV2RegisterPreset presetA;
+		if (presetA.Load("presetA.ntv2preset"))
+			presetA.Apply(device);
+	@endcode
+	@note	Collapsing assumes the order of writes to different configuration registers doesn't matter. Don't record
+			setups that program indirectly-addressed tables through a configuration register (e.g. LUT plane select).
+**/
+class AJAExport NTV2RegisterPreset
+{
+	public:
+		NTV2RegisterPreset ();		///< @brief	Constructs me empty.
+
+		/**
+			@name	Compiling
+		**/
+		///@{
+		/**
+			@brief		Replaces my contents with the given recorded register writes, collapsed (see Collapse).
+			@param[in]	inRecording		Specifies the recorded register writes.
+			@param[in]	inDeviceID		Specifies the device model the writes were recorded from. Apply will refuse
+										to write any other model. Specify ::DEVICE_ID_NOTFOUND to allow any model.
+			@return		True if successful;  otherwise false.
+		**/
+		bool						Compile (const NTV2RegisterWrites & inRecording, const NTV2DeviceID inDeviceID);
+
+		/**
+			@brief		Computes the minimal writes needed to bring a device from the state in the given snapshot to my state.
+			@param[in]	inLive		Specifies a snapshot of the device's registers (see CaptureLive). Writes to registers
+									that weren't captured are always kept.
+			@param[out]	outDelta	Receives the writes that would change something, in my order.
+			@return		True if successful;  otherwise false.
+		**/
+		bool						ComputeDelta (const CNTV2DeviceSnapshot & inLive, NTV2RegisterWrites & outDelta) const;
+
+		/**
+			@brief		Captures the current values of the configuration registers I write, in one bulk read.
+			@param[in]	inDevice	Specifies the open device to sample.
+			@param[out]	outLive		Receives the snapshot.
+			@return		True if successful;  otherwise false.
+		**/
+		bool						CaptureLive (CNTV2Card & inDevice, CNTV2DeviceSnapshot & outLive) const;
+
+		/**
+			@brief		Collapses the given register writes into at most one masked write per configuration register.
+			@param[in]	inWrites	Specifies the register writes to collapse.
+			@note		Writes to non-configuration registers (and zero-mask writes) are kept as-is, and act as barriers:
+						no later write is merged into a write made before them.
+			@return		The collapsed writes, ordered by each register's first write since the last barrier.
+		**/
+		static NTV2RegisterWrites	Collapse (const NTV2RegisterWrites & inWrites);
+		///@}
+
+		/**
+			@name	Recall
+		**/
+		///@{
+		/**
+			@brief		Brings the given device to my state:  captures its live register values, computes the delta,
+						then writes it in one batch, optionally just after an output vertical interrupt.
+			@param[in]	inDevice		Specifies the open device to write.
+			@param[in]	inWaitForVBI	Specify true (the default) to wait for the next output vertical interrupt
+										before writing, so the changes take effect in the same frame.
+			@param[in]	inVBIChannel	Specifies the output channel whose vertical interrupt to wait for.
+										Defaults to ::NTV2_CHANNEL1.
+			@param[out]	pOutDelta		Optionally specifies an NTV2RegisterWrites that receives the writes that were sent.
+			@return		True if successful;  otherwise false.
+		**/
+		bool						Apply (CNTV2Card & inDevice, const bool inWaitForVBI = true,
+											const NTV2Channel inVBIChannel = NTV2_CHANNEL1, NTV2RegisterWrites * pOutDelta = AJA_NULL) const;
+		///@}
+
+		/**
+			@name	Persistence
+		**/
+		///@{
+		bool						Save (const std::string & inFilePath) const;			///< @brief	Writes me to the given binary file. Returns true if successful.
+		bool						Load (const std::string & inFilePath);					///< @brief	Replaces my contents from the given binary file. Returns true if successful.
+		bool						Serialize (NTV2_RPC_BLOB_TYPE & outBlob) const;			///< @brief	Encodes me into the given blob (replacing its contents). Returns true if successful.
+		bool						Deserialize (const NTV2_RPC_BLOB_TYPE & inBlob);		///< @brief	Replaces my contents from the given blob. Returns true if successful.
+		///@}
+
+		/**
+			@name	Inquiry
+		**/
+		///@{
+		inline const NTV2RegisterWrites &	GetWrites (void) const		{return mWrites;}				///< @return	My collapsed register writes.
+		inline size_t				GetNumWrites (void) const			{return mWrites.size();}		///< @return	The number of collapsed register writes I hold.
+		inline size_t				GetNumRecordedWrites (void) const	{return mNumRecorded;}			///< @return	The number of recorded writes I was compiled from.
+		inline NTV2DeviceID			GetDeviceID (void) const			{return mDeviceID;}				///< @return	The device model I was recorded from.
+		inline bool					IsEmpty (void) const				{return mWrites.empty();}		///< @return	True if I have no register writes.
+		void						Clear (void);														///< @brief	Empties me.
+		///@}
+
+	private:
+		NTV2DeviceID		mDeviceID;		///< @brief	Device model recorded from (or DEVICE_ID_NOTFOUND for any)
+		ULWord				mNumRecorded;	///< @brief	Number of recorded writes compiled
+		NTV2RegisterWrites	mWrites;		///< @brief	Collapsed register writes
+};	//	NTV2RegisterPreset
+
+AJAExport std::ostream & operator << (std::ostream & oss, const NTV2RegisterPreset & inPreset);
+
+#endif	//	NTV2REGISTERPRESET_H
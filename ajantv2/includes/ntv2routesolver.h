@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2routesolver.h
+	@brief		Declares the NTV2RouteSolver class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2ROUTESOLVER_H
+#define NTV2ROUTESOLVER_H
+
+#include "ntv2signalrouter.h"
+
+class CNTV2Card;
+
+typedef std::set<NTV2WidgetType>			NTV2WidgetTypeSet;			///< @brief	A collection of distinct ::NTV2WidgetType values.
+typedef NTV2WidgetTypeSet::const_iterator	NTV2WidgetTypeSetConstIter;	///< @brief	A const iterator for iterating over an ::NTV2WidgetTypeSet.
+
+/**
+	@brief	Identifies the kind of signal a route must deliver to its sink.
+**/
+typedef enum
+{
+	NTV2RouteColor_Any,		///< @brief	YUV or RGB, whichever is cheapest
+	NTV2RouteColor_YUV,		///< @brief	YUV only
+	NTV2RouteColor_RGB		///< @brief	RGB only
+} NTV2RouteColor;
+
+/**
+	@brief	Constraints for NTV2RouteSolver::Solve.
+**/
+struct AJAExport NTV2RouteConstraints
+{
+	NTV2WidgetTypeSet	requiredTypes;		///< @brief	The route must pass through one widget of each of these types (in any order)
+	NTV2WidgetTypeSet	excludedTypes;		///< @brief	The route must not pass through any widget of these types
+	NTV2WidgetIDSet		excludedWidgets;	///< @brief	The route must not pass through these widgets (e.g. because they're in use)
+	NTV2InputXptIDSet	excludedInputs;		///< @brief	The route must not use these widget inputs (e.g. because they're already connected)
+	NTV2RouteColor		sinkColor;			///< @brief	The kind of signal the sink must receive
+
+	NTV2RouteConstraints ()	: requiredTypes(), excludedTypes(), excludedWidgets(), excludedInputs(), sinkColor(NTV2RouteColor_Any)	{}
+
+	inline NTV2RouteConstraints &	Require (const NTV2WidgetType inType)		{requiredTypes.insert(inType);  return *this;}		///< @brief	Requires a widget of the given type.
+	inline NTV2RouteConstraints &	RequireCSC (void)							{return Require(NTV2WidgetType_CSC);}				///< @brief	Requires a color space converter.
+	inline NTV2RouteConstraints &	RequireLUT (void)							{return Require(NTV2WidgetType_LUT);}				///< @brief	Requires a color lookup table.
+	inline NTV2RouteConstraints &	Require425Mux (void)						{return Require(NTV2WidgetType_SMPTE425Mux);}		///< @brief	Requires a SMPTE 425 mux (4K/UHD two-sample-interleave).
+	inline NTV2RouteConstraints &	ExcludeType (const NTV2WidgetType inType)	{excludedTypes.insert(inType);  return *this;}		///< @brief	Excludes widgets of the given type.
+	inline NTV2RouteConstraints &	Exclude (const NTV2WidgetID inWidget)		{excludedWidgets.insert(inWidget);  return *this;}	///< @brief	Excludes the given widget.
+	inline NTV2RouteConstraints &	ExcludeInput (const NTV2InputXptID inInput)	{excludedInputs.insert(inInput);  return *this;}	///< @brief	Excludes the given widget input.
+	inline NTV2RouteConstraints &	SetSinkColor (const NTV2RouteColor inColor)	{sinkColor = inColor;  return *this;}				///< @brief	Sets the kind of signal the sink must receive.
+
+	/**
+		@brief		Excludes every input in the given connections (e.g. a route solved for another link), so another route
+					can share their widgets only through unused inputs (e.g. the "B" input of a 425 mux).
+		@param[in]	inConnections	Specifies the connections whose inputs are to be excluded.
+		@return		A reference to me.
+	**/
+	NTV2RouteConstraints &			ExcludeInputsIn (const NTV2XptConnections & inConnections);
+};	//	NTV2RouteConstraints
+
+AJAExport std::ostream & operator << (std::ostream & oss, const NTV2RouteConstraints & inConstraints);
+
+
+/**
+	@brief	Finds the cheapest (fewest connections) valid signal route between a widget output (source) and a widget input
+			(sink) on a given device model, so apps needn't hand-code routes for each device family:
+			@code
+				NTV2XptConnections route;
+				NTV2RouteConstraints constraints;
+				constraints.SetSinkColor(NTV2RouteColor_RGB);	//	Capturing into an RGB FrameStore
+				if (NTV2RouteSolver::Solve(device, NTV2_XptSDIIn1, NTV2_XptFrameBuffer1Input, route, constraints))
+					device.ApplySignalRoute(route);				//	SDIIn1 ==> CSC1 ==> FrameStore1
+			@endcode
+			-	The routing graph for each device model is built once, from the model's widgets (see CNTV2SignalRouter::GetWidgetIDs)
+				and, when solving for an open device that has a crosspoint connect ROM, the device's legal connections (see
+				CNTV2Card::GetPossibleConnections). Without the ROM, any widget output may feed any widget input.
+			-	Color is tracked along the route:  only CSCs and LUTs convert between YUV and RGB, RGB-only and YUV-only inputs
+				only accept matching outputs, and key inputs and outputs are never used.
+			-	FrameStores are only used as the source or sink, never in the middle of a route.
+			-	Solutions are cached per device model (up to 1000 of them, after which the model's cache starts over), so
+				after the first call for a given source, sink and constraints, route setup is a table lookup.
+			-	Each widget is used at most once per route. The search first ignores that rule, which keeps it small, and only
+				if the shortest route it finds would pass through a widget twice does it search again, tracking the widgets
+				used along each path.
+	@note	Routes are single-link. For quad-link or two-sample-interleave (425 mux) 4K/UHD, solve each link separately,
+			excluding the inputs used by the links already solved (see NTV2RouteConstraints::ExcludeInputsIn).
+	@note	This class is thread-safe.
+**/
+class AJAExport NTV2RouteSolver
+{
+	public:
+		/**
+			@brief		Solves for the cheapest route between the given source and sink on the given device model.
+			@param[in]	inDeviceID		Specifies the device model.
+			@param[in]	inSource		Specifies the widget output the signal comes from (e.g. ::NTV2_XptSDIIn1 or ::NTV2_XptFrameBuffer1YUV).
+			@param[in]	inSink			Specifies the widget input the signal goes to (e.g. ::NTV2_XptFrameBuffer1Input or ::NTV2_XptSDIOut1Input).
+			@param[out]	outRoute		Receives the connections that make up the route.
+			@param[in]	inConstraints	Optionally specifies constraints the route must satisfy. Defaults to none.
+			@return		True if a route was found;  otherwise false.
+		**/
+		static bool		Solve (const NTV2DeviceID inDeviceID, const NTV2OutputXptID inSource, const NTV2InputXptID inSink,
+								NTV2XptConnections & outRoute, const NTV2RouteConstraints & inConstraints = NTV2RouteConstraints());
+
+		/**
+			@brief		Same as above, but for an open device, whose crosspoint connect ROM (if any) restricts the route to legal connections.
+			@param[in]	inDevice		Specifies the open device.
+			@param[in]	inSource		Specifies the widget output the signal comes from.
+			@param[in]	inSink			Specifies the widget input the signal goes to.
+			@param[out]	outRoute		Receives the connections that make up the route.
+			@param[in]	inConstraints	Optionally specifies constraints the route must satisfy. Defaults to none.
+			@return		True if a route was found;  otherwise false.
+		**/
+		static bool		Solve (CNTV2Card & inDevice, const NTV2OutputXptID inSource, const NTV2InputXptID inSink,
+								NTV2XptConnections & outRoute, const NTV2RouteConstraints & inConstraints = NTV2RouteConstraints());
+
+		static size_t	GetNumCachedSolutions (void);	///< @return	The number of solutions (and known-unsolvable requests) in my cache, for all device models.
+		static void		ClearCache (void);				///< @brief	Discards all routing graphs and solutions I've cached.
+
+	private:
+		NTV2RouteSolver ();		//	Not instantiable
+};	//	NTV2RouteSolver
+
+#endif	//	NTV2ROUTESOLVER_H
@@ -0,0 +1,179 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2simulateddevice.h
+	@brief		Declares the NTV2SimulatedDevice class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2SIMULATEDDEVICE_H
+#define NTV2SIMULATEDDEVICE_H
+
+#include "ntv2nubaccess.h"
+#include "ntv2testpatterngen.h"
+#include "ajabase/system/event.h"
+#include "ajabase/system/thread.h"
+#include <map>
+#include <set>
+#include <vector>
+
+#define	kQParamSimPattern		"pattern"		///< @brief	Simulated device query parameter naming the test pattern (or web color) to synthesize on its SDI inputs
+#define	kQParamSimInputFormat	"input"			///< @brief	Simulated device query parameter naming the video format of its synthesized SDI input signal (default "1080p59.94a")
+
+
+/**
+	@brief	A software-only NTV2 device that behaves enough like a real card to exercise CNTV2Card-based pipeline code
+			(and to measure SDK-side throughput and latency) without any hardware or driver. It's instantiated by
+			NTV2RPCClientAPI::CreateClient for the ::kLegalSchemeNTV2Sim URL scheme, where the "host" names the device
+			model to simulate (e.g. "corvid88", "kona5"), or its ::NTV2DeviceID in hex (e.g. "0x10538200"):
+			@code
+				CNTV2Card device;
+				device.Open("ntv2sim://corvid88/?pattern=100%25%20ColorBars&input=1080p50a");
+			@endcode
+			-	Registers are kept in memory, and seeded from the model's ::NTV2DeviceFeatureRow (::kRegBoardID, 8MB frames,
+				1080p59.94 on every FrameStore). Mask and shift work as they do with the driver.
+			-	Frame buffer memory spans the model's active memory size, and is allocated lazily, one page at a time.
+				DMA transfers (including segmented ones) copy to and from it.
+			-	A VBI thread ticks each FrameStore at the frame rate in its ::kRegGlobalControl register (FrameStore 1's,
+				unless multi-format mode is enabled), signaling output and input vertical interrupts once per frame.
+			-	AutoCirculate Init, Start, Stop, Abort, Pause/Resume, Flush, SetActiveFrame, GetStatus, GetFrameStamp and
+				Transfer (video only) follow the driver's frame ring semantics.
+			-	If ::kQParamSimPattern is given, every SDI input reports the ::kQParamSimInputFormat signal, and each frame
+				captured by an input AutoCirculate channel is filled with the given ::NTV2TestPatternGen pattern, rendered
+				in that channel's pixel format.
+	@note	Audio, anc, routing and signal processing aren't simulated.
+**/
+class AJAExport NTV2SimulatedDevice : public NTV2RPCClientAPI
+{
+	public:
+		/**
+			@brief		Instantiates a new simulated device.
+			@param[in]	inParams	Specifies the connect parameters. The ::kConnectParamHost value names the model to simulate.
+			@return		A pointer to the new instance, or nullptr upon failure (e.g. unknown device model).
+		**/
+		static NTV2SimulatedDevice *	Create (const NTV2ConnectParams & inParams);
+
+		/**
+			@return		The ::NTV2DeviceID that corresponds to the given model name or hex ID, or ::DEVICE_ID_NOTFOUND if none.
+			@param[in]	inName		Specifies the model name (compared case-insensitively, ignoring spaces) or hex device ID.
+		**/
+		static NTV2DeviceID		DeviceIDFromName (const std::string & inName);
+
+		virtual					~NTV2SimulatedDevice ();	///< @brief	My destructor. Stops my VBI thread.
+
+		/**
+			@name	General Inquiry
+		**/
+		///@{
+		virtual std::string		Name (void) const;
+		virtual std::string		Description (void) const;
+		virtual bool			IsConnected (void) const	{return mConnected;}
+		inline NTV2DeviceID		DeviceID (void) const		{return mDeviceID;}		///< @return	The device I'm simulating.
+		inline ULWord			MemorySize (void) const		{return mMemorySize;}	///< @return	My frame buffer memory size, in bytes.
+		///@}
+
+		/**
+			@name	Device Operation
+		**/
+		///@{
+		virtual bool	NTV2ReadRegisterRemote	(const ULWord regNum, ULWord & outRegValue, const ULWord regMask, const ULWord regShift);
+		virtual bool	NTV2WriteRegisterRemote	(const ULWord regNum, const ULWord regValue, const ULWord regMask, const ULWord regShift);
+		virtual bool	NTV2AutoCirculateRemote	(AUTOCIRCULATE_DATA & autoCircData);
+		virtual bool	NTV2WaitForInterruptRemote	(const INTERRUPT_ENUMS eInterrupt, const ULWord timeOutMs);
+		virtual bool	NTV2WaitForAnyInterruptRemote	(NTV2InterruptWaitSet & inOutWaitSet, const ULWord timeOutMs);
+		virtual	bool	NTV2DMATransferRemote		(const NTV2DMAEngine inDMAEngine,	const bool inIsRead,
+													const ULWord inFrameNumber,			NTV2Buffer & inOutBuffer,
+													const ULWord inCardOffsetBytes,		const ULWord inNumSegments,
+													const ULWord inSegmentHostPitch,	const ULWord inSegmentCardPitch,
+													const bool inSynchronous);
+		virtual bool	NTV2MessageRemote	(NTV2_HEADER *	pInMessage);
+		virtual bool	NTV2GetDeviceProfileRemote (NTV2DeviceProfile & outProfile);	///< @brief	Answers the SDK's features for the device I'm simulating.
+		///@}
+
+	protected:
+						NTV2SimulatedDevice (const NTV2ConnectParams & inParams, const NTV2DeviceID inDeviceID);
+		virtual bool	NTV2OpenRemote	(void);		///< @brief	Seeds my registers and starts my VBI thread.
+		virtual bool	NTV2CloseRemote	(void);		///< @brief	Stops my VBI thread and releases my frame memory.
+
+	private:
+		NTV2SimulatedDevice (const NTV2SimulatedDevice & inObj);				//	Not copyable
+		NTV2SimulatedDevice & operator = (const NTV2SimulatedDevice & inRHS);	//	Not assignable
+
+		//	One per frame in an AutoCirculate ring
+		struct SimFrameStamp
+		{
+			ULWord		validCount;		///< @brief	Capture: 1 if holds an unread frame;  Playout: remaining times to play
+			ULWord		repeatCount;	///< @brief	Playout: times to play, from acFrameRepeatCount
+			ULWord64	frameTime;		///< @brief	When captured or put on-air (100ns units)
+			ULWord64	userCookie;		///< @brief	From acInUserCookie
+		};
+		typedef std::vector<SimFrameStamp>	SimFrameStamps;
+
+		//	One per NTV2Crosspoint
+		struct SimACChannel
+		{
+			NTV2AutoCirculateState	state;
+			bool			recording;
+			ULWord			channelCount;	///< @brief	Number of ganged FrameStores (primary only, else zero)
+			LWord			startFrame, endFrame, activeFrame;
+			ULWord			framesProcessed, framesDropped;
+			ULWord			optionFlags;
+			NTV2AudioSystem	audioSystem;
+			ULWord64		startTime;		///< @brief	First VBI after AutoCirculateStart (100ns units)
+			SimFrameStamps	frames;			///< @brief	Indexed by frame number
+		};
+
+		//	Helpers -- all but VBI-thread entry points expect mLock to be held
+		ULWord			RegValue (const ULWord inRegNum) const;
+		void			SetRegValue (const ULWord inRegNum, const ULWord inValue, const ULWord inMask = 0xFFFFFFFF, const ULWord inShift = 0);
+		void			SeedRegisters (void);
+		void			SeedInputSignal (void);
+		bool			IsMultiFormat (void) const;
+		NTV2FrameRate	FrameRate (const NTV2Channel inChannel) const;
+		NTV2PixelFormat	PixelFormat (const NTV2Channel inChannel) const;
+		ULWord			FrameSize (const NTV2Channel inChannel) const;
+		bool			CopyFrameMemory (const bool inToHost, ULWord64 inAddress, UByte * pHost, ULWord inByteCount);
+		bool			CopySegments (const bool inToHost, const ULWord64 inAddress, UByte * pHost, const ULWord inSegmentBytes,
+									const ULWord inNumSegments, const ULWord inHostPitch, const ULWord inCardPitch);
+		bool			ACInit (const AUTOCIRCULATE_DATA & inData);
+		bool			ACStatus (AUTOCIRCULATE_STATUS & outStatus);
+		bool			ACTransfer (AUTOCIRCULATE_TRANSFER & inOutXfer);
+		bool			ACFrameStamp (FRAME_STAMP & inOutStamp);
+		NTV2Crosspoint	ACGangMember (const NTV2Crosspoint inPrimary, const ULWord inIndex) const;
+		bool			ACFindNextAvailFrame (const SimACChannel & inAC, LWord & outFrame) const;
+		ULWord			ACBufferLevel (const SimACChannel & inAC) const;
+		void			ACVerticalInterrupt (const NTV2Crosspoint inCrosspoint, const ULWord64 inNow);
+		void			FillInputFrame (const NTV2Channel inChannel, const LWord inFrame);
+		void			VerticalInterrupt (const NTV2Channel inChannel);
+		void			SignalWaiters (const INTERRUPT_ENUMS inInterrupt);
+		void			VBIThread (void);
+		static void		VBIThreadStatic (AJAThread * pThread, void * pContext);
+		LWord			NextFrame (const SimACChannel & inAC, const LWord inFrame) const	{return inFrame >= inAC.endFrame ? inAC.startFrame : inFrame + 1;}
+		LWord			PrevFrame (const SimACChannel & inAC, const LWord inFrame) const	{return inFrame <= inAC.startFrame ? inAC.endFrame : inFrame - 1;}
+
+	private:
+		typedef std::set<AJAEvent*>							SimWaiters;
+		typedef std::map<INTERRUPT_ENUMS, SimWaiters>		SimWaiterMap;
+
+		NTV2DeviceID			mDeviceID;			///< @brief	The device I'm simulating
+		bool					mConnected;			///< @brief	True while "open"
+		mutable AJALock			mLock;				///< @brief	Guards registers, frame memory & AutoCirculate state
+		ULWordSequence			mRegs;				///< @brief	Register file, indexed by register number (grows on demand)
+		ULWord					mMemorySize;		///< @brief	Frame buffer memory size, in bytes
+		std::vector<UByteSequence>	mPages;			///< @brief	Frame buffer memory pages (empty until first written)
+		std::vector<SimACChannel>	mAC;			///< @brief	AutoCirculate state, indexed by NTV2Crosspoint
+		std::vector<ULWord64>	mNextVBI;			///< @brief	Per-FrameStore deadline of next VBI (microseconds)
+		AJALock					mWaitLock;			///< @brief	Guards mWaiters
+		SimWaiterMap			mWaiters;			///< @brief	Threads blocked in NTV2WaitForInterruptRemote
+		SimWaiters				mAnyWaiters;		///< @brief	Threads blocked in NTV2WaitForAnyInterruptRemote
+		ULWord64Sequence		mIntCounts;			///< @brief	Per-interrupt count, indexed by INTERRUPT_ENUMS (guarded by mWaitLock)
+		ULWord64Sequence		mIntTimes;			///< @brief	Per-interrupt time of most recent interrupt (100ns units, guarded by mWaitLock)
+		AJAThread				mVBIThread;			///< @brief	Drives vertical interrupts
+		bool					mQuit;				///< @brief	Tells mVBIThread to quit
+		std::string				mPatternName;		///< @brief	Input test pattern (empty if no input signal)
+		NTV2VideoFormat			mInputFormat;		///< @brief	Input signal video format
+		NTV2TestPatternGen		mPatternGen;		///< @brief	Renders input frames
+		NTV2PixelFormat			mPatternPF;			///< @brief	Pixel format of mPatternBuffer
+		NTV2Buffer				mPatternBuffer;		///< @brief	Rendered input frame (rendered on demand)
+};	//	NTV2SimulatedDevice
+
+#endif	//	NTV2SIMULATEDDEVICE_H
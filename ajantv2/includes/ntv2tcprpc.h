@@ -0,0 +1,337 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2tcprpc.h
+	@brief		Declares the NTV2TCPClient and NTV2TCPServer classes.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2TCPRPC_H
+#define NTV2TCPRPC_H
+
+#include "ntv2nubaccess.h"
+#include "ajabase/system/event.h"
+#include "ajabase/system/thread.h"
+#include <map>
+#include <vector>
+
+#define	kQParamTCPBatch			"batch"			///< @brief	NTV2TCPClient query parameter that enables write batching (see NTV2TCPClient::SetWriteBatching)
+#define	kQParamTCPCompress		"compress"		///< @brief	NTV2TCPClient query parameter that enables DMA payload compression (see NTV2TCPClient::SetCompression)
+#define	kQParamTCPSharedMem		"shm"			///< @brief	NTV2TCPClient query parameter that sizes its shared memory segment, in megabytes (see NTV2TCPClient::HasSharedMemory)
+#define	kNTV2TCPDefaultSharedMB	64				///< @brief	Default NTV2TCPClient shared memory segment size, in megabytes
+#define	kNTV2TCPOpcodeUser		0x0100			///< @brief	First request opcode available to NTV2TCPClient and NTV2TCPServer subclasses
+
+class CNTV2Card;
+class NTV2TCPServerConnection;	//	Private to ntv2tcprpc.cpp
+
+
+/**
+	@brief	Traffic counters for an NTV2TCPClient, for measuring remote device throughput and latency.
+**/
+struct AJAExport NTV2TCPStats
+{
+	ULWord64	requests;				///< @brief	Requests sent (one per round trip, though concurrent requests overlap)
+	ULWord64	registerOps;			///< @brief	Register reads and writes carried by those requests
+	ULWord64	batchedWrites;			///< @brief	Register writes that were deferred and sent in a batch
+	ULWord64	deferredWriteFailures;	///< @brief	Batched register writes the server reported as failed
+	ULWord64	localReads;				///< @brief	Register reads answered without a round trip (see NTV2TCPClient::ReadLocalRegister)
+	ULWord64	bytesSent;				///< @brief	Bytes sent, including framing
+	ULWord64	bytesReceived;			///< @brief	Bytes received, including framing
+	ULWord64	dmaBytes;				///< @brief	DMA payload bytes transferred (uncompressed)
+	ULWord64	dmaWireBytes;			///< @brief	DMA payload bytes actually sent or received (after compression)
+	ULWord64	sharedBytes;			///< @brief	DMA and AutoCirculate payload bytes passed through shared memory instead
+	ULWord64	stagedBytes;			///< @brief	Shared memory payload bytes that were copied, because the host buffer wasn't in the segment
+
+	NTV2TCPStats ()	: requests(0), registerOps(0), batchedWrites(0), deferredWriteFailures(0), localReads(0),
+						bytesSent(0), bytesReceived(0), dmaBytes(0), dmaWireBytes(0), sharedBytes(0), stagedBytes(0)	{}
+};
+
+AJAExport std::ostream & operator << (std::ostream & oss, const NTV2TCPStats & inStats);
+
+
+/**
+	@brief	An NTV2RPCClientAPI that operates a device served by an NTV2TCPServer. It's instantiated by
+			NTV2RPCClientAPI::CreateClient for the ::kLegalSchemeNTV2TCP URL scheme:
+			@code
+				CNTV2Card device;
+				device.Open("ntv2tcp://192.168.1.20:7575/?batch=1&compress=1");
+			@endcode
+			-	Requests are tagged with an ID, and a reader thread matches responses to them, so any number of
+				threads can have requests outstanding at once. A thread blocked in WaitForInterrupt doesn't hold
+				up another thread's register reads.
+			-	NTV2GetRegisters and NTV2SetRegisters messages (CNTV2Card::ReadRegisters and WriteRegisters) are
+				sent in one round trip.
+			-	With write batching enabled, register writes are queued and sent in one round trip just before the
+				next request that needs an answer (e.g. a register read, which is carried in the same batch), or
+				when Flush is called.
+			-	With compression enabled, DMA payloads are run-length encoded when that makes them smaller.
+			-	With shared memory enabled (e.g. "?shm=256" for a 256MB segment), and the server on the same host,
+				DMA payloads don't go over the socket at all. The segment is mapped by both ends at connect time, and
+				transfers pass only offsets and lengths. Buffers from AllocateSharedBuffer are transferred in place;
+				others are copied through a temporary block in the segment. If the server can't map the segment
+				(e.g. it's on another host), DMA goes over the socket as usual.
+			-	The device's NTV2DeviceProfile is sent in one response, so opening it doesn't take a round trip for
+				every feature queried.
+			-	(Classic) AutoCirculate control and status, AUTOCIRCULATE_STATUS messages, WaitForInterrupt,
+				WaitForAnyInterrupt and (segmented) DMA transfers are supported. AUTOCIRCULATE_TRANSFER is supported
+				only with shared memory.
+	@note	There's no authentication or encryption. Only serve devices on trusted networks.
+**/
+class AJAExport NTV2TCPClient : public NTV2RPCClientAPI
+{
+	public:
+		/**
+			@brief		Instantiates a new client.
+			@param[in]	inParams	Specifies the connect parameters. ::kConnectParamHost and ::kConnectParamPort
+									(default ::NTV2NUBPORT) specify the server.
+			@return		A pointer to the new instance, or nullptr upon failure.
+		**/
+		static NTV2TCPClient *	Create (const NTV2ConnectParams & inParams);
+		virtual					~NTV2TCPClient ();	///< @brief	My destructor. Disconnects if connected.
+
+		/**
+			@name	General Inquiry
+		**/
+		///@{
+		virtual std::string		Name (void) const;
+		virtual std::string		Description (void) const;
+		virtual bool			IsConnected (void) const	{return mConnected;}
+		inline NTV2DeviceID		DeviceID (void) const		{return mDeviceID;}		///< @return	The served device's ::NTV2DeviceID.
+		NTV2TCPStats			GetStats (void) const;									///< @return	My traffic counters.
+		void					ResetStats (void);										///< @brief	Zeroes my traffic counters.
+		static NTV2TCPClient *	FromDevice (CNTV2Card & inDevice);	///< @return	The given device's client, or nullptr if it isn't an NTV2TCPClient device.
+		///@}
+
+		/**
+			@name	Batching & Compression
+		**/
+		///@{
+		/**
+			@brief		Enables or disables write batching. When enabled, NTV2WriteRegisterRemote queues the write and
+						returns true right away. Failures of queued writes are logged and counted in NTV2TCPStats.
+			@param[in]	inEnable	Specify true to enable write batching;  false to flush and disable it.
+			@return		True if successful;  otherwise false.
+		**/
+		bool					SetWriteBatching (const bool inEnable);
+		inline bool				IsWriteBatching (void) const			{return mBatchWrites;}		///< @return	True if write batching is enabled.
+		bool					Flush (void);	///< @brief	Sends any queued register writes. @return	True if all of them succeeded.
+		inline void				SetCompression (const bool inEnable)	{mCompress = inEnable;}		///< @brief	Enables or disables DMA payload compression.
+		inline bool				IsCompressing (void) const				{return mCompress;}			///< @return	True if DMA payload compression is enabled.
+		///@}
+
+		/**
+			@name	Shared Memory
+		**/
+		///@{
+		inline bool				HasSharedMemory (void) const			{return mpSharedMem ? true : false;}	///< @return	True if DMA payloads go through shared memory.
+		inline ULWord64			GetSharedMemorySize (void) const		{return mSharedBytes;}	///< @return	The size of my shared memory segment's data area, in bytes (zero if none).
+		/**
+			@brief		Allocates a buffer in my shared memory segment. DMA and AutoCirculate transfers into or out of it
+						aren't copied at all. Buffers are page-aligned.
+			@param[in]	inByteCount		Specifies the buffer size, in bytes.
+			@param[out]	outBuffer		Receives the buffer. It doesn't own its memory, which is valid until it's freed
+										by FreeSharedBuffer, or until I disconnect.
+			@return		True if successful;  false if I have no shared memory, or not enough of it is free.
+		**/
+		bool					AllocateSharedBuffer (const size_t inByteCount, NTV2Buffer & outBuffer);
+		/**
+			@brief		Frees a buffer that was allocated by AllocateSharedBuffer.
+			@param		inOutBuffer		Specifies the buffer to free. Upon success, it's set empty.
+			@return		True if successful;  otherwise false.
+		**/
+		bool					FreeSharedBuffer (NTV2Buffer & inOutBuffer);
+		///@}
+
+		/**
+			@name	Device Operation
+		**/
+		///@{
+		virtual bool	NTV2ReadRegisterRemote	(const ULWord regNum, ULWord & outRegValue, const ULWord regMask, const ULWord regShift);
+		virtual bool	NTV2WriteRegisterRemote	(const ULWord regNum, const ULWord regValue, const ULWord regMask, const ULWord regShift);
+		virtual bool	NTV2AutoCirculateRemote	(AUTOCIRCULATE_DATA & autoCircData);
+		virtual bool	NTV2WaitForInterruptRemote	(const INTERRUPT_ENUMS eInterrupt, const ULWord timeOutMs);
+		virtual bool	NTV2WaitForAnyInterruptRemote	(NTV2InterruptWaitSet & inOutWaitSet, const ULWord timeOutMs);
+		virtual	bool	NTV2DMATransferRemote		(const NTV2DMAEngine inDMAEngine,	const bool inIsRead,
+													const ULWord inFrameNumber,			NTV2Buffer & inOutBuffer,
+													const ULWord inCardOffsetBytes,		const ULWord inNumSegments,
+													const ULWord inSegmentHostPitch,	const ULWord inSegmentCardPitch,
+													const bool inSynchronous);
+		virtual bool	NTV2MessageRemote	(NTV2_HEADER *	pInMessage);
+		virtual bool	NTV2GetDeviceProfileRemote (NTV2DeviceProfile & outProfile);
+		///@}
+
+	protected:
+						NTV2TCPClient (const NTV2ConnectParams & inParams);
+		virtual bool	NTV2OpenRemote	(void);		///< @brief	Connects to the server and starts my reader thread.
+		virtual bool	NTV2CloseRemote	(void);		///< @brief	Flushes queued writes, then disconnects.
+		virtual int		ConnectSocket	(void);		///< @brief	Connects a stream socket to the server. @return	The socket, or -1 upon failure.
+
+		/**
+			@brief		Sends a request and waits for its response. Other threads may have requests in flight meanwhile.
+			@param[in]	inOpcode		Specifies the request opcode (subclasses use ::kNTV2TCPOpcodeUser and up).
+			@param[in]	inRequest		Specifies the request payload.
+			@param[out]	outResponse		Receives the response payload.
+			@param[out]	outFlags		Receives the response flags.
+			@param[in]	inTimeoutMs		Specifies how long to wait for the response, in milliseconds.
+			@param[in]	inRequestFlags	Optionally specifies the request flags. Defaults to none.
+			@return		True if the server handled the request successfully;  otherwise false.
+		**/
+		bool			Transact (const UWord inOpcode, const NTV2_RPC_BLOB_TYPE & inRequest, NTV2_RPC_BLOB_TYPE & outResponse,
+									UWord & outFlags, const ULWord inTimeoutMs, const UWord inRequestFlags = 0);
+
+		/**
+			@brief		Called before sending a register read, to let subclasses answer it locally (e.g. from shared memory).
+						Not called while register writes are queued.
+			@param[in]	inRegNum	Specifies the register number.
+			@param[out]	outValue	Receives the register's (unmasked) value.
+			@return		True if answered;  false to read it from the server.
+		**/
+		virtual bool	ReadLocalRegister (const ULWord inRegNum, ULWord & outValue)	{(void) inRegNum;  (void) outValue;  return false;}
+		virtual void	RegistersWritten (const NTV2RegisterWrites & inWrites)			{(void) inWrites;}	///< @brief	Called after the server has been sent the given register writes.
+		inline void		SetDefaultSharedMemory (const ULWord inMegabytes)	{if (!mSharedSpecified) mSharedMB = inMegabytes;}	///< @brief	Sets my shared memory size, unless ::kQParamTCPSharedMem specified it. Call before connecting.
+
+	private:
+		NTV2TCPClient (const NTV2TCPClient & inObj);				//	Not copyable
+		NTV2TCPClient & operator = (const NTV2TCPClient & inRHS);	//	Not assignable
+
+		//	One per outstanding request
+		struct TCPPending
+		{
+			AJAEvent			done;		///< @brief	Signaled by my reader thread when the response arrives
+			NTV2_RPC_BLOB_TYPE	payload;	///< @brief	Response payload
+			UWord				flags;		///< @brief	Response flags
+			bool				received;	///< @brief	True if the response arrived
+			TCPPending ()	: done(/*manualReset*/false), payload(), flags(0), received(false)	{}
+		};
+		typedef std::map<ULWord, TCPPending*>	TCPPendingMap;
+		typedef std::map<ULWord64, ULWord64>	SharedBlockMap;		//	Offset ==> byte count
+
+		bool			RegisterBatch (NTV2RegisterWrites & inOutOps, const std::vector<bool> & inIsRead, std::vector<bool> & outOK, ULWord & outQueuedFailures);
+		bool			TakeQueuedWrites (NTV2RegisterWrites & outWrites);
+		void			ReaderThread (void);
+		static void		ReaderThreadStatic (AJAThread * pThread, void * pContext);
+		bool			AttachSharedMemory (void);
+		void			DetachSharedMemory (void);
+		UByte *			SharedData (void) const;
+		bool			SharedOffset (const void * pHost, const ULWord64 inByteCount, ULWord64 & outOffset) const;
+		bool			AllocateSharedBlock (const ULWord64 inByteCount, ULWord64 & outOffset);
+		bool			FreeSharedBlock (const ULWord64 inOffset);
+		bool			StageShared (const UByte * pHost, const ULWord64 inByteCount, const bool inCopyIn, ULWord64 & outOffset, bool & outStaged);
+		void			UnstageShared (UByte * pHost, const ULWord64 inByteCount, const bool inCopyOut, const ULWord64 inOffset, const bool inStaged);
+		bool			SharedAutoCirculateTransfer (AUTOCIRCULATE_TRANSFER & inOutXfer);
+
+	private:
+		int					mSocket;		///< @brief	Connected socket (or -1)
+		bool				mConnected;		///< @brief	True while connected
+		NTV2DeviceID		mDeviceID;		///< @brief	Served device's ID (from the server)
+		std::string			mServerDesc;	///< @brief	Served device's description (from the server)
+		AJAThread			mReader;		///< @brief	Receives responses
+		AJALock				mSendLock;		///< @brief	Serializes request frames on mSocket
+		mutable AJALock		mPendingLock;	///< @brief	Guards mPending, mNextID and mStats
+		TCPPendingMap		mPending;		///< @brief	Outstanding requests, by ID
+		ULWord				mNextID;		///< @brief	Next request ID
+		AJALock				mQueueLock;		///< @brief	Guards mQueuedWrites
+		NTV2RegisterWrites	mQueuedWrites;	///< @brief	Register writes waiting to be sent (write batching)
+		bool				mBatchWrites;	///< @brief	True if write batching is enabled
+		bool				mCompress;		///< @brief	True if DMA payload compression is enabled
+		NTV2TCPStats		mStats;			///< @brief	Traffic counters
+		ULWord				mSharedMB;		///< @brief	Requested shared memory size, in megabytes (zero for none)
+		bool				mSharedSpecified;	///< @brief	True if ::kQParamTCPSharedMem was given
+		UByte *				mpSharedMem;	///< @brief	My shared memory segment (or NULL)
+		ULWord64			mSharedBytes;	///< @brief	Size of the segment's data area
+		mutable AJALock		mSharedLock;	///< @brief	Guards mSharedFree and mSharedUsed
+		SharedBlockMap		mSharedFree;	///< @brief	Free blocks in the data area
+		SharedBlockMap		mSharedUsed;	///< @brief	Allocated blocks in the data area
+};	//	NTV2TCPClient
+
+
+/**
+	@brief	A reference NTV2RPCServerAPI that serves one open device (local, or e.g. simulated) to NTV2TCPClient
+			instances over TCP, so remote device throughput and latency can be measured, even over loopback:
+			@code
+				CNTV2Card device;
+				device.Open("ntv2sim://kona5");
+				NTV2ConfigParams config;
+				config.insert(kConnectParamPort, "0");		//	Any free port
+				NTV2TCPServer server(device, config);
+				if (server.Start())
+				{
+					CNTV2Card remote;
+					remote.Open("ntv2tcp://127.0.0.1:" + aja::to_string(server.GetPort()) + "/?batch=1");
+					...
+				}
+			@endcode
+			-	Each connection is serviced by its own thread. Interrupt waits are handed off to a few waiter
+				threads, so they don't hold up the connection's other requests, and their responses may arrive
+				out of order.
+			-	The ::kConnectParamHost config parameter specifies the address of the interface to listen on. It defaults
+				to loopback (127.0.0.1), so only clients on the same host can connect;  to serve other hosts, specify the
+				interface's address, or "0.0.0.0" for all interfaces. ::kConnectParamPort specifies the port (default
+				::NTV2NUBPORT;  "0" picks any free port).
+	@note	There's no authentication or encryption. Only serve devices on trusted networks.
+**/
+class AJAExport NTV2TCPServer : public NTV2RPCServerAPI
+{
+	public:
+		/**
+			@brief		Constructs me to serve the given device.
+			@param[in]	inDevice	Specifies the open device to serve. It must outlive me.
+			@param[in]	inConfig	Optionally specifies my configuration.
+		**/
+						NTV2TCPServer (CNTV2Card & inDevice, const NTV2ConfigParams & inConfig = NTV2ConfigParams());
+		virtual			~NTV2TCPServer ();	///< @brief	My destructor. Stops me and closes all connections.
+
+		/**
+			@brief		Starts listening, and runs RunServer on a new thread.
+			@return		True if successful;  otherwise false.
+		**/
+		bool			Start (void);
+		virtual void	RunServer (void);	///< @brief	Accepts connections until Stop is called. Start calls this on its own thread.
+		virtual void	Stop (void);		///< @brief	Requests RunServer to stop, and waits for it to close all connections.
+
+		inline UWord	GetPort (void) const	{return mPort;}		///< @return	The port I'm listening on (valid after Start).
+		size_t			GetNumConnections (void) const;				///< @return	The number of connected clients.
+		virtual std::string		Endpoint (void) const;				///< @return	A description of where I'm listening (e.g. "port 7575").
+		virtual std::ostream &	Print (std::ostream & oss) const;
+
+	protected:
+		/**
+			@brief		Creates my listening socket.
+			@param[out]	outPort		Receives the port I'm listening on (zero if not applicable).
+			@return		The listening stream socket, or -1 upon failure.
+		**/
+		virtual int		OpenListenSocket (UWord & outPort);
+
+		/**
+			@brief		Called to handle a request whose opcode is ::kNTV2TCPOpcodeUser or higher. Called on a connection's
+						thread, so it must be thread-safe.
+			@param[in]	inConnectionID	Identifies the client connection.
+			@param[in]	inOpcode		Specifies the request opcode.
+			@param[in]	inRequest		Specifies the request payload.
+			@param[out]	outResponse		Receives the response payload.
+			@return		True if successful;  otherwise false.
+		**/
+		virtual bool	HandleRequest (const ULWord inConnectionID, const UWord inOpcode, const NTV2_RPC_BLOB_TYPE & inRequest, NTV2_RPC_BLOB_TYPE & outResponse);
+		virtual bool	IsBlockingRequest (const UWord inOpcode) const		{(void) inOpcode;  return false;}	///< @return	True if the given opcode's HandleRequest may block, and so should run on a waiter thread.
+		virtual void	ConnectionClosed (const ULWord inConnectionID)		{(void) inConnectionID;}			///< @brief	Called after the given client connection closes.
+		inline CNTV2Card &	GetDevice (void)								{return mDevice;}					///< @return	The device I serve.
+
+	private:
+		friend class NTV2TCPServerConnection;
+		NTV2TCPServer (const NTV2TCPServer & inObj);				//	Not copyable
+		NTV2TCPServer & operator = (const NTV2TCPServer & inRHS);	//	Not assignable
+		bool			Listen (void);
+		void			ReapConnections (const bool inAll);
+		static void		ServerThreadStatic (AJAThread * pThread, void * pContext);
+
+	private:
+		typedef std::vector<NTV2TCPServerConnection*>	TCPConnections;
+		CNTV2Card &				mDevice;		///< @brief	The device I serve
+		int						mListenSocket;	///< @brief	Listening socket (or -1)
+		UWord					mPort;			///< @brief	Port I'm listening on
+		AJAThread				mThread;		///< @brief	Runs RunServer (if started by Start)
+		mutable AJALock			mConnLock;		///< @brief	Guards mConnections
+		TCPConnections			mConnections;	///< @brief	Connected clients
+		ULWord					mNextConnID;	///< @brief	Next connection ID
+};	//	NTV2TCPServer
+
+#endif	//	NTV2TCPRPC_H
@@ -7,10 +7,16 @@
 #include "ntv2linuxdriverinterface.h"
 #include "ntv2linuxpublicinterface.h"
 #include "ntv2utils.h"
+#include "ntv2registerexpert.h"
+#include "ntv2drivertrace.h"
+#include "ajabase/system/atomic.h"
 #include "ajabase/system/debug.h"
+#include "ajabase/system/lock.h"
 #include <fcntl.h>
+#include <unistd.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <errno.h>
 
 using namespace std;
 
@@ -40,6 +46,11 @@ using namespace std;
 CNTV2LinuxDriverInterface::CNTV2LinuxDriverInterface()
 	:	_bitfileDirectory			("../xilinx")
 		,_hDevice					(INVALID_HANDLE_VALUE)
+		,_pMappedRegisters			(AJA_NULL)
+		,_pMappedRegisterBAR		(AJA_NULL)
+		,_mappedRegistersSize		(0)
+		,_noWaitForAnyIoctl			(false)
+		,_noWaitForSnapshotIoctl	(false)
 #if !defined(NTV2_DEPRECATE_16_0)
 		,_pDMADriverBufferAddress	(AJA_NULL)
 		,_BA0MemorySize				(0)
@@ -107,6 +118,14 @@ bool CNTV2LinuxDriverInterface::OpenLocalPhysical (const UWord inDeviceIndex)
 
 bool CNTV2LinuxDriverInterface::CloseLocalPhysical (void)
 {
+	SetMappedRegisterReads(false);
+	if (_pMappedRegisterBAR)
+	{
+		UnmapRegisterBAR(const_cast<ULWord*>(_pMappedRegisterBAR), _mappedRegistersSize);
+		LDIDBG("Register BAR unmapped");
+	}
+	_pMappedRegisterBAR = AJA_NULL;
+	_mappedRegistersSize = 0;
 #if !defined(NTV2_DEPRECATE_16_0)
 	UnmapXena2Flash();
 	UnmapDMADriverBuffer();
@@ -136,17 +155,28 @@ bool CNTV2LinuxDriverInterface::ReadRegister (const ULWord inRegNum,  ULWord & o
 		LDIFAIL("Shift " << DEC(inShift) << " > 31, reg=" << DEC(inRegNum) << " msk=" << xHEX0N(inMask,8));
 		return false;
 	}
+	bool cacheable(false);
+	if ((mpRegCache || mpRegWriteTxn)  &&  RegCacheRead(inRegNum, outValue, inMask, inShift, cacheable))
+		return true;	//	Answered from shadow register cache or pending register write transaction
+	const ULWord regMask(cacheable ? 0xFFFFFFFF : inMask), regShift(cacheable ? 0 : inShift);	//	Cache entire register
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_READ_REGISTER, inRegNum, inMask, 0, &outValue);
 #if defined(NTV2_NUB_CLIENT_SUPPORT)
 	if (IsRemote())
-		return CNTV2DriverInterface::ReadRegister (inRegNum, outValue, inMask, inShift);
+		return trace.Done(RegCacheFill(CNTV2DriverInterface::ReadRegister (inRegNum, outValue, regMask, regShift), cacheable, inRegNum, outValue, inMask, inShift));
 #endif	//	defined(NTV2_NUB_CLIENT_SUPPORT)
 	if ((_hDevice == INVALID_HANDLE_VALUE) || (_hDevice == 0))
 		return false;
+	const volatile ULWord * pMappedRegs (_pMappedRegisters);	//	Once -- another thread may disable the fast path
+	if (pMappedRegs  &&  inRegNum < _mappedRegistersSize / sizeof(ULWord)  &&  IsMappedRegisterReadSafe(inRegNum))
+	{	//	Fast path:  same mask & shift semantics as the driver
+		outValue = (pMappedRegs[inRegNum] & regMask) >> regShift;
+		return trace.Done(RegCacheFill(true, cacheable, inRegNum, outValue, inMask, inShift));
+	}
 
 	REGISTER_ACCESS ra;
 	ra.RegisterNumber = inRegNum;
-	ra.RegisterMask	  = inMask;
-	ra.RegisterShift  = inShift;
+	ra.RegisterMask	  = regMask;
+	ra.RegisterShift  = regShift;
 	ra.RegisterValue  = 0xDEADBEEF;
 	AJADebug::StatTimerStart(AJA_DebugStat_ReadRegister);
 	const int result (ioctl(int(_hDevice), IOCTL_NTV2_READ_REGISTER, &ra));
@@ -154,9 +184,105 @@ bool CNTV2LinuxDriverInterface::ReadRegister (const ULWord inRegNum,  ULWord & o
 	if (result)
 		{LDIFAIL("IOCTL_NTV2_READ_REGISTER failed");	return false;}
 	outValue = ra.RegisterValue;
+	return trace.Done(RegCacheFill(true, cacheable, inRegNum, outValue, inMask, inShift));
+}
+
+
+//	Returns a bitmap of the real registers whose mapped reads match the driver's
+static vector<bool> MakeMappedReadSafeBitmap (void)
+{
+	vector<bool> result;
+	//	Plain hardware reads...
+	static const string sSafeClasses[] = {kRegClass_Routing, kRegClass_Channel1, kRegClass_Channel2, kRegClass_Channel3,
+										kRegClass_Channel4, kRegClass_Channel5, kRegClass_Channel6, kRegClass_Channel7,
+										kRegClass_Channel8, kRegClass_Video, kRegClass_CSC, kRegClass_Output, kRegClass_Mixer,
+										kRegClass_HDR, kRegClass_VPID, kRegClass_Timing, kRegClass_NTV4FrameStore, kRegClass_Input,
+										kRegClass_Interrupt, kRegClass_Timecode, kRegClass_SDIError, kRegClass_Info, kRegClass_XptROM,
+										kRegClass_Audio, kRegClass_Anc, kRegClass_HDMI, kRegClass_Analog, kRegClass_AES,
+										kRegClass_ReadOnly, kRegClass_NULL};
+	//	...unless the driver services them (serial FIFOs, DMA), or reading them is meaningless or indirect
+	static const string sUnsafeClasses[] = {kRegClass_Serial, kRegClass_DMA, kRegClass_LUT, kRegClass_IP, kRegClass_Aux,
+										kRegClass_WriteOnly, kRegClass_Virtual, kRegClass_NULL};
+	NTV2RegNumSet unsafeRegs;
+	for (size_t ndx(0);  !sUnsafeClasses[ndx].empty();  ndx++)
+	{
+		const NTV2RegNumSet regs (CNTV2RegisterExpert::GetRegistersForClass(sUnsafeClasses[ndx]));
+		unsafeRegs.insert(regs.begin(), regs.end());
+	}
+	for (size_t ndx(0);  !sSafeClasses[ndx].empty();  ndx++)
+	{
+		const NTV2RegNumSet regs (CNTV2RegisterExpert::GetRegistersForClass(sSafeClasses[ndx]));
+		for (NTV2RegNumSetConstIter it(regs.begin());  it != regs.end();  ++it)
+			if (*it < VIRTUALREG_START  &&  unsafeRegs.find(*it) == unsafeRegs.end())
+			{
+				if (*it >= result.size())
+					result.resize(*it + 1, false);
+				result[*it] = true;
+			}
+	}
+	return result;
+}
+
+bool CNTV2LinuxDriverInterface::IsMappedRegisterReadSafe (const ULWord inRegNum)	//	STATIC
+{
+	static const vector<bool> sSafeRegs (MakeMappedReadSafeBitmap());	//	Built once (thread-safe), then read without a lock
+	return inRegNum < sSafeRegs.size()  &&  sSafeRegs[inRegNum];
+}
+
+bool CNTV2LinuxDriverInterface::SetMappedRegisterReads (const bool inEnable)
+{
+	if (!inEnable)
+	{	//	Another thread may be reading through it, so leave it mapped until I'm closed
+		if (_pMappedRegisters)
+			LDIDBG("Fast register reads disabled");
+		_pMappedRegisters = AJA_NULL;
+		return true;
+	}
+	if (_pMappedRegisters)
+		return true;	//	Already enabled
+	if (_pMappedRegisterBAR)
+	{
+		_pMappedRegisters = _pMappedRegisterBAR;
+		LDIDBG("Fast register reads re-enabled");
+		return true;
+	}
+	if (!IsOpen()  ||  IsRemote()  ||  _hDevice == INVALID_HANDLE_VALUE  ||  _hDevice == 0)
+		{LDIFAIL("Requires an open local device");  return false;}
+
+	ULWord barSize(0), boardID(0);
+	if (!ReadRegister(kVRegBA0MemorySize, barSize)  ||  !barSize)	//	From the driver (my fast path isn't enabled yet)
+		{LDIFAIL("Unable to get BAR0 size");  return false;}
+	void * pBAR (MapRegisterBAR(barSize));
+	if (!pBAR)
+		{LDIFAIL("mmap failed for " << xHEX0N(barSize,8) << "-byte BAR0");  return false;}
+
+	//	On some devices, BAR0 holds the DMA engine and the video registers are elsewhere -- make sure they're here
+	boardID = reinterpret_cast<volatile ULWord*>(pBAR)[kRegBoardID];
+	if (boardID != _boardID)
+	{
+		UnmapRegisterBAR(pBAR, barSize);
+		LDIWARN("BAR0 doesn't contain the video registers (mapped boardID " << xHEX0N(boardID,8) << " != " << xHEX0N(_boardID,8) << ")");
+		return false;
+	}
+	_pMappedRegisterBAR = reinterpret_cast<volatile ULWord*>(pBAR);
+	_mappedRegistersSize = barSize;
+	//	Exchange is a barrier, so ReadRegister sees the size before the pointer...
+	AJAAtomic::Exchange(reinterpret_cast<void* volatile*>(const_cast<ULWord**>(&_pMappedRegisters)), pBAR);
+	LDIINFO(xHEX0N(barSize,8) << "-byte register BAR mapped for fast register reads");
 	return true;
 }
 
+void * CNTV2LinuxDriverInterface::MapRegisterBAR (const ULWord inByteCount)
+{	//	The driver maps BAR0 at page offset 1
+	void * pBAR (mmap(AJA_NULL, inByteCount, PROT_READ, MAP_SHARED, int(_hDevice), off_t(sysconf(_SC_PAGESIZE))));
+	return pBAR == MAP_FAILED ? AJA_NULL : pBAR;
+}
+
+void CNTV2LinuxDriverInterface::UnmapRegisterBAR (void * pInBAR, const ULWord inByteCount)
+{
+	munmap(pInBAR, inByteCount);
+}
+
 
 bool CNTV2LinuxDriverInterface::WriteRegister (const ULWord inRegNum,  const ULWord inValue,  const ULWord inMask, const ULWord inShift)
 {
@@ -174,9 +300,12 @@ bool CNTV2LinuxDriverInterface::WriteRegister (const ULWord inRegNum,  const ULW
 			return true;
 	}
 #endif	//	defined(NTV2_WRITEREG_PROFILING)	//	Register Write Profiling
+	if (mpRegWriteTxn  &&  RegWriteTxnIntercept(inRegNum, inValue, inMask, inShift))
+		return true;	//	Deferred until register write transaction is committed
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_WRITE_REGISTER, inRegNum, inMask, inValue);
 #if defined(NTV2_NUB_CLIENT_SUPPORT)
 	if (IsRemote())
-		return CNTV2DriverInterface::WriteRegister(inRegNum, inValue, inMask, inShift);
+		return trace.Done(RegCacheWriteThrough(CNTV2DriverInterface::WriteRegister(inRegNum, inValue, inMask, inShift), inRegNum, inValue, inMask, inShift));
 #endif	//	defined(NTV2_NUB_CLIENT_SUPPORT)
 	if ((_hDevice == INVALID_HANDLE_VALUE) || (_hDevice == 0))
 		{LDIFAIL("_hDevice is invalid (0 or -1)");  return false;}
@@ -189,8 +318,8 @@ bool CNTV2LinuxDriverInterface::WriteRegister (const ULWord inRegNum,  const ULW
 	const int result (ioctl(int(_hDevice), IOCTL_NTV2_WRITE_REGISTER, &ra));
 	AJADebug::StatTimerStop(AJA_DebugStat_WriteRegister);
 	if (result)
-		{LDIFAIL("IOCTL_NTV2_WRITE_REGISTER failed");  return false;}
-	return true;
+		{LDIFAIL("IOCTL_NTV2_WRITE_REGISTER failed");  return RegCacheWriteThrough(false, inRegNum, inValue, inMask, inShift);}
+	return trace.Done(RegCacheWriteThrough(true, inRegNum, inValue, inMask, inShift));
 }
 
 bool CNTV2LinuxDriverInterface::RestoreHardwareProcampRegisters (void)
@@ -259,6 +388,7 @@ bool CNTV2LinuxDriverInterface::GetInterruptCount (const INTERRUPT_ENUMS eInterr
 		return false;
 	}
 
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_INTERRUPT_COUNT, eInterruptType, 0, 0, &outCount);
 	NTV2_INTERRUPT_CONTROL_STRUCT intrControlStruct;
 	memset(&intrControlStruct, 0, sizeof(NTV2_INTERRUPT_CONTROL_STRUCT));// Suppress valgrind error
 	intrControlStruct.eInterruptType = eGetIntCount;
@@ -271,7 +401,7 @@ bool CNTV2LinuxDriverInterface::GetInterruptCount (const INTERRUPT_ENUMS eInterr
 		{LDIFAIL("IOCTL_NTV2_INTERRUPT_CONTROL failed");	return false;}
 
 	outCount = intrControlStruct.interruptCount;
-	return true;
+	return trace.Done(true);
 }
 
 static const uint32_t sIntEnumToStatKeys[] = {	AJA_DebugStat_WaitForInterruptOut1,		//	eOutput1	//	0
@@ -297,8 +427,9 @@ static const uint32_t sIntEnumToStatKeys[] = {	AJA_DebugStat_WaitForInterruptOut
 // Output: True on successs, false on failure (ioctl failed or interrupt didn't happen)
 bool CNTV2LinuxDriverInterface::WaitForInterrupt (const INTERRUPT_ENUMS eInterrupt, const ULWord timeOutMs)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_WAIT_INTERRUPT, eInterrupt, timeOutMs);
 	if (IsRemote())
-		return CNTV2DriverInterface::WaitForInterrupt(eInterrupt, timeOutMs);
+		return trace.Done(CNTV2DriverInterface::WaitForInterrupt(eInterrupt, timeOutMs));
 
 	NTV2_ASSERT( (_hDevice != INVALID_HANDLE_VALUE) && (_hDevice != 0) );
 
@@ -313,7 +444,107 @@ bool CNTV2LinuxDriverInterface::WaitForInterrupt (const INTERRUPT_ENUMS eInterru
 	if (result)
 		{LDIFAIL("IOCTL_NTV2_WAITFOR_INTERRUPT failed");	return false;}
 	BumpEventCount (eInterrupt);
-	return waitIntrStruct.success != 0;
+	return trace.Done(waitIntrStruct.success != 0);
+}
+
+// Method: WaitForAnyInterrupt
+// Output: True if any of the given interrupts fired, false on timeout or failure
+bool CNTV2LinuxDriverInterface::WaitForAnyInterrupt (NTV2InterruptWaitSet & inOutWaitSet, const ULWord inTimeoutMs)
+{
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_WAIT_ANY_INTERRUPT, inOutWaitSet.GetMask(), inTimeoutMs);
+	if (IsRemote()  ||  _noWaitForAnyIoctl)
+		return trace.Done(CNTV2DriverInterface::WaitForAnyInterrupt(inOutWaitSet, inTimeoutMs));
+	if (!IsOpen())
+		{LDIFAIL("Device not open");  return false;}
+
+	NTV2_ASSERT( (_hDevice != INVALID_HANDLE_VALUE) && (_hDevice != 0) );
+	inOutWaitSet.StartWait();
+	if (inOutWaitSet.IsEmpty())
+		{LDIFAIL("No interrupts to wait on");  return false;}
+
+	NTV2_WAITFOR_ANY_INTERRUPT_STRUCT waitAnyStruct;
+	memset(&waitAnyStruct, 0, sizeof(waitAnyStruct));
+	waitAnyStruct.interruptMask = inOutWaitSet.GetMask();
+	waitAnyStruct.baselineMask = inOutWaitSet.GetBaselineMask();
+	waitAnyStruct.timeOutMs = inTimeoutMs;
+	for (int intr(0);  intr < eNumInterruptTypes;  intr++)
+		waitAnyStruct.counts[intr] = inOutWaitSet.GetCount(INTERRUPT_ENUMS(intr));
+
+	AJADebug::StatTimerStart(AJA_DebugStat_WaitForInterruptOthers);
+	const int result (ioctl(int(_hDevice), IOCTL_NTV2_WAITFOR_ANY_INTERRUPT, &waitAnyStruct));
+	AJADebug::StatTimerStop(AJA_DebugStat_WaitForInterruptOthers);
+	if (result  &&  (errno == ENOTTY  ||  errno == EINVAL))
+	{	//	Older driver
+		LDINOTE("IOCTL_NTV2_WAITFOR_ANY_INTERRUPT unsupported by driver -- will poll interrupt counts instead");
+		_noWaitForAnyIoctl = true;
+		return trace.Done(CNTV2DriverInterface::WaitForAnyInterrupt(inOutWaitSet, inTimeoutMs));
+	}
+	if (result  &&  errno != ETIMEDOUT)
+		{LDIFAIL("IOCTL_NTV2_WAITFOR_ANY_INTERRUPT failed, errno=" << errno);	return false;}
+
+	//	The driver returns counts & times even upon timeout, which establishes the baseline for the next wait
+	for (int intr(0);  intr < eNumInterruptTypes;  intr++)
+		if (inOutWaitSet.Contains(INTERRUPT_ENUMS(intr)))
+			if (inOutWaitSet.SetResult(INTERRUPT_ENUMS(intr), waitAnyStruct.counts[intr], ULWord64(waitAnyStruct.times[intr])))
+				BumpEventCount(INTERRUPT_ENUMS(intr));
+	trace.SetArg(2, inOutWaitSet.GetFiredMask());
+	return trace.Done(inOutWaitSet.GetFiredMask() != 0);
+}
+
+// Method: WaitForInterruptSnapshot
+// Output: True if the interrupt happened and the requested values were captured, false on timeout or failure
+bool CNTV2LinuxDriverInterface::WaitForInterruptSnapshot (const INTERRUPT_ENUMS inInterrupt, NTV2InterruptSnapshot & inOutSnapshot, const ULWord inTimeoutMs)
+{
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_WAIT_INTERRUPT_SNAPSHOT, inInterrupt, inTimeoutMs);
+	if (IsRemote()  ||  _noWaitForSnapshotIoctl)
+		return trace.Done(CNTV2DriverInterface::WaitForInterruptSnapshot(inInterrupt, inOutSnapshot, inTimeoutMs));
+	if (!IsOpen())
+		{LDIFAIL("Device not open");  return false;}
+
+	NTV2_ASSERT( (_hDevice != INVALID_HANDLE_VALUE) && (_hDevice != 0) );
+	inOutSnapshot.StartCapture(inInterrupt);
+	if (!NTV2_IS_VALID_INTERRUPT_ENUM(inInterrupt))
+		{LDIFAIL("Invalid interrupt " << DEC(inInterrupt));  return false;}
+
+	NTV2_WAITFOR_INTERRUPT_SNAPSHOT_STRUCT snapStruct;
+	memset(&snapStruct, 0, sizeof(snapStruct));
+	snapStruct.eInterruptType = inInterrupt;
+	snapStruct.timeOutMs = inTimeoutMs;
+	const NTV2RegNumSet & regNums (inOutSnapshot.GetRegisters());
+	for (NTV2RegNumSetConstIter it(regNums.begin());  it != regNums.end()  &&  snapStruct.numRegisters < NTV2_INTERRUPT_SNAPSHOT_MAX_REGISTERS;  ++it)
+		snapStruct.registers[snapStruct.numRegisters++] = *it;
+	const NTV2CrosspointSet & crosspoints (inOutSnapshot.GetAutoCirculates());
+	for (NTV2CrosspointSet::const_iterator it(crosspoints.begin());  it != crosspoints.end()  &&  snapStruct.numAutoCirculate < NTV2_INTERRUPT_SNAPSHOT_MAX_AUTOCIRCULATE;  ++it)
+		snapStruct.acStatus[snapStruct.numAutoCirculate++].channelSpec = *it;
+
+	AJADebug::StatTimerStart(sIntEnumToStatKeys[inInterrupt]);
+	const int result (ioctl(int(_hDevice), IOCTL_NTV2_WAITFOR_INTERRUPT_SNAPSHOT, &snapStruct));
+	AJADebug::StatTimerStop(sIntEnumToStatKeys[inInterrupt]);
+	if (result  &&  (errno == ENOTTY  ||  errno == EINVAL))
+	{	//	Older driver
+		LDINOTE("IOCTL_NTV2_WAITFOR_INTERRUPT_SNAPSHOT unsupported by driver -- will wait, then read registers instead");
+		_noWaitForSnapshotIoctl = true;
+		return trace.Done(CNTV2DriverInterface::WaitForInterruptSnapshot(inInterrupt, inOutSnapshot, inTimeoutMs));
+	}
+	if (result)
+	{
+		if (errno != ETIMEDOUT)
+			LDIFAIL("IOCTL_NTV2_WAITFOR_INTERRUPT_SNAPSHOT failed, errno=" << errno);
+		return false;
+	}
+
+	for (ULWord ndx(0);  ndx < snapStruct.numRegisters;  ndx++)
+		inOutSnapshot.SetRegisterValue(snapStruct.registers[ndx], snapStruct.values[ndx]);
+	for (ULWord ndx(0);  ndx < snapStruct.numAutoCirculate;  ndx++)
+	{
+		AUTOCIRCULATE_STATUS acStatus;
+		acStatus.CopyFrom(snapStruct.acStatus[ndx]);
+		inOutSnapshot.SetAutoCirculateStatus(acStatus);
+	}
+	inOutSnapshot.SetInterrupt(snapStruct.interruptCount, snapStruct.interruptTime, snapStruct.coherent != 0);
+	BumpEventCount(inInterrupt);
+	trace.SetArg(2, snapStruct.coherent);
+	return trace.Done(true);
 }
 
 // Method: ControlDriverDebugMessages
@@ -614,13 +845,14 @@ bool CNTV2LinuxDriverInterface::DmaTransfer (	const NTV2DMAEngine inDMAEngine,
 {
 	if (!IsOpen())
 		return false;
+	NTV2DriverTraceScope trace (mpDriverTrace, inIsRead ? NTV2_TRACE_DMA_READ : NTV2_TRACE_DMA_WRITE, inDMAEngine, inFrameNumber, inByteCount);
 	if (IsRemote())
 	{
 		NTV2Buffer buffer(pFrameBuffer, inByteCount);
-		return _pRPCAPI->NTV2DMATransferRemote (inDMAEngine, inIsRead, inFrameNumber,
+		return trace.Done(_pRPCAPI->NTV2DMATransferRemote (inDMAEngine, inIsRead, inFrameNumber,
 												buffer, inOffsetBytes, 0/*numSegs*/,
 												0/*hostPitch*/,  0/*cardPitch*/,
-												inSynchronous);
+												inSynchronous));
 	}
 	NTV2_DMA_CONTROL_STRUCT dmaControlBuf;
 	dmaControlBuf.engine			= inDMAEngine;
@@ -689,7 +921,7 @@ bool CNTV2LinuxDriverInterface::DmaTransfer (	const NTV2DMAEngine inDMAEngine,
 		LDIFAIL(errMsg << " FRM=" << inFrameNumber << " ENG=" << inDMAEngine << " CNT=" << inByteCount);
 		return false;
 	}
-	return true;
+	return trace.Done(true);
 }
 
 bool CNTV2LinuxDriverInterface::DmaTransfer (const NTV2DMAEngine	inDMAEngine,
@@ -705,11 +937,12 @@ bool CNTV2LinuxDriverInterface::DmaTransfer (const NTV2DMAEngine	inDMAEngine,
 {
 	if (!IsOpen())
 		return false;
+	NTV2DriverTraceScope trace (mpDriverTrace, inIsRead ? NTV2_TRACE_DMA_READ : NTV2_TRACE_DMA_WRITE, inDMAEngine, inFrameNumber, inByteCount);
 	if (IsRemote())
 	{
 		NTV2Buffer buffer(pFrameBuffer, inByteCount);
-		return _pRPCAPI->NTV2DMATransferRemote (inDMAEngine, inIsRead, inFrameNumber, buffer, inOffsetBytes,
-												inNumSegments, inHostPitch, inCardPitch, inIsSynchronous);
+		return trace.Done(_pRPCAPI->NTV2DMATransferRemote (inDMAEngine, inIsRead, inFrameNumber, buffer, inOffsetBytes,
+												inNumSegments, inHostPitch, inCardPitch, inIsSynchronous));
 	}
 	LDIDBG("FRM=" << inFrameNumber << " ENG=" << inDMAEngine << " NB=" << inByteCount << (inIsRead?" Rd":" Wr"));
 
@@ -779,7 +1012,7 @@ bool CNTV2LinuxDriverInterface::DmaTransfer (const NTV2DMAEngine	inDMAEngine,
 		LDIFAIL(errMsg << " FRM=" << inFrameNumber << " ENG=" << inDMAEngine << " CNT=" << inByteCount);
 		return false;
 	}
-	return true;
+	return trace.Done(true);
 }
 
 
@@ -796,9 +1029,10 @@ bool CNTV2LinuxDriverInterface::DmaTransfer (	const NTV2DMAEngine			inDMAEngine,
 {
 	if (!IsOpen())
 		return false;
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_DMA_P2P, inDMAEngine, inFrameNumber, inByteCount);
 	if (IsRemote())
-		return CNTV2DriverInterface::DmaTransfer (inDMAEngine, inDMAChannel, inIsTarget, inFrameNumber, inCardOffsetBytes, inByteCount,
-													inNumSegments, inSegmentHostPitch, inSegmentCardPitch, inP2PData);
+		return trace.Done(CNTV2DriverInterface::DmaTransfer (inDMAEngine, inDMAChannel, inIsTarget, inFrameNumber, inCardOffsetBytes, inByteCount,
+													inNumSegments, inSegmentHostPitch, inSegmentCardPitch, inP2PData));
 	if (!inP2PData)
 	{
 		LDIFAIL( "P2PData is NULL" );
@@ -848,15 +1082,16 @@ bool CNTV2LinuxDriverInterface::DmaTransfer (	const NTV2DMAEngine			inDMAEngine,
 	inP2PData->messageBusAddress	= dmaP2PStruct.ullMessageBusAddress;
 	inP2PData->videoBusSize			= dmaP2PStruct.ulVideoBusSize;
 	inP2PData->messageData			= dmaP2PStruct.ulMessageData;
-	return true;
+	return trace.Done(true);
 }
 
 ///////////////////////////////////////////////////////////////////////////
 // AutoCirculate
 bool CNTV2LinuxDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_AUTOCIRCULATE, autoCircData.eCommand, autoCircData.channelSpec);
 	if (IsRemote())
-		return CNTV2DriverInterface::AutoCirculate(autoCircData);
+		return trace.Done(CNTV2DriverInterface::AutoCirculate(autoCircData));
 	if (!IsOpen())
 		return false;
 
@@ -879,7 +1114,7 @@ bool CNTV2LinuxDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData
 			AJADebug::StatTimerStart(AJA_DebugStat_AutoCirculate);
 			if (result)
 				{LDIFAIL("IOCTL_NTV2_AUTOCIRCULATE_CONTROL failed");  return false;}
-			return true;
+			return trace.Done(true);
 
 		case eGetAutoCirc:
 			// Pass the autoCircStatus structure to the driver.
@@ -890,7 +1125,7 @@ bool CNTV2LinuxDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData
 			AJADebug::StatTimerStop(AJA_DebugStat_AutoCirculate);
 			if (result)
 				{LDIFAIL("IOCTL_NTV2_AUTOCIRCULATE_STATUS, failed");  return false;}
-			return true;
+			return trace.Done(true);
 
 		case eGetFrameStamp:
 		{
@@ -908,7 +1143,7 @@ bool CNTV2LinuxDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData
 			if (result)
 				{LDIFAIL("IOCTL_NTV2_AUTOCIRCULATE_FRAMESTAMP failed");	 return false;}
 			*pFrameStamp = acFrameStampCombo.acFrameStamp;
-			return true;
+			return trace.Done(true);
 		}
 
 		case eGetFrameStampEx2:
@@ -932,7 +1167,7 @@ bool CNTV2LinuxDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData
 			*pFrameStamp = acFrameStampCombo.acFrameStamp;
 			if (pTask)
 				*pTask = acFrameStampCombo.acTask;
-			return true;
+			return trace.Done(true);
 		}
 
 		case eTransferAutoCirculate:
@@ -973,7 +1208,7 @@ bool CNTV2LinuxDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData
 				{LDIFAIL("IOCTL_NTV2_AUTOCIRCULATE_TRANSFER failed");  return false;}
 			// Copy the results back into the status buffer we were given
 			*acStatus = acXferCombo.acStatus;
-			return true;
+			return trace.Done(true);
 		}
 
 		case eTransferAutoCirculateEx:
@@ -1014,7 +1249,7 @@ bool CNTV2LinuxDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData
 				{LDIFAIL("IOCTL_NTV2_AUTOCIRCULATE_TRANSFER failed");  return false;}
 			// Copy the results back into the status buffer we were given
 			*acStatus = acXferCombo.acStatus;
-			return true;
+			return trace.Done(true);
 		}
 
 		case eTransferAutoCirculateEx2:
@@ -1056,7 +1291,7 @@ bool CNTV2LinuxDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData
 				{LDIFAIL("IOCTL_NTV2_AUTOCIRCULATE_TRANSFER failed");  return false;}
 			// Copy the results back into the status buffer we were given
 			*acStatus = acXferCombo.acStatus;
-			return true;
+			return trace.Done(true);
 		}
 
 		case eSetCaptureTask:
@@ -1071,7 +1306,7 @@ bool CNTV2LinuxDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData
 			AJADebug::StatTimerStop(AJA_DebugStat_AutoCirculate);
 			if (result)
 				{LDIFAIL("IOCTL_NTV2_AUTOCIRCULATE_CAPTURETASK failed");  return false;}
-			return true;
+			return trace.Done(true);
 		}
 
 		default:
@@ -1087,8 +1322,9 @@ bool CNTV2LinuxDriverInterface::NTV2Message (NTV2_HEADER * pInMessage)
 	if (!pInMessage)
 		return false;	//	NULL message pointer
 
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_MESSAGE, pInMessage->GetType(), pInMessage->GetSizeInBytes());
 	if (IsRemote())
-		return CNTV2DriverInterface::NTV2Message(pInMessage);	//	Implement NTV2Message on nub
+		return trace.Done(CNTV2DriverInterface::NTV2Message(pInMessage));	//	Implement NTV2Message on nub
 
 	NTV2_ASSERT( (_hDevice != INVALID_HANDLE_VALUE) && (_hDevice != 0) );
 	AJADebug::StatTimerStart(AJA_DebugStat_NTV2Message);
@@ -1096,7 +1332,7 @@ bool CNTV2LinuxDriverInterface::NTV2Message (NTV2_HEADER * pInMessage)
 	AJADebug::StatTimerStop(AJA_DebugStat_NTV2Message);
 	if (result)
 		{LDIFAIL("IOCTL_AJANTV2_MESSAGE failed");	return false;}
-	return true;
+	return trace.Done(true);
 }
 
 bool CNTV2LinuxDriverInterface::HevcSendMessage (HevcMessageHeader* pMessage)
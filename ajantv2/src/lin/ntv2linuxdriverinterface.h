@@ -33,6 +33,31 @@ class CNTV2LinuxDriverInterface : public CNTV2DriverInterface
 
 		AJA_VIRTUAL bool	RestoreHardwareProcampRegisters (void);
 
+		/**
+			@brief		Enables or disables my memory-mapped register read fast path. When enabled, ReadRegister answers reads
+						of real registers that are safe to read directly (see IsMappedRegisterReadSafe) from the device's
+						register BAR, mapped into my address space, without a driver call. All other reads, and all writes,
+						still go through the driver. Disabled by default.
+			@param[in]	inEnable	Specify true to map the registers and enable the fast path;  false to disable it and unmap them.
+			@return		True if successful;  otherwise false (e.g. remote device, or the driver doesn't expose the
+						registers in BAR0).
+			@note		Mapped reads bypass the driver's register lock, and can't tell when the driver has disabled register
+						access (e.g. while the device is being reprogrammed).
+			@note		Disabling only stops ReadRegister from using the mapping, so it's safe while other threads are reading
+						registers. The registers stay mapped (and re-enabling reuses the mapping) until the device is closed.
+		**/
+		AJA_VIRTUAL bool	SetMappedRegisterReads (const bool inEnable);
+		AJA_VIRTUAL inline bool	IsMappedRegisterReadsEnabled (void) const	{return _pMappedRegisters != AJA_NULL;}	///< @return	True if my memory-mapped register read fast path is enabled.
+
+		/**
+			@return		True if the given register can be read straight from the mapped register BAR with the same result
+						the driver would give. That's true for real registers that belong only to register classes whose
+						reads have no side effects and aren't serviced by the driver itself (e.g. not serial port FIFOs,
+						DMA engine, LUT or IP registers, write-only registers, or virtual registers).
+			@param[in]	inRegNum	Specifies the register number of interest.
+		**/
+		static bool			IsMappedRegisterReadSafe (const ULWord inRegNum);
+
 		AJA_VIRTUAL bool	DmaTransfer (const NTV2DMAEngine	inDMAEngine,
 										const bool				inIsRead,
 										const ULWord			inFrameNumber,
@@ -68,6 +93,8 @@ class CNTV2LinuxDriverInterface : public CNTV2DriverInterface
 	AJA_VIRTUAL bool ConfigureInterrupt (const bool bEnable, const INTERRUPT_ENUMS eInterruptType);
 	AJA_VIRTUAL bool GetInterruptCount (const INTERRUPT_ENUMS eInterrupt, ULWord & outCount);
 	AJA_VIRTUAL bool WaitForInterrupt (INTERRUPT_ENUMS eInterrupt, ULWord timeOutMs = 68);	// default of 68 ms timeout is enough time for 2K at 14.98 HZ
+	AJA_VIRTUAL bool WaitForAnyInterrupt (NTV2InterruptWaitSet & inOutWaitSet, const ULWord inTimeoutMs = 68);	// falls back to polling on drivers that predate IOCTL_NTV2_WAITFOR_ANY_INTERRUPT
+	AJA_VIRTUAL bool WaitForInterruptSnapshot (const INTERRUPT_ENUMS inInterrupt, NTV2InterruptSnapshot & inOutSnapshot, const ULWord inTimeoutMs = 68);	// falls back to wait-then-read on drivers that predate IOCTL_NTV2_WAITFOR_INTERRUPT_SNAPSHOT
 
 	AJA_VIRTUAL bool AutoCirculate (AUTOCIRCULATE_DATA &autoCircData);
 	AJA_VIRTUAL bool NTV2Message (NTV2_HEADER * pInOutMessage);
@@ -121,15 +148,22 @@ public:
 	AJA_VIRTUAL bool SetAudioOutputMode(NTV2_GlobalAudioPlaybackMode mode); // Supported!
 	AJA_VIRTUAL bool GetAudioOutputMode(NTV2_GlobalAudioPlaybackMode* mode);// Supported!
 
-#if !defined(NTV2_NULL_DEVICE)
 protected:	//	PRIVATE METHODS
+#if !defined(NTV2_NULL_DEVICE)
 	AJA_VIRTUAL bool	OpenLocalPhysical (const UWord inDeviceIndex);	///< @brief Opens the local/physical device connection.
 	AJA_VIRTUAL bool	CloseLocalPhysical	(void);
 #endif	//	!defined(NTV2_NULL_DEVICE)
+	AJA_VIRTUAL void *	MapRegisterBAR (const ULWord inByteCount);	///< @brief	Maps my register BAR (read-only) for SetMappedRegisterReads. @return	Its address, or NULL upon failure.
+	AJA_VIRTUAL void	UnmapRegisterBAR (void * pInBAR, const ULWord inByteCount);	///< @brief	Unmaps a register BAR that MapRegisterBAR mapped.
 
 protected:	//	INSTANCE DATA
 	std::string		_bitfileDirectory;
 	HANDLE			_hDevice;
+	volatile ULWord * volatile	_pMappedRegisters;	///< @brief	Register BAR that ReadRegister reads from, if my fast path is enabled (or NULL)
+	volatile ULWord *	_pMappedRegisterBAR;	///< @brief	Register BAR mapped by SetMappedRegisterReads, and kept until I'm closed (or NULL)
+	ULWord			_mappedRegistersSize;		///< @brief	Size of _pMappedRegisterBAR, in bytes
+	bool			_noWaitForAnyIoctl;			///< @brief	True if the driver lacks IOCTL_NTV2_WAITFOR_ANY_INTERRUPT
+	bool			_noWaitForSnapshotIoctl;	///< @brief	True if the driver lacks IOCTL_NTV2_WAITFOR_INTERRUPT_SNAPSHOT
 #if !defined(NTV2_DEPRECATE_16_0)
 	ULWord *		_pDMADriverBufferAddress;
 	ULWord			_BA0MemorySize;
@@ -67,6 +67,16 @@
 #define IOCTL_NTV2_WAITFOR_INTERRUPT \
 			_IOW(NTV2_DEVICE_TYPE, 221, NTV2_WAITFOR_INTERRUPT_STRUCT)
 
+// Wait for any of several interrupts
+//
+#define IOCTL_NTV2_WAITFOR_ANY_INTERRUPT \
+			_IOWR(NTV2_DEVICE_TYPE, 222, NTV2_WAITFOR_ANY_INTERRUPT_STRUCT)
+
+// Wait for interrupt, then capture registers and autocirculate status
+//
+#define IOCTL_NTV2_WAITFOR_INTERRUPT_SNAPSHOT \
+			_IOWR(NTV2_DEVICE_TYPE, 223, NTV2_WAITFOR_INTERRUPT_SNAPSHOT_STRUCT)
+
 // Control debug messages.
 //
 #define IOCTL_NTV2_CONTROL_DRIVER_DEBUG_MESSAGES \
@@ -211,6 +221,34 @@ typedef struct
    ULWord			success;		// On return, nonzero if interrupt occured
 } NTV2_WAITFOR_INTERRUPT_STRUCT, *P_NTV2_WAITFOR_INTERRUPT_STRUCT;
 
+// Structure to wait for any of several interrupts
+typedef struct
+{
+   ULWord64			interruptMask;	// In: which interrupts to wait on (bit N is INTERRUPT_ENUMS value N)
+   ULWord64			baselineMask;	// In: interrupts whose counts[] entry holds the caller's last-seen count (others use the count at entry)
+   ULWord64			firedMask;		// Out: interrupts whose count changed
+   ULWord			timeOutMs;		// In: timeout in milliseconds
+   ULWord			reserved;
+   ULWord64			counts[eNumInterruptTypes];	// In: last-seen interrupt counts.  Out: current interrupt counts
+   ULWord64			times[eNumInterruptTypes];	// Out: time of most recent interrupt (100ns units)
+} NTV2_WAITFOR_ANY_INTERRUPT_STRUCT, *P_NTV2_WAITFOR_ANY_INTERRUPT_STRUCT;
+
+// Structure to wait for an interrupt and capture registers and autocirculate status as soon as it happens
+typedef struct
+{
+   INTERRUPT_ENUMS	eInterruptType;		// In: which interrupt to wait on
+   ULWord			timeOutMs;			// In: timeout in milliseconds
+   ULWord			numRegisters;		// In: number of registers[] entries to read
+   ULWord			numAutoCirculate;	// In: number of acStatus[] entries to fill
+   ULWord			coherent;			// Out: nonzero if no other interrupt of this type happened during the capture
+   ULWord			reserved;
+   ULWord64			interruptCount;		// Out: interrupt count
+   ULWord64			interruptTime;		// Out: time of most recent interrupt (100ns units)
+   ULWord			registers[NTV2_INTERRUPT_SNAPSHOT_MAX_REGISTERS];	// In: register numbers
+   ULWord			values[NTV2_INTERRUPT_SNAPSHOT_MAX_REGISTERS];		// Out: register values
+   AUTOCIRCULATE_STATUS_STRUCT	acStatus[NTV2_INTERRUPT_SNAPSHOT_MAX_AUTOCIRCULATE];	// In: channelSpec.  Out: status
+} NTV2_WAITFOR_INTERRUPT_SNAPSHOT_STRUCT, *P_NTV2_WAITFOR_INTERRUPT_SNAPSHOT_STRUCT;
+
 // Structure to control driver debug messages
 typedef struct
 {
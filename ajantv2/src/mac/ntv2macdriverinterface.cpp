@@ -16,6 +16,7 @@
 #include <map>
 #include <iomanip>
 #include "ntv2devicefeatures.h"
+#include "ntv2drivertrace.h"
 #include "ajabase/system/lock.h"
 #include "ajabase/system/debug.h"
 #include "ajabase/system/atomic.h"
@@ -393,12 +394,17 @@ bool CNTV2MacDriverInterface::ReadRegister (const ULWord inRegNum, ULWord & outV
 		DIFAIL("Shift " << DEC(inShift) << " > 31, reg=" << DEC(inRegNum) << " msk=" << xHEX0N(inMask,8));
 		return false;
 	}
+	bool cacheable(false);
+	if ((mpRegCache || mpRegWriteTxn)  &&  RegCacheRead(inRegNum, outValue, inMask, inShift, cacheable))
+		return true;	//	Answered from shadow register cache or pending register write transaction
+	const ULWord regMask(cacheable ? 0xFFFFFFFF : inMask), regShift(cacheable ? 0 : inShift);	//	Cache entire register
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_READ_REGISTER, inRegNum, inMask, 0, &outValue);
 #if defined (NTV2_NUB_CLIENT_SUPPORT)
 	if (IsRemote())
-		return CNTV2DriverInterface::ReadRegister(inRegNum, outValue, inMask, inShift);
+		return trace.Done(RegCacheFill(CNTV2DriverInterface::ReadRegister(inRegNum, outValue, regMask, regShift), cacheable, inRegNum, outValue, inMask, inShift));
 #endif	//	defined (NTV2_NUB_CLIENT_SUPPORT)
 	kern_return_t kernResult(KERN_FAILURE);
-	uint64_t	scalarI_64[3] = {inRegNum, inMask, inShift};
+	uint64_t	scalarI_64[3] = {inRegNum, regMask, regShift};
 	uint64_t	scalarO_64 = outValue;
 	uint32_t	outputCount = 1;
 	if (GetIOConnect())
@@ -414,7 +420,7 @@ bool CNTV2MacDriverInterface::ReadRegister (const ULWord inRegNum, ULWord & outV
 	}
 	outValue = uint32_t(scalarO_64);
 	if (kernResult == KERN_SUCCESS)
-		return true;
+		return trace.Done(RegCacheFill(true, cacheable, inRegNum, outValue, inMask, inShift));
 	DIFAIL(KR(kernResult) << ": ndx=" << _boardNumber << ", con=" << HEX8(GetIOConnect())
 			<< " -- reg=" << DEC(inRegNum) << ", mask=" << HEX8(inMask) << ", shift=" << HEX8(inShift));
 	return false;
@@ -443,9 +449,12 @@ bool CNTV2MacDriverInterface::WriteRegister (const ULWord inRegNum, const ULWord
 			return true;
 	}
 #endif	//	defined(NTV2_WRITEREG_PROFILING)	//	Register Write Profiling
+	if (mpRegWriteTxn  &&  RegWriteTxnIntercept(inRegNum, inValue, inMask, inShift))
+		return true;	//	Deferred until register write transaction is committed
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_WRITE_REGISTER, inRegNum, inMask, inValue);
 #if defined(NTV2_NUB_CLIENT_SUPPORT)
 	if (IsRemote())
-		return CNTV2DriverInterface::WriteRegister(inRegNum, inValue, inMask, inShift);
+		return trace.Done(RegCacheWriteThrough(CNTV2DriverInterface::WriteRegister(inRegNum, inValue, inMask, inShift), inRegNum, inValue, inMask, inShift));
 #endif	//	defined (NTV2_NUB_CLIENT_SUPPORT)
 	kern_return_t kernResult(KERN_FAILURE);
 	uint64_t	scalarI_64[4] = {inRegNum, inValue, inMask, inShift};
@@ -462,10 +471,10 @@ bool CNTV2MacDriverInterface::WriteRegister (const ULWord inRegNum, const ULWord
 		AJADebug::StatTimerStop(AJA_DebugStat_WriteRegister);
 	}
 	if (kernResult == KERN_SUCCESS)
-		return true;
+		return trace.Done(RegCacheWriteThrough(true, inRegNum, inValue, inMask, inShift));
 	DIFAIL (KR(kernResult) << ": con=" << HEX8(GetIOConnect()) << " -- reg=" << inRegNum
 			<< ", val=" << HEX8(inValue) << ", mask=" << HEX8(inMask) << ", shift=" << HEX8(inShift));
-	return false;
+	return RegCacheWriteThrough(false, inRegNum, inValue, inMask, inShift);
 }
 
 
@@ -725,10 +734,11 @@ static const uint32_t sIntEnumToStatKeys[] = {	AJA_DebugStat_WaitForInterruptOut
 //--------------------------------------------------------------------------------------------------------------------
 bool CNTV2MacDriverInterface::WaitForInterrupt (const INTERRUPT_ENUMS type, const ULWord timeout)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_WAIT_INTERRUPT, type, timeout);
 	if (IsRemote())
-		return CNTV2DriverInterface::WaitForInterrupt(type, timeout);
+		return trace.Done(CNTV2DriverInterface::WaitForInterrupt(type, timeout));
 	if (type == eChangeEvent)
-		return WaitForChangeEvent(timeout);
+		return trace.Done(WaitForChangeEvent(timeout));
 
 	kern_return_t	kernResult	= KERN_FAILURE;
 	uint64_t	scalarI_64[2]	= {type, timeout};
@@ -753,7 +763,7 @@ bool CNTV2MacDriverInterface::WaitForInterrupt (const INTERRUPT_ENUMS type, cons
 		{DIFAIL (KR(kernResult) << ": con=" << HEX8(GetIOConnect()));  return false;}
 	if (interruptOccurred)
 		BumpEventCount(type);
-	return interruptOccurred;
+	return trace.Done(interruptOccurred);
 }
 
 //--------------------------------------------------------------------------------------------------------------------
@@ -763,6 +773,7 @@ bool CNTV2MacDriverInterface::WaitForInterrupt (const INTERRUPT_ENUMS type, cons
 //--------------------------------------------------------------------------------------------------------------------
 bool CNTV2MacDriverInterface::GetInterruptCount (const INTERRUPT_ENUMS eInterrupt, ULWord & outCount)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_INTERRUPT_COUNT, eInterrupt, 0, 0, &outCount);
 	kern_return_t	kernResult	= KERN_FAILURE;
 	uint64_t	scalarI_64[1]	= {eInterrupt};
 	uint64_t	scalarO_64		= 0;
@@ -780,7 +791,7 @@ bool CNTV2MacDriverInterface::GetInterruptCount (const INTERRUPT_ENUMS eInterrup
 	}
 	outCount = ULWord(scalarO_64);
 	if (kernResult == KERN_SUCCESS)
-		return true;
+		return trace.Done(true);
 	DIFAIL(KR(kernResult) << ": con=" << HEX8(GetIOConnect()));
 	return false;
 }
@@ -829,9 +840,10 @@ bool CNTV2MacDriverInterface::DmaTransfer ( const NTV2DMAEngine inDMAEngine,
 											const ULWord		inByteCount,
 											const bool			inSynchronous)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, inIsRead ? NTV2_TRACE_DMA_READ : NTV2_TRACE_DMA_WRITE, inDMAEngine, inFrameNumber, inByteCount);
 	if (IsRemote())
-		return CNTV2DriverInterface::DmaTransfer(inDMAEngine, inIsRead, inFrameNumber, pFrameBuffer,
-												inOffsetBytes, inByteCount, inSynchronous);
+		return trace.Done(CNTV2DriverInterface::DmaTransfer(inDMAEngine, inIsRead, inFrameNumber, pFrameBuffer,
+												inOffsetBytes, inByteCount, inSynchronous));
 	if (!IsOpen())
 		return false;
 	kern_return_t kernResult = KERN_FAILURE;
@@ -849,7 +861,7 @@ bool CNTV2MacDriverInterface::DmaTransfer ( const NTV2DMAEngine inDMAEngine,
 		AJADebug::StatTimerStop(AJA_DebugStat_DMATransfer);
 	}
 	if (kernResult == KERN_SUCCESS)
-		return true;
+		return trace.Done(true);
 	DIFAIL(KR(kernResult) << ": con=" << HEX8(GetIOConnect()) << ", eng=" << inDMAEngine << ", frm=" << inFrameNumber
 			<< ", off=" << HEX8(inOffsetBytes) << ", len=" << HEX8(inByteCount) << ", " << (inIsRead ? "R" : "W"));
 	return false;
@@ -877,9 +889,10 @@ bool CNTV2MacDriverInterface::DmaTransfer ( const NTV2DMAEngine inDMAEngine,
 											const ULWord inSegmentCardPitch,
 											const bool inSynchronous)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, inIsRead ? NTV2_TRACE_DMA_READ : NTV2_TRACE_DMA_WRITE, inDMAEngine, inFrameNumber, inByteCount);
 	if (IsRemote())
-		return CNTV2DriverInterface::DmaTransfer (inDMAEngine, inIsRead, inFrameNumber, pFrameBuffer, inCardOffsetBytes, inByteCount,
-													inNumSegments, inSegmentHostPitch, inSegmentCardPitch, inSynchronous);
+		return trace.Done(CNTV2DriverInterface::DmaTransfer (inDMAEngine, inIsRead, inFrameNumber, pFrameBuffer, inCardOffsetBytes, inByteCount,
+													inNumSegments, inSegmentHostPitch, inSegmentCardPitch, inSynchronous));
 	if (!IsOpen())
 		return false;
 	kern_return_t kernResult = KERN_FAILURE;
@@ -911,7 +924,7 @@ bool CNTV2MacDriverInterface::DmaTransfer ( const NTV2DMAEngine inDMAEngine,
 		AJADebug::StatTimerStop(AJA_DebugStat_DMATransferEx);
 	}
 	if (kernResult == KERN_SUCCESS)
-		return true;
+		return trace.Done(true);
 	DIFAIL (KR(kernResult) << ": con=" << HEX8(GetIOConnect()));
 	return false;
 }
@@ -928,9 +941,10 @@ bool CNTV2MacDriverInterface::DmaTransfer ( const NTV2DMAEngine			inDMAEngine,
 											const ULWord				inSegmentCardPitch,
 											const PCHANNEL_P2P_STRUCT & inP2PData)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_DMA_P2P, inDMAEngine, inFrameNumber, inByteCount);
 	if (IsRemote())
-		return CNTV2DriverInterface::DmaTransfer (inDMAEngine, inDMAChannel, inIsTarget, inFrameNumber, inCardOffsetBytes, inByteCount,
-													inNumSegments, inSegmentHostPitch, inSegmentCardPitch, inP2PData);
+		return trace.Done(CNTV2DriverInterface::DmaTransfer (inDMAEngine, inDMAChannel, inIsTarget, inFrameNumber, inCardOffsetBytes, inByteCount,
+													inNumSegments, inSegmentHostPitch, inSegmentCardPitch, inP2PData));
 	return false;
 }
 
@@ -986,8 +1000,9 @@ bool CNTV2MacDriverInterface::SystemStatus ( void* dataPtr, SystemStatusCode sta
 bool CNTV2MacDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData)
 {
 	bool success = true;
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_AUTOCIRCULATE, autoCircData.eCommand, autoCircData.channelSpec);
 	if (IsRemote())
-		return CNTV2DriverInterface::AutoCirculate(autoCircData);
+		return trace.Done(CNTV2DriverInterface::AutoCirculate(autoCircData));
 
 	kern_return_t	kernResult = KERN_FAILURE;
 	io_connect_t	conn(GetIOConnect());
@@ -1123,7 +1138,7 @@ bool CNTV2MacDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData)
 	success = (kernResult == KERN_SUCCESS);
 	if (kernResult != KERN_SUCCESS && kernResult != kIOReturnOffline)
 		MDIFAIL (KR(kernResult) << INSTP(this) << ", con=" << HEX8(conn) << ", eCmd=" << autoCircData.eCommand);
-	return success;
+	return trace.Done(success);
 }	//	AutoCirculate
 
 
@@ -1135,8 +1150,9 @@ bool CNTV2MacDriverInterface::NTV2Message (NTV2_HEADER * pInOutMessage)
 		return false;
 	if (!pInOutMessage->GetSizeInBytes())
 		return false;
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_MESSAGE, pInOutMessage->GetType(), pInOutMessage->GetSizeInBytes());
 	if (IsRemote())
-		return CNTV2DriverInterface::NTV2Message (pInOutMessage);
+		return trace.Done(CNTV2DriverInterface::NTV2Message (pInOutMessage));
 
 	//	Force fOperation = 0 in SDK 16.3, to allow RPCs from 16.3 or later clients to work on servers running 16.2 or earlier drivers:
 	ULWord* pU32 = reinterpret_cast<ULWord*>(pInOutMessage); pU32[6] = 0;
@@ -1158,7 +1174,7 @@ bool CNTV2MacDriverInterface::NTV2Message (NTV2_HEADER * pInOutMessage)
 	}
 	if (kernResult != KERN_SUCCESS	&&	kernResult != kIOReturnOffline)
 		MDIFAIL (KR(kernResult) << INSTP(this) << ", con=" << HEX8(connection) << endl << *pInOutMessage);
-	return kernResult == KERN_SUCCESS;
+	return trace.Done(kernResult == KERN_SUCCESS);
 
 }	//	NTV2Message
 
@@ -0,0 +1,520 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2audioconverter.cpp
+	@brief		Implements the NTV2AudioConverter and NTV2AudioChannelMatrix classes.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2audioconverter.h"
+#include "ajabase/system/debug.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+
+using namespace std;
+
+#define ACTHIS				" " << HEX0N(uint64_t(this),16) << "::" << AJAFUNC << ": "
+#define ACFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_AudioGeneric,	ACTHIS << __x__)
+#define ACWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_AudioGeneric,	ACTHIS << __x__)
+#define ACDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_AudioGeneric,	ACTHIS << __x__)
+
+static const float	kMax24		(8388607.0f);
+static const float	kMin24		(-8388608.0f);
+static const float	kFloatTo24	(8388608.0f);			//	2^23
+static const float	k24ToFloat	(1.0f / 8388608.0f);
+static const float	kMinus3dB	(0.70710678f);
+
+
+string NTV2AudioSampleFormatToString (const NTV2AudioSampleFormat inFormat, const bool inCompactDisplay)
+{
+	switch (inFormat)
+	{
+		case NTV2_AUDIO_SAMPLE_FORMAT_S32:	return inCompactDisplay ? "S32" : "NTV2_AUDIO_SAMPLE_FORMAT_S32";
+		case NTV2_AUDIO_SAMPLE_FORMAT_S24:	return inCompactDisplay ? "S24" : "NTV2_AUDIO_SAMPLE_FORMAT_S24";
+		case NTV2_AUDIO_SAMPLE_FORMAT_S16:	return inCompactDisplay ? "S16" : "NTV2_AUDIO_SAMPLE_FORMAT_S16";
+		case NTV2_AUDIO_SAMPLE_FORMAT_F32:	return inCompactDisplay ? "F32" : "NTV2_AUDIO_SAMPLE_FORMAT_F32";
+		case NTV2_AUDIO_SAMPLE_FORMAT_INVALID:	break;
+	}
+	return inCompactDisplay ? "???" : "NTV2_AUDIO_SAMPLE_FORMAT_INVALID";
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////	NTV2AudioChannelMatrix
+
+NTV2AudioChannelMatrix::NTV2AudioChannelMatrix (const ULWord inNumOutputs, const ULWord inNumInputs)
+	:	mNumOutputs	(inNumOutputs),
+		mNumInputs	(inNumInputs),
+		mGains		(size_t(inNumOutputs) * size_t(inNumInputs), 0.0f)
+{
+}
+
+NTV2AudioChannelMatrix NTV2AudioChannelMatrix::Identity (const ULWord inNumChannels)
+{
+	NTV2AudioChannelMatrix	result (inNumChannels, inNumChannels);
+	for (ULWord chan(0);  chan < inNumChannels;  chan++)
+		result.SetGain(chan, chan, 1.0f);
+	return result;
+}
+
+NTV2AudioChannelMatrix NTV2AudioChannelMatrix::FromChannelMap (const vector<int> & inChannelMap, const ULWord inNumInputs)
+{
+	NTV2AudioChannelMatrix	result (ULWord(inChannelMap.size()), inNumInputs);
+	for (ULWord out(0);  out < ULWord(inChannelMap.size());  out++)
+		if (inChannelMap[out] >= 0)
+			result.SetGain(out, ULWord(inChannelMap[out]), 1.0f);
+	return result;
+}
+
+NTV2AudioChannelMatrix NTV2AudioChannelMatrix::Downmix51ToStereo (const ULWord inNumInputs, const ULWord inFirstInput)
+{
+	NTV2AudioChannelMatrix	result (2, inNumInputs);
+	const ULWord	L(inFirstInput), R(L+1), C(L+2), Ls(L+4), Rs(L+5);	//	LFE (L+3) is discarded
+	result.SetGain(0, L, 1.0f);		result.SetGain(0, C, kMinus3dB);	result.SetGain(0, Ls, kMinus3dB);
+	result.SetGain(1, R, 1.0f);		result.SetGain(1, C, kMinus3dB);	result.SetGain(1, Rs, kMinus3dB);
+	return result;
+}
+
+bool NTV2AudioChannelMatrix::SetGain (const ULWord inOutput, const ULWord inInput, const float inGain)
+{
+	if (inOutput >= mNumOutputs  ||  inInput >= mNumInputs)
+		return false;
+	mGains[size_t(inOutput) * mNumInputs + inInput] = inGain;
+	return true;
+}
+
+float NTV2AudioChannelMatrix::GetGain (const ULWord inOutput, const ULWord inInput) const
+{
+	if (inOutput >= mNumOutputs  ||  inInput >= mNumInputs)
+		return 0.0f;
+	return mGains[size_t(inOutput) * mNumInputs + inInput];
+}
+
+bool NTV2AudioChannelMatrix::IsRouting (void) const
+{
+	for (ULWord out(0);  out < mNumOutputs;  out++)
+	{
+		ULWord	numNonZero(0);
+		for (ULWord in(0);  in < mNumInputs;  in++)
+		{
+			const float	gain (mGains[size_t(out) * mNumInputs + in]);
+			if (gain == 0.0f)
+				continue;
+			if (gain != 1.0f  ||  ++numNonZero > 1)
+				return false;
+		}
+	}
+	return true;
+}
+
+bool NTV2AudioChannelMatrix::IsIdentity (void) const
+{
+	if (mNumOutputs != mNumInputs)
+		return false;
+	for (ULWord out(0);  out < mNumOutputs;  out++)
+		for (ULWord in(0);  in < mNumInputs;  in++)
+			if (mGains[size_t(out) * mNumInputs + in] != (in == out ? 1.0f : 0.0f))
+				return false;
+	return true;
+}
+
+int NTV2AudioChannelMatrix::GetSource (const ULWord inOutput) const
+{
+	if (inOutput >= mNumOutputs  ||  !IsRouting())
+		return -1;
+	for (ULWord in(0);  in < mNumInputs;  in++)
+		if (mGains[size_t(inOutput) * mNumInputs + in] != 0.0f)
+			return int(in);
+	return -1;
+}
+
+ostream & NTV2AudioChannelMatrix::Print (ostream & oss) const
+{
+	oss << DEC(mNumOutputs) << "x" << DEC(mNumInputs) << (IsRouting() ? " routing" : " mix") << ":";
+	for (ULWord out(0);  out < mNumOutputs;  out++)
+	{
+		oss << endl << "  out" << DEC(out) << ":";
+		for (ULWord in(0);  in < mNumInputs;  in++)
+			oss << " " << setw(6) << fixed << setprecision(3) << mGains[size_t(out) * mNumInputs + in];
+	}
+	return oss;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////	Sample Access
+
+//	Host sample values are exchanged as floats scaled to 24-bit integer units, which represents every 16- and 24-bit
+//	sample exactly. The format is switched once per channel, so each inner loop is a simple strided copy.
+
+//	Round half away from zero, then clamp. Branch-free (copysign, min, max), so loops that call these can vectorize.
+static inline int32_t Round24 (const float inValue)
+{
+	return int32_t(max(min(inValue + copysign(0.5f, inValue), kMax24), kMin24));
+}
+
+static inline int16_t Round16 (const float inValue)
+{
+	return int16_t(max(min(inValue + copysign(0.5f, inValue), 32767.0f), -32768.0f));
+}
+
+static void LoadHostChannel (const NTV2AudioSampleFormat inFormat, const UByte * pBase, const ULWord inStride,
+							const ULWord inNumFrames, float * pOut, const ULWord inOutStride)
+{
+	switch (inFormat)
+	{
+		case NTV2_AUDIO_SAMPLE_FORMAT_S32:
+		{	const int32_t *	pIn (reinterpret_cast<const int32_t*>(pBase));
+			for (ULWord frame(0);  frame < inNumFrames;  frame++)
+				pOut[frame * inOutStride] = float(pIn[frame * inStride] >> 8);
+			break;
+		}
+		case NTV2_AUDIO_SAMPLE_FORMAT_S24:
+			for (ULWord frame(0);  frame < inNumFrames;  frame++)
+			{
+				const UByte *	p (pBase + frame * inStride * 3);
+				pOut[frame * inOutStride] = float(int32_t(uint32_t(p[0]) << 8 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 24) >> 8);
+			}
+			break;
+		case NTV2_AUDIO_SAMPLE_FORMAT_S16:
+		{	const int16_t *	pIn (reinterpret_cast<const int16_t*>(pBase));
+			for (ULWord frame(0);  frame < inNumFrames;  frame++)
+				pOut[frame * inOutStride] = float(pIn[frame * inStride]) * 256.0f;
+			break;
+		}
+		case NTV2_AUDIO_SAMPLE_FORMAT_F32:
+		{	const float *	pIn (reinterpret_cast<const float*>(pBase));
+			for (ULWord frame(0);  frame < inNumFrames;  frame++)
+				pOut[frame * inOutStride] = pIn[frame * inStride] * kFloatTo24;
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////	NTV2AudioConverter
+
+NTV2AudioConverter::NTV2AudioConverter ()
+	:	mDeviceChannels	(0),
+		mHostFormat		(NTV2_AUDIO_SAMPLE_FORMAT_S32),
+		mIsPlanar		(false),
+		mDither			(true),
+		mDitherState	(0x12345678)
+{
+	SetDeviceChannels(16);
+}
+
+bool NTV2AudioConverter::SetDeviceChannels (const ULWord inNumChannels)
+{
+	if (!inNumChannels  ||  inNumChannels > 128)
+		{ACFAIL("Bad channel count " << DEC(inNumChannels));  return false;}
+	mDeviceChannels = inNumChannels;
+	mMatrix = NTV2AudioChannelMatrix::Identity(inNumChannels);
+	return true;
+}
+
+bool NTV2AudioConverter::SetHostFormat (const NTV2AudioSampleFormat inFormat, const bool inIsPlanar)
+{
+	if (!NTV2_IS_VALID_AUDIO_SAMPLE_FORMAT(inFormat))
+		{ACFAIL("Bad format " << DEC(inFormat));  return false;}
+	mHostFormat = inFormat;
+	mIsPlanar = inIsPlanar;
+	return true;
+}
+
+bool NTV2AudioConverter::SetChannelMatrix (const NTV2AudioChannelMatrix & inMatrix)
+{
+	if (!inMatrix.IsValid())
+		{ACFAIL("Empty matrix");  return false;}
+	if (inMatrix.GetNumInputs() != mDeviceChannels  &&  inMatrix.GetNumOutputs() != mDeviceChannels)
+		{ACFAIL(DEC(inMatrix.GetNumOutputs()) << "x" << DEC(inMatrix.GetNumInputs()) << " matrix doesn't fit " << DEC(mDeviceChannels) << " device channels");  return false;}
+	mMatrix = inMatrix;
+	return true;
+}
+
+ULWord NTV2AudioConverter::GetHostChannels (const bool inFromDevice) const
+{
+	return inFromDevice ? mMatrix.GetNumOutputs() : mMatrix.GetNumInputs();
+}
+
+ULWord NTV2AudioConverter::GetHostByteCount (const ULWord inNumSampleFrames, const bool inFromDevice) const
+{
+	return inNumSampleFrames * GetHostChannels(inFromDevice) * GetBytesPerSample(mHostFormat);
+}
+
+ULWord NTV2AudioConverter::GetBytesPerSample (const NTV2AudioSampleFormat inFormat)
+{
+	switch (inFormat)
+	{
+		case NTV2_AUDIO_SAMPLE_FORMAT_S32:	return 4;
+		case NTV2_AUDIO_SAMPLE_FORMAT_S24:	return 3;
+		case NTV2_AUDIO_SAMPLE_FORMAT_S16:	return 2;
+		case NTV2_AUDIO_SAMPLE_FORMAT_F32:	return 4;
+		default:							break;
+	}
+	return 0;
+}
+
+float NTV2AudioConverter::NextDither (void)
+{
+	//	Triangular PDF:  the difference of two uniform variates (xorshift32)
+	float	result (0.0f);
+	for (int ndx(0);  ndx < 2;  ndx++)
+	{
+		mDitherState ^= mDitherState << 13;
+		mDitherState ^= mDitherState >> 17;
+		mDitherState ^= mDitherState << 5;
+		const float	uniform	(float(mDitherState >> 8) * (1.0f / 16777216.0f));
+		result += ndx ? -uniform : uniform;
+	}
+	return result;
+}
+
+void NTV2AudioConverter::StoreHostChannel (const int32_t * pIn, const ULWord inStride, const ULWord inNumFrames, UByte * pOut, const ULWord inOutStride)
+{
+	switch (mHostFormat)
+	{
+		case NTV2_AUDIO_SAMPLE_FORMAT_S32:
+		{	int32_t *	pDst (reinterpret_cast<int32_t*>(pOut));
+			for (ULWord frame(0);  frame < inNumFrames;  frame++)
+				pDst[frame * inOutStride] = pIn ? pIn[frame * inStride] : 0;
+			break;
+		}
+		case NTV2_AUDIO_SAMPLE_FORMAT_S24:
+			for (ULWord frame(0);  frame < inNumFrames;  frame++)
+			{
+				const uint32_t	value	(pIn ? uint32_t(pIn[frame * inStride]) >> 8 : 0);
+				UByte *			p		(pOut + frame * inOutStride * 3);
+				p[0] = UByte(value);  p[1] = UByte(value >> 8);  p[2] = UByte(value >> 16);
+			}
+			break;
+		case NTV2_AUDIO_SAMPLE_FORMAT_S16:
+		{	int16_t *	pDst (reinterpret_cast<int16_t*>(pOut));
+			for (ULWord frame(0);  frame < inNumFrames;  frame++)
+				pDst[frame * inOutStride] = Round16((pIn ? float(pIn[frame * inStride] >> 8) * (1.0f / 256.0f) : 0.0f) + (mDither ? NextDither() : 0.0f));
+			break;
+		}
+		case NTV2_AUDIO_SAMPLE_FORMAT_F32:
+		{	float *	pDst (reinterpret_cast<float*>(pOut));
+			for (ULWord frame(0);  frame < inNumFrames;  frame++)
+				pDst[frame * inOutStride] = pIn ? float(pIn[frame * inStride]) * (1.0f / 2147483648.0f) : 0.0f;
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+bool NTV2AudioConverter::FromDevice (const NTV2Buffer & inDeviceAudio, const ULWord inNumSampleFrames, NTV2Buffer & outHostAudio)
+{
+	const ULWord	numIn	(mDeviceChannels);
+	const ULWord	numOut	(mMatrix.GetNumOutputs());
+	if (mMatrix.GetNumInputs() != numIn)
+		{ACFAIL("Matrix has " << DEC(mMatrix.GetNumInputs()) << " input(s), expected " << DEC(numIn) << " device channel(s)");  return false;}
+	if (inDeviceAudio.GetByteCount() < GetDeviceByteCount(inNumSampleFrames))
+		{ACFAIL(DEC(inNumSampleFrames) << " sample frame(s) exceed " << DEC(inDeviceAudio.GetByteCount()) << "-byte device buffer");  return false;}
+	if (outHostAudio.GetByteCount() < GetHostByteCount(inNumSampleFrames))
+		{ACFAIL(DEC(inNumSampleFrames) << " sample frame(s) exceed " << DEC(outHostAudio.GetByteCount()) << "-byte host buffer");  return false;}
+	if (!inNumSampleFrames)
+		return true;
+
+	const int32_t *	pSrc		(reinterpret_cast<const int32_t*>(inDeviceAudio.GetHostPointer()));
+	UByte *			pDst		(reinterpret_cast<UByte*>(outHostAudio.GetHostPointer()));
+	const ULWord	bps			(GetBytesPerSample(mHostFormat));
+	const bool		isRouting	(mMatrix.IsRouting());
+	const ULWord	dstStride	(mIsPlanar ? 1 : numOut);						//	In samples, between frames
+	const ULWord	dstChanStep	(mIsPlanar ? inNumSampleFrames : 1);			//	In samples, between channels
+
+	//	Fast path:  interleaved pass-through (host channel N is device channel N) converts one contiguous run of
+	//	samples, in loops with unit stride that the compiler can vectorize...
+	if (!mIsPlanar  &&  mMatrix.IsIdentity())
+	{
+		const ULWord	numSamples	(numIn * inNumSampleFrames);
+		switch (mHostFormat)
+		{
+			case NTV2_AUDIO_SAMPLE_FORMAT_S32:
+				::memcpy(pDst, pSrc, GetDeviceByteCount(inNumSampleFrames));
+				return true;
+			case NTV2_AUDIO_SAMPLE_FORMAT_S24:
+				for (ULWord ndx(0);  ndx < numSamples;  ndx++)
+				{
+					const uint32_t	value	(uint32_t(pSrc[ndx]) >> 8);
+					UByte *			p		(pDst + ndx * 3);
+					p[0] = UByte(value);  p[1] = UByte(value >> 8);  p[2] = UByte(value >> 16);
+				}
+				return true;
+			case NTV2_AUDIO_SAMPLE_FORMAT_S16:
+			{	int16_t *	pOut (reinterpret_cast<int16_t*>(pDst));
+				if (mDither)	//	The dither generator is serial, so only the undithered loop vectorizes
+					for (ULWord ndx(0);  ndx < numSamples;  ndx++)
+						pOut[ndx] = Round16(float(pSrc[ndx] >> 8) * (1.0f / 256.0f) + NextDither());
+				else
+					for (ULWord ndx(0);  ndx < numSamples;  ndx++)
+						pOut[ndx] = Round16(float(pSrc[ndx] >> 8) * (1.0f / 256.0f));
+				return true;
+			}
+			case NTV2_AUDIO_SAMPLE_FORMAT_F32:
+			{	float *	pOut (reinterpret_cast<float*>(pDst));
+				for (ULWord ndx(0);  ndx < numSamples;  ndx++)
+					pOut[ndx] = float(pSrc[ndx]) * (1.0f / 2147483648.0f);
+				return true;
+			}
+			default:
+				break;
+		}
+	}
+
+	//	Fast path:  routed (de-)interleave, one output channel at a time...
+	if (isRouting)
+	{
+		for (ULWord out(0);  out < numOut;  out++)
+		{
+			const int	source	(mMatrix.GetSource(out));
+			StoreHostChannel(source < 0 ? AJA_NULL : pSrc + source, numIn, inNumSampleFrames, pDst + out * dstChanStep * bps, dstStride);
+		}
+		return true;
+	}
+
+	//	General path:  mix each frame in 24-bit units, then store...
+	const bool	dither	(mDither  &&  mHostFormat != NTV2_AUDIO_SAMPLE_FORMAT_F32);
+	const float	scale	(mHostFormat == NTV2_AUDIO_SAMPLE_FORMAT_S16  ?  1.0f / 256.0f  :  1.0f);
+	mFrame.resize(numOut);
+	for (ULWord frame(0);  frame < inNumSampleFrames;  frame++)
+	{
+		const int32_t *	pIn (pSrc + frame * numIn);
+		for (ULWord out(0);  out < numOut;  out++)
+		{
+			const float *	pGains	(mMatrix.GetRow(out));
+			float			sum		(0.0f);
+			for (ULWord in(0);  in < numIn;  in++)
+				sum += pGains[in] * float(pIn[in] >> 8);
+			mFrame[out] = sum * scale + (dither ? NextDither() : 0.0f);
+		}
+		for (ULWord out(0);  out < numOut;  out++)
+		{
+			const ULWord	ndx	(frame * dstStride + out * dstChanStep);
+			switch (mHostFormat)
+			{
+				case NTV2_AUDIO_SAMPLE_FORMAT_S32:
+					reinterpret_cast<int32_t*>(pDst)[ndx] = int32_t(uint32_t(Round24(mFrame[out])) << 8);
+					break;
+				case NTV2_AUDIO_SAMPLE_FORMAT_S24:
+				{	const uint32_t	value (uint32_t(Round24(mFrame[out])));
+					UByte *	p (pDst + ndx * bps);
+					p[0] = UByte(value);  p[1] = UByte(value >> 8);  p[2] = UByte(value >> 16);
+					break;
+				}
+				case NTV2_AUDIO_SAMPLE_FORMAT_S16:
+					reinterpret_cast<int16_t*>(pDst)[ndx] = Round16(mFrame[out]);
+					break;
+				case NTV2_AUDIO_SAMPLE_FORMAT_F32:
+					reinterpret_cast<float*>(pDst)[ndx] = mFrame[out] * k24ToFloat;
+					break;
+				default:
+					break;
+			}
+		}
+	}
+	return true;
+}
+
+bool NTV2AudioConverter::FromDevice (const AUTOCIRCULATE_TRANSFER & inXfer, NTV2Buffer & outHostAudio, ULWord & outNumSampleFrames)
+{
+	outNumSampleFrames = inXfer.GetCapturedAudioByteCount() / (mDeviceChannels * 4);
+	return FromDevice(inXfer.acAudioBuffer, outNumSampleFrames, outHostAudio);
+}
+
+bool NTV2AudioConverter::ToDevice (const NTV2Buffer & inHostAudio, const ULWord inNumSampleFrames, NTV2Buffer & outDeviceAudio)
+{
+	const ULWord	numIn	(mMatrix.GetNumInputs());
+	const ULWord	numOut	(mDeviceChannels);
+	if (mMatrix.GetNumOutputs() != numOut)
+		{ACFAIL("Matrix has " << DEC(mMatrix.GetNumOutputs()) << " output(s), expected " << DEC(numOut) << " device channel(s)");  return false;}
+	if (inHostAudio.GetByteCount() < GetHostByteCount(inNumSampleFrames, false))
+		{ACFAIL(DEC(inNumSampleFrames) << " sample frame(s) exceed " << DEC(inHostAudio.GetByteCount()) << "-byte host buffer");  return false;}
+	if (outDeviceAudio.GetByteCount() < GetDeviceByteCount(inNumSampleFrames))
+		{ACFAIL(DEC(inNumSampleFrames) << " sample frame(s) exceed " << DEC(outDeviceAudio.GetByteCount()) << "-byte device buffer");  return false;}
+	if (!inNumSampleFrames)
+		return true;
+
+	const UByte *	pSrc		(reinterpret_cast<const UByte*>(inHostAudio.GetHostPointer()));
+	int32_t *		pDst		(reinterpret_cast<int32_t*>(outDeviceAudio.GetHostPointer()));
+	const ULWord	bps			(GetBytesPerSample(mHostFormat));
+	const bool		isRouting	(mMatrix.IsRouting());
+	const ULWord	srcStride	(mIsPlanar ? 1 : numIn);
+	const ULWord	srcChanStep	(mIsPlanar ? inNumSampleFrames : 1);
+	const bool		dither		(mDither  &&  !isRouting);
+
+	//	Fast path:  interleaved pass-through converts one contiguous run of samples, in loops with unit stride that the
+	//	compiler can vectorize. None of these loses precision, so none is dithered...
+	if (!mIsPlanar  &&  mMatrix.IsIdentity())
+	{
+		const ULWord	numSamples	(numIn * inNumSampleFrames);
+		switch (mHostFormat)
+		{
+			case NTV2_AUDIO_SAMPLE_FORMAT_S32:
+			{	const int32_t *	pIn (reinterpret_cast<const int32_t*>(pSrc));
+				for (ULWord ndx(0);  ndx < numSamples;  ndx++)
+					pDst[ndx] = int32_t(uint32_t(pIn[ndx]) & 0xFFFFFF00);
+				return true;
+			}
+			case NTV2_AUDIO_SAMPLE_FORMAT_S24:
+				for (ULWord ndx(0);  ndx < numSamples;  ndx++)
+				{
+					const UByte *	p (pSrc + ndx * 3);
+					pDst[ndx] = int32_t(uint32_t(p[0]) << 8 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 24);
+				}
+				return true;
+			case NTV2_AUDIO_SAMPLE_FORMAT_S16:
+			{	const int16_t *	pIn (reinterpret_cast<const int16_t*>(pSrc));
+				for (ULWord ndx(0);  ndx < numSamples;  ndx++)
+					pDst[ndx] = int32_t(uint32_t(int32_t(pIn[ndx])) << 16);
+				return true;
+			}
+			case NTV2_AUDIO_SAMPLE_FORMAT_F32:
+			{	const float *	pIn (reinterpret_cast<const float*>(pSrc));
+				for (ULWord ndx(0);  ndx < numSamples;  ndx++)
+					pDst[ndx] = int32_t(uint32_t(Round24(pIn[ndx] * kFloatTo24)) << 8);
+				return true;
+			}
+			default:
+				break;
+		}
+	}
+
+	//	Unpack each host channel into a planar scratch buffer (24-bit units)...
+	mFrame.resize(size_t(numIn) * inNumSampleFrames);
+	for (ULWord in(0);  in < numIn;  in++)
+		LoadHostChannel(mHostFormat, pSrc + in * srcChanStep * bps, srcStride, inNumSampleFrames, &mFrame[in], numIn);
+
+	//	Route/mix into the device buffer...
+	for (ULWord out(0);  out < numOut;  out++)
+	{
+		int32_t *	pOut	(pDst + out);
+		const int	source	(isRouting ? mMatrix.GetSource(out) : -1);
+		if (isRouting)
+		{
+			for (ULWord frame(0);  frame < inNumSampleFrames;  frame++)
+				pOut[frame * numOut] = source < 0 ? 0 : int32_t(uint32_t(Round24(mFrame[frame * numIn + ULWord(source)])) << 8);
+			continue;
+		}
+		const float *	pGains	(mMatrix.GetRow(out));
+		for (ULWord frame(0);  frame < inNumSampleFrames;  frame++)
+		{
+			const float *	pIn (&mFrame[frame * numIn]);
+			float	sum (0.0f);
+			for (ULWord in(0);  in < numIn;  in++)
+				sum += pGains[in] * pIn[in];
+			pOut[frame * numOut] = int32_t(uint32_t(Round24(sum + (dither ? NextDither() : 0.0f))) << 8);
+		}
+	}
+	return true;
+}
+
+ostream & NTV2AudioConverter::Print (ostream & oss) const
+{
+	oss << DEC(mDeviceChannels) << "-chl device <=> " << ::NTV2AudioSampleFormatToString(mHostFormat, true)
+		<< (mIsPlanar ? " planar" : " interleaved") << (mDither ? ", dither" : "") << ", " << mMatrix;
+	return oss;
+}
@@ -0,0 +1,307 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2audioresampler.cpp
+	@brief		Implements the NTV2AudioResampler class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2audioresampler.h"
+#include "ajabase/system/debug.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+#define ARTHIS				" " << HEX0N(uint64_t(this),16) << "::" << AJAFUNC << ": "
+#define ARFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_AudioGeneric,	ARTHIS << __x__)
+#define ARWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_AudioGeneric,	ARTHIS << __x__)
+#define ARDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_AudioGeneric,	ARTHIS << __x__)
+
+static const double	kPi				(3.14159265358979323846);
+static const double	kKaiserBeta		(8.6);				//	~-90dB stopband
+static const double	kTransition		(0.97);				//	Cutoff as fraction of output Nyquist when downsampling
+static const double	kIntegralRatio	(1.0 / 64.0);		//	Integral gain relative to proportional gain
+static const float	kToFloat		(1.0f / 2147483648.0f);
+static const float	kFromFloat		(8388608.0f);		//	2^23:  back to 24 bits
+
+
+//	Zeroth-order modified Bessel function of the first kind (for the Kaiser window)
+static double BesselI0 (const double inX)
+{
+	double	sum(1.0), term(1.0);
+	const double	halfX(inX / 2.0);
+	for (int k(1);  k < 64;  k++)
+	{
+		term *= (halfX / k) * (halfX / k);
+		sum += term;
+		if (term < sum * 1e-17)
+			break;
+	}
+	return sum;
+}
+
+//	Branch-free (rounds half away from zero, then clamps with min/max), so the callers' channel loops can vectorize
+static inline int32_t ToSample24in32 (const float inValue)
+{
+	const float	value	(inValue * kFromFloat + copysign(0.5f, inValue));
+	return int32_t(uint32_t(int32_t(max(min(value, 8388607.0f), -8388608.0f))) << 8);
+}
+
+//	Blend two adjacent phase rows of the polyphase table
+static inline void InterpolateTaps (const float * pRow0, const ULWord inNumTaps, const float inFrac, float * pTaps)
+{
+	const float *	pRow1	(pRow0 + inNumTaps);
+	for (ULWord tap(0);  tap < inNumTaps;  tap++)
+		pTaps[tap] = pRow0[tap] + inFrac * (pRow1[tap] - pRow0[tap]);
+}
+
+//	Multiply-accumulate one tap vector against consecutive input frames, for NG adjacent channels of an NCH-channel
+//	history. The channel loops have compile-time trip counts, so the compiler vectorizes them even at -O2, and NG is
+//	kept to at most 8 so the accumulators stay in (two) vector registers -- a 16-element array gets spilled, which
+//	puts a store and reload on every tap.
+template <ULWord NCH, ULWord NG> static inline void AccumulateGroup (const float * pTaps, const ULWord inNumTaps, const float * pSrc, int32_t * pOut)
+{
+	float	acc[NG];
+	for (ULWord ch(0);  ch < NG;  ch++)
+		acc[ch] = 0.0f;
+	for (ULWord tap(0);  tap < inNumTaps;  tap++, pSrc += NCH)
+	{
+		const float	coeff(pTaps[tap]);
+		for (ULWord ch(0);  ch < NG;  ch++)
+			acc[ch] += coeff * pSrc[ch];
+	}
+	for (ULWord ch(0);  ch < NG;  ch++)
+		pOut[ch] = ToSample24in32(acc[ch]);
+}
+
+//	Same, for all channels of the common channel counts (the group tests all fold away at compile time)
+template <ULWord NCH> static inline void AccumulateFrames (const float * pTaps, const ULWord inNumTaps, const float * pSrc, int32_t * pOut)
+{
+	ULWord	ch(0);
+	for ( ;  ch + 8 <= NCH;  ch += 8)
+		AccumulateGroup<NCH,8>(pTaps, inNumTaps, pSrc + ch, pOut + ch);
+	if (ch + 4 <= NCH)
+		{AccumulateGroup<NCH,4>(pTaps, inNumTaps, pSrc + ch, pOut + ch);  ch += 4;}
+	if (ch + 2 <= NCH)
+		{AccumulateGroup<NCH,2>(pTaps, inNumTaps, pSrc + ch, pOut + ch);  ch += 2;}
+	if (ch < NCH)
+		AccumulateGroup<NCH,1>(pTaps, inNumTaps, pSrc + ch, pOut + ch);
+}
+
+static inline void AccumulateFrames (const ULWord inNumChannels, const float * pTaps, const ULWord inNumTaps, const float * pSrc, float * pAcc, int32_t * pOut)
+{
+	switch (inNumChannels)
+	{
+		case 2:		AccumulateFrames<2>(pTaps, inNumTaps, pSrc, pOut);		return;
+		case 6:		AccumulateFrames<6>(pTaps, inNumTaps, pSrc, pOut);		return;
+		case 8:		AccumulateFrames<8>(pTaps, inNumTaps, pSrc, pOut);		return;
+		case 16:	AccumulateFrames<16>(pTaps, inNumTaps, pSrc, pOut);		return;
+		default:	break;
+	}
+	for (ULWord ch(0);  ch < inNumChannels;  ch++)
+		pAcc[ch] = 0.0f;
+	for (ULWord tap(0);  tap < inNumTaps;  tap++, pSrc += inNumChannels)
+		for (ULWord ch(0);  ch < inNumChannels;  ch++)
+			pAcc[ch] += pTaps[tap] * pSrc[ch];
+	for (ULWord ch(0);  ch < inNumChannels;  ch++)
+		pOut[ch] = ToSample24in32(pAcc[ch]);
+}
+
+
+NTV2AudioResampler::NTV2AudioResampler (const ULWord inNumChannels, const ULWord inHalfTaps, const ULWord inNumPhases)
+	:	mNumChannels	(inNumChannels ? inNumChannels : 1),
+		mHalfTaps		(inHalfTaps ? inHalfTaps : 1),
+		mNumPhases		(inNumPhases ? inNumPhases : 1),
+		mInputRate		(48000.0),
+		mOutputRate		(48000.0),
+		mNominalStep	(1.0),
+		mStep			(1.0),
+		mBase			(0),
+		mFraction		(0.0),
+		mAdjustPPM		(0.0),
+		mMaxPPM			(1000.0),
+		mGain			(0.05),
+		mIntegral		(0.0),
+		mTargetFrames	(0)
+{
+	mTaps.resize(2 * mHalfTaps);
+	mAccum.resize(mNumChannels);
+	DesignFilter();
+	Reset();
+}
+
+bool NTV2AudioResampler::SetRates (const double inInputRate, const double inOutputRate)
+{
+	if (inInputRate <= 0.0  ||  inOutputRate <= 0.0)
+		{ARFAIL("Bad rate(s): input=" << inInputRate << " output=" << inOutputRate);  return false;}
+	const bool	redesign (mOutputRate / mInputRate != inOutputRate / inInputRate);
+	mInputRate = inInputRate;
+	mOutputRate = inOutputRate;
+	mNominalStep = mInputRate / mOutputRate;
+	if (redesign)
+		DesignFilter();
+	Reset();
+	ARDBG(mInputRate << " => " << mOutputRate);
+	return true;
+}
+
+void NTV2AudioResampler::Reset (void)
+{
+	//	Prime the history with silence, so the first output frame lines up with the first input frame...
+	mHistory.assign((mHalfTaps - 1) * mNumChannels, 0.0f);
+	mBase = mHalfTaps - 1;
+	mFraction = 0.0;
+	mAdjustPPM = mIntegral = 0.0;
+	mStep = mNominalStep;
+}
+
+void NTV2AudioResampler::DesignFilter (void)
+{
+	const ULWord	numTaps	(2 * mHalfTaps);
+	const double	ratio	(mOutputRate / mInputRate);
+	//	Full-band when the rates match (so the zero phase is an exact pass-through), otherwise leave a transition band
+	//	below the lower of the two Nyquist frequencies...
+	const double	cutoff	(ratio >= 1.0  ?  (ratio == 1.0 ? 1.0 : kTransition)  :  ratio * kTransition);
+	const double	i0Beta	(BesselI0(kKaiserBeta));
+
+	mCoeffs.resize((mNumPhases + 1) * numTaps);
+	for (ULWord phase(0);  phase <= mNumPhases;  phase++)
+	{
+		float *	pRow	(&mCoeffs[phase * numTaps]);
+		double	sum		(0.0);
+		vector<double>	row (numTaps, 0.0);
+		for (ULWord tap(0);  tap < numTaps;  tap++)
+		{
+			//	Distance (in input frames) from the interpolation point to this tap...
+			const double	x	(double(tap) - double(mHalfTaps - 1) - double(phase) / double(mNumPhases));
+			const double	r	(x / double(mHalfTaps));
+			if (r <= -1.0  ||  r >= 1.0)
+				continue;	//	Outside window
+			double	sinc (1.0);
+			if (x != 0.0)
+				sinc = (cutoff == 1.0  &&  x == floor(x))  ?  0.0  :  sin(kPi * cutoff * x) / (kPi * cutoff * x);
+			row[tap] = cutoff * sinc * BesselI0(kKaiserBeta * sqrt(1.0 - r * r)) / i0Beta;
+			sum += row[tap];
+		}
+		for (ULWord tap(0);  tap < numTaps;  tap++)
+			pRow[tap] = float(sum != 0.0 ? row[tap] / sum : row[tap]);	//	Unity DC gain for every phase
+	}
+}
+
+ULWord NTV2AudioResampler::Process (const int32_t * pInSamples, const ULWord inNumInFrames, int32_t * pOutSamples, const ULWord inMaxOutFrames)
+{
+	if (inNumInFrames  &&  !pInSamples)
+		{ARFAIL("NULL input buffer");  return 0;}
+	if (inMaxOutFrames  &&  !pOutSamples)
+		{ARFAIL("NULL output buffer");  return 0;}
+
+	//	Append the new input...
+	const size_t	oldSize	(mHistory.size());
+	const ULWord	numIn	(inNumInFrames * mNumChannels);
+	mHistory.resize(oldSize + numIn);
+	for (ULWord ndx(0);  ndx < numIn;  ndx++)
+		mHistory[oldSize + ndx] = float(pInSamples[ndx]) * kToFloat;
+
+	//	Produce output frames for as long as there's enough input on both sides of the interpolation point...
+	const ULWord	numTaps		(2 * mHalfTaps);
+	const ULWord	numFrames	(ULWord(mHistory.size() / mNumChannels));
+	const float *	pCoeffs		(&mCoeffs[0]);
+	float *			pTaps		(&mTaps[0]);
+	float *			pAcc		(&mAccum[0]);
+	ULWord			numOut		(0);
+	while (numOut < inMaxOutFrames)
+	{
+		if (mBase + mHalfTaps >= numFrames)
+			break;	//	Need more input
+		const double	phasePos	(mFraction * double(mNumPhases));
+		const ULWord	phase		= ULWord(phasePos);
+		const float		frac		(float(phasePos - double(phase)));
+		InterpolateTaps(pCoeffs + phase * numTaps, numTaps, frac, pTaps);
+		AccumulateFrames(mNumChannels, pTaps, numTaps, &mHistory[(mBase - (mHalfTaps - 1)) * mNumChannels], pAcc,
+						pOutSamples + numOut * mNumChannels);
+		numOut++;
+		mFraction += mStep;
+		const ULWord	whole	= ULWord(mFraction);		//	mStep is always positive
+		mBase += whole;
+		mFraction -= double(whole);
+	}
+
+	//	Discard input that no future output frame can reach...
+	if (mBase > mHalfTaps - 1)
+	{
+		ULWord	discard	(mBase - (mHalfTaps - 1));
+		if (discard > numFrames)
+			discard = numFrames;
+		mHistory.erase(mHistory.begin(), mHistory.begin() + discard * mNumChannels);
+		mBase -= discard;
+	}
+	return numOut;
+}
+
+bool NTV2AudioResampler::Process (const NTV2Buffer & inInput, const ULWord inNumInFrames, NTV2Buffer & outOutput, ULWord & outNumOutFrames)
+{
+	outNumOutFrames = 0;
+	const ULWord	bytesPerFrame	(mNumChannels * ULWord(sizeof(int32_t)));
+	if (inNumInFrames * bytesPerFrame > inInput.GetByteCount())
+		{ARFAIL(DEC(inNumInFrames) << " input frame(s) exceed " << DEC(inInput.GetByteCount()) << "-byte input buffer");  return false;}
+	if (outOutput.IsNULL())
+		{ARFAIL("NULL output buffer");  return false;}
+	outNumOutFrames = Process(reinterpret_cast<const int32_t*>(inInput.GetHostPointer()), inNumInFrames,
+								reinterpret_cast<int32_t*>(outOutput.GetHostPointer()), outOutput.GetByteCount() / bytesPerFrame);
+	return true;
+}
+
+void NTV2AudioResampler::SetRatioAdjustment (const double inPPM)
+{
+	mAdjustPPM = inPPM;
+	if (mAdjustPPM > mMaxPPM)
+		mAdjustPPM = mMaxPPM;
+	else if (mAdjustPPM < -mMaxPPM)
+		mAdjustPPM = -mMaxPPM;
+	mIntegral = mAdjustPPM;	//	Feedback (if any) continues from here
+	mStep = mNominalStep * (1.0 + mAdjustPPM * 1e-6);
+}
+
+void NTV2AudioResampler::SetBufferTarget (const ULWord inTargetFrames, const double inMaxPPM, const double inGain)
+{
+	mTargetFrames = inTargetFrames;
+	mMaxPPM = inMaxPPM > 0.0 ? inMaxPPM : 0.0;
+	mGain = inGain > 0.0 ? inGain : 0.0;
+	mIntegral = 0.0;
+}
+
+void NTV2AudioResampler::UpdateBufferLevel (const ULWord inQueuedFrames)
+{
+	//	More queued than the target means I'm producing too much, so consume input faster (positive PPM)...
+	const double	error	(double(inQueuedFrames) - double(mTargetFrames));
+	mIntegral += error * mGain * kIntegralRatio;
+	if (mIntegral > mMaxPPM)
+		mIntegral = mMaxPPM;
+	else if (mIntegral < -mMaxPPM)
+		mIntegral = -mMaxPPM;
+	mAdjustPPM = mIntegral + error * mGain;
+	if (mAdjustPPM > mMaxPPM)
+		mAdjustPPM = mMaxPPM;
+	else if (mAdjustPPM < -mMaxPPM)
+		mAdjustPPM = -mMaxPPM;
+	mStep = mNominalStep * (1.0 + mAdjustPPM * 1e-6);
+}
+
+double NTV2AudioResampler::GetEffectiveRatio (void) const
+{
+	return mStep > 0.0  ?  1.0 / mStep  :  0.0;
+}
+
+ULWord NTV2AudioResampler::GetBufferedFrames (void) const
+{
+	const ULWord	numFrames	(ULWord(mHistory.size() / mNumChannels));
+	return numFrames > mBase  ?  numFrames - mBase  :  0;
+}
+
+ostream & NTV2AudioResampler::Print (ostream & oss) const
+{
+	oss << DEC(mNumChannels) << "ch " << mInputRate << "Hz => " << mOutputRate << "Hz, "
+		<< DEC(2 * mHalfTaps) << " taps x " << DEC(mNumPhases) << " phases, adjust=" << mAdjustPPM << "ppm, buffered="
+		<< DEC(GetBufferedFrames());
+	return oss;
+}
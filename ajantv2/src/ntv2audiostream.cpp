@@ -0,0 +1,281 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2audiostream.cpp
+	@brief		Implements the NTV2AudioStream class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2audiostream.h"
+#include "ntv2utils.h"
+#include "ajabase/system/debug.h"
+#include "ajabase/system/systemtime.h"
+
+using namespace std;
+
+#define ASTHIS				" " << HEX0N(uint64_t(this),16) << "::" << AJAFUNC << ": " << ::NTV2AudioSystemToString(mAudioSystem, true) << (mIsCapture ? " in: " : " out: ")
+#define ASFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_AudioGeneric,	ASTHIS << __x__)
+#define ASWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_AudioGeneric,	ASTHIS << __x__)
+#define ASNOTE(__x__)		AJA_sNOTICE (AJA_DebugUnit_AudioGeneric,	ASTHIS << __x__)
+#define ASDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_AudioGeneric,	ASTHIS << __x__)
+
+static const ULWord	kDefaultPlayoutLead	(4800);	//	100ms @ 48kHz
+
+
+ULWord NTV2AudioStream::RingDistance (const ULWord inFrom, const ULWord inTo, const ULWord inRingBytes)
+{
+	if (!inRingBytes)
+		return 0;
+	return inTo >= inFrom  ?  inTo - inFrom  :  inRingBytes - inFrom + inTo;
+}
+
+void NTV2AudioStream::SplitAtWrap (const ULWord inOffset, const ULWord inByteCount, const ULWord inRingBytes,
+									ULWord & outFirstBytes, ULWord & outSecondBytes)
+{
+	const ULWord	toEnd	(inOffset < inRingBytes  ?  inRingBytes - inOffset  :  0);
+	outFirstBytes  = inByteCount > toEnd  ?  toEnd  :  inByteCount;
+	outSecondBytes = inByteCount - outFirstBytes;
+}
+
+
+NTV2AudioStream::NTV2AudioStream (CNTV2Card & inDevice, const NTV2AudioSystem inAudioSystem, const bool inIsCapture)
+	:	mDevice			(inDevice),
+		mAudioSystem	(inAudioSystem),
+		mIsCapture		(inIsCapture),
+		mNumChannels	(0),
+		mRingBytes		(0),
+		mCaptureOffset	(0),
+		mSampleRate		(48000.0),
+		mGranularity	(1),
+		mPlayoutLead	(kDefaultPlayoutLead),
+		mCursor			(0),
+		mLastQueued		(0),
+		mLastAccessUS	(0),
+		mTotalSamples	(0),
+		mNumOverruns	(0),
+		mNumUnderruns	(0)
+{
+}
+
+bool NTV2AudioStream::Initialize (void)
+{
+	mRingBytes = 0;
+	if (!mDevice.IsOpen())
+		{ASFAIL("Device not open");  return false;}
+	if (!NTV2_IS_VALID_AUDIO_SYSTEM(mAudioSystem))
+		{ASFAIL("Invalid audio system " << DEC(mAudioSystem));  return false;}
+
+	NTV2AudioRate	audioRate	(NTV2_AUDIO_48K);
+	ULWord			ringBytes	(0);
+	if (!mDevice.GetNumberAudioChannels(mNumChannels, mAudioSystem)  ||  !mNumChannels)
+		{ASFAIL("Unable to determine number of audio channels");  return false;}
+	if (!mDevice.GetAudioWrapAddress(ringBytes, mAudioSystem)  ||  !mDevice.GetAudioReadOffset(mCaptureOffset, mAudioSystem))
+		{ASFAIL("Unable to determine audio buffer geometry");  return false;}
+	if (mDevice.GetAudioRate(audioRate, mAudioSystem))
+		mSampleRate = ::GetAudioSamplesPerSecond(audioRate);
+	if (mSampleRate <= 0.0)
+		mSampleRate = 48000.0;
+
+	mRingBytes = ringBytes;
+	mTotalSamples = 0;
+	mNumOverruns = mNumUnderruns = 0;
+	ASDBG(DEC(mNumChannels) << " chls, ring " << xHEX0N(mRingBytes,8) << " bytes (" << DEC(GetRingSampleFrames())
+			<< " samples), capture offset " << xHEX0N(mCaptureOffset,8) << ", " << mSampleRate << "Hz");
+	return Reset();
+}
+
+bool NTV2AudioStream::Reset (void)
+{
+	if (!IsInitialized())
+		return false;
+	ULWord head(0);
+	if (!ReadHead(head))
+		return false;
+	if (mIsCapture)
+	{	//	Start reading from where the device is writing now
+		mCursor = head;
+		mLastAccessUS = AJATime::GetSystemMicroseconds();
+		return true;
+	}
+
+	bool isRunning(false);
+	mDevice.IsAudioOutputRunning(mAudioSystem, isRunning);
+	if (isRunning)
+	{	//	Get ahead of the play head
+		const ULWord	bpf		(GetBytesPerSampleFrame());
+		ULWord			lead	(mPlayoutLead * bpf);
+		if (lead >= mRingBytes)
+			lead = (mRingBytes / 2) - ((mRingBytes / 2) % bpf);
+		mCursor = (head + lead) % mRingBytes;
+	}
+	else
+		mCursor = 0;	//	Output is in reset -- it'll start playing from the top
+	mLastQueued = RingDistance(isRunning ? head : 0, mCursor, mRingBytes);
+	return true;
+}
+
+bool NTV2AudioStream::SetSampleGranularity (const ULWord inSampleFrames)
+{
+	mGranularity = inSampleFrames ? inSampleFrames : 1;
+	return true;
+}
+
+bool NTV2AudioStream::ReadHead (ULWord & outHead)
+{
+	outHead = 0;
+	if (!(mIsCapture ? mDevice.ReadAudioLastIn(outHead, mAudioSystem) : mDevice.ReadAudioLastOut(outHead, mAudioSystem)))
+		{ASFAIL("Failed to read " << (mIsCapture ? "write" : "play") << " head");  return false;}
+	outHead &= ~0x3UL;	//	Force DWORD alignment
+	if (outHead >= mRingBytes)
+		outHead = 0;	//	Device is at the wrap
+	return true;
+}
+
+bool NTV2AudioStream::TransferChunk (const ULWord inRingOffset, ULWord * pHostBuffer, const ULWord inByteCount)
+{
+	if (!inByteCount)
+		return true;
+	const bool ok (mIsCapture	? mDevice.DMAReadAudio(mAudioSystem, pHostBuffer, mCaptureOffset + inRingOffset, inByteCount)
+								: mDevice.DMAWriteAudio(mAudioSystem, pHostBuffer, inRingOffset, inByteCount));
+	if (!ok)
+		ASFAIL("DMA failed: ring offset " << xHEX0N(inRingOffset,8) << ", " << DEC(inByteCount) << " bytes");
+	return ok;
+}
+
+bool NTV2AudioStream::GetAvailableSamples (ULWord & outSampleFrames)
+{
+	outSampleFrames = 0;
+	if (!IsInitialized()  ||  !mIsCapture)
+		return false;
+	ULWord head(0);
+	if (!ReadHead(head))
+		return false;
+
+	const ULWord	bpf			(GetBytesPerSampleFrame());
+	const ULWord	margin		(mRingBytes / 16);
+	ULWord			available	(RingDistance(mCursor, head, mRingBytes));
+	if (!available)
+		mLastAccessUS = AJATime::GetSystemMicroseconds();	//	Caught up (or input stopped) -- nothing can have been lost
+	//	The head position alone can't reveal a full lap, so also check how long it's been since the last read...
+	const double	ringUS		(double(GetRingSampleFrames()) * 1000000.0 / mSampleRate);
+	const double	elapsedUS	(double(AJATime::GetSystemMicroseconds() - mLastAccessUS));
+	if (available > mRingBytes - margin  ||  elapsedUS > ringUS * 15.0 / 16.0)
+	{
+		mNumOverruns++;
+		ASWARN("Overrun #" << DEC(mNumOverruns) << ": " << DEC(available) << " bytes pending, " << DEC(ULWord(elapsedUS/1000.0))
+				<< "ms since last read -- resyncing to write head " << xHEX0N(head,8));
+		mCursor = head;
+		mLastAccessUS = AJATime::GetSystemMicroseconds();
+		available = 0;
+	}
+	outSampleFrames = available / bpf;
+	outSampleFrames -= outSampleFrames % mGranularity;
+	return true;
+}
+
+bool NTV2AudioStream::Read (NTV2Buffer & inOutBuffer, ULWord & outSampleFrames, const ULWord inMaxSampleFrames, const ULWord inByteOffset)
+{
+	outSampleFrames = 0;
+	if (!IsInitialized()  ||  !mIsCapture)
+		return false;
+	if (inOutBuffer.IsNULL()  ||  inByteOffset >= inOutBuffer.GetByteCount()  ||  (inByteOffset & 0x3))
+		{ASFAIL("Bad host buffer or offset " << DEC(inByteOffset));  return false;}
+
+	ULWord available(0);
+	if (!GetAvailableSamples(available))
+		return false;
+
+	const ULWord	bpf		(GetBytesPerSampleFrame());
+	ULWord			count	((inOutBuffer.GetByteCount() - inByteOffset) / bpf);
+	if (available < count)
+		count = available;
+	if (inMaxSampleFrames  &&  inMaxSampleFrames < count)
+		count = inMaxSampleFrames;
+	count -= count % mGranularity;
+	if (!count)
+		return true;	//	Nothing to read
+
+	const ULWord	byteCount	(count * bpf);
+	ULWord			firstBytes(0), secondBytes(0);
+	SplitAtWrap(mCursor, byteCount, mRingBytes, firstBytes, secondBytes);
+	UByte *	pHost (reinterpret_cast<UByte*>(inOutBuffer.GetHostAddress(inByteOffset)));
+	if (!TransferChunk(mCursor, reinterpret_cast<ULWord*>(pHost), firstBytes))
+		return false;
+	if (!TransferChunk(0, reinterpret_cast<ULWord*>(pHost + firstBytes), secondBytes))
+		return false;
+	mCursor = (mCursor + byteCount) % mRingBytes;
+	mLastAccessUS = AJATime::GetSystemMicroseconds();
+	mTotalSamples += count;
+	outSampleFrames = count;
+	return true;
+}
+
+bool NTV2AudioStream::GetQueuedSamples (ULWord & outSampleFrames)
+{
+	outSampleFrames = 0;
+	if (!IsInitialized()  ||  mIsCapture)
+		return false;
+	ULWord head(0);
+	if (!ReadHead(head))
+		return false;
+
+	ULWord queued (RingDistance(head, mCursor, mRingBytes));
+	if (queued > mLastQueued)
+	{	//	Queue can only shrink between writes -- if it grew, the play head passed my write cursor
+		mNumUnderruns++;
+		const ULWord	bpf		(GetBytesPerSampleFrame());
+		ULWord			lead	(mPlayoutLead * bpf);
+		if (lead >= mRingBytes)
+			lead = (mRingBytes / 2) - ((mRingBytes / 2) % bpf);
+		ASWARN("Underrun #" << DEC(mNumUnderruns) << ": play head " << xHEX0N(head,8) << " passed write cursor "
+				<< xHEX0N(mCursor,8) << " -- resyncing " << DEC(lead / bpf) << " samples ahead");
+		mCursor = (head + lead) % mRingBytes;
+		queued = lead;
+	}
+	mLastQueued = queued;
+	outSampleFrames = queued / GetBytesPerSampleFrame();
+	return true;
+}
+
+bool NTV2AudioStream::Write (const NTV2Buffer & inBuffer, const ULWord inSampleFrames, const ULWord inByteOffset)
+{
+	if (!IsInitialized()  ||  mIsCapture)
+		return false;
+	if (!inSampleFrames)
+		return true;	//	Nothing to write
+	const ULWord	bpf			(GetBytesPerSampleFrame());
+	const ULWord	byteCount	(inSampleFrames * bpf);
+	if (inBuffer.IsNULL()  ||  (inByteOffset & 0x3)  ||  ULWord64(inByteOffset) + byteCount > inBuffer.GetByteCount())
+		{ASFAIL("Bad host buffer, offset " << DEC(inByteOffset) << " or sample count " << DEC(inSampleFrames));  return false;}
+
+	ULWord queuedSamples(0);
+	if (!GetQueuedSamples(queuedSamples))
+		return false;
+	if (queuedSamples + inSampleFrames >= GetRingSampleFrames())
+		{ASFAIL(DEC(inSampleFrames) << " samples won't fit, " << DEC(queuedSamples) << " of " << DEC(GetRingSampleFrames()) << " queued");  return false;}
+
+	ULWord	firstBytes(0), secondBytes(0);
+	SplitAtWrap(mCursor, byteCount, mRingBytes, firstBytes, secondBytes);
+	UByte *	pHost (reinterpret_cast<UByte*>(inBuffer.GetHostAddress(inByteOffset)));
+	if (!TransferChunk(mCursor, reinterpret_cast<ULWord*>(pHost), firstBytes))
+		return false;
+	if (!TransferChunk(0, reinterpret_cast<ULWord*>(pHost + firstBytes), secondBytes))
+		return false;
+	mCursor = (mCursor + byteCount) % mRingBytes;
+	mLastQueued += byteCount;
+	mTotalSamples += inSampleFrames;
+	return true;
+}
+
+ostream & NTV2AudioStream::Print (ostream & oss) const
+{
+	oss << ::NTV2AudioSystemToString(mAudioSystem, true) << (mIsCapture ? " capture" : " playout");
+	if (!IsInitialized())
+		return oss << " (uninitialized)";
+	oss << ": " << DEC(mNumChannels) << " chls, ring " << DEC(GetRingSampleFrames()) << " samples, cursor "
+		<< xHEX0N(mCursor,8) << ", " << mTotalSamples << " samples transferred";
+	if (mIsCapture)
+		oss << ", " << DEC(mNumOverruns) << " overrun(s)";
+	else
+		oss << ", " << DEC(mNumUnderruns) << " underrun(s)";
+	return oss;
+}
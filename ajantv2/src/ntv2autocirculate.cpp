@@ -9,6 +9,7 @@
 #include "ntv2utils.h"
 #include "ntv2rp188.h"
 #include "ntv2endian.h"
+#include "ntv2latencytimeline.h"
 #include "ajabase/system/lock.h"
 #include "ajabase/system/debug.h"
 #include "ajaanc/includes/ancillarylist.h"
@@ -708,6 +709,9 @@ bool CNTV2Card::AutoCirculateTransfer (const NTV2Channel inChannel, AUTOCIRCULAT
 		return false;
 	GetEveryFrameServices(taskMode);
 
+	NTV2LatencyTimeline *	pTimeline	(mLatencyTimeline);	//	The NTV2LatencyRecord is only built at the end, if enabled
+	uint64_t	submitTime(pTimeline ? NTV2LatencyRecord::Now() : 0),  dmaStartTime(0),  dmaEndTime(0),  ancDoneTime(0);
+
 	if (NTV2_IS_INPUT_CROSSPOINT(crosspoint))
 		inOutXferInfo.acTransferStatus.acFrameStamp.acTimeCodes.Fill(ULWord(0xFFFFFFFF));	//	Invalidate old timecodes
 	else if (NTV2_IS_OUTPUT_CROSSPOINT(crosspoint))
@@ -801,7 +805,11 @@ bool CNTV2Card::AutoCirculateTransfer (const NTV2Channel inChannel, AUTOCIRCULAT
 	/////////////////////////////////////////////////////////////////////////////
 	//	Call the driver...
 	inOutXferInfo.acCrosspoint = crosspoint;
+	if (pTimeline)
+		dmaStartTime = NTV2LatencyRecord::Now();
 	bool result = NTV2Message(inOutXferInfo);
+	if (pTimeline)
+		dmaEndTime = NTV2LatencyRecord::Now();
 	/////////////////////////////////////////////////////////////////////////////
 
 	if (result	&&	NTV2_IS_INPUT_CROSSPOINT(crosspoint))
@@ -854,6 +862,8 @@ bool CNTV2Card::AutoCirculateTransfer (const NTV2Channel inChannel, AUTOCIRCULAT
 				pArray [NTV2_TCINDEX_DEFAULT] = tcValue;
 		}	//	if retail mode
 	}	//	if NTV2Message OK && capturing
+	if (pTimeline)
+		ancDoneTime = NTV2LatencyRecord::Now();
 	if (result	&&	NTV2_IS_OUTPUT_CROSSPOINT(crosspoint))
 	{
 		if (savedAncF1)
@@ -925,11 +935,46 @@ bool CNTV2Card::AutoCirculateTransfer (const NTV2Channel inChannel, AUTOCIRCULAT
 		ACDBG("Transfer successful for Ch" << DEC(inChannel+1));
 	else
 		ACFAIL("Transfer failed on Ch" << DEC(inChannel+1));
+	if (pTimeline)
+	{
+		NTV2LatencyRecord latency (NTV2_IS_INPUT_CROSSPOINT(crosspoint) ? NTV2_LATENCY_KIND_AC_CAPTURE : NTV2_LATENCY_KIND_AC_PLAYOUT, inChannel);
+		latency.fTimes[NTV2_LATENCY_SUBMIT]		= submitTime;
+		latency.fTimes[NTV2_LATENCY_DMA_START]	= dmaStartTime;
+		latency.fTimes[NTV2_LATENCY_DMA_END]	= dmaEndTime;
+		latency.fTimes[NTV2_LATENCY_ANC_DONE]	= ancDoneTime;
+		latency.fSuccess		= result;
+		latency.fFrame			= ULWord(inOutXferInfo.acTransferStatus.acTransferFrame);
+		latency.fByteCount		= inOutXferInfo.acVideoBuffer.GetByteCount();
+		latency.fDroppedFrames	= inOutXferInfo.acTransferStatus.acFramesDropped;
+		latency.SetFrameStamp(inOutXferInfo.acTransferStatus.acFrameStamp);
+		latency.Stamp(NTV2_LATENCY_RETURN);
+		pTimeline->Record(latency);
+	}
 	return result;
 
 }	//	AutoCirculateTransfer
 
 
+bool CNTV2Card::SetLatencyTimelineEnable (const bool inEnable, const ULWord inCapacity)
+{
+	if (!inEnable)
+	{
+		if (mLatencyTimeline)
+			ACDBG("Latency timeline disabled");
+		delete mLatencyTimeline;
+		mLatencyTimeline = AJA_NULL;
+		return true;
+	}
+	if (mLatencyTimeline  &&  mLatencyTimeline->GetCapacity() >= inCapacity)
+		return true;	//	Already enabled
+	NTV2LatencyTimeline * pNewTimeline (new NTV2LatencyTimeline(inCapacity));
+	delete mLatencyTimeline;
+	mLatencyTimeline = pNewTimeline;
+	ACDBG("Latency timeline enabled, capacity " << DEC(mLatencyTimeline->GetCapacity()) << " per channel");
+	return true;
+}
+
+
 static const AJA_FrameRate	sNTV2Rate2AJARate[] = { AJA_FrameRate_Unknown	//	NTV2_FRAMERATE_UNKNOWN	= 0,
 													,AJA_FrameRate_6000		//	NTV2_FRAMERATE_6000		= 1,
 													,AJA_FrameRate_5994		//	NTV2_FRAMERATE_5994		= 2,
@@ -19,13 +19,15 @@ using namespace std;
 
 // Default Constructor
 CNTV2Card::CNTV2Card ()
-	:	mDevCap(driverInterface())
+	:	mDevCap(driverInterface()),
+		mLatencyTimeline(AJA_NULL)
 {
 	_boardOpened = false;
 }
 
 CNTV2Card::CNTV2Card (const UWord inDeviceIndex, const string & inHostName)
-	:	mDevCap(driverInterface())
+	:	mDevCap(driverInterface()),
+		mLatencyTimeline(AJA_NULL)
 {
 	string hostName(inHostName);
 	aja::strip(hostName);
@@ -58,7 +60,7 @@ CNTV2Card::~CNTV2Card ()
 {
 	if (IsOpen ())
 		Close ();
-
+	SetLatencyTimelineEnable(false);
 }	//	destructor
 
 
@@ -0,0 +1,307 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2clockcorrelator.cpp
+	@brief		Implements the NTV2ClockFit and NTV2ClockCorrelator classes.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2clockcorrelator.h"
+#include "ntv2utils.h"
+#include "ajabase/system/systemtime.h"
+#include <cmath>
+#include <iomanip>
+
+using namespace std;
+
+static const double	kMinGate	(8.0);	//	Smallest outlier rejection threshold (Y units), to tolerate integer rounding
+static const double	kGateSigmas	(6.0);	//	Outlier rejection threshold, in standard deviations of the residual
+
+
+NTV2ClockFit::NTV2ClockFit (const double inNominalSlope, const ULWord inTimeConstant)
+	:	mNominalSlope	(inNominalSlope > 0.0 ? inNominalSlope : 1.0),
+		mDecay			(1.0 - 1.0 / double(inTimeConstant > 1 ? inTimeConstant : 2)),
+		mNumOutliers	(0),
+		mNumResets		(0)
+{
+	Reset();
+}
+
+void NTV2ClockFit::Reset (void)
+{
+	mAnchorX = mAnchorY = 0;
+	mSumW = mSumX = mSumY = mSumXX = mSumXY = mSumRR = mOffsetY = 0.0;
+	mSlope = mNominalSlope;
+	mNumSamples = mOutlierRun = 0;
+}
+
+bool NTV2ClockFit::AddSample (const int64_t inX, const int64_t inY)
+{
+	if (!mNumSamples)
+	{	//	First sample becomes the origin
+		mAnchorX = inX;  mAnchorY = inY;
+		mSumW = 1.0;
+		mSumX = mSumY = mSumXX = mSumXY = mSumRR = mOffsetY = 0.0;
+		mSlope = mNominalSlope;
+		mNumSamples = 1;
+		return true;
+	}
+
+	const double	dx		(double(inX - mAnchorX));
+	const double	dy		(double(inY - mAnchorY));
+	const double	resid	(dy - (mOffsetY + mSlope * dx));
+	if (IsLocked())
+	{
+		const double	gate	(kGateSigmas * JitterRMS());
+		if (::fabs(resid) > (gate > kMinGate ? gate : kMinGate))
+		{
+			mNumOutliers++;
+			if (++mOutlierRun < kMaxOutlierRun)
+				return false;
+			//	Sustained run of outliers -- assume a clock discontinuity, and restart from here
+			mNumResets++;
+			Reset();
+			return AddSample(inX, inY);
+		}
+	}
+	mOutlierRun = 0;
+
+	//	Age the existing statistics...
+	mSumW *= mDecay;  mSumX *= mDecay;  mSumY *= mDecay;  mSumXX *= mDecay;  mSumXY *= mDecay;  mSumRR *= mDecay;
+
+	//	Move the origin to the new sample (so the sums stay small), then add it (at 0,0)...
+	const double	sx	(mSumX),  sy	(mSumY);
+	mSumX	= sx - mSumW * dx;
+	mSumY	= sy - mSumW * dy;
+	mSumXX	= mSumXX - 2.0 * dx * sx + mSumW * dx * dx;
+	mSumXY	= mSumXY - dy * sx - dx * sy + mSumW * dx * dy;
+	mSumRR	+= resid * resid;
+	mSumW	+= 1.0;
+	mAnchorX = inX;  mAnchorY = inY;
+	mNumSamples++;
+
+	//	Refit...
+	const double	meanX	(mSumX / mSumW);
+	const double	meanY	(mSumY / mSumW);
+	const double	varX	(mSumXX / mSumW - meanX * meanX);
+	const double	covXY	(mSumXY / mSumW - meanX * meanY);
+	if (varX > 1.0)
+		mSlope = covXY / varX;
+	else
+		mSlope = mNominalSlope;	//	Degenerate (all samples at same X)
+	if (mSlope <= 0.0)
+		mSlope = mNominalSlope;	//	Clocks never run backwards
+	mOffsetY = meanY - mSlope * meanX;
+	return true;
+}
+
+int64_t NTV2ClockFit::XToY (const int64_t inX) const
+{
+	if (!mNumSamples)
+		return int64_t(::llround(double(inX) * mSlope));
+	return mAnchorY + int64_t(::llround(mOffsetY + mSlope * double(inX - mAnchorX)));
+}
+
+int64_t NTV2ClockFit::YToX (const int64_t inY) const
+{
+	if (!mNumSamples)
+		return int64_t(::llround(double(inY) / mSlope));
+	return mAnchorX + int64_t(::llround((double(inY - mAnchorY) - mOffsetY) / mSlope));
+}
+
+double NTV2ClockFit::JitterRMS (void) const
+{
+	if (mSumW <= 1.0)
+		return 0.0;
+	const double meanSq (mSumRR / (mSumW - 1.0));	//	Newest sample contributes no residual history
+	return meanSq > 0.0 ? ::sqrt(meanSq) : 0.0;
+}
+
+ostream & NTV2ClockFit::Print (ostream & oss) const
+{
+	oss << "slope=" << fixed << setprecision(9) << Slope()
+		<< " drift=" << setprecision(3) << DriftPPM() << "ppm"
+		<< " jitter=" << setprecision(1) << JitterRMS()
+		<< " samples=" << DEC(NumSamples()) << " outliers=" << DEC(NumOutliers()) << " resets=" << DEC(NumResets())
+		<< (IsLocked() ? " locked" : " unlocked");
+	oss.unsetf(ios::floatfield);
+	return oss;
+}
+
+
+NTV2ClockCorrelator::NTV2ClockCorrelator (const ULWord inTimeConstant)
+	:	mAudioToHost		(1.0, inTimeConstant),	//	10MHz ticks vs. 100ns units
+		mHostToMono			(1.0, inTimeConstant),
+		mVBIToHost			(1.0, inTimeConstant),
+		mTimeConstant		(inTimeConstant),
+		mNominalVBIPeriod	(0.0),
+		mLastVBIHostTime	(0),
+		mSynthVBICount		(0),
+		mHaveVBICounts		(false)
+{
+}
+
+void NTV2ClockCorrelator::Reset (void)
+{
+	AJAAutoLock tmp(&mLock);
+	mAudioToHost.Reset();
+	mHostToMono.Reset();
+	mVBIToHost.Reset();
+	mLastVBIHostTime = 0;
+	mSynthVBICount = 0;
+	mHaveVBICounts = false;
+}
+
+void NTV2ClockCorrelator::SetFrameRate (const NTV2FrameRate inFrameRate)
+{
+	const double fps (NTV2_IS_VALID_NTV2FrameRate(inFrameRate) ? ::GetFramesPerSecond(inFrameRate) : 0.0);
+	AJAAutoLock tmp(&mLock);
+	mNominalVBIPeriod = fps > 0.0 ? 10000000.0 / fps : 0.0;
+	mVBIToHost = NTV2ClockFit(mNominalVBIPeriod > 0.0 ? mNominalVBIPeriod : 1.0, mTimeConstant);
+	mLastVBIHostTime = 0;
+	mSynthVBICount = 0;
+}
+
+bool NTV2ClockCorrelator::AddFrameStamp (const FRAME_STAMP & inFrameStamp, const int64_t inMonoTime)
+{
+	const int64_t monoNow (inMonoTime ? inMonoTime : int64_t(AJATime::GetSystemNanoseconds() / 100));
+	bool result (false);
+	AJAAutoLock tmp(&mLock);
+	if (inFrameStamp.acAudioClockTimeStamp  &&  inFrameStamp.acFrameTime)
+		if (mAudioToHost.AddSample(int64_t(inFrameStamp.acAudioClockTimeStamp), inFrameStamp.acFrameTime))
+			result = true;
+	if (inFrameStamp.acAudioClockCurrentTime  &&  inFrameStamp.acCurrentTime)
+		if (mAudioToHost.AddSample(int64_t(inFrameStamp.acAudioClockCurrentTime), inFrameStamp.acCurrentTime))
+			result = true;
+	if (monoNow > 0  &&  inFrameStamp.acCurrentTime)
+		mHostToMono.AddSample(inFrameStamp.acCurrentTime, monoNow);
+	if (inFrameStamp.acCurrentFrameTime  &&  !mHaveVBICounts)
+		AddVBITimeLocked(inFrameStamp.acCurrentFrameTime);
+	return result;
+}
+
+bool NTV2ClockCorrelator::AddClockPair (const ULWord64 inAudioClock, const int64_t inHostTime)
+{
+	if (!inAudioClock  ||  !inHostTime)
+		return false;
+	AJAAutoLock tmp(&mLock);
+	return mAudioToHost.AddSample(int64_t(inAudioClock), inHostTime);
+}
+
+bool NTV2ClockCorrelator::AddInterrupt (const ULWord inVBICount, const int64_t inHostTime)
+{
+	if (!inHostTime)
+		return false;
+	AJAAutoLock tmp(&mLock);
+	if (!mHaveVBICounts)
+	{	//	Explicit counts supersede any synthesized from frame stamps
+		mVBIToHost.Reset();
+		mHaveVBICounts = true;
+	}
+	return mVBIToHost.AddSample(int64_t(inVBICount), inHostTime);
+}
+
+bool NTV2ClockCorrelator::AddVBITimeLocked (const int64_t inHostTime)
+{
+	if (mNominalVBIPeriod <= 0.0)
+		return false;	//	Frame rate unknown
+	if (mLastVBIHostTime)
+	{
+		const double nFrames (::floor(double(inHostTime - mLastVBIHostTime) / mNominalVBIPeriod + 0.5));
+		if (nFrames < 1.0)
+			return false;	//	Same (or earlier) VBI as last time
+		mSynthVBICount += ULWord(nFrames);
+	}
+	mLastVBIHostTime = inHostTime;
+	return mVBIToHost.AddSample(int64_t(mSynthVBICount), inHostTime);
+}
+
+int64_t NTV2ClockCorrelator::AudioClockToHost (const ULWord64 inAudioClock) const
+{
+	AJAAutoLock tmp(&mLock);
+	return mAudioToHost.XToY(int64_t(inAudioClock));
+}
+
+ULWord64 NTV2ClockCorrelator::HostToAudioClock (const int64_t inHostTime) const
+{
+	AJAAutoLock tmp(&mLock);
+	return ULWord64(mAudioToHost.YToX(inHostTime));
+}
+
+int64_t NTV2ClockCorrelator::HostToMono (const int64_t inHostTime) const
+{
+	AJAAutoLock tmp(&mLock);
+	return mHostToMono.XToY(inHostTime);
+}
+
+int64_t NTV2ClockCorrelator::MonoToHost (const int64_t inMonoTime) const
+{
+	AJAAutoLock tmp(&mLock);
+	return mHostToMono.YToX(inMonoTime);
+}
+
+int64_t NTV2ClockCorrelator::VBIToHost (const ULWord inVBICount) const
+{
+	AJAAutoLock tmp(&mLock);
+	return mVBIToHost.XToY(int64_t(inVBICount));
+}
+
+ULWord NTV2ClockCorrelator::HostToVBI (const int64_t inHostTime) const
+{
+	AJAAutoLock tmp(&mLock);
+	int64_t vbi (mVBIToHost.YToX(inHostTime));	//	Rounded to nearest...
+	if (mVBIToHost.XToY(vbi) > inHostTime)
+		vbi--;									//	...so back up if it's in the future
+	return vbi > 0 ? ULWord(vbi) : 0;
+}
+
+int64_t NTV2ClockCorrelator::NextVBIHostTime (const int64_t inHostTime) const
+{
+	return VBIToHost(HostToVBI(inHostTime) + 1);
+}
+
+double NTV2ClockCorrelator::AudioClockDriftPPM (void) const
+{
+	AJAAutoLock tmp(&mLock);
+	return mAudioToHost.IsLocked() ? -mAudioToHost.DriftPPM() : 0.0;	//	Host runs slow when device runs fast
+}
+
+double NTV2ClockCorrelator::VBIPeriod (void) const
+{
+	AJAAutoLock tmp(&mLock);
+	if (mVBIToHost.IsLocked())
+		return mVBIToHost.Slope();
+	return mNominalVBIPeriod;
+}
+
+bool NTV2ClockCorrelator::IsLocked (void) const
+{
+	AJAAutoLock tmp(&mLock);
+	return mAudioToHost.IsLocked();
+}
+
+NTV2ClockFit NTV2ClockCorrelator::AudioClockModel (void) const
+{
+	AJAAutoLock tmp(&mLock);
+	return mAudioToHost;
+}
+
+NTV2ClockFit NTV2ClockCorrelator::HostToMonoModel (void) const
+{
+	AJAAutoLock tmp(&mLock);
+	return mHostToMono;
+}
+
+NTV2ClockFit NTV2ClockCorrelator::VBIModel (void) const
+{
+	AJAAutoLock tmp(&mLock);
+	return mVBIToHost;
+}
+
+ostream & NTV2ClockCorrelator::Print (ostream & oss) const
+{
+	AJAAutoLock tmp(&mLock);
+	oss << "AudioClock->Host: " << mAudioToHost << endl
+		<< "Host->Mono:       " << mHostToMono << endl
+		<< "VBI->Host:        " << mVBIToHost;
+	return oss;
+}
@@ -847,84 +847,49 @@ bool CNTV2Card::WriteLUTTables (const UWordSequence & inRedLUT, const UWordSeque
 	if (inRedLUT.size() < kLUTArraySize	 ||	 inGreenLUT.size() < kLUTArraySize	||	inBlueLUT.size() < kLUTArraySize)
 		{LUTFAIL("Size error (< 1024): R=" << DEC(inRedLUT.size()) << " G=" << DEC(inGreenLUT.size()) << " B=" << DEC(inBlueLUT.size())); return false;}
 
-	size_t	errorCount(0), nonzeroes(0);
-	ULWord	RTableReg = (Has12BitLUTSupport() ? kColorCorrection12BitLUTOffset_Base : kColorCorrectionLUTOffset_Red) / 4;	//	Byte offset to LUT in register bar;	 divide by sizeof (ULWord) to get register number
-	ULWord	GTableReg = (Has12BitLUTSupport() ? kColorCorrection12BitLUTOffset_Base : kColorCorrectionLUTOffset_Green) / 4;
-	ULWord	BTableReg = (Has12BitLUTSupport() ? kColorCorrection12BitLUTOffset_Base : kColorCorrectionLUTOffset_Blue) / 4;
-
-	for (size_t ndx(0);	 ndx < NTV2_COLORCORRECTOR_WORDSPERTABLE;  ndx++)
+	//	All three tables go to the device in one WriteRegisters batch (a few NTV2SetRegisters messages), instead of one WriteRegister call per word...
+	const bool			has12BitLUT (Has12BitLUTSupport());
+	const UWordSequence *	pTables[3] = {&inRedLUT, &inGreenLUT, &inBlueLUT};
+	size_t				nonzeroes(0);
+	NTV2RegisterWrites	regWrites;
+	if (!has12BitLUT)
 	{
-		ULWord	loRed(ULWord(inRedLUT[2 * ndx + 0]) & 0x3FF);
-		ULWord	hiRed(ULWord(inRedLUT[2 * ndx + 1]) & 0x3FF);
-
-		ULWord	loGreen = ULWord(inGreenLUT[2 * ndx + 0]) & 0x3FF;
-		ULWord	hiGreen = ULWord(inGreenLUT[2 * ndx + 1]) & 0x3FF;
-
-		ULWord	loBlue = ULWord(inBlueLUT[2 * ndx + 0]) & 0x3FF;
-		ULWord	hiBlue = ULWord(inBlueLUT[2 * ndx + 1]) & 0x3FF;
-		
-		if(!Has12BitLUTSupport())
-		{
-			ULWord	tmpRed((hiRed << kRegColorCorrectionLUTOddShift) + (loRed << kRegColorCorrectionLUTEvenShift));
-			if (tmpRed) nonzeroes++;
-			if (!WriteRegister(RTableReg++, tmpRed))
-				errorCount++;
-			
-			ULWord	tmpGreen = (hiGreen << kRegColorCorrectionLUTOddShift) + (loGreen << kRegColorCorrectionLUTEvenShift);
-			if (tmpGreen) nonzeroes++;
-			if (!WriteRegister(GTableReg++, tmpGreen))
-				errorCount++;
-			
-			ULWord	tmpBlue = (hiBlue << kRegColorCorrectionLUTOddShift) + (loBlue << kRegColorCorrectionLUTEvenShift);
-			if (tmpBlue) nonzeroes++;
-			if (!WriteRegister(BTableReg++, tmpBlue))
-				errorCount++;
-		}
-		else
+		static const ULWord	tableRegs[3] = {kColorCorrectionLUTOffset_Red / 4, kColorCorrectionLUTOffset_Green / 4, kColorCorrectionLUTOffset_Blue / 4};	//	Byte offset to LUT in register bar;	 divide by sizeof (ULWord) to get register number
+		regWrites.reserve(3 * NTV2_COLORCORRECTOR_WORDSPERTABLE);
+		for (size_t ndx(0);	 ndx < NTV2_COLORCORRECTOR_WORDSPERTABLE;  ndx++)
+			for (size_t plane(0);  plane < 3;  plane++)
+			{
+				const ULWord lo(ULWord((*pTables[plane])[2 * ndx + 0]) & 0x3FF),	hi(ULWord((*pTables[plane])[2 * ndx + 1]) & 0x3FF);
+				const ULWord tmp((hi << kRegColorCorrectionLUTOddShift) + (lo << kRegColorCorrectionLUTEvenShift));
+				if (tmp) nonzeroes++;
+				regWrites.push_back(NTV2RegInfo(tableRegs[plane] + ULWord(ndx), tmp));
+			}
+	}
+	else
+	{	//	10-bit values into a 12-bit LUT:  each plane is selected in turn, and each 10-bit pair fills four 12-bit pairs
+		static const NTV2LUTPlaneSelect	planes[3] = {NTV2_REDPLANE, NTV2_GREENPLANE, NTV2_BLUEPLANE};
+		regWrites.reserve(3 * (4 * NTV2_COLORCORRECTOR_WORDSPERTABLE + 1));
+		for (size_t plane(0);  plane < 3;  plane++)
 		{
-			ULWord	tmpRedLo((loRed << kRegColorCorrection10To12BitLUTOddShift) + (loRed << kRegColorCorrection10To12BitLUTEvenShift));
-			ULWord	tmpRedHi((hiRed << kRegColorCorrection10To12BitLUTOddShift) + (hiRed << kRegColorCorrection10To12BitLUTEvenShift));
-			if(tmpRedLo || tmpRedHi) nonzeroes++;
-			Set12BitLUTPlaneSelect(NTV2_REDPLANE);
-			if (!WriteRegister(RTableReg++, tmpRedLo))
-				errorCount++;
-			if (!WriteRegister(RTableReg++, tmpRedLo))
-				errorCount++;
-			if (!WriteRegister(RTableReg++, tmpRedHi))
-				errorCount++;
-			if (!WriteRegister(RTableReg++, tmpRedHi))
-				errorCount++;
-			
-			ULWord	tmpGreenLo((loGreen << kRegColorCorrection10To12BitLUTOddShift) + (loGreen << kRegColorCorrection10To12BitLUTEvenShift));
-			ULWord	tmpGreenHi((hiGreen << kRegColorCorrection10To12BitLUTOddShift) + (hiGreen << kRegColorCorrection10To12BitLUTEvenShift));
-			if(tmpGreenLo || tmpGreenHi) nonzeroes++;
-			Set12BitLUTPlaneSelect(NTV2_GREENPLANE);
-			if (!WriteRegister(GTableReg++, tmpGreenLo))
-				errorCount++;
-			if (!WriteRegister(GTableReg++, tmpGreenLo))
-				errorCount++;
-			if (!WriteRegister(GTableReg++, tmpGreenHi))
-				errorCount++;
-			if (!WriteRegister(GTableReg++, tmpGreenHi))
-				errorCount++;
-			
-			ULWord	tmpBlueLo((loBlue << kRegColorCorrection10To12BitLUTOddShift) + (loBlue << kRegColorCorrection10To12BitLUTEvenShift));
-			ULWord	tmpBlueHi((hiBlue << kRegColorCorrection10To12BitLUTOddShift) + (hiBlue << kRegColorCorrection10To12BitLUTEvenShift));
-			if(tmpBlueLo || tmpBlueHi) nonzeroes++;
-			Set12BitLUTPlaneSelect(NTV2_BLUEPLANE);
-			if (!WriteRegister(BTableReg++, tmpBlueLo))
-				errorCount++;
-			if (!WriteRegister(BTableReg++, tmpBlueLo))
-				errorCount++;
-			if (!WriteRegister(BTableReg++, tmpBlueHi))
-				errorCount++;
-			if (!WriteRegister(BTableReg++, tmpBlueHi))
-				errorCount++;
+			ULWord	tableReg(kColorCorrection12BitLUTOffset_Base / 4);
+			regWrites.push_back(NTV2RegInfo(kRegLUTV2Control, planes[plane], kRegMask12BitLUTPlaneSelect, kRegShift12BitLUTPlaneSelect));
+			for (size_t ndx(0);	 ndx < NTV2_COLORCORRECTOR_WORDSPERTABLE;  ndx++)
+			{
+				const ULWord lo(ULWord((*pTables[plane])[2 * ndx + 0]) & 0x3FF),	hi(ULWord((*pTables[plane])[2 * ndx + 1]) & 0x3FF);
+				const ULWord tmpLo((lo << kRegColorCorrection10To12BitLUTOddShift) + (lo << kRegColorCorrection10To12BitLUTEvenShift));
+				const ULWord tmpHi((hi << kRegColorCorrection10To12BitLUTOddShift) + (hi << kRegColorCorrection10To12BitLUTEvenShift));
+				if (tmpLo || tmpHi) nonzeroes++;
+				regWrites.push_back(NTV2RegInfo(tableReg++, tmpLo));
+				regWrites.push_back(NTV2RegInfo(tableReg++, tmpLo));
+				regWrites.push_back(NTV2RegInfo(tableReg++, tmpHi));
+				regWrites.push_back(NTV2RegInfo(tableReg++, tmpHi));
+			}
 		}
 	}
-	if (errorCount) LUTFAIL(GetDisplayName() << " " << DEC(errorCount) << " WriteRegister calls failed");
-	else if (!nonzeroes) LUTWARN(GetDisplayName() << " All zero LUT table values!");
-	return !errorCount;
+	if (!WriteRegisters(regWrites))
+		{LUTFAIL(GetDisplayName() << " WriteRegisters failed for " << DEC(regWrites.size()) << " LUT register(s)"); return false;}
+	if (!nonzeroes) LUTWARN(GetDisplayName() << " All zero LUT table values!");
+	return true;
 }
 
 bool CNTV2Card::Write12BitLUTTables (const UWordSequence & inRedLUT, const UWordSequence & inGreenLUT, const UWordSequence & inBlueLUT)
@@ -934,51 +899,56 @@ bool CNTV2Card::Write12BitLUTTables (const UWordSequence & inRedLUT, const UWord
 
 	if (!Has12BitLUTSupport())
 		return false;
-	
-	size_t	errorCount(0), nonzeroes(0);
-	ULWord	RTableReg(kColorCorrection12BitLUTOffset_Base / 4); //	Byte offset to LUT in register bar;	 divide by sizeof (ULWord) to get register number
-	ULWord	GTableReg(kColorCorrection12BitLUTOffset_Base / 4);
-	ULWord	BTableReg(kColorCorrection12BitLUTOffset_Base / 4);
 
-	Set12BitLUTPlaneSelect(NTV2_REDPLANE);
-	for (size_t ndx(0);	 ndx < NTV2_12BIT_COLORCORRECTOR_WORDSPERTABLE;	 ndx++)
+	//	All three planes go to the device in one WriteRegisters batch (sent in order), each preceded by its plane select...
+	static const NTV2LUTPlaneSelect	planes[3] = {NTV2_REDPLANE, NTV2_GREENPLANE, NTV2_BLUEPLANE};
+	const UWordSequence *	pTables[3] = {&inRedLUT, &inGreenLUT, &inBlueLUT};
+	size_t				nonzeroes(0);
+	NTV2RegisterWrites	regWrites;
+	regWrites.reserve(3 * (NTV2_12BIT_COLORCORRECTOR_WORDSPERTABLE + 1));
+	for (size_t plane(0);  plane < 3;  plane++)
 	{
-		ULWord	loRed(ULWord(inRedLUT[2 * ndx + 0]) & 0xFFF);
-		ULWord	hiRed(ULWord(inRedLUT[2 * ndx + 1]) & 0xFFF);
-
-		ULWord	tmpRed((hiRed << kRegColorCorrection12BitLUTOddShift) + (loRed << kRegColorCorrection12BitLUTEvenShift));
-		if (tmpRed) nonzeroes++;
-		if (!WriteRegister(RTableReg++, tmpRed))
-			errorCount++;
-	}
-	
-	Set12BitLUTPlaneSelect(NTV2_GREENPLANE);
-	for (size_t ndx(0);	 ndx < NTV2_12BIT_COLORCORRECTOR_WORDSPERTABLE;	 ndx++)
-	{
-		ULWord	loGreen = ULWord(inGreenLUT[2 * ndx + 0]) & 0xFFF;
-		ULWord	hiGreen = ULWord(inGreenLUT[2 * ndx + 1]) & 0xFFF;
-		
-		ULWord	tmpGreen = (hiGreen << kRegColorCorrection12BitLUTOddShift) + (loGreen << kRegColorCorrection12BitLUTEvenShift);
-		if (tmpGreen) nonzeroes++;
-		if (!WriteRegister(GTableReg++, tmpGreen))
-			errorCount++;
+		ULWord	tableReg(kColorCorrection12BitLUTOffset_Base / 4);	//	Byte offset to LUT in register bar;	 divide by sizeof (ULWord) to get register number
+		regWrites.push_back(NTV2RegInfo(kRegLUTV2Control, planes[plane], kRegMask12BitLUTPlaneSelect, kRegShift12BitLUTPlaneSelect));
+		for (size_t ndx(0);	 ndx < NTV2_12BIT_COLORCORRECTOR_WORDSPERTABLE;	 ndx++)
+		{
+			const ULWord lo(ULWord((*pTables[plane])[2 * ndx + 0]) & 0xFFF),	hi(ULWord((*pTables[plane])[2 * ndx + 1]) & 0xFFF);
+			const ULWord tmp((hi << kRegColorCorrection12BitLUTOddShift) + (lo << kRegColorCorrection12BitLUTEvenShift));
+			if (tmp) nonzeroes++;
+			regWrites.push_back(NTV2RegInfo(tableReg++, tmp));
+		}
 	}
-	
-	Set12BitLUTPlaneSelect(NTV2_BLUEPLANE);
-	for (size_t ndx(0);	 ndx < NTV2_12BIT_COLORCORRECTOR_WORDSPERTABLE;	 ndx++)
-	{
-		ULWord	loBlue = ULWord(inBlueLUT[2 * ndx + 0]) & 0xFFF;
-		ULWord	hiBlue = ULWord(inBlueLUT[2 * ndx + 1]) & 0xFFF;
+	if (!WriteRegisters(regWrites))
+		{LUTFAIL(GetDisplayName() << " WriteRegisters failed for " << DEC(regWrites.size()) << " LUT register(s)"); return false;}
+	if (!nonzeroes) LUTWARN(GetDisplayName() << " All zero LUT table values!");
+	return true;
+}
 
-		ULWord	tmpBlue = (hiBlue << kRegColorCorrection12BitLUTOddShift) + (loBlue << kRegColorCorrection12BitLUTEvenShift);
-		if (tmpBlue) nonzeroes++;
-		if (!WriteRegister(BTableReg++, tmpBlue))
-			errorCount++;
-	}
-	
-	if (errorCount) LUTFAIL(GetDisplayName() << " " << DEC(errorCount) << " WriteRegister calls failed");
-	else if (!nonzeroes) LUTWARN(GetDisplayName() << " All zero LUT table values!");
-	return !errorCount;
+bool CNTV2Card::DownloadLUTToInactiveBank (const UWordSequence & inRedLUT, const UWordSequence & inGreenLUT, const UWordSequence & inBlueLUT,
+											const NTV2Channel inLUT, const bool in12Bit, const bool inAtNextVBI)
+{
+	if (IS_CHANNEL_INVALID(inLUT))
+		{LUTFAIL("Bad LUT/channel (> 7): " << DEC(inLUT)); return false;}
+	if (::NTV2DeviceGetNumLUTs(_boardID) == 0)
+		{LUTFAIL(GetDisplayName() << " has no LUTs"); return false;}
+
+	ULWord	outputBank(0);
+	if (!GetColorCorrectionOutputBank(inLUT, outputBank))
+		{LUTFAIL(GetDisplayName() << " GetColorCorrectionOutputBank failed for LUT" << DEC(inLUT+1)); return false;}
+	const int inactiveBank (outputBank ? 0 : 1);
+
+	//	Fill the bank that's not being output...
+	if (!(in12Bit	? Download12BitLUTToHW(inRedLUT, inGreenLUT, inBlueLUT, inLUT, inactiveBank)
+					: DownloadLUTToHW(inRedLUT, inGreenLUT, inBlueLUT, inLUT, inactiveBank)))
+		return false;
+
+	//	...then make it visible with one register write, right after the VBI if requested...
+	if (inAtNextVBI  &&  !WaitForOutputVerticalInterrupt(inLUT))
+		{LUTFAIL(GetDisplayName() << " VBI wait failed for output " << DEC(inLUT+1) << ", LUT" << DEC(inLUT+1) << " still outputting bank " << DEC(outputBank)); return false;}
+	if (!SetColorCorrectionOutputBank(inLUT, ULWord(inactiveBank)))
+		{LUTFAIL(GetDisplayName() << " SetColorCorrectionOutputBank failed for LUT" << DEC(inLUT+1) << " bank " << DEC(inactiveBank)); return false;}
+	LUTDBG(GetDisplayName() << " LUT" << DEC(inLUT+1) << " now outputting bank " << DEC(inactiveBank));
+	return true;
 }
 
 bool CNTV2Card::GetLUTTables (NTV2DoubleArray & outRedLUT, NTV2DoubleArray & outGreenLUT, NTV2DoubleArray & outBlueLUT)
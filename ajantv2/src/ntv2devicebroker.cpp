@@ -0,0 +1,709 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2devicebroker.cpp
+	@brief		Implements the NTV2DeviceBroker and NTV2BrokerClient classes.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2devicebroker.h"
+#include "ntv2card.h"
+#include "ntv2devicesnapshot.h"
+#include "ntv2nubtypes.h"
+#include "ntv2utils.h"
+#include "ajabase/common/common.h"
+#include "ajabase/system/atomic.h"
+#include "ajabase/system/debug.h"
+#include "ajabase/system/memory.h"
+#include "ajabase/system/process.h"
+#include "ajabase/system/systemtime.h"
+#include <cstring>
+#if defined(AJA_WINDOWS)
+	#include <WinSock2.h>
+	#include <WS2tcpip.h>
+	#define	BrokerCloseSocket(_s_)	::closesocket(SOCKET(_s_))
+	#define	BrokerBarrier()			MemoryBarrier()
+#else
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+	#define	BrokerCloseSocket(_s_)	::close(_s_)
+	#define	BrokerBarrier()			__sync_synchronize()
+#endif
+
+using namespace std;
+using namespace ntv2nub;
+
+#define INSTP(_p_)			HEX0N(uint64_t(_p_),16)
+#define BCFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_RPCClient, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define BCWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_RPCClient, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define BCDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_RPCClient, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define BSFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_RPCServer, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define BSWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_RPCServer, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define BSNOTE(__x__)		AJA_sNOTICE	(AJA_DebugUnit_RPCServer, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define BSDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_RPCServer, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+
+static const ULWord		kBrokerMagic			(NTV2_FOURCC('N','B','R','K'));
+static const ULWord		kBrokerVersion			(2);
+static const ULWord		kBrokerMaxSnapshotRegs	(8192);		//	Shared memory is always sized for this many
+static const ULWord		kBrokerRefreshMs		(50);		//	Refresh at least this often, even without interrupts
+static const ULWord		kBrokerRequestTimeoutMs	(5000);		//	Plus the reservation timeout, if any
+
+typedef enum
+{
+	kBrokerOpReserve		= kNTV2TCPOpcodeUser,	//	Channel, timeout, app type, PID, owner ==> [current owner]
+	kBrokerOpRelease,								//	Channel ==> nothing
+	kBrokerOpReservations							//	Nothing ==> reservations
+} NTV2BrokerOpcode;
+
+/**
+	@brief	The shared memory layout. The broker writes it, clients only read it. The register values follow
+			the header (at offset headerBytes), followed by one byte per register that's non-zero if the register
+			is in the snapshot (registers that are volatile or have read side-effects aren't). Updates are bracketed by incrementing 'sequence', so it's odd
+			while an update is in progress, and readers retry if it changed while they read.
+**/
+struct NTV2BrokerShared
+{
+	ULWord				magic;			///< @brief	kBrokerMagic
+	ULWord				version;		///< @brief	kBrokerVersion
+	ULWord				headerBytes;	///< @brief	Offset to the register values
+	ULWord				numRegs;		///< @brief	Number of registers in the snapshot (from zero)
+	ULWord				deviceID;		///< @brief	The shared device's ::NTV2DeviceID
+	ULWord				port;			///< @brief	The broker's loopback TCP port (Windows only)
+	uint64_t			brokerPID;		///< @brief	The broker's process ID
+	volatile uint32_t	sequence;		///< @brief	Odd while an update is in progress
+	volatile uint32_t	alive;			///< @brief	Non-zero while the broker is running
+	volatile uint64_t	refreshCount;	///< @brief	Number of refreshes
+	volatile uint64_t	refreshTime;	///< @brief	Time of the last refresh (AJATime::GetSystemMicroseconds)
+};
+
+static inline volatile ULWord * SharedValues (NTV2BrokerShared * pShared)
+{
+	return reinterpret_cast<volatile ULWord*>(reinterpret_cast<UByte*>(pShared) + pShared->headerBytes);
+}
+
+static inline volatile UByte * SharedInSnapshot (const NTV2BrokerShared * pShared)
+{
+	return reinterpret_cast<volatile UByte*>(const_cast<UByte*>(reinterpret_cast<const UByte*>(pShared)) + pShared->headerBytes + kBrokerMaxSnapshotRegs * sizeof(ULWord));
+}
+
+static inline size_t SharedBytes (void)
+{
+	return sizeof(NTV2BrokerShared) + kBrokerMaxSnapshotRegs * (sizeof(ULWord) + sizeof(UByte));
+}
+
+static inline bool IsSnapshotReg (const NTV2BrokerShared * pShared, const ULWord inRegNum)
+{
+	return pShared  &&  inRegNum < pShared->numRegs  &&  SharedInSnapshot(pShared)[inRegNum];
+}
+
+//	Only registers that don't change by themselves, and that can be read without side-effects, go in the snapshot
+static inline bool IsSnapshotCandidate (const ULWord inRegNum)
+{
+	const NTV2RegCacheClass regClass (CNTV2DriverInterface::DefaultRegisterCacheClass(inRegNum));
+	return (regClass == NTV2_REGCACHE_CONFIG  ||  regClass == NTV2_REGCACHE_STATIC)  &&  !CNTV2DeviceSnapshot::HasReadSideEffects(inRegNum);
+}
+
+static void PushBrokerString (const string & inStr, NTV2_RPC_BLOB_TYPE & outBlob)
+{
+	PUSHU32(ULWord(inStr.size()), outBlob);
+	outBlob.insert(outBlob.end(), inStr.begin(), inStr.end());
+}
+
+static bool PopBrokerString (string & outStr, const NTV2_RPC_BLOB_TYPE & inBlob, size_t & inOutNdx)
+{
+	ULWord len(0);
+	if (inOutNdx + sizeof(ULWord) > inBlob.size())
+		return false;
+	POPU32(len, inBlob, inOutNdx);
+	if (len > inBlob.size() - inOutNdx)
+		return false;
+	outStr.assign(inBlob.begin() + ptrdiff_t(inOutNdx), inBlob.begin() + ptrdiff_t(inOutNdx + len));
+	inOutNdx += len;
+	return true;
+}
+
+static NTV2ConfigParams BrokerConfig (const NTV2ConfigParams & inConfig)
+{	//	The broker is local-only:  on Windows it listens on loopback TCP, on any free port
+	NTV2ConfigParams config (inConfig);
+	config.insert(kConnectParamHost, "127.0.0.1");
+	config.insert(kConnectParamPort, "0");
+	return config;
+}
+
+
+ostream & operator << (ostream & oss, const NTV2BrokerReservation & inReservation)
+{
+	oss << ::NTV2ChannelToString(inReservation.channel, true) << " reserved by '" << inReservation.owner << "'";
+	if (inReservation.appType)
+		oss << " (" << NTV2_4CC_AS_STRING(inReservation.appType) << ")";
+	oss << " pid " << DEC(inReservation.processID) << " conn " << DEC(inReservation.connectionID);
+	return oss;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	NTV2DeviceBroker
+
+string NTV2DeviceBroker::SocketPath (const string & inName)	//	CLASS METHOD
+{
+	return "/tmp/ntv2broker-" + inName + ".sock";
+}
+
+string NTV2DeviceBroker::SharedName (const string & inName)	//	CLASS METHOD
+{
+	return "ntv2broker-" + inName;
+}
+
+bool NTV2DeviceBroker::IsLegalName (const string & inName)	//	CLASS METHOD
+{
+	if (inName.empty()  ||  inName.size() > 64)
+		return false;
+	for (size_t ndx(0);  ndx < inName.size();  ndx++)
+	{
+		const char ch (inName.at(ndx));
+		if (!::isalnum(ch)  &&  ch != '-'  &&  ch != '_'  &&  ch != '.')
+			return false;
+	}
+	return true;
+}
+
+NTV2DeviceBroker::NTV2DeviceBroker (CNTV2Card & inDevice, const NTV2ConfigParams & inConfig)
+	:	NTV2TCPServer	(inDevice, BrokerConfig(inConfig)),
+		mName			(inConfig.valueForKey(kNTV2BrokerParamName)),
+		mpShared		(AJA_NULL),
+		mQuitRefresh	(false),
+		mOwnSocket		(false),
+		mReleased		(/*manualReset*/false)
+{
+}
+
+NTV2DeviceBroker::~NTV2DeviceBroker ()
+{
+	Stop();	//	Before ~NTV2TCPServer, whose Stop wouldn't call my ConnectionClosed
+}
+
+bool NTV2DeviceBroker::Start (void)
+{
+	if (IsRunning())
+		return true;
+	if (!IsLegalName(mName))
+		{BSFAIL("Bad or missing broker name '" << mName << "'");  return false;}
+	CNTV2Card & device (GetDevice());
+	if (!device.IsOpen())
+		{BSFAIL("Device not open");  return false;}
+
+	//	Decide which registers to snapshot...
+	const string regsStr (ConfigParam(kNTV2BrokerParamSnapshotRegs));
+	ULWord numRegs (regsStr.empty() ? device.GetNumSupported(kDeviceGetMaxRegisterNumber) + 1 : ULWord(aja::stoul(regsStr)));
+	if (numRegs > kBrokerMaxSnapshotRegs)
+		numRegs = kBrokerMaxSnapshotRegs;
+	mSnapshotRegs.clear();
+	for (ULWord regNum(0);  regNum < numRegs;  regNum++)
+		if (IsSnapshotCandidate(regNum))
+			mSnapshotRegs.push_back(NTV2RegInfo(regNum));
+
+	//	Publish the snapshot...
+	size_t sharedBytes (SharedBytes());
+	mpShared = reinterpret_cast<NTV2BrokerShared*>(AJAMemory::AllocateShared(&sharedBytes, SharedName(mName).c_str()));
+	if (!mpShared  ||  sharedBytes < SharedBytes())
+	{
+		BSFAIL("Can't allocate " << DEC(SharedBytes()) << "-byte shared memory '" << SharedName(mName) << "'");
+		if (mpShared)
+			{AJAMemory::FreeShared(mpShared);  mpShared = AJA_NULL;}
+		return false;
+	}
+	if (mpShared->magic == kBrokerMagic  &&  mpShared->alive
+		&&  (mpShared->brokerPID == AJAProcess::GetPid()  ||  AJAProcess::IsValid(mpShared->brokerPID)))
+	{
+		BSFAIL("Broker '" << mName << "' already running in process " << DEC(mpShared->brokerPID));
+		AJAMemory::FreeShared(mpShared);  mpShared = AJA_NULL;
+		return false;
+	}
+	mpShared->alive = 0;
+	mpShared->magic = kBrokerMagic;
+	mpShared->version = kBrokerVersion;
+	mpShared->headerBytes = ULWord(sizeof(NTV2BrokerShared));
+	mpShared->numRegs = numRegs;
+	mpShared->deviceID = ULWord(device.GetDeviceID());
+	mpShared->brokerPID = AJAProcess::GetPid();
+	mpShared->sequence = 0;
+	mpShared->refreshCount = 0;
+	volatile UByte * pInSnapshot (SharedInSnapshot(mpShared));
+	for (ULWord regNum(0);  regNum < kBrokerMaxSnapshotRegs;  regNum++)
+		pInSnapshot[regNum] = 0;
+	for (size_t ndx(0);  ndx < mSnapshotRegs.size();  ndx++)
+		pInSnapshot[mSnapshotRegs.at(ndx).registerNumber] = 1;
+	RefreshSnapshot();	//	Clients find a valid snapshot right away
+
+	//	Accept clients...
+	if (!NTV2TCPServer::Start())
+		{Stop();  return false;}
+	mpShared->port = GetPort();
+	BrokerBarrier();
+	mpShared->alive = 1;
+	device.SubscribeOutputVerticalEvent(NTV2_CHANNEL1);
+	mQuitRefresh = false;
+	mRefresher.Attach(RefreshThreadStatic, this);
+	if (AJA_FAILURE(mRefresher.Start()))
+		{BSFAIL("Failed to start refresh thread");  Stop();  return false;}
+	BSNOTE("Broker '" << mName << "' sharing '" << device.GetDisplayName() << "', " << DEC(mSnapshotRegs.size()) << "-register snapshot");
+	return true;
+}
+
+void NTV2DeviceBroker::Stop (void)
+{
+	mQuitRefresh = true;
+	while (mRefresher.Active())
+		AJATime::Sleep(1);
+	NTV2TCPServer::Stop();	//	Closes all connections, releasing their reservations
+	if (mpShared)
+	{
+		mpShared->alive = 0;
+		AJAMemory::FreeShared(mpShared);
+		mpShared = AJA_NULL;
+	}
+#if !defined(AJA_WINDOWS)
+	if (mOwnSocket)
+		::unlink(SocketPath(mName).c_str());
+	mOwnSocket = false;
+#endif
+}
+
+int NTV2DeviceBroker::OpenListenSocket (UWord & outPort)
+{
+#if defined(AJA_WINDOWS)
+	return NTV2TCPServer::OpenListenSocket(outPort);	//	Loopback TCP, port published in shared memory
+#else
+	outPort = 0;
+	const string path (SocketPath(mName));
+	struct sockaddr_un addr;
+	::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path))
+		{BSFAIL("Socket path '" << path << "' too long");  return -1;}
+	::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	const int sock (::socket(AF_UNIX, SOCK_STREAM, 0));
+	if (sock < 0)
+		{BSFAIL("socket failed");  return -1;}
+	if (!::connect(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)))
+		{BSFAIL("Broker '" << mName << "' already listening on '" << path << "'");  BrokerCloseSocket(sock);  return -1;}
+	::unlink(path.c_str());	//	Stale, from a broker that died
+	const int listenSock (::socket(AF_UNIX, SOCK_STREAM, 0));
+	BrokerCloseSocket(sock);
+	if (listenSock < 0)
+		{BSFAIL("socket failed");  return -1;}
+	if (::bind(listenSock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr))  ||  ::listen(listenSock, 8))
+		{BSFAIL("Can't listen on '" << path << "'");  BrokerCloseSocket(listenSock);  return -1;}
+	mOwnSocket = true;
+	return listenSock;
+#endif
+}
+
+string NTV2DeviceBroker::Endpoint (void) const
+{
+#if defined(AJA_WINDOWS)
+	return "'" + mName + "' (" + NTV2TCPServer::Endpoint() + ")";
+#else
+	return "'" + SocketPath(mName) + "'";
+#endif
+}
+
+void NTV2DeviceBroker::RefreshThreadStatic (AJAThread * pThread, void * pContext)	//	CLASS METHOD
+{	(void) pThread;
+	NTV2DeviceBroker * pBroker (reinterpret_cast<NTV2DeviceBroker*>(pContext));
+	if (pBroker)
+		pBroker->RefreshThread();
+}
+
+void NTV2DeviceBroker::RefreshThread (void)
+{
+	CNTV2Card & device (GetDevice());
+	while (!mQuitRefresh)
+	{
+		const uint64_t startMs (AJATime::GetSystemMilliseconds());
+		if (!device.WaitForInterrupt(eOutput1, kBrokerRefreshMs))
+		{	//	No VBI -- don't refresh any faster than kBrokerRefreshMs
+			const uint64_t elapsedMs (AJATime::GetSystemMilliseconds() - startMs);
+			if (elapsedMs < kBrokerRefreshMs)
+				AJATime::Sleep(int32_t(kBrokerRefreshMs - elapsedMs));
+		}
+		if (!mQuitRefresh)
+			RefreshSnapshot();
+	}
+}
+
+void NTV2DeviceBroker::RefreshSnapshot (void)
+{
+	NTV2RegisterReads regs (mSnapshotRegs);
+	if (!GetDevice().ReadRegisters(regs))
+		{BSWARN("ReadRegisters failed");  return;}
+	volatile ULWord * pValues (SharedValues(mpShared));
+	AJAAtomic::Increment(&mpShared->sequence);		//	Odd:  update in progress
+	for (size_t ndx(0);  ndx < regs.size();  ndx++)
+		pValues[regs.at(ndx).registerNumber] = regs.at(ndx).registerValue;
+	mpShared->refreshCount = mpShared->refreshCount + 1;
+	mpShared->refreshTime = AJATime::GetSystemMicroseconds();
+	AJAAtomic::Increment(&mpShared->sequence);		//	Even:  done
+}
+
+ULWord64 NTV2DeviceBroker::GetSnapshotCount (void) const
+{
+	return mpShared ? ULWord64(mpShared->refreshCount) : 0;
+}
+
+
+//	Reservations
+
+bool NTV2DeviceBroker::Reserve (const ULWord inConnectionID, const NTV2BrokerReservation & inRequest, const ULWord inTimeoutMs, string & outOwner)
+{
+	const uint64_t deadline (AJATime::GetSystemMilliseconds() + inTimeoutMs);
+	while (true)
+	{
+		{
+			AJAAutoLock tmp(&mResLock);
+			BrokerReservationMap::const_iterator it (mReservations.find(inRequest.channel));
+			if (it != mReservations.end()  &&  it->second.connectionID == inConnectionID)
+				return true;	//	Already mine
+			if (it == mReservations.end())
+			{
+				NTV2BrokerReservation & reservation (mReservations[inRequest.channel]);
+				reservation = inRequest;
+				reservation.connectionID = inConnectionID;
+				BSDBG(reservation);
+				return true;
+			}
+			outOwner = it->second.owner;
+		}
+		if (mTerminate  ||  AJATime::GetSystemMilliseconds() >= deadline)
+			return false;
+		mReleased.WaitForSignal(10);
+	}
+}
+
+bool NTV2DeviceBroker::HandleRequest (const ULWord inConnectionID, const UWord inOpcode, const NTV2_RPC_BLOB_TYPE & inRequest, NTV2_RPC_BLOB_TYPE & outResponse)
+{
+	size_t ndx(0);
+	switch (inOpcode)
+	{
+		case kBrokerOpReserve:
+		{
+			NTV2BrokerReservation reservation;
+			UWord channel(0);
+			ULWord timeoutMs(0);
+			uint64_t pid(0);
+			string owner;
+			if (inRequest.size() < sizeof(UWord) + 2 * sizeof(ULWord) + sizeof(uint64_t))
+				return false;
+			POPU16(channel, inRequest, ndx);
+			POPU32(timeoutMs, inRequest, ndx);
+			POPU32(reservation.appType, inRequest, ndx);
+			POPU64(pid, inRequest, ndx);
+			if (!PopBrokerString(reservation.owner, inRequest, ndx)  ||  !NTV2_IS_VALID_CHANNEL(NTV2Channel(channel)))
+				return false;
+			reservation.channel = NTV2Channel(channel);
+			reservation.processID = pid;
+			if (Reserve(inConnectionID, reservation, timeoutMs, owner))
+				return true;
+			PushBrokerString(owner, outResponse);
+			return false;
+		}
+
+		case kBrokerOpRelease:
+		{
+			UWord channel(0);
+			if (inRequest.size() != sizeof(UWord))
+				return false;
+			POPU16(channel, inRequest, ndx);
+			AJAAutoLock tmp(&mResLock);
+			BrokerReservationMap::iterator it (mReservations.find(NTV2Channel(channel)));
+			if (it == mReservations.end()  ||  it->second.connectionID != inConnectionID)
+				return false;	//	Not mine
+			mReservations.erase(it);
+			mReleased.Signal();
+			return true;
+		}
+
+		case kBrokerOpReservations:
+		{
+			const NTV2BrokerReservations reservations (GetReservations());
+			PUSHU32(ULWord(reservations.size()), outResponse);
+			for (size_t num(0);  num < reservations.size();  num++)
+			{
+				const NTV2BrokerReservation & reservation (reservations.at(num));
+				PUSHU16(UWord(reservation.channel), outResponse);
+				PUSHU32(reservation.connectionID, outResponse);
+				PUSHU32(reservation.appType, outResponse);
+				PUSHU64(reservation.processID, outResponse);
+				PushBrokerString(reservation.owner, outResponse);
+			}
+			return true;
+		}
+
+		default:
+			break;
+	}
+	return NTV2TCPServer::HandleRequest(inConnectionID, inOpcode, inRequest, outResponse);
+}
+
+bool NTV2DeviceBroker::IsBlockingRequest (const UWord inOpcode) const
+{
+	return inOpcode == kBrokerOpReserve;	//	It may wait for a release
+}
+
+void NTV2DeviceBroker::ConnectionClosed (const ULWord inConnectionID)
+{
+	AJAAutoLock tmp(&mResLock);
+	for (BrokerReservationMap::iterator it(mReservations.begin());  it != mReservations.end();  )
+		if (it->second.connectionID == inConnectionID)
+			{BSDBG("Released " << it->second);  mReservations.erase(it++);  mReleased.Signal();}
+		else
+			++it;
+}
+
+NTV2BrokerReservations NTV2DeviceBroker::GetReservations (void) const
+{
+	NTV2BrokerReservations result;
+	AJAAutoLock tmp(&mResLock);
+	for (BrokerReservationMap::const_iterator it(mReservations.begin());  it != mReservations.end();  ++it)
+		result.push_back(it->second);
+	return result;
+}
+
+ostream & NTV2DeviceBroker::Print (ostream & oss) const
+{
+	NTV2TCPServer::Print(oss);
+	oss << ", " << DEC(GetSnapshotCount()) << " snapshot(s), " << DEC(GetReservations().size()) << " reservation(s)";
+	return oss;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	NTV2BrokerClient
+
+NTV2BrokerClient * NTV2BrokerClient::Create (const NTV2ConnectParams & inParams)	//	CLASS METHOD
+{
+	const string name (inParams.valueForKey(kConnectParamHost));
+	if (!NTV2DeviceBroker::IsLegalName(name))
+		{AJA_sERROR(AJA_DebugUnit_RPCClient, AJAFUNC << ": Bad or missing broker name '" << name << "'");  return AJA_NULL;}
+	return new NTV2BrokerClient(inParams);
+}
+
+NTV2BrokerClient * NTV2BrokerClient::FromDevice (CNTV2Card & inDevice)	//	CLASS METHOD
+{
+	return dynamic_cast<NTV2BrokerClient*>(inDevice.GetRPCAPI());
+}
+
+NTV2BrokerClient::NTV2BrokerClient (const NTV2ConnectParams & inParams)
+	:	NTV2TCPClient	(inParams),
+		mpShared		(AJA_NULL)
+{
+	SetDefaultSharedMemory(kNTV2TCPDefaultSharedMB);	//	Broker's always on this host
+}
+
+NTV2BrokerClient::~NTV2BrokerClient ()
+{
+	if (IsConnected())
+		NTV2Disconnect();	//	Before ~NTV2TCPClient, which can't call my NTV2CloseRemote
+	UnmapSnapshot();
+}
+
+string NTV2BrokerClient::Name (void) const
+{
+	return string(kLegalSchemeNTV2Broker) + "://" + HostName();
+}
+
+bool NTV2BrokerClient::MapSnapshot (void)
+{
+	if (mpShared)
+		return true;
+	const string sharedName (NTV2DeviceBroker::SharedName(HostName()));
+	size_t sharedBytes (SharedBytes());
+	mpShared = reinterpret_cast<NTV2BrokerShared*>(AJAMemory::AllocateShared(&sharedBytes, sharedName.c_str()));
+	if (!mpShared)
+		{BCFAIL("Can't map shared memory '" << sharedName << "'");  return false;}
+	if (sharedBytes < SharedBytes()  ||  mpShared->magic != kBrokerMagic  ||  mpShared->version != kBrokerVersion
+		||  !mpShared->alive  ||  mpShared->headerBytes != sizeof(NTV2BrokerShared)  ||  mpShared->numRegs > kBrokerMaxSnapshotRegs)
+	{
+		BCFAIL("Broker '" << HostName() << "' not running, or incompatible");
+		UnmapSnapshot();
+		return false;
+	}
+	return true;
+}
+
+void NTV2BrokerClient::UnmapSnapshot (void)
+{
+	if (mpShared)
+		AJAMemory::FreeShared(mpShared);
+	mpShared = AJA_NULL;
+}
+
+int NTV2BrokerClient::ConnectSocket (void)
+{
+#if defined(AJA_WINDOWS)
+	//	The broker's loopback port is in shared memory
+	if (!MapSnapshot())
+		return -1;
+	NTV2ConnectParams params (ConnectParams());
+	params.insert(kConnectParamPort, aja::to_string(mpShared->port));
+	SetConnectParams(params);
+	return NTV2TCPClient::ConnectSocket();
+#else
+	const string path (NTV2DeviceBroker::SocketPath(HostName()));
+	struct sockaddr_un addr;
+	::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path))
+		{BCFAIL("Socket path '" << path << "' too long");  return -1;}
+	::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	const int sock (::socket(AF_UNIX, SOCK_STREAM, 0));
+	if (sock < 0)
+		{BCFAIL("socket failed");  return -1;}
+	if (::connect(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)))
+		{BCFAIL("Broker '" << HostName() << "' not listening on '" << path << "'");  BrokerCloseSocket(sock);  return -1;}
+	return sock;
+#endif
+}
+
+bool NTV2BrokerClient::NTV2OpenRemote (void)
+{
+	if (!NTV2TCPClient::NTV2OpenRemote())
+		return false;
+	if (!MapSnapshot())
+		{NTV2TCPClient::NTV2CloseRemote();  return false;}
+	if (mpShared->deviceID != ULWord(DeviceID()))
+		BCWARN("Snapshot device ID " << xHEX0N(mpShared->deviceID,8) << " doesn't match " << xHEX0N(DeviceID(),8));
+	return true;
+}
+
+bool NTV2BrokerClient::NTV2CloseRemote (void)
+{
+	const bool result (NTV2TCPClient::NTV2CloseRemote());
+	UnmapSnapshot();
+	AJAAutoLock tmp(&mWrittenLock);
+	mWritten.clear();
+	return result;
+}
+
+bool NTV2BrokerClient::ReadSnapshot (const ULWord inRegNum, ULWord & outValue) const
+{
+	if (!IsSnapshotReg(mpShared, inRegNum)  ||  !mpShared->alive)
+		return false;
+	volatile ULWord * pValues (SharedValues(mpShared));
+	for (int tries(0);  tries < 10000;  tries++)
+	{
+		const uint32_t sequence (mpShared->sequence);
+		BrokerBarrier();
+		if (sequence & 1)
+			{if (tries > 100) AJATime::SleepInMicroseconds(10);  continue;}	//	Update in progress
+		const ULWord value (pValues[inRegNum]);
+		BrokerBarrier();
+		if (mpShared->sequence == sequence)
+			{outValue = value;  return true;}
+	}
+	return false;
+}
+
+ULWord64 NTV2BrokerClient::GetSnapshotCount (void) const
+{
+	return mpShared ? ULWord64(mpShared->refreshCount) : 0;
+}
+
+ULWord64 NTV2BrokerClient::GetSnapshotTime (void) const
+{
+	return mpShared ? ULWord64(mpShared->refreshTime) : 0;
+}
+
+ULWord NTV2BrokerClient::GetSnapshotRegCount (void) const
+{
+	return mpShared ? mpShared->numRegs : 0;
+}
+
+bool NTV2BrokerClient::ReadLocalRegister (const ULWord inRegNum, ULWord & outValue)
+{
+	if (!IsSnapshotReg(mpShared, inRegNum))
+		return false;
+	{	//	Registers I wrote must be read from the device until a refresh that started after the write completes
+		AJAAutoLock tmp(&mWrittenLock);
+		RegSequenceMap::iterator it (mWritten.find(inRegNum));
+		if (it != mWritten.end())
+		{
+			if (int32_t(mpShared->sequence - it->second) < 0)
+				return false;
+			mWritten.erase(it);
+		}
+	}
+	return ReadSnapshot(inRegNum, outValue);
+}
+
+void NTV2BrokerClient::RegistersWritten (const NTV2RegisterWrites & inWrites)
+{
+	if (!mpShared)
+		return;
+	const uint32_t sequence (mpShared->sequence);
+	const uint32_t ready (sequence + 2 + (sequence & 1));	//	End of the first refresh that starts after now
+	AJAAutoLock tmp(&mWrittenLock);
+	for (size_t ndx(0);  ndx < inWrites.size();  ndx++)
+		if (IsSnapshotReg(mpShared, inWrites.at(ndx).registerNumber))
+			mWritten[inWrites.at(ndx).registerNumber] = ready;
+}
+
+
+//	Reservations
+
+bool NTV2BrokerClient::ReserveChannel (const NTV2Channel inChannel, const string & inOwner, const ULWord inTimeoutMs, const ULWord inAppType)
+{
+	if (!NTV2_IS_VALID_CHANNEL(inChannel))
+		return false;
+	NTV2_RPC_BLOB_TYPE request, response;
+	UWord flags(0);
+	PUSHU16(UWord(inChannel), request);
+	PUSHU32(inTimeoutMs, request);
+	PUSHU32(inAppType, request);
+	PUSHU64(AJAProcess::GetPid(), request);
+	PushBrokerString(inOwner, request);
+	if (Transact(kBrokerOpReserve, request, response, flags, inTimeoutMs + kBrokerRequestTimeoutMs))
+		return true;
+	string owner;
+	size_t ndx(0);
+	if (PopBrokerString(owner, response, ndx))
+		BCDBG(::NTV2ChannelToString(inChannel, true) << " reserved by '" << owner << "'");
+	return false;
+}
+
+bool NTV2BrokerClient::ReleaseChannel (const NTV2Channel inChannel)
+{
+	NTV2_RPC_BLOB_TYPE request, response;
+	UWord flags(0);
+	PUSHU16(UWord(inChannel), request);
+	return Transact(kBrokerOpRelease, request, response, flags, kBrokerRequestTimeoutMs);
+}
+
+bool NTV2BrokerClient::GetReservations (NTV2BrokerReservations & outReservations)
+{
+	outReservations.clear();
+	NTV2_RPC_BLOB_TYPE request, response;
+	UWord flags(0);
+	ULWord count(0);
+	size_t ndx(0);
+	if (!Transact(kBrokerOpReservations, request, response, flags, kBrokerRequestTimeoutMs)  ||  response.size() < sizeof(ULWord))
+		return false;
+	POPU32(count, response, ndx);
+	for (ULWord num(0);  num < count;  num++)
+	{
+		NTV2BrokerReservation reservation;
+		UWord channel(0);
+		if (ndx + sizeof(UWord) + 2 * sizeof(ULWord) + sizeof(uint64_t) > response.size())
+			return false;
+		POPU16(channel, response, ndx);
+		POPU32(reservation.connectionID, response, ndx);
+		POPU32(reservation.appType, response, ndx);
+		POPU64(reservation.processID, response, ndx);
+		if (!PopBrokerString(reservation.owner, response, ndx))
+			return false;
+		reservation.channel = NTV2Channel(channel);
+		outReservations.push_back(reservation);
+	}
+	return true;
+}
@@ -1,22 +1,33 @@
 /* SPDX-License-Identifier: MIT */
 /**
 	@file		ntv2devicefeatures.cpp
-	@brief		Implementations of non-auto-generated device capability functions.
+	@brief		Implementations of non-auto-generated device capability functions, and of device feature row publishing.
 	@copyright	(C) 2004-2022 AJA Video Systems, Inc.
-	@note		The functions in this module are those that aren't auto-generated by a Python script from CSV
-				files that were exported from a spreadsheet. The mechanically-generated functions are placed
-				in the 'ntv2devicefeatures.hpp' file that's included below. See the README in 'ntv2projects/sdkgen'
-				for more details.
+	@note		The table-driven NTV2DeviceCanDo... and NTV2DeviceGetNum... functions, and the device feature table
+				they answer from, are in the 'ntv2devicefeatures.hpp' file that's included below.
 **/
 
 #include "ntv2devicefeatures.h"
+#if (defined(__CPLUSPLUS__) || defined(__cplusplus)) && !defined(NTV2_BUILDING_DRIVER)
+	#include "ajabase/system/atomic.h"
+	#include "ajabase/system/lock.h"
+	#include <cstddef>
+	#include <cstdlib>
+	#include <cstring>
+	#include <algorithm>
+	#include <deque>
+	#include <iomanip>
+	#include <sstream>
+	#include <vector>
+#endif
 
-//	Most of the device features functions are generated using a Python script from files inside 'ntv2projects/sdkgen/device'.
-//	The script writes the declarations into 'ntv2devicefeatures.hh', and implementations into 'ntv2devicefeatures.hpp'...
+//	The declarations of most of the device features functions are generated into 'ntv2devicefeatures.hh' using a Python
+//	script from files inside 'ntv2projects/sdkgen/device'. The device feature table, and the functions that answer from it,
+//	are maintained in 'ntv2devicefeatures.hpp'...
 #include "ntv2devicefeatures.hpp"
 
 ///////////////////////////////////////////////////////////////////////////
-//	The rest of the non-sdkgen-generated function implementations follow...
+//	The rest of the function implementations follow...
 ///////////////////////////////////////////////////////////////////////////
 
 #if !defined(NTV2_DEPRECATE_17_2)
@@ -1173,3 +1184,214 @@ bool NTV2DeviceROMHasBankSelect (const NTV2DeviceID inDeviceID)
 #endif	//	!defined(NTV2_DEPRECATE_17_0)
 
 bool work_around_erroneous_compiler_warning (void)	{return true;}
+
+
+///////////////////////////////////////////////////////////////////////////
+//	Published device feature rows...
+///////////////////////////////////////////////////////////////////////////
+#if (defined(__CPLUSPLUS__) || defined(__cplusplus)) && !defined(NTV2_BUILDING_DRIVER)
+using namespace std;
+
+typedef vector<NTV2DeviceFeatureRow>	NTV2DevFeatRows;		//	Sorted by device ID
+typedef NTV2DevFeatRows::iterator		NTV2DevFeatRowsIter;
+
+//	The published rows are an immutable snapshot that queries read without a lock. Publishing builds a new
+//	snapshot and swaps it in;  the one it replaces is retired (not deleted), as queries may still be reading it.
+//	Only publishing or unpublishing a different row retires a snapshot, so they only pile up if rows keep changing.
+static AJALock						sDevFeatLock;						//	Serializes publishers, and guards sDevFeatRetired
+static NTV2DevFeatRows * volatile	sDevFeatSnapshot (AJA_NULL);		//	The current snapshot, or NULL if nothing's published
+static deque<NTV2DevFeatRows *>		sDevFeatRetired;					//	Snapshots that were replaced
+
+static struct NTV2DevFeatSnapshotReaper
+{
+	~NTV2DevFeatSnapshotReaper ()
+	{
+		delete sDevFeatSnapshot;
+		sDevFeatSnapshot = AJA_NULL;
+		while (!sDevFeatRetired.empty())
+			{delete sDevFeatRetired.back();  sDevFeatRetired.pop_back();}
+	}
+} sDevFeatSnapshotReaper;	//	Constructed after (so destroyed before) the snapshot variables above
+
+//	Where each supported item bitset lives in a row, in sDevFeatItemNames order...
+static const struct {size_t fOffset;  ULWord fNumBits;}	sDevFeatItemColumns [NTV2_DEVFEAT_NUM_ITEM_COLUMNS] =
+{
+	{offsetof(NTV2DeviceFeatureRow, conversionModes),	ULWord(NTV2_NUM_CONVERSIONMODES)},
+	{offsetof(NTV2DeviceFeatureRow, dskModes),			ULWord(NTV2_DSKModeMax)},
+	{offsetof(NTV2DeviceFeatureRow, pixelFormats),		ULWord(NTV2_FBF_NUMFRAMEBUFFERFORMATS)},
+	{offsetof(NTV2DeviceFeatureRow, inputSources),		ULWord(NTV2_NUM_INPUTSOURCES)},
+	{offsetof(NTV2DeviceFeatureRow, videoFormats),		ULWord(NTV2_MAX_NUM_VIDEO_FORMATS)},
+	{offsetof(NTV2DeviceFeatureRow, widgets),			ULWord(NTV2_WgtModuleTypeCount)}
+};
+
+static inline ULWord * DevFeatItemWords (NTV2DeviceFeatureRow & inRow, const size_t inColumn)
+{
+	return reinterpret_cast<ULWord*>(reinterpret_cast<UByte*>(&inRow) + sDevFeatItemColumns[inColumn].fOffset);
+}
+
+static inline const ULWord * DevFeatItemWords (const NTV2DeviceFeatureRow & inRow, const size_t inColumn)
+{
+	return reinterpret_cast<const ULWord*>(reinterpret_cast<const UByte*>(&inRow) + sDevFeatItemColumns[inColumn].fOffset);
+}
+
+static bool DevFeatParseULWord (const string & inStr, ULWord & outValue)
+{
+	if (inStr.empty())
+		return false;
+	char * pEnd (AJA_NULL);
+	const unsigned long long value (::strtoull(inStr.c_str(), &pEnd, 0));
+	if (!pEnd  ||  *pEnd  ||  value > 0xFFFFFFFFULL)
+		return false;
+	outValue = ULWord(value);
+	return true;
+}
+
+static inline bool DevFeatRowIDLess (const NTV2DeviceFeatureRow & inRow, const ULWord inDeviceID)
+{
+	return inRow.deviceID < inDeviceID;
+}
+
+static const NTV2DeviceFeatureRow * NTV2DevFeatFindPublishedRow (const NTV2DeviceID inDeviceID)
+{
+	const NTV2DevFeatRows * pRows (sDevFeatSnapshot);
+	if (!pRows)
+		return AJA_NULL;	//	Nothing published (the usual case)
+	NTV2DevFeatRows::const_iterator it (lower_bound(pRows->begin(), pRows->end(), ULWord(inDeviceID), DevFeatRowIDLess));
+	return it != pRows->end()  &&  it->deviceID == ULWord(inDeviceID)  ?  &(*it)  :  AJA_NULL;
+}
+
+static void DevFeatSwapSnapshot (NTV2DevFeatRows * pInNewRows)	//	Caller must hold sDevFeatLock
+{
+	if (pInNewRows  &&  pInNewRows->empty())
+		{delete pInNewRows;  pInNewRows = AJA_NULL;}
+	//	Exchange is a barrier, so the new snapshot is fully built before queries can see it...
+	void * pOld (AJAAtomic::Exchange(reinterpret_cast<void* volatile*>(&sDevFeatSnapshot), pInNewRows));
+	if (pOld)
+		sDevFeatRetired.push_back(reinterpret_cast<NTV2DevFeatRows*>(pOld));
+}
+
+bool NTV2DeviceGetFeatureRow (const NTV2DeviceID inDeviceID, NTV2DeviceFeatureRow & outRow)
+{
+	const NTV2DeviceFeatureRow * pRow (NTV2DevFeatFindRow(inDeviceID));
+	if (!pRow)
+		return false;
+	outRow = *pRow;
+	return true;
+}
+
+bool NTV2DevicePublishFeatureRow (const NTV2DeviceFeatureRow & inRow)
+{
+	if (NTV2DeviceID(inRow.deviceID) == DEVICE_ID_NOTFOUND)
+		return false;
+	AJAAutoLock locker(&sDevFeatLock);
+	NTV2DevFeatRows * pRows (sDevFeatSnapshot ? new NTV2DevFeatRows(*sDevFeatSnapshot) : new NTV2DevFeatRows);
+	NTV2DevFeatRowsIter it (lower_bound(pRows->begin(), pRows->end(), inRow.deviceID, DevFeatRowIDLess));
+	if (it == pRows->end()  ||  it->deviceID != inRow.deviceID)
+		pRows->insert(it, inRow);
+	else if (::memcmp(&(*it), &inRow, sizeof(inRow)))
+		*it = inRow;
+	else
+		{delete pRows;  return true;}	//	Already published as-is
+	DevFeatSwapSnapshot(pRows);
+	return true;
+}
+
+bool NTV2DeviceUnpublishFeatureRow (const NTV2DeviceID inDeviceID)
+{
+	AJAAutoLock locker(&sDevFeatLock);
+	if (!sDevFeatSnapshot)
+		return false;
+	NTV2DevFeatRows * pRows (new NTV2DevFeatRows(*sDevFeatSnapshot));
+	NTV2DevFeatRowsIter it (lower_bound(pRows->begin(), pRows->end(), ULWord(inDeviceID), DevFeatRowIDLess));
+	if (it == pRows->end()  ||  it->deviceID != ULWord(inDeviceID))
+		{delete pRows;  return false;}
+	pRows->erase(it);
+	DevFeatSwapSnapshot(pRows);
+	return true;
+}
+
+string NTV2DeviceFeatureRowToString (const NTV2DeviceFeatureRow & inRow)
+{
+	ostringstream oss;
+	oss << "DeviceID=0x" << hex << setw(8) << setfill('0') << inRow.deviceID << dec << endl;
+	for (ULWord col(0);  col < NTV2_DEVICE_FEATURE_NUM_BOOLS;  col++)
+		oss << sDevFeatBoolNames[col] << "=" << (NTV2DevFeatTestBit(inRow.bools, NTV2_DEVICE_FEATURE_NUM_BOOLS, col) ? 1 : 0) << endl;
+	for (ULWord col(0);  col < NTV2_DEVICE_FEATURE_NUM_NUMS;  col++)
+		oss << sDevFeatNumNames[col] << "=" << inRow.nums[col] << endl;
+	for (size_t col(0);  col < NTV2_DEVFEAT_NUM_ITEM_COLUMNS;  col++)
+	{
+		const ULWord * pWords (DevFeatItemWords(inRow, col));
+		oss << sDevFeatItemNames[col] << "=";
+		for (ULWord item(0), num(0);  item < sDevFeatItemColumns[col].fNumBits;  item++)
+			if (NTV2DevFeatTestBit(pWords, sDevFeatItemColumns[col].fNumBits, item))
+				oss << (num++ ? "," : "") << item;
+		oss << endl;
+	}
+	return oss.str();
+}
+
+bool NTV2DeviceFeatureRowFromString (const string & inStr, NTV2DeviceFeatureRow & outRow)
+{
+	NTV2DeviceFeatureRow row;
+	::memset(&row, 0, sizeof(row));
+	bool hasDeviceID (false);
+	istringstream iss (inStr);
+	string line;
+	while (getline(iss, line))
+	{
+		if (!line.empty()  &&  line[line.size()-1] == '\r')
+			line.resize(line.size()-1);
+		if (line.empty())
+			continue;
+		const size_t equalsPos (line.find('='));
+		if (equalsPos == string::npos)
+			return false;
+		const string name (line.substr(0, equalsPos)),  value (line.substr(equalsPos+1));
+		ULWord num (0);
+		if (name == "DeviceID")
+		{
+			if (!DevFeatParseULWord(value, row.deviceID))
+				return false;
+			hasDeviceID = true;
+			continue;
+		}
+		bool found (false);
+		for (ULWord col(0);  !found  &&  col < NTV2_DEVICE_FEATURE_NUM_BOOLS;  col++)
+			if (name == sDevFeatBoolNames[col])
+			{
+				if (!DevFeatParseULWord(value, num))
+					return false;
+				if (num)
+					row.bools[col / 32] |= ULWord(1) << (col % 32);
+				found = true;
+			}
+		for (ULWord col(0);  !found  &&  col < NTV2_DEVICE_FEATURE_NUM_NUMS;  col++)
+			if (name == sDevFeatNumNames[col])
+			{
+				if (!DevFeatParseULWord(value, row.nums[col]))
+					return false;
+				found = true;
+			}
+		for (size_t col(0);  !found  &&  col < NTV2_DEVFEAT_NUM_ITEM_COLUMNS;  col++)
+			if (name == sDevFeatItemNames[col])
+			{
+				ULWord * pWords (DevFeatItemWords(row, col));
+				istringstream items (value);
+				string item;
+				while (getline(items, item, ','))
+				{
+					if (!DevFeatParseULWord(item, num))
+						return false;
+					if (num < sDevFeatItemColumns[col].fNumBits)	//	Ignore items this SDK doesn't know about
+						pWords[num / 32] |= ULWord(1) << (num % 32);
+				}
+				found = true;
+			}
+		//	Ignore features this SDK doesn't know about
+	}
+	if (!hasDeviceID)
+		return false;
+	outRow = row;
+	return true;
+}
+#endif	//	C++ && !NTV2_BUILDING_DRIVER
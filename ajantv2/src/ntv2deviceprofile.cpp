@@ -0,0 +1,419 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2deviceprofile.cpp
+	@brief		Implements the NTV2DeviceProfile class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2deviceprofile.h"
+#include "ntv2devicesnapshot.h"
+#include "ntv2driverinterface.h"
+#include "ntv2nubtypes.h"
+#include "ntv2utils.h"
+#include "ajabase/system/debug.h"
+#include "ajabase/system/lock.h"
+#include "ajabase/system/process.h"
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#if defined(AJA_WINDOWS)
+	#include <io.h>
+	#define	DPOPENEXCL(__p__)	::_open((__p__), _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY, _S_IREAD | _S_IWRITE)
+	#define	DPWRITE				::_write
+	#define	DPCLOSE				::_close
+#else
+	#include <unistd.h>
+	#define	DPOPENEXCL(__p__)	::open((__p__), O_WRONLY | O_CREAT | O_EXCL, 0600)
+	#define	DPWRITE				::write
+	#define	DPCLOSE				::close
+#endif
+
+using namespace std;
+using namespace ntv2nub;
+
+#define DPFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_DriverInterface, AJAFUNC << ": " << __x__)
+#define DPWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_DriverInterface, AJAFUNC << ": " << __x__)
+#define DPDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_DriverInterface, AJAFUNC << ": " << __x__)
+
+static const ULWord		kProfileMagic		(NTV2_FOURCC('N','T','D','P'));
+static const ULWord		kProfileVersion		(1);
+static const ULWord		kProfileMaxBytes	(64UL * 1024UL * 1024UL);
+static const string		kProfileFilePrefix	("ntv2profile-");
+static const string		kProfileFileSuffix	(".bin");
+#if defined(AJA_WINDOWS)
+	static const char	kPathSeparator		('\\');
+#else
+	static const char	kPathSeparator		('/');
+#endif
+
+static AJALock		gCacheLock;
+static string		gCacheFolder;		//	Empty (caching disabled) until SetCacheFolder is called
+
+
+static inline bool HasBytes (const NTV2_RPC_BLOB_TYPE & inBlob, const size_t inNdx, const size_t inNeeded)
+{
+	return inNdx <= inBlob.size()  &&  inBlob.size() - inNdx >= inNeeded;
+}
+
+static void PushValueMap (const NTV2RegisterValueMap & inMap, NTV2_RPC_BLOB_TYPE & outBlob)
+{
+	PUSHU32(ULWord(inMap.size()), outBlob);
+	for (NTV2RegValueMapConstIter it(inMap.begin());  it != inMap.end();  ++it)
+		{PUSHU32(it->first, outBlob);  PUSHU32(it->second, outBlob);}
+}
+
+static bool PopValueMap (NTV2RegisterValueMap & outMap, const NTV2_RPC_BLOB_TYPE & inBlob, size_t & inOutNdx)
+{
+	ULWord count(0);
+	outMap.clear();
+	if (!HasBytes(inBlob, inOutNdx, sizeof(ULWord)))
+		return false;
+	POPU32(count, inBlob, inOutNdx);
+	if (!HasBytes(inBlob, inOutNdx, size_t(count) * 2 * sizeof(ULWord)))
+		return false;
+	for (ULWord num(0);  num < count;  num++)
+	{	ULWord key(0), value(0);
+		POPU32(key, inBlob, inOutNdx);
+		POPU32(value, inBlob, inOutNdx);
+		outMap[key] = value;
+	}
+	return true;
+}
+
+
+NTV2DeviceProfile::NTV2DeviceProfile ()
+	:	mDeviceID			(DEVICE_ID_NOTFOUND),
+		mFirmwareVersion	(0)
+{
+}
+
+void NTV2DeviceProfile::Clear (void)
+{
+	mDeviceID = DEVICE_ID_NOTFOUND;
+	mFirmwareVersion = 0;
+	mBools.clear();
+	mNums.clear();
+	mEnums.clear();
+	mRegNames.clear();
+	mRouteROM.clear();
+}
+
+bool NTV2DeviceProfile::SetFromDevice (CNTV2DriverInterface & inDevice)
+{
+	return inDevice.GetDeviceProfile(*this);
+}
+
+bool NTV2DeviceProfile::SetFromDeviceID (const NTV2DeviceID inDeviceID)
+{
+	Clear();
+	const NTV2DeviceIDSet devIDs (::NTV2GetSupportedDevices());
+	if (devIDs.find(inDeviceID) == devIDs.end())
+		{DPFAIL("Unsupported device ID " << xHEX0N(ULWord(inDeviceID),8));  return false;}
+	//	A snapshot holding nothing but kRegBoardID answers every feature that doesn't need a register...
+	CNTV2DeviceSnapshot snapshot;
+	NTV2RegisterValueMap regValues;
+	regValues[kRegBoardID] = ULWord(inDeviceID);
+	return snapshot.SetRegisterValues(regValues)  &&  snapshot.GetDeviceProfile(*this);
+}
+
+bool NTV2DeviceProfile::ReadFirmwareVersion (CNTV2DriverInterface & inDevice, ULWord64 & outVersion)
+{
+	outVersion = 0;
+	NTV2RegReads regs;
+	regs.push_back(NTV2RegInfo(kRegBitfileDate));
+	regs.push_back(NTV2RegInfo(kRegBitfileTime));
+	regs.push_back(NTV2RegInfo(kRegDMAControl));
+	if (!inDevice.IsOpen()  ||  !inDevice.ReadRegisters(regs))
+		return false;
+	outVersion = MakeFirmwareVersion(regs.at(0).registerValue, regs.at(1).registerValue, regs.at(2).registerValue);
+	return true;
+}
+
+ULWord64 NTV2DeviceProfile::MakeFirmwareVersion (const ULWord inBitfileDate, const ULWord inBitfileTime, const ULWord inDMAControl)
+{
+	return (ULWord64(inBitfileDate) << 32)  |  (ULWord64(inBitfileTime & 0x00FFFFFF) << 8)  |  ULWord64((inDMAControl & 0x0000FF00) >> 8);
+}
+
+bool NTV2DeviceProfile::Encode (NTV2_RPC_BLOB_TYPE & outBlob) const
+{
+	if (IsEmpty())
+		return false;
+	PUSHU32(kProfileMagic, outBlob);
+	PUSHU32(kProfileVersion, outBlob);
+	PUSHU32(ULWord(mDeviceID), outBlob);
+	PUSHU64(mFirmwareVersion, outBlob);
+	PushValueMap(mBools, outBlob);
+	PushValueMap(mNums, outBlob);
+	PUSHU32(ULWord(mEnums.size()), outBlob);
+	for (NTV2SupportedItemsMapConstIter it(mEnums.begin());  it != mEnums.end();  ++it)
+	{
+		PUSHU32(it->first, outBlob);
+		PUSHU32(ULWord(it->second.size()), outBlob);
+		for (ULWordSetConstIter item(it->second.begin());  item != it->second.end();  ++item)
+			PUSHU32(*item, outBlob);
+	}
+	PUSHU32(ULWord(mRegNames.size()), outBlob);
+	for (NTV2RegisterNameMapConstIter it(mRegNames.begin());  it != mRegNames.end();  ++it)
+	{
+		PUSHU32(it->first, outBlob);
+		PUSHU32(ULWord(it->second.size()), outBlob);
+		outBlob.insert(outBlob.end(), it->second.begin(), it->second.end());
+	}
+	PUSHU32(ULWord(mRouteROM.size()), outBlob);
+	for (NTV2RegReadsConstIter it(mRouteROM.begin());  it != mRouteROM.end();  ++it)
+		{PUSHU32(it->registerNumber, outBlob);  PUSHU32(it->registerValue, outBlob);}
+	return true;
+}
+
+bool NTV2DeviceProfile::Decode (const NTV2_RPC_BLOB_TYPE & inBlob)
+{
+	Clear();
+	size_t ndx(0);
+	ULWord magic(0), version(0), devID(0), count(0);
+	if (!HasBytes(inBlob, ndx, 3 * sizeof(ULWord) + sizeof(ULWord64)))
+		{DPFAIL("Truncated header");  return false;}
+	POPU32(magic, inBlob, ndx);
+	POPU32(version, inBlob, ndx);
+	if (magic != kProfileMagic  ||  version != kProfileVersion)
+		{DPFAIL("Bad magic " << xHEX0N(magic,8) << " or version " << DEC(version));  return false;}
+	POPU32(devID, inBlob, ndx);
+	POPU64(mFirmwareVersion, inBlob, ndx);
+	mDeviceID = NTV2DeviceID(devID);
+	if (!PopValueMap(mBools, inBlob, ndx)  ||  !PopValueMap(mNums, inBlob, ndx))
+		{DPFAIL("Truncated features");  Clear();  return false;}
+
+	if (!HasBytes(inBlob, ndx, sizeof(ULWord)))
+		{DPFAIL("Truncated supported items");  Clear();  return false;}
+	POPU32(count, inBlob, ndx);
+	for (ULWord num(0);  num < count;  num++)
+	{	ULWord enumsID(0), numItems(0);
+		if (!HasBytes(inBlob, ndx, 2 * sizeof(ULWord)))
+			{DPFAIL("Truncated supported items");  Clear();  return false;}
+		POPU32(enumsID, inBlob, ndx);
+		POPU32(numItems, inBlob, ndx);
+		if (!HasBytes(inBlob, ndx, size_t(numItems) * sizeof(ULWord)))
+			{DPFAIL("Truncated supported items");  Clear();  return false;}
+		ULWordSet & items (mEnums[enumsID]);
+		for (ULWord item(0);  item < numItems;  item++)
+			{ULWord value(0);  POPU32(value, inBlob, ndx);  items.insert(value);}
+	}
+
+	if (!HasBytes(inBlob, ndx, sizeof(ULWord)))
+		{DPFAIL("Truncated register names");  Clear();  return false;}
+	POPU32(count, inBlob, ndx);
+	for (ULWord num(0);  num < count;  num++)
+	{	ULWord regNum(0), len(0);
+		if (!HasBytes(inBlob, ndx, 2 * sizeof(ULWord)))
+			{DPFAIL("Truncated register names");  Clear();  return false;}
+		POPU32(regNum, inBlob, ndx);
+		POPU32(len, inBlob, ndx);
+		if (!HasBytes(inBlob, ndx, len))
+			{DPFAIL("Truncated register names");  Clear();  return false;}
+		mRegNames[regNum].assign(inBlob.begin() + ptrdiff_t(ndx), inBlob.begin() + ptrdiff_t(ndx + len));
+		ndx += len;
+	}
+
+	if (!HasBytes(inBlob, ndx, sizeof(ULWord)))
+		{DPFAIL("Truncated route ROM");  Clear();  return false;}
+	POPU32(count, inBlob, ndx);
+	if (!HasBytes(inBlob, ndx, size_t(count) * 2 * sizeof(ULWord)))
+		{DPFAIL("Truncated route ROM");  Clear();  return false;}
+	mRouteROM.reserve(count);
+	for (ULWord num(0);  num < count;  num++)
+	{	ULWord regNum(0), regValue(0);
+		POPU32(regNum, inBlob, ndx);
+		POPU32(regValue, inBlob, ndx);
+		mRouteROM.push_back(NTV2RegInfo(regNum, regValue));
+	}
+	return true;
+}
+
+bool NTV2DeviceProfile::WriteToFile (const string & inFilePath) const
+{
+	NTV2_RPC_BLOB_TYPE blob;
+	if (!Encode(blob))
+		{DPFAIL("Empty profile");  return false;}
+	ofstream ofs(inFilePath.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!ofs.good())
+		{DPFAIL("Unable to create '" << inFilePath << "'");  return false;}
+	ofs.write(reinterpret_cast<const char*>(&blob[0]), streamsize(blob.size()));
+	ofs.close();
+	if (ofs.fail())
+		{DPFAIL("Failed writing " << DEC(blob.size()) << " byte(s) to '" << inFilePath << "'");  return false;}
+	return true;
+}
+
+bool NTV2DeviceProfile::ReadFromFile (const string & inFilePath)
+{
+	Clear();
+	ifstream ifs(inFilePath.c_str(), ios::in | ios::binary);
+	if (!ifs.good())
+		return false;
+	ifs.seekg(0, ios::end);
+	const streamoff fileBytes (ifs.tellg());
+	ifs.seekg(0, ios::beg);
+	if (fileBytes <= 0  ||  fileBytes > streamoff(kProfileMaxBytes))
+		{DPFAIL("'" << inFilePath << "' size " << DEC(fileBytes) << " out of range");  return false;}
+	NTV2_RPC_BLOB_TYPE blob (static_cast<size_t>(fileBytes), 0);
+	ifs.read(reinterpret_cast<char*>(&blob[0]), streamsize(blob.size()));
+	if (ifs.gcount() != streamsize(blob.size()))
+		{DPFAIL("Failed reading '" << inFilePath << "'");  return false;}
+	return Decode(blob);
+}
+
+bool NTV2DeviceProfile::SaveToCache (void) const
+{
+	if (!mFirmwareVersion)
+		return false;	//	Can't tell firmware builds apart
+	const string path (GetCacheFilePath(mDeviceID, mFirmwareVersion));
+	if (path.empty())
+		return false;	//	Caching disabled
+	NTV2_RPC_BLOB_TYPE blob;
+	if (!Encode(blob))
+		{DPFAIL("Empty profile");  return false;}
+	//	Write to a temp file, then rename it, so that no other process ever reads a partial file.
+	//	The temp file must not already exist, so nobody else can pre-create (or link) it to see or alter what's written...
+	ostringstream tmpPath;
+	int fd(-1);
+	for (unsigned attempt(0);  fd < 0  &&  attempt < 16;  attempt++)
+	{
+		tmpPath.str(string());
+		tmpPath << path << "." << AJAProcess::GetPid() << "." << attempt;
+		fd = DPOPENEXCL(tmpPath.str().c_str());
+	}
+	if (fd < 0)
+		{DPWARN("Unable to create temp file for '" << path << "'");  return false;}
+	size_t bytesWritten(0);
+	while (bytesWritten < blob.size())
+	{
+		const int result (int(DPWRITE(fd, &blob[bytesWritten], unsigned(blob.size() - bytesWritten))));
+		if (result <= 0)
+			break;
+		bytesWritten += size_t(result);
+	}
+	const bool closeOK (DPCLOSE(fd) == 0);
+	if (bytesWritten < blob.size()  ||  !closeOK)
+		{::remove(tmpPath.str().c_str());  DPFAIL("Failed writing " << DEC(blob.size()) << " byte(s) to '" << tmpPath.str() << "'");  return false;}
+	::remove(path.c_str());	//	Windows won't rename over an existing file
+	if (::rename(tmpPath.str().c_str(), path.c_str()) != 0)
+		{::remove(tmpPath.str().c_str());  DPWARN("Unable to rename '" << tmpPath.str() << "' to '" << path << "'");  return false;}
+	DPDBG("Cached " << ::NTV2DeviceIDToString(mDeviceID) << " profile in '" << path << "'");
+	return true;
+}
+
+bool NTV2DeviceProfile::LoadFromCache (const NTV2DeviceID inDeviceID, const ULWord64 inFirmwareVersion)
+{
+	Clear();
+	if (!inFirmwareVersion)
+		return false;
+	const string path (GetCacheFilePath(inDeviceID, inFirmwareVersion));
+	if (path.empty()  ||  !ReadFromFile(path))
+		return false;
+	if (mDeviceID != inDeviceID  ||  mFirmwareVersion != inFirmwareVersion)
+		{DPWARN("'" << path << "' describes a different device or firmware");  Clear();  return false;}
+	return true;
+}
+
+string NTV2DeviceProfile::GetCacheFilePath (const NTV2DeviceID inDeviceID, const ULWord64 inFirmwareVersion)
+{
+	const string folder (GetCacheFolder());
+	if (folder.empty())
+		return string();
+	ostringstream oss;
+	oss << folder;
+	if (folder.at(folder.length()-1) != kPathSeparator)
+		oss << kPathSeparator;
+	oss << kProfileFilePrefix << HEX0N(ULWord(inDeviceID),8) << "-" << HEX0N(inFirmwareVersion,16) << kProfileFileSuffix;
+	return oss.str();
+}
+
+void NTV2DeviceProfile::SetCacheFolder (const string & inFolderPath)
+{
+	AJAAutoLock locker(&gCacheLock);
+	gCacheFolder = inFolderPath;
+}
+
+string NTV2DeviceProfile::GetCacheFolder (void)
+{
+	AJAAutoLock locker(&gCacheLock);
+	return gCacheFolder;
+}
+
+bool NTV2DeviceProfile::GetBoolParam (const ULWord inParamID, ULWord & outValue) const
+{
+	NTV2RegValueMapConstIter it (mBools.find(inParamID));
+	if (it == mBools.end())
+		return false;
+	outValue = it->second;
+	return true;
+}
+
+bool NTV2DeviceProfile::GetNumericParam (const ULWord inParamID, ULWord & outValue) const
+{
+	NTV2RegValueMapConstIter it (mNums.find(inParamID));
+	if (it == mNums.end())
+		return false;
+	outValue = it->second;
+	return true;
+}
+
+bool NTV2DeviceProfile::GetSupportedItems (const NTV2EnumsID inEnumsID, ULWordSet & outItems) const
+{
+	NTV2SupportedItemsMapConstIter it (mEnums.find(ULWord(inEnumsID)));
+	if (it == mEnums.end())
+		return false;
+	outItems = it->second;
+	return true;
+}
+
+bool NTV2DeviceProfile::IsSupported (const NTV2BoolParamID inParamID) const
+{
+	ULWord value(0);
+	GetBoolParam(ULWord(inParamID), value);
+	return value ? true : false;
+}
+
+ULWord NTV2DeviceProfile::GetNumSupported (const NTV2NumericParamID inParamID) const
+{
+	ULWord value(0);
+	GetNumericParam(ULWord(inParamID), value);
+	return value;
+}
+
+ULWordSet NTV2DeviceProfile::GetSupportedItems (const NTV2EnumsID inEnumsID) const
+{
+	ULWordSet result;
+	GetSupportedItems(inEnumsID, result);
+	return result;
+}
+
+string NTV2DeviceProfile::GetRegisterName (const ULWord inRegNum) const
+{
+	NTV2RegisterNameMapConstIter it (mRegNames.find(inRegNum));
+	return it != mRegNames.end() ? it->second : string();
+}
+
+bool NTV2DeviceProfile::GetPossibleConnections (NTV2PossibleConnections & outConnections) const
+{
+	outConnections.clear();
+	return !mRouteROM.empty()  &&  CNTV2SignalRouter::GetPossibleConnections(mRouteROM, outConnections);
+}
+
+bool NTV2DeviceProfile::operator == (const NTV2DeviceProfile & inRHS) const
+{
+	return mDeviceID == inRHS.mDeviceID  &&  mFirmwareVersion == inRHS.mFirmwareVersion
+		&&  mBools == inRHS.mBools  &&  mNums == inRHS.mNums  &&  mEnums == inRHS.mEnums
+		&&  mRegNames == inRHS.mRegNames  &&  mRouteROM == inRHS.mRouteROM;
+}
+
+ostream & NTV2DeviceProfile::Print (ostream & oss) const
+{
+	if (IsEmpty())
+		return oss << "(empty)";
+	oss << ::NTV2DeviceIDToString(mDeviceID) << " firmware=" << xHEX0N(mFirmwareVersion,16)
+		<< " bools=" << DEC(mBools.size()) << " nums=" << DEC(mNums.size()) << " enums=" << DEC(mEnums.size())
+		<< " regNames=" << DEC(mRegNames.size()) << " routeROM=" << DEC(mRouteROM.size());
+	return oss;
+}
@@ -8,8 +8,10 @@
 #include "ntv2devicescanner.h"
 #include "ntv2devicefeatures.h"
 #include "ntv2utils.h"
+#include "ntv2deviceprofile.h"
 #include "ajabase/common/common.h"
 #include "ajabase/system/lock.h"
+#include "ajabase/system/thread.h"
 #include <sstream>
 
 using namespace std;
@@ -95,6 +97,9 @@ bool CNTV2DeviceScanner::IsLegalSerialNumber (const string & inStr)
 
 static NTV2DeviceInfoList	sDevInfoList;
 static AJALock				sDevInfoListLock;
+static bool					sParallelScan(false);	//	Probe devices in parallel & reuse discoveries?
+static bool					sHotplugRefresh(false);	//	Only rescan upon hotplug?
+static bool					sScanned(false);		//	Has the host been scanned yet?
 
 size_t CNTV2DeviceScanner::GetNumDevices (void)
 {
@@ -102,11 +107,25 @@ size_t CNTV2DeviceScanner::GetNumDevices (void)
 	return sDevInfoList.size();
 }
 
+void CNTV2DeviceScanner::SetParallelScan (const bool inParallel)
+{
+	sParallelScan = inParallel;
+	if (inParallel)
+		CNTV2DriverInterface::SetDiscoveryCache(true);
+}
+
+bool CNTV2DeviceScanner::IsParallelScan (void)				{return sParallelScan;}
+void CNTV2DeviceScanner::SetHotplugRefresh (const bool inEnable)	{sHotplugRefresh = inEnable;}
+bool CNTV2DeviceScanner::GetHotplugRefresh (void)			{return sHotplugRefresh;}
+
+static inline bool NeedsRescan (void)	{return !sHotplugRefresh  ||  !sScanned;}
+
 #if defined(NTV2_DEPRECATE_17_1)
 	void ScanHardware (void)
 	{
 		AJAAutoLock tmpLock(&sDevInfoListLock);
 		sDevInfoList.clear();
+		sScanned = true;
 		UWord ndx(0);
 		do
 		{
@@ -144,77 +163,72 @@ NTV2DeviceInfoList	GetDeviceInfoList (void)
 }
 
 
+//	Device info discovered by ProbeDevice, keyed by index number, serial number & firmware version...
+typedef std::pair<uint64_t, ULWord64>				NTV2ScanSerialFirmware;
+typedef std::pair<UWord, NTV2ScanSerialFirmware>	NTV2ScanKey;
+typedef std::map<NTV2ScanKey, NTV2DeviceInfo>		NTV2ScanCache;
+static NTV2ScanCache	sScanCache;
+static AJALock			sScanCacheLock;
+
+//	Parallel probing state for one device index...
+typedef struct NTV2ScanProbe
+{
+	UWord			index;
+	bool			present;
+	NTV2DeviceInfo	info;
+	AJAThread		thread;
+} NTV2ScanProbe;
+
+static const UWord	kMaxParallelProbes(8);	//	Max devices probed at once
+
+
 void CNTV2DeviceScanner::ScanHardware (void)
 {
 	AJAAutoLock tmpLock(&sDevInfoListLock);
 	sDevInfoList.clear();
+	sScanned = true;
 
-	for (UWord boardNum(0);   ;   boardNum++)
+	if (!sParallelScan)
 	{
-		CNTV2Card tmpDev(boardNum);
-		if (!tmpDev.IsOpen())
-			break;
-		const NTV2DeviceID	deviceID (tmpDev.GetDeviceID());
-
-		if (deviceID != DEVICE_ID_NOTFOUND)
+		for (UWord boardNum(0);   ;   boardNum++)
 		{
-			ostringstream	oss;
-			NTV2DeviceInfo	info;
-			info.deviceIndex		= boardNum;
-			info.deviceID			= deviceID;
-			info.deviceSerialNumber	= tmpDev.GetSerialNumber();
-
-			oss << ::NTV2DeviceIDToString (deviceID, tmpDev.IsSupported(kDeviceHasMicrophoneInput)) << " - " << boardNum;
-
-			const ULWordSet wgtIDs (tmpDev.GetSupportedItems(kNTV2EnumsID_WidgetID));
-			info.deviceIdentifier		= oss.str();
-			info.numVidInputs			= tmpDev.GetNumSupported(kDeviceGetNumVideoInputs);
-			info.numVidOutputs			= tmpDev.GetNumSupported(kDeviceGetNumVideoOutputs);
-			info.numAnlgVidOutputs		= tmpDev.GetNumSupported(kDeviceGetNumAnalogVideoOutputs);
-			info.numAnlgVidInputs		= tmpDev.GetNumSupported(kDeviceGetNumAnalogVideoInputs);
-			info.numHDMIVidOutputs		= tmpDev.GetNumSupported(kDeviceGetNumHDMIVideoOutputs);
-			info.numHDMIVidInputs		= tmpDev.GetNumSupported(kDeviceGetNumHDMIVideoInputs);
-			info.numInputConverters		= tmpDev.GetNumSupported(kDeviceGetNumInputConverters);
-			info.numOutputConverters	= tmpDev.GetNumSupported(kDeviceGetNumOutputConverters);
-			info.numUpConverters		= tmpDev.GetNumSupported(kDeviceGetNumUpConverters);
-			info.numDownConverters		= tmpDev.GetNumSupported(kDeviceGetNumDownConverters);
-			info.downConverterDelay		= tmpDev.GetNumSupported(kDeviceGetDownConverterDelay);
-			info.dvcproHDSupport		= tmpDev.IsSupported(kDeviceCanDoDVCProHD);
-			info.qrezSupport			= tmpDev.IsSupported(kDeviceCanDoQREZ);
-			info.hdvSupport				= tmpDev.IsSupported(kDeviceCanDoHDV);
-			info.quarterExpandSupport	= tmpDev.IsSupported(kDeviceCanDoQuarterExpand);
-			info.colorCorrectionSupport	= tmpDev.IsSupported(kDeviceCanDoColorCorrection);
-			info.programmableCSCSupport	= tmpDev.IsSupported(kDeviceCanDoProgrammableCSC);
-			info.rgbAlphaOutputSupport	= tmpDev.IsSupported(kDeviceCanDoRGBPlusAlphaOut);
-			info.breakoutBoxSupport		= tmpDev.IsSupported(kDeviceCanDoBreakoutBox);
-			info.vidProcSupport			= tmpDev.IsSupported(kDeviceCanDoVideoProcessing);
-			info.dualLinkSupport		= tmpDev.IsSupported(kDeviceCanDoDualLink);
-			info.numDMAEngines			= UWord(tmpDev.GetNumSupported(kDeviceGetNumDMAEngines));
-			info.pingLED				= tmpDev.GetNumSupported(kDeviceGetPingLED);
-			info.has2KSupport			= tmpDev.IsSupported(kDeviceCanDo2KVideo);
-			info.has4KSupport			= tmpDev.IsSupported(kDeviceCanDo4KVideo);
-			info.has8KSupport			= tmpDev.IsSupported(kDeviceCanDo8KVideo);
-			info.has3GLevelConversion   = tmpDev.IsSupported(kDeviceCanDo3GLevelConversion);
-			info.isoConvertSupport		= tmpDev.IsSupported(kDeviceCanDoIsoConvert);
-			info.rateConvertSupport		= tmpDev.IsSupported(kDeviceCanDoRateConvert);
-			info.proResSupport			= tmpDev.IsSupported(kDeviceCanDoProRes);
-			info.sdi3GSupport			= wgtIDs.find(NTV2_Wgt3GSDIOut1) != wgtIDs.end();
-			info.sdi12GSupport			= tmpDev.IsSupported(kDeviceCanDo12GSDI);
-			info.ipSupport				= tmpDev.IsSupported(kDeviceCanDoIP);
-			info.biDirectionalSDI		= tmpDev.IsSupported(kDeviceHasBiDirectionalSDI);
-			info.ltcInSupport			= tmpDev.GetNumSupported(kDeviceGetNumLTCInputs) > 0;
-			info.ltcOutSupport			= tmpDev.GetNumSupported(kDeviceGetNumLTCOutputs) > 0;
-			info.ltcInOnRefPort			= tmpDev.IsSupported(kDeviceCanDoLTCInOnRefPort);
-			info.stereoOutSupport		= tmpDev.IsSupported(kDeviceCanDoStereoOut);
-			info.stereoInSupport		= tmpDev.IsSupported(kDeviceCanDoStereoIn);
-			info.multiFormat			= tmpDev.IsSupported(kDeviceCanDoMultiFormat);
-			info.numSerialPorts			= tmpDev.GetNumSupported(kDeviceGetNumSerialPorts);
-			info.procAmpSupport			= false;
-			SetAudioAttributes(info, tmpDev);
-			sDevInfoList.push_back(info);
+			NTV2DeviceInfo info;
+			if (!ProbeDevice(boardNum, info))
+				break;
+			if (info.deviceID != DEVICE_ID_NOTFOUND)
+				sDevInfoList.push_back(info);
+		}	//	boardNum loop
+	}
+	else
+	{	//	Probe devices a wave at a time, stopping at the first index that won't open (like the serial scan)...
+		const UWord maxDevices (UWord(CNTV2DriverInterface::MaxNumDevices()));
+		bool done(false);
+		for (UWord firstNum(0);  !done  &&  firstNum < maxDevices;  firstNum += kMaxParallelProbes)
+		{
+			const UWord numProbes (std::min(kMaxParallelProbes, UWord(maxDevices - firstNum)));
+			std::vector<NTV2ScanProbe*> probes;
+			for (UWord ndx(0);  ndx < numProbes;  ndx++)
+			{
+				NTV2ScanProbe * pProbe (new NTV2ScanProbe);
+				pProbe->index = UWord(firstNum + ndx);
+				pProbe->present = false;
+				probes.push_back(pProbe);
+				pProbe->thread.Attach(ProbeThread, pProbe);
+				if (AJA_FAILURE(pProbe->thread.Start()))
+					ProbeThread(AJA_NULL, pProbe);	//	Couldn't start thread -- probe it here
+			}
+			for (size_t ndx(0);  ndx < probes.size();  ndx++)
+			{
+				NTV2ScanProbe * pProbe (probes.at(ndx));
+				pProbe->thread.Stop();	//	Wait for it to finish
+				if (!pProbe->present)
+					done = true;
+				else if (!done  &&  pProbe->info.deviceID != DEVICE_ID_NOTFOUND)
+					sDevInfoList.push_back(pProbe->info);
+				delete pProbe;
+			}
 		}
-		tmpDev.Close();
-	}	//	boardNum loop
+	}
 
 #if defined(VIRTUAL_DEVICES_SUPPORT)
 	NTV2SerialToVirtualDevices vdMap;
@@ -241,6 +255,111 @@ void CNTV2DeviceScanner::ScanHardware (void)
 #endif	//	defined(VIRTUAL_DEVICES_SUPPORT)
 }	//	ScanHardware
 
+
+void CNTV2DeviceScanner::ProbeThread (AJAThread * pThread, void * pContext)
+{
+	(void)pThread;
+	NTV2ScanProbe * pProbe (reinterpret_cast<NTV2ScanProbe*>(pContext));
+	if (pProbe)
+		pProbe->present = ProbeDevice(pProbe->index, pProbe->info);
+}
+
+
+bool CNTV2DeviceScanner::ProbeDevice (const UWord boardNum, NTV2DeviceInfo & info)
+{
+	info = NTV2DeviceInfo();
+	info.deviceID = DEVICE_ID_NOTFOUND;
+	CNTV2Card tmpDev(boardNum);
+	if (!tmpDev.IsOpen())
+		return false;
+	const NTV2DeviceID	deviceID (tmpDev.GetDeviceID());
+	if (deviceID == DEVICE_ID_NOTFOUND)
+		return true;	//	Present, but unknown
+
+	//	Reuse what was discovered last time, if the serial number & firmware haven't changed...
+	NTV2ScanKey key (boardNum, NTV2ScanSerialFirmware(0, 0));
+	if (sParallelScan)
+	{
+		NTV2RegReads regs;	//	Serial number & firmware version in one go
+		regs.push_back(NTV2RegInfo(kRegReserved54));
+		regs.push_back(NTV2RegInfo(kRegReserved55));
+		regs.push_back(NTV2RegInfo(kRegBitfileDate));
+		regs.push_back(NTV2RegInfo(kRegBitfileTime));
+		regs.push_back(NTV2RegInfo(kRegDMAControl));
+		if (tmpDev.ReadRegisters(regs))
+		{
+			key.second.first = (uint64_t(regs.at(1).registerValue) << 32) | uint64_t(regs.at(0).registerValue);
+			key.second.second = NTV2DeviceProfile::MakeFirmwareVersion(regs.at(2).registerValue, regs.at(3).registerValue, regs.at(4).registerValue);
+		}
+		if (key.second.first  &&  key.second.second)
+		{
+			AJAAutoLock tmpLock(&sScanCacheLock);
+			NTV2ScanCache::const_iterator it (sScanCache.find(key));
+			if (it != sScanCache.end()  &&  it->second.deviceID == deviceID)
+				{info = it->second;  return true;}
+		}
+	}
+
+	ostringstream	oss;
+	info.deviceIndex		= boardNum;
+	info.deviceID			= deviceID;
+	info.deviceSerialNumber	= key.second.first ? key.second.first : tmpDev.GetSerialNumber();
+
+	oss << ::NTV2DeviceIDToString (deviceID, tmpDev.IsSupported(kDeviceHasMicrophoneInput)) << " - " << boardNum;
+
+	const ULWordSet wgtIDs (tmpDev.GetSupportedItems(kNTV2EnumsID_WidgetID));
+	info.deviceIdentifier		= oss.str();
+	info.numVidInputs			= tmpDev.GetNumSupported(kDeviceGetNumVideoInputs);
+	info.numVidOutputs			= tmpDev.GetNumSupported(kDeviceGetNumVideoOutputs);
+	info.numAnlgVidOutputs		= tmpDev.GetNumSupported(kDeviceGetNumAnalogVideoOutputs);
+	info.numAnlgVidInputs		= tmpDev.GetNumSupported(kDeviceGetNumAnalogVideoInputs);
+	info.numHDMIVidOutputs		= tmpDev.GetNumSupported(kDeviceGetNumHDMIVideoOutputs);
+	info.numHDMIVidInputs		= tmpDev.GetNumSupported(kDeviceGetNumHDMIVideoInputs);
+	info.numInputConverters		= tmpDev.GetNumSupported(kDeviceGetNumInputConverters);
+	info.numOutputConverters	= tmpDev.GetNumSupported(kDeviceGetNumOutputConverters);
+	info.numUpConverters		= tmpDev.GetNumSupported(kDeviceGetNumUpConverters);
+	info.numDownConverters		= tmpDev.GetNumSupported(kDeviceGetNumDownConverters);
+	info.downConverterDelay		= tmpDev.GetNumSupported(kDeviceGetDownConverterDelay);
+	info.dvcproHDSupport		= tmpDev.IsSupported(kDeviceCanDoDVCProHD);
+	info.qrezSupport			= tmpDev.IsSupported(kDeviceCanDoQREZ);
+	info.hdvSupport				= tmpDev.IsSupported(kDeviceCanDoHDV);
+	info.quarterExpandSupport	= tmpDev.IsSupported(kDeviceCanDoQuarterExpand);
+	info.colorCorrectionSupport	= tmpDev.IsSupported(kDeviceCanDoColorCorrection);
+	info.programmableCSCSupport	= tmpDev.IsSupported(kDeviceCanDoProgrammableCSC);
+	info.rgbAlphaOutputSupport	= tmpDev.IsSupported(kDeviceCanDoRGBPlusAlphaOut);
+	info.breakoutBoxSupport		= tmpDev.IsSupported(kDeviceCanDoBreakoutBox);
+	info.vidProcSupport			= tmpDev.IsSupported(kDeviceCanDoVideoProcessing);
+	info.dualLinkSupport		= tmpDev.IsSupported(kDeviceCanDoDualLink);
+	info.numDMAEngines			= UWord(tmpDev.GetNumSupported(kDeviceGetNumDMAEngines));
+	info.pingLED				= tmpDev.GetNumSupported(kDeviceGetPingLED);
+	info.has2KSupport			= tmpDev.IsSupported(kDeviceCanDo2KVideo);
+	info.has4KSupport			= tmpDev.IsSupported(kDeviceCanDo4KVideo);
+	info.has8KSupport			= tmpDev.IsSupported(kDeviceCanDo8KVideo);
+	info.has3GLevelConversion   = tmpDev.IsSupported(kDeviceCanDo3GLevelConversion);
+	info.isoConvertSupport		= tmpDev.IsSupported(kDeviceCanDoIsoConvert);
+	info.rateConvertSupport		= tmpDev.IsSupported(kDeviceCanDoRateConvert);
+	info.proResSupport			= tmpDev.IsSupported(kDeviceCanDoProRes);
+	info.sdi3GSupport			= wgtIDs.find(NTV2_Wgt3GSDIOut1) != wgtIDs.end();
+	info.sdi12GSupport			= tmpDev.IsSupported(kDeviceCanDo12GSDI);
+	info.ipSupport				= tmpDev.IsSupported(kDeviceCanDoIP);
+	info.biDirectionalSDI		= tmpDev.IsSupported(kDeviceHasBiDirectionalSDI);
+	info.ltcInSupport			= tmpDev.GetNumSupported(kDeviceGetNumLTCInputs) > 0;
+	info.ltcOutSupport			= tmpDev.GetNumSupported(kDeviceGetNumLTCOutputs) > 0;
+	info.ltcInOnRefPort			= tmpDev.IsSupported(kDeviceCanDoLTCInOnRefPort);
+	info.stereoOutSupport		= tmpDev.IsSupported(kDeviceCanDoStereoOut);
+	info.stereoInSupport		= tmpDev.IsSupported(kDeviceCanDoStereoIn);
+	info.multiFormat			= tmpDev.IsSupported(kDeviceCanDoMultiFormat);
+	info.numSerialPorts			= tmpDev.GetNumSupported(kDeviceGetNumSerialPorts);
+	info.procAmpSupport			= false;
+	SetAudioAttributes(info, tmpDev);
+	if (key.second.first  &&  key.second.second)
+	{
+		AJAAutoLock tmpLock(&sScanCacheLock);
+		sScanCache[key] = info;
+	}
+	return true;
+}	//	ProbeDevice
+
 bool CNTV2DeviceScanner::DeviceIDPresent (const NTV2DeviceID inDeviceID, const bool inRescan)
 {
 	AJAAutoLock tmpLock(&sDevInfoListLock);
@@ -271,11 +390,22 @@ bool CNTV2DeviceScanner::GetDeviceInfo (const ULWord inDeviceIndexNumber, NTV2De
 }	//	GetDeviceInfo
 #endif	//	!defined(NTV2_DEPRECATE_17_1)
 
+void CNTV2DeviceScanner::HotplugCallback (AJAPnpMessage inMessage, void * inRefCon)
+{
+	(void)inRefCon;
+	if (inMessage == AJA_Pnp_DeviceGoingToSleep)
+		return;	//	Nothing changed yet
+	AJAAutoLock tmpLock(&sDevInfoListLock);
+	ScanHardware();
+}
+
+
 bool CNTV2DeviceScanner::GetDeviceAtIndex (const ULWord inDeviceIndexNumber, CNTV2Card & outDevice)
 {
 	outDevice.Close();
 	AJAAutoLock tmpLock(&sDevInfoListLock);
-	ScanHardware();
+	if (NeedsRescan())
+		ScanHardware();
 	return size_t(inDeviceIndexNumber) < sDevInfoList.size()
 				? outDevice.Open(UWord(inDeviceIndexNumber))
 				: false;
@@ -287,7 +417,8 @@ bool CNTV2DeviceScanner::GetFirstDeviceWithID (const NTV2DeviceID inDeviceID, CN
 {
 	outDevice.Close();
 	AJAAutoLock tmpLock(&sDevInfoListLock);
-	ScanHardware();
+	if (NeedsRescan())
+		ScanHardware();
 	for (size_t ndx(0);  ndx < sDevInfoList.size();  ndx++)
 		if (sDevInfoList.at(ndx).deviceID == inDeviceID)
 			return outDevice.Open(UWord(ndx));	//	Found!
@@ -307,7 +438,8 @@ bool CNTV2DeviceScanner::GetFirstDeviceWithName (const string & inNameSubString,
 	}
 
 	AJAAutoLock tmpLock(&sDevInfoListLock);
-	ScanHardware();
+	if (NeedsRescan())
+		ScanHardware();
 	string	nameSubString(inNameSubString);  aja::lower(nameSubString);
 	for (size_t ndx(0);  ndx < sDevInfoList.size();  ndx++)
 	{
@@ -334,7 +466,8 @@ bool CNTV2DeviceScanner::GetFirstDeviceWithSerial (const string & inSerialStr, C
 {
 	outDevice.Close();
 	AJAAutoLock tmpLock(&sDevInfoListLock);
-	ScanHardware();
+	if (NeedsRescan())
+		ScanHardware();
 	string searchSerialStr(inSerialStr);  aja::lower(searchSerialStr);
 	for (size_t ndx(0);  ndx < sDevInfoList.size();  ndx++)
 	{
@@ -355,7 +488,8 @@ bool CNTV2DeviceScanner::GetDeviceWithSerial (const uint64_t inSerialNumber, CNT
 {
 	outDevice.Close();
 	AJAAutoLock tmpLock(&sDevInfoListLock);
-	ScanHardware();
+	if (NeedsRescan())
+		ScanHardware();
 	for (size_t ndx(0);  ndx < sDevInfoList.size();  ndx++)
 		if (sDevInfoList.at(ndx).deviceSerialNumber == inSerialNumber)
 			return outDevice.Open(UWord(ndx));
@@ -371,7 +505,8 @@ bool CNTV2DeviceScanner::GetFirstDeviceFromArgument (const string & inArgument,
 
 	//	Special case:  'LIST' or '?'  ---  print an enumeration of available devices to stdout, then bail
 	AJAAutoLock tmpLock(&sDevInfoListLock);
-	ScanHardware();
+	if (NeedsRescan())
+		ScanHardware();
 	string upperArg(inArgument);  aja::upper(upperArg);
 	if (upperArg == "LIST" || upperArg == "?")
 	{
@@ -0,0 +1,173 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2devicesnapshot.cpp
+	@brief		Implements the CNTV2DeviceSnapshot class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2devicesnapshot.h"
+#include "ntv2registerexpert.h"
+#include "ntv2utils.h"
+#include "ajabase/system/debug.h"
+#include "ajabase/system/systemtime.h"
+
+using namespace std;
+
+#define INSTP(_p_)			HEX0N(uint64_t(_p_),16)
+#define DSFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_DriverInterface, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define DSWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_DriverInterface, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define DSDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_DriverInterface, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+
+
+CNTV2DeviceSnapshot::CNTV2DeviceSnapshot ()
+	:	mpDevice		(AJA_NULL),
+		mRegNums		(),
+		mRegValues		(),
+		mCaptureTime	(0),
+		mCaptureDuration(0)
+{
+}
+
+CNTV2DeviceSnapshot::~CNTV2DeviceSnapshot ()
+{
+	Close();	//	Before ~CNTV2Card tries to close a device I never opened
+}
+
+//	Registers that change device state when read
+static const ULWord	sReadSideEffectRegs[] = {kRegXenaxFlashDOUT,					//	Disturbs firmware erase/program/verify
+											kRegRS422Receive,	kRegRS4222Receive};	//	Pops a byte from the UART's receive FIFO
+
+NTV2RegNumSet CNTV2DeviceSnapshot::DefaultRegisters (const NTV2DeviceID inDeviceID)
+{
+	NTV2RegNumSet result (CNTV2RegisterExpert::GetRegistersForDevice(inDeviceID, kIncludeOtherRegs_VRegs));
+	for (size_t ndx(0);  ndx < sizeof(sReadSideEffectRegs) / sizeof(ULWord);  ndx++)
+		result.erase(sReadSideEffectRegs[ndx]);
+	result.insert(kRegBoardID);
+	return result;
+}
+
+bool CNTV2DeviceSnapshot::HasReadSideEffects (const ULWord inRegNum)
+{
+	for (size_t ndx(0);  ndx < sizeof(sReadSideEffectRegs) / sizeof(ULWord);  ndx++)
+		if (sReadSideEffectRegs[ndx] == inRegNum)
+			return true;
+	return false;
+}
+
+bool CNTV2DeviceSnapshot::Capture (CNTV2Card & inDevice, const NTV2RegNumSet & inRegNums)
+{
+	if (&inDevice == this)
+		{DSFAIL("Can't capture from myself");  return false;}
+	if (!inDevice.IsOpen())
+		{DSFAIL("Device not open");  return false;}
+
+	NTV2RegNumSet regNums (inRegNums.empty() ? DefaultRegisters(inDevice.GetDeviceID()) : inRegNums);
+	regNums.insert(kRegBoardID);	//	So GetDeviceID works
+	NTV2RegisterReads regReads;
+	regReads.reserve(regNums.size());
+	for (NTV2RegNumSetConstIter it(regNums.begin());  it != regNums.end();  ++it)
+		regReads.push_back(NTV2RegInfo(*it));
+
+	const uint64_t startTime (AJATime::GetSystemMicroseconds());
+	if (!inDevice.ReadRegisters(regReads))
+		{DSFAIL("ReadRegisters failed for " << DEC(regReads.size()) << " register(s) on '" << inDevice.GetDisplayName() << "'");  return false;}
+	const uint64_t endTime (AJATime::GetSystemMicroseconds());
+
+	NTV2RegisterValueMap regValues;
+	for (NTV2RegisterReadsConstIter it(regReads.begin());  it != regReads.end();  ++it)
+		regValues[it->registerNumber] = it->registerValue;
+	if (!SetRegisterValues(regValues))
+		return false;
+	_boardNumber		= inDevice.GetIndexNumber();
+	_ulNumFrameBuffers	= inDevice.GetNumFrameBuffers();
+	_ulFrameBufferSize	= inDevice.GetFrameBufferSize();
+	mpDevice			= &inDevice;
+	mRegNums			= regNums;
+	mCaptureTime		= startTime;
+	mCaptureDuration	= endTime - startTime;
+	DSDBG(DEC(mRegValues.size()) << " register(s) captured from '" << inDevice.GetDisplayName() << "' in " << DEC(mCaptureDuration) << "us");
+	return true;
+}
+
+bool CNTV2DeviceSnapshot::Refresh (void)
+{
+	if (!mpDevice)
+		{DSFAIL("Nothing captured yet");  return false;}
+	const NTV2RegNumSet regNums (mRegNums);	//	Capture replaces mRegNums
+	return Capture(*mpDevice, regNums);
+}
+
+bool CNTV2DeviceSnapshot::SetRegisterValues (const NTV2RegisterValueMap & inRegValues)
+{
+	NTV2RegValueMapConstIter it (inRegValues.find(kRegBoardID));
+	if (it == inRegValues.end())
+		{DSFAIL("Missing kRegBoardID");  return false;}
+	Close();
+	mRegValues = inRegValues;
+	_boardID = NTV2DeviceID(it->second);
+	_boardOpened = true;
+	return true;
+}
+
+bool CNTV2DeviceSnapshot::ReadRegister (const ULWord inRegNum, ULWord & outValue, const ULWord inMask, const ULWord inShift)
+{
+	if (inShift >= 32)
+		{DSFAIL("Shift " << DEC(inShift) << " > 31, reg=" << DEC(inRegNum) << " msk=" << xHEX0N(inMask,8));  return false;}
+	NTV2RegValueMapConstIter it (mRegValues.find(inRegNum));
+	if (it == mRegValues.end())
+		{DSDBG("Register " << DEC(inRegNum) << " not in snapshot");  return false;}
+	if (inRegNum >= VIRTUALREG_START  ||  !inMask)	//	Same as the driver:  virtual registers and zero masks ignore mask & shift
+		outValue = it->second;
+	else
+		outValue = (it->second & inMask) >> inShift;
+	return true;
+}
+
+bool CNTV2DeviceSnapshot::ReadRegisters (NTV2RegisterReads & inOutValues)
+{
+	if (!IsOpen())
+		return false;
+	bool result (true);
+	for (NTV2RegisterReadsIter it(inOutValues.begin());  it != inOutValues.end();  ++it)
+		if (!ReadRegister(it->registerNumber, it->registerValue))
+			result = false;
+	return result;
+}
+
+bool CNTV2DeviceSnapshot::WriteRegister (const ULWord inRegNum, const ULWord inValue, const ULWord inMask, const ULWord inShift)
+{
+	DSWARN("Read-only: reg=" << DEC(inRegNum) << " val=" << xHEX0N(inValue,8) << " msk=" << xHEX0N(inMask,8) << " shf=" << DEC(inShift));
+	return false;
+}
+
+bool CNTV2DeviceSnapshot::NTV2Message (NTV2_HEADER * pInMessage)
+{
+	(void) pInMessage;
+	return false;
+}
+
+bool CNTV2DeviceSnapshot::WaitForInterrupt (const INTERRUPT_ENUMS eInterrupt, const ULWord timeOutMs)
+{
+	(void) eInterrupt;	(void) timeOutMs;
+	return false;
+}
+
+bool CNTV2DeviceSnapshot::Open (const UWord inDeviceIndex)
+{
+	DSFAIL("Use Capture, not Open(" << DEC(inDeviceIndex) << ")");
+	return false;
+}
+
+bool CNTV2DeviceSnapshot::Open (const string & inURLSpec)
+{
+	DSFAIL("Use Capture, not Open('" << inURLSpec << "')");
+	return false;
+}
+
+bool CNTV2DeviceSnapshot::Close (void)
+{
+	mRegValues.clear();
+	_boardOpened = false;
+	_boardID = DEVICE_ID_NOTFOUND;
+	return true;
+}
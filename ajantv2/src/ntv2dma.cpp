@@ -7,6 +7,7 @@
 
 #include "ntv2card.h"
 #include "ntv2devicefeatures.h"
+#include "ntv2latencytimeline.h"
 #include "ntv2utils.h"
 #include "ajabase/system/debug.h"
 #include <assert.h>
@@ -28,19 +29,22 @@ using namespace std;
 
 bool CNTV2Card::DMARead (const ULWord inFrameNumber, ULWord * pFrameBuffer, const ULWord inOffsetBytes, const ULWord inByteCount)
 {
-	return DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, true, inFrameNumber, pFrameBuffer, inOffsetBytes, inByteCount, true);
+	NTV2LatencyScope latency (mLatencyTimeline, /*isRead*/true, inFrameNumber, inByteCount);
+	return latency.Done(DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, true, inFrameNumber, pFrameBuffer, inOffsetBytes, inByteCount, true));
 }
 
 
 bool CNTV2Card::DMAWrite (const ULWord inFrameNumber, const ULWord * pFrameBuffer, const ULWord inOffsetBytes, const ULWord inByteCount)
 {
-	return DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, false, inFrameNumber, const_cast<ULWord*>(pFrameBuffer), inOffsetBytes, inByteCount, true);
+	NTV2LatencyScope latency (mLatencyTimeline, /*isRead*/false, inFrameNumber, inByteCount);
+	return latency.Done(DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, false, inFrameNumber, const_cast<ULWord*>(pFrameBuffer), inOffsetBytes, inByteCount, true));
 }
 
 
 bool CNTV2Card::DMAReadFrame (const ULWord inFrameNumber, ULWord * pFrameBuffer, const ULWord inByteCount)
 {
-	return DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, true, inFrameNumber, pFrameBuffer, ULWord(0), inByteCount, true);
+	NTV2LatencyScope latency (mLatencyTimeline, /*isRead*/true, inFrameNumber, inByteCount);
+	return latency.Done(DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, true, inFrameNumber, pFrameBuffer, ULWord(0), inByteCount, true));
 }
 
 bool CNTV2Card::DMAReadFrame (const ULWord inFrameNumber, ULWord * pFrameBuffer, const ULWord inByteCount, const NTV2Channel inChannel)
@@ -58,13 +62,15 @@ bool CNTV2Card::DMAReadFrame (const ULWord inFrameNumber, ULWord * pFrameBuffer,
 		actualFrameSize *= 4;
 	if (quadQuadEnabled)
 		actualFrameSize *= 4;
-	return DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, true, 0, pFrameBuffer, inFrameNumber * actualFrameSize, inByteCount, true);
+	NTV2LatencyScope latency (mLatencyTimeline, /*isRead*/true, inFrameNumber, inByteCount);
+	return latency.Done(DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, true, 0, pFrameBuffer, inFrameNumber * actualFrameSize, inByteCount, true));
 }
 
 
 bool CNTV2Card::DMAWriteFrame (const ULWord inFrameNumber, const ULWord * pFrameBuffer, const ULWord inByteCount)
 {
-	return DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, false, inFrameNumber, const_cast <ULWord *> (pFrameBuffer), ULWord(0), inByteCount, true);
+	NTV2LatencyScope latency (mLatencyTimeline, /*isRead*/false, inFrameNumber, inByteCount);
+	return latency.Done(DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, false, inFrameNumber, const_cast <ULWord *> (pFrameBuffer), ULWord(0), inByteCount, true));
 }
 
 bool CNTV2Card::DMAWriteFrame (const ULWord inFrameNumber, const ULWord * pFrameBuffer, const ULWord inByteCount, const NTV2Channel inChannel)
@@ -82,8 +88,9 @@ bool CNTV2Card::DMAWriteFrame (const ULWord inFrameNumber, const ULWord * pFrame
 		actualFrameSize *= 4;
 	if (quadQuadEnabled)
 		actualFrameSize *= 4;
-	return DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, false, 0, const_cast<ULWord*>(pFrameBuffer),
-						inFrameNumber * actualFrameSize, inByteCount, true);
+	NTV2LatencyScope latency (mLatencyTimeline, /*isRead*/false, inFrameNumber, inByteCount);
+	return latency.Done(DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, false, 0, const_cast<ULWord*>(pFrameBuffer),
+									inFrameNumber * actualFrameSize, inByteCount, true));
 }
 
 
@@ -95,8 +102,9 @@ bool CNTV2Card::DMAReadSegments (	const ULWord		inFrameNumber,
 									const ULWord		inSegmentHostPitch,
 									const ULWord		inSegmentCardPitch)
 {
-	return DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, true, inFrameNumber, pFrameBuffer, inOffsetBytes, inTotalByteCount,
-						inNumSegments, inSegmentHostPitch, inSegmentCardPitch, true);
+	NTV2LatencyScope latency (mLatencyTimeline, /*isRead*/true, inFrameNumber, inTotalByteCount);
+	return latency.Done(DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, true, inFrameNumber, pFrameBuffer, inOffsetBytes, inTotalByteCount,
+									inNumSegments, inSegmentHostPitch, inSegmentCardPitch, true));
 }
 
 
@@ -108,8 +116,9 @@ bool CNTV2Card::DMAWriteSegments (	const ULWord		inFrameNumber,
 									const ULWord		inSegmentHostPitch,
 									const ULWord		inSegmentCardPitch)
 {
-	return DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, false, inFrameNumber, const_cast<ULWord*>(pFrameBuffer),
-						inOffsetBytes, inTotalByteCount, inNumSegments, inSegmentHostPitch, inSegmentCardPitch, true);
+	NTV2LatencyScope latency (mLatencyTimeline, /*isRead*/false, inFrameNumber, inTotalByteCount);
+	return latency.Done(DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, false, inFrameNumber, const_cast<ULWord*>(pFrameBuffer),
+									inOffsetBytes, inTotalByteCount, inNumSegments, inSegmentHostPitch, inSegmentCardPitch, true));
 }
 
 
@@ -147,7 +156,8 @@ bool CNTV2Card::DMAReadAudio (	const NTV2AudioSystem	inAudioSystem,
 	if (!GetAudioMemoryOffset (inOffsetBytes,  absoluteByteOffset,	inAudioSystem))
 		return false;
 
-	return DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, true, 0, pOutAudioBuffer, absoluteByteOffset, inByteCount, true);
+	NTV2LatencyScope latency (mLatencyTimeline, /*isRead*/true, 0, inByteCount);
+	return latency.Done(DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, true, 0, pOutAudioBuffer, absoluteByteOffset, inByteCount, true));
 }
 
 
@@ -165,7 +175,8 @@ bool CNTV2Card::DMAWriteAudio ( const NTV2AudioSystem	inAudioSystem,
 	if (!GetAudioMemoryOffset (inOffsetBytes,  absoluteByteOffset,	inAudioSystem))
 		return false;
 
-	return DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, false, 0, const_cast <ULWord *> (pInAudioBuffer), absoluteByteOffset, inByteCount, true);
+	NTV2LatencyScope latency (mLatencyTimeline, /*isRead*/false, 0, inByteCount);
+	return latency.Done(DmaTransfer (NTV2_DMA_FIRST_AVAILABLE, false, 0, const_cast <ULWord *> (pInAudioBuffer), absoluteByteOffset, inByteCount, true));
 }
 
 
@@ -17,10 +17,16 @@
 #include "ntv2utils.h"
 #include "ntv2version.h"
 #include "ntv2devicescanner.h"	//	for IsHexDigit, IsAlphaNumeric, etc.
+#include "ntv2registerexpert.h"	//	for shadow register cache classification
+#include "ntv2drivertrace.h"
+#include "ntv2deviceprofile.h"
+#include "ntv2signalrouter.h"
 #include "ajabase/system/debug.h"
 #include "ajabase/system/atomic.h"
 #include "ajabase/system/systemtime.h"
 #include "ajabase/system/process.h"
+#include "ajabase/system/lock.h"
+#include "ajabase/system/thread.h"
 #include "ajabase/common/common.h"	//	aja::join
 #include <string.h>
 #include <assert.h>
@@ -50,6 +56,8 @@ static uint32_t gCloseCount(0);		//	Number of Close calls made
 	#define DIDBGX(__x__)	
 #endif
 
+static AJALock	gLazyCreateLock;	//	Serializes the on-demand creation of each instance's mpRegCache & mpRegWriteTxn
+
 /////////////// CLASS METHODS
 
 NTV2StringList CNTV2DriverInterface::GetLegalSchemeNames (void)
@@ -66,6 +74,127 @@ static bool		gOverlappedMode(false);
 void CNTV2DriverInterface::SetOverlappedMode (const bool inOverlapMode) {gOverlappedMode = inOverlapMode;}
 bool CNTV2DriverInterface::GetOverlappedMode (void) {return gOverlappedMode;}
 
+//	Features discovered by RefreshDeviceCapabilities, keyed by serial number & firmware version...
+typedef std::pair<ULWord64, ULWord64>					NTV2DiscoveryKey;
+typedef std::map<NTV2DiscoveryKey, NTV2DeviceProfile>	NTV2DiscoveryCache;
+static bool					gDiscoveryCacheEnabled(false);
+static NTV2DiscoveryCache	gDiscoveryCache;
+static AJALock				gDiscoveryCacheLock;
+void CNTV2DriverInterface::SetDiscoveryCache (const bool inEnable)	{gDiscoveryCacheEnabled = inEnable;}
+bool CNTV2DriverInterface::GetDiscoveryCache (void)	{return gDiscoveryCacheEnabled;}
+void CNTV2DriverInterface::ClearDiscoveryCache (void)	{AJAAutoLock locker(&gDiscoveryCacheLock);  gDiscoveryCache.clear();}
+
+
+/////////////// DEVICE CAPABILITY CACHE
+
+/**
+	@brief	Private implementation of the device capability cache:  flat tables indexed by NTV2BoolParamID,
+			NTV2NumericParamID and NTV2EnumsID, each entry valid only once it's been successfully queried.
+**/
+class NTV2DevCapsCache
+{
+	public:
+		NTV2DevCapsCache ()
+			:	mBools		(size_t(kNTV2BoolParam_COUNT), 0),
+				mBoolsOK	(size_t(kNTV2BoolParam_COUNT), false),
+				mNums		(size_t(kNTV2NumericParam_COUNT), 0),
+				mNumsOK		(size_t(kNTV2NumericParam_COUNT), false),
+				mEnums		(size_t(kNTV2EnumsID_COUNT)),
+				mEnumsOK	(size_t(kNTV2EnumsID_COUNT), false)
+		{
+		}
+
+		void Clear (void)
+		{
+			AJAAutoLock locker(&mLock);
+			std::fill(mBoolsOK.begin(), mBoolsOK.end(), false);
+			std::fill(mNumsOK.begin(), mNumsOK.end(), false);
+			std::fill(mEnumsOK.begin(), mEnumsOK.end(), false);
+			for (size_t ndx(0);  ndx < mEnums.size();  ndx++)
+				mEnums[ndx].clear();
+		}
+
+		bool GetBool (const ULWord inParamID, ULWord & outValue) const
+		{
+			if (inParamID >= ULWord(kNTV2BoolParam_LAST))
+				return false;
+			const size_t ndx (inParamID - kNTV2BoolParam_FIRST);
+			AJAAutoLock locker(&mLock);
+			if (mBoolsOK[ndx])
+				outValue = mBools[ndx];
+			return mBoolsOK[ndx];
+		}
+		void SetBool (const ULWord inParamID, const ULWord inValue)
+		{
+			if (inParamID >= ULWord(kNTV2BoolParam_LAST)  ||  inParamID == ULWord(kDeviceHasBreakoutBoard))	//	Breakout boxes come and go
+				return;
+			const size_t ndx (inParamID - kNTV2BoolParam_FIRST);
+			AJAAutoLock locker(&mLock);
+			mBools[ndx] = inValue;  mBoolsOK[ndx] = true;
+		}
+
+		bool GetNum (const ULWord inParamID, ULWord & outValue) const
+		{
+			if (!NTV2_IS_VALID_NUMPARAMID(inParamID))
+				return false;
+			const size_t ndx (inParamID - kNTV2NumericParam_FIRST);
+			AJAAutoLock locker(&mLock);
+			if (mNumsOK[ndx])
+				outValue = mNums[ndx];
+			return mNumsOK[ndx];
+		}
+		void SetNum (const ULWord inParamID, const ULWord inValue)
+		{
+			if (!NTV2_IS_VALID_NUMPARAMID(inParamID))
+				return;
+			const size_t ndx (inParamID - kNTV2NumericParam_FIRST);
+			AJAAutoLock locker(&mLock);
+			mNums[ndx] = inValue;  mNumsOK[ndx] = true;
+		}
+
+		bool GetEnums (const NTV2EnumsID inEnumsID, ULWordSet & outItems) const
+		{
+			if (ULWord(inEnumsID) >= ULWord(kNTV2EnumsID_LAST))
+				return false;
+			const size_t ndx (inEnumsID - kNTV2EnumsID_FIRST);
+			AJAAutoLock locker(&mLock);
+			if (mEnumsOK[ndx])
+				outItems = mEnums[ndx];
+			return mEnumsOK[ndx];
+		}
+		void SetEnums (const NTV2EnumsID inEnumsID, const ULWordSet & inItems)
+		{
+			if (ULWord(inEnumsID) >= ULWord(kNTV2EnumsID_LAST))
+				return;
+			const size_t ndx (inEnumsID - kNTV2EnumsID_FIRST);
+			AJAAutoLock locker(&mLock);
+			mEnums[ndx] = inItems;  mEnumsOK[ndx] = true;
+		}
+
+		void CopyTo (NTV2DeviceProfile & outProfile) const	//	Copies all valid entries
+		{
+			AJAAutoLock locker(&mLock);
+			for (size_t ndx(0);  ndx < mBools.size();  ndx++)
+				if (mBoolsOK[ndx])
+					outProfile.SetBoolParam(ULWord(ndx + kNTV2BoolParam_FIRST), mBools[ndx]);
+			for (size_t ndx(0);  ndx < mNums.size();  ndx++)
+				if (mNumsOK[ndx])
+					outProfile.SetNumericParam(ULWord(ndx + kNTV2NumericParam_FIRST), mNums[ndx]);
+			for (size_t ndx(0);  ndx < mEnums.size();  ndx++)
+				if (mEnumsOK[ndx])
+					outProfile.SetSupportedItems(NTV2EnumsID(ndx + kNTV2EnumsID_FIRST), mEnums[ndx]);
+		}
+
+	private:
+		mutable AJALock			mLock;		///< @brief	Guards all of the following
+		ULWordSequence			mBools;		///< @brief	Boolean feature values, indexed by NTV2BoolParamID
+		std::vector<bool>		mBoolsOK;	///< @brief	Which boolean feature values are valid
+		ULWordSequence			mNums;		///< @brief	Numeric feature values, indexed by NTV2NumericParamID
+		std::vector<bool>		mNumsOK;	///< @brief	Which numeric feature values are valid
+		std::vector<ULWordSet>	mEnums;		///< @brief	Supported items, indexed by NTV2EnumsID
+		std::vector<bool>		mEnumsOK;	///< @brief	Which supported item sets are valid
+};	//	NTV2DevCapsCache
+
 
 /////////////// INSTANCE METHODS
 
@@ -81,6 +210,12 @@ CNTV2DriverInterface::CNTV2DriverInterface ()
 		_pRPCAPI						(AJA_NULL),
 		mInterruptEventHandles			(),
 		mEventCounts					(),
+		mpRegCache						(AJA_NULL),
+		mpRegWriteTxn					(AJA_NULL),
+		mpDevCaps						(AJA_NULL),
+		mpDriverTrace					(AJA_NULL),
+		mRetiredDriverTraces			(),
+		mDriverTraceLock				(),
 #if defined(NTV2_WRITEREG_PROFILING)
 		mRegWrites						(),
 		mRegWritesLock					(),
@@ -111,12 +246,29 @@ CNTV2DriverInterface::CNTV2DriverInterface ()
 }	//	constructor
 
 
+static void DeleteRegCache (NTV2RegCache * pCache);		//	Defined below, where NTV2RegCache is complete
+static void DeleteRegWriteTxn (NTV2RegWriteTxn * pTxn);	//	Defined below, where NTV2RegWriteTxn is complete
+
 CNTV2DriverInterface::~CNTV2DriverInterface ()
 {
 	AJAAtomic::Increment(&gDestructCount);
 	if (_pRPCAPI)
 		delete _pRPCAPI;
 	_pRPCAPI = AJA_NULL;
+	if (mpRegCache)
+		DeleteRegCache(mpRegCache);
+	mpRegCache = AJA_NULL;
+	if (mpRegWriteTxn)
+		DeleteRegWriteTxn(mpRegWriteTxn);
+	mpRegWriteTxn = AJA_NULL;
+	if (mpDevCaps)
+		delete mpDevCaps;
+	mpDevCaps = AJA_NULL;
+	if (mpDriverTrace)
+		delete mpDriverTrace;
+	mpDriverTrace = AJA_NULL;
+	while (!mRetiredDriverTraces.empty())
+		{delete mRetiredDriverTraces.back();  mRetiredDriverTraces.pop_back();}
 	DIDBGX(DEC(gConstructCount) << " constructed, " << DEC(gDestructCount) << " destroyed");
 }	//	destructor
 
@@ -204,6 +356,14 @@ bool CNTV2DriverInterface::Close (void)
 		for (INTERRUPT_ENUMS eInt(eVerticalInterrupt);  eInt < eNumInterruptTypes;  eInt = INTERRUPT_ENUMS(eInt+1))
 			ConfigureSubscription (false, eInt, mInterruptEventHandles[eInt]);
 
+		FlushRegisterCache(true);	//	Next device may differ
+		if (RegWriteTxnIsOpen())
+		{	NTV2RegisterWrites discards;
+			DIWARN("Discarding open register write transaction having " << DEC(RegWriteTxnNumPending()) << " pending write(s)");
+			RegWriteTxnEnd(false, discards);
+		}
+		if (mpDevCaps)
+			mpDevCaps->Clear();	//	Next device may differ
 		const bool closeOK(IsRemote() ? CloseRemote() : CloseLocalPhysical());
 		if (closeOK)
 			AJAAtomic::Increment(&gCloseCount);
@@ -418,17 +578,49 @@ bool CNTV2DriverInterface::ReadRegisters (NTV2RegisterReads & inOutValues)
 	if (inOutValues.empty())
 		return true;		//	Nothing to do!
 
-	NTV2GetRegisters getRegsParams (inOutValues);
-	if (NTV2Message(reinterpret_cast<NTV2_HEADER*>(&getRegsParams)))
+	//	Answer what I can from the shadow register cache, and only ask the device for the rest...
+	NTV2RegisterReads missedRegs;
+	vector<size_t> missedNdxs;
+	vector<bool> missedCacheable;
+	const bool useCache (mpRegCache  ||  mpRegWriteTxn);
+	if (useCache)
 	{
-		if (!getRegsParams.GetRegisterValues(inOutValues))
-			return false;
+		for (size_t ndx(0);  ndx < inOutValues.size();  ndx++)
+		{
+			bool cacheable(false);
+			if (!RegCacheRead(inOutValues[ndx].registerNumber, inOutValues[ndx].registerValue, 0xFFFFFFFF, 0, cacheable))
+				{missedRegs.push_back(inOutValues[ndx]);  missedNdxs.push_back(ndx);  missedCacheable.push_back(cacheable);}
+		}
+		if (missedRegs.empty())
+			return true;	//	All cache hits!
 	}
-	else	//	Non-atomic user-space workaround until GETREGS implemented in driver...
-		for (NTV2RegisterReadsIter iter(inOutValues.begin());  iter != inOutValues.end();  ++iter)
-			if (iter->registerNumber != kRegXenaxFlashDOUT) //	Prevent firmware erase/program/verify failures
-				if (!ReadRegister (iter->registerNumber, iter->registerValue))
-					return false;
+	NTV2RegisterReads & regReads (useCache ? missedRegs : inOutValues);
+
+	for (size_t firstNdx(0);  firstNdx < regReads.size();  firstNdx += NTV2_MAX_NUM_GETREGS)
+	{	//	Drivers reject bigger NTV2GetRegisters messages, so read them in chunks...
+		const size_t endNdx (regReads.size() - firstNdx > NTV2_MAX_NUM_GETREGS  ?  firstNdx + NTV2_MAX_NUM_GETREGS  :  regReads.size());
+		NTV2RegisterReads chunk (regReads.begin() + ptrdiff_t(firstNdx), regReads.begin() + ptrdiff_t(endNdx));
+		NTV2GetRegisters getRegsParams (chunk);
+		if (NTV2Message(reinterpret_cast<NTV2_HEADER*>(&getRegsParams)))
+		{
+			if (!getRegsParams.GetRegisterValues(chunk))
+				return false;
+		}
+		else	//	Non-atomic user-space workaround until GETREGS implemented in driver...
+			for (NTV2RegisterReadsIter iter(chunk.begin());  iter != chunk.end();  ++iter)
+				if (iter->registerNumber != kRegXenaxFlashDOUT) //	Prevent firmware erase/program/verify failures
+					if (!ReadRegister (iter->registerNumber, iter->registerValue))
+						return false;
+		std::copy(chunk.begin(), chunk.end(), regReads.begin() + ptrdiff_t(firstNdx));
+	}
+
+	if (useCache)	//	Fill the cache, and merge the device's answers into the caller's list
+		for (size_t ndx(0);  ndx < missedNdxs.size()  &&  ndx < regReads.size();  ndx++)
+		{
+			ULWord value (regReads[ndx].registerValue);
+			RegCacheFill(true, missedCacheable[ndx], regReads[ndx].registerNumber, value, 0xFFFFFFFF, 0);
+			inOutValues[missedNdxs[ndx]].registerValue = value;
+		}
 	return true;
 }
 
@@ -479,6 +671,475 @@ bool CNTV2DriverInterface::WriteRegister (const ULWord inRegNum, const ULWord in
 }
 
 
+/////////////// REGISTER WRITE TRANSACTIONS
+
+/**
+	@brief	Private implementation of a register write transaction. Writes to registers that only change when written
+			(::NTV2_REGCACHE_CONFIG) are coalesced:  each is normalized to an unshifted value and mask, and later writes to
+			the same register are merged into it. All other writes are kept, unmerged and in order, and no write is ever
+			merged across one of them (so configuration writes never move past a status or trigger register write).
+**/
+class NTV2RegWriteTxn
+{
+	public:
+		typedef map<ULWord, size_t>		NdxMap;
+		typedef NdxMap::const_iterator	NdxMapConstIter;
+		typedef map<ULWord, NTV2RegInfo>	PendingMap;
+		typedef PendingMap::const_iterator	PendingMapConstIter;
+
+		NTV2RegWriteTxn ()	:	mThreadID(0), mDepth(0)	{}
+
+		inline bool	IsMine (void) const	{return mDepth  &&  mThreadID == AJAThread::GetThreadId();}	//	Caller must hold mLock
+
+		bool GetPending (const ULWord inRegNum, ULWord & outValue, ULWord & outMask) const
+		{
+			AJAAutoLock locker(&mLock);
+			if (!IsMine())
+				return false;
+			PendingMapConstIter it(mPending.find(inRegNum));
+			if (it == mPending.end())
+				return false;
+			outValue = it->second.registerValue;
+			outMask = it->second.registerMask;
+			return true;
+		}
+
+		void Add (const ULWord inRegNum, const ULWord inValue, const ULWord inMask, const ULWord inShift)
+		{
+			if (!inMask  ||  CNTV2DriverInterface::DefaultRegisterCacheClass(inRegNum) != NTV2_REGCACHE_CONFIG)
+			{	//	Not mergeable -- keep it as-is, and don't merge any later write into one made before it
+				mWrites.push_back(NTV2RegInfo(inRegNum, inValue, inMask, inShift));
+				mMergeNdxs.clear();
+				mPending.erase(inRegNum);
+				return;
+			}
+			const bool isVirtual (inRegNum >= VIRTUALREG_START);	//	Virtual registers ignore mask & shift
+			const ULWord mask (isVirtual ? 0xFFFFFFFF : inMask);
+			const ULWord value (isVirtual ? inValue : ((inValue << inShift) & mask));
+			PendingMap::iterator pendIt(mPending.find(inRegNum));
+			if (pendIt == mPending.end())
+				mPending[inRegNum] = NTV2RegInfo(inRegNum, value, mask, 0);
+			else
+			{
+				pendIt->second.registerValue = (pendIt->second.registerValue & ~mask) | value;
+				pendIt->second.registerMask |= mask;
+			}
+			NdxMapConstIter it(mMergeNdxs.find(inRegNum));
+			if (it != mMergeNdxs.end())
+			{
+				NTV2RegInfo & regInfo (mWrites.at(it->second));
+				regInfo.registerValue = (regInfo.registerValue & ~mask) | value;
+				regInfo.registerMask |= mask;
+				return;
+			}
+			mMergeNdxs[inRegNum] = mWrites.size();
+			mWrites.push_back(NTV2RegInfo(inRegNum, value, mask, 0));
+		}
+
+	public:
+		mutable AJALock		mLock;			///< @brief	Guards all of the following
+		uint64_t			mThreadID;		///< @brief	The thread that has the transaction open
+		ULWord				mDepth;			///< @brief	Nesting depth (zero if not open)
+		NTV2RegisterWrites	mWrites;		///< @brief	Pending writes
+		NdxMap				mMergeNdxs;		///< @brief	Where to merge later writes to a given register
+		PendingMap			mPending;		///< @brief	What ReadRegister sees:  the net pending value & mask of each config register
+};	//	NTV2RegWriteTxn
+
+static void DeleteRegWriteTxn (NTV2RegWriteTxn * pTxn)	{delete pTxn;}
+
+
+bool CNTV2DriverInterface::RegWriteTxnBegin (void)
+{
+	if (!mpRegWriteTxn)
+	{
+		AJAAutoLock creator(&gLazyCreateLock);
+		if (!mpRegWriteTxn)	//	Publish it fully constructed, as the other RegWriteTxn methods test it without a lock...
+			AJAAtomic::Exchange(reinterpret_cast<void* volatile*>(&mpRegWriteTxn), new NTV2RegWriteTxn);
+	}
+	AJAAutoLock locker(&mpRegWriteTxn->mLock);
+	if (mpRegWriteTxn->mDepth  &&  !mpRegWriteTxn->IsMine())
+		{DIFAIL("Register write transaction already open on thread " << xHEX0N(mpRegWriteTxn->mThreadID,16));  return false;}
+	if (!mpRegWriteTxn->mDepth)
+	{
+		mpRegWriteTxn->mThreadID = AJAThread::GetThreadId();
+		mpRegWriteTxn->mWrites.clear();
+		mpRegWriteTxn->mMergeNdxs.clear();
+		mpRegWriteTxn->mPending.clear();
+	}
+	mpRegWriteTxn->mDepth++;
+	return true;
+}
+
+bool CNTV2DriverInterface::RegWriteTxnEnd (const bool inCommit, NTV2RegisterWrites & outWrites)
+{
+	outWrites.clear();
+	if (!mpRegWriteTxn)
+		{DIFAIL("No register write transaction open");  return false;}
+	AJAAutoLock locker(&mpRegWriteTxn->mLock);
+	if (!mpRegWriteTxn->IsMine())
+		{DIFAIL("No register write transaction open on this thread");  return false;}
+	if (inCommit  &&  --mpRegWriteTxn->mDepth)
+		return true;	//	Still nested
+	if (inCommit)
+		outWrites = mpRegWriteTxn->mWrites;
+	else
+		DIDBG("Aborted register write transaction having " << DEC(mpRegWriteTxn->mWrites.size()) << " pending write(s)");
+	mpRegWriteTxn->mDepth = 0;
+	mpRegWriteTxn->mWrites.clear();
+	mpRegWriteTxn->mMergeNdxs.clear();
+	mpRegWriteTxn->mPending.clear();
+	return true;
+}
+
+bool CNTV2DriverInterface::RegWriteTxnIntercept (const ULWord inRegNum, const ULWord inValue, const ULWord inMask, const ULWord inShift)
+{
+	if (!mpRegWriteTxn)
+		return false;
+	AJAAutoLock locker(&mpRegWriteTxn->mLock);
+	if (!mpRegWriteTxn->IsMine())
+		return false;
+	mpRegWriteTxn->Add(inRegNum, inValue, inMask, inShift);
+	return true;
+}
+
+bool CNTV2DriverInterface::RegWriteTxnIsOpen (void) const
+{
+	if (!mpRegWriteTxn)
+		return false;
+	AJAAutoLock locker(&mpRegWriteTxn->mLock);
+	return mpRegWriteTxn->IsMine();
+}
+
+ULWord CNTV2DriverInterface::RegWriteTxnNumPending (void) const
+{
+	if (!mpRegWriteTxn)
+		return 0;
+	AJAAutoLock locker(&mpRegWriteTxn->mLock);
+	return mpRegWriteTxn->IsMine() ? ULWord(mpRegWriteTxn->mWrites.size()) : 0;
+}
+
+
+/////////////// SHADOW REGISTER CACHE
+
+typedef map<ULWord, NTV2RegCacheClass>	NTV2RegCacheClassMap;
+typedef NTV2RegCacheClassMap::const_iterator	NTV2RegCacheClassMapConstIter;
+static AJALock					gRegCacheClassesLock;
+static NTV2RegCacheClassMap		gRegCacheClasses;	//	Default classifications (absent means volatile)
+
+static const NTV2RegCacheClassMap & DefaultRegCacheClasses (void)
+{
+	AJAAutoLock locker(&gRegCacheClassesLock);
+	if (gRegCacheClasses.empty())
+	{	//	Config:  registers that only change when someone writes them...
+		static const string sConfigClasses[] = {kRegClass_Routing, kRegClass_Channel1, kRegClass_Channel2, kRegClass_Channel3,
+												kRegClass_Channel4, kRegClass_Channel5, kRegClass_Channel6, kRegClass_Channel7,
+												kRegClass_Channel8, kRegClass_Video, kRegClass_CSC, kRegClass_Output, kRegClass_Mixer,
+												kRegClass_HDR, kRegClass_VPID, kRegClass_Timing, kRegClass_NTV4FrameStore,
+												kRegClass_Virtual, kRegClass_NULL};
+		//	...unless they're also status, counters, or side-effect registers (e.g. indirect access, FIFOs)...
+		static const string sVolatileClasses[] = {kRegClass_ReadOnly, kRegClass_WriteOnly, kRegClass_Interrupt, kRegClass_Timecode,
+												kRegClass_Input, kRegClass_SDIError, kRegClass_Audio, kRegClass_Anc, kRegClass_DMA,
+												kRegClass_LUT, kRegClass_IP, kRegClass_Serial, kRegClass_AES, kRegClass_Analog,
+												kRegClass_Aux, kRegClass_HDMI, kRegClass_NULL};
+		NTV2RegNumSet volatileRegs (CNTV2RegisterExpert::GetRegistersWithName("OutputFrame", CNTV2RegisterExpert::ENDSWITH));
+		const NTV2RegNumSet inputFrameRegs (CNTV2RegisterExpert::GetRegistersWithName("InputFrame", CNTV2RegisterExpert::ENDSWITH));
+		volatileRegs.insert(inputFrameRegs.begin(), inputFrameRegs.end());	//	AutoCirculate changes these every frame
+		for (size_t ndx(0);  !sVolatileClasses[ndx].empty();  ndx++)
+		{
+			const NTV2RegNumSet regs (CNTV2RegisterExpert::GetRegistersForClass(sVolatileClasses[ndx]));
+			volatileRegs.insert(regs.begin(), regs.end());
+		}
+		for (size_t ndx(0);  !sConfigClasses[ndx].empty();  ndx++)
+		{
+			const NTV2RegNumSet regs (CNTV2RegisterExpert::GetRegistersForClass(sConfigClasses[ndx]));
+			for (NTV2RegNumSetConstIter it(regs.begin());  it != regs.end();  ++it)
+				if (volatileRegs.find(*it) == volatileRegs.end())
+					gRegCacheClasses[*it] = NTV2_REGCACHE_CONFIG;
+		}
+		//	...or virtual registers whose writes are driver actions (every one must reach the driver) or whose reads change
+		static const ULWord sActionVRegs[] = {kVRegAcquireReferenceCount, kVRegReleaseReferenceCount, kVRegAcquireReferenceCounter,
+												kVRegAcquireLinuxReferenceCount, kVRegReleaseLinuxReferenceCount,
+												kVRegApplicationPID, kVRegApplicationCode, kVRegReleaseApplication,
+												kVRegForceApplicationPID, kVRegForceApplicationCode,
+												kVRegRestoreHardwareProcampRegisters, kVRegIpConfigStreamRefresh,
+												kVRegInputChangedCount, kVRegResetCycleCount, 0};
+		for (size_t ndx(0);  sActionVRegs[ndx];  ndx++)
+			gRegCacheClasses.erase(sActionVRegs[ndx]);	//	Volatile
+		//	Static:  read-only device info, crosspoint ROM, driver version...
+		const NTV2RegNumSet infoRegs (CNTV2RegisterExpert::GetRegistersForClass(kRegClass_Info));
+		for (NTV2RegNumSetConstIter it(infoRegs.begin());  it != infoRegs.end();  ++it)
+			if (CNTV2RegisterExpert::IsReadOnly(*it))
+				gRegCacheClasses[*it] = NTV2_REGCACHE_STATIC;
+		const NTV2RegNumSet romRegs (CNTV2RegisterExpert::GetRegistersForClass(kRegClass_XptROM));
+		for (NTV2RegNumSetConstIter it(romRegs.begin());  it != romRegs.end();  ++it)
+			gRegCacheClasses[*it] = NTV2_REGCACHE_STATIC;
+		gRegCacheClasses[kVRegDriverVersion] = NTV2_REGCACHE_STATIC;
+	}
+	return gRegCacheClasses;
+}
+
+/**
+	@brief	Private implementation of the shadow register cache. Entries are always entire (unmasked, unshifted) register
+			values. A config entry is only valid for the generation in which it was cached (the generation advances at
+			each vertical interrupt), and until it reaches the maximum age.
+**/
+class NTV2RegCache
+{
+	public:
+		struct Entry
+		{
+			ULWord		value;			///< @brief	Entire register value
+			ULWord		generation;		///< @brief	Generation in which it was cached
+			uint64_t	timeMicrosecs;	///< @brief	When it was cached
+		};
+		typedef map<ULWord, Entry>	EntryMap;
+		typedef EntryMap::iterator	EntryMapIter;
+
+		explicit NTV2RegCache (const ULWord inMaxAge)
+			:	mEnabled(true), mGeneration(0), mMaxAgeMicrosecs(inMaxAge), mHits(0), mMisses(0),
+				mClasses(DefaultRegCacheClasses())
+		{
+		}
+
+		inline void	NextGeneration (void)	{AJAAutoLock locker(&mLock);  mGeneration++;}
+
+		NTV2RegCacheClass ClassOf (const ULWord inRegNum) const
+		{
+			NTV2RegCacheClassMapConstIter it(mClasses.find(inRegNum));
+			return it != mClasses.end() ? it->second : NTV2_REGCACHE_VOLATILE;
+		}
+
+		bool IsFresh (const Entry & inEntry, const NTV2RegCacheClass inClass) const
+		{
+			if (inClass == NTV2_REGCACHE_STATIC)
+				return true;
+			if (inEntry.generation != mGeneration)
+				return false;
+			return !mMaxAgeMicrosecs  ||  (AJATime::GetSystemMicroseconds() - inEntry.timeMicrosecs) <= mMaxAgeMicrosecs;
+		}
+
+		void Store (const ULWord inRegNum, const ULWord inValue)
+		{
+			Entry & entry(mEntries[inRegNum]);
+			entry.value = inValue;
+			entry.generation = mGeneration;
+			entry.timeMicrosecs = AJATime::GetSystemMicroseconds();
+		}
+
+	public:
+		mutable AJALock	mLock;				///< @brief	Guards all of the following
+		bool			mEnabled;			///< @brief	Enabled?  (Once allocated, I live until the driver interface dies.)
+		ULWord			mGeneration;		///< @brief	Advances at each vertical interrupt
+		ULWord			mMaxAgeMicrosecs;	///< @brief	Maximum age of a config entry (zero means unlimited)
+		ULWord64		mHits;				///< @brief	Reads answered from the cache
+		ULWord64		mMisses;			///< @brief	Cacheable reads that went to the device
+		EntryMap		mEntries;			///< @brief	Cached register values
+		NTV2RegCacheClassMap	mClasses;	///< @brief	Register classifications (defaults plus client overrides)
+};	//	NTV2RegCache
+
+static void DeleteRegCache (NTV2RegCache * pCache)	{delete pCache;}
+
+
+//	The register value as ReadRegister would answer it (virtual registers, and zero masks, ignore the mask)
+static inline ULWord RegCacheMaskShift (const ULWord inRegNum, const ULWord inValue, const ULWord inMask, const ULWord inShift)
+{
+	if (inRegNum >= VIRTUALREG_START  ||  !inMask)
+		return inValue;
+	return (inValue & inMask) >> inShift;
+}
+
+NTV2RegCacheClass CNTV2DriverInterface::DefaultRegisterCacheClass (const ULWord inRegNum)
+{
+	const NTV2RegCacheClassMap & classes (DefaultRegCacheClasses());
+	NTV2RegCacheClassMapConstIter it(classes.find(inRegNum));
+	return it != classes.end() ? it->second : NTV2_REGCACHE_VOLATILE;
+}
+
+bool CNTV2DriverInterface::SetRegisterCacheEnable (const bool inEnable, const ULWord inMaxAgeMicrosecs)
+{
+	if (!mpRegCache)
+	{
+		if (!inEnable)
+			return true;	//	Already disabled
+		AJAAutoLock locker(&gLazyCreateLock);
+		if (!mpRegCache)	//	Still NULL, so no other thread beat me to it
+		{	//	Publish it fully constructed (Exchange is a barrier), as readers test mpRegCache without a lock...
+			AJAAtomic::Exchange(reinterpret_cast<void* volatile*>(&mpRegCache), new NTV2RegCache(inMaxAgeMicrosecs));
+			DIINFO("Shadow register cache enabled, max age " << DEC(inMaxAgeMicrosecs) << "us");
+			return true;
+		}
+	}
+	AJAAutoLock locker(&mpRegCache->mLock);
+	mpRegCache->mEntries.clear();
+	mpRegCache->mMaxAgeMicrosecs = inMaxAgeMicrosecs;
+	if (inEnable  &&  !mpRegCache->mEnabled)
+		mpRegCache->mHits = mpRegCache->mMisses = 0;
+	mpRegCache->mEnabled = inEnable;
+	DIINFO("Shadow register cache " << (inEnable ? "enabled" : "disabled"));
+	return true;
+}
+
+bool CNTV2DriverInterface::IsRegisterCacheEnabled (void) const
+{
+	if (!mpRegCache)
+		return false;
+	AJAAutoLock locker(&mpRegCache->mLock);
+	return mpRegCache->mEnabled;
+}
+
+void CNTV2DriverInterface::FlushRegisterCache (const bool inIncludeStatic)
+{
+	if (!mpRegCache)
+		return;
+	AJAAutoLock locker(&mpRegCache->mLock);
+	if (inIncludeStatic)
+		{mpRegCache->mEntries.clear();  return;}
+	for (NTV2RegCache::EntryMapIter it(mpRegCache->mEntries.begin());  it != mpRegCache->mEntries.end();  )
+		if (mpRegCache->ClassOf(it->first) == NTV2_REGCACHE_STATIC)
+			++it;
+		else
+			mpRegCache->mEntries.erase(it++);
+}
+
+bool CNTV2DriverInterface::SetRegisterCacheClass (const ULWord inRegNum, const NTV2RegCacheClass inClass)
+{
+	if (inClass >= NTV2_REGCACHE_INVALID)
+		{DIFAIL("Bad class " << DEC(inClass) << " for reg " << DEC(inRegNum));  return false;}
+	if (!mpRegCache)
+		{DIFAIL("Shadow register cache not enabled");  return false;}
+	AJAAutoLock locker(&mpRegCache->mLock);
+	mpRegCache->mClasses[inRegNum] = inClass;
+	mpRegCache->mEntries.erase(inRegNum);
+	return true;
+}
+
+NTV2RegCacheClass CNTV2DriverInterface::GetRegisterCacheClass (const ULWord inRegNum) const
+{
+	if (!mpRegCache)
+		return DefaultRegisterCacheClass(inRegNum);
+	AJAAutoLock locker(&mpRegCache->mLock);
+	return mpRegCache->ClassOf(inRegNum);
+}
+
+bool CNTV2DriverInterface::GetRegisterCacheStats (ULWord64 & outHits, ULWord64 & outMisses) const
+{
+	outHits = outMisses = 0;
+	if (!mpRegCache)
+		return false;
+	AJAAutoLock locker(&mpRegCache->mLock);
+	outHits = mpRegCache->mHits;
+	outMisses = mpRegCache->mMisses;
+	return mpRegCache->mEnabled;
+}
+
+bool CNTV2DriverInterface::SetDriverTraceEnable (const bool inEnable, const ULWord inCapacity)
+{
+	//	Other threads may hold the current trace in an NTV2DriverTraceScope, so never delete it here -- retire it instead
+	AJAAutoLock locker(&mDriverTraceLock);	//	Only one swap at a time, or two could retire (or reuse) the same trace
+	NTV2DriverTrace * pOldTrace (mpDriverTrace);
+	if (!inEnable)
+	{
+		if (!pOldTrace)
+			return true;	//	Already disabled
+		AJAAtomic::Exchange(reinterpret_cast<void* volatile*>(&mpDriverTrace), AJA_NULL);
+		mRetiredDriverTraces.push_back(pOldTrace);
+		DIDBG("Driver trace disabled");
+		return true;
+	}
+	if (pOldTrace  &&  pOldTrace->GetCapacity() >= inCapacity)
+		return true;	//	Already enabled
+	NTV2DriverTrace * pNewTrace (AJA_NULL);
+	if (!mRetiredDriverTraces.empty()  &&  mRetiredDriverTraces.back()->GetCapacity() >= inCapacity)
+	{	//	Reuse the most recently retired trace
+		pNewTrace = mRetiredDriverTraces.back();
+		mRetiredDriverTraces.pop_back();
+		pNewTrace->Reset();
+	}
+	else
+		pNewTrace = new NTV2DriverTrace(inCapacity);
+	if (pOldTrace)
+		mRetiredDriverTraces.push_back(pOldTrace);
+	AJAAtomic::Exchange(reinterpret_cast<void* volatile*>(&mpDriverTrace), pNewTrace);	//	Publish it fully constructed
+	DIDBG("Driver trace enabled, capacity " << DEC(pNewTrace->GetCapacity()) << " per thread");
+	return true;
+}
+
+bool CNTV2DriverInterface::RegCacheRead (const ULWord inRegNum, ULWord & outValue, const ULWord inMask, const ULWord inShift, bool & outCacheable)
+{
+	outCacheable = false;
+	ULWord pendingValue(0), pendingMask(0);
+	const bool isPending (mpRegWriteTxn  &&  mpRegWriteTxn->GetPending(inRegNum, pendingValue, pendingMask));
+	if (isPending  &&  pendingMask == 0xFFFFFFFF)
+		{outValue = RegCacheMaskShift(inRegNum, pendingValue, inMask, inShift);  return true;}	//	Entire value is pending
+	outCacheable = isPending;	//	Caller must read entire register, so I can overlay the pending bits
+	if (!mpRegCache)
+		return false;
+	NTV2RegCache & cache(*mpRegCache);
+	AJAAutoLock locker(&cache.mLock);
+	if (!cache.mEnabled)
+		return false;
+	const NTV2RegCacheClass regClass (cache.ClassOf(inRegNum));
+	if (regClass == NTV2_REGCACHE_VOLATILE)
+		return false;
+	outCacheable = true;
+	NTV2RegCache::EntryMapIter it(cache.mEntries.find(inRegNum));
+	if (it != cache.mEntries.end()  &&  cache.IsFresh(it->second, regClass))
+	{
+		const ULWord value ((it->second.value & ~pendingMask) | (pendingValue & pendingMask));
+		outValue = RegCacheMaskShift(inRegNum, value, inMask, inShift);
+		cache.mHits++;
+		AJADebug::StatCounterIncrement(AJA_DebugStat_RegCacheHit);
+		return true;
+	}
+	cache.mMisses++;
+	AJADebug::StatCounterIncrement(AJA_DebugStat_RegCacheMiss);
+	return false;
+}
+
+bool CNTV2DriverInterface::RegCacheFill (const bool inReadOK, const bool inCacheable, const ULWord inRegNum, ULWord & inOutValue, const ULWord inMask, const ULWord inShift)
+{
+	if (!inCacheable)
+		return inReadOK;
+	if (inReadOK  &&  mpRegCache)
+	{
+		AJAAutoLock locker(&mpRegCache->mLock);
+		if (mpRegCache->mEnabled  &&  mpRegCache->ClassOf(inRegNum) != NTV2_REGCACHE_VOLATILE)
+			mpRegCache->Store(inRegNum, inOutValue);
+	}
+	ULWord pendingValue(0), pendingMask(0);
+	if (inReadOK  &&  mpRegWriteTxn  &&  mpRegWriteTxn->GetPending(inRegNum, pendingValue, pendingMask))
+		inOutValue = (inOutValue & ~pendingMask) | (pendingValue & pendingMask);
+	inOutValue = RegCacheMaskShift(inRegNum, inOutValue, inMask, inShift);
+	return inReadOK;
+}
+
+bool CNTV2DriverInterface::RegCacheWriteThrough (const bool inWriteOK, const ULWord inRegNum, const ULWord inValue, const ULWord inMask, const ULWord inShift)
+{
+	if (!mpRegCache)
+		return inWriteOK;
+	NTV2RegCache & cache(*mpRegCache);
+	AJAAutoLock locker(&cache.mLock);
+	NTV2RegCache::EntryMapIter it(cache.mEntries.find(inRegNum));
+	const bool isWhole (inRegNum >= VIRTUALREG_START  ||  ((!inMask || inMask == 0xFFFFFFFF)  &&  !inShift));
+	if (!inWriteOK  ||  !cache.mEnabled  ||  (!isWhole && it == cache.mEntries.end()))
+	{	//	Failed, or can't tell what the register now holds
+		if (it != cache.mEntries.end())
+			cache.mEntries.erase(it);
+		return inWriteOK;
+	}
+	const NTV2RegCacheClass regClass (cache.ClassOf(inRegNum));
+	if (regClass == NTV2_REGCACHE_VOLATILE)
+		return inWriteOK;
+	if (isWhole)
+		cache.Store(inRegNum, inValue);
+	else if (!cache.IsFresh(it->second, regClass))
+		cache.mEntries.erase(it);	//	Don't merge into a stale value
+	else
+		cache.Store(inRegNum, (it->second.value & ~inMask) | ((inValue << inShift) & inMask));	//	Read-modify-write, as the driver does
+	return inWriteOK;
+}
+
+
 bool CNTV2DriverInterface::DmaTransfer (const NTV2DMAEngine inDMAEngine,
 										const bool			inIsRead,
 										const ULWord		inFrameNumber,
@@ -554,6 +1215,100 @@ bool CNTV2DriverInterface::WaitForInterrupt (INTERRUPT_ENUMS eInterrupt, ULWord
 #endif
 }
 
+// Common multi-interrupt wait.  Remote cards use their RPC API;  local cards poll the driver's
+// interrupt counts, unless a subclass has a platform-specific implementation.
+bool CNTV2DriverInterface::WaitForAnyInterrupt (NTV2InterruptWaitSet & inOutWaitSet, const ULWord inTimeoutMs)
+{
+	inOutWaitSet.StartWait();
+	if (inOutWaitSet.IsEmpty())
+		{DIFAIL("No interrupts to wait on");  return false;}
+	if (!IsOpen())
+		return false;
+	if (IsRemote())
+	{
+#if defined(NTV2_NUB_CLIENT_SUPPORT)
+		if (!_pRPCAPI  ||  !_pRPCAPI->NTV2WaitForAnyInterruptRemote(inOutWaitSet, inTimeoutMs))
+			return false;
+#else
+		return false;
+#endif
+	}
+	else
+	{
+		const vector<INTERRUPT_ENUMS> sources (inOutWaitSet.GetSources());
+		const uint64_t deadline (AJATime::GetSystemMilliseconds() + inTimeoutMs);
+		while (true)
+		{
+			bool anyCounted (false);
+			const ULWord64 now (ULWord64(AJATime::GetSystemMicroseconds()) * 10);
+			for (size_t ndx(0);  ndx < sources.size();  ndx++)
+			{
+				const INTERRUPT_ENUMS intr (sources.at(ndx));
+				ULWord count (0);
+				if (!GetInterruptCount(intr, count))
+					continue;
+				anyCounted = true;
+				const bool fired (inOutWaitSet.HasBaseline(intr)  &&  inOutWaitSet.GetCount(intr) != count);
+				inOutWaitSet.SetResult(intr, count, fired ? now : 0);
+			}
+			if (!anyCounted)
+				{DIFAIL("Driver can't count any of these interrupts: " << inOutWaitSet);  return false;}
+			if (inOutWaitSet.GetFiredMask())
+				break;
+			if (AJATime::GetSystemMilliseconds() >= deadline)
+				return false;
+			AJATime::SleepInMicroseconds(1000);
+		}
+	}
+	const vector<INTERRUPT_ENUMS> fired (inOutWaitSet.GetFired());
+	for (size_t ndx(0);  ndx < fired.size();  ndx++)
+		BumpEventCount(fired.at(ndx));
+	return !fired.empty();
+}
+
+// Common interrupt snapshot.  Waits, then reads the requested registers & AutoCirculate status, unless
+// a subclass can have the driver capture them in the same call.
+bool CNTV2DriverInterface::WaitForInterruptSnapshot (const INTERRUPT_ENUMS inInterrupt, NTV2InterruptSnapshot & inOutSnapshot, const ULWord inTimeoutMs)
+{
+	inOutSnapshot.StartCapture(inInterrupt);
+	if (!NTV2_IS_VALID_INTERRUPT_ENUM(inInterrupt))
+		{DIFAIL("Invalid interrupt " << DEC(inInterrupt));  return false;}
+	if (!WaitForInterrupt(inInterrupt, inTimeoutMs))
+		return false;
+
+	const ULWord64 now (ULWord64(AJATime::GetSystemMicroseconds()) * 10);
+	ULWord countBefore(0), countAfter(0);
+	const bool counted (GetInterruptCount(inInterrupt, countBefore));
+	bool ok (true);
+
+	const NTV2RegNumSet & regNums (inOutSnapshot.GetRegisters());
+	if (!regNums.empty())
+	{
+		NTV2RegisterReads regReads;
+		for (NTV2RegNumSetConstIter it(regNums.begin());  it != regNums.end();  ++it)
+			regReads.push_back(NTV2RegInfo(*it));
+		if (ReadRegisters(regReads))
+			for (NTV2RegisterReadsConstIter it(regReads.begin());  it != regReads.end();  ++it)
+				inOutSnapshot.SetRegisterValue(it->registerNumber, it->registerValue);
+		else
+			{DIFAIL("ReadRegisters failed for " << DEC(regReads.size()) << " register(s)");  ok = false;}
+	}
+
+	const NTV2CrosspointSet & crosspoints (inOutSnapshot.GetAutoCirculates());
+	for (NTV2CrosspointSet::const_iterator it(crosspoints.begin());  it != crosspoints.end();  ++it)
+	{
+		AUTOCIRCULATE_STATUS acStatus (*it);
+		if (NTV2Message(acStatus))
+			inOutSnapshot.SetAutoCirculateStatus(acStatus);
+		else
+			{DIFAIL("AutoCirculate status failed for crosspoint " << DEC(*it));  ok = false;}
+	}
+
+	const bool coherent (counted  &&  GetInterruptCount(inInterrupt, countAfter)  &&  countAfter == countBefore);
+	inOutSnapshot.SetInterrupt(countBefore, now, coherent);
+	return ok;
+}
+
 // Common remote card autocirculate.  Subclasses have overloaded function
 // that does platform-specific autocirculate on local cards.
 bool CNTV2DriverInterface::AutoCirculate (AUTOCIRCULATE_DATA & autoCircData)
@@ -882,20 +1637,19 @@ void CNTV2DriverInterface::FinishOpen (void)
 	// HACK! FinishOpen needs frame geometry to determine frame buffer size and number.
 	NTV2FrameGeometry fg(NTV2_FG_INVALID);
 	ULWord val1(0), val2(0);
-	ReadRegister (kRegGlobalControl, fg, kRegMaskGeometry, kRegShiftGeometry);	//	Read FrameGeometry
-	ReadRegister (kRegCh1Control, val1, kRegMaskFrameFormat, kRegShiftFrameFormat); //	Read PixelFormat
-	ReadRegister (kRegCh1Control, val2, kRegMaskFrameFormatHiBit, kRegShiftFrameFormatHiBit);
+	NTV2RegReads regs;	//	Read FrameGeometry & PixelFormat in one go
+	regs.push_back(NTV2RegInfo(kRegGlobalControl));
+	regs.push_back(NTV2RegInfo(kRegCh1Control));
+	if (ReadRegisters(regs))
+	{
+		fg = NTV2FrameGeometry((regs.at(0).registerValue & kRegMaskGeometry) >> kRegShiftGeometry);
+		val1 = (regs.at(1).registerValue & kRegMaskFrameFormat) >> kRegShiftFrameFormat;
+		val2 = (regs.at(1).registerValue & kRegMaskFrameFormatHiBit) >> kRegShiftFrameFormatHiBit;
+	}
 	NTV2PixelFormat pf(NTV2PixelFormat((val1 & 0x0F) | ((val2 & 0x1) << 4)));
 	_ulFrameBufferSize = ::NTV2DeviceGetFrameBufferSize(_boardID, fg, pf);
 	_ulNumFrameBuffers = ::NTV2DeviceGetNumberFrameBuffers(_boardID, fg, pf);
 
-	ULWord returnVal1 = false;
-	ULWord returnVal2 = false;
-	if (::NTV2DeviceCanDo4KVideo(_boardID))
-		ReadRegister(kRegGlobalControl2, returnVal1, kRegMaskQuadMode, kRegShiftQuadMode);
-	if (::NTV2DeviceCanDo425Mux(_boardID))
-		ReadRegister(kRegGlobalControl2, returnVal2, kRegMask425FB12, kRegShift425FB12);
-
 #if !defined(NTV2_DEPRECATE_16_0)
 	_pFrameBaseAddress = AJA_NULL;
 	_pRegisterBaseAddress = AJA_NULL;
@@ -905,6 +1659,7 @@ void CNTV2DriverInterface::FinishOpen (void)
 	_pCh2FrameBaseAddress = AJA_NULL;
 #endif	//	!defined(NTV2_DEPRECATE_16_0)
 
+	RefreshDeviceCapabilities();
 }	//	FinishOpen
 
 
@@ -1277,6 +2032,8 @@ void CNTV2DriverInterface::BumpEventCount (const INTERRUPT_ENUMS eInterruptType)
 {
 	if (NTV2_IS_VALID_INTERRUPT_ENUM(eInterruptType))
 		mEventCounts[eInterruptType] += 1;
+	if (mpRegCache  &&  (NTV2_IS_INPUT_INTERRUPT(eInterruptType) || NTV2_IS_OUTPUT_INTERRUPT(eInterruptType)))
+		mpRegCache->NextGeneration();	//	Config registers may have changed at the VBI
 
 }	//	BumpEventCount
 
@@ -1379,14 +2136,217 @@ bool CNTV2DriverInterface::IsMBSystemReady (void)
 #endif	//	NTV2_WRITEREG_PROFILING
 
 
+/////////////// DEVICE CAPABILITIES
+
+bool CNTV2DriverInterface::RefreshDeviceCapabilities (void)
+{
+	if (!IsOpen())
+		return false;
+	if (!mpDevCaps)
+		mpDevCaps = new NTV2DevCapsCache;
+	mpDevCaps->Clear();
+	const uint64_t startTime (AJATime::GetSystemMicroseconds());
+	const NTV2DeviceID devID (GetDeviceID());
+	if (IsRemote())
+	{	//	Use the device's profile, if it's cached on disk, or if the remote host can send it in one go...
+		NTV2DeviceProfile profile;
+		ULWord64 fwVersion(0);
+		const bool haveFW (NTV2DeviceProfile::ReadFirmwareVersion(*this, fwVersion)  &&  fwVersion);
+		if (haveFW  &&  profile.LoadFromCache(devID, fwVersion)  &&  ApplyDeviceProfile(profile))
+			DIDBG(::NTV2DeviceIDToString(devID) << " capabilities loaded from profile cache in " << DEC(AJATime::GetSystemMicroseconds() - startTime) << "us");
+		else if (_pRPCAPI->NTV2GetDeviceProfileRemote(profile)  &&  ApplyDeviceProfile(profile))
+		{
+			if (haveFW  &&  profile.GetFirmwareVersion() == fwVersion)
+				profile.SaveToCache();
+			DIDBG(::NTV2DeviceIDToString(devID) << " capabilities received in " << DEC(AJATime::GetSystemMicroseconds() - startTime) << "us");
+		}
+		return true;	//	Anything else is cached upon first use
+	}
+
+
+	//	Read all register-based features in one go...
+	NTV2RegisterReads regReads;
+	NTV2RegInfo regInfo;
+	for (ULWord param(kNTV2BoolParam_FIRST);  param < kNTV2BoolParam_LAST;  param++)
+		if (GetRegInfoForBoolParam(NTV2BoolParamID(param), regInfo))
+			regReads.push_back(NTV2RegInfo(regInfo.registerNumber));
+	for (ULWord param(kNTV2NumericParam_FIRST);  param < kNTV2NumericParam_LAST;  param++)
+		if (GetRegInfoForNumericParam(NTV2NumericParamID(param), regInfo))
+			regReads.push_back(NTV2RegInfo(regInfo.registerNumber));
+	const bool useDiscoveryCache (GetDiscoveryCache());
+	if (useDiscoveryCache)
+	{	//	...along with the serial number and firmware version...
+		regReads.push_back(NTV2RegInfo(kRegReserved54));	//	Serial number low
+		regReads.push_back(NTV2RegInfo(kRegReserved55));	//	Serial number high
+		regReads.push_back(NTV2RegInfo(kRegBitfileDate));
+		regReads.push_back(NTV2RegInfo(kRegBitfileTime));
+		regReads.push_back(NTV2RegInfo(kRegDMAControl));
+	}
+	NTV2RegisterValueMap regValues;
+	if (!regReads.empty()  &&  ReadRegisters(regReads))
+		for (NTV2RegisterReadsConstIter it(regReads.begin());  it != regReads.end();  ++it)
+			regValues[it->registerNumber] = it->registerValue;
+
+	//	...and reuse what was discovered the last time this device & firmware was opened...
+	NTV2DiscoveryKey discoveryKey(0, 0);
+	if (useDiscoveryCache  &&  regValues.find(kRegDMAControl) != regValues.end())
+	{
+		discoveryKey.first = (ULWord64(regValues[kRegReserved55]) << 32) | ULWord64(regValues[kRegReserved54]);
+		discoveryKey.second = NTV2DeviceProfile::MakeFirmwareVersion(regValues[kRegBitfileDate], regValues[kRegBitfileTime], regValues[kRegDMAControl]);
+		if (!discoveryKey.first  ||  !discoveryKey.second)
+			discoveryKey = NTV2DiscoveryKey(0, 0);	//	Can't tell devices or firmware builds apart
+	}
+	if (discoveryKey.first)
+	{
+		AJAAutoLock locker(&gDiscoveryCacheLock);
+		NTV2DiscoveryCache::const_iterator it (gDiscoveryCache.find(discoveryKey));
+		if (it != gDiscoveryCache.end()  &&  ApplyDeviceProfile(it->second))
+		{
+			DIDBG(::NTV2DeviceIDToString(devID) << " capabilities reused in " << DEC(AJATime::GetSystemMicroseconds() - startTime) << "us");
+			return true;
+		}
+	}
+
+	//	Register-based features first, since other features depend on them...
+	for (ULWord param(kNTV2BoolParam_FIRST);  param < kNTV2BoolParam_LAST;  param++)
+		if (GetRegInfoForBoolParam(NTV2BoolParamID(param), regInfo))
+		{	NTV2RegValueMapConstIter it(regValues.find(regInfo.registerNumber));
+			if (it != regValues.end())
+				mpDevCaps->SetBool(param, (it->second & regInfo.registerMask) ? 1 : 0);
+		}
+	for (ULWord param(kNTV2NumericParam_FIRST);  param < kNTV2NumericParam_LAST;  param++)
+		if (GetRegInfoForNumericParam(NTV2NumericParamID(param), regInfo))
+		{	NTV2RegValueMapConstIter it(regValues.find(regInfo.registerNumber));
+			if (it != regValues.end())
+				mpDevCaps->SetNum(param, (it->second & regInfo.registerMask) >> regInfo.registerShift);
+		}
+	//	Numeric features (some of which depend on the register-based ones)...
+	for (ULWord param(kNTV2NumericParam_FIRST);  param < kNTV2NumericParam_LAST;  param++)
+	{	ULWord value(0);
+		if (!GetRegInfoForNumericParam(NTV2NumericParamID(param), regInfo)  &&  QueryNumericParam(param, value, devID))
+			mpDevCaps->SetNum(param, value);
+	}
+	//	Boolean features (many of which depend on the numeric ones)...
+	for (ULWord param(kNTV2BoolParam_FIRST);  param < kNTV2BoolParam_LAST;  param++)
+	{	ULWord value(0);
+		if (!GetRegInfoForBoolParam(NTV2BoolParamID(param), regInfo)  &&  QueryBoolParam(param, value, devID))
+			mpDevCaps->SetBool(param, value);
+	}
+	//	Supported items (some of which depend on the features cached above)...
+	for (NTV2EnumsID enumsID(kNTV2EnumsID_FIRST);  enumsID < kNTV2EnumsID_LAST;  enumsID = NTV2EnumsID(enumsID+1))
+		mpDevCaps->SetEnums(enumsID, QuerySupportedItems(enumsID, devID));
+	if (discoveryKey.first)
+	{
+		NTV2DeviceProfile profile;
+		profile.SetDeviceID(devID);
+		profile.SetFirmwareVersion(discoveryKey.second);
+		mpDevCaps->CopyTo(profile);
+		AJAAutoLock locker(&gDiscoveryCacheLock);
+		gDiscoveryCache[discoveryKey] = profile;
+	}
+	DIDBG(::NTV2DeviceIDToString(devID) << " capabilities cached in " << DEC(AJATime::GetSystemMicroseconds() - startTime) << "us");
+	return true;
+}
+
+bool CNTV2DriverInterface::GetDeviceProfile (NTV2DeviceProfile & outProfile)
+{
+	outProfile.Clear();
+	if (!IsOpen())
+		return false;
+	const NTV2DeviceID devID (GetDeviceID());
+	ULWord64 fwVersion(0);
+	NTV2DeviceProfile::ReadFirmwareVersion(*this, fwVersion);
+	outProfile.SetDeviceID(devID);
+	outProfile.SetFirmwareVersion(fwVersion);
+
+	//	Only features that can be answered are included...
+	for (ULWord param(kNTV2NumericParam_FIRST);  param < kNTV2NumericParam_LAST;  param++)
+	{	ULWord value(0);
+		if (GetNumericParam(param, value))
+			outProfile.SetNumericParam(param, value);
+	}
+	for (ULWord param(kNTV2BoolParam_FIRST);  param < kNTV2BoolParam_LAST;  param++)
+	{	ULWord value(0);
+		if (param != ULWord(kDeviceHasBreakoutBoard)  &&  GetBoolParam(param, value))	//	Breakout boxes come and go
+			outProfile.SetBoolParam(param, value);
+	}
+	for (NTV2EnumsID enumsID(kNTV2EnumsID_FIRST);  enumsID < kNTV2EnumsID_LAST;  enumsID = NTV2EnumsID(enumsID+1))
+		outProfile.SetSupportedItems(enumsID, GetSupportedItems(enumsID));
+
+	NTV2RegisterNameMap regNames;
+	const NTV2RegNumSet regNums (CNTV2RegisterExpert::GetRegistersForDevice(devID, kIncludeOtherRegs_None));
+	for (NTV2RegNumSetConstIter it(regNums.begin());  it != regNums.end();  ++it)
+		regNames[*it] = CNTV2RegisterExpert::GetDisplayName(*it);
+	outProfile.SetRegisterNames(regNames);
+
+	if (outProfile.IsSupported(kDeviceHasXptConnectROM))
+	{	NTV2RegReads romRegs;
+		if (CNTV2SignalRouter::MakeRouteROMRegisters(romRegs)  &&  ReadRegisters(romRegs))
+			outProfile.SetRouteROM(romRegs);
+	}
+	return true;
+}
+
+bool CNTV2DriverInterface::ApplyDeviceProfile (const NTV2DeviceProfile & inProfile)
+{
+	if (!IsOpen())
+		return false;
+	if (inProfile.GetDeviceID() != GetDeviceID())
+		{DIFAIL("Profile is for " << ::NTV2DeviceIDToString(inProfile.GetDeviceID()) << ", not " << ::NTV2DeviceIDToString(GetDeviceID()));  return false;}
+	if (!mpDevCaps)
+		mpDevCaps = new NTV2DevCapsCache;
+	for (NTV2RegValueMapConstIter it(inProfile.GetBoolParams().begin());  it != inProfile.GetBoolParams().end();  ++it)
+		mpDevCaps->SetBool(it->first, it->second);
+	for (NTV2RegValueMapConstIter it(inProfile.GetNumericParams().begin());  it != inProfile.GetNumericParams().end();  ++it)
+		mpDevCaps->SetNum(it->first, it->second);
+	for (NTV2SupportedItemsMapConstIter it(inProfile.GetSupportedItemsMap().begin());  it != inProfile.GetSupportedItemsMap().end();  ++it)
+		mpDevCaps->SetEnums(NTV2EnumsID(it->first), it->second);
+	return true;
+}
+
+bool CNTV2DriverInterface::GetBoolParam (const ULWord inParamID, ULWord & outValue)
+{
+	if (mpDevCaps  &&  mpDevCaps->GetBool(inParamID, outValue))
+		return true;
+	if (!QueryBoolParam(inParamID, outValue, GetDeviceID()))
+		return false;
+	if (mpDevCaps  &&  IsOpen())
+		mpDevCaps->SetBool(inParamID, outValue);
+	return true;
+}
+
+bool CNTV2DriverInterface::GetNumericParam (const ULWord inParamID, ULWord & outValue)
+{
+	if (mpDevCaps  &&  mpDevCaps->GetNum(inParamID, outValue))
+		return true;
+	if (!QueryNumericParam(inParamID, outValue, GetDeviceID()))
+		return false;
+	if (mpDevCaps  &&  IsOpen())
+		mpDevCaps->SetNum(inParamID, outValue);
+	return true;
+}
+
 ULWordSet CNTV2DriverInterface::GetSupportedItems (const NTV2EnumsID inEnumsID)
+{
+	ULWordSet result;
+	if (!IsOpen())
+		return result;
+	if (mpDevCaps  &&  mpDevCaps->GetEnums(inEnumsID, result))
+		return result;
+	result = QuerySupportedItems(inEnumsID, GetDeviceID());
+	if (mpDevCaps)
+		mpDevCaps->SetEnums(inEnumsID, result);
+	return result;
+}
+
+ULWordSet CNTV2DriverInterface::QuerySupportedItems (const NTV2EnumsID inEnumsID, const NTV2DeviceID inDeviceID)
 {
 	ULWordSet result;
 	if (!IsOpen())
 		return result;
 	if (IsRemote()  &&  _pRPCAPI->NTV2GetSupportedRemote (inEnumsID, result))
 		return result;
-	const NTV2DeviceID devID(GetDeviceID());
+	const NTV2DeviceID devID(inDeviceID);
 	switch (inEnumsID)
 	{
 		case kNTV2EnumsID_DeviceID:
@@ -1523,7 +2483,7 @@ ULWordSet CNTV2DriverInterface::GetSupportedItems (const NTV2EnumsID inEnumsID)
 	return result;
 }
 
-bool CNTV2DriverInterface::GetBoolParam (const ULWord inParamID, ULWord & outValue)
+bool CNTV2DriverInterface::QueryBoolParam (const ULWord inParamID, ULWord & outValue, const NTV2DeviceID inDeviceID)
 {
 	const NTV2BoolParamID paramID (NTV2BoolParamID(inParamID+0));
 
@@ -1543,7 +2503,7 @@ bool CNTV2DriverInterface::GetBoolParam (const ULWord inParamID, ULWord & outVal
 		return true;
 
 	//	Call classic device features function...
-	const NTV2DeviceID devID (GetDeviceID());
+	const NTV2DeviceID devID (inDeviceID);
 	switch (inParamID)
 	{
 		case kDeviceCanChangeEmbeddedAudioClock:	outValue = ::NTV2DeviceCanChangeEmbeddedAudioClock(devID);			break;	//	Deprecate?
@@ -1677,11 +2637,11 @@ bool CNTV2DriverInterface::GetBoolParam (const ULWord inParamID, ULWord & outVal
 		case kDeviceHasRotaryEncoder:				outValue = ::NTV2DeviceHasRotaryEncoder(devID);						break;
 		case kDeviceHasSPIv5:						outValue = ::NTV2DeviceGetSPIFlashVersion(devID) == 5;				break;
 		case kDeviceHasXilinxDMA:					outValue = ::NTV2DeviceHasXilinxDMA(devID);							break;
-		case kDeviceCanDoStreamingDMA:				outValue = GetDeviceID() == DEVICE_ID_KONAXM;						break;
+		case kDeviceCanDoStreamingDMA:				outValue = devID == DEVICE_ID_KONAXM;						break;
 		case kDeviceHasPWMFanControl:				outValue = ::NTV2DeviceHasPWMFanControl(devID);						break;
 		case kDeviceCanDoHDMIQuadRasterConversion:	outValue = (GetNumSupported(kDeviceGetNumHDMIVideoInputs)
 																	||  GetNumSupported(kDeviceGetNumHDMIVideoOutputs))	//	At least 1 HDMI in/out
-																&& (GetDeviceID() != DEVICE_ID_KONAHDMI)				//	Not a KonaHDMI
+																&& (devID != DEVICE_ID_KONAHDMI)				//	Not a KonaHDMI
 																&& (!IsSupported(kDeviceCanDoAudioMixer));				//	No audio mixer
 													break;
 
@@ -1691,10 +2651,10 @@ bool CNTV2DriverInterface::GetBoolParam (const ULWord inParamID, ULWord & outVal
 	}
 	return true;	//	Successfully used old ::NTV2DeviceCanDo function
 
-}	//	GetBoolParam
+}	//	QueryBoolParam
 
 
-bool CNTV2DriverInterface::GetNumericParam (const ULWord inParamID, ULWord & outVal)
+bool CNTV2DriverInterface::QueryNumericParam (const ULWord inParamID, ULWord & outVal, const NTV2DeviceID inDeviceID)
 {
 	const NTV2NumericParamID paramID (NTV2NumericParamID(inParamID+0));
 	outVal = 0;
@@ -1709,7 +2669,7 @@ bool CNTV2DriverInterface::GetNumericParam (const ULWord inParamID, ULWord & out
 		return true;
 
 	//	Call classic device features function...
-	const NTV2DeviceID devID (GetDeviceID());
+	const NTV2DeviceID devID (inDeviceID);
 	switch (paramID)
 	{
 		case kDeviceGetActiveMemorySize:				outVal = ::NTV2DeviceGetActiveMemorySize (devID);				break;
@@ -1773,7 +2733,7 @@ bool CNTV2DriverInterface::GetNumericParam (const ULWord inParamID, ULWord & out
 	}
 	return true;	//	Successfully used old ::NTV2DeviceGetNum function
 
-}	//	GetNumericParam
+}	//	QueryNumericParam
 
 
 bool CNTV2DriverInterface::GetRegInfoForBoolParam (const NTV2BoolParamID inParamID, NTV2RegInfo & outRegInfo)
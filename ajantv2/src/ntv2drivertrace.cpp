@@ -0,0 +1,322 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2drivertrace.cpp
+	@brief		Implements the NTV2DriverTrace class, and its NTV2DriverTraceRecord, NTV2DriverTraceStats and NTV2DriverTraceScope helpers.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2drivertrace.h"
+#include "ntv2seqlockring.hpp"
+#include "ntv2debug.h"
+#include "ntv2utils.h"
+#include "ajabase/system/atomic.h"
+#include "ajabase/system/systemtime.h"
+#include "ajabase/system/thread.h"
+#include "ajabase/system/debug.h"
+#include "ajabase/common/common.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+using namespace std;
+
+#define DTFAIL(__x__)	AJA_sERROR	(AJA_DebugUnit_DriverInterface, AJAFUNC << ": " << __x__)
+#define DTWARN(__x__)	AJA_sWARNING(AJA_DebugUnit_DriverInterface, AJAFUNC << ": " << __x__)
+#define DTDBG(__x__)	AJA_sDEBUG	(AJA_DebugUnit_DriverInterface, AJAFUNC << ": " << __x__)
+
+
+string NTV2DriverTraceOpToString (const NTV2DriverTraceOp inOp)
+{
+	switch (inOp)
+	{
+		case NTV2_TRACE_READ_REGISTER:		return "ReadRegister";
+		case NTV2_TRACE_WRITE_REGISTER:		return "WriteRegister";
+		case NTV2_TRACE_MESSAGE:			return "NTV2Message";
+		case NTV2_TRACE_DMA_READ:			return "DMARead";
+		case NTV2_TRACE_DMA_WRITE:			return "DMAWrite";
+		case NTV2_TRACE_DMA_P2P:			return "DMAP2P";
+		case NTV2_TRACE_AUTOCIRCULATE:		return "AutoCirculate";
+		case NTV2_TRACE_WAIT_INTERRUPT:		return "WaitForInterrupt";
+		case NTV2_TRACE_WAIT_ANY_INTERRUPT:	return "WaitForAnyInterrupt";
+		case NTV2_TRACE_WAIT_INTERRUPT_SNAPSHOT:	return "WaitForInterruptSnapshot";
+		case NTV2_TRACE_INTERRUPT_COUNT:	return "GetInterruptCount";
+		case NTV2_TRACE_NUM_OPS:			break;
+	}
+	return "";
+}
+
+
+string NTV2DriverTraceRecord::ArgsString (void) const
+{
+	ostringstream oss;
+	switch (fOp)
+	{
+		case NTV2_TRACE_READ_REGISTER:
+		case NTV2_TRACE_WRITE_REGISTER:
+			oss << "reg=" << DEC(fArgs[0]);
+			if (ULWord(fArgs[1]) != 0xFFFFFFFF)
+				oss << " msk=" << xHEX0N(ULWord(fArgs[1]),8);
+			oss << " val=" << xHEX0N(ULWord(fArgs[2]),8);
+			break;
+		case NTV2_TRACE_MESSAGE:
+			oss << "type=" << NTV2_4CC_AS_STRING(ULWord(fArgs[0])) << " size=" << DEC(fArgs[1]);
+			break;
+		case NTV2_TRACE_DMA_READ:
+		case NTV2_TRACE_DMA_WRITE:
+		case NTV2_TRACE_DMA_P2P:
+			oss << "eng=" << DEC(fArgs[0]) << " frm=" << DEC(fArgs[1]) << " bytes=" << DEC(fArgs[2]);
+			break;
+		case NTV2_TRACE_AUTOCIRCULATE:
+			oss << "cmd=" << DEC(fArgs[0]) << " chan=" << DEC(fArgs[1]);
+			break;
+		case NTV2_TRACE_WAIT_INTERRUPT:
+			oss << "intr=" << ::NTV2InterruptEnumString(unsigned(fArgs[0])) << " timeout=" << DEC(fArgs[1]) << "ms";
+			break;
+		case NTV2_TRACE_WAIT_ANY_INTERRUPT:
+			oss << "mask=" << xHEX0N(fArgs[0],16) << " timeout=" << DEC(fArgs[1]) << "ms fired=" << xHEX0N(fArgs[2],16);
+			break;
+		case NTV2_TRACE_WAIT_INTERRUPT_SNAPSHOT:
+			oss << "intr=" << ::NTV2InterruptEnumString(unsigned(fArgs[0])) << " timeout=" << DEC(fArgs[1]) << "ms" << (fArgs[2] ? "" : " incoherent");
+			break;
+		case NTV2_TRACE_INTERRUPT_COUNT:
+			oss << "intr=" << ::NTV2InterruptEnumString(unsigned(fArgs[0])) << " count=" << DEC(fArgs[2]);
+			break;
+		case NTV2_TRACE_NUM_OPS:
+			break;
+	}
+	return oss.str();
+}
+
+ostream & NTV2DriverTraceRecord::Print (ostream & oss) const
+{
+	oss << "#" << fSequence << " thr=" << xHEX0N(fThreadID,16) << " " << ::NTV2DriverTraceOpToString(fOp)
+		<< " " << ArgsString() << " " << DEC(fDuration/1000) << "us" << (fSuccess ? "" : " FAILED");
+	return oss;
+}
+
+
+NTV2DriverTraceStats::NTV2DriverTraceStats (const NTV2DriverTraceOp inOp)
+	:	fOp				(inOp),
+		fCount			(0),
+		fNumFailures	(0),
+		fTotal			(0),
+		fP50			(0),
+		fP99			(0),
+		fMax			(0)
+{
+}
+
+ostream & NTV2DriverTraceStats::Print (ostream & oss) const
+{
+	oss << setw(20) << left << ::NTV2DriverTraceOpToString(fOp) << right << fixed << setprecision(1)
+		<< "  n=" << setw(7) << fCount << "  fail=" << setw(5) << fNumFailures
+		<< "  p50=" << setw(9) << double(fP50) / 1000.0 << "us"
+		<< "  p99=" << setw(9) << double(fP99) / 1000.0 << "us"
+		<< "  max=" << setw(9) << double(fMax) / 1000.0 << "us"
+		<< "  total=" << setw(10) << double(fTotal) / 1000.0 << "us" << endl;
+	oss.unsetf(ios::floatfield);
+	return oss;
+}
+
+
+//	A thread's ring is the shared NTV2SeqLockRing, tagged with its owning thread's ID
+struct NTV2DriverTrace::Ring : public NTV2SeqLockRing<NTV2DriverTraceRecord>
+{
+	Ring (const ULWord inCapacity, const uint64_t inOwner)
+		:	NTV2SeqLockRing<NTV2DriverTraceRecord>	(inCapacity),
+			fOwner	(inOwner)
+	{
+	}
+	uint64_t	fOwner;		///< @brief	Owning thread ID (or zero for the shared overflow ring)
+};
+
+
+NTV2DriverTrace::NTV2DriverTrace (const ULWord inCapacity)
+	:	mCapacity	(16)
+{
+	while (mCapacity < inCapacity  &&  mCapacity < 0x80000000)
+		mCapacity <<= 1;
+	for (size_t ndx(0);  ndx < size_t(kMaxRings);  ndx++)
+		mRings[ndx] = AJA_NULL;
+	mRings[kMaxRings] = new Ring(mCapacity, 0);
+}
+
+NTV2DriverTrace::~NTV2DriverTrace ()
+{
+	for (size_t ndx(0);  ndx <= size_t(kMaxRings);  ndx++)
+	{
+		delete mRings[ndx];
+		mRings[ndx] = AJA_NULL;
+	}
+}
+
+NTV2DriverTrace::Ring * NTV2DriverTrace::GetRing (void)
+{
+	//	Open addressing by thread ID:  the lookup is lock-free, and only a thread's first record takes the lock
+	const uint64_t	tid		(AJAThread::GetThreadId());
+	const size_t	start	(size_t((tid ^ (tid >> 17)) % uint64_t(kMaxRings)));
+	for (size_t probe(0);  probe < size_t(kMaxRings);  probe++)
+	{
+		const size_t ndx ((start + probe) % size_t(kMaxRings));
+		Ring * pRing (mRings[ndx]);
+		if (pRing)
+		{
+			if (pRing->fOwner == tid)
+				return pRing;
+			continue;
+		}
+		AJAAutoLock locker(&mLock);
+		if (!mRings[ndx])
+		{
+			pRing = new Ring(mCapacity, tid);
+			NTV2SLRBARRIER();
+			mRings[ndx] = pRing;
+			return pRing;
+		}
+		if (mRings[ndx]->fOwner == tid)
+			return mRings[ndx];
+		//	Another thread claimed it first -- keep probing
+	}
+	return mRings[kMaxRings];	//	Too many threads -- share the overflow ring
+}
+
+void NTV2DriverTrace::Record (const NTV2DriverTraceRecord & inRecord)
+{
+	GetRing()->Push(inRecord);	//	Only the overflow ring has more than one writer
+}
+
+void NTV2DriverTrace::Reset (void)
+{
+	for (size_t ndx(0);  ndx <= size_t(kMaxRings);  ndx++)
+		if (mRings[ndx])
+			mRings[ndx]->Reset();
+}
+
+ULWord NTV2DriverTrace::GetNumThreads (void) const
+{
+	ULWord result(0);
+	for (size_t ndx(0);  ndx < size_t(kMaxRings);  ndx++)
+		if (mRings[ndx])
+			result++;
+	return result;
+}
+
+static bool RecordStartsBefore (const NTV2DriverTraceRecord & inLHS, const NTV2DriverTraceRecord & inRHS)
+{
+	return inLHS.fStart < inRHS.fStart;
+}
+
+bool NTV2DriverTrace::GetRecords (NTV2DriverTraceRecords & outRecords) const
+{
+	outRecords.clear();
+	for (size_t ringNdx(0);  ringNdx <= size_t(kMaxRings);  ringNdx++)
+		if (mRings[ringNdx])
+			mRings[ringNdx]->CopyTo(outRecords);
+	std::stable_sort(outRecords.begin(), outRecords.end(), RecordStartsBefore);
+	return true;
+}
+
+bool NTV2DriverTrace::GetStats (const NTV2DriverTraceOp inOp, NTV2DriverTraceStats & outStats) const
+{
+	outStats = NTV2DriverTraceStats(inOp);
+	if (!NTV2_IS_VALID_TRACE_OP(inOp))
+		return false;
+	NTV2DriverTraceRecords records;
+	if (!GetRecords(records))
+		return false;
+	vector<uint64_t> durations;
+	for (NTV2DriverTraceRecords::const_iterator it(records.begin());  it != records.end();  ++it)
+		if (it->fOp == inOp)
+		{
+			durations.push_back(it->fDuration);
+			outStats.fTotal += it->fDuration;
+			if (!it->fSuccess)
+				outStats.fNumFailures++;
+		}
+	outStats.fCount = ULWord(durations.size());
+	if (durations.empty())
+		return true;
+	std::sort(durations.begin(), durations.end());
+	//	Nearest-rank percentiles
+	outStats.fP50 = durations.at((durations.size() * 50 + 99) / 100 - 1);
+	outStats.fP99 = durations.at((durations.size() * 99 + 99) / 100 - 1);
+	outStats.fMax = durations.back();
+	return true;
+}
+
+ostream & NTV2DriverTrace::Print (ostream & oss) const
+{
+	for (int op(0);  op < int(NTV2_TRACE_NUM_OPS);  op++)
+	{
+		NTV2DriverTraceStats stats;
+		if (GetStats(NTV2DriverTraceOp(op), stats)  &&  stats.fCount)
+			oss << stats;
+	}
+	return oss;
+}
+
+bool NTV2DriverTrace::WriteChromeTrace (ostream & oss) const
+{
+	NTV2DriverTraceRecords records;
+	if (!GetRecords(records))
+		return false;
+
+	//	Chrome trace-event format: times are in microseconds, one track per thread
+	typedef map<uint64_t, ULWord>	ThreadTrackMap;
+	ThreadTrackMap	tracks;
+	bool			needComma	(false);
+	oss << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << endl;
+	for (NTV2DriverTraceRecords::const_iterator it(records.begin());  it != records.end();  ++it)
+	{
+		const NTV2DriverTraceRecord & rec (*it);
+		ThreadTrackMap::const_iterator trackIt (tracks.find(rec.fThreadID));
+		if (trackIt == tracks.end())
+		{
+			const ULWord track (ULWord(tracks.size()) + 1);
+			trackIt = tracks.insert(ThreadTrackMap::value_type(rec.fThreadID, track)).first;
+			oss << (needComma ? ",\n" : "")
+				<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << DEC(track)
+				<< ",\"args\":{\"name\":\"Thread " << xHEX0N(rec.fThreadID,16) << "\"}}";
+			needComma = true;
+		}
+		oss << (needComma ? ",\n" : "")
+			<< "{\"name\":\"" << ::NTV2DriverTraceOpToString(rec.fOp) << "\",\"cat\":\"driver\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+			<< DEC(trackIt->second) << ",\"ts\":" << fixed << setprecision(3) << double(rec.fStart) / 1000.0
+			<< ",\"dur\":" << double(rec.fDuration) / 1000.0
+			<< ",\"args\":{\"seq\":" << rec.fSequence << ",\"args\":\"" << rec.ArgsString()
+			<< "\",\"ok\":" << (rec.fSuccess ? "true" : "false") << "}}";
+		needComma = true;
+	}
+	oss << endl << "]}" << endl;
+	oss.unsetf(ios::floatfield);
+	return oss.good();
+}
+
+bool NTV2DriverTrace::WriteChromeTrace (const string & inFilePath) const
+{
+	ofstream ofs(inFilePath.c_str(), ios::out | ios::trunc);
+	if (!ofs.is_open())
+		{DTFAIL("Unable to open '" << inFilePath << "' for writing");  return false;}
+	return WriteChromeTrace(ofs);
+}
+
+
+void NTV2DriverTraceScope::Begin (const NTV2DriverTraceOp inOp, const ULWord64 inArg0, const ULWord64 inArg1, const ULWord64 inArg2)
+{
+	mRecord.fOp = inOp;
+	mRecord.fArgs[0] = inArg0;
+	mRecord.fArgs[1] = inArg1;
+	mRecord.fArgs[2] = inArg2;
+	mRecord.fStart = AJATime::GetSystemNanoseconds();
+}
+
+void NTV2DriverTraceScope::End (void)
+{
+	const uint64_t now (AJATime::GetSystemNanoseconds());
+	mRecord.fDuration = now > mRecord.fStart ? now - mRecord.fStart : 0;
+	mRecord.fThreadID = AJAThread::GetThreadId();
+	if (mpArg2  &&  mRecord.fSuccess)
+		mRecord.fArgs[2] = ULWord64(*mpArg2);
+	mpTrace->Record(mRecord);
+}
@@ -208,6 +208,7 @@ bool CNTV2Card::LoadDynamicDevice (const NTV2DeviceID inDeviceID)
 	if (!BitstreamWrite (partialStream, false, true))
 		{DDFAIL("BitstreamWrite failed writing 'partial' bitstream for " << oldDevName);  return false;}
 
+	RefreshDeviceCapabilities();	//	Different firmware, different features
 	DDNOTE(oldDevName << " dynamically changed to '" << ::NTV2DeviceIDToString(inDeviceID) << "' (" << xHEX0N(inDeviceID,8) << ")");
 	return true;
 }	//	LoadDynamicDevice
@@ -0,0 +1,336 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2latencytimeline.cpp
+	@brief		Implements the NTV2LatencyTimeline class, and its NTV2LatencyRecord and NTV2LatencySummary helpers.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2latencytimeline.h"
+#include "ntv2utils.h"
+#include "ntv2seqlockring.hpp"
+#include "ajabase/system/systemtime.h"
+#include "ajabase/system/debug.h"
+#include "ajabase/common/common.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+#define LTFAIL(__x__)	AJA_sERROR	(AJA_DebugUnit_AutoCirculate, AJAFUNC << ": " << __x__)
+#define LTWARN(__x__)	AJA_sWARNING(AJA_DebugUnit_AutoCirculate, AJAFUNC << ": " << __x__)
+#define LTDBG(__x__)	AJA_sDEBUG	(AJA_DebugUnit_AutoCirculate, AJAFUNC << ": " << __x__)
+
+static const uint64_t	kNoSequence	(0xFFFFFFFFFFFFFFFFULL);
+
+
+string NTV2LatencyEventToString (const NTV2LatencyEvent inEvent)
+{
+	switch (inEvent)
+	{
+		case NTV2_LATENCY_VBI:			return "VBI";
+		case NTV2_LATENCY_SUBMIT:		return "Submit";
+		case NTV2_LATENCY_DMA_START:	return "DMAStart";
+		case NTV2_LATENCY_DMA_END:		return "DMAEnd";
+		case NTV2_LATENCY_ANC_DONE:		return "AncDone";
+		case NTV2_LATENCY_RETURN:		return "Return";
+		case NTV2_LATENCY_NUM_EVENTS:	break;
+	}
+	return "";
+}
+
+string NTV2LatencyKindToString (const NTV2LatencyKind inKind)
+{
+	switch (inKind)
+	{
+		case NTV2_LATENCY_KIND_AC_CAPTURE:	return "ACCapture";
+		case NTV2_LATENCY_KIND_AC_PLAYOUT:	return "ACPlayout";
+		case NTV2_LATENCY_KIND_DMA_READ:	return "DMARead";
+		case NTV2_LATENCY_KIND_DMA_WRITE:	return "DMAWrite";
+		case NTV2_LATENCY_KIND_INVALID:		break;
+	}
+	return "";
+}
+
+
+NTV2LatencyRecord::NTV2LatencyRecord (const NTV2LatencyKind inKind, const NTV2Channel inChannel)
+	:	fSequence				(kNoSequence),
+		fKind					(inKind),
+		fChannel				(inChannel),
+		fFrame					(0xFFFFFFFF),
+		fByteCount				(0),
+		fSuccess				(false),
+		fFrameTime				(0),
+		fCurrentTime			(0),
+		fAudioClockTimeStamp	(0),
+		fCurrentFrame			(0),
+		fDroppedFrames			(0)
+{
+	for (int ndx(0);  ndx < NTV2_LATENCY_NUM_EVENTS;  ndx++)
+		fTimes[ndx] = 0;
+}
+
+void NTV2LatencyRecord::Stamp (const NTV2LatencyEvent inEvent)
+{
+	if (NTV2_IS_VALID_LATENCY_EVENT(inEvent))
+		fTimes[inEvent] = AJATime::GetSystemNanoseconds();
+}
+
+uint64_t NTV2LatencyRecord::Now (void)
+{
+	return AJATime::GetSystemNanoseconds();
+}
+
+void NTV2LatencyRecord::SetFrameStamp (const FRAME_STAMP & inFrameStamp)
+{
+	fFrameTime				= inFrameStamp.acFrameTime;
+	fCurrentTime			= inFrameStamp.acCurrentTime;
+	fAudioClockTimeStamp	= inFrameStamp.acAudioClockTimeStamp;
+	fCurrentFrame			= inFrameStamp.acCurrentFrame;
+	if (fFrameTime > 0  &&  fCurrentTime >= fFrameTime  &&  fTimes[NTV2_LATENCY_DMA_END])
+	{
+		const uint64_t	agoNanosecs	(uint64_t(fCurrentTime - fFrameTime) * 100ULL);
+		if (agoNanosecs < fTimes[NTV2_LATENCY_DMA_END])
+			fTimes[NTV2_LATENCY_VBI] = fTimes[NTV2_LATENCY_DMA_END] - agoNanosecs;
+	}
+}
+
+int64_t NTV2LatencyRecord::Elapsed (const NTV2LatencyEvent inFrom, const NTV2LatencyEvent inTo) const
+{
+	if (!NTV2_IS_VALID_LATENCY_EVENT(inFrom)  ||  !NTV2_IS_VALID_LATENCY_EVENT(inTo))
+		return -1;
+	if (!fTimes[inFrom]  ||  !fTimes[inTo]  ||  fTimes[inTo] < fTimes[inFrom])
+		return -1;
+	return int64_t(fTimes[inTo] - fTimes[inFrom]);
+}
+
+ostream & NTV2LatencyRecord::Print (ostream & oss) const
+{
+	oss << "#" << fSequence << " " << ::NTV2LatencyKindToString(fKind);
+	if (NTV2_IS_VALID_CHANNEL(fChannel))
+		oss << " Ch" << DEC(fChannel+1);
+	oss << " frm=" << DEC(fFrame) << " bytes=" << DEC(fByteCount) << (fSuccess ? "" : " FAILED");
+	for (int ndx(NTV2_LATENCY_SUBMIT);  ndx < NTV2_LATENCY_NUM_EVENTS;  ndx++)
+	{
+		const int64_t elapsed (Elapsed(NTV2LatencyEvent(ndx-1), NTV2LatencyEvent(ndx)));
+		if (elapsed >= 0)
+			oss << " " << ::NTV2LatencyEventToString(NTV2LatencyEvent(ndx)) << "=+" << DEC(elapsed/1000) << "us";
+	}
+	return oss;
+}
+
+
+NTV2LatencyStage::NTV2LatencyStage (const NTV2LatencyEvent inFrom, const NTV2LatencyEvent inTo)
+	:	fFrom	(inFrom),
+		fTo		(inTo),
+		fCount	(0),
+		fP50	(0),
+		fP99	(0),
+		fMax	(0)
+{
+}
+
+ostream & NTV2LatencySummary::Print (ostream & oss) const
+{
+	oss << (NTV2_IS_VALID_CHANNEL(fChannel) ? string("Ch") + aja::to_string(int(fChannel+1)) : string("DMA"))
+		<< ": " << DEC(fNumRecords) << " record(s), " << DEC(fNumFailures) << " failure(s)" << endl;
+	for (NTV2LatencyStages::const_iterator it(fStages.begin());  it != fStages.end();  ++it)
+	{
+		if (!it->fCount)
+			continue;
+		const string stageName (::NTV2LatencyEventToString(it->fFrom) + "->" + ::NTV2LatencyEventToString(it->fTo));
+		oss << "  " << setw(18) << left << stageName << right << fixed << setprecision(1)
+			<< "  n=" << setw(6) << it->fCount
+			<< "  p50=" << setw(9) << double(it->fP50) / 1000.0 << "us"
+			<< "  p99=" << setw(9) << double(it->fP99) / 1000.0 << "us"
+			<< "  max=" << setw(9) << double(it->fMax) / 1000.0 << "us" << endl;
+	}
+	oss.unsetf(ios::floatfield);
+	return oss;
+}
+
+
+struct NTV2LatencyTimeline::Ring : public NTV2SeqLockRing<NTV2LatencyRecord>
+{
+	explicit Ring (const ULWord inCapacity)	:	NTV2SeqLockRing<NTV2LatencyRecord>(inCapacity)	{}
+};
+
+
+NTV2LatencyTimeline::NTV2LatencyTimeline (const ULWord inCapacity)
+	:	mCapacity	(16)
+{
+	while (mCapacity < inCapacity  &&  mCapacity < 0x80000000)
+		mCapacity <<= 1;
+	for (size_t ndx(0);  ndx <= size_t(NTV2_MAX_NUM_CHANNELS);  ndx++)
+		mRings[ndx] = new Ring(mCapacity);
+}
+
+NTV2LatencyTimeline::~NTV2LatencyTimeline ()
+{
+	for (size_t ndx(0);  ndx <= size_t(NTV2_MAX_NUM_CHANNELS);  ndx++)
+	{
+		delete mRings[ndx];
+		mRings[ndx] = AJA_NULL;
+	}
+}
+
+NTV2LatencyTimeline::Ring * NTV2LatencyTimeline::GetRing (const NTV2Channel inChannel) const
+{
+	return mRings[NTV2_IS_VALID_CHANNEL(inChannel) ? size_t(inChannel) : size_t(NTV2_MAX_NUM_CHANNELS)];
+}
+
+void NTV2LatencyTimeline::Record (const NTV2LatencyRecord & inRecord)
+{
+	GetRing(inRecord.fChannel)->Push(inRecord);
+}
+
+void NTV2LatencyTimeline::Reset (void)
+{
+	for (size_t ndx(0);  ndx <= size_t(NTV2_MAX_NUM_CHANNELS);  ndx++)
+		mRings[ndx]->Reset();
+}
+
+bool NTV2LatencyTimeline::GetRecords (const NTV2Channel inChannel, NTV2LatencyRecords & outRecords) const
+{
+	outRecords.clear();
+	outRecords.reserve(size_t(mCapacity));
+	GetRing(inChannel)->CopyTo(outRecords);
+	return true;
+}
+
+NTV2LatencyStages NTV2LatencyTimeline::DefaultStages (void)
+{
+	NTV2LatencyStages result;
+	for (int ndx(NTV2_LATENCY_SUBMIT);  ndx < NTV2_LATENCY_NUM_EVENTS;  ndx++)
+		result.push_back(NTV2LatencyStage(NTV2LatencyEvent(ndx-1), NTV2LatencyEvent(ndx)));
+	result.push_back(NTV2LatencyStage(NTV2_LATENCY_SUBMIT, NTV2_LATENCY_RETURN));
+	result.push_back(NTV2LatencyStage(NTV2_LATENCY_VBI, NTV2_LATENCY_RETURN));
+	return result;
+}
+
+bool NTV2LatencyTimeline::GetSummary (const NTV2Channel inChannel, NTV2LatencySummary & outSummary) const
+{
+	NTV2LatencyRecords records;
+	outSummary = NTV2LatencySummary();
+	outSummary.fChannel = NTV2_IS_VALID_CHANNEL(inChannel) ? inChannel : NTV2_CHANNEL_INVALID;
+	outSummary.fStages = DefaultStages();
+	if (!GetRecords(inChannel, records))
+		return false;
+	outSummary.fNumRecords = ULWord(records.size());
+
+	vector<uint64_t> values;
+	values.reserve(records.size());
+	for (NTV2LatencyRecords::const_iterator it(records.begin());  it != records.end();  ++it)
+		if (!it->fSuccess)
+			outSummary.fNumFailures++;
+	for (NTV2LatencyStages::iterator stageIt(outSummary.fStages.begin());  stageIt != outSummary.fStages.end();  ++stageIt)
+	{
+		values.clear();
+		for (NTV2LatencyRecords::const_iterator it(records.begin());  it != records.end();  ++it)
+		{
+			const int64_t elapsed (it->Elapsed(stageIt->fFrom, stageIt->fTo));
+			if (elapsed >= 0)
+				values.push_back(uint64_t(elapsed));
+		}
+		stageIt->fCount = ULWord(values.size());
+		if (values.empty())
+			continue;
+		std::sort(values.begin(), values.end());
+		//	Nearest-rank percentiles
+		stageIt->fP50 = values.at((values.size() * 50 + 99) / 100 - 1);
+		stageIt->fP99 = values.at((values.size() * 99 + 99) / 100 - 1);
+		stageIt->fMax = values.back();
+	}
+	return true;
+}
+
+ostream & NTV2LatencyTimeline::Print (ostream & oss) const
+{
+	for (int ndx(0);  ndx <= int(NTV2_MAX_NUM_CHANNELS);  ndx++)
+	{
+		NTV2LatencySummary summary;
+		if (GetSummary(NTV2Channel(ndx), summary)  &&  summary.fNumRecords)
+			oss << summary;
+	}
+	return oss;
+}
+
+bool NTV2LatencyTimeline::WriteChromeTrace (ostream & oss) const
+{
+	//	Chrome trace-event format: times are in microseconds
+	bool	needComma	(false);
+	oss << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << endl;
+	for (int ndx(0);  ndx <= int(NTV2_MAX_NUM_CHANNELS);  ndx++)
+	{
+		const NTV2Channel	chan	= NTV2Channel(ndx);
+		NTV2LatencyRecords	records;
+		if (!GetRecords(chan, records)  ||  records.empty())
+			continue;
+		const string trackName (NTV2_IS_VALID_CHANNEL(chan) ? string("Ch") + aja::to_string(ndx+1) : string("DMA"));
+		oss << (needComma ? ",\n" : "")
+			<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << DEC(ndx+1)
+			<< ",\"args\":{\"name\":\"" << trackName << "\"}}";
+		needComma = true;
+		for (NTV2LatencyRecords::const_iterator it(records.begin());  it != records.end();  ++it)
+		{
+			const NTV2LatencyRecord & rec (*it);
+			if (rec.fTimes[NTV2_LATENCY_VBI])
+				oss << ",\n{\"name\":\"VBI\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":" << DEC(ndx+1)
+					<< ",\"ts\":" << fixed << setprecision(3) << double(rec.fTimes[NTV2_LATENCY_VBI]) / 1000.0
+					<< ",\"args\":{\"seq\":" << rec.fSequence << ",\"frame\":" << DEC(rec.fFrame) << "}}";
+			for (int evt(NTV2_LATENCY_SUBMIT);  evt < NTV2_LATENCY_NUM_EVENTS;  evt++)
+			{
+				if (evt == NTV2_LATENCY_SUBMIT)
+					continue;	//	VBI->Submit is shown as the VBI instant event (above)
+				const int64_t elapsed (rec.Elapsed(NTV2LatencyEvent(evt-1), NTV2LatencyEvent(evt)));
+				if (elapsed < 0)
+					continue;
+				oss << ",\n{\"name\":\"" << ::NTV2LatencyEventToString(NTV2LatencyEvent(evt-1)) << "->"
+					<< ::NTV2LatencyEventToString(NTV2LatencyEvent(evt)) << "\",\"cat\":\"" << ::NTV2LatencyKindToString(rec.fKind)
+					<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << DEC(ndx+1)
+					<< ",\"ts\":" << fixed << setprecision(3) << double(rec.fTimes[evt-1]) / 1000.0
+					<< ",\"dur\":" << double(elapsed) / 1000.0
+					<< ",\"args\":{\"seq\":" << rec.fSequence << ",\"frame\":" << DEC(rec.fFrame)
+					<< ",\"bytes\":" << DEC(rec.fByteCount) << ",\"ok\":" << (rec.fSuccess ? "true" : "false")
+					<< ",\"acFrameTime\":" << rec.fFrameTime << ",\"acAudioClockTimeStamp\":" << rec.fAudioClockTimeStamp
+					<< ",\"acCurrentFrame\":" << DEC(rec.fCurrentFrame) << ",\"dropped\":" << DEC(rec.fDroppedFrames) << "}}";
+			}
+		}
+	}
+	oss << endl << "]}" << endl;
+	oss.unsetf(ios::floatfield);
+	return oss.good();
+}
+
+bool NTV2LatencyTimeline::WriteChromeTrace (const string & inFilePath) const
+{
+	ofstream ofs(inFilePath.c_str(), ios::out | ios::trunc);
+	if (!ofs.is_open())
+		{LTFAIL("Unable to open '" << inFilePath << "' for writing");  return false;}
+	return WriteChromeTrace(ofs);
+}
+
+
+NTV2LatencyScope::NTV2LatencyScope (NTV2LatencyTimeline * pInTimeline, const bool inIsRead, const ULWord inFrame, const ULWord inByteCount)
+	:	mpTimeline	(pInTimeline),
+		mIsRead		(inIsRead),
+		mSuccess	(false),
+		mFrame		(inFrame),
+		mByteCount	(inByteCount),
+		mStartTime	(pInTimeline ? NTV2LatencyRecord::Now() : 0)
+{
+}
+
+NTV2LatencyScope::~NTV2LatencyScope ()
+{
+	if (!mpTimeline)
+		return;
+	NTV2LatencyRecord record (mIsRead ? NTV2_LATENCY_KIND_DMA_READ : NTV2_LATENCY_KIND_DMA_WRITE);
+	record.fFrame = mFrame;
+	record.fByteCount = mByteCount;
+	record.fSuccess = mSuccess;
+	record.fTimes[NTV2_LATENCY_SUBMIT] = record.fTimes[NTV2_LATENCY_DMA_START] = mStartTime;
+	record.Stamp(NTV2_LATENCY_DMA_END);
+	record.fTimes[NTV2_LATENCY_RETURN] = record.fTimes[NTV2_LATENCY_DMA_END];
+	mpTimeline->Record(record);
+}
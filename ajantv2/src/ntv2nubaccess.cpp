@@ -7,6 +7,8 @@
 #include "ajatypes.h"
 #include "ntv2utils.h"
 #include "ntv2nubaccess.h"
+#include "ntv2simulateddevice.h"
+#include "ntv2devicebroker.h"
 #include "ntv2publicinterface.h"
 #include "ntv2version.h"
 #include "ajabase/system/debug.h"
@@ -1972,6 +1974,11 @@ bool NTV2RPCClientAPI::NTV2WaitForInterruptRemote (const INTERRUPT_ENUMS eInterr
 	return false;	//	UNIMPLEMENTED
 }
 
+bool NTV2RPCClientAPI::NTV2WaitForAnyInterruptRemote (NTV2InterruptWaitSet & inOutWaitSet, const ULWord timeOutMs)
+{	(void) inOutWaitSet; (void) timeOutMs;
+	return false;	//	UNIMPLEMENTED
+}
+
 #if !defined(NTV2_DEPRECATE_16_3)
 	bool NTV2RPCClientAPI::NTV2DriverGetBitFileInformationRemote (BITFILE_INFO_STRUCT & bitFileInfo, const NTV2BitFileType bitFileType)
 	{	(void) bitFileType;
@@ -2036,6 +2043,11 @@ bool NTV2RPCClientAPI::NTV2GetSupportedRemote (const ULWord inEnumsID, ULWordSet
 	return false;	//	UNIMPLEMENTED
 }
 
+bool NTV2RPCClientAPI::NTV2GetDeviceProfileRemote (NTV2DeviceProfile & outProfile)
+{	(void) outProfile;
+	return false;	//	UNIMPLEMENTED
+}
+
 bool NTV2RPCClientAPI::NTV2OpenRemote (void)
 {
 	return false;	//	UNIMPLEMENTED
@@ -2050,6 +2062,12 @@ bool NTV2RPCClientAPI::NTV2CloseRemote (void)
 
 NTV2RPCClientAPI * NTV2RPCClientAPI::CreateClient (NTV2ConnectParams & params)	//	CLASS METHOD
 {
+	if (params.valueForKey(kConnectParamScheme) == kLegalSchemeNTV2Sim)
+		return NTV2SimulatedDevice::Create(params);	//	Built-in -- no plugin to load
+	if (params.valueForKey(kConnectParamScheme) == kLegalSchemeNTV2TCP)
+		return NTV2TCPClient::Create(params);		//	Built-in -- no plugin to load
+	if (params.valueForKey(kConnectParamScheme) == kLegalSchemeNTV2Broker)
+		return NTV2BrokerClient::Create(params);	//	Built-in -- no plugin to load
 #if defined(NTV2_PREVENT_PLUGIN_LOAD)
 	return AJA_NULL;
 #else
@@ -3418,6 +3418,206 @@ NTV2AudioSystemSet NTV2MakeAudioSystemSet (const NTV2AudioSystem inFirstAudioSys
 	return result;
 }
 
+
+NTV2InterruptWaitSet::NTV2InterruptWaitSet ()
+{
+	Clear();
+}
+
+NTV2InterruptWaitSet & NTV2InterruptWaitSet::Add (const INTERRUPT_ENUMS inInterrupt)
+{
+	mMask |= Bit(inInterrupt);
+	return *this;
+}
+
+NTV2InterruptWaitSet & NTV2InterruptWaitSet::Remove (const INTERRUPT_ENUMS inInterrupt)
+{
+	const ULWord64 bit (Bit(inInterrupt));
+	mMask &= ~bit;
+	mFiredMask &= ~bit;
+	mBaselineMask &= ~bit;
+	return *this;
+}
+
+void NTV2InterruptWaitSet::Clear (void)
+{
+	mMask = mFiredMask = mBaselineMask = 0;
+	::memset(mCounts, 0, sizeof(mCounts));
+	::memset(mTimes, 0, sizeof(mTimes));
+}
+
+vector<INTERRUPT_ENUMS> NTV2InterruptWaitSet::GetSources (void) const
+{
+	vector<INTERRUPT_ENUMS> result;
+	for (INTERRUPT_ENUMS intr(eOutput1);  intr < eNumInterruptTypes;  intr = INTERRUPT_ENUMS(intr+1))
+		if (Contains(intr))
+			result.push_back(intr);
+	return result;
+}
+
+vector<INTERRUPT_ENUMS> NTV2InterruptWaitSet::GetFired (void) const
+{
+	vector<INTERRUPT_ENUMS> result;
+	for (INTERRUPT_ENUMS intr(eOutput1);  intr < eNumInterruptTypes;  intr = INTERRUPT_ENUMS(intr+1))
+		if (HasFired(intr))
+			result.push_back(intr);
+	return result;
+}
+
+ULWord64 NTV2InterruptWaitSet::GetCount (const INTERRUPT_ENUMS inInterrupt) const
+{
+	return HasBaseline(inInterrupt) ? mCounts[inInterrupt] : 0;
+}
+
+ULWord64 NTV2InterruptWaitSet::GetTime (const INTERRUPT_ENUMS inInterrupt) const
+{
+	return HasBaseline(inInterrupt) ? mTimes[inInterrupt] : 0;
+}
+
+void NTV2InterruptWaitSet::StartWait (void)
+{
+	mFiredMask = 0;
+}
+
+bool NTV2InterruptWaitSet::SetResult (const INTERRUPT_ENUMS inInterrupt, const ULWord64 inCount, const ULWord64 inTime)
+{
+	const ULWord64 bit (Bit(inInterrupt));
+	if (!bit)
+		return false;
+	const bool fired (HasBaseline(inInterrupt)  &&  mCounts[inInterrupt] != inCount);
+	mCounts[inInterrupt] = inCount;
+	if (inTime)
+		mTimes[inInterrupt] = inTime;
+	mBaselineMask |= bit;
+	if (fired)
+		mFiredMask |= bit;
+	return fired;
+}
+
+ostream & operator << (ostream & oss, const NTV2InterruptWaitSet & inObj)
+{
+	const vector<INTERRUPT_ENUMS> sources (inObj.GetSources());
+	for (size_t ndx(0);  ndx < sources.size();  ndx++)
+	{
+		const INTERRUPT_ENUMS intr (sources.at(ndx));
+		oss << (ndx ? ", " : "") << ::NTV2InterruptEnumToString(intr);
+		if (inObj.HasBaseline(intr))
+			oss << " count=" << DEC(inObj.GetCount(intr)) << " time=" << DEC(inObj.GetTime(intr));
+		if (inObj.HasFired(intr))
+			oss << " FIRED";
+	}
+	return oss;
+}
+
+NTV2InterruptSnapshot::NTV2InterruptSnapshot ()
+{
+	Clear();
+}
+
+NTV2InterruptSnapshot & NTV2InterruptSnapshot::AddRegister (const ULWord inRegNum)
+{
+	if (mRegNums.size() < NTV2_INTERRUPT_SNAPSHOT_MAX_REGISTERS)
+		mRegNums.insert(inRegNum);
+	return *this;
+}
+
+NTV2InterruptSnapshot & NTV2InterruptSnapshot::AddRegisters (const NTV2RegNumSet & inRegNums)
+{
+	for (NTV2RegNumSetConstIter it(inRegNums.begin());  it != inRegNums.end();  ++it)
+		AddRegister(*it);
+	return *this;
+}
+
+NTV2InterruptSnapshot & NTV2InterruptSnapshot::AddAutoCirculate (const NTV2Crosspoint inCrosspoint)
+{
+	if (NTV2_IS_VALID_NTV2CROSSPOINT(inCrosspoint)  &&  mCrosspoints.size() < NTV2_INTERRUPT_SNAPSHOT_MAX_AUTOCIRCULATE)
+		mCrosspoints.insert(inCrosspoint);
+	return *this;
+}
+
+void NTV2InterruptSnapshot::Clear (void)
+{
+	mRegNums.clear();
+	mCrosspoints.clear();
+	StartCapture(eNumInterruptTypes);
+}
+
+bool NTV2InterruptSnapshot::GetRegisterValue (const ULWord inRegNum, ULWord & outValue) const
+{
+	NTV2RegValueMapConstIter it (mValues.find(inRegNum));
+	if (it == mValues.end())
+		return false;
+	outValue = it->second;
+	return true;
+}
+
+bool NTV2InterruptSnapshot::GetAutoCirculateStatus (const NTV2Crosspoint inCrosspoint, AUTOCIRCULATE_STATUS & outStatus) const
+{
+	ACStatusMap::const_iterator it (mStatuses.find(inCrosspoint));
+	if (it == mStatuses.end())
+		return false;
+	outStatus = it->second;
+	return true;
+}
+
+void NTV2InterruptSnapshot::StartCapture (const INTERRUPT_ENUMS inInterrupt)
+{
+	mValues.clear();
+	mStatuses.clear();
+	mInterrupt = inInterrupt;
+	mCount = mTime = 0;
+	mCoherent = false;
+}
+
+void NTV2InterruptSnapshot::SetRegisterValue (const ULWord inRegNum, const ULWord inValue)
+{
+	if (mRegNums.find(inRegNum) != mRegNums.end())
+		mValues[inRegNum] = inValue;
+}
+
+bool NTV2InterruptSnapshot::SetAutoCirculateStatus (const AUTOCIRCULATE_STATUS & inStatus)
+{
+	if (mCrosspoints.find(inStatus.acCrosspoint) == mCrosspoints.end())
+		return false;
+	mStatuses[inStatus.acCrosspoint] = inStatus;
+	return true;
+}
+
+void NTV2InterruptSnapshot::SetInterrupt (const ULWord64 inCount, const ULWord64 inTime, const bool inCoherent)
+{
+	mCount = inCount;
+	mTime = inTime;
+	mCoherent = inCoherent;
+}
+
+ostream & operator << (ostream & oss, const NTV2InterruptSnapshot & inObj)
+{
+	oss << ::NTV2InterruptEnumToString(inObj.GetInterrupt()) << " count=" << DEC(inObj.GetInterruptCount())
+		<< " time=" << DEC(inObj.GetInterruptTime()) << (inObj.IsCoherent() ? "" : " INCOHERENT");
+	const NTV2RegNumSet & regNums (inObj.GetRegisters());
+	for (NTV2RegNumSetConstIter it(regNums.begin());  it != regNums.end();  ++it)
+	{
+		ULWord value (0);
+		oss << " reg" << DEC(*it) << "=";
+		if (inObj.GetRegisterValue(*it, value))
+			oss << xHEX0N(value,8);
+		else
+			oss << "?";
+	}
+	const NTV2CrosspointSet & crosspoints (inObj.GetAutoCirculates());
+	for (NTV2CrosspointSet::const_iterator it(crosspoints.begin());  it != crosspoints.end();  ++it)
+	{
+		AUTOCIRCULATE_STATUS acStatus;
+		oss << " " << ::NTV2CrosspointToString(*it) << "=";
+		if (inObj.GetAutoCirculateStatus(*it, acStatus))
+			oss << ::NTV2AutoCirculateStateToString(acStatus.acState) << " frm=" << DEC(acStatus.acActiveFrame)
+				<< " proc=" << DEC(acStatus.acFramesProcessed) << " drop=" << DEC(acStatus.acFramesDropped);
+		else
+			oss << "?";
+	}
+	return oss;
+}
+
 NTV2RegNumSet GetRegisterNumbers (const NTV2RegReads & inRegInfos)
 {
 	NTV2RegNumSet result;
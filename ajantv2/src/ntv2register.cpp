@@ -4586,6 +4586,23 @@ bool CNTV2Card::WriteRegisters (const NTV2RegisterWrites & inRegWrites)
 		return false;		//	Device not open!
 	if (inRegWrites.empty())
 		return true;		//	Nothing to do!
+	if (RegWriteTxnIsOpen())
+	{	//	Hold them in the open register write transaction...
+		for (NTV2RegisterWritesConstIter it(inRegWrites.begin());  it != inRegWrites.end();  ++it)
+			RegWriteTxnIntercept(it->registerNumber, it->registerValue, it->registerMask, it->registerShift);
+		return true;
+	}
+	if (inRegWrites.size() > NTV2_MAX_NUM_SETREGS)
+	{	//	Drivers reject bigger NTV2SetRegisters messages, so send them in order, in as few messages as possible...
+		bool result(true);
+		for (size_t ndx(0);  ndx < inRegWrites.size();  ndx += NTV2_MAX_NUM_SETREGS)
+		{
+			const size_t endNdx (inRegWrites.size() - ndx > NTV2_MAX_NUM_SETREGS  ?  ndx + NTV2_MAX_NUM_SETREGS  :  inRegWrites.size());
+			if (!WriteRegisters(NTV2RegisterWrites(inRegWrites.begin() + ptrdiff_t(ndx), inRegWrites.begin() + ptrdiff_t(endNdx))))
+				result = false;
+		}
+		return result;
+	}
 
 	bool				result(false);
 	NTV2SetRegisters	setRegsParams(inRegWrites);
@@ -4601,12 +4618,53 @@ bool CNTV2Card::WriteRegisters (const NTV2RegisterWrites & inRegWrites)
 				pBadNdxs[setRegsParams.mOutNumFailures++] = UWord(ndx);
 		result = true;
 	}
+	else if (mpRegCache)
+	{	//	Update the shadow register cache (the fallback above did so via WriteRegister)
+		const NTV2RegInfo *	pRegInfos = setRegsParams.mInRegInfos;
+		const UWord *		pBadNdxs = setRegsParams.mOutBadRegIndexes;
+		NTV2RegNumSet		badRegs;
+		for (ULWord ndx(0);  ndx < setRegsParams.mOutNumFailures;  ndx++)
+			badRegs.insert(pRegInfos[pBadNdxs[ndx]].registerNumber);
+		for (NTV2RegisterWritesConstIter it(inRegWrites.begin());  it != inRegWrites.end();  ++it)
+			RegCacheWriteThrough(badRegs.find(it->registerNumber) == badRegs.end(), it->registerNumber, it->registerValue, it->registerMask, it->registerShift);
+	}
 	if (result	&&	setRegsParams.mInNumRegisters  &&  setRegsParams.mOutNumFailures)
 		result = false; //	fail if any writes failed
 	if (!result)	CVIDFAIL("Failed: setRegsParams: " << setRegsParams);
 	return result;
 }
 
+bool CNTV2Card::BeginRegisterWrites (void)
+{
+	if (!_boardOpened)
+		return false;		//	Device not open!
+	return RegWriteTxnBegin();
+}
+
+bool CNTV2Card::CommitRegisterWrites (const bool inAtNextVBI, const NTV2Channel inChannel)
+{
+	NTV2RegisterWrites regWrites;
+	if (!RegWriteTxnEnd(true, regWrites))
+		return false;
+	if (regWrites.empty())
+		return true;	//	Nested, or nothing written
+	bool vbiOK (true);
+	if (inAtNextVBI)
+		if (!WaitForOutputVerticalInterrupt(inChannel))
+		{	//	Still send the writes -- they're out of the transaction now, and dropping them would be worse than mistiming them
+			CVIDFAIL("Output " << DEC(inChannel+1) << " VBI wait failed, sending " << DEC(regWrites.size()) << " register write(s) anyway");
+			vbiOK = false;
+		}
+	CVIDDBG(DEC(regWrites.size()) << " coalesced register write(s)" << (inAtNextVBI && vbiOK ? " after VBI" : ""));
+	return WriteRegisters(regWrites)  &&  vbiOK;
+}
+
+bool CNTV2Card::AbortRegisterWrites (void)
+{
+	NTV2RegisterWrites discards;
+	return RegWriteTxnEnd(false, discards);
+}
+
 bool CNTV2Card::BankSelectWriteRegister (const NTV2RegInfo & inBankSelect, const NTV2RegInfo & inRegInfo)
 {
 	NTV2BankSelGetSetRegs bankSelGetSetMsg (inBankSelect, inRegInfo, true);
@@ -0,0 +1,241 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2registerpreset.cpp
+	@brief		Implements the NTV2RegisterPreset class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2registerpreset.h"
+#include "ntv2nubtypes.h"
+#include "ntv2utils.h"
+#include "ajabase/system/debug.h"
+#include "ajabase/system/systemtime.h"
+#include <fstream>
+#include <iterator>
+
+using namespace std;
+using namespace ntv2nub;
+
+#define INSTP(_p_)			HEX0N(uint64_t(_p_),16)
+#define RPFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_DriverInterface, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define RPWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_DriverInterface, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define RPDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_DriverInterface, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+
+//	Binary file layout (all big-endian):	magic, version, device ID, number of recorded writes, number of writes,
+//											then per write:  register number, value, mask (ULWords), and shift (UByte)
+static const ULWord	kPresetMagic		(NTV2_FOURCC('N','T','R','P'));
+static const ULWord	kPresetVersion		(1);
+static const size_t	kPresetHeaderBytes	(5 * sizeof(ULWord));
+static const size_t	kPresetWriteBytes	(3 * sizeof(ULWord) + 1);
+
+
+//	Same rule as register write transactions:  only non-zero-mask writes to configuration registers can be merged
+static inline bool IsCollapsible (const NTV2RegInfo & inWrite)
+{
+	return inWrite.registerMask  &&  CNTV2DriverInterface::DefaultRegisterCacheClass(inWrite.registerNumber) == NTV2_REGCACHE_CONFIG;
+}
+
+
+NTV2RegisterPreset::NTV2RegisterPreset ()
+	:	mDeviceID		(DEVICE_ID_NOTFOUND),
+		mNumRecorded	(0),
+		mWrites			()
+{
+}
+
+void NTV2RegisterPreset::Clear (void)
+{
+	mDeviceID = DEVICE_ID_NOTFOUND;
+	mNumRecorded = 0;
+	mWrites.clear();
+}
+
+NTV2RegisterWrites NTV2RegisterPreset::Collapse (const NTV2RegisterWrites & inWrites)	//	CLASS METHOD
+{
+	typedef map<ULWord, size_t>	NdxMap;
+	NTV2RegisterWrites	result;
+	NdxMap				mergeNdxs;	//	Where to merge later writes to a given register
+	result.reserve(inWrites.size());
+	for (NTV2RegisterWritesConstIter it(inWrites.begin());  it != inWrites.end();  ++it)
+	{
+		if (!IsCollapsible(*it))
+		{	//	Keep it as-is, and don't merge any later write into one made before it (it may be a trigger)
+			result.push_back(*it);
+			mergeNdxs.clear();
+			continue;
+		}
+		const bool isVirtual (it->registerNumber >= VIRTUALREG_START);	//	Virtual registers ignore mask & shift
+		const ULWord mask (isVirtual ? 0xFFFFFFFF : it->registerMask);
+		const ULWord value (isVirtual ? it->registerValue : ((it->registerValue << it->registerShift) & mask));
+		NdxMap::const_iterator mergeIt (mergeNdxs.find(it->registerNumber));
+		if (mergeIt != mergeNdxs.end())
+		{
+			NTV2RegInfo & regInfo (result.at(mergeIt->second));
+			regInfo.registerValue = (regInfo.registerValue & ~mask) | value;
+			regInfo.registerMask |= mask;
+			continue;
+		}
+		mergeNdxs[it->registerNumber] = result.size();
+		result.push_back(NTV2RegInfo(it->registerNumber, value, mask, 0));
+	}
+	return result;
+}
+
+bool NTV2RegisterPreset::Compile (const NTV2RegisterWrites & inRecording, const NTV2DeviceID inDeviceID)
+{
+	Clear();
+	mWrites = Collapse(inRecording);
+	mNumRecorded = ULWord(inRecording.size());
+	mDeviceID = inDeviceID;
+	RPDBG(DEC(mNumRecorded) << " recorded write(s) collapsed into " << DEC(mWrites.size()));
+	return true;
+}
+
+bool NTV2RegisterPreset::CaptureLive (CNTV2Card & inDevice, CNTV2DeviceSnapshot & outLive) const
+{
+	NTV2RegNumSet regNums;
+	for (NTV2RegisterWritesConstIter it(mWrites.begin());  it != mWrites.end();  ++it)
+		if (IsCollapsible(*it))
+			regNums.insert(it->registerNumber);
+	return outLive.Capture(inDevice, regNums);	//	Also captures kRegBoardID
+}
+
+bool NTV2RegisterPreset::ComputeDelta (const CNTV2DeviceSnapshot & inLive, NTV2RegisterWrites & outDelta) const
+{
+	outDelta.clear();
+	outDelta.reserve(mWrites.size());
+	const NTV2RegisterValueMap & liveValues (inLive.GetRegisterValues());
+	for (NTV2RegisterWritesConstIter it(mWrites.begin());  it != mWrites.end();  ++it)
+	{
+		if (IsCollapsible(*it))
+		{
+			NTV2RegValueMapConstIter liveIt (liveValues.find(it->registerNumber));
+			if (liveIt != liveValues.end()  &&  (liveIt->second & it->registerMask) == (it->registerValue & it->registerMask))
+				continue;	//	No change
+		}
+		outDelta.push_back(*it);
+	}
+	return true;
+}
+
+bool NTV2RegisterPreset::Apply (CNTV2Card & inDevice, const bool inWaitForVBI, const NTV2Channel inVBIChannel, NTV2RegisterWrites * pOutDelta) const
+{
+	if (pOutDelta)
+		pOutDelta->clear();
+	if (!inDevice.IsOpen())
+		{RPFAIL("Device not open");  return false;}
+	if (mDeviceID != DEVICE_ID_NOTFOUND  &&  inDevice.GetDeviceID() != mDeviceID)
+		{RPFAIL("Preset for '" << ::NTV2DeviceIDToString(mDeviceID) << "' can't be applied to '" << inDevice.GetDisplayName() << "'");  return false;}
+	if (mWrites.empty())
+		return true;	//	Nothing to do
+
+	const uint64_t startTime (AJATime::GetSystemMicroseconds());
+	CNTV2DeviceSnapshot live;
+	NTV2RegisterWrites delta;
+	if (!CaptureLive(inDevice, live))
+		{RPFAIL("Failed to capture live registers from '" << inDevice.GetDisplayName() << "'");  return false;}
+	if (!ComputeDelta(live, delta))
+		return false;
+	if (pOutDelta)
+		*pOutDelta = delta;
+	if (delta.empty())
+		{RPDBG("'" << inDevice.GetDisplayName() << "' already matches");  return true;}
+	if (inWaitForVBI  &&  !inDevice.WaitForOutputVerticalInterrupt(inVBIChannel))
+		RPWARN("Output " << DEC(inVBIChannel+1) << " VBI wait failed -- writing anyway");
+	if (!inDevice.WriteRegisters(delta))
+		{RPFAIL("WriteRegisters failed for " << DEC(delta.size()) << " write(s) on '" << inDevice.GetDisplayName() << "'");  return false;}
+	RPDBG(DEC(delta.size()) << " of " << DEC(mWrites.size()) << " write(s) applied to '" << inDevice.GetDisplayName()
+			<< "' in " << DEC(AJATime::GetSystemMicroseconds() - startTime) << "us");
+	return true;
+}
+
+bool NTV2RegisterPreset::Serialize (NTV2_RPC_BLOB_TYPE & outBlob) const
+{
+	outBlob.clear();
+	outBlob.reserve(kPresetHeaderBytes + mWrites.size() * kPresetWriteBytes);
+	PUSHU32(kPresetMagic, outBlob);
+	PUSHU32(kPresetVersion, outBlob);
+	PUSHU32(ULWord(mDeviceID), outBlob);
+	PUSHU32(mNumRecorded, outBlob);
+	PUSHU32(ULWord(mWrites.size()), outBlob);
+	for (NTV2RegisterWritesConstIter it(mWrites.begin());  it != mWrites.end();  ++it)
+	{
+		PUSHU32(it->registerNumber, outBlob);
+		PUSHU32(it->registerValue, outBlob);
+		PUSHU32(it->registerMask, outBlob);
+		PUSHU8(UByte(it->registerShift), outBlob);
+	}
+	return true;
+}
+
+bool NTV2RegisterPreset::Deserialize (const NTV2_RPC_BLOB_TYPE & inBlob)
+{
+	ULWord magic(0), version(0), deviceID(0), numRecorded(0), numWrites(0);
+	size_t ndx(0);
+	if (inBlob.size() < kPresetHeaderBytes)
+		{RPFAIL("Blob too small: " << DEC(inBlob.size()) << " byte(s)");  return false;}
+	POPU32(magic, inBlob, ndx);
+	POPU32(version, inBlob, ndx);
+	POPU32(deviceID, inBlob, ndx);
+	POPU32(numRecorded, inBlob, ndx);
+	POPU32(numWrites, inBlob, ndx);
+	if (magic != kPresetMagic)
+		{RPFAIL("Bad magic " << xHEX0N(magic,8));  return false;}
+	if (version != kPresetVersion)
+		{RPFAIL("Unsupported version " << DEC(version));  return false;}
+	if (inBlob.size() != kPresetHeaderBytes + size_t(numWrites) * kPresetWriteBytes)
+		{RPFAIL(DEC(numWrites) << " write(s) expected, but blob has " << DEC(inBlob.size()) << " byte(s)");  return false;}
+
+	NTV2RegisterWrites writes;
+	writes.reserve(numWrites);
+	for (ULWord num(0);  num < numWrites;  num++)
+	{
+		NTV2RegInfo regInfo;
+		UByte shift(0);
+		POPU32(regInfo.registerNumber, inBlob, ndx);
+		POPU32(regInfo.registerValue, inBlob, ndx);
+		POPU32(regInfo.registerMask, inBlob, ndx);
+		POPU8(shift, inBlob, ndx);
+		if (shift > 31)
+			{RPFAIL("Write " << DEC(num) << " reg=" << DEC(regInfo.registerNumber) << " has bad shift " << DEC(shift));  return false;}
+		regInfo.registerShift = shift;
+		writes.push_back(regInfo);
+	}
+	mDeviceID = NTV2DeviceID(deviceID);
+	mNumRecorded = numRecorded;
+	mWrites = writes;
+	return true;
+}
+
+bool NTV2RegisterPreset::Save (const string & inFilePath) const
+{
+	NTV2_RPC_BLOB_TYPE blob;
+	if (!Serialize(blob))
+		return false;
+	ofstream ofs(inFilePath.c_str(), ios::out | ios::trunc | ios::binary);
+	if (!ofs.is_open())
+		{RPFAIL("Unable to open '" << inFilePath << "' for writing");  return false;}
+	ofs.write(reinterpret_cast<const char*>(&blob[0]), streamsize(blob.size()));
+	if (!ofs.good())
+		{RPFAIL("Failed writing " << DEC(blob.size()) << " byte(s) to '" << inFilePath << "'");  return false;}
+	return true;
+}
+
+bool NTV2RegisterPreset::Load (const string & inFilePath)
+{
+	ifstream ifs(inFilePath.c_str(), ios::in | ios::binary);
+	if (!ifs.is_open())
+		{RPFAIL("Unable to open '" << inFilePath << "' for reading");  return false;}
+	const NTV2_RPC_BLOB_TYPE blob ((istreambuf_iterator<char>(ifs)), istreambuf_iterator<char>());
+	if (!Deserialize(blob))
+		{RPFAIL("'" << inFilePath << "' isn't a valid register preset file");  return false;}
+	RPDBG(DEC(mWrites.size()) << " write(s) loaded from '" << inFilePath << "'");
+	return true;
+}
+
+ostream & operator << (ostream & oss, const NTV2RegisterPreset & inPreset)
+{
+	oss << DEC(inPreset.GetNumWrites()) << " write(s) (from " << DEC(inPreset.GetNumRecordedWrites()) << " recorded) for '"
+		<< (inPreset.GetDeviceID() == DEVICE_ID_NOTFOUND ? string("any device") : ::NTV2DeviceIDToString(inPreset.GetDeviceID())) << "'";
+	return oss;
+}
@@ -265,6 +265,78 @@ bool CNTV2Card::ApplySignalRoute (const NTV2XptConnections & inConnections, cons
 	return failures == 0;
 }
 
+bool CNTV2Card::ApplySignalRouteDelta (const CNTV2SignalRouter & inRouter, const bool inReplace)
+{
+	NTV2XptConnections current;
+	if (!GetConnections(current))
+		{ROUTEFAIL(GetDisplayName() << ": GetConnections failed");  return false;}
+	CNTV2SignalRouter currentRouter;
+	currentRouter.ResetFrom(current);
+	NTV2XptConnections newConns, changedConns, missingConns;
+	if (inRouter.Compare(currentRouter, newConns, changedConns, missingConns))
+		{ROUTEDBG(GetDisplayName() << ": Routing unchanged, nothing written");  return true;}
+
+	//	Compile the connections to be made (NTV2_XptBlack to disconnect)...
+	NTV2XptConnections toWrite;
+	for (NTV2XptConnectionsConstIter it(newConns.begin());  it != newConns.end();  ++it)
+		if (it->second != NTV2_XptBlack)		//	Already disconnected
+			toWrite.insert(*it);
+	for (NTV2XptConnectionsConstIter it(changedConns.begin());  it != changedConns.end();  ++it)
+		toWrite.insert(NTV2Connection(it->first, inRouter.GetConnectedOutput(it->first)));	//	changedConns has the current output xpts
+	if (inReplace)
+		for (NTV2XptConnectionsConstIter it(missingConns.begin());  it != missingConns.end();  ++it)
+			toWrite.insert(NTV2Connection(it->first, NTV2_XptBlack));
+
+	//	Validate every connection against the crosspoint connect ROM before writing anything...
+	if (IsSupported(kDeviceHasXptConnectROM))
+		for (NTV2XptConnectionsConstIter it(toWrite.begin());  it != toWrite.end();  ++it)
+		{
+			bool canConnect(true);
+			if (it->second != NTV2_XptBlack)
+				if (CanConnect(it->first, it->second, canConnect))	//	If answer can be trusted
+					if (!canConnect)
+						{ROUTEFAIL(GetDisplayName() << ": Unsupported route " << ::NTV2InputCrosspointIDToString(it->first) << " <== "
+									<< ::NTV2OutputCrosspointIDToString(it->second) << ", nothing written");  return false;}
+		}
+
+	//	Merge them into one masked write per crosspoint select register...
+	typedef map<ULWord, NTV2RegInfo>	RegWriteMap;
+	const ULWord	maxRegNum	(GetNumSupported(kDeviceGetMaxRegisterNumber));
+	RegWriteMap		regWrites;
+	for (NTV2XptConnectionsConstIter it(toWrite.begin());  it != toWrite.end();  ++it)
+	{
+		uint32_t regNum(0), ndx(0);
+		if (!CNTV2RegisterExpert::GetCrosspointSelectGroupRegisterInfo(it->first, regNum, ndx))
+			{ROUTEFAIL(GetDisplayName() << ": GetCrosspointSelectGroupRegisterInfo failed, inputXpt=" << DEC(it->first));  return false;}
+		if (!regNum  ||  regNum > maxRegNum  ||  ndx > 3)
+			{ROUTEFAIL(GetDisplayName() << ": Bad register " << DEC(regNum) << " or index " << DEC(ndx) << " for inputXpt " << ::NTV2InputCrosspointIDToString(it->first));  return false;}
+		RegWriteMap::iterator regIt (regWrites.find(regNum));
+		if (regIt == regWrites.end())
+			regIt = regWrites.insert(RegWriteMap::value_type(regNum, NTV2RegInfo(regNum, 0, 0, 0))).first;
+		regIt->second.registerValue |= (ULWord(it->second) << sShifts[ndx]) & sMasks[ndx];
+		regIt->second.registerMask |= sMasks[ndx];
+		if (LOGGING_ROUTING_CHANGES)
+			ROUTENOTE(GetDisplayName() << ": " << (it->second == NTV2_XptBlack ? "Disconnecting " : "Connecting ") << ::NTV2InputCrosspointIDToString(it->first)
+						<< " <== " << ::NTV2OutputCrosspointIDToString(it->second == NTV2_XptBlack ? currentRouter.GetConnectedOutput(it->first) : it->second));
+	}
+
+	NTV2RegisterWrites writes;
+	writes.reserve(regWrites.size());
+	for (RegWriteMap::const_iterator it(regWrites.begin());  it != regWrites.end();  ++it)
+		writes.push_back(it->second);
+	if (!WriteRegisters(writes))
+		{ROUTEFAIL(GetDisplayName() << ": WriteRegisters failed for " << DEC(writes.size()) << " routing register(s)");  return false;}
+	ROUTEDBG(GetDisplayName() << ": " << DEC(toWrite.size()) << " connection(s) changed with " << DEC(writes.size()) << " register write(s)");
+	return true;
+}
+
+bool CNTV2Card::ApplySignalRouteDelta (const NTV2XptConnections & inConnections, const bool inReplace)
+{
+	CNTV2SignalRouter router;
+	router.ResetFrom(inConnections);
+	return ApplySignalRouteDelta(router, inReplace);
+}
+
 bool CNTV2Card::RemoveConnections (const NTV2XptConnections & inConnections)
 {
 	unsigned failures(0);
@@ -0,0 +1,401 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2routesolver.cpp
+	@brief		Implements the NTV2RouteSolver class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2routesolver.h"
+#include "ntv2card.h"
+#include "ntv2utils.h"
+#include "ajabase/system/debug.h"
+#include "ajabase/system/lock.h"
+#include <algorithm>
+#include <deque>
+
+using namespace std;
+
+#define RSFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_RoutingGeneric, AJAFUNC << ": " << __x__)
+#define RSWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_RoutingGeneric, AJAFUNC << ": " << __x__)
+#define RSDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_RoutingGeneric, AJAFUNC << ": " << __x__)
+
+static inline bool IsRGBOutputXpt (const NTV2OutputXptID inOutputXpt)	{return (inOutputXpt & 0x80) != 0;}
+static inline UByte OutputXptLane (const NTV2OutputXptID inOutputXpt)	{return UByte(inOutputXpt & 0x7F);}	//	YUV & RGB flavors share a lane
+
+//	Key outputs carry a matte, not the widget's video
+static inline bool IsKeyOutputXpt (const NTV2OutputXptID inOutputXpt)
+{
+	switch (inOutputXpt)
+	{
+		case NTV2_XptCSC1KeyYUV:	case NTV2_XptCSC2KeyYUV:	case NTV2_XptCSC3KeyYUV:	case NTV2_XptCSC4KeyYUV:
+		case NTV2_XptCSC5KeyYUV:	case NTV2_XptCSC6KeyYUV:	case NTV2_XptCSC7KeyYUV:	case NTV2_XptCSC8KeyYUV:
+		case NTV2_XptMixer1KeyYUV:	case NTV2_XptMixer2KeyYUV:	case NTV2_XptMixer3KeyYUV:	case NTV2_XptMixer4KeyYUV:
+			return true;
+		default:
+			return false;
+	}
+}
+
+//	Only these widgets convert between YUV and RGB
+static inline bool CanConvertColor (const NTV2WidgetType inType)
+{
+	return inType == NTV2WidgetType_CSC  ||  inType == NTV2WidgetType_LUT  ||  inType == NTV2WidgetType_LUT3D;
+}
+
+
+//	One widget input in a device's routing graph, and the outputs the signal can leave its widget through
+struct RSHop
+{
+	NTV2InputXptID		input;
+	NTV2WidgetID		widget;
+	NTV2WidgetType		type;
+	NTV2OutputXptIDSet	outputs;
+};
+typedef vector<RSHop>							RSHops;
+typedef multimap<NTV2OutputXptID, size_t>		RSEdges;		//	Output ==> indexes of the hops it can feed
+typedef RSEdges::const_iterator					RSEdgesConstIter;
+typedef map<string, NTV2XptConnections>			RSSolutions;	//	Request key ==> route (empty if unsolvable)
+typedef RSSolutions::const_iterator				RSSolutionsConstIter;
+
+//	A device model's routing graph and solution cache
+struct RSGraph
+{
+	NTV2DeviceID		deviceID;
+	bool				fromROM;	//	True if edges came from the device's crosspoint connect ROM
+	NTV2WidgetIDSet		widgets;
+	NTV2OutputXptIDSet	outputs;	//	All outputs of all my widgets
+	RSHops				hops;		//	One per non-key input of my widgets
+	RSEdges				edges;
+	RSSolutions			solutions;
+};
+typedef map<ULWord64, RSGraph>	RSGraphs;	//	Keyed by device ID and fromROM
+
+static AJALock		gRSLock;
+static RSGraphs		gRSGraphs;
+
+static inline ULWord64 GraphKey (const NTV2DeviceID inDeviceID, const bool inFromROM)	{return (ULWord64(inDeviceID) << 1) | (inFromROM ? 1 : 0);}
+
+//	Builds the routing graph for the given device model. If pInROM is non-NULL, only its connections are legal.
+static bool BuildGraph (RSGraph & outGraph, const NTV2DeviceID inDeviceID, const NTV2PossibleConnections * pInROM)
+{
+	outGraph.deviceID = inDeviceID;
+	outGraph.fromROM = pInROM != AJA_NULL;
+	if (!CNTV2SignalRouter::GetWidgetIDs(inDeviceID, outGraph.widgets))
+		{RSFAIL("No widgets for '" << ::NTV2DeviceIDToString(inDeviceID) << "'");  return false;}
+
+	for (NTV2WidgetIDSetConstIter wgtIt(outGraph.widgets.begin());  wgtIt != outGraph.widgets.end();  ++wgtIt)
+	{
+		NTV2InputXptIDSet wgtInputs, inputs;
+		NTV2OutputXptIDSet wgtOutputs, outputs;
+		CNTV2SignalRouter::GetWidgetInputs(*wgtIt, wgtInputs);
+		CNTV2SignalRouter::GetWidgetOutputs(*wgtIt, wgtOutputs);
+		outGraph.outputs.insert(wgtOutputs.begin(), wgtOutputs.end());
+		for (NTV2InputXptIDSetConstIter it(wgtInputs.begin());  it != wgtInputs.end();  ++it)
+			if (!CNTV2SignalRouter::IsKeyInputXpt(*it))
+				inputs.insert(*it);
+		set<UByte> lanes;
+		for (NTV2OutputXptIDSetConstIter it(wgtOutputs.begin());  it != wgtOutputs.end();  ++it)
+			if (!IsKeyOutputXpt(*it))
+				{outputs.insert(*it);  lanes.insert(OutputXptLane(*it));}
+
+		//	Widgets with as many inputs as output lanes (425 muxes, dual-stream FrameStores, etc.) pass input N to lane N;
+		//	all others pass any input to any output
+		const bool perLane (inputs.size() > 1  &&  inputs.size() == lanes.size());
+		size_t inputNdx(0);
+		for (NTV2InputXptIDSetConstIter inIt(inputs.begin());  inIt != inputs.end();  ++inIt, inputNdx++)
+		{
+			RSHop hop;
+			hop.input = *inIt;
+			hop.widget = *wgtIt;
+			hop.type = CNTV2SignalRouter::WidgetIDToType(*wgtIt);
+			set<UByte>::const_iterator laneIt(lanes.begin());
+			std::advance(laneIt, perLane ? inputNdx : 0);
+			for (NTV2OutputXptIDSetConstIter outIt(outputs.begin());  outIt != outputs.end();  ++outIt)
+				if (!perLane  ||  OutputXptLane(*outIt) == *laneIt)
+					hop.outputs.insert(*outIt);
+			outGraph.hops.push_back(hop);
+		}
+	}
+
+	for (size_t hopNdx(0);  hopNdx < outGraph.hops.size();  hopNdx++)
+	{
+		const NTV2InputXptID inputXpt (outGraph.hops.at(hopNdx).input);
+		const bool rgbOnly (CNTV2SignalRouter::IsRGBOnlyInputXpt(inputXpt)),  yuvOnly (CNTV2SignalRouter::IsYUVOnlyInputXpt(inputXpt));
+		NTV2OutputXptIDSet legalOutputs;
+		if (pInROM)
+		{
+			for (NTV2PossibleConnectionsConstIter it(pInROM->lower_bound(inputXpt));  it != pInROM->upper_bound(inputXpt);  ++it)
+				if (outGraph.outputs.find(it->second) != outGraph.outputs.end())
+					legalOutputs.insert(it->second);
+		}
+		else
+			legalOutputs = outGraph.outputs;
+		for (NTV2OutputXptIDSetConstIter it(legalOutputs.begin());  it != legalOutputs.end();  ++it)
+			if (!(rgbOnly && !IsRGBOutputXpt(*it))  &&  !(yuvOnly && IsRGBOutputXpt(*it)))
+				outGraph.edges.insert(RSEdges::value_type(*it, hopNdx));
+	}
+	RSDBG("'" << ::NTV2DeviceIDToString(inDeviceID) << "' graph built from " << (pInROM ? "ROM" : "widgets") << ": "
+			<< DEC(outGraph.widgets.size()) << " widget(s), " << DEC(outGraph.hops.size()) << " input(s), " << DEC(outGraph.edges.size()) << " edge(s)");
+	return true;
+}
+
+static string RequestKey (const NTV2OutputXptID inSource, const NTV2InputXptID inSink, const NTV2RouteConstraints & inConstraints)
+{
+	ostringstream oss;
+	oss << DEC(inSource) << "|" << DEC(inSink) << "|" << inConstraints;
+	return oss.str();
+}
+
+static bool CanFeedSink (const RSGraph & inGraph, const NTV2OutputXptID inOutput, const size_t inSinkHop, const NTV2RouteColor inSinkColor)
+{
+	if (inSinkColor == NTV2RouteColor_RGB  &&  !IsRGBOutputXpt(inOutput))
+		return false;
+	if (inSinkColor == NTV2RouteColor_YUV  &&  IsRGBOutputXpt(inOutput))
+		return false;
+	for (RSEdgesConstIter it(inGraph.edges.lower_bound(inOutput));  it != inGraph.edges.upper_bound(inOutput);  ++it)
+		if (it->second == inSinkHop)
+			return true;
+	return false;
+}
+
+//	A state in the search
+struct RSNode
+{
+	NTV2OutputXptID	output;
+	ULWord			satisfied;	//	Bit N set if requiredTypes' Nth type is on the route
+	size_t			parent;		//	Index of previous node
+	size_t			hop;		//	Index of hop taken from parent
+	NTV2WidgetIDSet	used;		//	Widgets on the route so far (only tracked by the exact search)
+};
+typedef pair<NTV2OutputXptID,ULWord>	RSState;
+typedef map<RSState, vector<size_t> >	RSReached;		//	State ==> nodes that reached it
+static const size_t kNone (~size_t(0));
+static const size_t kMaxExactNodes (200000);			//	Bounds the exact search
+static const size_t kMaxCachedSolutions (1000);			//	Per graph
+
+enum RSResult {RSResult_NoRoute, RSResult_Found, RSResult_ReusesWidget};
+
+//	Breadth-first search over (output, required types satisfied) states -- every connection costs the same.
+//	The quick search (inExact false) keeps one node per state, ignoring which widgets are already on the route, so it
+//	may find a route that passes through a widget twice (which it reports instead of returning). The exact search makes
+//	the widgets used so far part of the state:  a node is only dropped if another node already reached its output and
+//	required types using a subset of its widgets, so it finds a route whenever one exists (within kMaxExactNodes).
+static RSResult SearchGraph (const RSGraph & inGraph, const NTV2OutputXptID inSource, const NTV2WidgetID inSourceWidget,
+							const NTV2InputXptID inSink, const size_t inSinkHop, const NTV2RouteConstraints & inConstraints,
+							const bool inExact, NTV2XptConnections & outRoute)
+{
+	const vector<NTV2WidgetType> required (inConstraints.requiredTypes.begin(), inConstraints.requiredTypes.end());
+	const ULWord allSatisfied (required.empty() ? 0 : ULWord(0xFFFFFFFF >> (32 - required.size())));
+	vector<RSNode> nodes;
+	RSReached reached;
+	deque<size_t> queue;
+	RSNode root;
+	root.output = inSource;  root.satisfied = 0;  root.parent = kNone;  root.hop = kNone;
+	nodes.push_back(root);
+	reached[RSState(inSource, 0)].push_back(0);
+	queue.push_back(0);
+	while (!queue.empty())
+	{
+		const size_t nodeNdx (queue.front());
+		queue.pop_front();
+		const RSNode node (nodes.at(nodeNdx));
+		if (node.satisfied == allSatisfied  &&  CanFeedSink(inGraph, node.output, inSinkHop, inConstraints.sinkColor))
+		{	//	Found it -- walk back to the source
+			NTV2WidgetIDSet widgets;
+			outRoute[inSink] = node.output;
+			for (size_t ndx(nodeNdx);  nodes.at(ndx).parent != kNone;  ndx = nodes.at(ndx).parent)
+			{
+				const RSHop & hop (inGraph.hops.at(nodes.at(ndx).hop));
+				if (!widgets.insert(hop.widget).second)
+					{outRoute.clear();  return RSResult_ReusesWidget;}	//	Only the quick search gets here
+				outRoute[hop.input] = nodes.at(nodes.at(ndx).parent).output;
+			}
+			return RSResult_Found;
+		}
+
+		for (RSEdgesConstIter edgeIt(inGraph.edges.lower_bound(node.output));  edgeIt != inGraph.edges.upper_bound(node.output);  ++edgeIt)
+		{
+			const RSHop & hop (inGraph.hops.at(edgeIt->second));
+			if (edgeIt->second == inSinkHop  ||  hop.type == NTV2WidgetType_FrameStore  ||  hop.widget == inSourceWidget)
+				continue;	//	FrameStores only at the ends
+			if (inConstraints.excludedWidgets.find(hop.widget) != inConstraints.excludedWidgets.end()
+				||  inConstraints.excludedTypes.find(hop.type) != inConstraints.excludedTypes.end()
+				||  inConstraints.excludedInputs.find(hop.input) != inConstraints.excludedInputs.end())
+				continue;
+			if (inExact  &&  node.used.find(hop.widget) != node.used.end())
+				continue;	//	A widget can only be used once
+			ULWord satisfied (node.satisfied);
+			for (size_t ndx(0);  ndx < required.size();  ndx++)
+				if (required.at(ndx) == hop.type)
+					satisfied |= ULWord(1) << ndx;
+			NTV2WidgetIDSet used;
+			if (inExact)
+				{used = node.used;  used.insert(hop.widget);}
+			for (NTV2OutputXptIDSetConstIter outIt(hop.outputs.begin());  outIt != hop.outputs.end();  ++outIt)
+			{
+				if (!CanConvertColor(hop.type)  &&  IsRGBOutputXpt(*outIt) != IsRGBOutputXpt(node.output))
+					continue;	//	Only CSCs & LUTs change color
+				vector<size_t> & others (reached[RSState(*outIt, satisfied)]);
+				bool dominated (!inExact  &&  !others.empty());	//	Quick:  already reached more cheaply
+				for (size_t ndx(0);  inExact  &&  ndx < others.size()  &&  !dominated;  ndx++)
+				{	//	Exact:  already reached more cheaply, using no widget that this node doesn't?
+					const NTV2WidgetIDSet & otherUsed (nodes.at(others.at(ndx)).used);
+					dominated = std::includes(used.begin(), used.end(), otherUsed.begin(), otherUsed.end());
+				}
+				if (dominated)
+					continue;
+				if (nodes.size() >= kMaxExactNodes)
+					{RSWARN("'" << ::NTV2DeviceIDToString(inGraph.deviceID) << "': gave up after " << DEC(nodes.size()) << " nodes");  return RSResult_NoRoute;}
+				RSNode next;
+				next.output = *outIt;  next.satisfied = satisfied;  next.parent = nodeNdx;  next.hop = edgeIt->second;  next.used = used;
+				others.push_back(nodes.size());
+				nodes.push_back(next);
+				queue.push_back(nodes.size() - 1);
+			}
+		}
+	}
+	return RSResult_NoRoute;
+}
+
+static bool SolveGraph (const RSGraph & inGraph, const NTV2OutputXptID inSource, const NTV2InputXptID inSink,
+						const NTV2RouteConstraints & inConstraints, NTV2XptConnections & outRoute)
+{
+	outRoute.clear();
+	size_t sinkHop(kNone);
+	for (size_t ndx(0);  ndx < inGraph.hops.size()  &&  sinkHop == kNone;  ndx++)
+		if (inGraph.hops.at(ndx).input == inSink)
+			sinkHop = ndx;
+	if (sinkHop == kNone)
+		{RSFAIL("'" << ::NTV2DeviceIDToString(inGraph.deviceID) << "' has no input '" << ::NTV2InputCrosspointIDToString(inSink) << "'");  return false;}
+	if (inGraph.outputs.find(inSource) == inGraph.outputs.end())
+		{RSFAIL("'" << ::NTV2DeviceIDToString(inGraph.deviceID) << "' has no output '" << ::NTV2OutputCrosspointIDToString(inSource) << "'");  return false;}
+	if (inConstraints.requiredTypes.size() > 32)
+		{RSFAIL(DEC(inConstraints.requiredTypes.size()) << " required widget types exceeds 32");  return false;}
+
+	NTV2WidgetID sourceWidget (NTV2_WIDGET_INVALID);
+	CNTV2SignalRouter::GetWidgetForOutput(inSource, sourceWidget, inGraph.deviceID);
+
+	//	The quick search is exact unless the route it finds reuses a widget, and if it finds nothing, nothing exists...
+	switch (SearchGraph(inGraph, inSource, sourceWidget, inSink, sinkHop, inConstraints, false, outRoute))
+	{
+		case RSResult_Found:			return true;
+		case RSResult_NoRoute:			return false;
+		case RSResult_ReusesWidget:		break;
+	}
+	RSDBG("'" << ::NTV2DeviceIDToString(inGraph.deviceID) << "': shortest route reuses a widget, searching exhaustively");
+	return SearchGraph(inGraph, inSource, sourceWidget, inSink, sinkHop, inConstraints, true, outRoute) == RSResult_Found;
+}
+
+static bool SolveCached (RSGraph & inGraph, const NTV2OutputXptID inSource, const NTV2InputXptID inSink,
+						NTV2XptConnections & outRoute, const NTV2RouteConstraints & inConstraints)
+{
+	const string key (RequestKey(inSource, inSink, inConstraints));
+	RSSolutionsConstIter it (inGraph.solutions.find(key));
+	if (it == inGraph.solutions.end())
+	{
+		NTV2XptConnections route;
+		if (!SolveGraph(inGraph, inSource, inSink, inConstraints, route))
+			RSDBG("'" << ::NTV2DeviceIDToString(inGraph.deviceID) << "': no route for " << key);
+		if (inGraph.solutions.size() >= kMaxCachedSolutions)
+		{	//	Callers generating endless distinct requests (e.g. ever-changing exclusions) mustn't grow the cache forever
+			RSDBG("'" << ::NTV2DeviceIDToString(inGraph.deviceID) << "': " << DEC(inGraph.solutions.size()) << " cached solutions -- flushed");
+			inGraph.solutions.clear();
+		}
+		it = inGraph.solutions.insert(RSSolutions::value_type(key, route)).first;
+	}
+	outRoute = it->second;
+	return !outRoute.empty();
+}
+
+
+NTV2RouteConstraints & NTV2RouteConstraints::ExcludeInputsIn (const NTV2XptConnections & inConnections)
+{
+	for (NTV2XptConnectionsConstIter it(inConnections.begin());  it != inConnections.end();  ++it)
+		excludedInputs.insert(it->first);
+	return *this;
+}
+
+ostream & operator << (ostream & oss, const NTV2RouteConstraints & inConstraints)
+{
+	static const char * sColors[] = {"any", "YUV", "RGB"};
+	oss << "color=" << sColors[inConstraints.sinkColor] << " require=";
+	for (NTV2WidgetTypeSetConstIter it(inConstraints.requiredTypes.begin());  it != inConstraints.requiredTypes.end();  ++it)
+		oss << (it == inConstraints.requiredTypes.begin() ? "" : ",") << DEC(*it);
+	oss << " excludeTypes=";
+	for (NTV2WidgetTypeSetConstIter it(inConstraints.excludedTypes.begin());  it != inConstraints.excludedTypes.end();  ++it)
+		oss << (it == inConstraints.excludedTypes.begin() ? "" : ",") << DEC(*it);
+	oss << " exclude=";
+	for (NTV2WidgetIDSetConstIter it(inConstraints.excludedWidgets.begin());  it != inConstraints.excludedWidgets.end();  ++it)
+		oss << (it == inConstraints.excludedWidgets.begin() ? "" : ",") << DEC(*it);
+	oss << " excludeInputs=";
+	for (NTV2InputXptIDSetConstIter it(inConstraints.excludedInputs.begin());  it != inConstraints.excludedInputs.end();  ++it)
+		oss << (it == inConstraints.excludedInputs.begin() ? "" : ",") << DEC(*it);
+	return oss;
+}
+
+
+bool NTV2RouteSolver::Solve (const NTV2DeviceID inDeviceID, const NTV2OutputXptID inSource, const NTV2InputXptID inSink,
+							NTV2XptConnections & outRoute, const NTV2RouteConstraints & inConstraints)	//	STATIC
+{
+	outRoute.clear();
+	AJAAutoLock locker(&gRSLock);
+	const ULWord64 graphKey (GraphKey(inDeviceID, false));
+	RSGraphs::iterator it (gRSGraphs.find(graphKey));
+	if (it == gRSGraphs.end())
+	{
+		RSGraph graph;
+		if (!BuildGraph(graph, inDeviceID, AJA_NULL))
+			return false;
+		it = gRSGraphs.insert(RSGraphs::value_type(graphKey, graph)).first;
+	}
+	return SolveCached(it->second, inSource, inSink, outRoute, inConstraints);
+}
+
+bool NTV2RouteSolver::Solve (CNTV2Card & inDevice, const NTV2OutputXptID inSource, const NTV2InputXptID inSink,
+							NTV2XptConnections & outRoute, const NTV2RouteConstraints & inConstraints)	//	STATIC
+{
+	outRoute.clear();
+	if (!inDevice.IsOpen())
+		{RSFAIL("Device not open");  return false;}
+	if (!inDevice.IsSupported(kDeviceHasXptConnectROM))
+		return Solve(inDevice.GetDeviceID(), inSource, inSink, outRoute, inConstraints);
+
+	const ULWord64 graphKey (GraphKey(inDevice.GetDeviceID(), true));
+	{
+		AJAAutoLock locker(&gRSLock);
+		RSGraphs::iterator it (gRSGraphs.find(graphKey));
+		if (it != gRSGraphs.end())
+			return SolveCached(it->second, inSource, inSink, outRoute, inConstraints);
+	}
+	NTV2PossibleConnections possibleConnections;	//	Read the ROM without holding the lock
+	if (!inDevice.GetPossibleConnections(possibleConnections))
+	{
+		RSWARN("'" << inDevice.GetDisplayName() << "': GetPossibleConnections failed -- solving without ROM");
+		return Solve(inDevice.GetDeviceID(), inSource, inSink, outRoute, inConstraints);
+	}
+	AJAAutoLock locker(&gRSLock);
+	RSGraphs::iterator it (gRSGraphs.find(graphKey));
+	if (it == gRSGraphs.end())
+	{
+		RSGraph graph;
+		if (!BuildGraph(graph, inDevice.GetDeviceID(), &possibleConnections))
+			return false;
+		it = gRSGraphs.insert(RSGraphs::value_type(graphKey, graph)).first;
+	}
+	return SolveCached(it->second, inSource, inSink, outRoute, inConstraints);
+}
+
+size_t NTV2RouteSolver::GetNumCachedSolutions (void)	//	STATIC
+{
+	AJAAutoLock locker(&gRSLock);
+	size_t result(0);
+	for (RSGraphs::const_iterator it(gRSGraphs.begin());  it != gRSGraphs.end();  ++it)
+		result += it->second.solutions.size();
+	return result;
+}
+
+void NTV2RouteSolver::ClearCache (void)	//	STATIC
+{
+	AJAAutoLock locker(&gRSLock);
+	gRSGraphs.clear();
+}
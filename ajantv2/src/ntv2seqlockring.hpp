@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2seqlockring.hpp
+	@brief		Declares and implements the NTV2SeqLockRing template, the fixed-capacity record ring shared by
+				NTV2LatencyTimeline and NTV2DriverTrace. This module is included at compile time from
+				'ntv2latencytimeline.cpp' and 'ntv2drivertrace.cpp'.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#ifndef NTV2SEQLOCKRING_HPP
+#define NTV2SEQLOCKRING_HPP
+
+#include "ajatypes.h"
+#include "ajabase/system/atomic.h"
+#include <vector>
+#if defined(MSWindows)
+	#include <windows.h>
+	#define	NTV2SLRBARRIER()	MemoryBarrier()
+#else
+	#define	NTV2SLRBARRIER()	__sync_synchronize()
+#endif
+
+
+/**
+	@brief	A fixed-capacity ring of records that any number of threads can append to without locking or allocating,
+			and that can be read at any time from any thread. Each slot is bracketed by a sequence lock, so readers
+			skip records that are torn (being written) or stale (overwritten, or from before the last Reset).
+			The record type must have a uint64_t 'fSequence' member, which Push fills with the record's sequence number.
+**/
+template <typename RecordT> class NTV2SeqLockRing
+{
+	public:
+		/**
+			@brief	Constructs me.
+			@param[in]	inCapacity	Specifies the number of records to retain. Must be a power of two.
+		**/
+		explicit NTV2SeqLockRing (const ULWord inCapacity)
+			:	mSlots		(inCapacity),
+				mMask		(inCapacity - 1),
+				mWriteCount	(0),
+				mFloor		(0)
+		{
+			for (size_t ndx(0);  ndx < mSlots.size();  ndx++)
+				mSlots[ndx].fSeqLock = 0;
+		}
+
+		/**
+			@brief	Appends the given record. Lock-free. Two writers can only collide on the same slot if the ring wraps
+					completely during a single copy.
+		**/
+		void Push (const RecordT & inRecord)
+		{
+			const uint64_t	seq		(AJAAtomic::Increment(&mWriteCount) - 1);
+			Slot &			slot	(mSlots[size_t(seq & mMask)]);
+			AJAAtomic::Increment(&slot.fSeqLock);		//	Now odd
+			NTV2SLRBARRIER();
+			slot.fRecord = inRecord;
+			slot.fRecord.fSequence = seq;
+			NTV2SLRBARRIER();
+			AJAAtomic::Increment(&slot.fSeqLock);		//	Now even
+		}
+
+		/**
+			@brief	Discards every record appended so far. Sequence numbers keep counting up (rather than restarting at zero),
+					so a reader racing a writer can't mistake a record from before the Reset for a new one.
+		**/
+		void Reset (void)
+		{
+			NTV2SLRBARRIER();
+			AJAAtomic::Exchange(&mFloor, uint64_t(mWriteCount));
+		}
+
+		/**
+			@brief	Appends a copy of the retained records, oldest first, to the given vector.
+		**/
+		void CopyTo (std::vector<RecordT> & outRecords) const
+		{
+			NTV2SLRBARRIER();
+			const uint64_t	count	(mWriteCount);
+			const uint64_t	floor	(mFloor);
+			uint64_t		first	(count > uint64_t(mSlots.size())  ?  count - uint64_t(mSlots.size())  :  0);
+			if (first < floor)
+				first = floor;
+			for (uint64_t seq(first);  seq < count;  seq++)
+			{
+				const Slot &	slot	(mSlots[size_t(seq & mMask)]);
+				const uint32_t	lock1	(slot.fSeqLock);
+				if (lock1 & 1)
+					continue;	//	Being written
+				NTV2SLRBARRIER();
+				const RecordT	rec		(slot.fRecord);
+				NTV2SLRBARRIER();
+				if (slot.fSeqLock != lock1  ||  rec.fSequence != seq)
+					continue;	//	Overwritten while copying, or stale
+				outRecords.push_back(rec);
+			}
+		}
+
+		inline bool		IsEmpty (void) const	{return mWriteCount <= mFloor;}	///< @return	True if nothing was appended since construction or the last Reset.
+
+	private:
+		struct Slot
+		{
+			volatile uint32_t	fSeqLock;	///< @brief	Odd while being written
+			RecordT				fRecord;
+		};
+		std::vector<Slot>	mSlots;
+		uint64_t			mMask;
+		volatile uint64_t	mWriteCount;	///< @brief	Total number of records ever claimed
+		volatile uint64_t	mFloor;			///< @brief	Sequence number of the first record after the last Reset
+};	//	NTV2SeqLockRing
+
+#endif	//	NTV2SEQLOCKRING_HPP
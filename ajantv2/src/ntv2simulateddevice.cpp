@@ -0,0 +1,955 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2simulateddevice.cpp
+	@brief		Implements the NTV2SimulatedDevice class.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2simulateddevice.h"
+#include "ntv2deviceprofile.h"
+#include "ntv2devicefeatures.h"
+#include "ntv2formatdescriptor.h"
+#include "ntv2utils.h"
+#include "ntv2endian.h"
+#include "ntv2vpid.h"
+#include "ajabase/common/common.h"
+#include "ajabase/system/debug.h"
+#include "ajabase/system/systemtime.h"
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+#define INSTP(_p_)			HEX0N(uint64_t(_p_),16)
+#define DSFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_DriverInterface, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define DSWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_DriverInterface, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define DSNOTE(__x__)		AJA_sNOTICE	(AJA_DebugUnit_DriverInterface, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define DSDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_DriverInterface, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+
+static const ULWord		kSimPageSize		(1UL << 20);	//	Frame memory allocation granularity
+static const ULWord		kSimMaxRegNum		(0x00100000);	//	Reject register numbers beyond this
+static const ULWord		kSimMaxVBISleepUS	(2000);			//	VBI thread wakes at least this often, to notice mQuit
+static const LWord		kSimInvalidFrame	(-1);
+
+//	These static tables eliminate a lot of switch statements.
+//	CAUTION:	These are predicated on NTV2Channel being ordinal (NTV2_CHANNEL1==0, NTV2_CHANNEL2==1, etc.)
+static const ULWord gChannelToGlobalControlRegNum []	= { kRegGlobalControl, kRegGlobalControlCh2, kRegGlobalControlCh3, kRegGlobalControlCh4,
+															kRegGlobalControlCh5, kRegGlobalControlCh6, kRegGlobalControlCh7, kRegGlobalControlCh8, 0};
+
+static const ULWord gChannelToControlRegNum []			= { kRegCh1Control, kRegCh2Control, kRegCh3Control, kRegCh4Control, kRegCh5Control, kRegCh6Control,
+															kRegCh7Control, kRegCh8Control, 0};
+
+static const ULWord gChannelToOutputFrameRegNum []		= { kRegCh1OutputFrame, kRegCh2OutputFrame, kRegCh3OutputFrame, kRegCh4OutputFrame,
+															kRegCh5OutputFrame, kRegCh6OutputFrame, kRegCh7OutputFrame, kRegCh8OutputFrame, 0};
+
+static const ULWord gChannelToInputFrameRegNum []		= { kRegCh1InputFrame, kRegCh2InputFrame, kRegCh3InputFrame, kRegCh4InputFrame,
+															kRegCh5InputFrame, kRegCh6InputFrame, kRegCh7InputFrame, kRegCh8InputFrame, 0};
+
+static const ULWord gChannelTo425FBMask []				= { kRegMask425FB12, kRegMask425FB12, kRegMask425FB34, kRegMask425FB34,
+															kRegMask425FB56, kRegMask425FB56, kRegMask425FB78, kRegMask425FB78, 0};
+
+static const ULWord gChannelToSDIInputStatusRegNum []		= { kRegInputStatus,		kRegInputStatus,		kRegInputStatus2,		kRegInputStatus2,
+																kRegInput56Status,		kRegInput56Status,		kRegInput78Status,		kRegInput78Status,	0};
+static const ULWord gChannelToSDIInputRateMask []			= { kRegMaskInput1FrameRate,			kRegMaskInput2FrameRate,			kRegMaskInput1FrameRate,			kRegMaskInput2FrameRate,
+																kRegMaskInput1FrameRate,			kRegMaskInput2FrameRate,			kRegMaskInput1FrameRate,			kRegMaskInput2FrameRate,			0};
+static const ULWord gChannelToSDIInputRateHighMask []		= { kRegMaskInput1FrameRateHigh,		kRegMaskInput2FrameRateHigh,		kRegMaskInput1FrameRateHigh,		kRegMaskInput2FrameRateHigh,
+																kRegMaskInput1FrameRateHigh,		kRegMaskInput2FrameRateHigh,		kRegMaskInput1FrameRateHigh,		kRegMaskInput2FrameRateHigh,		0};
+static const ULWord gChannelToSDIInputRateShift []			= { kRegShiftInput1FrameRate,			kRegShiftInput2FrameRate,			kRegShiftInput1FrameRate,			kRegShiftInput2FrameRate,
+																kRegShiftInput1FrameRate,			kRegShiftInput2FrameRate,			kRegShiftInput1FrameRate,			kRegShiftInput2FrameRate,			0};
+static const ULWord gChannelToSDIInputRateHighShift []		= { kRegShiftInput1FrameRateHigh,		kRegShiftInput2FrameRateHigh,		kRegShiftInput1FrameRateHigh,		kRegShiftInput2FrameRateHigh,
+																kRegShiftInput1FrameRateHigh,		kRegShiftInput2FrameRateHigh,		kRegShiftInput1FrameRateHigh,		kRegShiftInput2FrameRateHigh,		0};
+
+static const ULWord gChannelToSDIInput3GStatusRegNum [] = { kRegSDIInput3GStatus,		kRegSDIInput3GStatus,		kRegSDIInput3GStatus2,		kRegSDIInput3GStatus2,
+															kRegSDI5678Input3GStatus,	kRegSDI5678Input3GStatus,	kRegSDI5678Input3GStatus,	kRegSDI5678Input3GStatus,	0};
+static const ULWord gChannelToSDIIn3GModeMask []	= { kRegMaskSDIIn3GbpsMode,		kRegMaskSDIIn23GbpsMode,	kRegMaskSDIIn33GbpsMode,	kRegMaskSDIIn43GbpsMode,
+														kRegMaskSDIIn53GbpsMode,	kRegMaskSDIIn63GbpsMode,	kRegMaskSDIIn73GbpsMode,	kRegMaskSDIIn83GbpsMode,	0};
+static const ULWord gChannelToSDIInVPIDLinkAValidMask[] = { kRegMaskSDIInVPIDLinkAValid,	kRegMaskSDIIn2VPIDLinkAValid,	kRegMaskSDIIn3VPIDLinkAValid,	kRegMaskSDIIn4VPIDLinkAValid,
+															kRegMaskSDIIn5VPIDLinkAValid,	kRegMaskSDIIn6VPIDLinkAValid,	kRegMaskSDIIn7VPIDLinkAValid,	kRegMaskSDIIn8VPIDLinkAValid,	0};
+static const ULWord gChannelToSDIInVPIDARegNum []		= { kRegSDIIn1VPIDA,			kRegSDIIn2VPIDA,			kRegSDIIn3VPIDA,			kRegSDIIn4VPIDA,
+															kRegSDIIn5VPIDA,			kRegSDIIn6VPIDA,			kRegSDIIn7VPIDA,			kRegSDIIn8VPIDA,			0};
+
+static const INTERRUPT_ENUMS	gChannelToOutputVerticalInterrupt[]	= {eOutput1, eOutput2, eOutput3, eOutput4, eOutput5, eOutput6, eOutput7, eOutput8, eNumInterruptTypes};
+static const INTERRUPT_ENUMS	gChannelToInputVerticalInterrupt[]	= {eInput1,  eInput2,  eInput3,  eInput4,  eInput5,  eInput6,  eInput7,  eInput8,  eNumInterruptTypes};
+
+static inline ULWord64 SimTime100ns (void)	{return ULWord64(AJATime::GetSystemMicroseconds()) * 10;}
+
+
+NTV2SimulatedDevice * NTV2SimulatedDevice::Create (const NTV2ConnectParams & inParams)	//	CLASS METHOD
+{
+	const string host (inParams.valueForKey(kConnectParamHost));
+	const NTV2DeviceID devID (DeviceIDFromName(host));
+	if (devID == DEVICE_ID_NOTFOUND)
+		{AJA_sERROR(AJA_DebugUnit_DriverInterface, AJAFUNC << ": No simulated device model '" << host << "'");  return AJA_NULL;}
+	return new NTV2SimulatedDevice(inParams, devID);
+}
+
+NTV2DeviceID NTV2SimulatedDevice::DeviceIDFromName (const string & inName)	//	CLASS METHOD
+{
+	string name (inName);
+	aja::strip(name);
+	aja::lower(name);
+	if (name.empty())
+		return DEVICE_ID_NOTFOUND;
+	NTV2DeviceFeatureRow row;
+	if (name.find("0x") == 0)
+	{	//	Hex device ID
+		const NTV2DeviceID devID (NTV2DeviceID(::strtoul(name.c_str(), AJA_NULL, 16)));
+		return ::NTV2DeviceGetFeatureRow(devID, row) ? devID : DEVICE_ID_NOTFOUND;
+	}
+	aja::replace(name, " ", "");
+	const NTV2DeviceIDSet devIDs (::NTV2GetSupportedDevices());
+	for (NTV2DeviceIDSetConstIter it(devIDs.begin());  it != devIDs.end();  ++it)
+		for (int retail(0);  retail < 2;  retail++)
+		{
+			string devName (::NTV2DeviceIDToString(*it, retail ? true : false));
+			aja::lower(devName);
+			aja::replace(devName, " ", "");
+			if (devName == name)
+				return ::NTV2DeviceGetFeatureRow(*it, row) ? *it : DEVICE_ID_NOTFOUND;
+		}
+	return DEVICE_ID_NOTFOUND;
+}
+
+NTV2SimulatedDevice::NTV2SimulatedDevice (const NTV2ConnectParams & inParams, const NTV2DeviceID inDeviceID)
+	:	NTV2RPCClientAPI	(inParams, AJA_NULL),
+		mDeviceID			(inDeviceID),
+		mConnected			(false),
+		mMemorySize			(::NTV2DeviceGetActiveMemorySize(inDeviceID)),
+		mIntCounts			(eNumInterruptTypes, 0),
+		mIntTimes			(eNumInterruptTypes, 0),
+		mQuit				(false),
+		mInputFormat		(NTV2_FORMAT_1080p_5994_A),
+		mPatternPF			(NTV2_FBF_INVALID)
+{
+	//	Parse query parameters, e.g. "?pattern=100%25%20ColorBars&input=1080p50a"...
+	string query (inParams.valueForKey(kConnectParamQuery));
+	if (!query.empty()  &&  query.at(0) == '?')
+		query.erase(0, 1);
+	const NTV2StringList params (aja::split(query, '&'));
+	for (NTV2StringListConstIter it(params.begin());  it != params.end();  ++it)
+	{
+		const size_t eqPos (it->find('='));
+		string key (::PercentDecode(it->substr(0, eqPos))), value (eqPos == string::npos ? "" : ::PercentDecode(it->substr(eqPos+1)));
+		aja::lower(key);
+		if (key == kQParamSimPattern)
+			mPatternName = value;
+		else if (key == kQParamSimInputFormat)
+		{
+			aja::lower(value);
+			mInputFormat = NTV2_FORMAT_UNKNOWN;
+			for (int vf(NTV2_FORMAT_UNKNOWN+1);  vf < NTV2_MAX_NUM_VIDEO_FORMATS  &&  mInputFormat == NTV2_FORMAT_UNKNOWN;  vf++)
+			{
+				string vfName (::NTV2VideoFormatToString(NTV2VideoFormat(vf)));
+				if (NTV2_IS_VALID_VIDEO_FORMAT(NTV2VideoFormat(vf))  &&  aja::lower(vfName) == value)
+					mInputFormat = NTV2VideoFormat(vf);
+			}
+			if (mInputFormat == NTV2_FORMAT_UNKNOWN)
+				DSWARN("Unknown '" << kQParamSimInputFormat << "' video format '" << value << "' -- no input signal");
+		}
+		else if (!key.empty())
+			DSWARN("Unknown query parameter '" << key << "' ignored");
+	}
+	if (mInputFormat == NTV2_FORMAT_UNKNOWN)
+		mPatternName.clear();
+	DSDBG("Simulating '" << ::NTV2DeviceIDToString(mDeviceID) << "' with " << xHEX0N(mMemorySize,8) << " bytes of frame memory"
+			<< (mPatternName.empty() ? "" : ", '" + mPatternName + "' on " + ::NTV2VideoFormatToString(mInputFormat) + " inputs"));
+}
+
+NTV2SimulatedDevice::~NTV2SimulatedDevice ()
+{
+	if (IsConnected())
+		NTV2Disconnect();	//	Before ~NTV2RPCClientAPI, which can't call my NTV2CloseRemote
+}
+
+string NTV2SimulatedDevice::Name (void) const
+{
+	return string(kLegalSchemeNTV2Sim) + "://" + HostName();
+}
+
+string NTV2SimulatedDevice::Description (void) const
+{
+	return "Simulated " + ::NTV2DeviceIDToString(mDeviceID, true);
+}
+
+
+bool NTV2SimulatedDevice::NTV2OpenRemote (void)
+{
+	if (mConnected)
+		return true;
+	if (!mMemorySize)
+		{DSFAIL("'" << ::NTV2DeviceIDToString(mDeviceID) << "' has no frame memory");  return false;}
+	{
+		AJAAutoLock tmp(&mLock);
+		mRegs.clear();
+		mPages.clear();
+		mPages.resize((ULWord64(mMemorySize) + kSimPageSize - 1) / kSimPageSize);
+		SimACChannel idle;
+		idle.state = NTV2_AUTOCIRCULATE_DISABLED;
+		idle.recording = false;
+		idle.channelCount = 0;
+		idle.startFrame = idle.endFrame = idle.activeFrame = kSimInvalidFrame;
+		idle.framesProcessed = idle.framesDropped = idle.optionFlags = 0;
+		idle.audioSystem = NTV2_AUDIOSYSTEM_INVALID;
+		idle.startTime = 0;
+		mAC.assign(NTV2_NUM_CROSSPOINTS, idle);
+		mPatternBuffer.Deallocate();
+		mPatternPF = NTV2_FBF_INVALID;
+		SeedRegisters();
+	}
+	const ULWord64 now (AJATime::GetSystemMicroseconds());
+	mNextVBI.assign(::NTV2DeviceGetNumFrameStores(mDeviceID), now);
+	mQuit = false;
+	mVBIThread.Attach(VBIThreadStatic, this);
+	mVBIThread.SetPriority(AJA_ThreadPriority_High);
+	if (AJA_FAILURE(mVBIThread.Start()))
+		{DSFAIL("Failed to start VBI thread");  return false;}
+	mConnected = true;
+	DSNOTE("Opened '" << Description() << "'");
+	return true;
+}
+
+bool NTV2SimulatedDevice::NTV2CloseRemote (void)
+{
+	mQuit = true;
+	while (mVBIThread.Active())
+		AJATime::Sleep(1);
+	AJAAutoLock tmp(&mLock);
+	mPages.clear();
+	mPatternBuffer.Deallocate();
+	if (mConnected)
+		DSNOTE("Closed '" << Description() << "'");
+	mConnected = false;
+	return true;
+}
+
+void NTV2SimulatedDevice::SeedRegisters (void)
+{
+	SetRegValue(kRegBoardID, ULWord(mDeviceID));
+	const UWord numFrameStores (::NTV2DeviceGetNumFrameStores(mDeviceID));
+	for (UWord ndx(0);  ndx < numFrameStores  &&  ndx < NTV2_MAX_NUM_CHANNELS;  ndx++)
+	{	//	1080p59.94, 8MB frames, 10-bit YCbCr, display mode...
+		const ULWord gblCtrl (gChannelToGlobalControlRegNum[ndx]);
+		SetRegValue(gblCtrl, ULWord(NTV2_FRAMERATE_5994), kRegMaskFrameRate, kRegShiftFrameRate);
+		SetRegValue(gblCtrl, ULWord(NTV2_FG_1920x1080), kRegMaskGeometry, kRegShiftGeometry);
+		SetRegValue(gblCtrl, ULWord(NTV2_STANDARD_1080p), kRegMaskStandard, kRegShiftStandard);
+		SetRegValue(gChannelToControlRegNum[ndx], ULWord(NTV2_FRAMESIZE_8MB), kK2RegMaskFrameSize, kK2RegShiftFrameSize);
+		SetRegValue(kVRegChannelCrosspointFirst + ndx, ULWord(NTV2CROSSPOINT_INVALID));
+	}
+	SeedInputSignal();
+}
+
+void NTV2SimulatedDevice::SeedInputSignal (void)
+{
+	if (mPatternName.empty())
+		return;
+	//	Advertise the input signal the way GetSDIInputVideoFormat expects:  a valid rate and a valid VPID...
+	const NTV2FrameRate rate (::GetNTV2FrameRateFromVideoFormat(mInputFormat));
+	ULWord vpid (0);
+	CNTV2VPID::SetVPIDData(vpid, mInputFormat, NTV2_FBF_10BIT_YCBCR, ::IsProgressivePicture(mInputFormat), /*is16x9*/true, VPIDChannel_1);
+	const UWord numInputs (::NTV2DeviceGetNumVideoInputs(mDeviceID));
+	for (UWord ndx(0);  ndx < numInputs  &&  ndx < NTV2_MAX_NUM_CHANNELS;  ndx++)
+	{
+		SetRegValue(gChannelToSDIInputStatusRegNum[ndx], ULWord(rate) & 0x7, gChannelToSDIInputRateMask[ndx], gChannelToSDIInputRateShift[ndx]);
+		SetRegValue(gChannelToSDIInputStatusRegNum[ndx], ULWord(rate) >> 3, gChannelToSDIInputRateHighMask[ndx], gChannelToSDIInputRateHighShift[ndx]);
+		SetRegValue(gChannelToSDIInput3GStatusRegNum[ndx], NTV2_IS_3G_FORMAT(mInputFormat) ? 0xFFFFFFFF : 0, gChannelToSDIIn3GModeMask[ndx]);
+		SetRegValue(gChannelToSDIInput3GStatusRegNum[ndx], 0xFFFFFFFF, gChannelToSDIInVPIDLinkAValidMask[ndx]);
+		SetRegValue(gChannelToSDIInVPIDARegNum[ndx], NTV2EndianSwap32(vpid));	//	Hardware byte order
+	}
+}
+
+
+//	Registers
+
+ULWord NTV2SimulatedDevice::RegValue (const ULWord inRegNum) const
+{
+	return inRegNum < mRegs.size() ? mRegs[inRegNum] : 0;
+}
+
+void NTV2SimulatedDevice::SetRegValue (const ULWord inRegNum, const ULWord inValue, const ULWord inMask, const ULWord inShift)
+{
+	if (inRegNum >= mRegs.size())
+		mRegs.resize(inRegNum + 1, 0);
+	if (inRegNum >= VIRTUALREG_START  ||  !inMask  ||  inMask == 0xFFFFFFFF)	//	Same as the driver:  virtual registers and zero masks ignore mask & shift
+		mRegs[inRegNum] = inValue;
+	else
+		mRegs[inRegNum] = (mRegs[inRegNum] & ~inMask) | ((inValue << inShift) & inMask);
+}
+
+bool NTV2SimulatedDevice::NTV2ReadRegisterRemote (const ULWord regNum, ULWord & outRegValue, const ULWord regMask, const ULWord regShift)
+{
+	if (regNum >= kSimMaxRegNum  ||  regShift >= 32)
+		{DSFAIL("Bad reg=" << DEC(regNum) << " msk=" << xHEX0N(regMask,8) << " shf=" << DEC(regShift));  return false;}
+	AJAAutoLock tmp(&mLock);
+	const ULWord value (RegValue(regNum));
+	outRegValue = (regNum >= VIRTUALREG_START  ||  !regMask) ? value : (value & regMask) >> regShift;
+	return true;
+}
+
+bool NTV2SimulatedDevice::NTV2WriteRegisterRemote (const ULWord regNum, const ULWord regValue, const ULWord regMask, const ULWord regShift)
+{
+	if (regNum >= kSimMaxRegNum  ||  regShift >= 32)
+		{DSFAIL("Bad reg=" << DEC(regNum) << " msk=" << xHEX0N(regMask,8) << " shf=" << DEC(regShift));  return false;}
+	if (regNum == kRegBoardID)
+		{DSWARN("kRegBoardID is read-only");  return false;}
+	AJAAutoLock tmp(&mLock);
+	SetRegValue(regNum, regValue, regMask, regShift);
+	return true;
+}
+
+bool NTV2SimulatedDevice::IsMultiFormat (void) const
+{
+	return ::NTV2DeviceCanDoMultiFormat(mDeviceID)  &&  (RegValue(kRegGlobalControl2) & kRegMaskIndependentMode);
+}
+
+NTV2FrameRate NTV2SimulatedDevice::FrameRate (const NTV2Channel inChannel) const
+{
+	const ULWord value (RegValue(gChannelToGlobalControlRegNum[IsMultiFormat() ? inChannel : NTV2_CHANNEL1]));
+	return NTV2FrameRate(((value & kRegMaskFrameRate) >> kRegShiftFrameRate)  |  (((value & kRegMaskFrameRateHiBit) >> kRegShiftFrameRateHiBit) << 3));
+}
+
+NTV2PixelFormat NTV2SimulatedDevice::PixelFormat (const NTV2Channel inChannel) const
+{
+	const ULWord value (RegValue(gChannelToControlRegNum[inChannel]));
+	return NTV2PixelFormat(((value & kRegMaskFrameFormat) >> kRegShiftFrameFormat)  |  (((value & kRegMaskFrameFormatHiBit) >> kRegShiftFrameFormatHiBit) << 4));
+}
+
+ULWord NTV2SimulatedDevice::FrameSize (const NTV2Channel inChannel) const
+{
+	//	Same as the driver's GetFrameBufferSize:  FrameStore 1's size, times 4 for quad/425 frames, and times 4 again for quad-quad...
+	ULWord result (::NTV2FramesizeToByteCount(NTV2Framesize((RegValue(kRegCh1Control) & kK2RegMaskFrameSize) >> kK2RegShiftFrameSize)));
+	const ULWord gblCtrl2 (RegValue(kRegGlobalControl2));
+	bool quad (::NTV2DeviceCanDo4KVideo(mDeviceID)  &&  (gblCtrl2 & (inChannel < NTV2_CHANNEL5 ? kRegMaskQuadMode : kRegMaskQuadMode2)));
+	if (!quad  &&  ::NTV2DeviceCanDo12gRouting(mDeviceID))
+		quad = (RegValue(gChannelToGlobalControlRegNum[inChannel]) & kRegMaskQuadTsiEnable) ? true : false;
+	else if (!quad  &&  ::NTV2DeviceCanDo425Mux(mDeviceID))
+		quad = (gblCtrl2 & gChannelTo425FBMask[inChannel]) ? true : false;
+	if (quad)
+		result *= 4;
+	if (::NTV2DeviceCanDo8KVideo(mDeviceID)  &&  (RegValue(kRegGlobalControl3) & kRegMaskQuadQuadMode))
+		result *= 4;
+	return result;
+}
+
+
+//	Frame Memory
+
+bool NTV2SimulatedDevice::CopyFrameMemory (const bool inToHost, ULWord64 inAddress, UByte * pHost, ULWord inByteCount)
+{
+	if (inAddress + inByteCount > ULWord64(mMemorySize))
+		{DSFAIL("Address " << xHEX0N(inAddress,8) << " + " << xHEX0N(inByteCount,8) << " bytes exceeds " << xHEX0N(mMemorySize,8));  return false;}
+	while (inByteCount)
+	{
+		UByteSequence & page (mPages.at(size_t(inAddress / kSimPageSize)));
+		const ULWord pageOffset (ULWord(inAddress % kSimPageSize));
+		const ULWord numBytes (inByteCount < kSimPageSize - pageOffset  ?  inByteCount  :  kSimPageSize - pageOffset);
+		if (inToHost)
+		{
+			if (page.empty())
+				::memset(pHost, 0, numBytes);	//	Never written
+			else
+				::memcpy(pHost, &page[pageOffset], numBytes);
+		}
+		else
+		{
+			if (page.empty())
+				page.resize(kSimPageSize, 0);
+			::memcpy(&page[pageOffset], pHost, numBytes);
+		}
+		inAddress += numBytes;
+		pHost += numBytes;
+		inByteCount -= numBytes;
+	}
+	return true;
+}
+
+bool NTV2SimulatedDevice::CopySegments (const bool inToHost, const ULWord64 inAddress, UByte * pHost, const ULWord inSegmentBytes,
+										const ULWord inNumSegments, const ULWord inHostPitch, const ULWord inCardPitch)
+{
+	if (inNumSegments < 2)
+		return CopyFrameMemory(inToHost, inAddress, pHost, inSegmentBytes);
+	for (ULWord seg(0);  seg < inNumSegments;  seg++)
+		if (!CopyFrameMemory(inToHost, inAddress + ULWord64(seg) * inCardPitch, pHost + size_t(seg) * inHostPitch, inSegmentBytes))
+			return false;
+	return true;
+}
+
+bool NTV2SimulatedDevice::NTV2DMATransferRemote (const NTV2DMAEngine inDMAEngine,	const bool inIsRead,
+												const ULWord inFrameNumber,			NTV2Buffer & inOutBuffer,
+												const ULWord inCardOffsetBytes,		const ULWord inNumSegments,
+												const ULWord inSegmentHostPitch,	const ULWord inSegmentCardPitch,
+												const bool inSynchronous)
+{	(void) inDMAEngine;  (void) inSynchronous;
+	if (inOutBuffer.IsNULL())
+		{DSFAIL("NULL or empty host buffer");  return false;}
+	AJAAutoLock tmp(&mLock);
+	//	Like the driver, plain DMA uses FrameStore 1's frame size, and the buffer's byte count is the segment size
+	const ULWord64 address (ULWord64(inFrameNumber) * FrameSize(NTV2_CHANNEL1) + inCardOffsetBytes);
+	return CopySegments(inIsRead, address, reinterpret_cast<UByte*>(inOutBuffer.GetHostPointer()), inOutBuffer.GetByteCount(),
+						inNumSegments, inSegmentHostPitch, inSegmentCardPitch);
+}
+
+
+//	Interrupts
+
+bool NTV2SimulatedDevice::NTV2WaitForInterruptRemote (const INTERRUPT_ENUMS eInterrupt, const ULWord timeOutMs)
+{
+	if (!NTV2_IS_VALID_INTERRUPT_ENUM(eInterrupt))
+		return false;
+	if (!mConnected)
+		return false;
+	AJAEvent event (/*manualReset*/false);
+	{
+		AJAAutoLock tmp(&mWaitLock);
+		mWaiters[eInterrupt].insert(&event);
+	}
+	const bool result (AJA_SUCCESS(event.WaitForSignal(timeOutMs)));
+	{
+		AJAAutoLock tmp(&mWaitLock);
+		mWaiters[eInterrupt].erase(&event);
+	}
+	return result;
+}
+
+bool NTV2SimulatedDevice::NTV2WaitForAnyInterruptRemote (NTV2InterruptWaitSet & inOutWaitSet, const ULWord timeOutMs)
+{
+	if (!mConnected)
+		return false;
+	const vector<INTERRUPT_ENUMS> sources (inOutWaitSet.GetSources());
+	const uint64_t deadline (AJATime::GetSystemMilliseconds() + timeOutMs);
+	AJAEvent event (/*manualReset*/false);
+	bool fired (false);
+	{
+		AJAAutoLock tmp(&mWaitLock);
+		mAnyWaiters.insert(&event);
+	}
+	while (true)
+	{
+		{
+			AJAAutoLock tmp(&mWaitLock);
+			for (size_t ndx(0);  ndx < sources.size();  ndx++)
+				if (inOutWaitSet.SetResult(sources.at(ndx), mIntCounts.at(sources.at(ndx)), mIntTimes.at(sources.at(ndx))))
+					fired = true;
+		}
+		const uint64_t now (AJATime::GetSystemMilliseconds());
+		if (fired  ||  now >= deadline)
+			break;
+		event.WaitForSignal(ULWord(deadline - now));
+	}
+	{
+		AJAAutoLock tmp(&mWaitLock);
+		mAnyWaiters.erase(&event);
+	}
+	return fired;
+}
+
+void NTV2SimulatedDevice::SignalWaiters (const INTERRUPT_ENUMS inInterrupt)
+{
+	AJAAutoLock tmp(&mWaitLock);
+	mIntCounts.at(inInterrupt)++;
+	mIntTimes.at(inInterrupt) = SimTime100ns();
+	SimWaiterMap::iterator it (mWaiters.find(inInterrupt));
+	if (it != mWaiters.end())
+		for (SimWaiters::iterator waiter(it->second.begin());  waiter != it->second.end();  ++waiter)
+			(*waiter)->Signal();
+	for (SimWaiters::iterator waiter(mAnyWaiters.begin());  waiter != mAnyWaiters.end();  ++waiter)
+		(*waiter)->Signal();
+}
+
+void NTV2SimulatedDevice::VBIThreadStatic (AJAThread * pThread, void * pContext)	//	CLASS METHOD
+{	(void) pThread;
+	NTV2SimulatedDevice * pDevice (reinterpret_cast<NTV2SimulatedDevice*>(pContext));
+	if (pDevice)
+		pDevice->VBIThread();
+}
+
+void NTV2SimulatedDevice::VBIThread (void)
+{
+	DSDBG("Started");
+	while (!mQuit)
+	{
+		ULWord64 now (AJATime::GetSystemMicroseconds()), nextWake (now + kSimMaxVBISleepUS);
+		for (size_t ndx(0);  ndx < mNextVBI.size()  &&  ndx < NTV2_MAX_NUM_CHANNELS;  ndx++)
+		{
+			const NTV2Channel channel (NTV2Channel(ndx+0));
+			if (now >= mNextVBI[ndx])
+			{
+				NTV2FrameRate rate (NTV2_FRAMERATE_INVALID);
+				{
+					AJAAutoLock tmp(&mLock);
+					rate = FrameRate(channel);
+				}
+				const double fps (NTV2_IS_SUPPORTED_NTV2FrameRate(rate) ? ::GetFramesPerSecond(rate) : 59.94);
+				VerticalInterrupt(channel);
+				mNextVBI[ndx] += ULWord64(1000000.0 / fps);
+				if (mNextVBI[ndx] < now)
+					mNextVBI[ndx] = now + ULWord64(1000000.0 / fps);	//	Fell behind -- don't burst
+			}
+			if (mNextVBI[ndx] < nextWake)
+				nextWake = mNextVBI[ndx];
+		}
+		now = AJATime::GetSystemMicroseconds();
+		if (nextWake > now)
+			AJATime::SleepInMicroseconds(int32_t(nextWake - now));
+	}
+	DSDBG("Stopped");
+}
+
+void NTV2SimulatedDevice::VerticalInterrupt (const NTV2Channel inChannel)
+{
+	{
+		AJAAutoLock tmp(&mLock);
+		const ULWord64 now (SimTime100ns());
+		ACVerticalInterrupt(::NTV2ChannelToOutputCrosspoint(inChannel), now);
+		ACVerticalInterrupt(::NTV2ChannelToInputCrosspoint(inChannel), now);
+	}
+	SignalWaiters(gChannelToOutputVerticalInterrupt[inChannel]);
+	SignalWaiters(gChannelToInputVerticalInterrupt[inChannel]);
+}
+
+void NTV2SimulatedDevice::FillInputFrame (const NTV2Channel inChannel, const LWord inFrame)
+{
+	if (mPatternName.empty())
+		return;
+	const NTV2PixelFormat pf (PixelFormat(inChannel));
+	if (pf != mPatternPF)
+	{	//	Render (once per pixel format)...
+		mPatternPF = pf;
+		mPatternBuffer.Deallocate();
+		const NTV2FormatDescriptor fd (mInputFormat, pf);
+		if (fd.IsValid()  &&  mPatternBuffer.Allocate(fd.GetTotalBytes()))
+			if (!mPatternGen.DrawTestPattern(mPatternName, fd, mPatternBuffer))
+			{
+				DSWARN("Can't draw '" << mPatternName << "' in " << ::NTV2FrameBufferFormatToString(pf) << " " << ::NTV2VideoFormatToString(mInputFormat));
+				mPatternBuffer.Deallocate();
+			}
+	}
+	if (mPatternBuffer.IsNULL())
+		return;
+	const ULWord frameSize (FrameSize(inChannel));
+	CopyFrameMemory(/*toHost*/false, ULWord64(inFrame) * frameSize, reinterpret_cast<UByte*>(mPatternBuffer.GetHostPointer()),
+				mPatternBuffer.GetByteCount() < frameSize ? mPatternBuffer.GetByteCount() : frameSize);
+}
+
+
+//	AutoCirculate
+
+NTV2Crosspoint NTV2SimulatedDevice::ACGangMember (const NTV2Crosspoint inPrimary, const ULWord inIndex) const
+{
+	const NTV2Channel channel (NTV2Channel(::NTV2CrosspointToNTV2Channel(inPrimary) + inIndex));
+	if (!NTV2_IS_VALID_CHANNEL(channel))
+		return NTV2CROSSPOINT_INVALID;
+	return NTV2_IS_INPUT_CROSSPOINT(inPrimary) ? ::NTV2ChannelToInputCrosspoint(channel) : ::NTV2ChannelToOutputCrosspoint(channel);
+}
+
+bool NTV2SimulatedDevice::ACInit (const AUTOCIRCULATE_DATA & inData)
+{
+	const NTV2Crosspoint primary (inData.channelSpec);
+	const LWord startFrame (inData.lVal1), endFrame (inData.lVal2);
+	const ULWord numChannels (inData.lVal4 > 0 ? ULWord(inData.lVal4) : 1);
+	const LWord range (endFrame - startFrame + 1);
+	if (startFrame < 0  ||  range < 2  ||  startFrame + LWord(numChannels) * range > LWord(MAX_FRAMEBUFFERS))
+		{DSFAIL("Bad frame range " << DEC(startFrame) << "-" << DEC(endFrame) << " x" << DEC(numChannels));  return false;}
+	for (ULWord ndx(0);  ndx < numChannels;  ndx++)
+	{
+		const NTV2Crosspoint xpt (ACGangMember(primary, ndx));
+		const NTV2Channel channel (::NTV2CrosspointToNTV2Channel(xpt));
+		if (!NTV2_IS_VALID_NTV2CROSSPOINT(xpt)  ||  channel >= ::NTV2DeviceGetNumFrameStores(mDeviceID))
+			{DSFAIL("Bad crosspoint " << DEC(primary) << " +" << DEC(ndx));  return false;}
+		if (mAC[xpt].state != NTV2_AUTOCIRCULATE_DISABLED)
+			{DSFAIL(::NTV2CrosspointToString(xpt) << " busy");  return false;}
+	}
+	for (ULWord ndx(0);  ndx < numChannels;  ndx++)
+	{
+		const NTV2Crosspoint xpt (ACGangMember(primary, ndx));
+		const NTV2Channel channel (::NTV2CrosspointToNTV2Channel(xpt));
+		SimACChannel & ac (mAC[xpt]);
+		ac.recording		= NTV2_IS_INPUT_CROSSPOINT(xpt);
+		ac.channelCount		= ndx ? 0 : numChannels;
+		ac.startFrame		= startFrame + LWord(ndx) * range;
+		ac.endFrame			= endFrame + LWord(ndx) * range;
+		ac.activeFrame		= kSimInvalidFrame;	//	Same as the driver:  no active frame until started
+		ac.framesProcessed	= ac.framesDropped = 0;
+		ac.audioSystem		= (!ndx && inData.bVal1) ? NTV2AudioSystem(inData.lVal3 & NTV2AudioSystemRemoveValues) : NTV2_AUDIOSYSTEM_INVALID;
+		ac.optionFlags		= ndx ? 0 : ((inData.bVal2 ? AUTOCIRCULATE_WITH_RP188 : 0)  |  (inData.bVal3 ? AUTOCIRCULATE_WITH_FBFCHANGE : 0)
+										|  (inData.bVal4 ? AUTOCIRCULATE_WITH_FBOCHANGE : 0)  |  (inData.bVal5 ? AUTOCIRCULATE_WITH_COLORCORRECT : 0)
+										|  (inData.bVal6 ? AUTOCIRCULATE_WITH_VIDPROC : 0)  |  (inData.bVal7 ? AUTOCIRCULATE_WITH_ANC : 0)
+										|  (inData.bVal8 ? AUTOCIRCULATE_WITH_LTC : 0)  |  (inData.lVal6 & AUTOCIRCULATE_WITH_FIELDS));
+		ac.startTime		= 0;
+		SimFrameStamp empty;
+		::memset(&empty, 0, sizeof(empty));
+		ac.frames.assign(size_t(ac.endFrame + 1), empty);
+		ac.state			= NTV2_AUTOCIRCULATE_INIT;
+		SetRegValue(gChannelToControlRegNum[channel], ac.recording ? NTV2_MODE_CAPTURE : NTV2_MODE_DISPLAY, kRegMaskMode, kRegShiftMode);
+		SetRegValue(kVRegChannelCrosspointFirst + channel, ULWord(xpt));
+		SetRegValue(ac.recording ? gChannelToInputFrameRegNum[channel] : gChannelToOutputFrameRegNum[channel], ULWord(ac.startFrame));
+		DSDBG(::NTV2CrosspointToString(xpt) << " frames " << DEC(ac.startFrame) << "-" << DEC(ac.endFrame));
+	}
+	return true;
+}
+
+bool NTV2SimulatedDevice::NTV2AutoCirculateRemote (AUTOCIRCULATE_DATA & autoCircData)
+{
+	const NTV2Crosspoint primary (autoCircData.channelSpec);
+	if (!NTV2_IS_VALID_NTV2CROSSPOINT(primary))
+		{DSFAIL("Bad crosspoint " << DEC(primary));  return false;}
+	AJAAutoLock tmp(&mLock);
+	if (autoCircData.eCommand == eInitAutoCirc)
+		return ACInit(autoCircData);
+	if (autoCircData.eCommand == eGetAutoCirc)
+	{
+		AUTOCIRCULATE_STATUS_STRUCT * pOldStatus (reinterpret_cast<AUTOCIRCULATE_STATUS_STRUCT*>(autoCircData.pvVal1));
+		AUTOCIRCULATE_STATUS status (primary);
+		return pOldStatus  &&  ACStatus(status)  &&  status.CopyTo(*pOldStatus);
+	}
+
+	const ULWord numChannels (mAC[primary].channelCount ? mAC[primary].channelCount : 1);
+	for (ULWord ndx(0);  ndx < numChannels;  ndx++)
+	{
+		const NTV2Crosspoint xpt (ACGangMember(primary, ndx));
+		if (!NTV2_IS_VALID_NTV2CROSSPOINT(xpt))
+			break;
+		SimACChannel & ac (mAC[xpt]);
+		switch (autoCircData.eCommand)
+		{
+			case eStartAutoCirc:
+				if (ac.state != NTV2_AUTOCIRCULATE_INIT)
+					{DSFAIL(::NTV2CrosspointToString(xpt) << " not initialized");  return false;}
+				ac.activeFrame = ac.startFrame;
+				ac.state = NTV2_AUTOCIRCULATE_STARTING;
+				break;
+
+			case eStopAutoCirc:
+				if (ac.state == NTV2_AUTOCIRCULATE_STARTING  ||  ac.state == NTV2_AUTOCIRCULATE_INIT
+					||  ac.state == NTV2_AUTOCIRCULATE_PAUSED  ||  ac.state == NTV2_AUTOCIRCULATE_RUNNING)
+						ac.state = NTV2_AUTOCIRCULATE_STOPPING;	//	Next VBI disables it
+				break;
+
+			case eAbortAutoCirc:
+				if (ac.state != NTV2_AUTOCIRCULATE_DISABLED)
+				{
+					ac.state = NTV2_AUTOCIRCULATE_DISABLED;
+					SetRegValue(kVRegChannelCrosspointFirst + ::NTV2CrosspointToNTV2Channel(xpt), ULWord(NTV2CROSSPOINT_INVALID));
+				}
+				break;
+
+			case ePauseAutoCirc:
+				if (!autoCircData.bVal1  &&  ac.state == NTV2_AUTOCIRCULATE_RUNNING)
+					ac.state = NTV2_AUTOCIRCULATE_PAUSED;
+				else if (autoCircData.bVal1  &&  ac.state == NTV2_AUTOCIRCULATE_PAUSED)
+				{
+					ac.state = NTV2_AUTOCIRCULATE_RUNNING;
+					if (autoCircData.bVal2)
+						ac.framesDropped = 0;
+				}
+				break;
+
+			case eFlushAutoCirculate:
+			{
+				if (ac.state != NTV2_AUTOCIRCULATE_INIT  &&  ac.state != NTV2_AUTOCIRCULATE_RUNNING  &&  ac.state != NTV2_AUTOCIRCULATE_PAUSED)
+					break;
+				if (autoCircData.bVal1)
+					ac.framesDropped = 0;
+				const LWord activeFrame (ac.activeFrame < ac.startFrame || ac.activeFrame > ac.endFrame  ?  ac.startFrame  :  ac.activeFrame);
+				if (ac.recording)	//	Release every captured frame except the active one
+					for (LWord frame(PrevFrame(ac, activeFrame));  frame != activeFrame  &&  ac.frames[size_t(frame)].validCount;  frame = PrevFrame(ac, frame))
+						ac.frames[size_t(frame)].validCount = 0;
+				else				//	Drop every queued frame after the active one
+				{
+					for (LWord frame(NextFrame(ac, activeFrame));  frame != activeFrame;  frame = NextFrame(ac, frame))
+						ac.frames[size_t(frame)].validCount = 0;
+					if (ac.state == NTV2_AUTOCIRCULATE_INIT)
+						ac.frames[size_t(activeFrame)].validCount = 0;
+				}
+				break;
+			}
+
+			case eSetActiveFrame:
+				if (ac.state != NTV2_AUTOCIRCULATE_RUNNING  &&  ac.state != NTV2_AUTOCIRCULATE_STARTING  &&  ac.state != NTV2_AUTOCIRCULATE_PAUSED)
+					break;
+				if (autoCircData.lVal1 < ac.startFrame  ||  autoCircData.lVal1 > ac.endFrame)
+					{DSFAIL(::NTV2CrosspointToString(xpt) << " frame " << DEC(autoCircData.lVal1) << " out of range");  return false;}
+				ac.activeFrame = autoCircData.lVal1 + LWord(ndx) * (ac.endFrame - ac.startFrame + 1);
+				SetRegValue(ac.recording ? gChannelToInputFrameRegNum[::NTV2CrosspointToNTV2Channel(xpt)]
+										: gChannelToOutputFrameRegNum[::NTV2CrosspointToNTV2Channel(xpt)], ULWord(ac.activeFrame));
+				break;
+
+			default:
+				DSFAIL("Unsupported AutoCirculate command " << DEC(autoCircData.eCommand));
+				return false;
+		}	//	switch on command
+	}	//	for each ganged channel
+	return true;
+}
+
+bool NTV2SimulatedDevice::ACFindNextAvailFrame (const SimACChannel & inAC, LWord & outFrame) const
+{
+	const LWord range (inAC.endFrame - inAC.startFrame + 1);
+	LWord frame (inAC.activeFrame), first (1);
+	if (inAC.state == NTV2_AUTOCIRCULATE_INIT)
+		{frame = inAC.startFrame - 1;  first = 0;}	//	Pre-loading starts at startFrame
+	else if (frame < inAC.startFrame  ||  frame > inAC.endFrame)
+		return false;
+	if (inAC.recording)
+	{	//	Oldest captured frame
+		if (inAC.state != NTV2_AUTOCIRCULATE_RUNNING)
+			return false;
+		for (LWord ndx(0);  ndx < range;  ndx++)
+		{
+			frame = NextFrame(inAC, frame);
+			if (inAC.frames[size_t(frame)].validCount)
+				{outFrame = frame;  return true;}
+		}
+	}
+	else
+	{	//	Next empty frame after the last queued one
+		if (inAC.state == NTV2_AUTOCIRCULATE_DISABLED)
+			return false;
+		for (LWord ndx(first);  ndx < range;  ndx++)
+		{
+			frame = NextFrame(inAC, frame);
+			if (!inAC.frames[size_t(frame)].validCount)
+				{outFrame = frame;  return true;}
+		}
+	}
+	return false;
+}
+
+ULWord NTV2SimulatedDevice::ACBufferLevel (const SimACChannel & inAC) const
+{
+	const LWord range (inAC.endFrame - inAC.startFrame + 1);
+	LWord frame (inAC.state == NTV2_AUTOCIRCULATE_INIT ? inAC.startFrame : inAC.activeFrame);
+	if (frame < inAC.startFrame  ||  frame > inAC.endFrame)
+		return 0;
+	ULWord result (0);
+	if (inAC.recording)
+	{	//	Captured frames, counting back from the active frame
+		if (inAC.state != NTV2_AUTOCIRCULATE_RUNNING)
+			return 0;
+		if (inAC.frames[size_t(frame)].validCount)
+			result++;
+		for (LWord ndx(1);  ndx < range;  ndx++)
+		{
+			frame = PrevFrame(inAC, frame);
+			if (!inAC.frames[size_t(frame)].validCount)
+				break;
+			result++;
+		}
+	}
+	else
+	{	//	Queued plays, counting forward from the active frame
+		result = inAC.frames[size_t(frame)].validCount;
+		for (LWord ndx(1);  ndx < range;  ndx++)
+		{
+			frame = NextFrame(inAC, frame);
+			if (!inAC.frames[size_t(frame)].validCount)
+				break;
+			result += inAC.frames[size_t(frame)].validCount;
+		}
+	}
+	return result;
+}
+
+bool NTV2SimulatedDevice::ACStatus (AUTOCIRCULATE_STATUS & outStatus)
+{
+	if (!NTV2_IS_VALID_NTV2CROSSPOINT(outStatus.acCrosspoint))
+		return false;
+	const SimACChannel & ac (mAC[outStatus.acCrosspoint]);
+	outStatus.acState					= ac.state;
+	outStatus.acStartFrame				= ac.startFrame;
+	outStatus.acEndFrame				= ac.endFrame;
+	outStatus.acActiveFrame				= ac.activeFrame;
+	outStatus.acRDTSCStartTime			= ac.startTime;
+	outStatus.acAudioClockStartTime		= ac.startTime;
+	outStatus.acRDTSCCurrentTime		= SimTime100ns();
+	outStatus.acAudioClockCurrentTime	= outStatus.acRDTSCCurrentTime;
+	outStatus.acFramesProcessed			= ac.framesProcessed;
+	outStatus.acFramesDropped			= ac.framesDropped;
+	outStatus.acBufferLevel				= ac.state == NTV2_AUTOCIRCULATE_DISABLED ? 0 : ACBufferLevel(ac);
+	outStatus.acOptionFlags				= ac.optionFlags;
+	outStatus.acAudioSystem				= ac.audioSystem;
+	return true;
+}
+
+bool NTV2SimulatedDevice::ACTransfer (AUTOCIRCULATE_TRANSFER & inOutXfer)
+{
+	const NTV2Crosspoint xpt (inOutXfer.acCrosspoint);
+	if (!NTV2_IS_VALID_NTV2CROSSPOINT(xpt))
+		{DSFAIL("Bad crosspoint " << DEC(xpt));  return false;}
+	const NTV2Channel channel (::NTV2CrosspointToNTV2Channel(xpt));
+	SimACChannel & ac (mAC[xpt]);
+	AUTOCIRCULATE_TRANSFER_STATUS & status (inOutXfer.acTransferStatus);
+	status.acTransferFrame = kSimInvalidFrame;
+	status.acAudioTransferSize = status.acAudioStartSample = status.acAncTransferSize = status.acAncField2TransferSize = 0;
+	if ((ac.recording  &&  ac.state != NTV2_AUTOCIRCULATE_RUNNING  &&  ac.state != NTV2_AUTOCIRCULATE_STARTING)
+		||  (!ac.recording  &&  ac.state == NTV2_AUTOCIRCULATE_DISABLED))
+			return true;	//	Same as the driver:  nothing to transfer, but not an error
+
+	LWord frame (inOutXfer.acDesiredFrame);
+	if (frame == kSimInvalidFrame  &&  !ACFindNextAvailFrame(ac, frame))
+	{
+		if (!ac.recording)
+			return true;	//	Playout ring full
+		frame = ac.startFrame;
+	}
+	if (frame < ac.startFrame  ||  frame > ac.endFrame)
+		{DSFAIL(::NTV2CrosspointToString(xpt) << " frame " << DEC(frame) << " not in " << DEC(ac.startFrame) << "-" << DEC(ac.endFrame));  return false;}
+
+	if (!inOutXfer.acVideoBuffer.IsNULL())
+	{
+		const NTV2SegmentedDMAInfo & segInfo (inOutXfer.acInSegmentedDMAInfo);
+		const ULWord64 address (ULWord64(frame) * FrameSize(channel) + inOutXfer.acInVideoDMAOffset);
+		if (!CopySegments(ac.recording, address, reinterpret_cast<UByte*>(inOutXfer.acVideoBuffer.GetHostPointer()),
+						inOutXfer.acVideoBuffer.GetByteCount(), segInfo.acNumSegments, segInfo.acSegmentHostPitch, segInfo.acSegmentDevicePitch))
+			return false;
+	}
+	SimFrameStamp & stamp (ac.frames[size_t(frame)]);
+	if (ac.recording)
+		stamp.validCount = 0;	//	Frame is free to capture into again
+	else
+	{
+		stamp.repeatCount = inOutXfer.acFrameRepeatCount ? inOutXfer.acFrameRepeatCount : 1;
+		stamp.validCount = stamp.repeatCount;
+		stamp.userCookie = inOutXfer.acInUserCookie;
+	}
+
+	status.acState				= ac.state;
+	status.acTransferFrame		= frame;
+	status.acBufferLevel		= ACBufferLevel(ac);
+	status.acFramesProcessed	= ac.framesProcessed;
+	status.acFramesDropped		= ac.framesDropped;
+	FRAME_STAMP & fs (status.acFrameStamp);
+	fs.acFrameTime				= LWord64(stamp.frameTime);
+	fs.acRequestedFrame			= ULWord(frame);
+	fs.acAudioClockTimeStamp	= stamp.frameTime;
+	fs.acCurrentTime			= LWord64(SimTime100ns());
+	fs.acCurrentFrame			= ULWord(ac.activeFrame);
+	if (ac.activeFrame >= ac.startFrame  &&  ac.activeFrame <= ac.endFrame)
+	{
+		const SimFrameStamp & active (ac.frames[size_t(ac.activeFrame)]);
+		fs.acCurrentFrameTime		= LWord64(active.frameTime);
+		fs.acAudioClockCurrentTime	= active.frameTime;
+		fs.acCurrentReps			= active.validCount;
+		fs.acCurrentUserCookie		= active.userCookie;
+	}
+	fs.acFrame					= ULWord(frame);
+	return true;
+}
+
+bool NTV2SimulatedDevice::ACFrameStamp (FRAME_STAMP & inOutStamp)
+{
+	//	On entry, acFrameTime has the NTV2Channel, and acRequestedFrame has the frame of interest
+	const NTV2Channel channel (NTV2Channel(inOutStamp.acFrameTime));
+	if (!NTV2_IS_VALID_CHANNEL(channel))
+		return false;
+	const bool capture ((RegValue(gChannelToControlRegNum[channel]) & kRegMaskMode) ? true : false);
+	const SimACChannel & ac (mAC[capture ? ::NTV2ChannelToInputCrosspoint(channel) : ::NTV2ChannelToOutputCrosspoint(channel)]);
+	const ULWord requestedFrame (inOutStamp.acRequestedFrame);
+	inOutStamp.acCurrentTime = LWord64(SimTime100ns());
+	inOutStamp.acAudioClockCurrentTime = ULWord64(inOutStamp.acCurrentTime);
+	if (ac.state != NTV2_AUTOCIRCULATE_RUNNING  &&  ac.state != NTV2_AUTOCIRCULATE_STARTING  &&  ac.state != NTV2_AUTOCIRCULATE_PAUSED)
+	{
+		inOutStamp.acCurrentFrame = ULWord(kSimInvalidFrame);
+		return true;
+	}
+	if (LWord(requestedFrame) >= ac.startFrame  &&  LWord(requestedFrame) <= ac.endFrame)
+	{
+		inOutStamp.acFrame = requestedFrame;
+		inOutStamp.acFrameTime = LWord64(ac.frames[requestedFrame].frameTime);
+		inOutStamp.acAudioClockTimeStamp = ac.frames[requestedFrame].frameTime;
+	}
+	else
+	{
+		inOutStamp.acFrame = ULWord(kSimInvalidFrame);
+		inOutStamp.acFrameTime = 0;
+		inOutStamp.acAudioClockTimeStamp = 0;
+	}
+	const LWord currentFrame (ac.activeFrame < ac.startFrame || ac.activeFrame > ac.endFrame  ?  ac.startFrame  :  ac.activeFrame);
+	const SimFrameStamp & current (ac.frames[size_t(currentFrame)]);
+	inOutStamp.acCurrentFrame		= ULWord(currentFrame);
+	inOutStamp.acCurrentFrameTime	= LWord64(current.frameTime);
+	inOutStamp.acCurrentFieldCount	= 0;
+	inOutStamp.acCurrentReps		= current.validCount;
+	inOutStamp.acCurrentUserCookie	= current.userCookie;
+	return true;
+}
+
+void NTV2SimulatedDevice::ACVerticalInterrupt (const NTV2Crosspoint inCrosspoint, const ULWord64 inNow)
+{
+	SimACChannel & ac (mAC[inCrosspoint]);
+	const NTV2Channel channel (::NTV2CrosspointToNTV2Channel(inCrosspoint));
+	const ULWord frameReg (ac.recording ? gChannelToInputFrameRegNum[channel] : gChannelToOutputFrameRegNum[channel]);
+	switch (ac.state)
+	{
+		case NTV2_AUTOCIRCULATE_STARTING:
+			ac.activeFrame = ac.startFrame;
+			ac.frames[size_t(ac.activeFrame)].frameTime = inNow;
+			ac.startTime = inNow;
+			ac.state = NTV2_AUTOCIRCULATE_RUNNING;
+			SetRegValue(frameReg, ULWord(ac.activeFrame));
+			break;
+
+		case NTV2_AUTOCIRCULATE_RUNNING:
+			if (ac.recording)
+			{	//	Active frame is now captured -- advance if the next frame is free, otherwise recapture (drop)...
+				const LWord nextFrame (NextFrame(ac, ac.activeFrame));
+				if (ac.frames[size_t(nextFrame)].validCount)
+					{ac.framesDropped++;  break;}
+				FillInputFrame(channel, ac.activeFrame);
+				ac.frames[size_t(ac.activeFrame)].validCount = 1;
+				ac.framesProcessed++;
+				ac.activeFrame = nextFrame;
+				ac.frames[size_t(nextFrame)].frameTime = inNow;
+			}
+			else
+			{	//	Active frame has played once more -- advance if it's done and the next frame is queued, otherwise repeat (drop)...
+				SimFrameStamp & active (ac.frames[size_t(ac.activeFrame)]);
+				if (active.validCount)
+					active.validCount--;
+				if (active.validCount)
+					break;
+				const LWord nextFrame (NextFrame(ac, ac.activeFrame));
+				if (!ac.frames[size_t(nextFrame)].validCount)
+					{ac.framesDropped++;  break;}
+				ac.framesProcessed++;
+				ac.activeFrame = nextFrame;
+				ac.frames[size_t(nextFrame)].frameTime = inNow;
+			}
+			SetRegValue(frameReg, ULWord(ac.activeFrame));
+			break;
+
+		case NTV2_AUTOCIRCULATE_STOPPING:
+			ac.state = NTV2_AUTOCIRCULATE_DISABLED;
+			SetRegValue(kVRegChannelCrosspointFirst + channel, ULWord(NTV2CROSSPOINT_INVALID));
+			break;
+
+		default:
+			break;
+	}
+}
+
+
+//	Messages
+
+bool NTV2SimulatedDevice::NTV2MessageRemote (NTV2_HEADER * pInMessage)
+{
+	if (!pInMessage)
+		return false;
+	AJAAutoLock tmp(&mLock);
+	switch (pInMessage->GetType())
+	{
+		case NTV2_TYPE_ACSTATUS:		return ACStatus(*reinterpret_cast<AUTOCIRCULATE_STATUS*>(pInMessage));
+		case NTV2_TYPE_ACXFER:			return ACTransfer(*reinterpret_cast<AUTOCIRCULATE_TRANSFER*>(pInMessage));
+		case NTV2_TYPE_ACFRAMESTAMP:	return ACFrameStamp(*reinterpret_cast<FRAME_STAMP*>(pInMessage));
+		case NTV2_TYPE_AJABUFFERLOCK:	return true;	//	Nothing to lock
+		default:						break;			//	Incl. NTV2_TYPE_GETREGS/SETREGS -- callers fall back to single reads/writes
+	}
+	return false;
+}
+
+
+//	Features
+
+bool NTV2SimulatedDevice::NTV2GetDeviceProfileRemote (NTV2DeviceProfile & outProfile)
+{
+	return outProfile.SetFromDeviceID(mDeviceID);	//	Register-based features are read from my registers upon first use
+}
@@ -161,6 +161,22 @@ bool CNTV2Card::WaitForInputVerticalInterrupt (const NTV2Channel inChannel, UWor
 }
 
 
+bool CNTV2Card::WaitForOutputVerticalInterrupt (const NTV2Channel inChannel, NTV2InterruptSnapshot & inOutSnapshot)
+{
+	if (!NTV2_IS_VALID_CHANNEL(inChannel))
+		return false;
+	return WaitForInterruptSnapshot (gChannelToOutputVerticalInterrupt [inChannel], inOutSnapshot);
+}
+
+
+bool CNTV2Card::WaitForInputVerticalInterrupt (const NTV2Channel inChannel, NTV2InterruptSnapshot & inOutSnapshot)
+{
+	if (!NTV2_IS_VALID_CHANNEL(inChannel))
+		return false;
+	return WaitForInterruptSnapshot (gChannelToInputVerticalInterrupt [inChannel], inOutSnapshot);
+}
+
+
 bool CNTV2Card::GetOutputFieldID (const NTV2Channel channel, NTV2FieldID & outFieldID)
 {
 	//           	         	 	   CHANNEL1    CHANNEL2     CHANNEL3     CHANNEL4     CHANNEL5     CHANNEL6     CHANNEL7     CHANNEL8
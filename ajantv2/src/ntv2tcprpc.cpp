@@ -0,0 +1,1887 @@
+/* SPDX-License-Identifier: MIT */
+/**
+	@file		ntv2tcprpc.cpp
+	@brief		Implements the NTV2TCPClient and NTV2TCPServer classes.
+	@copyright	(C) 2024 AJA Video Systems, Inc.
+**/
+
+#include "ntv2tcprpc.h"
+#include "ntv2card.h"
+#include "ntv2deviceprofile.h"
+#include "ntv2nubtypes.h"
+#include "ntv2utils.h"
+#include "ajabase/common/common.h"
+#include "ajabase/system/debug.h"
+#include "ajabase/system/memory.h"
+#include "ajabase/system/process.h"
+#include "ajabase/system/systemtime.h"
+#include <algorithm>
+#include <deque>
+#include <cstdlib>
+#include <cstring>
+#if defined(AJA_WINDOWS)
+	#include <WinSock2.h>
+	#include <WS2tcpip.h>
+	#define	TCPCloseSocket(_s_)		::closesocket(SOCKET(_s_))
+	#define	kTCPShutdownBoth		SD_BOTH
+#else
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <sys/select.h>
+	#include <sys/mman.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
+	#include <arpa/inet.h>
+	#include <netdb.h>
+	#include <unistd.h>
+	#define	TCPCloseSocket(_s_)		::close(_s_)
+	#define	kTCPShutdownBoth		SHUT_RDWR
+#endif
+#if !defined(MSG_NOSIGNAL)
+	#define	MSG_NOSIGNAL			0
+#endif
+
+using namespace std;
+using namespace ntv2nub;
+
+#define INSTP(_p_)			HEX0N(uint64_t(_p_),16)
+#define TCFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_RPCClient, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define TCWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_RPCClient, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define TCNOTE(__x__)		AJA_sNOTICE	(AJA_DebugUnit_RPCClient, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define TCDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_RPCClient, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define TSFAIL(__x__)		AJA_sERROR	(AJA_DebugUnit_RPCServer, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define TSWARN(__x__)		AJA_sWARNING(AJA_DebugUnit_RPCServer, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define TSNOTE(__x__)		AJA_sNOTICE	(AJA_DebugUnit_RPCServer, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+#define TSDBG(__x__)		AJA_sDEBUG	(AJA_DebugUnit_RPCServer, INSTP(this) << "::" << AJAFUNC << ": " << __x__)
+
+//	Frame layout (all big-endian):	magic, request ID (ULWords), opcode, flags (UWords), payload size (ULWord), payload.
+//	A response carries its request's ID, and its opcode with kTCPResponseBit set.
+static const ULWord		kTCPMagic				(NTV2_FOURCC('N','T','C','P'));
+static const ULWord		kTCPVersion				(1);
+static const size_t		kTCPHeaderBytes			(3 * sizeof(ULWord) + 2 * sizeof(UWord));
+static const ULWord		kTCPMaxPayload			(256UL * 1024UL * 1024UL);
+static const size_t		kTCPRecvChunkBytes		(1024UL * 1024UL);	//	Larger payloads are received (and allocated) piecemeal
+static const ULWord		kTCPRequestTimeoutMs	(5000);		//	Plus the interrupt wait timeout, if any
+static const size_t		kTCPMaxQueuedWrites		(256);		//	Write batching flushes at this many
+static const size_t		kTCPNumWaiters			(4);		//	Server interrupt waiter threads per connection
+static const size_t		kTCPMinRun				(3);		//	Shortest run of identical ULWords worth encoding as a run
+
+static const UWord		kTCPResponseBit			(0x8000);
+static const UWord		kTCPFlagOK				(0x0001);	//	Response:  request succeeded
+static const UWord		kTCPFlagCompressed		(0x0002);	//	DMA payload is run-length encoded
+static const UWord		kTCPFlagWantCompressed	(0x0004);	//	Request:  compress DMA read data if it helps
+
+static const ULWord		kTCPSharedMagic			(NTV2_FOURCC('N','T','S','M'));
+static const ULWord64	kTCPSharedHeaderBytes	(4096);		//	Segment header page, ahead of the data area
+static const ULWord64	kTCPSharedAlign			(4096);		//	Shared buffers are page-aligned
+static const ULWord		kTCPMaxSharedMB			(4096);
+static const size_t		kTCPNumSharedXferBufs	(4);		//	AUTOCIRCULATE_TRANSFER video, audio, anc F1 & F2 buffers
+static const string		kTCPSharedPrefix		("ntv2tcp-");
+
+static const UByte		kTCPIntCounted			(1);		//	WaitAny response:  interrupt was counted
+static const UByte		kTCPIntFired			(2);		//	WaitAny response:  interrupt was counted and fired
+
+typedef enum
+{
+	kTCPOpHello			= 1,	//	Version ==> version, device ID, description
+	kTCPOpRegBatch		= 2,	//	Register reads and/or writes ==> value & status of each
+	kTCPOpAutoCirculate	= 3,	//	AUTOCIRCULATE_DATA ==> status (eGetAutoCirc)
+	kTCPOpMessage		= 4,	//	Message type, RPC-encoded message ==> RPC-encoded message
+	kTCPOpWaitInterrupt	= 5,	//	Interrupt, timeout ==> status
+	kTCPOpWaitAny		= 6,	//	Timeout, mask, baseline mask, counts ==> state, count & time of each
+	kTCPOpDMA			= 7,	//	Transfer params [+ data] ==> [data]
+	kTCPOpSharedMemory	= 8,	//	Segment name, size, cookie ==> nothing
+	kTCPOpSharedDMA		= 9,	//	Transfer params, segment offset ==> nothing
+	kTCPOpSharedACXfer	= 10,	//	Segment offset & size of each buffer, AUTOCIRCULATE_TRANSFER sans buffers ==> AUTOCIRCULATE_TRANSFER_STATUS
+	kTCPOpProfile		= 11	//	Nothing ==> encoded NTV2DeviceProfile
+} NTV2TCPOpcode;
+
+//	Shared memory segment header. The cookie proves the server mapped the client's segment, and not a same-named one on another host.
+struct NTV2TCPSharedHeader
+{
+	ULWord		magic;			//	kTCPSharedMagic
+	ULWord		version;		//	kTCPVersion
+	ULWord64	cookie;			//	Random
+	ULWord64	dataBytes;		//	Size of the data area, which starts kTCPSharedHeaderBytes into the segment
+};
+
+static inline bool IsWaitOpcode (const UWord inOpcode)	{return inOpcode == kTCPOpWaitInterrupt  ||  inOpcode == kTCPOpWaitAny;}
+
+static inline size_t HostExtent (const ULWord inSegmentBytes, const ULWord inNumSegments, const ULWord inHostPitch)
+{
+	return inNumSegments < 2 ? size_t(inSegmentBytes) : size_t(inNumSegments - 1) * inHostPitch + inSegmentBytes;
+}
+
+static inline bool HasBytes (const NTV2_RPC_BLOB_TYPE & inBlob, const size_t inNdx, const size_t inNeeded)
+{
+	return inNdx <= inBlob.size()  &&  inBlob.size() - inNdx >= inNeeded;
+}
+
+static void PushString (const string & inStr, NTV2_RPC_BLOB_TYPE & outBlob)
+{
+	PUSHU32(ULWord(inStr.size()), outBlob);
+	outBlob.insert(outBlob.end(), inStr.begin(), inStr.end());
+}
+
+static bool PopString (string & outStr, const NTV2_RPC_BLOB_TYPE & inBlob, size_t & inOutNdx)
+{
+	ULWord len(0);
+	if (!HasBytes(inBlob, inOutNdx, sizeof(ULWord)))
+		return false;
+	POPU32(len, inBlob, inOutNdx);
+	if (!HasBytes(inBlob, inOutNdx, len))
+		return false;
+	outStr.assign(inBlob.begin() + ptrdiff_t(inOutNdx), inBlob.begin() + ptrdiff_t(inOutNdx + len));
+	inOutNdx += len;
+	return true;
+}
+
+
+//	Run-length encoding of ULWords:		raw byte count (ULWord), then tokens, then any trailing (raw byte count % 4) bytes.
+//	Each token starts with a ULWord whose MS bit is set for a run (followed by one ULWord repeated the given number of times),
+//	or clear for literals (followed by the given number of ULWords). ULWords are copied as-is (not byte-swapped).
+
+static inline ULWord WordAt (const UByte * pData, const size_t inWordNdx)
+{
+	ULWord result(0);
+	::memcpy(&result, pData + inWordNdx * sizeof(ULWord), sizeof(ULWord));
+	return result;
+}
+
+static void PushLiterals (const UByte * pData, const size_t inFirstWord, const size_t inNumWords, NTV2_RPC_BLOB_TYPE & outBlob)
+{
+	if (!inNumWords)
+		return;
+	PUSHU32(ULWord(inNumWords), outBlob);
+	outBlob.insert(outBlob.end(), pData + inFirstWord * sizeof(ULWord), pData + (inFirstWord + inNumWords) * sizeof(ULWord));
+}
+
+static void RLEncode (const UByte * pData, const size_t inByteCount, NTV2_RPC_BLOB_TYPE & outBlob)
+{
+	const size_t numWords (inByteCount / sizeof(ULWord));
+	size_t ndx(0), literalStart(0);
+	PUSHU32(ULWord(inByteCount), outBlob);
+	while (ndx < numWords)
+	{
+		const ULWord word (WordAt(pData, ndx));
+		size_t runLength (1);
+		while (ndx + runLength < numWords  &&  WordAt(pData, ndx + runLength) == word)
+			runLength++;
+		if (runLength < kTCPMinRun)
+			{ndx += runLength;  continue;}		//	Leave it in the literals
+		PushLiterals(pData, literalStart, ndx - literalStart, outBlob);
+		PUSHU32(0x80000000 | ULWord(runLength), outBlob);
+		outBlob.insert(outBlob.end(), pData + ndx * sizeof(ULWord), pData + (ndx + 1) * sizeof(ULWord));
+		ndx += runLength;
+		literalStart = ndx;
+	}
+	PushLiterals(pData, literalStart, numWords - literalStart, outBlob);
+	outBlob.insert(outBlob.end(), pData + numWords * sizeof(ULWord), pData + inByteCount);
+}
+
+static bool RLDecode (const NTV2_RPC_BLOB_TYPE & inBlob, size_t inNdx, UByte * pOutData, const size_t inByteCount)
+{
+	ULWord byteCount(0);
+	if (!HasBytes(inBlob, inNdx, sizeof(ULWord)))
+		return false;
+	POPU32(byteCount, inBlob, inNdx);
+	if (byteCount != inByteCount)
+		return false;
+	const size_t wordBytes (inByteCount - inByteCount % sizeof(ULWord));
+	size_t outNdx(0);
+	while (outNdx < wordBytes)
+	{
+		ULWord token(0);
+		if (!HasBytes(inBlob, inNdx, sizeof(ULWord)))
+			return false;
+		POPU32(token, inBlob, inNdx);
+		const size_t count (token & 0x7FFFFFFF), countBytes (count * sizeof(ULWord));
+		if (!count  ||  countBytes > wordBytes - outNdx)
+			return false;
+		if (token & 0x80000000)
+		{	//	Run
+			if (!HasBytes(inBlob, inNdx, sizeof(ULWord)))
+				return false;
+			for (size_t num(0);  num < count;  num++, outNdx += sizeof(ULWord))
+				::memcpy(pOutData + outNdx, &inBlob[inNdx], sizeof(ULWord));
+			inNdx += sizeof(ULWord);
+		}
+		else
+		{	//	Literals
+			if (!HasBytes(inBlob, inNdx, countBytes))
+				return false;
+			::memcpy(pOutData + outNdx, &inBlob[inNdx], countBytes);
+			inNdx += countBytes;
+			outNdx += countBytes;
+		}
+	}
+	if (inBlob.size() - inNdx != inByteCount - wordBytes)
+		return false;
+	if (inByteCount > wordBytes)
+		::memcpy(pOutData + wordBytes, &inBlob[inNdx], inByteCount - wordBytes);
+	return true;
+}
+
+//	Appends the given data to outBlob, compressed if requested and if that makes it smaller. Returns true if compressed.
+static bool PushPayload (const UByte * pData, const size_t inByteCount, const bool inCompress, NTV2_RPC_BLOB_TYPE & outBlob)
+{
+	const size_t startSize (outBlob.size());
+	if (inCompress)
+	{
+		RLEncode(pData, inByteCount, outBlob);
+		if (outBlob.size() - startSize < inByteCount)
+			return true;
+		outBlob.resize(startSize);	//	Didn't help
+	}
+	outBlob.insert(outBlob.end(), pData, pData + inByteCount);
+	return false;
+}
+
+static bool PopPayload (const NTV2_RPC_BLOB_TYPE & inBlob, const size_t inNdx, const bool inCompressed, UByte * pOutData, const size_t inByteCount)
+{
+	if (inCompressed)
+		return RLDecode(inBlob, inNdx, pOutData, inByteCount);
+	if (inBlob.size() < inNdx  ||  inBlob.size() - inNdx != inByteCount)
+		return false;
+	if (inByteCount)
+		::memcpy(pOutData, &inBlob[inNdx], inByteCount);
+	return true;
+}
+
+
+//	Socket I/O
+
+static bool SendAll (const int inSocket, const UByte * pData, size_t inByteCount)
+{
+	while (inByteCount)
+	{
+		const int chunk (inByteCount > 0x40000000 ? 0x40000000 : int(inByteCount));
+		const int sent (int(::send(inSocket, reinterpret_cast<const char*>(pData), chunk, MSG_NOSIGNAL)));
+		if (sent <= 0)
+			return false;
+		pData += sent;
+		inByteCount -= size_t(sent);
+	}
+	return true;
+}
+
+static bool RecvAll (const int inSocket, UByte * pData, size_t inByteCount)
+{
+	while (inByteCount)
+	{
+		const int chunk (inByteCount > 0x40000000 ? 0x40000000 : int(inByteCount));
+		const int got (int(::recv(inSocket, reinterpret_cast<char*>(pData), chunk, 0)));
+		if (got <= 0)
+			return false;	//	Closed or failed
+		pData += got;
+		inByteCount -= size_t(got);
+	}
+	return true;
+}
+
+static bool WaitReadable (const int inSocket, const ULWord inTimeoutMs)
+{
+	fd_set readSet;
+	FD_ZERO(&readSet);
+	FD_SET(inSocket, &readSet);
+	struct timeval timeout;
+	timeout.tv_sec = long(inTimeoutMs / 1000);
+	timeout.tv_usec = long(inTimeoutMs % 1000) * 1000;
+	return ::select(inSocket + 1, &readSet, AJA_NULL, AJA_NULL, &timeout) > 0;
+}
+
+static void SetNoDelay (const int inSocket)
+{
+	int noDelay(1);	//	Requests are small and latency-sensitive
+	::setsockopt(inSocket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+}
+
+//	Sends a whole frame. Caller must serialize calls for the same socket. Returns the number of bytes sent, or zero upon failure.
+static size_t SendFrame (const int inSocket, const ULWord inID, const UWord inOpcode, const UWord inFlags, const NTV2_RPC_BLOB_TYPE & inPayload)
+{
+	NTV2_RPC_BLOB_TYPE frame;
+	const bool smallPayload (inPayload.size() <= 64 * 1024);	//	Small payloads go out with the header in one send
+	frame.reserve(kTCPHeaderBytes + (smallPayload ? inPayload.size() : 0));
+	PUSHU32(kTCPMagic, frame);
+	PUSHU32(inID, frame);
+	PUSHU16(inOpcode, frame);
+	PUSHU16(inFlags, frame);
+	PUSHU32(ULWord(inPayload.size()), frame);
+	if (smallPayload)
+		frame.insert(frame.end(), inPayload.begin(), inPayload.end());
+	if (!SendAll(inSocket, &frame[0], frame.size()))
+		return 0;
+	if (!smallPayload  &&  !SendAll(inSocket, &inPayload[0], inPayload.size()))
+		return 0;
+	return kTCPHeaderBytes + inPayload.size();
+}
+
+//	Receives a whole frame. Returns false if the connection closed or the frame is malformed.
+static bool RecvFrame (const int inSocket, ULWord & outID, UWord & outOpcode, UWord & outFlags, NTV2_RPC_BLOB_TYPE & outPayload)
+{
+	NTV2_RPC_BLOB_TYPE header (kTCPHeaderBytes, 0);
+	if (!RecvAll(inSocket, &header[0], header.size()))
+		return false;
+	ULWord magic(0), payloadBytes(0);
+	size_t ndx(0);
+	POPU32(magic, header, ndx);
+	POPU32(outID, header, ndx);
+	POPU16(outOpcode, header, ndx);
+	POPU16(outFlags, header, ndx);
+	POPU32(payloadBytes, header, ndx);
+	if (magic != kTCPMagic  ||  payloadBytes > kTCPMaxPayload + 1024)
+		return false;
+	//	Grow the buffer only as the payload arrives, so a peer can't make me allocate much more than it actually sends
+	outPayload.clear();
+	while (outPayload.size() < payloadBytes)
+	{
+		const size_t have (outPayload.size());
+		const size_t want (std::min(size_t(payloadBytes), std::max(2 * have, kTCPRecvChunkBytes)));
+		outPayload.resize(want);
+		if (!RecvAll(inSocket, &outPayload[have], want - have))
+			return false;
+	}
+	return true;
+}
+
+static void PushRegOp (const NTV2RegInfo & inOp, const bool inIsRead, NTV2_RPC_BLOB_TYPE & outBlob)
+{
+	PUSHU8(inIsRead ? 1 : 0, outBlob);
+	PUSHU32(inOp.registerNumber, outBlob);
+	PUSHU32(inOp.registerValue, outBlob);
+	PUSHU32(inOp.registerMask, outBlob);
+	PUSHU32(inOp.registerShift, outBlob);
+}
+
+static void PushAutoCirculateData (const AUTOCIRCULATE_DATA & inData, NTV2_RPC_BLOB_TYPE & outBlob)
+{	//	Scalars only -- pointers are meaningless on the other side
+	PUSHU16(UWord(inData.eCommand), outBlob);
+	PUSHU16(UWord(inData.channelSpec), outBlob);
+	const LWord lVals[] = {inData.lVal1, inData.lVal2, inData.lVal3, inData.lVal4, inData.lVal5, inData.lVal6};
+	for (size_t ndx(0);  ndx < sizeof(lVals) / sizeof(LWord);  ndx++)
+		PUSHU32(ULWord(lVals[ndx]), outBlob);
+	const BOOL_ bVals[] = {inData.bVal1, inData.bVal2, inData.bVal3, inData.bVal4, inData.bVal5, inData.bVal6, inData.bVal7, inData.bVal8};
+	for (size_t ndx(0);  ndx < sizeof(bVals) / sizeof(BOOL_);  ndx++)
+		PUSHU8(bVals[ndx] ? 1 : 0, outBlob);
+}
+
+//	Same layout as AUTOCIRCULATE_TRANSFER::RPCEncode, but with empty video, audio & anc buffers (they're in shared memory)
+static bool PushTransferSansBuffers (AUTOCIRCULATE_TRANSFER & inXfer, NTV2_RPC_BLOB_TYPE & outBlob)
+{
+	NTV2Buffer none;
+	bool ok = inXfer.acHeader.RPCEncode(outBlob);
+	for (size_t ndx(0);  ndx < kTCPNumSharedXferBufs;  ndx++)
+		ok &= none.RPCEncode(outBlob);
+	ok &= inXfer.acOutputTimeCodes.RPCEncode(outBlob);
+	ok &= inXfer.acTransferStatus.RPCEncode(outBlob);
+	PUSHU64(inXfer.acInUserCookie, outBlob);
+	PUSHU32(inXfer.acInVideoDMAOffset, outBlob);
+	ok &= inXfer.acInSegmentedDMAInfo.RPCEncode(outBlob);
+	ok &= inXfer.acColorCorrection.RPCEncode(outBlob);
+	PUSHU16(UWord(inXfer.acFrameBufferFormat), outBlob);
+	PUSHU16(UWord(inXfer.acFrameBufferOrientation), outBlob);
+	ok &= inXfer.acVidProcInfo.RPCEncode(outBlob);
+	PUSHU16(UWord(inXfer.acVideoQuarterSizeExpand), outBlob);
+	ok &= inXfer.acHDMIAuxData.RPCEncode(outBlob);
+	PUSHU32(inXfer.acPeerToPeerFlags, outBlob);
+	PUSHU32(inXfer.acFrameRepeatCount, outBlob);
+	PUSHU32(ULWord(inXfer.acDesiredFrame), outBlob);
+	ok &= inXfer.acRP188.RPCEncode(outBlob);
+	PUSHU16(UWord(inXfer.acCrosspoint), outBlob);
+	ok &= inXfer.acTrailer.RPCEncode(outBlob);
+	return ok;
+}
+
+static inline NTV2Buffer * TransferBuffer (AUTOCIRCULATE_TRANSFER & inXfer, const size_t inNdx)
+{
+	NTV2Buffer * buffers[] = {&inXfer.acVideoBuffer, &inXfer.acAudioBuffer, &inXfer.acANCBuffer, &inXfer.acANCField2Buffer};
+	return inNdx < kTCPNumSharedXferBufs ? buffers[inNdx] : AJA_NULL;
+}
+
+//	DMA transfer parameters, as sent in kTCPOpDMA and kTCPOpSharedDMA requests
+struct NTV2TCPDMAParams
+{
+	UWord	engine;
+	UByte	isRead, isSync;
+	ULWord	frameNum, cardOffset, segBytes, numSegs, hostPitch, cardPitch;
+
+	NTV2TCPDMAParams ()	: engine(0), isRead(0), isSync(0), frameNum(0), cardOffset(0), segBytes(0), numSegs(0), hostPitch(0), cardPitch(0)	{}
+	inline size_t	Extent (void) const		{return HostExtent(segBytes, numSegs, hostPitch);}
+
+	void Push (NTV2_RPC_BLOB_TYPE & outBlob) const
+	{
+		PUSHU16(engine, outBlob);
+		PUSHU8(isRead, outBlob);
+		PUSHU8(isSync, outBlob);
+		PUSHU32(frameNum, outBlob);
+		PUSHU32(cardOffset, outBlob);
+		PUSHU32(segBytes, outBlob);
+		PUSHU32(numSegs, outBlob);
+		PUSHU32(hostPitch, outBlob);
+		PUSHU32(cardPitch, outBlob);
+	}
+
+	bool Pop (const NTV2_RPC_BLOB_TYPE & inBlob, size_t & inOutNdx)
+	{
+		if (!HasBytes(inBlob, inOutNdx, sizeof(UWord) + 2 + 6 * sizeof(ULWord)))
+			return false;
+		POPU16(engine, inBlob, inOutNdx);
+		POPU8(isRead, inBlob, inOutNdx);
+		POPU8(isSync, inBlob, inOutNdx);
+		POPU32(frameNum, inBlob, inOutNdx);
+		POPU32(cardOffset, inBlob, inOutNdx);
+		POPU32(segBytes, inBlob, inOutNdx);
+		POPU32(numSegs, inBlob, inOutNdx);
+		POPU32(hostPitch, inBlob, inOutNdx);
+		POPU32(cardPitch, inBlob, inOutNdx);
+		return segBytes != 0;
+	}
+
+	bool Transfer (CNTV2Card & inDevice, UByte * pHost) const
+	{
+		ULWord * pFrameBuffer (reinterpret_cast<ULWord*>(pHost));
+		return numSegs < 2
+				? inDevice.DmaTransfer(NTV2DMAEngine(engine), isRead != 0, frameNum, pFrameBuffer, cardOffset, segBytes, isSync != 0)
+				: inDevice.DmaTransfer(NTV2DMAEngine(engine), isRead != 0, frameNum, pFrameBuffer, cardOffset, segBytes,
+										numSegs, hostPitch, cardPitch, isSync != 0);
+	}
+};
+
+static bool IsSharedName (const string & inName)
+{
+	if (inName.size() <= kTCPSharedPrefix.size()  ||  inName.size() > 64  ||  inName.compare(0, kTCPSharedPrefix.size(), kTCPSharedPrefix))
+		return false;
+	for (size_t ndx(0);  ndx < inName.size();  ndx++)
+		if (!::isalnum(inName.at(ndx))  &&  inName.at(ndx) != '-')
+			return false;
+	return true;
+}
+
+//	AJAMemory::FreeShared leaves the name behind. Once both ends have the segment mapped, removing the name means
+//	the segment goes away when they unmap it, even if they crash.
+static void UnlinkShared (const string & inName)
+{
+#if defined(AJA_LINUX)
+	::shm_unlink(("/" + inName).c_str());
+#elif !defined(AJA_WINDOWS)
+	::shm_unlink(inName.c_str());
+#else
+	(void) inName;	//	Named mappings go away with their last handle
+#endif
+}
+
+static bool PopAutoCirculateData (AUTOCIRCULATE_DATA & outData, const NTV2_RPC_BLOB_TYPE & inBlob, size_t & inOutNdx)
+{
+	if (!HasBytes(inBlob, inOutNdx, 2 * sizeof(UWord) + 6 * sizeof(ULWord) + 8))
+		return false;
+	UWord u16(0);  ULWord u32(0);  UByte u8(0);
+	POPU16(u16, inBlob, inOutNdx);	outData.eCommand = AUTO_CIRC_COMMAND(u16);
+	POPU16(u16, inBlob, inOutNdx);	outData.channelSpec = NTV2Crosspoint(u16);
+	LWord * lVals[] = {&outData.lVal1, &outData.lVal2, &outData.lVal3, &outData.lVal4, &outData.lVal5, &outData.lVal6};
+	for (size_t ndx(0);  ndx < sizeof(lVals) / sizeof(LWord*);  ndx++)
+		{POPU32(u32, inBlob, inOutNdx);  *lVals[ndx] = LWord(u32);}
+	BOOL_ * bVals[] = {&outData.bVal1, &outData.bVal2, &outData.bVal3, &outData.bVal4, &outData.bVal5, &outData.bVal6, &outData.bVal7, &outData.bVal8};
+	for (size_t ndx(0);  ndx < sizeof(bVals) / sizeof(BOOL_*);  ndx++)
+		{POPU8(u8, inBlob, inOutNdx);  *bVals[ndx] = u8 ? true : false;}
+	return true;
+}
+
+
+ostream & operator << (ostream & oss, const NTV2TCPStats & inStats)
+{
+	oss << DEC(inStats.requests) << " request(s), " << DEC(inStats.registerOps) << " register op(s) (" << DEC(inStats.batchedWrites)
+		<< " batched write(s), " << DEC(inStats.deferredWriteFailures) << " failed), " << DEC(inStats.localReads) << " local read(s), " << DEC(inStats.bytesSent) << " byte(s) sent, "
+		<< DEC(inStats.bytesReceived) << " received, DMA " << DEC(inStats.dmaBytes) << " byte(s) as " << DEC(inStats.dmaWireBytes)
+		<< ", " << DEC(inStats.sharedBytes) << " byte(s) shared (" << DEC(inStats.stagedBytes) << " staged)";
+	return oss;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	NTV2TCPClient
+
+NTV2TCPClient * NTV2TCPClient::Create (const NTV2ConnectParams & inParams)	//	CLASS METHOD
+{
+	if (inParams.valueForKey(kConnectParamHost).empty())
+		{AJA_sERROR(AJA_DebugUnit_RPCClient, AJAFUNC << ": No host specified");  return AJA_NULL;}
+	return new NTV2TCPClient(inParams);
+}
+
+NTV2TCPClient::NTV2TCPClient (const NTV2ConnectParams & inParams)
+	:	NTV2RPCClientAPI	(inParams, AJA_NULL),
+		mSocket				(-1),
+		mConnected			(false),
+		mDeviceID			(DEVICE_ID_NOTFOUND),
+		mNextID				(1),
+		mBatchWrites		(false),
+		mCompress			(false),
+		mSharedMB			(0),
+		mSharedSpecified	(false),
+		mpSharedMem			(AJA_NULL),
+		mSharedBytes		(0)
+{
+	//	Parse query parameters, e.g. "?batch=1&compress=1"...
+	string query (inParams.valueForKey(kConnectParamQuery));
+	if (!query.empty()  &&  query.at(0) == '?')
+		query.erase(0, 1);
+	const NTV2StringList params (aja::split(query, '&'));
+	for (NTV2StringListConstIter it(params.begin());  it != params.end();  ++it)
+	{
+		const size_t eqPos (it->find('='));
+		string key (::PercentDecode(it->substr(0, eqPos))), value (eqPos == string::npos ? "1" : ::PercentDecode(it->substr(eqPos+1)));
+		aja::lower(key);
+		aja::lower(value);
+		const bool enable (value == "1"  ||  value == "true"  ||  value == "yes"  ||  value == "on");
+		if (key == kQParamTCPBatch)
+			mBatchWrites = enable;
+		else if (key == kQParamTCPCompress)
+			mCompress = enable;
+		else if (key == kQParamTCPSharedMem)
+		{	//	"1" or "true" means the default size, otherwise it's in megabytes
+			mSharedSpecified = true;
+			mSharedMB = enable ? ULWord(kNTV2TCPDefaultSharedMB) : ULWord(aja::stoul(value));
+			if (mSharedMB > kTCPMaxSharedMB)
+				{TCWARN("Shared memory size " << DEC(mSharedMB) << "MB reduced to " << DEC(kTCPMaxSharedMB) << "MB");  mSharedMB = kTCPMaxSharedMB;}
+		}
+		else if (!key.empty())
+			TCWARN("Unknown query parameter '" << key << "' ignored");
+	}
+}
+
+NTV2TCPClient::~NTV2TCPClient ()
+{
+	if (mSocket >= 0)
+		NTV2Disconnect();	//	Before ~NTV2RPCClientAPI, which can't call my NTV2CloseRemote
+	DetachSharedMemory();
+}
+
+NTV2TCPClient * NTV2TCPClient::FromDevice (CNTV2Card & inDevice)	//	CLASS METHOD
+{
+	return dynamic_cast<NTV2TCPClient*>(inDevice.GetRPCAPI());
+}
+
+string NTV2TCPClient::Name (void) const
+{
+	const string port (ConnectParam(kConnectParamPort));
+	return string(kLegalSchemeNTV2TCP) + "://" + HostName() + ":" + (port.empty() ? aja::to_string(NTV2NUBPORT) : port);
+}
+
+string NTV2TCPClient::Description (void) const
+{
+	return "'" + mServerDesc + "' at " + Name();
+}
+
+NTV2TCPStats NTV2TCPClient::GetStats (void) const
+{
+	AJAAutoLock tmp(&mPendingLock);
+	return mStats;
+}
+
+void NTV2TCPClient::ResetStats (void)
+{
+	AJAAutoLock tmp(&mPendingLock);
+	mStats = NTV2TCPStats();
+}
+
+
+int NTV2TCPClient::ConnectSocket (void)
+{
+	const string host (HostName()), portStr (ConnectParam(kConnectParamPort));
+	const string port (portStr.empty() ? aja::to_string(NTV2NUBPORT) : portStr);
+	struct addrinfo hints, *pAddrs(AJA_NULL);
+	::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &pAddrs)  ||  !pAddrs)
+		{TCFAIL("Can't resolve '" << host << ":" << port << "'");  return -1;}
+	int sock (int(::socket(pAddrs->ai_family, pAddrs->ai_socktype, pAddrs->ai_protocol)));
+	if (sock >= 0  &&  ::connect(sock, pAddrs->ai_addr, int(pAddrs->ai_addrlen)))
+		{TCPCloseSocket(sock);  sock = -1;}
+	::freeaddrinfo(pAddrs);
+	if (sock < 0)
+		{TCFAIL("Can't connect to '" << host << ":" << port << "'");  return -1;}
+	SetNoDelay(sock);
+	return sock;
+}
+
+bool NTV2TCPClient::NTV2OpenRemote (void)
+{
+	if (mConnected)
+		return true;
+	const int sock (ConnectSocket());
+	if (sock < 0)
+		return false;
+	mSocket = sock;
+	mConnected = true;
+	mReader.Attach(ReaderThreadStatic, this);
+	if (AJA_FAILURE(mReader.Start()))
+		{TCFAIL("Failed to start reader thread");  NTV2CloseRemote();  return false;}
+
+	//	Say hello...
+	NTV2_RPC_BLOB_TYPE request, response;
+	UWord flags(0);
+	ULWord version(0), deviceID(0);
+	size_t ndx(0);
+	PUSHU32(kTCPVersion, request);
+	if (!Transact(kTCPOpHello, request, response, flags, kTCPRequestTimeoutMs)  ||  !HasBytes(response, 0, 2 * sizeof(ULWord)))
+		{TCFAIL("No hello from " << Name());  NTV2CloseRemote();  return false;}
+	POPU32(version, response, ndx);
+	POPU32(deviceID, response, ndx);
+	if (version != kTCPVersion  ||  !PopString(mServerDesc, response, ndx))
+		{TCFAIL(Name() << " speaks protocol version " << DEC(version) << ", not " << DEC(kTCPVersion));  NTV2CloseRemote();  return false;}
+	mDeviceID = NTV2DeviceID(deviceID);
+	if (mSharedMB)
+		AttachSharedMemory();	//	Optional -- DMA goes over the socket without it
+	TCNOTE("Connected to " << Description() << (mBatchWrites ? ", batching writes" : "") << (mCompress ? ", compressing DMA" : "")
+			<< (HasSharedMemory() ? ", DMA through shared memory" : ""));
+	return true;
+}
+
+bool NTV2TCPClient::NTV2CloseRemote (void)
+{
+	if (mSocket < 0)
+		return true;
+	if (mConnected)
+		Flush();
+	mConnected = false;
+	::shutdown(mSocket, kTCPShutdownBoth);	//	Unblocks my reader thread
+	while (mReader.Active())
+		AJATime::Sleep(1);
+	TCPCloseSocket(mSocket);
+	mSocket = -1;
+	DetachSharedMemory();
+	TCDBG("Disconnected from " << Name() << ": " << GetStats());
+	return true;
+}
+
+void NTV2TCPClient::ReaderThreadStatic (AJAThread * pThread, void * pContext)	//	CLASS METHOD
+{	(void) pThread;
+	NTV2TCPClient * pClient (reinterpret_cast<NTV2TCPClient*>(pContext));
+	if (pClient)
+		pClient->ReaderThread();
+}
+
+void NTV2TCPClient::ReaderThread (void)
+{
+	ULWord id(0);
+	UWord opcode(0), flags(0);
+	NTV2_RPC_BLOB_TYPE payload;
+	while (mConnected  &&  RecvFrame(mSocket, id, opcode, flags, payload))
+	{
+		AJAAutoLock tmp(&mPendingLock);
+		mStats.bytesReceived += kTCPHeaderBytes + payload.size();
+		TCPPendingMap::iterator it (mPending.find(id));
+		if (it == mPending.end())
+			{TCWARN("Response " << DEC(id) << " opcode " << xHEX0N(opcode,4) << " has no request (timed out?)");  continue;}
+		it->second->payload.swap(payload);
+		it->second->flags = flags;
+		it->second->received = true;
+		it->second->done.Signal();
+	}
+	if (mConnected)
+		TCWARN("Connection to " << Name() << " lost");
+	mConnected = false;
+	AJAAutoLock tmp(&mPendingLock);
+	for (TCPPendingMap::iterator it(mPending.begin());  it != mPending.end();  ++it)
+		it->second->done.Signal();	//	Fail them all
+}
+
+bool NTV2TCPClient::Transact (const UWord inOpcode, const NTV2_RPC_BLOB_TYPE & inRequest, NTV2_RPC_BLOB_TYPE & outResponse,
+								UWord & outFlags, const ULWord inTimeoutMs, const UWord inRequestFlags)
+{
+	outResponse.clear();
+	outFlags = 0;
+	if (!mConnected)
+		return false;
+	TCPPending pending;
+	ULWord id(0);
+	{
+		AJAAutoLock tmp(&mPendingLock);
+		id = mNextID++;
+		mPending[id] = &pending;
+		mStats.requests++;
+	}
+	size_t bytesSent(0);
+	{
+		AJAAutoLock tmp(&mSendLock);
+		bytesSent = SendFrame(mSocket, id, inOpcode, inRequestFlags, inRequest);
+	}
+	if (bytesSent)
+		pending.done.WaitForSignal(inTimeoutMs);
+	{
+		AJAAutoLock tmp(&mPendingLock);
+		mPending.erase(id);
+		mStats.bytesSent += bytesSent;
+	}
+	if (!bytesSent)
+		{TCFAIL("Failed to send request " << DEC(id) << " opcode " << DEC(inOpcode));  return false;}
+	if (!pending.received)
+		{TCFAIL("No response to request " << DEC(id) << " opcode " << DEC(inOpcode) << (mConnected ? " -- timed out" : " -- disconnected"));  return false;}
+	outResponse.swap(pending.payload);
+	outFlags = pending.flags;
+	return (outFlags & kTCPFlagOK) != 0;
+}
+
+
+//	Register operations
+
+bool NTV2TCPClient::TakeQueuedWrites (NTV2RegisterWrites & outWrites)
+{
+	AJAAutoLock tmp(&mQueueLock);
+	outWrites.swap(mQueuedWrites);
+	mQueuedWrites.clear();
+	return !outWrites.empty();
+}
+
+bool NTV2TCPClient::RegisterBatch (NTV2RegisterWrites & inOutOps, const vector<bool> & inIsRead, vector<bool> & outOK, ULWord & outQueuedFailures)
+{
+	//	Queued writes go first, in the same round trip
+	NTV2RegisterWrites queued;
+	TakeQueuedWrites(queued);
+	outOK.assign(inOutOps.size(), false);
+	outQueuedFailures = 0;
+
+	//	Answer what reads I can locally (unless queued writes might change them), and send the rest...
+	vector<size_t> wireNdxs;
+	ULWord64 numLocal(0);
+	for (size_t ndx(0);  ndx < inOutOps.size();  ndx++)
+	{
+		NTV2RegInfo & op (inOutOps.at(ndx));
+		ULWord value(0);
+		if (inIsRead.at(ndx)  &&  queued.empty()  &&  op.registerShift < 32  &&  ReadLocalRegister(op.registerNumber, value))
+			{op.registerValue = (value & op.registerMask) >> op.registerShift;  outOK.at(ndx) = true;  numLocal++;}
+		else
+			wireNdxs.push_back(ndx);
+	}
+	if (numLocal)
+		{AJAAutoLock tmp(&mPendingLock);  mStats.localReads += numLocal;}
+	const size_t numOps (queued.size() + wireNdxs.size());
+	if (!numOps)
+		return true;
+	NTV2_RPC_BLOB_TYPE request, response;
+	NTV2RegisterWrites written (queued);
+	request.reserve(sizeof(ULWord) + numOps * (1 + 4 * sizeof(ULWord)));
+	PUSHU32(ULWord(numOps), request);
+	for (size_t ndx(0);  ndx < queued.size();  ndx++)
+		PushRegOp(queued.at(ndx), false, request);
+	for (size_t ndx(0);  ndx < wireNdxs.size();  ndx++)
+	{
+		PushRegOp(inOutOps.at(wireNdxs.at(ndx)), inIsRead.at(wireNdxs.at(ndx)), request);
+		if (!inIsRead.at(wireNdxs.at(ndx)))
+			written.push_back(inOutOps.at(wireNdxs.at(ndx)));
+	}
+	UWord flags(0);
+	const bool ok (Transact(kTCPOpRegBatch, request, response, flags, kTCPRequestTimeoutMs));
+	{
+		AJAAutoLock tmp(&mPendingLock);
+		mStats.registerOps += numOps;
+	}
+	if (!written.empty())
+		RegistersWritten(written);	//	Even upon failure -- some may have been written
+	if (!ok  ||  response.size() != numOps * (1 + sizeof(ULWord)))
+	{
+		outQueuedFailures = ULWord(queued.size());
+		if (!queued.empty())
+			{AJAAutoLock tmp(&mPendingLock);  mStats.deferredWriteFailures += queued.size();}
+		TCFAIL(DEC(numOps) << " register op(s) failed, including " << DEC(queued.size()) << " batched write(s)");
+		return false;
+	}
+	size_t ndx(0);
+	for (size_t num(0);  num < numOps;  num++)
+	{
+		UByte opOK(0);
+		ULWord value(0);
+		POPU8(opOK, response, ndx);
+		POPU32(value, response, ndx);
+		if (num < queued.size())
+		{
+			if (!opOK)
+				{outQueuedFailures++;  TCFAIL("Batched write failed: " << queued.at(num));}
+			continue;
+		}
+		const size_t opNdx (wireNdxs.at(num - queued.size()));
+		outOK.at(opNdx) = opOK != 0;
+		if (opOK  &&  inIsRead.at(opNdx))
+			inOutOps.at(opNdx).registerValue = value;
+	}
+	if (outQueuedFailures)
+		{AJAAutoLock tmp(&mPendingLock);  mStats.deferredWriteFailures += outQueuedFailures;}
+	return true;
+}
+
+bool NTV2TCPClient::Flush (void)
+{
+	NTV2RegisterWrites none;
+	vector<bool> isRead, ok;
+	ULWord failures(0);
+	return RegisterBatch(none, isRead, ok, failures)  &&  !failures;
+}
+
+bool NTV2TCPClient::SetWriteBatching (const bool inEnable)
+{
+	if (!inEnable)
+	{
+		mBatchWrites = false;
+		return Flush();
+	}
+	mBatchWrites = true;
+	return true;
+}
+
+bool NTV2TCPClient::NTV2ReadRegisterRemote (const ULWord regNum, ULWord & outRegValue, const ULWord regMask, const ULWord regShift)
+{
+	NTV2RegisterWrites ops;
+	ops.push_back(NTV2RegInfo(regNum, 0, regMask, regShift));
+	vector<bool> isRead(1, true), ok;
+	ULWord failures(0);
+	if (!RegisterBatch(ops, isRead, ok, failures)  ||  !ok.at(0))
+		return false;
+	outRegValue = ops.at(0).registerValue;
+	return true;
+}
+
+bool NTV2TCPClient::NTV2WriteRegisterRemote (const ULWord regNum, const ULWord regValue, const ULWord regMask, const ULWord regShift)
+{
+	if (!mConnected)
+		return false;
+	if (mBatchWrites)
+	{
+		size_t numQueued(0);
+		{
+			AJAAutoLock tmp(&mQueueLock);
+			mQueuedWrites.push_back(NTV2RegInfo(regNum, regValue, regMask, regShift));
+			numQueued = mQueuedWrites.size();
+		}
+		{
+			AJAAutoLock tmp(&mPendingLock);
+			mStats.batchedWrites++;
+		}
+		return numQueued < kTCPMaxQueuedWrites  ||  Flush();
+	}
+	NTV2RegisterWrites ops;
+	ops.push_back(NTV2RegInfo(regNum, regValue, regMask, regShift));
+	vector<bool> isRead(1, false), ok;
+	ULWord failures(0);
+	return RegisterBatch(ops, isRead, ok, failures)  &&  ok.at(0);
+}
+
+
+//	Shared memory
+
+bool NTV2TCPClient::AttachSharedMemory (void)
+{
+	const uint64_t pid (AJAProcess::GetPid());
+	const ULWord64 cookie (AJATime::GetSystemNanoseconds() ^ (pid << 32) ^ ULWord64(uintptr_t(this)));
+	const ULWord64 dataBytes (ULWord64(mSharedMB) * 1024ULL * 1024ULL);
+	ostringstream oss;
+	oss << kTCPSharedPrefix << DEC(pid) << "-" << HEX0N(cookie,16);
+	const string name (oss.str());
+	size_t totalBytes (size_t(kTCPSharedHeaderBytes + dataBytes));
+	UByte * pShared (reinterpret_cast<UByte*>(AJAMemory::AllocateShared(&totalBytes, name.c_str())));
+	if (!pShared  ||  totalBytes < kTCPSharedHeaderBytes + dataBytes)
+	{
+		TCWARN("Can't allocate " << DEC(mSharedMB) << "MB shared memory '" << name << "' -- DMA goes over the socket");
+		if (pShared)
+			AJAMemory::FreeShared(pShared);
+		UnlinkShared(name);
+		return false;
+	}
+	NTV2TCPSharedHeader * pHeader (reinterpret_cast<NTV2TCPSharedHeader*>(pShared));
+	pHeader->magic = kTCPSharedMagic;
+	pHeader->version = kTCPVersion;
+	pHeader->cookie = cookie;
+	pHeader->dataBytes = dataBytes;
+
+	//	Have the server map it...
+	NTV2_RPC_BLOB_TYPE request, response;
+	UWord flags(0);
+	PushString(name, request);
+	PUSHU64(ULWord64(totalBytes), request);
+	PUSHU64(cookie, request);
+	const bool ok (Transact(kTCPOpSharedMemory, request, response, flags, kTCPRequestTimeoutMs));
+	UnlinkShared(name);		//	Both ends have it mapped by now, or never will
+	if (!ok)
+	{
+		TCNOTE(Name() << " can't map shared memory (different host?) -- DMA goes over the socket");
+		AJAMemory::FreeShared(pShared);
+		return false;
+	}
+	AJAAutoLock tmp(&mSharedLock);
+	mSharedFree.clear();
+	mSharedUsed.clear();
+	mSharedFree[0] = dataBytes;
+	mSharedBytes = dataBytes;
+	mpSharedMem = pShared;
+	return true;
+}
+
+void NTV2TCPClient::DetachSharedMemory (void)
+{
+	AJAAutoLock tmp(&mSharedLock);
+	if (!mpSharedMem)
+		return;
+	if (!mSharedUsed.empty())
+		TCWARN(DEC(mSharedUsed.size()) << " shared buffer(s) still allocated -- now invalid");
+	AJAMemory::FreeShared(mpSharedMem);
+	mpSharedMem = AJA_NULL;
+	mSharedBytes = 0;
+	mSharedFree.clear();
+	mSharedUsed.clear();
+}
+
+UByte * NTV2TCPClient::SharedData (void) const
+{
+	return mpSharedMem ? mpSharedMem + kTCPSharedHeaderBytes : AJA_NULL;
+}
+
+bool NTV2TCPClient::SharedOffset (const void * pHost, const ULWord64 inByteCount, ULWord64 & outOffset) const
+{
+	const UByte * pData (SharedData()), * pBytes (reinterpret_cast<const UByte*>(pHost));
+	if (!pData  ||  pBytes < pData  ||  pBytes >= pData + mSharedBytes  ||  inByteCount > ULWord64(pData + mSharedBytes - pBytes))
+		return false;
+	outOffset = ULWord64(pBytes - pData);
+	return true;
+}
+
+bool NTV2TCPClient::AllocateSharedBlock (const ULWord64 inByteCount, ULWord64 & outOffset)
+{
+	const ULWord64 numBytes ((inByteCount + kTCPSharedAlign - 1) / kTCPSharedAlign * kTCPSharedAlign);
+	AJAAutoLock tmp(&mSharedLock);
+	if (!mpSharedMem  ||  !numBytes)
+		return false;
+	for (SharedBlockMap::iterator it(mSharedFree.begin());  it != mSharedFree.end();  ++it)
+		if (it->second >= numBytes)
+		{	//	First fit
+			outOffset = it->first;
+			if (it->second > numBytes)
+				mSharedFree[it->first + numBytes] = it->second - numBytes;
+			mSharedFree.erase(it);
+			mSharedUsed[outOffset] = numBytes;
+			return true;
+		}
+	return false;
+}
+
+bool NTV2TCPClient::FreeSharedBlock (const ULWord64 inOffset)
+{
+	AJAAutoLock tmp(&mSharedLock);
+	SharedBlockMap::iterator used (mSharedUsed.find(inOffset));
+	if (used == mSharedUsed.end())
+		return false;
+	ULWord64 numBytes (used->second);
+	mSharedUsed.erase(used);
+
+	//	Coalesce with the free blocks on either side...
+	SharedBlockMap::iterator next (mSharedFree.lower_bound(inOffset));
+	if (next != mSharedFree.end()  &&  inOffset + numBytes == next->first)
+		{numBytes += next->second;  mSharedFree.erase(next++);}
+	if (next != mSharedFree.begin())
+	{
+		SharedBlockMap::iterator prev (next);
+		--prev;
+		if (prev->first + prev->second == inOffset)
+			{prev->second += numBytes;  return true;}
+	}
+	mSharedFree[inOffset] = numBytes;
+	return true;
+}
+
+bool NTV2TCPClient::AllocateSharedBuffer (const size_t inByteCount, NTV2Buffer & outBuffer)
+{
+	ULWord64 offset(0);
+	if (!AllocateSharedBlock(inByteCount, offset))
+		{TCFAIL("Can't allocate " << DEC(inByteCount) << "-byte shared buffer" << (HasSharedMemory() ? "" : " -- no shared memory"));  return false;}
+	return outBuffer.Set(SharedData() + offset, inByteCount);
+}
+
+bool NTV2TCPClient::FreeSharedBuffer (NTV2Buffer & inOutBuffer)
+{
+	ULWord64 offset(0);
+	if (!SharedOffset(inOutBuffer.GetHostPointer(), inOutBuffer.GetByteCount(), offset)  ||  !FreeSharedBlock(offset))
+		{TCFAIL(inOutBuffer << " not allocated by AllocateSharedBuffer");  return false;}
+	return inOutBuffer.Set(AJA_NULL, 0);
+}
+
+//	Finds shared memory for a transfer:  the host buffer itself if it's in my segment, otherwise a temporary block (filled from the host buffer if inCopyIn).
+bool NTV2TCPClient::StageShared (const UByte * pHost, const ULWord64 inByteCount, const bool inCopyIn, ULWord64 & outOffset, bool & outStaged)
+{
+	outStaged = false;
+	if (SharedOffset(pHost, inByteCount, outOffset))
+		return true;
+	if (!AllocateSharedBlock(inByteCount, outOffset))
+		{TCDBG("No room for " << DEC(inByteCount) << " byte(s) in shared memory");  return false;}
+	outStaged = true;
+	if (inCopyIn)
+		::memcpy(SharedData() + outOffset, pHost, size_t(inByteCount));
+	return true;
+}
+
+void NTV2TCPClient::UnstageShared (UByte * pHost, const ULWord64 inByteCount, const bool inCopyOut, const ULWord64 inOffset, const bool inStaged)
+{
+	if (!inStaged)
+		return;
+	if (inCopyOut)
+		::memcpy(pHost, SharedData() + inOffset, size_t(inByteCount));
+	FreeSharedBlock(inOffset);
+}
+
+bool NTV2TCPClient::SharedAutoCirculateTransfer (AUTOCIRCULATE_TRANSFER & inOutXfer)
+{
+	const bool isCapture (NTV2_IS_INPUT_CROSSPOINT(inOutXfer.acCrosspoint));
+	ULWord64 offsets[kTCPNumSharedXferBufs], sharedBytes(0), stagedBytes(0);
+	bool staged[kTCPNumSharedXferBufs];
+	NTV2_RPC_BLOB_TYPE request, response;
+	UWord flags(0);
+	size_t ndx(0), numBufs(0);
+	bool ok (true);
+	if (!Flush())
+		return false;
+	for (;  ok  &&  numBufs < kTCPNumSharedXferBufs;  numBufs++)
+	{
+		const NTV2Buffer & buffer (*TransferBuffer(inOutXfer, numBufs));
+		offsets[numBufs] = 0;
+		staged[numBufs] = false;
+		if (!buffer.IsNULL())
+			ok = StageShared(reinterpret_cast<const UByte*>(buffer.GetHostPointer()), buffer.GetByteCount(), !isCapture, offsets[numBufs], staged[numBufs]);
+		PUSHU64(offsets[numBufs], request);
+		PUSHU32(buffer.GetByteCount(), request);
+		sharedBytes += buffer.GetByteCount();
+		stagedBytes += staged[numBufs] ? buffer.GetByteCount() : 0;
+	}
+	if (!ok)
+		TCFAIL("No room for " << DEC(sharedBytes) << " transfer byte(s) in " << DEC(mSharedBytes) << "-byte shared memory");
+	else
+		ok = PushTransferSansBuffers(inOutXfer, request)
+				&&  Transact(kTCPOpSharedACXfer, request, response, flags, kTCPRequestTimeoutMs)
+				&&  inOutXfer.acTransferStatus.RPCDecode(response, ndx);
+	for (size_t num(0);  num < numBufs;  num++)
+	{
+		NTV2Buffer & buffer (*TransferBuffer(inOutXfer, num));
+		UnstageShared(reinterpret_cast<UByte*>(buffer.GetHostPointer()), buffer.GetByteCount(), ok && isCapture, offsets[num], staged[num]);
+	}
+	if (!ok)
+		return false;
+	AJAAutoLock tmp(&mPendingLock);
+	mStats.sharedBytes += sharedBytes;
+	mStats.stagedBytes += stagedBytes;
+	return true;
+}
+
+
+//	Other device operations
+
+bool NTV2TCPClient::NTV2AutoCirculateRemote (AUTOCIRCULATE_DATA & autoCircData)
+{
+	if (!Flush())
+		return false;
+	NTV2_RPC_BLOB_TYPE request, response;
+	UWord flags(0);
+	PushAutoCirculateData(autoCircData, request);
+	if (!Transact(kTCPOpAutoCirculate, request, response, flags, kTCPRequestTimeoutMs))
+		return false;
+	if (autoCircData.eCommand == eGetAutoCirc  &&  autoCircData.pvVal1)
+	{
+		size_t ndx(0);
+		return reinterpret_cast<AUTOCIRCULATE_STATUS_STRUCT*>(autoCircData.pvVal1)->RPCDecode(response, ndx);
+	}
+	return true;
+}
+
+bool NTV2TCPClient::NTV2WaitForInterruptRemote (const INTERRUPT_ENUMS eInterrupt, const ULWord timeOutMs)
+{
+	if (!NTV2_IS_VALID_INTERRUPT_ENUM(eInterrupt))
+		return false;
+	if (!Flush())
+		return false;
+	NTV2_RPC_BLOB_TYPE request, response;
+	UWord flags(0);
+	PUSHU32(ULWord(eInterrupt), request);
+	PUSHU32(timeOutMs, request);
+	return Transact(kTCPOpWaitInterrupt, request, response, flags, timeOutMs + kTCPRequestTimeoutMs);
+}
+
+bool NTV2TCPClient::NTV2WaitForAnyInterruptRemote (NTV2InterruptWaitSet & inOutWaitSet, const ULWord timeOutMs)
+{
+	if (!Flush())
+		return false;
+	NTV2_RPC_BLOB_TYPE request, response;
+	UWord flags(0);
+	PUSHU32(timeOutMs, request);
+	PUSHU64(inOutWaitSet.GetMask(), request);
+	PUSHU64(inOutWaitSet.GetBaselineMask(), request);
+	for (int intr(0);  intr < eNumInterruptTypes;  intr++)
+		PUSHU64(inOutWaitSet.GetCount(INTERRUPT_ENUMS(intr)), request);
+	const bool fired (Transact(kTCPOpWaitAny, request, response, flags, timeOutMs + kTCPRequestTimeoutMs));
+	if (response.size() != size_t(eNumInterruptTypes) * (1 + 2 * sizeof(ULWord64)))
+		return false;	//	Failed -- no results
+	//	Take the server's counts even upon timeout, to establish the baseline for the next wait
+	size_t ndx(0);
+	for (int intr(0);  intr < eNumInterruptTypes;  intr++)
+	{
+		const INTERRUPT_ENUMS source = INTERRUPT_ENUMS(intr);
+		UByte state(0);
+		ULWord64 count(0), time(0);
+		POPU8(state, response, ndx);
+		POPU64(count, response, ndx);
+		POPU64(time, response, ndx);
+		if (!state  ||  !inOutWaitSet.Contains(source))
+			continue;
+		if (state == kTCPIntFired  &&  !inOutWaitSet.HasBaseline(source))
+			inOutWaitSet.SetResult(source, count - 1, 0);	//	Server had the baseline -- adopt the one it fired from
+		inOutWaitSet.SetResult(source, count, time);
+	}
+	return fired  &&  inOutWaitSet.GetFiredMask();
+}
+
+bool NTV2TCPClient::NTV2DMATransferRemote (const NTV2DMAEngine inDMAEngine,	const bool inIsRead,
+											const ULWord inFrameNumber,			NTV2Buffer & inOutBuffer,
+											const ULWord inCardOffsetBytes,		const ULWord inNumSegments,
+											const ULWord inSegmentHostPitch,	const ULWord inSegmentCardPitch,
+											const bool inSynchronous)
+{
+	if (inOutBuffer.IsNULL())
+		{TCFAIL("NULL or empty host buffer");  return false;}
+	NTV2TCPDMAParams params;
+	params.engine = UWord(inDMAEngine);
+	params.isRead = inIsRead ? 1 : 0;
+	params.isSync = inSynchronous ? 1 : 0;
+	params.frameNum = inFrameNumber;
+	params.cardOffset = inCardOffsetBytes;
+	params.segBytes = inOutBuffer.GetByteCount();
+	params.numSegs = inNumSegments;
+	params.hostPitch = inSegmentHostPitch;
+	params.cardPitch = inSegmentCardPitch;
+	const size_t extent (params.Extent());
+	UByte * pHost (reinterpret_cast<UByte*>(inOutBuffer.GetHostPointer()));
+	NTV2_RPC_BLOB_TYPE request, response;
+	UWord requestFlags(0), flags(0);
+	ULWord64 offset(0);
+	bool staged(false);
+	if (HasSharedMemory()  &&  StageShared(pHost, extent, !inIsRead, offset, staged))
+	{	//	Only the offset goes over the socket
+		params.Push(request);
+		PUSHU64(offset, request);
+		const bool ok (Flush()  &&  Transact(kTCPOpSharedDMA, request, response, flags, kTCPRequestTimeoutMs));
+		UnstageShared(pHost, extent, ok && inIsRead, offset, staged);
+		if (!ok)
+			return false;
+		AJAAutoLock tmp(&mPendingLock);
+		mStats.dmaBytes += extent;
+		mStats.sharedBytes += extent;
+		mStats.stagedBytes += staged ? extent : 0;
+		return true;
+	}
+	if (extent > kTCPMaxPayload)
+		{TCFAIL(DEC(extent) << "-byte transfer exceeds " << DEC(kTCPMaxPayload) << "-byte limit");  return false;}
+	if (!Flush())
+		return false;
+	request.reserve(32 + (inIsRead ? 0 : extent));
+	params.Push(request);
+	const size_t paramBytes (request.size());
+	if (inIsRead)
+		requestFlags = mCompress ? kTCPFlagWantCompressed : 0;
+	else if (PushPayload(pHost, extent, mCompress, request))
+		requestFlags = kTCPFlagCompressed;
+	if (!Transact(kTCPOpDMA, request, response, flags, kTCPRequestTimeoutMs, requestFlags))
+		return false;
+	if (inIsRead  &&  !PopPayload(response, 0, (flags & kTCPFlagCompressed) != 0, pHost, extent))
+		{TCFAIL("Bad " << DEC(response.size()) << "-byte DMA read response for " << DEC(extent) << " byte(s)");  return false;}
+	AJAAutoLock tmp(&mPendingLock);
+	mStats.dmaBytes += extent;
+	mStats.dmaWireBytes += inIsRead ? response.size() : request.size() - paramBytes;
+	return true;
+}
+
+bool NTV2TCPClient::NTV2MessageRemote (NTV2_HEADER * pInMessage)
+{
+	if (!pInMessage)
+		return false;
+	switch (pInMessage->GetType())
+	{
+		case NTV2_TYPE_GETREGS:
+		{	//	One round trip
+			NTV2GetRegisters & getRegs (*reinterpret_cast<NTV2GetRegisters*>(pInMessage));
+			const ULWord * pRegNums (getRegs.mInRegisters);
+			ULWord * pGoodRegs (getRegs.mOutGoodRegisters);
+			ULWord * pValues (getRegs.mOutValues);
+			const ULWord numRegs (getRegs.mInNumRegisters);
+			if (!pRegNums  ||  !pGoodRegs  ||  !pValues  ||  getRegs.mInRegisters.GetByteCount() < numRegs * sizeof(ULWord)
+				||  getRegs.mOutGoodRegisters.GetByteCount() < numRegs * sizeof(ULWord)  ||  getRegs.mOutValues.GetByteCount() < numRegs * sizeof(ULWord))
+					return false;
+			NTV2RegisterWrites ops;
+			for (ULWord ndx(0);  ndx < numRegs;  ndx++)
+				ops.push_back(NTV2RegInfo(pRegNums[ndx]));
+			vector<bool> isRead(ops.size(), true), ok;
+			ULWord failures(0);
+			if (!RegisterBatch(ops, isRead, ok, failures))
+				return false;
+			ULWord numGood(0);
+			for (ULWord ndx(0);  ndx < numRegs;  ndx++)
+				if (ok.at(ndx))
+					{pGoodRegs[numGood] = ops.at(ndx).registerNumber;  pValues[numGood] = ops.at(ndx).registerValue;  numGood++;}
+			getRegs.mOutNumRegisters = numGood;
+			return true;
+		}
+		case NTV2_TYPE_SETREGS:
+		{	//	One round trip
+			NTV2SetRegisters & setRegs (*reinterpret_cast<NTV2SetRegisters*>(pInMessage));
+			const NTV2RegInfo * pRegInfos (setRegs.mInRegInfos);
+			const ULWord numRegs (setRegs.mInNumRegisters);
+			if (!pRegInfos  ||  setRegs.mInRegInfos.GetByteCount() < numRegs * sizeof(NTV2RegInfo))
+				return false;
+			const NTV2RegisterWrites writes (pRegInfos, pRegInfos + numRegs);
+			NTV2RegisterWrites ops (writes);
+			vector<bool> isRead(ops.size(), false), ok;
+			ULWord failures(0);
+			if (!RegisterBatch(ops, isRead, ok, failures))
+				return false;
+			UWord * pBadNdxs (setRegs.mOutBadRegIndexes);
+			const ULWord maxBad (ULWord(setRegs.mOutBadRegIndexes.GetByteCount() / sizeof(UWord)));
+			setRegs.mOutNumFailures = 0;
+			for (ULWord ndx(0);  ndx < numRegs;  ndx++)
+				if (!ok.at(ndx))
+				{
+					if (pBadNdxs  &&  setRegs.mOutNumFailures < maxBad)
+						pBadNdxs[setRegs.mOutNumFailures] = UWord(ndx);
+					setRegs.mOutNumFailures++;
+				}
+			return true;
+		}
+		case NTV2_TYPE_ACSTATUS:
+		{
+			if (!Flush())
+				return false;
+			AUTOCIRCULATE_STATUS & status (*reinterpret_cast<AUTOCIRCULATE_STATUS*>(pInMessage));
+			NTV2_RPC_BLOB_TYPE request, response;
+			UWord flags(0);
+			size_t ndx(0);
+			PUSHU32(ULWord(NTV2_TYPE_ACSTATUS), request);
+			if (!status.RPCEncode(request))
+				return false;
+			if (!Transact(kTCPOpMessage, request, response, flags, kTCPRequestTimeoutMs))
+				return false;
+			return status.RPCDecode(response, ndx);
+		}
+		case NTV2_TYPE_ACXFER:
+			if (!HasSharedMemory())
+				{TCFAIL("AUTOCIRCULATE_TRANSFER requires shared memory");  return false;}
+			return SharedAutoCirculateTransfer(*reinterpret_cast<AUTOCIRCULATE_TRANSFER*>(pInMessage));
+		default:
+			break;	//	Others aren't supported
+	}
+	return false;
+}
+
+bool NTV2TCPClient::NTV2GetDeviceProfileRemote (NTV2DeviceProfile & outProfile)
+{
+	NTV2_RPC_BLOB_TYPE request, response;
+	UWord flags(0);
+	outProfile.Clear();
+	return Transact(kTCPOpProfile, request, response, flags, kTCPRequestTimeoutMs)  &&  outProfile.Decode(response);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	NTV2TCPServerConnection
+
+//	One per request handed off to a waiter thread
+struct NTV2TCPRequest
+{
+	ULWord				id;
+	UWord				opcode;
+	UWord				flags;
+	NTV2_RPC_BLOB_TYPE	payload;
+};
+
+/**
+	@brief	Services one NTV2TCPClient connection for an NTV2TCPServer.
+**/
+class NTV2TCPServerConnection
+{
+	public:
+		NTV2TCPServerConnection (NTV2TCPServer & inServer, CNTV2Card & inDevice, const int inSocket, const ULWord inID);
+		~NTV2TCPServerConnection ();	///< @brief	Closes me.
+		bool			Start (void);	///< @brief	Starts my threads.
+		void			Close (void);	///< @brief	Closes my socket and stops my threads.
+		inline bool		IsDone (void) const		{return mDone;}		///< @return	True if the client disconnected.
+		inline ULWord	GetID (void) const		{return mID;}		///< @return	My connection ID (unique per server).
+
+	private:
+		void			ReaderThread (void);
+		void			WaiterThread (void);
+		void			Process (const NTV2TCPRequest & inRequest);
+		bool			Handle (const NTV2TCPRequest & inRequest, NTV2_RPC_BLOB_TYPE & outResponse, UWord & outFlags);
+		bool			HandleRegBatch (const NTV2_RPC_BLOB_TYPE & inRequest, NTV2_RPC_BLOB_TYPE & outResponse);
+		bool			HandleDMA (const NTV2TCPRequest & inRequest, NTV2_RPC_BLOB_TYPE & outResponse, UWord & outFlags);
+		bool			HandleSharedMemory (const NTV2_RPC_BLOB_TYPE & inRequest);
+		bool			HandleSharedDMA (const NTV2_RPC_BLOB_TYPE & inRequest);
+		bool			HandleSharedACXfer (const NTV2_RPC_BLOB_TYPE & inRequest, NTV2_RPC_BLOB_TYPE & outResponse);
+		UByte *			SharedAt (const ULWord64 inOffset, const ULWord64 inByteCount) const;
+		static void		ReaderThreadStatic (AJAThread * pThread, void * pContext);
+		static void		WaiterThreadStatic (AJAThread * pThread, void * pContext);
+
+	private:
+		NTV2TCPServer &				mServer;
+		CNTV2Card &					mDevice;
+		int							mSocket;
+		ULWord						mID;
+		bool						mDone;
+		bool						mQuit;
+		AJAThread					mReader;
+		AJAThread					mWaiters[kTCPNumWaiters];
+		AJALock						mSendLock;		///< @brief	Serializes responses on mSocket
+		AJALock						mQueueLock;		///< @brief	Guards mQueue
+		AJAEvent					mQueueEvent;	///< @brief	Signaled when a request is queued
+		std::deque<NTV2TCPRequest>	mQueue;			///< @brief	Interrupt waits (and other blocking requests) for my waiter threads
+		UByte *						mpShared;		///< @brief	Client's shared memory segment (or NULL)
+		ULWord64					mSharedBytes;	///< @brief	Size of its data area
+};
+
+NTV2TCPServerConnection::NTV2TCPServerConnection (NTV2TCPServer & inServer, CNTV2Card & inDevice, const int inSocket, const ULWord inID)
+	:	mServer		(inServer),
+		mDevice		(inDevice),
+		mSocket		(inSocket),
+		mID			(inID),
+		mDone		(false),
+		mQuit		(false),
+		mQueueEvent	(/*manualReset*/false),
+		mpShared	(AJA_NULL),
+		mSharedBytes(0)
+{
+}
+
+NTV2TCPServerConnection::~NTV2TCPServerConnection ()
+{
+	Close();
+}
+
+bool NTV2TCPServerConnection::Start (void)
+{
+	mReader.Attach(ReaderThreadStatic, this);
+	if (AJA_FAILURE(mReader.Start()))
+		{TSFAIL("Failed to start reader thread");  return false;}
+	for (size_t ndx(0);  ndx < kTCPNumWaiters;  ndx++)
+	{
+		mWaiters[ndx].Attach(WaiterThreadStatic, this);
+		if (AJA_FAILURE(mWaiters[ndx].Start()))
+			{TSFAIL("Failed to start waiter thread " << DEC(ndx));  return false;}
+	}
+	return true;
+}
+
+void NTV2TCPServerConnection::Close (void)
+{
+	if (mSocket < 0)
+		return;
+	mQuit = true;
+	::shutdown(mSocket, kTCPShutdownBoth);	//	Unblocks my reader thread
+	while (mReader.Active())
+		AJATime::Sleep(1);
+	for (size_t ndx(0);  ndx < kTCPNumWaiters;  ndx++)
+		while (mWaiters[ndx].Active())
+			{mQueueEvent.Signal();  AJATime::Sleep(1);}
+	TCPCloseSocket(mSocket);
+	if (mpShared)
+		{AJAMemory::FreeShared(mpShared);  mpShared = AJA_NULL;}
+	mSocket = -1;
+	mDone = true;
+}
+
+void NTV2TCPServerConnection::ReaderThreadStatic (AJAThread * pThread, void * pContext)	//	CLASS METHOD
+{	(void) pThread;
+	NTV2TCPServerConnection * pConn (reinterpret_cast<NTV2TCPServerConnection*>(pContext));
+	if (pConn)
+		pConn->ReaderThread();
+}
+
+void NTV2TCPServerConnection::WaiterThreadStatic (AJAThread * pThread, void * pContext)	//	CLASS METHOD
+{	(void) pThread;
+	NTV2TCPServerConnection * pConn (reinterpret_cast<NTV2TCPServerConnection*>(pContext));
+	if (pConn)
+		pConn->WaiterThread();
+}
+
+void NTV2TCPServerConnection::ReaderThread (void)
+{
+	NTV2TCPRequest request;
+	while (!mQuit  &&  RecvFrame(mSocket, request.id, request.opcode, request.flags, request.payload))
+	{
+		if (IsWaitOpcode(request.opcode)  ||  (request.opcode >= kNTV2TCPOpcodeUser  &&  mServer.IsBlockingRequest(request.opcode)))
+		{	//	Hand off to a waiter thread, so it doesn't hold up the requests behind it
+			AJAAutoLock tmp(&mQueueLock);
+			mQueue.push_back(request);
+			mQueueEvent.Signal();
+		}
+		else
+			Process(request);
+	}
+	TSDBG("Connection " << DEC(mSocket) << " closed");
+	mDone = true;
+}
+
+void NTV2TCPServerConnection::WaiterThread (void)
+{
+	while (!mQuit)
+	{
+		NTV2TCPRequest request;
+		bool haveRequest(false);
+		{
+			AJAAutoLock tmp(&mQueueLock);
+			if (!mQueue.empty())
+				{request = mQueue.front();  mQueue.pop_front();  haveRequest = true;}
+		}
+		if (haveRequest)
+			Process(request);
+		else
+			mQueueEvent.WaitForSignal(10);
+	}
+}
+
+void NTV2TCPServerConnection::Process (const NTV2TCPRequest & inRequest)
+{
+	NTV2_RPC_BLOB_TYPE response;
+	UWord flags(0);
+	if (Handle(inRequest, response, flags))
+		flags |= kTCPFlagOK;
+	AJAAutoLock tmp(&mSendLock);
+	if (!SendFrame(mSocket, inRequest.id, inRequest.opcode | kTCPResponseBit, flags, response)  &&  !mQuit)
+		TSWARN("Failed to send response " << DEC(inRequest.id));
+}
+
+bool NTV2TCPServerConnection::Handle (const NTV2TCPRequest & inRequest, NTV2_RPC_BLOB_TYPE & outResponse, UWord & outFlags)
+{
+	const NTV2_RPC_BLOB_TYPE & request (inRequest.payload);
+	size_t ndx(0);
+	switch (inRequest.opcode)
+	{
+		case kTCPOpHello:
+			PUSHU32(kTCPVersion, outResponse);
+			PUSHU32(ULWord(mDevice.GetDeviceID()), outResponse);
+			PushString(mDevice.GetDisplayName(), outResponse);
+			return true;
+
+		case kTCPOpRegBatch:
+			return HandleRegBatch(request, outResponse);
+
+		case kTCPOpAutoCirculate:
+		{
+			AUTOCIRCULATE_DATA acData;		//	Its constructor zeroes it
+			AUTOCIRCULATE_STATUS_STRUCT acStatus;
+			::memset(&acStatus, 0, sizeof(acStatus));
+			if (!PopAutoCirculateData(acData, request, ndx))
+				return false;
+			switch (acData.eCommand)
+			{	//	Only commands that need no pointers (other than eGetAutoCirc's status) -- the rest would dereference NULL
+				case eInitAutoCirc:		case eStartAutoCirc:		case eStopAutoCirc:			case eAbortAutoCirc:
+				case ePauseAutoCirc:	case eFlushAutoCirculate:	case ePrerollAutoCirculate:	case eSetActiveFrame:
+				case eStartAutoCircAtTime:	case eGetAutoCirc:
+					break;
+				default:
+					TSWARN("Rejected AutoCirculate command " << DEC(acData.eCommand));
+					return false;
+			}
+			if (acData.eCommand == eGetAutoCirc)
+				acData.pvVal1 = &acStatus;
+			if (!mDevice.AutoCirculate(acData))
+				return false;
+			if (acData.eCommand == eGetAutoCirc)
+				acStatus.RPCEncode(outResponse);
+			return true;
+		}
+
+		case kTCPOpMessage:
+		{
+			ULWord type(0);
+			if (!HasBytes(request, ndx, sizeof(ULWord)))
+				return false;
+			POPU32(type, request, ndx);
+			if (type != NTV2_TYPE_ACSTATUS)
+				return false;
+			AUTOCIRCULATE_STATUS status;
+			if (!status.RPCDecode(request, ndx))
+				return false;
+			const bool ok (mDevice.NTV2Message(reinterpret_cast<NTV2_HEADER*>(&status)));
+			status.RPCEncode(outResponse);
+			return ok;
+		}
+
+		case kTCPOpWaitInterrupt:
+		{
+			ULWord intr(0), timeoutMs(0);
+			if (!HasBytes(request, ndx, 2 * sizeof(ULWord)))
+				return false;
+			POPU32(intr, request, ndx);
+			POPU32(timeoutMs, request, ndx);
+			if (!NTV2_IS_VALID_INTERRUPT_ENUM(INTERRUPT_ENUMS(intr)))
+				{TSWARN("Rejected invalid interrupt " << DEC(intr));  return false;}
+			return mDevice.WaitForInterrupt(INTERRUPT_ENUMS(intr), timeoutMs);
+		}
+
+		case kTCPOpWaitAny:
+		{
+			ULWord timeoutMs(0);
+			ULWord64 mask(0), baselineMask(0);
+			if (request.size() != sizeof(ULWord) + size_t(2 + eNumInterruptTypes) * sizeof(ULWord64))
+				return false;
+			POPU32(timeoutMs, request, ndx);
+			POPU64(mask, request, ndx);
+			POPU64(baselineMask, request, ndx);
+			NTV2InterruptWaitSet waitSet;
+			for (int intr(0);  intr < eNumInterruptTypes;  intr++)
+			{
+				ULWord64 count(0);
+				POPU64(count, request, ndx);
+				if (mask & (ULWord64(1) << intr))
+					waitSet.Add(INTERRUPT_ENUMS(intr));
+				if (mask & baselineMask & (ULWord64(1) << intr))
+					waitSet.SetResult(INTERRUPT_ENUMS(intr), count, 0);	//	Client's last-seen count
+			}
+			const bool fired (mDevice.WaitForAnyInterrupt(waitSet, timeoutMs));
+			for (int intr(0);  intr < eNumInterruptTypes;  intr++)
+			{
+				const INTERRUPT_ENUMS source = INTERRUPT_ENUMS(intr);
+				PUSHU8(waitSet.HasFired(source) ? kTCPIntFired : (waitSet.HasBaseline(source) ? kTCPIntCounted : 0), outResponse);
+				PUSHU64(waitSet.GetCount(source), outResponse);
+				PUSHU64(waitSet.GetTime(source), outResponse);
+			}
+			return fired;
+		}
+
+		case kTCPOpDMA:
+			return HandleDMA(inRequest, outResponse, outFlags);
+
+		case kTCPOpSharedMemory:
+			return HandleSharedMemory(request);
+
+		case kTCPOpSharedDMA:
+			return HandleSharedDMA(request);
+
+		case kTCPOpSharedACXfer:
+			return HandleSharedACXfer(request, outResponse);
+
+		case kTCPOpProfile:
+		{
+			NTV2DeviceProfile profile;
+			return mDevice.GetDeviceProfile(profile)  &&  profile.Encode(outResponse);
+		}
+
+		default:
+			if (inRequest.opcode >= kNTV2TCPOpcodeUser)
+				return mServer.HandleRequest(mID, inRequest.opcode, request, outResponse);
+			break;
+	}
+	TSWARN("Unknown opcode " << xHEX0N(inRequest.opcode,4));
+	return false;
+}
+
+bool NTV2TCPServerConnection::HandleRegBatch (const NTV2_RPC_BLOB_TYPE & inRequest, NTV2_RPC_BLOB_TYPE & outResponse)
+{
+	size_t ndx(0);
+	ULWord numOps(0);
+	if (!HasBytes(inRequest, ndx, sizeof(ULWord)))
+		return false;
+	POPU32(numOps, inRequest, ndx);
+	if (inRequest.size() != sizeof(ULWord) + size_t(numOps) * (1 + 4 * sizeof(ULWord)))
+		return false;
+	NTV2RegisterWrites ops;
+	vector<bool> isRead;
+	ops.reserve(numOps);
+	for (ULWord num(0);  num < numOps;  num++)
+	{
+		UByte read(0);
+		NTV2RegInfo op;
+		POPU8(read, inRequest, ndx);
+		POPU32(op.registerNumber, inRequest, ndx);
+		POPU32(op.registerValue, inRequest, ndx);
+		POPU32(op.registerMask, inRequest, ndx);
+		POPU32(op.registerShift, inRequest, ndx);
+		if (op.registerShift > 31)
+			return false;
+		ops.push_back(op);
+		isRead.push_back(read != 0);
+	}
+
+	//	Consecutive reads go in one ReadRegisters call, consecutive writes in one WriteRegisters call, in order
+	outResponse.reserve(size_t(numOps) * (1 + sizeof(ULWord)));
+	for (size_t first(0);  first < ops.size();  )
+	{
+		size_t end (first + 1);
+		while (end < ops.size()  &&  isRead.at(end) == isRead.at(first))
+			end++;
+		bool ok(false);
+		if (isRead.at(first))
+		{
+			NTV2RegisterReads reads;
+			for (size_t num(first);  num < end;  num++)
+				reads.push_back(NTV2RegInfo(ops.at(num).registerNumber));
+			ok = mDevice.ReadRegisters(reads);
+			for (size_t num(first);  num < end;  num++)
+				ops.at(num).registerValue = (reads.at(num - first).registerValue & ops.at(num).registerMask) >> ops.at(num).registerShift;
+		}
+		else
+			ok = mDevice.WriteRegisters(NTV2RegisterWrites(ops.begin() + ptrdiff_t(first), ops.begin() + ptrdiff_t(end)));
+		for (size_t num(first);  num < end;  num++)
+		{
+			PUSHU8(ok ? 1 : 0, outResponse);
+			PUSHU32(isRead.at(num) && ok ? ops.at(num).registerValue : 0, outResponse);
+		}
+		first = end;
+	}
+	return true;
+}
+
+bool NTV2TCPServerConnection::HandleDMA (const NTV2TCPRequest & inRequest, NTV2_RPC_BLOB_TYPE & outResponse, UWord & outFlags)
+{
+	const NTV2_RPC_BLOB_TYPE & request (inRequest.payload);
+	size_t ndx(0);
+	NTV2TCPDMAParams params;
+	if (!params.Pop(request, ndx))
+		return false;
+	const size_t extent (params.Extent());
+	if (extent > kTCPMaxPayload)
+		return false;
+	NTV2Buffer hostBuffer(extent);
+	if (!hostBuffer)
+		return false;
+	UByte * pHost (reinterpret_cast<UByte*>(hostBuffer.GetHostPointer()));
+	if (!params.isRead  &&  !PopPayload(request, ndx, (inRequest.flags & kTCPFlagCompressed) != 0, pHost, extent))
+		{TSFAIL("Bad " << DEC(request.size()) << "-byte DMA write request for " << DEC(extent) << " byte(s)");  return false;}
+	const bool ok (params.Transfer(mDevice, pHost));
+	if (ok  &&  params.isRead  &&  PushPayload(pHost, extent, (inRequest.flags & kTCPFlagWantCompressed) != 0, outResponse))
+		outFlags |= kTCPFlagCompressed;
+	return ok;
+}
+
+bool NTV2TCPServerConnection::HandleSharedMemory (const NTV2_RPC_BLOB_TYPE & inRequest)
+{
+	size_t ndx(0);
+	string name;
+	ULWord64 totalBytes(0), cookie(0);
+	if (mpShared  ||  !PopString(name, inRequest, ndx)  ||  !HasBytes(inRequest, ndx, 2 * sizeof(ULWord64)))
+		return false;
+	POPU64(totalBytes, inRequest, ndx);
+	POPU64(cookie, inRequest, ndx);
+	if (!IsSharedName(name)  ||  totalBytes <= kTCPSharedHeaderBytes  ||  totalBytes > kTCPSharedHeaderBytes + ULWord64(kTCPMaxSharedMB) * 1024ULL * 1024ULL)
+		{TSFAIL("Bad shared memory '" << name << "' size " << DEC(totalBytes));  return false;}
+	size_t mappedBytes (static_cast<size_t>(totalBytes));
+	UByte * pShared (reinterpret_cast<UByte*>(AJAMemory::AllocateShared(&mappedBytes, name.c_str())));
+	if (!pShared)
+		return false;
+	const NTV2TCPSharedHeader * pHeader (reinterpret_cast<const NTV2TCPSharedHeader*>(pShared));
+	const ULWord64 dataBytes (pHeader->dataBytes);
+	if (mappedBytes < totalBytes  ||  pHeader->magic != kTCPSharedMagic  ||  pHeader->version != kTCPVersion
+		||  pHeader->cookie != cookie  ||  dataBytes > mappedBytes - kTCPSharedHeaderBytes)
+	{	//	Not the client's segment (e.g. the client's on another host) -- AllocateShared just made a new one
+		TSNOTE("Shared memory '" << name << "' isn't the client's");
+		AJAMemory::FreeShared(pShared);
+		UnlinkShared(name);
+		return false;
+	}
+	mpShared = pShared;
+	mSharedBytes = dataBytes;
+	TSDBG("Connection " << DEC(mID) << " sharing " << DEC(dataBytes) << " byte(s) in '" << name << "'");
+	return true;
+}
+
+UByte * NTV2TCPServerConnection::SharedAt (const ULWord64 inOffset, const ULWord64 inByteCount) const
+{
+	if (!mpShared  ||  !inByteCount  ||  inOffset > mSharedBytes  ||  inByteCount > mSharedBytes - inOffset)
+		return AJA_NULL;
+	return mpShared + kTCPSharedHeaderBytes + inOffset;
+}
+
+bool NTV2TCPServerConnection::HandleSharedDMA (const NTV2_RPC_BLOB_TYPE & inRequest)
+{
+	size_t ndx(0);
+	NTV2TCPDMAParams params;
+	ULWord64 offset(0);
+	if (!params.Pop(inRequest, ndx)  ||  !HasBytes(inRequest, ndx, sizeof(ULWord64)))
+		return false;
+	POPU64(offset, inRequest, ndx);
+	UByte * pHost (SharedAt(offset, params.Extent()));
+	if (!pHost)
+		{TSFAIL(DEC(params.Extent()) << " byte(s) at offset " << DEC(offset) << " not in " << DEC(mSharedBytes) << "-byte shared memory");  return false;}
+	return params.Transfer(mDevice, pHost);
+}
+
+bool NTV2TCPServerConnection::HandleSharedACXfer (const NTV2_RPC_BLOB_TYPE & inRequest, NTV2_RPC_BLOB_TYPE & outResponse)
+{
+	size_t ndx(0);
+	ULWord64 offsets[kTCPNumSharedXferBufs];
+	ULWord sizes[kTCPNumSharedXferBufs];
+	if (!mpShared  ||  !HasBytes(inRequest, ndx, kTCPNumSharedXferBufs * (sizeof(ULWord64) + sizeof(ULWord))))
+		return false;
+	for (size_t num(0);  num < kTCPNumSharedXferBufs;  num++)
+		{POPU64(offsets[num], inRequest, ndx);  POPU32(sizes[num], inRequest, ndx);}
+	AUTOCIRCULATE_TRANSFER xfer;
+	if (!xfer.RPCDecode(inRequest, ndx))
+		return false;
+	for (size_t num(0);  num < kTCPNumSharedXferBufs;  num++)
+		if (sizes[num])
+		{	//	Point the buffer into the client's segment
+			UByte * pHost (SharedAt(offsets[num], sizes[num]));
+			if (!pHost)
+				{TSFAIL(DEC(sizes[num]) << " byte(s) at offset " << DEC(offsets[num]) << " not in " << DEC(mSharedBytes) << "-byte shared memory");  return false;}
+			TransferBuffer(xfer, num)->Set(pHost, sizes[num]);
+		}
+	const bool ok (mDevice.NTV2Message(reinterpret_cast<NTV2_HEADER*>(&xfer)));
+	xfer.acTransferStatus.RPCEncode(outResponse);
+	return ok;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//	NTV2TCPServer
+
+NTV2TCPServer::NTV2TCPServer (CNTV2Card & inDevice, const NTV2ConfigParams & inConfig)
+	:	NTV2RPCServerAPI	(inConfig, AJA_NULL),
+		mDevice				(inDevice),
+		mListenSocket		(-1),
+		mPort				(0),
+		mNextConnID			(1)
+{
+	mRunning = mTerminate = false;
+}
+
+NTV2TCPServer::~NTV2TCPServer ()
+{
+	Stop();
+}
+
+bool NTV2TCPServer::Listen (void)
+{
+	if (mListenSocket >= 0)
+		return true;
+	if (!mDevice.IsOpen())
+		{TSFAIL("Device not open");  return false;}
+	mListenSocket = OpenListenSocket(mPort);
+	if (mListenSocket < 0)
+		return false;
+	TSNOTE("Serving '" << mDevice.GetDisplayName() << "' on " << Endpoint());
+	return true;
+}
+
+int NTV2TCPServer::OpenListenSocket (UWord & outPort)
+{
+	const string host (ConfigParam(kConnectParamHost)), portStr (ConfigParam(kConnectParamPort));
+	const UWord port (portStr.empty() ? UWord(NTV2NUBPORT) : UWord(aja::stoul(portStr)));
+	struct sockaddr_in addr;
+	::memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = host.empty() ? htonl(INADDR_LOOPBACK) : ::inet_addr(host.c_str());	//	Local clients only, unless told otherwise
+	addr.sin_port = htons(port);
+	if (addr.sin_addr.s_addr == htonl(INADDR_NONE))
+		{TSFAIL("Bad host address '" << host << "'");  return -1;}
+	const int sock (int(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)));
+	if (sock < 0)
+		{TSFAIL("socket failed");  return -1;}
+	int reuse(1);
+	::setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+	socklen_t addrLen (sizeof(addr));
+	if (::bind(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr))
+		||  ::listen(sock, 8)
+		||  ::getsockname(sock, reinterpret_cast<struct sockaddr*>(&addr), &addrLen))
+			{TSFAIL("Can't listen on '" << host << ":" << DEC(port) << "'");  TCPCloseSocket(sock);  return -1;}
+	outPort = ntohs(addr.sin_port);
+	return sock;
+}
+
+string NTV2TCPServer::Endpoint (void) const
+{
+	return "port " + aja::to_string(mPort);
+}
+
+bool NTV2TCPServer::HandleRequest (const ULWord inConnectionID, const UWord inOpcode, const NTV2_RPC_BLOB_TYPE & inRequest, NTV2_RPC_BLOB_TYPE & outResponse)
+{	(void) inConnectionID;  (void) inRequest;  (void) outResponse;
+	TSWARN("Unknown opcode " << xHEX0N(inOpcode,4));
+	return false;
+}
+
+bool NTV2TCPServer::Start (void)
+{
+	if (IsRunning())
+		return true;
+	if (!Listen())
+		return false;
+	mTerminate = false;
+	mThread.Attach(ServerThreadStatic, this);
+	if (AJA_FAILURE(mThread.Start()))
+		{TSFAIL("Failed to start server thread");  return false;}
+	while (!IsRunning()  &&  mThread.Active())
+		AJATime::Sleep(1);
+	return true;
+}
+
+void NTV2TCPServer::ServerThreadStatic (AJAThread * pThread, void * pContext)	//	CLASS METHOD
+{	(void) pThread;
+	NTV2TCPServer * pServer (reinterpret_cast<NTV2TCPServer*>(pContext));
+	if (pServer)
+		pServer->RunServer();
+}
+
+void NTV2TCPServer::RunServer (void)
+{
+	if (!Listen())
+		return;
+	mRunning = true;
+	while (!mTerminate)
+	{
+		if (WaitReadable(mListenSocket, 100))
+		{
+			const int sock (int(::accept(mListenSocket, AJA_NULL, AJA_NULL)));
+			if (sock >= 0)
+			{
+				SetNoDelay(sock);
+				NTV2TCPServerConnection * pConn (new NTV2TCPServerConnection(*this, mDevice, sock, mNextConnID++));
+				if (pConn->Start())
+					{AJAAutoLock tmp(&mConnLock);  mConnections.push_back(pConn);}
+				else
+					delete pConn;
+			}
+		}
+		ReapConnections(false);
+	}
+	ReapConnections(true);
+	mRunning = false;
+}
+
+void NTV2TCPServer::Stop (void)
+{
+	mTerminate = true;
+	while (IsRunning()  ||  mThread.Active())
+		AJATime::Sleep(1);
+	if (mListenSocket >= 0)
+		{TCPCloseSocket(mListenSocket);  mListenSocket = -1;}
+}
+
+void NTV2TCPServer::ReapConnections (const bool inAll)
+{
+	TCPConnections reaped;
+	{
+		AJAAutoLock tmp(&mConnLock);
+		for (TCPConnections::iterator it(mConnections.begin());  it != mConnections.end();  )
+			if (inAll  ||  (*it)->IsDone())
+				{reaped.push_back(*it);  it = mConnections.erase(it);}
+			else
+				++it;
+	}
+	for (size_t ndx(0);  ndx < reaped.size();  ndx++)
+	{
+		const ULWord connID (reaped.at(ndx)->GetID());
+		delete reaped.at(ndx);	//	Closes it
+		ConnectionClosed(connID);
+	}
+}
+
+size_t NTV2TCPServer::GetNumConnections (void) const
+{
+	AJAAutoLock tmp(&mConnLock);
+	return mConnections.size();
+}
+
+ostream & NTV2TCPServer::Print (ostream & oss) const
+{
+	oss << "NTV2TCPServer serving '" << mDevice.GetDisplayName() << "' on " << Endpoint()
+		<< (IsRunning() ? "" : " (stopped)") << ", " << DEC(GetNumConnections()) << " connection(s)";
+	return oss;
+}
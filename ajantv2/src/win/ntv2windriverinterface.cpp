@@ -10,6 +10,7 @@
 #include "ntv2publicinterface.h"
 #include "ntv2nubtypes.h"
 #include "ntv2debug.h"
+#include "ntv2drivertrace.h"
 #include "winioctl.h"
 #include "ajabase/system/debug.h"
 #include <sstream>
@@ -303,9 +304,14 @@ bool CNTV2WinDriverInterface::ReadRegister (const ULWord inRegNum,	ULWord & outV
 		WDIFAIL("Shift " << DEC(inShift) << " > 31, reg=" << DEC(inRegNum) << " msk=" << xHEX0N(inMask,8));
 		return false;
 	}
+	bool cacheable(false);
+	if ((mpRegCache || mpRegWriteTxn)  &&  RegCacheRead(inRegNum, outValue, inMask, inShift, cacheable))
+		return true;	//	Answered from shadow register cache or pending register write transaction
+	const ULWord regMask(cacheable ? 0xFFFFFFFF : inMask), regShift(cacheable ? 0 : inShift);	//	Cache entire register
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_READ_REGISTER, inRegNum, inMask, 0, &outValue);
 #if defined(NTV2_NUB_CLIENT_SUPPORT)
 	if (IsRemote())
-		return CNTV2DriverInterface::ReadRegister (inRegNum, outValue, inMask, inShift);
+		return trace.Done(RegCacheFill(CNTV2DriverInterface::ReadRegister (inRegNum, outValue, regMask, regShift), cacheable, inRegNum, outValue, inMask, inShift));
 #endif	//	defined(NTV2_NUB_CLIENT_SUPPORT)
 	if (!IsOpen())
 		return false;
@@ -319,8 +325,8 @@ bool CNTV2WinDriverInterface::ReadRegister (const ULWord inRegNum,	ULWord & outV
 	propStruct.Property.Id		= KSPROPERTY_AJAPROPS_GETSETREGISTER;
 	propStruct.Property.Flags	= KSPROPERTY_TYPE_GET;
 	propStruct.RegisterID		= inRegNum;
-	propStruct.ulRegisterMask	= inMask;
-	propStruct.ulRegisterShift	= inShift;
+	propStruct.ulRegisterMask	= regMask;
+	propStruct.ulRegisterShift	= regShift;
 	AJADebug::StatTimerStart(AJA_DebugStat_ReadRegister);
 	const bool ok = DeviceIoControl(_hDevice, IOCTL_AJAPROPS_GETSETREGISTER, &propStruct, sizeof(KSPROPERTY_AJAPROPS_GETSETREGISTER_S),
 						&propStruct, sizeof(KSPROPERTY_AJAPROPS_GETSETREGISTER_S), &dwBytesReturned, NULL);
@@ -328,7 +334,7 @@ bool CNTV2WinDriverInterface::ReadRegister (const ULWord inRegNum,	ULWord & outV
 	if (ok)
 	{
 		outValue = propStruct.ulRegisterValue;
-		return true;
+		return trace.Done(RegCacheFill(true, cacheable, inRegNum, outValue, inMask, inShift));
 	}
 	WDIFAIL("reg=" << DEC(inRegNum) << " val=" << xHEX0N(outValue,8) << " msk=" << xHEX0N(inMask,8) << " shf=" << DEC(inShift) << " failed: " << ::GetKernErrStr(GetLastError()));
 	return false;
@@ -351,9 +357,12 @@ bool CNTV2WinDriverInterface::WriteRegister (const ULWord inRegNum,	 const ULWor
 			return true;
 	}
 #endif	//	defined(NTV2_WRITEREG_PROFILING)	//	Register Write Profiling
+	if (mpRegWriteTxn  &&  RegWriteTxnIntercept(inRegNum, inValue, inMask, inShift))
+		return true;	//	Deferred until register write transaction is committed
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_WRITE_REGISTER, inRegNum, inMask, inValue);
 #if defined(NTV2_NUB_CLIENT_SUPPORT)
 	if (IsRemote())
-		return CNTV2DriverInterface::WriteRegister(inRegNum, inValue, inMask, inShift);
+		return trace.Done(RegCacheWriteThrough(CNTV2DriverInterface::WriteRegister(inRegNum, inValue, inMask, inShift), inRegNum, inValue, inMask, inShift));
 #endif	//	defined(NTV2_NUB_CLIENT_SUPPORT)
 	if (!IsOpen())
 		return false;
@@ -376,9 +385,9 @@ bool CNTV2WinDriverInterface::WriteRegister (const ULWord inRegNum,	 const ULWor
 	if (!ok)
 	{
 		WDIFAIL("reg=" << DEC(inRegNum) << " val=" << xHEX0N(inValue,8) << " msk=" << xHEX0N(inMask,8) << " shf=" << DEC(inShift) << " failed: " << ::GetKernErrStr(GetLastError()));
-		return false;
+		return RegCacheWriteThrough(false, inRegNum, inValue, inMask, inShift);
 	}
-	return true;
+	return trace.Done(RegCacheWriteThrough(true, inRegNum, inValue, inMask, inShift));
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -467,9 +476,10 @@ bool CNTV2WinDriverInterface::ConfigureSubscription (const bool bSubscribe, cons
 // Output: ULONG or equivalent(i.e. ULWord).
 bool CNTV2WinDriverInterface::GetInterruptCount (const INTERRUPT_ENUMS eInterruptType, ULWord & outCount)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_INTERRUPT_COUNT, eInterruptType, 0, 0, &outCount);
 #if defined(NTV2_NUB_CLIENT_SUPPORT)
 	if (IsRemote())
-		return CNTV2DriverInterface::GetInterruptCount(eInterruptType, outCount);
+		return trace.Done(CNTV2DriverInterface::GetInterruptCount(eInterruptType, outCount));
 #endif	//	defined(NTV2_NUB_CLIENT_SUPPORT)
 	if (!IsOpen())
 		return false;
@@ -491,7 +501,7 @@ bool CNTV2WinDriverInterface::GetInterruptCount (const INTERRUPT_ENUMS eInterrup
 		return false;
 	}
 	outCount = propStruct.ulIntCount;
-	return true;
+	return trace.Done(true);
 }
 
 static const uint32_t sIntEnumToStatKeys[] = {	AJA_DebugStat_WaitForInterruptOut1,		//	eOutput1	//	0
@@ -515,9 +525,10 @@ static const uint32_t sIntEnumToStatKeys[] = {	AJA_DebugStat_WaitForInterruptOut
 
 bool CNTV2WinDriverInterface::WaitForInterrupt (const INTERRUPT_ENUMS eInterruptType, const ULWord timeOutMs)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_WAIT_INTERRUPT, eInterruptType, timeOutMs);
 #if defined(NTV2_NUB_CLIENT_SUPPORT)
 	if (IsRemote())
-		return CNTV2DriverInterface::WaitForInterrupt(eInterruptType,timeOutMs);
+		return trace.Done(CNTV2DriverInterface::WaitForInterrupt(eInterruptType,timeOutMs));
 #endif	//	defined(NTV2_NUB_CLIENT_SUPPORT)
 	if (!IsOpen())
 		return false;
@@ -547,7 +558,7 @@ bool CNTV2WinDriverInterface::WaitForInterrupt (const INTERRUPT_ENUMS eInterrupt
 			;//MessageBox (0, "WaitForInterrupt timed out", "CNTV2WinDriverInterface", MB_ICONERROR | MB_OK);
 		}
 	}
-	return bInterruptHappened;
+	return trace.Done(bInterruptHappened);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -837,9 +848,10 @@ bool CNTV2WinDriverInterface::DmaTransfer ( const NTV2DMAEngine inDMAEngine,
 											const ULWord		inByteCount,
 											const bool			inSynchronous)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, inIsRead ? NTV2_TRACE_DMA_READ : NTV2_TRACE_DMA_WRITE, inDMAEngine, inFrameNumber, inByteCount);
 	if (IsRemote())
-		return CNTV2DriverInterface::DmaTransfer(inDMAEngine, inIsRead, inFrameNumber, pFrameBuffer,
-												inOffsetBytes, inByteCount, inSynchronous);
+		return trace.Done(CNTV2DriverInterface::DmaTransfer(inDMAEngine, inIsRead, inFrameNumber, pFrameBuffer,
+												inOffsetBytes, inByteCount, inSynchronous));
 	if (!IsOpen())
 		return false;
 
@@ -866,7 +878,7 @@ bool CNTV2WinDriverInterface::DmaTransfer ( const NTV2DMAEngine inDMAEngine,
 				<< " off=" << HEX8(inOffsetBytes) << " len=" << HEX8(inByteCount) << " " << (inIsRead ? "Rd" : "Wr"));
 		return false;
 	}
-	return true;
+	return trace.Done(true);
 }
 
 
@@ -881,9 +893,10 @@ bool CNTV2WinDriverInterface::DmaTransfer ( const NTV2DMAEngine inDMAEngine,
 											const ULWord		inCardPitch,
 											const bool			inSynchronous)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, inIsRead ? NTV2_TRACE_DMA_READ : NTV2_TRACE_DMA_WRITE, inDMAEngine, inFrameNumber, inByteCount);
 	if (IsRemote())
-		return CNTV2DriverInterface::DmaTransfer (inDMAEngine, inIsRead, inFrameNumber, pFrameBuffer, inOffsetBytes, inByteCount,
-													inNumSegments, inHostPitch, inCardPitch, inSynchronous);
+		return trace.Done(CNTV2DriverInterface::DmaTransfer (inDMAEngine, inIsRead, inFrameNumber, pFrameBuffer, inOffsetBytes, inByteCount,
+													inNumSegments, inHostPitch, inCardPitch, inSynchronous));
 	if (!IsOpen())
 		return false;
 
@@ -913,7 +926,7 @@ bool CNTV2WinDriverInterface::DmaTransfer ( const NTV2DMAEngine inDMAEngine,
 				<< " off=" << HEX8(inOffsetBytes) << " len=" << HEX8(inByteCount) << " " << (inIsRead ? "Rd" : "Wr"));
 		return false;
 	}
-	return true;
+	return trace.Done(true);
 }
 
 bool CNTV2WinDriverInterface::DmaTransfer ( const NTV2DMAEngine			inDMAEngine,
@@ -927,9 +940,10 @@ bool CNTV2WinDriverInterface::DmaTransfer ( const NTV2DMAEngine			inDMAEngine,
 											const ULWord				inCardPitch,
 											const PCHANNEL_P2P_STRUCT & inP2PData)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_DMA_P2P, inDMAEngine, inFrameNumber, inByteCount);
 	if (IsRemote())
-		return CNTV2DriverInterface::DmaTransfer (inDMAEngine, inDMAChannel, inIsTarget, inFrameNumber, inCardOffsetBytes, inByteCount,
-													inNumSegments, inHostPitch, inCardPitch, inP2PData);
+		return trace.Done(CNTV2DriverInterface::DmaTransfer (inDMAEngine, inDMAChannel, inIsTarget, inFrameNumber, inCardOffsetBytes, inByteCount,
+													inNumSegments, inHostPitch, inCardPitch, inP2PData));
 	if (!IsOpen())
 		return false;
 	if (!inP2PData)
@@ -1003,7 +1017,7 @@ bool CNTV2WinDriverInterface::DmaTransfer ( const NTV2DMAEngine			inDMAEngine,
 		inP2PData->videoBusSize			= propStruct.ulVideoBusSize;
 		inP2PData->messageData			= propStruct.ulMessageData;
 	}
-	return true;
+	return trace.Done(true);
 }
 
 
@@ -1011,8 +1025,9 @@ bool CNTV2WinDriverInterface::DmaTransfer ( const NTV2DMAEngine			inDMAEngine,
 // AutoCirculate
 bool CNTV2WinDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA &autoCircData)
 {
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_AUTOCIRCULATE, autoCircData.eCommand, autoCircData.channelSpec);
 	if (IsRemote())
-		return CNTV2DriverInterface::AutoCirculate(autoCircData);
+		return trace.Done(CNTV2DriverInterface::AutoCirculate(autoCircData));
 	bool bRes(true);
 	DWORD dwBytesReturned(0);
 
@@ -1343,7 +1358,7 @@ bool CNTV2WinDriverInterface::AutoCirculate (AUTOCIRCULATE_DATA &autoCircData)
 			break;
 		}
 	}	//	switch on autoCircData.eCommand
-	return bRes;
+	return trace.Done(bRes);
 }	//	AutoCirculate
 
 
@@ -1351,13 +1366,14 @@ bool CNTV2WinDriverInterface::NTV2Message (NTV2_HEADER * pInMessage)
 {
 	if (!pInMessage)
 		{WDIFAIL("Failed: NULL pointer"); return false;}
+	NTV2DriverTraceScope trace (mpDriverTrace, NTV2_TRACE_MESSAGE, pInMessage->GetType(), pInMessage->GetSizeInBytes());
 	DWORD dwBytesReturned(0);
 	AJADebug::StatTimerStart(AJA_DebugStat_NTV2Message);
 	const bool ok = DeviceIoControl(_hDevice, IOCTL_AJANTV2_MESSAGE, pInMessage, pInMessage->GetSizeInBytes (), pInMessage, pInMessage->GetSizeInBytes(), &dwBytesReturned, NULL);
 	AJADebug::StatTimerStop(AJA_DebugStat_NTV2Message);
 	if (!ok)
 		{WDIFAIL("Failed: " << ::GetKernErrStr(GetLastError()));  return false;}
-	return true;
+	return trace.Done(true);
 }
 
 
@@ -16,14 +16,34 @@
 #include "ntv2debug.h"
 #include "ntv2endian.h"
 #include "ntv2signalrouter.h"
+#include "ntv2registerexpert.h"
 #include "ntv2routingexpert.h"
 #include "ntv2transcode.h"
 #include "ntv2utils.h"
 #include "ntv2vpid.h"
 #include "ntv2version.h"
 #include "ntv2testpatterngen.h"
+#include "ntv2clockcorrelator.h"
+#include "ntv2latencytimeline.h"
+#include "ntv2audiostream.h"
+#include "ntv2audiodefines.h"
+#include "ntv2audioresampler.h"
+#include "ntv2audioconverter.h"
+#include "ntv2devicesnapshot.h"
+#include "ntv2simulateddevice.h"
+#include "ntv2registerpreset.h"
+#include "ntv2routesolver.h"
+#include "ntv2tcprpc.h"
+#include "ntv2devicebroker.h"
+#include "ntv2drivertrace.h"
+#include "ntv2deviceprofile.h"
+#include "ntv2devicescanner.h"
 #include "ajabase/system/debug.h"
 #include "ajabase/common/common.h"
+#include "ajabase/system/file_io.h"
+#include "ajabase/system/process.h"
+#include "ajabase/system/systemtime.h"
+#include "ajabase/network/tcp_socket.h"
 #include <vector>
 #include <algorithm>
 #include <iomanip>
@@ -3380,3 +3400,2752 @@ TEST_SUITE("AutoCirculate" * doctest::description("AutoCirculate tests"))
 		CHECK_FALSE(fRange.valid());
 	}	//	TEST_CASE("NTV2ACFrameRange")
 }	//	TEST_SUITE("AutoCirculate")
+
+
+void clockcorrelatormarker() {}
+TEST_SUITE("ClockCorrelator" * doctest::description("NTV2ClockFit & NTV2ClockCorrelator tests"))
+{
+	TEST_CASE("NTV2ClockFit")
+	{
+		NTV2ClockFit fit;
+		CHECK_FALSE(fit.IsValid());
+		CHECK_EQ(fit.XToY(12345), 12345);	//	Nominal until populated
+
+		//	Device clock runs 50ppm fast, with a large starting offset and +/-2 units of jitter...
+		const double slope (1.0 / 1.00005);
+		const int64_t x0 (LWord64(1) << 40), y0 (LWord64(1) << 50);
+		for (int n(0);  n < 500;  n++)
+		{
+			const int64_t x (x0 + int64_t(n) * 166833);
+			const int64_t y (y0 + int64_t(::llround(double(x - x0) * slope)) + ((n % 5) - 2));
+			CHECK(fit.AddSample(x, y));
+		}
+		CHECK(fit.IsLocked());
+		CHECK_EQ(fit.NumOutliers(), 0);
+		CHECK(fit.DriftPPM() == doctest::Approx(-50.0).epsilon(0.02));
+		const int64_t xTest (x0 + 500 * 166833);
+		const int64_t yTest (y0 + int64_t(::llround(double(xTest - x0) * slope)));
+		CHECK(::llabs(fit.XToY(xTest) - yTest) < 4);
+		CHECK(::llabs(fit.YToX(yTest) - xTest) < 4);
+
+		//	Single late sample is rejected...
+		CHECK_FALSE(fit.AddSample(xTest, yTest + 50000));
+		CHECK_EQ(fit.NumOutliers(), 1);
+		CHECK(fit.AddSample(xTest, yTest));
+
+		//	Sustained step is treated as a discontinuity...
+		for (int n(1);  n <= int(NTV2ClockFit::kMaxOutlierRun);  n++)
+			fit.AddSample(xTest + n * 166833, yTest + 10000000 + int64_t(n) * 166825);
+		CHECK_EQ(fit.NumResets(), 1);
+		CHECK(fit.IsValid());
+		CHECK_FALSE(fit.IsLocked());
+		if (gVerboseOutput)
+			cerr << fit << endl;
+	}	//	TEST_CASE("NTV2ClockFit")
+
+	TEST_CASE("NTV2ClockCorrelator")
+	{
+		NTV2ClockCorrelator cc;
+		cc.SetFrameRate(NTV2_FRAMERATE_5994);
+		CHECK_FALSE(cc.IsLocked());
+		CHECK(cc.VBIPeriod() == doctest::Approx(166833.33).epsilon(0.0001));
+
+		const double	vbiPeriod	(10000000.0 * 1001.0 / 60000.0);	//	Host time per frame
+		const double	devPerHost	(1.0 + 20.0 / 1000000.0);			//	Device clock 20ppm fast
+		const int64_t	host0		(133000000000000000LL);
+		const int64_t	mono0		(5000000000LL);
+		for (int n(0);  n < 300;  n++)
+		{
+			FRAME_STAMP fs;
+			const double vbiHost (double(n) * vbiPeriod);
+			fs.acFrameTime				= host0 + LWord64(vbiHost);
+			fs.acAudioClockTimeStamp	= ULWord64(vbiHost * devPerHost) + 1000;
+			fs.acCurrentFrameTime		= fs.acFrameTime;
+			fs.acCurrentTime			= fs.acFrameTime + 20000;
+			fs.acAudioClockCurrentTime	= ULWord64((vbiHost + 20000.0) * devPerHost) + 1000;
+			cc.AddFrameStamp(fs, mono0 + LWord64(vbiHost) + 20000 + 35);
+		}
+		CHECK(cc.IsLocked());
+		CHECK(cc.AudioClockDriftPPM() == doctest::Approx(20.0).epsilon(0.02));
+		CHECK(cc.VBIPeriod() == doctest::Approx(vbiPeriod).epsilon(0.00001));
+
+		const double	futureHost	(310.0 * vbiPeriod);
+		const ULWord64	futureAudio	(ULWord64(futureHost * devPerHost) + 1000);
+		CHECK(::llabs(cc.AudioClockToHost(futureAudio) - (host0 + LWord64(futureHost))) < 4);
+		CHECK(::llabs(LWord64(cc.HostToAudioClock(host0 + LWord64(futureHost))) - LWord64(futureAudio)) < 4);
+		CHECK(::llabs(cc.HostToMono(host0 + 1000) - (mono0 + 1035)) < 4);
+		CHECK(::llabs(cc.MonoToHost(mono0 + 1035) - (host0 + 1000)) < 4);
+		CHECK_EQ(cc.HostToVBI(host0 + LWord64(310.5 * vbiPeriod)), 310);
+		CHECK(::llabs(cc.NextVBIHostTime(host0 + LWord64(310.5 * vbiPeriod)) - (host0 + LWord64(311.0 * vbiPeriod))) < 4);
+
+		//	Explicit interrupt counts supersede synthesized ones...
+		for (ULWord n(0);  n < 20;  n++)
+			CHECK(cc.AddInterrupt(1000 + n, host0 + LWord64(double(n) * vbiPeriod)));
+		CHECK_EQ(cc.VBIModel().NumSamples(), 20);
+		CHECK_EQ(cc.HostToVBI(host0 + LWord64(5.2 * vbiPeriod)), 1005);
+		if (gVerboseOutput)
+			cerr << cc << endl;
+	}	//	TEST_CASE("NTV2ClockCorrelator")
+}	//	TEST_SUITE("ClockCorrelator")
+
+
+void latencytimelinemarker() {}
+TEST_SUITE("LatencyTimeline" * doctest::description("NTV2LatencyTimeline tests"))
+{
+	TEST_CASE("NTV2LatencyRecord")
+	{
+		NTV2LatencyRecord rec(NTV2_LATENCY_KIND_AC_CAPTURE, NTV2_CHANNEL2);
+		CHECK_EQ(rec.Elapsed(NTV2_LATENCY_SUBMIT, NTV2_LATENCY_RETURN), -1);
+		rec.fTimes[NTV2_LATENCY_SUBMIT]		= 1000000;
+		rec.fTimes[NTV2_LATENCY_DMA_START]	= 1010000;
+		rec.fTimes[NTV2_LATENCY_DMA_END]	= 3010000;
+		FRAME_STAMP fs;
+		fs.acFrameTime		= 500000;
+		fs.acCurrentTime	= 500000 + 150;		//	Driver says VBI was 15us before it returned
+		fs.acCurrentFrame	= 7;
+		rec.SetFrameStamp(fs);
+		CHECK_EQ(rec.fTimes[NTV2_LATENCY_VBI], 3010000 - 15000);
+		CHECK_EQ(rec.fCurrentFrame, 7);
+		CHECK_EQ(rec.Elapsed(NTV2_LATENCY_DMA_START, NTV2_LATENCY_DMA_END), 2000000);
+		CHECK_EQ(rec.Elapsed(NTV2_LATENCY_DMA_END, NTV2_LATENCY_DMA_START), -1);
+	}	//	TEST_CASE("NTV2LatencyRecord")
+
+	TEST_CASE("NTV2LatencyTimeline")
+	{
+		NTV2LatencyTimeline timeline(100);
+		CHECK_EQ(timeline.GetCapacity(), 128);
+		for (ULWord n(0);  n < 200;  n++)
+		{
+			NTV2LatencyRecord rec(NTV2_LATENCY_KIND_AC_PLAYOUT, NTV2_CHANNEL1);
+			const uint64_t t0 (uint64_t(n) * 16683333ULL + 1000);
+			rec.fFrame = n % 7;
+			rec.fSuccess = n != 150;
+			rec.fTimes[NTV2_LATENCY_SUBMIT]		= t0;
+			rec.fTimes[NTV2_LATENCY_DMA_START]	= t0 + 1000;
+			rec.fTimes[NTV2_LATENCY_DMA_END]	= t0 + 1000 + (n + 1) * 1000;	//	1..200us
+			rec.fTimes[NTV2_LATENCY_RETURN]		= rec.fTimes[NTV2_LATENCY_DMA_END] + 500;
+			timeline.Record(rec);
+		}
+		NTV2LatencyRecord dmaRec(NTV2_LATENCY_KIND_DMA_READ);
+		dmaRec.Stamp(NTV2_LATENCY_SUBMIT);  dmaRec.Stamp(NTV2_LATENCY_RETURN);
+		timeline.Record(dmaRec);
+
+		NTV2LatencyRecords records;
+		CHECK(timeline.GetRecords(NTV2_CHANNEL1, records));
+		CHECK_EQ(records.size(), 128);		//	Oldest 72 were overwritten
+		CHECK_EQ(records.front().fSequence, 72);
+		CHECK_EQ(records.back().fSequence, 199);
+		CHECK(timeline.GetRecords(NTV2_CHANNEL2, records));
+		CHECK(records.empty());
+		CHECK(timeline.GetRecords(NTV2_CHANNEL_INVALID, records));
+		CHECK_EQ(records.size(), 1);
+
+		NTV2LatencySummary summary;
+		CHECK(timeline.GetSummary(NTV2_CHANNEL1, summary));
+		CHECK_EQ(summary.fNumRecords, 128);
+		CHECK_EQ(summary.fNumFailures, 1);
+		bool foundDMAStage (false);
+		for (size_t ndx(0);  ndx < summary.fStages.size();  ndx++)
+		{
+			const NTV2LatencyStage & stage (summary.fStages.at(ndx));
+			if (stage.fFrom != NTV2_LATENCY_DMA_START  ||  stage.fTo != NTV2_LATENCY_DMA_END)
+				continue;
+			foundDMAStage = true;
+			CHECK_EQ(stage.fCount, 128);
+			CHECK_EQ(stage.fMax, 200000);
+			CHECK_EQ(stage.fP50, 136000);		//	73..200us, nearest-rank median is the 64th value
+			CHECK_EQ(stage.fP99, 199000);		//	127th value
+		}
+		CHECK(foundDMAStage);
+
+		ostringstream oss;
+		CHECK(timeline.WriteChromeTrace(oss));
+		const string json (oss.str());
+		CHECK(json.find("\"traceEvents\"") != string::npos);
+		CHECK(json.find("\"thread_name\"") != string::npos);
+		CHECK(json.find("DMAStart->DMAEnd") != string::npos);
+		CHECK_EQ(json.substr(json.size() - 3), "]}\n");
+		if (gVerboseOutput)
+			cerr << timeline << endl;
+
+		timeline.Reset();
+		CHECK(timeline.GetRecords(NTV2_CHANNEL1, records));
+		CHECK(records.empty());
+		timeline.Record(NTV2LatencyRecord(NTV2_LATENCY_KIND_AC_PLAYOUT, NTV2_CHANNEL1));
+		CHECK(timeline.GetRecords(NTV2_CHANNEL1, records));
+		REQUIRE_EQ(records.size(), 1);		//	Records from before the Reset stay hidden
+		CHECK_EQ(records.front().fSequence, 200);	//	Sequence numbers keep counting
+
+		{	NTV2LatencyScope noScope (AJA_NULL, true, 3, 4096);
+			CHECK(noScope.Done(true));
+			NTV2LatencyScope dmaScope (&timeline, false, 5, 8192);
+			CHECK_FALSE(dmaScope.Done(false));
+		}
+		CHECK(timeline.GetRecords(NTV2_CHANNEL_INVALID, records));
+		REQUIRE_EQ(records.size(), 1);
+		CHECK_EQ(records.front().fKind, NTV2_LATENCY_KIND_DMA_WRITE);
+		CHECK_EQ(records.front().fFrame, 5);
+		CHECK_EQ(records.front().fByteCount, 8192);
+		CHECK_FALSE(records.front().fSuccess);
+		CHECK_EQ(records.front().fTimes[NTV2_LATENCY_DMA_START], records.front().fTimes[NTV2_LATENCY_SUBMIT]);
+		CHECK(records.front().Elapsed(NTV2_LATENCY_SUBMIT, NTV2_LATENCY_RETURN) >= 0);
+
+		CNTV2Card card;
+		CHECK(card.GetLatencyTimeline() == AJA_NULL);
+		CHECK(card.SetLatencyTimelineEnable(true, 64));
+		CHECK(card.GetLatencyTimeline() != AJA_NULL);
+		CHECK_EQ(card.GetLatencyTimeline()->GetCapacity(), 64);
+		CHECK(card.SetLatencyTimelineEnable(false));
+		CHECK(card.GetLatencyTimeline() == AJA_NULL);
+	}	//	TEST_CASE("NTV2LatencyTimeline")
+}	//	TEST_SUITE("LatencyTimeline")
+
+
+void audiostreammarker() {}
+//	An "open" 2-channel device whose Audio System 1 buffer memory is a vector, and whose heads the test moves
+class AudioStreamTestCard : public CNTV2Card
+{
+	public:
+		static const ULWord	kRingBytes = 0x100000;	//	1MB:  131072 2-channel sample frames (~2.7 sec @ 48kHz)
+		AudioStreamTestCard ()
+			:	mMemory(2 * kRingBytes / sizeof(ULWord), 0),  mLastIn(0),  mLastOut(0),  mOutputRunning(false)
+		{
+			_boardOpened = true;
+			for (ULWord ndx(0);  ndx < kRingBytes / sizeof(ULWord);  ndx++)
+				mMemory[kRingBytes / sizeof(ULWord) + ndx] = 0xC0000000 | ndx;	//	Capture ring:  marked with word offset
+		}
+		virtual ~AudioStreamTestCard ()	{_boardOpened = false;}
+		virtual bool GetNumberAudioChannels (ULWord & outNumChannels, const NTV2AudioSystem inAudioSystem = NTV2_AUDIOSYSTEM_1)
+			{(void) inAudioSystem;  outNumChannels = 2;  return true;}
+		virtual bool GetAudioRate (NTV2AudioRate & outRate, const NTV2AudioSystem inAudioSystem = NTV2_AUDIOSYSTEM_1)
+			{(void) inAudioSystem;  outRate = NTV2_AUDIO_48K;  return true;}
+		virtual bool GetAudioWrapAddress (ULWord & outWrapAddress, const NTV2AudioSystem inAudioSystem = NTV2_AUDIOSYSTEM_1)
+			{(void) inAudioSystem;  outWrapAddress = kRingBytes;  return true;}
+		virtual bool GetAudioReadOffset (ULWord & outReadOffset, const NTV2AudioSystem inAudioSystem = NTV2_AUDIOSYSTEM_1)
+			{(void) inAudioSystem;  outReadOffset = kRingBytes;  return true;}
+		virtual bool ReadAudioLastIn (ULWord & outValue, const NTV2AudioSystem inAudioSystem = NTV2_AUDIOSYSTEM_1)
+			{(void) inAudioSystem;  outValue = mLastIn;  return true;}
+		virtual bool ReadAudioLastOut (ULWord & outValue, const NTV2AudioSystem inAudioSystem = NTV2_AUDIOSYSTEM_1)
+			{(void) inAudioSystem;  outValue = mLastOut;  return true;}
+		virtual bool IsAudioOutputRunning (const NTV2AudioSystem inAudioSystem, bool & outIsRunning)
+			{(void) inAudioSystem;  outIsRunning = mOutputRunning;  return true;}
+		virtual bool DMAReadAudio (const NTV2AudioSystem inAudioSystem, ULWord * pOutAudioBuffer, const ULWord inOffsetBytes, const ULWord inByteCount)
+		{
+			if (inAudioSystem != NTV2_AUDIOSYSTEM_1  ||  !pOutAudioBuffer  ||  inOffsetBytes + inByteCount > mMemory.size() * sizeof(ULWord))
+				return false;
+			mDMAs.push_back(OffsetAndBytes(inOffsetBytes, inByteCount));
+			::memcpy(pOutAudioBuffer, &mMemory[inOffsetBytes / sizeof(ULWord)], inByteCount);
+			return true;
+		}
+		virtual bool DMAWriteAudio (const NTV2AudioSystem inAudioSystem, const ULWord * pInAudioBuffer, const ULWord inOffsetBytes, const ULWord inByteCount)
+		{
+			if (inAudioSystem != NTV2_AUDIOSYSTEM_1  ||  !pInAudioBuffer  ||  inOffsetBytes + inByteCount > kRingBytes)
+				return false;	//	Must stay in the playout ring
+			mDMAs.push_back(OffsetAndBytes(inOffsetBytes, inByteCount));
+			::memcpy(&mMemory[inOffsetBytes / sizeof(ULWord)], pInAudioBuffer, inByteCount);
+			return true;
+		}
+		vector<ULWord>					mMemory;	//	Playout ring, then capture ring
+		typedef pair<ULWord, ULWord>	OffsetAndBytes;
+		vector<OffsetAndBytes>			mDMAs;		//	Device buffer offset & byte count of each DMA
+		ULWord							mLastIn, mLastOut;
+		bool							mOutputRunning;
+};
+
+TEST_SUITE("AudioStream" * doctest::description("NTV2AudioStream tests"))
+{
+	TEST_CASE("Ring Arithmetic")
+	{
+		const ULWord ringBytes (NTV2_AUDIO_WRAPADDRESS_BIG);
+		CHECK_EQ(NTV2AudioStream::RingDistance(0, 0, ringBytes), 0);
+		CHECK_EQ(NTV2AudioStream::RingDistance(100, 500, ringBytes), 400);
+		CHECK_EQ(NTV2AudioStream::RingDistance(ringBytes - 64, 128, ringBytes), 192);
+		CHECK_EQ(NTV2AudioStream::RingDistance(1, 2, 0), 0);
+
+		ULWord first(0), second(0);
+		NTV2AudioStream::SplitAtWrap(0, 6400, ringBytes, first, second);
+		CHECK_EQ(first, 6400);	CHECK_EQ(second, 0);
+		NTV2AudioStream::SplitAtWrap(ringBytes - 6400, 6400, ringBytes, first, second);
+		CHECK_EQ(first, 6400);	CHECK_EQ(second, 0);	//	Ends exactly at the wrap
+		NTV2AudioStream::SplitAtWrap(ringBytes - 64 * 3, 64 * 128, ringBytes, first, second);
+		CHECK_EQ(first, 64 * 3);	CHECK_EQ(second, 64 * 125);
+		//	Ring sizes hold a whole number of 6-, 8- and 16-channel sample frames...
+		static const ULWord sNumChannels[] = {6, 8, 16};
+		for (size_t ndx(0);  ndx < sizeof(sNumChannels) / sizeof(ULWord);  ndx++)
+		{
+			CHECK_EQ(NTV2_AUDIO_WRAPADDRESS % (sNumChannels[ndx] * 4), 0);
+			CHECK_EQ(NTV2_AUDIO_WRAPADDRESS_BIG % (sNumChannels[ndx] * 4), 0);
+		}
+	}	//	TEST_CASE("Ring Arithmetic")
+
+	TEST_CASE("Closed Device")
+	{
+		CNTV2Card card;
+		NTV2AudioStream captureStream(card, NTV2_AUDIOSYSTEM_1, true), playoutStream(card, NTV2_AUDIOSYSTEM_1, false);
+		CHECK(captureStream.IsCapture());
+		CHECK_FALSE(playoutStream.IsCapture());
+		CHECK_FALSE(captureStream.Initialize());
+		CHECK_FALSE(captureStream.IsInitialized());
+		CHECK_EQ(captureStream.GetRingSampleFrames(), 0);
+		NTV2Buffer buffer(4096);
+		ULWord numSamples(99);
+		CHECK_FALSE(captureStream.Read(buffer, numSamples));
+		CHECK_EQ(numSamples, 0);
+		CHECK_FALSE(playoutStream.Write(buffer, 16));
+		CHECK_FALSE(playoutStream.GetQueuedSamples(numSamples));
+		ostringstream oss;
+		oss << captureStream;
+		CHECK(oss.str().find("uninitialized") != string::npos);
+	}	//	TEST_CASE("Closed Device")
+
+	TEST_CASE("Read Across The Wrap")
+	{
+		const ULWord ringBytes (AudioStreamTestCard::kRingBytes), bpf(8);
+		AudioStreamTestCard card;
+		NTV2AudioStream stream(card, NTV2_AUDIOSYSTEM_1, true);
+		REQUIRE(stream.Initialize());
+		CHECK_EQ(stream.GetRingSampleFrames(), ringBytes / bpf);
+		NTV2Buffer buffer(ringBytes / 2);
+		ULWord numSamples(0);
+		CHECK(stream.Read(buffer, numSamples));
+		CHECK_EQ(numSamples, 0);							//	Head hasn't moved
+		CHECK(card.mDMAs.empty());
+
+		card.mLastIn = ringBytes / 2;						//	Half the ring captured
+		CHECK(stream.Read(buffer, numSamples));
+		CHECK_EQ(numSamples, ringBytes / 2 / bpf);
+		REQUIRE_EQ(card.mDMAs.size(), 1);
+		CHECK_EQ(card.mDMAs.at(0).first, ringBytes);	//	Capture ring starts at the read offset
+		CHECK_EQ(buffer.U32(0), 0xC0000000);
+		CHECK_EQ(buffer.U32(int(ringBytes / 8 - 1)), 0xC0000000 | (ringBytes / 8 - 1));
+
+		card.mLastIn = ringBytes - 16 * bpf;				//	Almost to the end...
+		CHECK(stream.Read(buffer, numSamples));
+		card.mLastIn = 32 * bpf;							//	...then past the wrap
+		card.mDMAs.clear();
+		CHECK(stream.Read(buffer, numSamples));
+		CHECK_EQ(numSamples, 48);
+		REQUIRE_EQ(card.mDMAs.size(), 2);					//	Split at the wrap
+		CHECK_EQ(card.mDMAs.at(0).first, ringBytes + ringBytes - 16 * bpf);
+		CHECK_EQ(card.mDMAs.at(0).second, 16 * bpf);
+		CHECK_EQ(card.mDMAs.at(1).first, ringBytes);
+		CHECK_EQ(card.mDMAs.at(1).second, 32 * bpf);
+		for (ULWord word(0);  word < 48 * bpf / 4;  word++)	//	In ring order across the wrap
+			CHECK_EQ(buffer.U32(int(word)), 0xC0000000 | ((ringBytes - 16 * bpf) / 4 + word) % (ringBytes / 4));
+		CHECK_EQ(stream.GetTotalSampleFrames(), ULWord64(ringBytes / bpf) - 16 + 48);
+		CHECK_EQ(stream.GetNumOverruns(), 0);
+
+		card.mLastIn = 16 * bpf;							//	Nearly a full lap behind:  overrun
+		CHECK(stream.Read(buffer, numSamples));
+		CHECK_EQ(numSamples, 0);
+		CHECK_EQ(stream.GetNumOverruns(), 1);
+		card.mLastIn = 40 * bpf;							//	Resynced to the write head
+		CHECK(stream.Read(buffer, numSamples, 10));			//	Capped
+		CHECK_EQ(numSamples, 10);
+		CHECK_EQ(buffer.U32(0), 0xC0000000 | (16 * bpf / 4));
+	}	//	TEST_CASE("Read Across The Wrap")
+
+	TEST_CASE("Write Across The Wrap")
+	{
+		const ULWord ringBytes (AudioStreamTestCard::kRingBytes), bpf(8);
+		AudioStreamTestCard card;
+		NTV2AudioStream stream(card, NTV2_AUDIOSYSTEM_1, false);
+		REQUIRE(stream.Initialize());					//	Output stopped:  cursor at the top
+		ULWord queued(0);
+		CHECK(stream.GetQueuedSamples(queued));
+		CHECK_EQ(queued, 0);
+		NTV2Buffer buffer(ringBytes / 2);
+		for (ULWord word(0);  word < ringBytes / 8;  word++)
+			buffer.U32(int(word)) = 0xA0000000 | word;
+
+		CHECK(stream.Write(buffer, ringBytes / 2 / bpf));
+		REQUIRE_EQ(card.mDMAs.size(), 1);
+		CHECK_EQ(card.mDMAs.at(0).first, 0);
+		CHECK_EQ(card.mMemory.at(ringBytes / 8 - 1), 0xA0000000 | (ringBytes / 8 - 1));
+		CHECK_FALSE(stream.Write(buffer, ringBytes / 2 / bpf));	//	Won't fit:  play head hasn't moved
+		card.mOutputRunning = true;
+		card.mLastOut = ringBytes / 2 - 64 * bpf;			//	Played most of it
+		CHECK(stream.GetQueuedSamples(queued));
+		CHECK_EQ(queued, 64);
+		CHECK(stream.Write(buffer, ringBytes / 2 / bpf - 16));	//	Cursor now 16 samples from the end
+		card.mLastOut = ringBytes - 32 * bpf;
+		card.mDMAs.clear();
+		CHECK(stream.Write(buffer, 48));
+		REQUIRE_EQ(card.mDMAs.size(), 2);					//	Split at the wrap
+		CHECK_EQ(card.mDMAs.at(0).first, ringBytes - 16 * bpf);
+		CHECK_EQ(card.mDMAs.at(0).second, 16 * bpf);
+		CHECK_EQ(card.mDMAs.at(1).first, 0);
+		CHECK_EQ(card.mDMAs.at(1).second, 32 * bpf);
+		for (ULWord word(0);  word < 48 * bpf / 4;  word++)	//	In ring order across the wrap
+			CHECK_EQ(card.mMemory.at(((ringBytes - 16 * bpf) / 4 + word) % (ringBytes / 4)), 0xA0000000 | word);
+		CHECK(stream.GetQueuedSamples(queued));
+		CHECK_EQ(queued, 32 + 32);
+		CHECK_EQ(stream.GetNumUnderruns(), 0);
+
+		card.mLastOut = 64 * bpf;							//	Play head passed the write cursor:  underrun
+		CHECK(stream.GetQueuedSamples(queued));
+		CHECK_EQ(stream.GetNumUnderruns(), 1);
+		CHECK_EQ(queued, 4800);								//	Resynced the default playout lead ahead
+		card.mDMAs.clear();
+		CHECK(stream.Write(buffer, 1));
+		REQUIRE_EQ(card.mDMAs.size(), 1);
+		CHECK_EQ(card.mDMAs.at(0).first, (64 + 4800) * bpf);
+	}	//	TEST_CASE("Write Across The Wrap")
+}	//	TEST_SUITE("AudioStream")
+
+
+void audioresamplermarker() {}
+TEST_SUITE("AudioResampler" * doctest::description("NTV2AudioResampler tests"))
+{
+	TEST_CASE("Pass-Through")
+	{
+		//	At matching rates, the output is the input delayed by the filter latency, sample-for-sample...
+		const ULWord numChannels(16), numFrames(1000);
+		NTV2AudioResampler resampler(numChannels);
+		vector<int32_t> input(numFrames * numChannels), output(numFrames * numChannels, 0);
+		for (size_t ndx(0);  ndx < input.size();  ndx++)
+			input[ndx] = int32_t(uint32_t((ndx * 2654435761UL) & 0xFFFFFF) << 8);	//	Arbitrary 24-in-32 samples
+		const ULWord numOut (resampler.Process(&input[0], numFrames, &output[0], numFrames));
+		CHECK_EQ(numOut, numFrames - resampler.GetLatencyFrames());
+		CHECK(std::equal(output.begin(), output.begin() + numOut * numChannels, input.begin()));
+		CHECK_EQ(resampler.GetEffectiveRatio(), 1.0);
+	}	//	TEST_CASE("Pass-Through")
+
+	TEST_CASE("Rate Conversion")
+	{
+		const ULWord numChannels(2), numFrames(4410);
+		const double inRate(44100.0), outRate(48000.0), freq(1000.0), amplitude(0.5);
+		vector<int32_t> input(numFrames * numChannels);
+		for (ULWord frame(0);  frame < numFrames;  frame++)
+			for (ULWord ch(0);  ch < numChannels;  ch++)
+				input[frame * numChannels + ch] = int32_t(uint32_t(int32_t(floor(amplitude * 8388608.0 * sin(2.0 * M_PI * freq * (ch + 1) * frame / inRate) + 0.5))) << 8);
+
+		NTV2AudioResampler whole(numChannels), chunked(numChannels);
+		CHECK_FALSE(whole.SetRates(0.0, outRate));
+		CHECK(whole.SetRates(inRate, outRate));
+		CHECK(chunked.SetRates(inRate, outRate));
+
+		//	One big block...
+		vector<int32_t> wholeOut(numFrames * 2 * numChannels);
+		const ULWord numWhole (whole.Process(&input[0], numFrames, &wholeOut[0], numFrames * 2));
+		CHECK(numWhole >= ULWord((numFrames - whole.GetLatencyFrames()) * outRate / inRate) - 1);
+		CHECK(numWhole <= ULWord((numFrames - whole.GetLatencyFrames()) * outRate / inRate) + 1);
+
+		//	Many odd-sized blocks must give the identical result (no discontinuities between calls)...
+		vector<int32_t> chunkedOut(numFrames * 2 * numChannels);
+		ULWord numChunked(0);
+		for (ULWord frame(0);  frame < numFrames;  frame += 37)
+		{
+			const ULWord numIn (frame + 37 > numFrames  ?  numFrames - frame  :  37);
+			numChunked += chunked.Process(&input[frame * numChannels], numIn, &chunkedOut[numChunked * numChannels], numFrames * 2 - numChunked);
+		}
+		CHECK_EQ(numChunked, numWhole);
+		CHECK(std::equal(wholeOut.begin(), wholeOut.begin() + numWhole * numChannels, chunkedOut.begin()));
+
+		//	Compare against the ideal signal (skipping the start-up transient)...
+		double maxError(0.0);
+		for (ULWord frame(2 * whole.GetLatencyFrames());  frame < numWhole;  frame++)
+			for (ULWord ch(0);  ch < numChannels;  ch++)
+			{
+				const double expected (amplitude * sin(2.0 * M_PI * freq * (ch + 1) * frame / outRate));
+				const double actual (double(wholeOut[frame * numChannels + ch]) / 2147483648.0);
+				maxError = std::max(maxError, fabs(actual - expected));
+			}
+		CHECK(maxError < 1e-4);
+	}	//	TEST_CASE("Rate Conversion")
+
+	TEST_CASE("Drift Compensation")
+	{
+		NTV2AudioResampler resampler(8);
+		resampler.SetRatioAdjustment(5000.0);
+		CHECK_EQ(resampler.GetRatioAdjustment(), 1000.0);		//	Clamped to default maximum
+		resampler.SetRatioAdjustment(-100.0);
+		CHECK(resampler.GetEffectiveRatio() > 1.0);				//	Consuming input slower
+		resampler.Reset();
+		CHECK_EQ(resampler.GetRatioAdjustment(), 0.0);
+
+		resampler.SetBufferTarget(4800, 200.0);
+		resampler.UpdateBufferLevel(4800);
+		CHECK_EQ(resampler.GetRatioAdjustment(), 0.0);
+		resampler.UpdateBufferLevel(5000);						//	Too much queued
+		CHECK(resampler.GetRatioAdjustment() > 0.0);
+		CHECK(resampler.GetEffectiveRatio() < 1.0);
+		for (int ndx(0);  ndx < 1000;  ndx++)
+			resampler.UpdateBufferLevel(0);						//	Starved
+		CHECK_EQ(resampler.GetRatioAdjustment(), -200.0);
+		CHECK(resampler.GetEffectiveRatio() > 1.0);
+	}	//	TEST_CASE("Drift Compensation")
+}	//	TEST_SUITE("AudioResampler")
+
+
+void audioconvertermarker() {}
+TEST_SUITE("AudioConverter" * doctest::description("NTV2AudioConverter tests"))
+{
+	static int32_t DeviceSample (const ULWord inFrame, const ULWord inChannel)	//	Distinct 24-in-32 value per frame & channel
+	{
+		return int32_t(uint32_t((int32_t(inFrame * 16 + inChannel) - 100) * 4099) << 8);
+	}
+
+	TEST_CASE("Channel Matrix")
+	{
+		const NTV2AudioChannelMatrix identity (NTV2AudioChannelMatrix::Identity(4));
+		CHECK(identity.IsRouting());
+		CHECK_EQ(identity.GetSource(2), 2);
+		std::vector<int> channelMap;
+		channelMap.push_back(3);	channelMap.push_back(-1);	channelMap.push_back(0);
+		NTV2AudioChannelMatrix routing (NTV2AudioChannelMatrix::FromChannelMap(channelMap, 16));
+		CHECK_EQ(routing.GetNumOutputs(), 3);
+		CHECK_EQ(routing.GetNumInputs(), 16);
+		CHECK(routing.IsRouting());
+		CHECK_EQ(routing.GetSource(0), 3);
+		CHECK_EQ(routing.GetSource(1), -1);
+		CHECK_FALSE(routing.SetGain(3, 0, 1.0f));
+		CHECK(routing.SetGain(1, 5, 0.5f));
+		CHECK_FALSE(routing.IsRouting());
+		CHECK_EQ(routing.GetSource(0), -1);
+		const NTV2AudioChannelMatrix downmix (NTV2AudioChannelMatrix::Downmix51ToStereo(16, 2));
+		CHECK_FALSE(downmix.IsRouting());
+		CHECK_EQ(downmix.GetGain(0, 2), 1.0f);
+		CHECK_EQ(downmix.GetGain(0, 5), 0.0f);		//	LFE
+		CHECK(downmix.GetGain(1, 7) > 0.7f);		//	Rs
+	}	//	TEST_CASE("Channel Matrix")
+
+	TEST_CASE("From Device")
+	{
+		const ULWord numFrames(100), numChannels(16);
+		NTV2Buffer device(numFrames * numChannels * 4), host(numFrames * numChannels * 4);
+		for (ULWord frame(0);  frame < numFrames;  frame++)
+			for (ULWord chan(0);  chan < numChannels;  chan++)
+				device.U32(int(frame * numChannels + chan)) = ULWord(DeviceSample(frame, chan));
+
+		NTV2AudioConverter converter;
+		CHECK_EQ(converter.GetHostByteCount(numFrames), device.GetByteCount());
+		CHECK(converter.FromDevice(device, numFrames, host));				//	Pass-through
+		CHECK(host.IsContentEqual(device));
+		CHECK_FALSE(converter.FromDevice(device, numFrames + 1, host));		//	Too big
+
+		//	Re-map 3 channels into planar float...
+		std::vector<int> channelMap;
+		channelMap.push_back(3);	channelMap.push_back(-1);	channelMap.push_back(0);
+		CHECK(converter.SetChannelMatrix(NTV2AudioChannelMatrix::FromChannelMap(channelMap, numChannels)));
+		CHECK(converter.SetHostFormat(NTV2_AUDIO_SAMPLE_FORMAT_F32, /*planar*/true));
+		CHECK_EQ(converter.GetHostByteCount(numFrames), numFrames * 3 * 4);
+		CHECK(converter.FromDevice(device, numFrames, host));
+		const float * pPlanes (reinterpret_cast<const float*>(host.GetHostPointer()));
+		for (ULWord frame(0);  frame < numFrames;  frame++)
+		{
+			CHECK_EQ(pPlanes[frame], float(DeviceSample(frame, 3)) / 2147483648.0f);
+			CHECK_EQ(pPlanes[numFrames + frame], 0.0f);
+			CHECK_EQ(pPlanes[2 * numFrames + frame], float(DeviceSample(frame, 0)) / 2147483648.0f);
+		}
+
+		//	Packed 24-bit, interleaved...
+		CHECK(converter.SetHostFormat(NTV2_AUDIO_SAMPLE_FORMAT_S24));
+		CHECK(converter.FromDevice(device, numFrames, host));
+		const UByte * pBytes (reinterpret_cast<const UByte*>(host.GetHostPointer()));
+		for (ULWord frame(0);  frame < numFrames;  frame++)
+		{
+			const UByte * p (pBytes + frame * 3 * 3);
+			CHECK_EQ(int32_t(uint32_t(p[0]) << 8 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 24), DeviceSample(frame, 3));
+		}
+
+		//	16-bit, without and with dither...
+		CHECK(converter.SetHostFormat(NTV2_AUDIO_SAMPLE_FORMAT_S16));
+		converter.SetDither(false);
+		CHECK(converter.FromDevice(device, numFrames, host));
+		const int16_t * pShorts (reinterpret_cast<const int16_t*>(host.GetHostPointer()));
+		for (ULWord frame(0);  frame < numFrames;  frame++)
+			CHECK_EQ(pShorts[frame * 3 + 2], int16_t(floor(double(DeviceSample(frame, 0)) / 65536.0 + 0.5)));
+		converter.SetDither(true);
+		CHECK(converter.FromDevice(device, numFrames, host));
+		for (ULWord frame(0);  frame < numFrames;  frame++)
+			CHECK(fabs(double(pShorts[frame * 3 + 2]) - double(DeviceSample(frame, 0)) / 65536.0) <= 1.5);
+
+		//	From an AUTOCIRCULATE_TRANSFER...
+		AUTOCIRCULATE_TRANSFER xfer;
+		xfer.acAudioBuffer.Set(device.GetHostPointer(), device.GetByteCount());
+		xfer.acTransferStatus.acAudioTransferSize = 10 * numChannels * 4;
+		ULWord numConverted(0);
+		CHECK(converter.FromDevice(xfer, host, numConverted));
+		CHECK_EQ(numConverted, 10);
+	}	//	TEST_CASE("From Device")
+
+	TEST_CASE("Downmix & Round Trip")
+	{
+		const ULWord numFrames(64), numChannels(8);
+		NTV2Buffer device(numFrames * numChannels * 4), host(numFrames * numChannels * 4), device2(numFrames * numChannels * 4);
+		for (ULWord frame(0);  frame < numFrames;  frame++)
+			for (ULWord chan(0);  chan < numChannels;  chan++)
+				device.U32(int(frame * numChannels + chan)) = ULWord(DeviceSample(frame, chan));
+
+		//	5.1 => stereo float...
+		NTV2AudioConverter converter;
+		CHECK(converter.SetDeviceChannels(numChannels));
+		CHECK(converter.SetChannelMatrix(NTV2AudioChannelMatrix::Downmix51ToStereo(numChannels)));
+		CHECK(converter.SetHostFormat(NTV2_AUDIO_SAMPLE_FORMAT_F32));
+		CHECK(converter.FromDevice(device, numFrames, host));
+		const float * pStereo (reinterpret_cast<const float*>(host.GetHostPointer()));
+		for (ULWord frame(0);  frame < numFrames;  frame++)
+		{
+			const double expected ((double(DeviceSample(frame, 0)) + 0.70710678 * (double(DeviceSample(frame, 2)) + double(DeviceSample(frame, 4)))) / 2147483648.0);
+			CHECK(fabs(pStereo[frame * 2] - expected) < 1e-6);
+		}
+		CHECK_FALSE(converter.ToDevice(host, numFrames, device2));	//	Matrix has wrong orientation for playout
+
+		//	Every host format round-trips losslessly through the device format (interleaved and planar)...
+		static const NTV2AudioSampleFormat sFormats[] = {NTV2_AUDIO_SAMPLE_FORMAT_S32, NTV2_AUDIO_SAMPLE_FORMAT_S24, NTV2_AUDIO_SAMPLE_FORMAT_F32};
+		for (size_t ndx(0);  ndx < sizeof(sFormats) / sizeof(NTV2AudioSampleFormat);  ndx++)
+			for (int planar(0);  planar < 2;  planar++)
+			{
+				CHECK(converter.SetDeviceChannels(numChannels));
+				CHECK(converter.SetHostFormat(sFormats[ndx], planar != 0));
+				CHECK(converter.FromDevice(device, numFrames, host));
+				device2.Fill(ULWord(0xDEADBEEF));
+				CHECK(converter.ToDevice(host, numFrames, device2));
+				CHECK(device2.IsContentEqual(device));
+			}
+
+		//	16-bit host audio round-trips losslessly the other way (host => device => host)...
+		NTV2Buffer host2(host.GetByteCount());
+		for (ULWord ndx(0);  ndx < numFrames * numChannels;  ndx++)
+			reinterpret_cast<int16_t*>(host.GetHostPointer())[ndx] = int16_t(ndx * 997);
+		converter.SetDither(false);
+		for (int planar(0);  planar < 2;  planar++)
+		{
+			CHECK(converter.SetHostFormat(NTV2_AUDIO_SAMPLE_FORMAT_S16, planar != 0));
+			CHECK(converter.ToDevice(host, numFrames, device2));
+			const int16_t	chan1 (reinterpret_cast<const int16_t*>(host.GetHostPointer())[planar ? numFrames : 1]);	//	Frame 0, channel 1
+			CHECK_EQ(int32_t(device2.U32(1)), int32_t(uint32_t(int32_t(chan1)) << 16));
+			CHECK(converter.FromDevice(device2, numFrames, host2));
+			CHECK(::memcmp(host2.GetHostPointer(), host.GetHostPointer(), numFrames * numChannels * 2) == 0);
+		}
+	}	//	TEST_CASE("Downmix & Round Trip")
+}	//	TEST_SUITE("AudioConverter")
+
+
+void regcache_marker() {}
+class RegCacheTestCard : public CNTV2Card
+{
+	public:
+		using CNTV2Card::RegCacheFill;
+		using CNTV2Card::RegCacheWriteThrough;
+		using CNTV2Card::BumpEventCount;
+};
+
+TEST_SUITE("RegisterCache" * doctest::description("Shadow register cache tests"))
+{
+	TEST_CASE("Classification")
+	{
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kRegBoardID), NTV2_REGCACHE_STATIC);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kVRegDriverVersion), NTV2_REGCACHE_STATIC);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kRegXptSelectGroup1), NTV2_REGCACHE_CONFIG);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kRegSDIOut1Control), NTV2_REGCACHE_CONFIG);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kRegGlobalControl), NTV2_REGCACHE_CONFIG);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kRegStatus), NTV2_REGCACHE_VOLATILE);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kRegInputStatus), NTV2_REGCACHE_VOLATILE);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kRegCh1OutputFrame), NTV2_REGCACHE_VOLATILE);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kRegCh1InputFrame), NTV2_REGCACHE_VOLATILE);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kRegAud1Control), NTV2_REGCACHE_VOLATILE);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kRegLUTV2Control), NTV2_REGCACHE_VOLATILE);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kVRegChannelCrosspointFirst), NTV2_REGCACHE_CONFIG);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kVRegAcquireLinuxReferenceCount), NTV2_REGCACHE_VOLATILE);	//	Actions
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kVRegReleaseLinuxReferenceCount), NTV2_REGCACHE_VOLATILE);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kVRegReleaseApplication), NTV2_REGCACHE_VOLATILE);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kVRegApplicationPID), NTV2_REGCACHE_VOLATILE);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kVRegForceApplicationPID), NTV2_REGCACHE_VOLATILE);
+		CHECK_EQ(CNTV2DriverInterface::DefaultRegisterCacheClass(kVRegForceApplicationCode), NTV2_REGCACHE_VOLATILE);
+	}	//	TEST_CASE("Classification")
+
+	TEST_CASE("Read/Write-Through/Flush")
+	{
+		RegCacheTestCard card;	//	Not open, so anything not answered from the cache fails
+		ULWord value(0);
+		ULWord64 hits(0), misses(0);
+		CHECK_FALSE(card.IsRegisterCacheEnabled());
+		CHECK_FALSE(card.GetRegisterCacheStats(hits, misses));
+		CHECK_FALSE(card.SetRegisterCacheClass(kRegStatus, NTV2_REGCACHE_CONFIG));
+		CHECK_FALSE(card.ReadRegister(kRegXptSelectGroup1, value));
+
+		CHECK(card.SetRegisterCacheEnable(true, 0));	//	No age limit
+		CHECK(card.IsRegisterCacheEnabled());
+		CHECK_FALSE(card.ReadRegister(kRegXptSelectGroup1, value));		//	Miss
+		value = 0x12345678;
+		CHECK(card.RegCacheFill(true, true, kRegXptSelectGroup1, value, 0x0000FF00, 8));
+		CHECK_EQ(value, 0x56);
+		CHECK(card.ReadRegister(kRegXptSelectGroup1, value));			//	Hit
+		CHECK_EQ(value, 0x12345678);
+		CHECK(card.ReadRegister(kRegXptSelectGroup1, value, 0x00FF0000, 16));	//	Hit
+		CHECK_EQ(value, 0x34);
+		CHECK(card.ReadRegister(kRegXptSelectGroup1, value, 0, 0));		//	Hit (zero mask ignored)
+		CHECK_EQ(value, 0x12345678);
+
+		//	Write-through...
+		CHECK(card.RegCacheWriteThrough(true, kRegXptSelectGroup1, 0xAB, 0x000000FF, 0));
+		CHECK(card.ReadRegister(kRegXptSelectGroup1, value));			//	Hit
+		CHECK_EQ(value, 0x123456AB);
+		CHECK(card.RegCacheWriteThrough(true, kRegXptSelectGroup1, 0x0C, 0x00000F00, 8));
+		CHECK(card.ReadRegister(kRegXptSelectGroup1, value));			//	Hit
+		CHECK_EQ(value, 0x12345CAB);
+		CHECK_FALSE(card.RegCacheWriteThrough(false, kRegXptSelectGroup1, 0, 0xFFFFFFFF, 0));	//	Failed write invalidates
+		CHECK_FALSE(card.ReadRegister(kRegXptSelectGroup1, value));		//	Miss
+		CHECK(card.RegCacheWriteThrough(true, kRegXptSelectGroup1, 0x87654321));	//	Whole-register write
+		CHECK(card.ReadRegister(kRegXptSelectGroup1, value));			//	Hit
+		CHECK_EQ(value, 0x87654321);
+		CHECK(card.RegCacheWriteThrough(true, kRegStatus, 0x1));		//	Volatile -- not cached
+		CHECK_FALSE(card.ReadRegister(kRegStatus, value));
+
+		//	Vertical interrupt invalidates config, but not static...
+		value = 0x00001234;
+		CHECK(card.RegCacheFill(true, true, kRegBoardID, value, 0xFFFFFFFF, 0));
+		card.BumpEventCount(eOutput1);
+		CHECK_FALSE(card.ReadRegister(kRegXptSelectGroup1, value));		//	Miss
+		CHECK(card.ReadRegister(kRegBoardID, value));					//	Hit
+		CHECK_EQ(value, 0x00001234);
+		card.FlushRegisterCache();
+		CHECK(card.ReadRegister(kRegBoardID, value));					//	Hit
+		card.FlushRegisterCache(true);
+		CHECK_FALSE(card.ReadRegister(kRegBoardID, value));				//	Miss
+
+		//	Reclassification...
+		CHECK(card.SetRegisterCacheClass(kRegStatus, NTV2_REGCACHE_CONFIG));
+		CHECK_EQ(card.GetRegisterCacheClass(kRegStatus), NTV2_REGCACHE_CONFIG);
+		value = 0xCAFEBABE;
+		CHECK(card.RegCacheFill(true, true, kRegStatus, value, 0xFFFFFFFF, 0));
+		CHECK(card.ReadRegister(kRegStatus, value));					//	Hit
+		CHECK_EQ(value, 0xCAFEBABE);
+
+		CHECK(card.GetRegisterCacheStats(hits, misses));
+		CHECK_EQ(hits, 9);
+		CHECK_EQ(misses, 4);
+
+		CHECK(card.SetRegisterCacheEnable(false));
+		CHECK_FALSE(card.IsRegisterCacheEnabled());
+		CHECK_FALSE(card.ReadRegister(kRegStatus, value));
+	}	//	TEST_CASE("Read/Write-Through/Flush")
+}	//	TEST_SUITE("RegisterCache")
+
+
+void devicesnapshot_marker() {}
+TEST_SUITE("DeviceSnapshot" * doctest::description("CNTV2DeviceSnapshot tests"))
+{
+	TEST_CASE("Getters From Register Values")
+	{
+		CNTV2Card device;	//	Not open
+		CNTV2DeviceSnapshot snapshot;
+		CHECK_FALSE(snapshot.IsOpen());
+		CHECK_FALSE(snapshot.Capture(device));
+		CHECK_FALSE(snapshot.Refresh());
+
+		NTV2RegisterValueMap regValues;
+		CHECK_FALSE(snapshot.SetRegisterValues(regValues));	//	Needs kRegBoardID
+		regValues[kRegBoardID] = ULWord(DEVICE_ID_KONA4);
+		regValues[kRegCh1Control] = (ULWord(NTV2_MODE_INPUT) << kRegShiftMode)
+									| ((ULWord(NTV2_FBF_10BIT_DPX) & 0x0F) << kRegShiftFrameFormat)
+									| ((ULWord(NTV2_FBF_10BIT_DPX) >> 4) << kRegShiftFrameFormatHiBit);
+		regValues[kRegCh2Control] = (ULWord(NTV2_MODE_OUTPUT) << kRegShiftMode)
+									| ((ULWord(NTV2_FBF_8BIT_YCBCR_422PL3) & 0x0F) << kRegShiftFrameFormat)
+									| ((ULWord(NTV2_FBF_8BIT_YCBCR_422PL3) >> 4) << kRegShiftFrameFormatHiBit);
+		regValues[kVRegDriverVersion] = 0x12345678;
+		CHECK(snapshot.SetRegisterValues(regValues));
+		CHECK(snapshot.IsOpen());
+		CHECK_EQ(snapshot.GetNumRegisters(), 4);
+		CHECK_EQ(snapshot.GetDeviceID(), DEVICE_ID_KONA4);
+
+		NTV2Mode mode(NTV2_MODE_INVALID);
+		CHECK(snapshot.GetMode(NTV2_CHANNEL1, mode));
+		CHECK_EQ(mode, NTV2_MODE_INPUT);
+		CHECK(snapshot.GetMode(NTV2_CHANNEL2, mode));
+		CHECK_EQ(mode, NTV2_MODE_OUTPUT);
+		CHECK_FALSE(snapshot.GetMode(NTV2_CHANNEL3, mode));	//	Not captured
+		NTV2PixelFormat pf(NTV2_FBF_INVALID);
+		CHECK(snapshot.GetFrameBufferFormat(NTV2_CHANNEL1, pf));
+		CHECK_EQ(pf, NTV2_FBF_10BIT_DPX);
+		CHECK(snapshot.GetFrameBufferFormat(NTV2_CHANNEL2, pf));
+		CHECK_EQ(pf, NTV2_FBF_8BIT_YCBCR_422PL3);
+
+		ULWord value(0);
+		CHECK(snapshot.ReadRegister(kVRegDriverVersion, value, 0xFF, 4));	//	Virtual regs ignore mask & shift
+		CHECK_EQ(value, 0x12345678);
+		NTV2RegisterReads regReads;
+		regReads.push_back(NTV2RegInfo(kRegBoardID));
+		regReads.push_back(NTV2RegInfo(kRegCh1Control));
+		CHECK(snapshot.ReadRegisters(regReads));
+		CHECK_EQ(regReads.at(0).registerValue, ULWord(DEVICE_ID_KONA4));
+		CHECK_EQ(regReads.at(1).registerValue, regValues[kRegCh1Control]);
+		regReads.push_back(NTV2RegInfo(kRegStatus));
+		CHECK_FALSE(snapshot.ReadRegisters(regReads));
+
+		//	Read-only...
+		CHECK_FALSE(snapshot.SetMode(NTV2_CHANNEL1, NTV2_MODE_OUTPUT));
+		CHECK_FALSE(snapshot.WriteRegister(kRegCh1Control, 0));
+		CHECK(snapshot.GetMode(NTV2_CHANNEL1, mode));
+		CHECK_EQ(mode, NTV2_MODE_INPUT);
+		CHECK_FALSE(snapshot.Open(0));
+
+		CHECK(snapshot.Close());
+		CHECK_FALSE(snapshot.IsOpen());
+		CHECK_FALSE(snapshot.GetMode(NTV2_CHANNEL1, mode));
+	}	//	TEST_CASE("Getters From Register Values")
+
+	TEST_CASE("Default Registers")
+	{
+		const NTV2RegNumSet regs (CNTV2DeviceSnapshot::DefaultRegisters(DEVICE_ID_KONA4));
+		CHECK(regs.find(kRegBoardID) != regs.end());
+		CHECK(regs.find(kRegCh1Control) != regs.end());
+		CHECK(regs.find(kVRegDriverVersion) != regs.end());
+		CHECK(regs.find(kRegXenaxFlashDOUT) == regs.end());
+		CHECK(regs.find(kRegRS422Receive) == regs.end());
+		CHECK(regs.find(kRegRS4222Receive) == regs.end());
+		CHECK(regs.find(kRegRS422Control) != regs.end());
+	}	//	TEST_CASE("Default Registers")
+}	//	TEST_SUITE("DeviceSnapshot")
+
+
+void regwritetxn_marker() {}
+class RegWriteTxnTestCard : public CNTV2Card
+{
+	public:
+		RegWriteTxnTestCard ()	:	mSendOK(true), mVBIOK(true), mNumVBIWaits(0), mNumMessages(0)	{}
+		inline void	FakeOpen (const bool inOpen)	{_boardOpened = inOpen;}	//	Interceptions happen before any device access
+		~RegWriteTxnTestCard ()	{_boardOpened = false;}
+		bool NTV2Message (NTV2_HEADER * pInMessage)		//	Stands in for the driver:  records what a commit sends
+		{
+			if (!pInMessage  ||  pInMessage->GetType() != NTV2_TYPE_SETREGS  ||  !mSendOK)
+				return false;
+			NTV2SetRegisters & setRegs (*reinterpret_cast<NTV2SetRegisters*>(pInMessage));
+			if (setRegs.mInNumRegisters > NTV2_MAX_NUM_SETREGS)
+				return false;	//	Like the driver:  bigger than a page
+			const NTV2RegInfo * pRegInfos (setRegs.mInRegInfos);
+			mSent.assign(pRegInfos, pRegInfos + setRegs.mInNumRegisters);
+			mAllSent.insert(mAllSent.end(), pRegInfos, pRegInfos + setRegs.mInNumRegisters);
+			mNumMessages++;
+			return true;
+		}
+		bool WaitForOutputVerticalInterrupt (const NTV2Channel inChannel = NTV2_CHANNEL1, UWord inRepeatCount = 1)
+		{
+			(void) inChannel;	(void) inRepeatCount;
+			mNumVBIWaits++;
+			return mVBIOK;
+		}
+		NTV2RegisterWrites	mSent;		//	Last message's writes
+		NTV2RegisterWrites	mAllSent;	//	Every message's writes
+		bool				mSendOK, mVBIOK;
+		ULWord				mNumVBIWaits, mNumMessages;
+};
+
+TEST_SUITE("RegisterWriteTransaction" * doctest::description("CNTV2Card register write transaction tests"))
+{
+	TEST_CASE("Begin/Coalesce/Commit/Abort")
+	{
+		RegWriteTxnTestCard card;
+		ULWord value(0);
+		CHECK_FALSE(card.BeginRegisterWrites());	//	Not open
+		card.FakeOpen(true);
+		CHECK_FALSE(card.IsRegisterWriteTransactionOpen());
+		CHECK_FALSE(card.CommitRegisterWrites());
+		CHECK_FALSE(card.AbortRegisterWrites());
+
+		CHECK(card.BeginRegisterWrites());
+		CHECK(card.IsRegisterWriteTransactionOpen());
+		CHECK(card.WriteRegister(kRegXptSelectGroup1, 0x12345678));			//	Config:  coalesced...
+		CHECK(card.WriteRegister(kRegXptSelectGroup1, 0xAB, 0x000000FF, 0));
+		CHECK(card.WriteRegister(kRegXptSelectGroup1, 0xC, 0x00000F00, 8));
+		CHECK_EQ(card.GetNumPendingRegisterWrites(), 1);
+		CHECK(card.ReadRegister(kRegXptSelectGroup1, value));				//	Reads see pending value
+		CHECK_EQ(value, 0x12345CAB);
+		CHECK(card.ReadRegister(kRegXptSelectGroup1, value, 0x00FF0000, 16));
+		CHECK_EQ(value, 0x34);
+		CHECK(card.WriteRegister(kRegCh1Control, ULWord(NTV2_MODE_INPUT), kRegMaskMode, kRegShiftMode));
+		CHECK(card.WriteRegister(kRegCh1Control, 0x3, kRegMaskFrameFormat, kRegShiftFrameFormat));
+		CHECK_EQ(card.GetNumPendingRegisterWrites(), 2);
+		CHECK_FALSE(card.ReadRegister(kRegCh1Control, value));				//	Partly pending -- needs the device
+		CHECK(card.WriteRegister(kRegStatus, 1));							//	Volatile:  not coalesced
+		CHECK(card.WriteRegister(kRegStatus, 2));
+		CHECK_EQ(card.GetNumPendingRegisterWrites(), 4);
+		NTV2RegisterWrites regWrites;
+		regWrites.push_back(NTV2RegInfo(kRegXptSelectGroup1, 0x99, 0xFF000000, 24));
+		CHECK(card.WriteRegisters(regWrites));								//	Also held, but not merged across the kRegStatus writes
+		CHECK_EQ(card.GetNumPendingRegisterWrites(), 5);
+		CHECK(card.ReadRegister(kRegXptSelectGroup1, value));				//	Reads still see the net pending value
+		CHECK_EQ(value, 0x99345CAB);
+
+		//	Nesting...
+		CHECK(card.BeginRegisterWrites());
+		CHECK(card.WriteRegister(kRegXptSelectGroup2, 0x1));
+		CHECK(card.CommitRegisterWrites());									//	Inner:  nothing sent
+		CHECK(card.IsRegisterWriteTransactionOpen());
+		CHECK_EQ(card.GetNumPendingRegisterWrites(), 6);
+		CHECK(card.mSent.empty());
+
+		CHECK(card.AbortRegisterWrites());
+		CHECK_FALSE(card.IsRegisterWriteTransactionOpen());
+		CHECK_EQ(card.GetNumPendingRegisterWrites(), 0);
+		CHECK_FALSE(card.ReadRegister(kRegXptSelectGroup1, value));			//	Goes to (closed) device
+
+		//	Commit sends everything in order, merging only between non-config writes...
+		CHECK(card.BeginRegisterWrites());
+		CHECK(card.WriteRegister(kRegXptSelectGroup1, 0x1));
+		CHECK(card.WriteRegister(kRegXptSelectGroup2, 0x2));
+		CHECK(card.WriteRegister(kRegXptSelectGroup1, 0x3));				//	Merged into the first write
+		CHECK(card.WriteRegister(kRegStatus, 4));
+		CHECK(card.WriteRegister(kRegXptSelectGroup2, 0x5));				//	Not merged across kRegStatus
+		CHECK(card.CommitRegisterWrites());
+		CHECK_FALSE(card.IsRegisterWriteTransactionOpen());
+		CHECK_EQ(card.mNumVBIWaits, 0);
+		REQUIRE_EQ(card.mSent.size(), 4);
+		CHECK_EQ(card.mSent.at(0).registerNumber, ULWord(kRegXptSelectGroup1));
+		CHECK_EQ(card.mSent.at(0).registerValue, 0x3);
+		CHECK_EQ(card.mSent.at(1).registerNumber, ULWord(kRegXptSelectGroup2));
+		CHECK_EQ(card.mSent.at(1).registerValue, 0x2);
+		CHECK_EQ(card.mSent.at(2).registerNumber, ULWord(kRegStatus));
+		CHECK_EQ(card.mSent.at(3).registerNumber, ULWord(kRegXptSelectGroup2));
+		CHECK_EQ(card.mSent.at(3).registerValue, 0x5);
+
+		//	A failed VBI wait is reported, but the writes are still sent...
+		card.mSent.clear();
+		card.mVBIOK = false;
+		CHECK(card.BeginRegisterWrites());
+		CHECK(card.WriteRegister(kRegXptSelectGroup1, 0x6));
+		CHECK_FALSE(card.CommitRegisterWrites(true));
+		CHECK_EQ(card.mNumVBIWaits, 1);
+		CHECK_EQ(card.mSent.size(), 1);
+		card.mVBIOK = true;
+
+		card.mSendOK = false;
+		CHECK(card.BeginRegisterWrites());
+		CHECK(card.WriteRegister(kRegXptSelectGroup1, 0x1));
+		CHECK_FALSE(card.CommitRegisterWrites(true));						//	Driver rejected it
+		CHECK_EQ(card.mNumVBIWaits, 2);
+		CHECK_FALSE(card.IsRegisterWriteTransactionOpen());
+	}	//	TEST_CASE("Begin/Coalesce/Commit/Abort")
+
+	TEST_CASE("Scoped")
+	{
+		RegWriteTxnTestCard card;
+		card.FakeOpen(true);
+		{
+			CNTV2RegisterWriteTransaction txn(card);
+			CHECK(txn.IsOpen());
+			CHECK(card.WriteRegister(kRegXptSelectGroup1, 0x1));
+			CHECK_EQ(card.GetNumPendingRegisterWrites(), 1);
+		}	//	Not committed -- discarded
+		CHECK_FALSE(card.IsRegisterWriteTransactionOpen());
+		{
+			CNTV2RegisterWriteTransaction txn(card);
+			CHECK(txn.Abort());
+			CHECK_FALSE(txn.IsOpen());
+			CHECK_FALSE(txn.Commit());
+		}
+		CHECK_FALSE(card.IsRegisterWriteTransactionOpen());
+	}	//	TEST_CASE("Scoped")
+
+	TEST_CASE("Action Registers")
+	{	//	Each acquire write is a driver action:  neither merged nor cached
+		RegWriteTxnTestCard card;
+		card.FakeOpen(true);
+		CHECK(card.SetRegisterCacheEnable(true, 0));
+		CHECK(card.BeginRegisterWrites());
+		CHECK(card.WriteRegister(kVRegAcquireLinuxReferenceCount, 1234));
+		CHECK(card.WriteRegister(kVRegAcquireLinuxReferenceCount, 1234));
+		CHECK_EQ(card.GetNumPendingRegisterWrites(), 2);
+		CHECK(card.CommitRegisterWrites());
+		REQUIRE_EQ(card.mSent.size(), 2);
+		CHECK_EQ(card.mSent.at(0).registerNumber, ULWord(kVRegAcquireLinuxReferenceCount));
+		CHECK_EQ(card.mSent.at(1).registerNumber, ULWord(kVRegAcquireLinuxReferenceCount));
+		ULWord value(0);
+		CHECK_FALSE(card.ReadRegister(kVRegAcquireLinuxReferenceCount, value));	//	Not cached:  asks the (absent) device
+		CHECK_FALSE(card.ReadRegister(kVRegApplicationPID, value));
+	}	//	TEST_CASE("Action Registers")
+
+	TEST_CASE("Over The Message Limit")
+	{	//	More writes than one NTV2SetRegisters message can hold:  sent in order, in page-sized messages
+		RegWriteTxnTestCard card;
+		card.FakeOpen(true);
+		const ULWord numWrites (ULWord(NTV2_MAX_NUM_SETREGS) + 44);
+		CHECK(card.BeginRegisterWrites());
+		for (ULWord n(0);  n < numWrites;  n++)
+			CHECK(card.WriteRegister(kRegStatus, n));		//	Volatile:  not coalesced
+		CHECK_EQ(card.GetNumPendingRegisterWrites(), numWrites);
+		CHECK(card.CommitRegisterWrites(true));
+		CHECK_EQ(card.mNumVBIWaits, 1);
+		CHECK_EQ(card.mNumMessages, 2);
+		CHECK_EQ(card.mSent.size(), 44);
+		REQUIRE_EQ(card.mAllSent.size(), numWrites);
+		for (ULWord n(0);  n < numWrites;  n++)
+			CHECK_EQ(card.mAllSent.at(n).registerValue, n);
+	}	//	TEST_CASE("Over The Message Limit")
+}	//	TEST_SUITE("RegisterWriteTransaction")
+
+
+void lutupload_marker() {}
+class LUTUploadTestCard : public CNTV2Card
+{
+	public:
+		explicit LUTUploadTestCard (const bool in12BitLUT)
+			:	mNumMessages(0), mNumWrites(0), mNumBatchedWrites(0), mVBIOK(true)
+		{
+			_boardOpened = true;
+			_boardID = DEVICE_ID_CORVID88;		//	Version 2 LUTs
+			mRegs[kRegBoardID] = ULWord(_boardID);
+			mRegs[kRegLUTV2Control] = in12BitLUT ? kRegMask12BitLUTSupport : 0;
+		}
+		~LUTUploadTestCard ()	{_boardOpened = false;}
+		bool ReadRegister (const ULWord inRegNum, ULWord & outValue, const ULWord inMask = 0xFFFFFFFF, const ULWord inShift = 0)
+		{
+			outValue = (mRegs[inRegNum] & inMask) >> inShift;
+			return true;
+		}
+		bool WriteRegister (const ULWord inRegNum, const ULWord inValue, const ULWord inMask = 0xFFFFFFFF, const ULWord inShift = 0)
+		{
+			mNumWrites++;
+			mRegs[inRegNum] = (mRegs[inRegNum] & ~inMask) | ((inValue << inShift) & inMask);
+			return true;
+		}
+		bool NTV2Message (NTV2_HEADER * pInMessage)
+		{
+			if (!pInMessage  ||  pInMessage->GetType() != NTV2_TYPE_SETREGS)
+				return false;
+			NTV2SetRegisters & setRegs (*reinterpret_cast<NTV2SetRegisters*>(pInMessage));
+			if (setRegs.mInRegInfos.GetByteCount() > 4096)
+				return false;	//	Like the Linux driver, which won't take more than a page
+			const NTV2RegInfo * pRegInfos (setRegs.mInRegInfos);
+			for (ULWord ndx(0);  ndx < setRegs.mInNumRegisters;  ndx++)
+			{
+				const NTV2RegInfo & ri (pRegInfos[ndx]);
+				mRegs[ri.registerNumber] = (mRegs[ri.registerNumber] & ~ri.registerMask) | ((ri.registerValue << ri.registerShift) & ri.registerMask);
+				if (ri.registerNumber == kRegLUTV2Control)
+					mPlaneSelects.push_back((mRegs[kRegLUTV2Control] & kRegMask12BitLUTPlaneSelect) >> kRegShift12BitLUTPlaneSelect);
+			}
+			mNumMessages++;
+			mNumBatchedWrites += setRegs.mInNumRegisters;
+			return true;
+		}
+		bool WaitForInterrupt (const INTERRUPT_ENUMS eInterrupt, const ULWord timeOutMs = 68)
+		{
+			(void) eInterrupt;	(void) timeOutMs;
+			return mVBIOK;
+		}
+		NTV2RegisterValueMap	mRegs;
+		ULWordSequence			mPlaneSelects;
+		ULWord					mNumMessages, mNumWrites, mNumBatchedWrites;
+		bool					mVBIOK;
+};
+
+TEST_SUITE("LUTUpload" * doctest::description("Bulk and double-buffered LUT upload tests"))
+{
+	TEST_CASE("Batched 10-bit")
+	{
+		LUTUploadTestCard card(false);
+		UWordSequence red, green, blue;
+		for (UWord ndx(0);  ndx < 1024;  ndx++)
+			{red.push_back(ndx);  green.push_back(UWord(1023 - ndx));  blue.push_back(UWord(ndx / 2));}
+		CHECK_FALSE(card.WriteLUTTables(UWordSequence(10), green, blue));
+		CHECK(card.WriteLUTTables(red, green, blue));
+		CHECK_EQ(card.mNumMessages, 6);			//	A few page-sized NTV2SetRegisters...
+		CHECK_EQ(card.mNumWrites, 0);			//	...and no WriteRegister calls
+		CHECK_EQ(card.mNumBatchedWrites, 3 * NTV2_COLORCORRECTOR_WORDSPERTABLE);
+		const ULWord regR(kColorCorrectionLUTOffset_Red / 4), regG(kColorCorrectionLUTOffset_Green / 4), regB(kColorCorrectionLUTOffset_Blue / 4);
+		CHECK_EQ(card.mRegs[regR + 1], (3U << kRegColorCorrectionLUTOddShift) | (2U << kRegColorCorrectionLUTEvenShift));
+		CHECK_EQ(card.mRegs[regG], (1022U << kRegColorCorrectionLUTOddShift) | (1023U << kRegColorCorrectionLUTEvenShift));
+		CHECK_EQ(card.mRegs[regB + 511], (511U << kRegColorCorrectionLUTOddShift) | (511U << kRegColorCorrectionLUTEvenShift));
+	}	//	TEST_CASE("Batched 10-bit")
+
+	TEST_CASE("Batched 12-bit")
+	{
+		LUTUploadTestCard card(true);
+		UWordSequence red(4096, 0x123), green(4096, 0x456), blue(4096, 0x789);
+		CHECK(card.Write12BitLUTTables(red, green, blue));
+		CHECK_EQ(card.mNumMessages, 25);
+		CHECK_EQ(card.mNumWrites, 0);
+		CHECK_EQ(card.mNumBatchedWrites, 3 * (NTV2_12BIT_COLORCORRECTOR_WORDSPERTABLE + 1));
+		REQUIRE_EQ(card.mPlaneSelects.size(), 3);	//	Each plane selected before its table
+		CHECK_EQ(card.mPlaneSelects.at(0), ULWord(NTV2_REDPLANE));
+		CHECK_EQ(card.mPlaneSelects.at(1), ULWord(NTV2_GREENPLANE));
+		CHECK_EQ(card.mPlaneSelects.at(2), ULWord(NTV2_BLUEPLANE));
+		const ULWord reg(kColorCorrection12BitLUTOffset_Base / 4);
+		CHECK_EQ(card.mRegs[reg + 100], (0x789U << kRegColorCorrection12BitLUTOddShift) | (0x789U << kRegColorCorrection12BitLUTEvenShift));	//	Blue was last
+
+		//	10-bit tables into a 12-bit LUT...
+		card.mNumMessages = card.mNumBatchedWrites = 0;  card.mPlaneSelects.clear();
+		CHECK(card.WriteLUTTables(UWordSequence(1024, 1), UWordSequence(1024, 2), UWordSequence(1024, 3)));
+		CHECK_EQ(card.mNumMessages, 25);
+		CHECK_EQ(card.mNumWrites, 0);
+		CHECK_EQ(card.mNumBatchedWrites, 3 * (4 * NTV2_COLORCORRECTOR_WORDSPERTABLE + 1));
+		CHECK_EQ(card.mPlaneSelects.size(), 3);
+	}	//	TEST_CASE("Batched 12-bit")
+
+	TEST_CASE("Double-Buffered")
+	{
+		LUTUploadTestCard card(false);
+		UWordSequence table(1024, 0x200);
+		ULWord bank(99);
+		CHECK(card.GetColorCorrectionOutputBank(NTV2_CHANNEL2, bank));
+		CHECK_EQ(bank, 0);
+		CHECK(card.DownloadLUTToInactiveBank(table, table, table, NTV2_CHANNEL2));
+		CHECK_EQ(card.mNumMessages, 6);
+		CHECK(card.GetColorCorrectionOutputBank(NTV2_CHANNEL2, bank));
+		CHECK_EQ(bank, 1);
+		ULWord hostBank(99);
+		CHECK(card.ReadRegister(kRegLUTV2Control, hostBank, kRegMaskLUT2HostAccessBankSelect, kRegShiftLUT2HostAccessBankSelect));
+		CHECK_EQ(hostBank, 1);		//	Loaded bank 1 while bank 0 was being output
+		CHECK(card.DownloadLUTToInactiveBank(table, table, table, NTV2_CHANNEL2, false, false));
+		CHECK(card.GetColorCorrectionOutputBank(NTV2_CHANNEL2, bank));
+		CHECK_EQ(bank, 0);			//	Flipped back
+		CHECK(card.ReadRegister(kRegLUTV2Control, hostBank, kRegMaskLUT2HostAccessBankSelect, kRegShiftLUT2HostAccessBankSelect));
+		CHECK_EQ(hostBank, 0);
+		card.mVBIOK = false;
+		CHECK_FALSE(card.DownloadLUTToInactiveBank(table, table, table, NTV2_CHANNEL2));			//	VBI wait failed...
+		CHECK(card.GetColorCorrectionOutputBank(NTV2_CHANNEL2, bank));
+		CHECK_EQ(bank, 0);			//	...so not flipped
+		card.mVBIOK = true;
+		CHECK_FALSE(card.DownloadLUTToInactiveBank(table, table, table, NTV2_CHANNEL2, true));	//	No 12-bit LUT support
+		CHECK_FALSE(card.DownloadLUTToInactiveBank(table, table, table, NTV2_CHANNEL_INVALID));
+	}	//	TEST_CASE("Double-Buffered")
+}	//	TEST_SUITE("LUTUpload")
+
+
+void devcaps_marker() {}
+class DevCapsTestCard : public CNTV2Card
+{
+	public:
+		DevCapsTestCard ()	: mNumReads(0)	{mRegs[kRegBoardID] = ULWord(DEVICE_ID_CORVID88);}
+		~DevCapsTestCard ()	{_boardOpened = false;}
+		inline void	FakeOpen (void)	{_boardOpened = true;  _boardID = NTV2DeviceID(mRegs[kRegBoardID]);}
+		bool ReadRegister (const ULWord inRegNum, ULWord & outValue, const ULWord inMask = 0xFFFFFFFF, const ULWord inShift = 0)
+		{
+			mNumReads++;
+			outValue = (mRegs[inRegNum] & inMask) >> inShift;
+			return true;
+		}
+		bool ReadRegisters (NTV2RegisterReads & inOutValues)	//	Counts as one read, like NTV2GetRegisters
+		{
+			mNumReads++;
+			for (NTV2RegisterReadsIter it(inOutValues.begin());  it != inOutValues.end();  ++it)
+				it->registerValue = mRegs[it->registerNumber];
+			return true;
+		}
+		bool NTV2Message (NTV2_HEADER * pInMessage)	{(void) pInMessage;  return false;}
+		NTV2RegisterValueMap	mRegs;
+		ULWord					mNumReads;
+};
+
+TEST_SUITE("DeviceCapabilities" * doctest::description("Memoized device capability tests"))
+{
+	TEST_CASE("Cache/Refresh")
+	{
+		DevCapsTestCard card;
+		CHECK_FALSE(card.RefreshDeviceCapabilities());		//	Not open
+		CHECK(card.GetSupportedItems(kNTV2EnumsID_PixelFormat).empty());
+		card.mRegs[kRegGlobalControl2] = kRegMaskAudioMixerPresent;
+		card.FakeOpen();
+		CHECK(card.RefreshDeviceCapabilities());
+		const ULWord numReads (card.mNumReads);
+		CHECK(numReads > 0);
+		CHECK(numReads < 4);	//	One kRegBoardID read, plus one batch for all register-based features
+
+		//	Cached answers need no device access...
+		NTV2PixelFormats pfs;  ::NTV2DeviceGetSupportedPixelFormats(DEVICE_ID_CORVID88, pfs);
+		for (int n(0);  n < 100;  n++)
+		{
+			CHECK_EQ(card.GetNumSupported(kDeviceGetNumVideoChannels), ::NTV2DeviceGetNumVideoChannels(DEVICE_ID_CORVID88));
+			CHECK_EQ(card.IsSupported(kDeviceCanDoPlayback), ::NTV2DeviceCanDoPlayback(DEVICE_ID_CORVID88));
+			CHECK(card.IsSupported(kDeviceCanDoAudioMixer));
+		}
+		CHECK_EQ(card.GetSupportedItems(kNTV2EnumsID_PixelFormat).size(), pfs.size());
+		CHECK_EQ(card.GetSupportedItems(kNTV2EnumsID_Channel).size(), ::NTV2DeviceGetNumFrameStores(DEVICE_ID_CORVID88));
+		CHECK_EQ(card.mNumReads, numReads);
+
+		//	...except breakout boxes, which come and go...
+		card.IsSupported(kDeviceHasBreakoutBoard);
+		CHECK(card.mNumReads > numReads);
+
+		//	Different firmware:  stale until refreshed...
+		card.mRegs[kRegBoardID] = ULWord(DEVICE_ID_CORVID1);
+		card.mRegs[kRegGlobalControl2] = 0;
+		CHECK_EQ(card.GetNumSupported(kDeviceGetNumVideoChannels), ::NTV2DeviceGetNumVideoChannels(DEVICE_ID_CORVID88));
+		CHECK(card.RefreshDeviceCapabilities());
+		CHECK_EQ(card.GetNumSupported(kDeviceGetNumVideoChannels), ::NTV2DeviceGetNumVideoChannels(DEVICE_ID_CORVID1));
+		CHECK_FALSE(card.IsSupported(kDeviceCanDoAudioMixer));
+		CHECK_EQ(card.GetSupportedItems(kNTV2EnumsID_Channel).size(), ::NTV2DeviceGetNumFrameStores(DEVICE_ID_CORVID1));
+	}	//	TEST_CASE("Cache/Refresh")
+}	//	TEST_SUITE("DeviceCapabilities")
+
+
+void devfeattable_marker() {}
+TEST_SUITE("DeviceFeatureTable" * doctest::description("Device feature table lookup & serialization tests"))
+{
+	TEST_CASE("Lookup")
+	{
+		NTV2DeviceFeatureRow row;
+		CHECK_FALSE(::NTV2DeviceGetFeatureRow(DEVICE_ID_NOTFOUND, row));
+		CHECK_FALSE(::NTV2DeviceCanDoPlayback(DEVICE_ID_NOTFOUND));
+		CHECK_EQ(::NTV2DeviceGetNumVideoChannels(DEVICE_ID_NOTFOUND), 0);
+		CHECK_FALSE(::NTV2DeviceCanDoVideoFormat(DEVICE_ID_NOTFOUND, NTV2_FORMAT_1080i_5994));
+
+		const NTV2DeviceIDSet devIDs (::NTV2GetSupportedDevices());
+		for (NTV2DeviceIDSetConstIter it(devIDs.begin());  it != devIDs.end();  ++it)
+		{
+			CHECK(::NTV2DeviceGetFeatureRow(*it, row));
+			CHECK_EQ(NTV2DeviceID(row.deviceID), *it);
+			CHECK_FALSE(::NTV2DeviceCanDoVideoFormat(*it, NTV2_MAX_NUM_VIDEO_FORMATS));	//	Out of range
+			CHECK_FALSE(::NTV2DeviceCanDoWidget(*it, NTV2_WIDGET_INVALID));
+			CHECK_FALSE(::NTV2DeviceCanDoFrameBufferFormat(*it, NTV2FrameBufferFormat(-1)));
+		}
+		CHECK(::NTV2DeviceCanDoWidget(DEVICE_ID_CORVID1, NTV2_WgtSDIOut1));
+		CHECK_FALSE(::NTV2DeviceCanDoWidget(DEVICE_ID_CORVID1, NTV2_WgtSDIOut2));
+		CHECK_EQ(::NTV2DeviceGetNumVideoChannels(DEVICE_ID_CORVID88), 8);
+		CHECK_EQ(::NTV2DeviceGetNumVideoChannels(DEVICE_ID_CORVID1), 2);
+		CHECK(::NTV2DeviceCanDo4KVideo(DEVICE_ID_CORVID88));
+		CHECK_FALSE(::NTV2DeviceCanDo4KVideo(DEVICE_ID_CORVID1));
+	}	//	TEST_CASE("Lookup")
+
+	TEST_CASE("Serialization")
+	{
+		const NTV2DeviceIDSet devIDs (::NTV2GetSupportedDevices());
+		for (NTV2DeviceIDSetConstIter it(devIDs.begin());  it != devIDs.end();  ++it)
+		{
+			NTV2DeviceFeatureRow row, row2;
+			REQUIRE(::NTV2DeviceGetFeatureRow(*it, row));
+			const std::string str (::NTV2DeviceFeatureRowToString(row));
+			CHECK(::NTV2DeviceFeatureRowFromString(str, row2));
+			CHECK_EQ(::memcmp(&row, &row2, sizeof(row)), 0);
+		}
+		NTV2DeviceFeatureRow row;
+		CHECK_FALSE(::NTV2DeviceFeatureRowFromString("CanDo4KVideo=1\n", row));					//	No DeviceID
+		CHECK_FALSE(::NTV2DeviceFeatureRowFromString("DeviceID=0x10538200\nCanDo4KVideo=yes\n", row));	//	Bad value
+		CHECK_FALSE(::NTV2DeviceFeatureRowFromString("DeviceID=0x10538200\nCanDo4KVideo\n", row));		//	No '='
+		REQUIRE(::NTV2DeviceFeatureRowFromString("DeviceID=0x10538200\r\nCanDo4KVideo=1\r\nCanTeleport=1\nGetNumVideoChannels=3\nCanDoVideoFormat=1,2,99999\n", row));
+		CHECK_EQ(row.deviceID, 0x10538200);
+		CHECK_EQ(row.nums[0], 0);	//	Not mentioned
+		NTV2DeviceFeatureRow row2;
+		REQUIRE(::NTV2DeviceFeatureRowFromString(::NTV2DeviceFeatureRowToString(row), row2));
+		CHECK_EQ(::memcmp(&row, &row2, sizeof(row)), 0);
+	}	//	TEST_CASE("Serialization")
+
+	TEST_CASE("Publish")
+	{
+		const NTV2DeviceID simID (NTV2DeviceID(0x1BADF00D));
+		NTV2DeviceFeatureRow row;
+		CHECK_FALSE(::NTV2DeviceCanDoPlayback(simID));
+		REQUIRE(::NTV2DeviceFeatureRowFromString("DeviceID=0x1BADF00D\nCanDoPlayback=1\nGetNumVideoChannels=3\nCanDoVideoFormat=1,2\n", row));
+		CHECK(::NTV2DevicePublishFeatureRow(row));
+		CHECK(::NTV2DeviceCanDoPlayback(simID));
+		CHECK_FALSE(::NTV2DeviceCanDoCapture(simID));
+		CHECK_EQ(::NTV2DeviceGetNumVideoChannels(simID), 3);
+		CHECK(::NTV2DeviceCanDoVideoFormat(simID, NTV2VideoFormat(1)));
+		CHECK(::NTV2DeviceCanDoVideoFormat(simID, NTV2VideoFormat(2)));
+		CHECK_FALSE(::NTV2DeviceCanDoVideoFormat(simID, NTV2VideoFormat(3)));
+		CHECK_EQ(::NTV2DeviceGetNumVideoChannels(DEVICE_ID_CORVID88), 8);	//	Others unaffected
+
+		//	Published rows override built-in rows...
+		REQUIRE(::NTV2DeviceGetFeatureRow(DEVICE_ID_CORVID88, row));
+		row.nums[0] = 0;  ::memset(row.widgets, 0, sizeof(row.widgets));
+		CHECK(::NTV2DevicePublishFeatureRow(row));
+		CHECK_FALSE(::NTV2DeviceCanDoWidget(DEVICE_ID_CORVID88, NTV2_Wgt3GSDIOut1));
+		CHECK(::NTV2DeviceUnpublishFeatureRow(DEVICE_ID_CORVID88));
+		CHECK(::NTV2DeviceCanDoWidget(DEVICE_ID_CORVID88, NTV2_Wgt3GSDIOut1));
+
+		CHECK(::NTV2DeviceUnpublishFeatureRow(simID));
+		CHECK_FALSE(::NTV2DeviceUnpublishFeatureRow(simID));
+		CHECK_FALSE(::NTV2DeviceCanDoPlayback(simID));
+		row.deviceID = ULWord(DEVICE_ID_NOTFOUND);
+		CHECK_FALSE(::NTV2DevicePublishFeatureRow(row));
+	}	//	TEST_CASE("Publish")
+}	//	TEST_SUITE("DeviceFeatureTable")
+
+
+void simdevice_marker() {}
+TEST_SUITE("SimulatedDevice" * doctest::description("Software-simulated NTV2 device tests"))
+{
+	TEST_CASE("Open/Registers/DMA")
+	{
+		CHECK_EQ(NTV2SimulatedDevice::DeviceIDFromName("Corvid 88"), DEVICE_ID_CORVID88);
+		CHECK_EQ(NTV2SimulatedDevice::DeviceIDFromName("0x10538200"), DEVICE_ID_CORVID88);
+		CHECK_EQ(NTV2SimulatedDevice::DeviceIDFromName("nosuchcard"), DEVICE_ID_NOTFOUND);
+		CNTV2Card card;
+		CHECK_FALSE(card.Open("ntv2sim://nosuchcard"));
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		CHECK(card.IsRemote());
+		CHECK_EQ(card.GetDeviceID(), DEVICE_ID_CORVID88);
+
+		//	Registers...
+		ULWord value(0);
+		CHECK(card.WriteRegister(kRegCh2OutputFrame, 0x12345678));
+		CHECK(card.ReadRegister(kRegCh2OutputFrame, value));
+		CHECK_EQ(value, 0x12345678);
+		CHECK(card.WriteRegister(kRegCh2OutputFrame, 0xA, 0x00000F00, 8));
+		CHECK(card.ReadRegister(kRegCh2OutputFrame, value));
+		CHECK_EQ(value, 0x12345A78);
+		CHECK(card.ReadRegister(kRegCh2OutputFrame, value, 0x0000FF00, 8));
+		CHECK_EQ(value, 0x5A);
+		NTV2FrameRate fr(NTV2_FRAMERATE_INVALID);
+		CHECK(card.GetFrameRate(fr, NTV2_CHANNEL1));
+		CHECK_EQ(fr, NTV2_FRAMERATE_5994);
+
+		//	DMA round trip...
+		NTV2Buffer src(4096), dst(4096);
+		for (ULWord ndx(0);  ndx < src.GetByteCount();  ndx++)
+			src.U8(int(ndx)) = UByte(ndx * 7);
+		CHECK(card.DMAWriteFrame(3, src, src.GetByteCount()));
+		CHECK(card.DMAReadFrame(3, dst, dst.GetByteCount()));
+		CHECK(dst.IsContentEqual(src));
+		CHECK(card.DMAReadFrame(4, dst, dst.GetByteCount()));	//	Never written
+		CHECK_EQ(dst.U8(0), 0);
+		CHECK(card.Close());
+	}	//	TEST_CASE("Open/Registers/DMA")
+
+	TEST_CASE("Vertical Interrupts")
+	{
+		CNTV2Card card;
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		CHECK(card.WaitForOutputVerticalInterrupt(NTV2_CHANNEL1));	//	Sync to VBI
+		const uint64_t startUS (AJATime::GetSystemMicroseconds());
+		CHECK(card.WaitForOutputVerticalInterrupt(NTV2_CHANNEL1, 6));
+		const uint64_t elapsedUS (AJATime::GetSystemMicroseconds() - startUS);
+		CHECK(elapsedUS > 6 * 16683 - 8000);	//	59.94Hz
+		CHECK(elapsedUS < 6 * 16683 + 30000);
+	}	//	TEST_CASE("Vertical Interrupts")
+
+	TEST_CASE("AutoCirculate Playout")
+	{
+		CNTV2Card card;
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		const NTV2FormatDescriptor fd (NTV2_FORMAT_1080p_5994_A, NTV2_FBF_10BIT_YCBCR);
+		NTV2Buffer video(fd.GetTotalBytes());
+		video.Fill(UByte(0x5A));
+		CHECK(card.AutoCirculateInitForOutput(NTV2_CHANNEL1, 0, NTV2_AUDIOSYSTEM_INVALID, 0, 1, 0, 3));
+		AUTOCIRCULATE_STATUS acStatus;
+		CHECK(card.AutoCirculateGetStatus(NTV2_CHANNEL1, acStatus));
+		CHECK(acStatus.IsStarting() == false);
+		CHECK_EQ(acStatus.GetState(), NTV2_AUTOCIRCULATE_INIT);
+		CHECK_EQ(acStatus.GetStartFrame(), 0);
+		CHECK_EQ(acStatus.GetEndFrame(), 3);
+		AUTOCIRCULATE_TRANSFER xfer;
+		xfer.SetVideoBuffer(video, video.GetByteCount());
+		for (int ndx(0);  ndx < 4;  ndx++)
+		{
+			CHECK(card.AutoCirculateTransfer(NTV2_CHANNEL1, xfer));
+			CHECK_EQ(xfer.GetTransferFrameNumber(), ULWord(ndx));
+		}
+		CHECK(card.AutoCirculateTransfer(NTV2_CHANNEL1, xfer));		//	Ring is full
+		CHECK_EQ(xfer.acTransferStatus.acTransferFrame, -1);
+		CHECK(card.AutoCirculateGetStatus(NTV2_CHANNEL1, acStatus));
+		CHECK_EQ(acStatus.GetBufferLevel(), 4);
+		NTV2Buffer frame(video.GetByteCount());
+		CHECK(card.DMAReadFrame(2, frame, frame.GetByteCount()));
+		CHECK(frame.IsContentEqual(video));
+
+		CHECK(card.AutoCirculateStart(NTV2_CHANNEL1));
+		CHECK(card.WaitForOutputVerticalInterrupt(NTV2_CHANNEL1, 3));
+		CHECK(card.AutoCirculateGetStatus(NTV2_CHANNEL1, acStatus));
+		CHECK(acStatus.IsRunning());
+		CHECK(acStatus.GetProcessedFrameCount() >= 1);
+		CHECK(acStatus.GetBufferLevel() < 4);
+		CHECK(card.AutoCirculateStop(NTV2_CHANNEL1));
+		CHECK(card.AutoCirculateGetStatus(NTV2_CHANNEL1, acStatus));
+		CHECK(acStatus.IsStopped());
+	}	//	TEST_CASE("AutoCirculate Playout")
+
+	TEST_CASE("AutoCirculate Capture")
+	{
+		CNTV2Card card;
+		REQUIRE(card.Open("ntv2sim://corvid88/?pattern=100%25%20ColorBars&input=1080p50a"));
+		CHECK_EQ(card.GetInputVideoFormat(NTV2_INPUTSOURCE_SDI1), NTV2_FORMAT_1080p_5000_A);
+		CHECK_EQ(card.GetInputVideoFormat(NTV2_INPUTSOURCE_SDI8), NTV2_FORMAT_1080p_5000_A);
+		CHECK(card.SetMode(NTV2_CHANNEL1, NTV2_MODE_CAPTURE));
+		CHECK(card.AutoCirculateInitForInput(NTV2_CHANNEL1, 0, NTV2_AUDIOSYSTEM_INVALID, 0, 1, 4, 7));
+		CHECK(card.AutoCirculateStart(NTV2_CHANNEL1));
+		CHECK(card.WaitForInputVerticalInterrupt(NTV2_CHANNEL1, 4));
+		AUTOCIRCULATE_STATUS acStatus;
+		CHECK(card.AutoCirculateGetStatus(NTV2_CHANNEL1, acStatus));
+		CHECK(acStatus.IsRunning());
+		CHECK(acStatus.HasAvailableInputFrame());
+
+		const NTV2FormatDescriptor fd (NTV2_FORMAT_1080p_5000_A, NTV2_FBF_10BIT_YCBCR);
+		NTV2Buffer video(fd.GetTotalBytes());
+		AUTOCIRCULATE_TRANSFER xfer;
+		xfer.SetVideoBuffer(video, video.GetByteCount());
+		CHECK(card.AutoCirculateTransfer(NTV2_CHANNEL1, xfer));
+		CHECK(xfer.GetTransferFrameNumber() >= 4);
+		CHECK(xfer.GetTransferFrameNumber() <= 7);
+		NTV2Buffer zeroes(video.GetByteCount());
+		zeroes.Fill(ULWord(0));
+		CHECK_FALSE(video.IsContentEqual(zeroes));		//	Got color bars
+		CHECK(card.AutoCirculateStop(NTV2_CHANNEL1));
+	}	//	TEST_CASE("AutoCirculate Capture")
+}	//	TEST_SUITE("SimulatedDevice")
+
+
+void regpreset_marker() {}
+TEST_SUITE("RegisterPreset" * doctest::description("Register write preset compile/persist/recall tests"))
+{
+	TEST_CASE("Collapse")
+	{
+		NTV2RegisterWrites writes;
+		writes.push_back(NTV2RegInfo(kRegCh1Control, 1, kRegMaskMode, kRegShiftMode));
+		writes.push_back(NTV2RegInfo(kRegCh2Control, 0x12345678));
+		writes.push_back(NTV2RegInfo(kRegCh1Control, 3, kRegMaskFrameFormat, kRegShiftFrameFormat));
+		writes.push_back(NTV2RegInfo(kRegCh1Control, 0, kRegMaskMode, kRegShiftMode));
+		writes.push_back(NTV2RegInfo(kVRegChannelCrosspointFirst, 7, 0x0000FF00, 8));	//	Virtual:  mask & shift ignored
+		writes.push_back(NTV2RegInfo(kRegCh2Control, 0, 0));							//	Zero mask:  kept as-is
+		writes.push_back(NTV2RegInfo(kRegCh2Control, 0x5, 0xF));
+		const NTV2RegisterWrites collapsed (NTV2RegisterPreset::Collapse(writes));
+		REQUIRE_EQ(collapsed.size(), 5);
+		CHECK_EQ(collapsed.at(0).registerNumber, ULWord(kRegCh1Control));
+		CHECK_EQ(collapsed.at(0).registerValue, ULWord(3 << kRegShiftFrameFormat));
+		CHECK_EQ(collapsed.at(0).registerMask, ULWord(kRegMaskMode | kRegMaskFrameFormat));
+		CHECK_EQ(collapsed.at(0).registerShift, 0);
+		CHECK_EQ(collapsed.at(1).registerValue, 0x12345678);
+		CHECK_EQ(collapsed.at(1).registerMask, 0xFFFFFFFF);
+		CHECK_EQ(collapsed.at(2).registerNumber, ULWord(kVRegChannelCrosspointFirst));
+		CHECK_EQ(collapsed.at(2).registerValue, 7);
+		CHECK_EQ(collapsed.at(2).registerMask, 0xFFFFFFFF);
+		CHECK_EQ(collapsed.at(3).registerMask, 0);
+		CHECK_EQ(collapsed.at(4).registerNumber, ULWord(kRegCh2Control));	//	Not merged across the zero-mask write
+		CHECK_EQ(collapsed.at(4).registerValue, 0x5);
+		CHECK_EQ(collapsed.at(4).registerMask, 0xF);
+	}	//	TEST_CASE("Collapse")
+
+	TEST_CASE("Collapse Keeps Trigger Order")
+	{	//	Configure, trigger, reconfigure:  the reconfiguration must stay after the trigger
+		NTV2RegisterWrites writes;
+		writes.push_back(NTV2RegInfo(kRegCh1Control, 1, kRegMaskMode, kRegShiftMode));
+		writes.push_back(NTV2RegInfo(kRegCh1OutputFrame, 5));							//	Volatile:  the trigger
+		writes.push_back(NTV2RegInfo(kRegCh1Control, 0, kRegMaskMode, kRegShiftMode));
+		writes.push_back(NTV2RegInfo(kRegCh1Control, 3, kRegMaskFrameFormat, kRegShiftFrameFormat));
+		const NTV2RegisterWrites collapsed (NTV2RegisterPreset::Collapse(writes));
+		REQUIRE_EQ(collapsed.size(), 3);
+		CHECK_EQ(collapsed.at(0).registerNumber, ULWord(kRegCh1Control));
+		CHECK_EQ(collapsed.at(0).registerValue, ULWord(1 << kRegShiftMode));
+		CHECK_EQ(collapsed.at(0).registerMask, ULWord(kRegMaskMode));
+		CHECK_EQ(collapsed.at(1).registerNumber, ULWord(kRegCh1OutputFrame));
+		CHECK_EQ(collapsed.at(2).registerNumber, ULWord(kRegCh1Control));
+		CHECK_EQ(collapsed.at(2).registerValue, ULWord(3 << kRegShiftFrameFormat));
+		CHECK_EQ(collapsed.at(2).registerMask, ULWord(kRegMaskMode | kRegMaskFrameFormat));
+	}	//	TEST_CASE("Collapse Keeps Trigger Order")
+
+	TEST_CASE("Record/Save/Load/Apply")
+	{
+		CNTV2Card card;
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		//	Record a setup without actually writing it...
+		CHECK(card.StartRecordRegisterWrites(/*skipActualWrites*/true));
+		CHECK(card.SetMode(NTV2_CHANNEL2, NTV2_MODE_CAPTURE));
+		CHECK(card.SetFrameBufferFormat(NTV2_CHANNEL2, NTV2_FBF_8BIT_YCBCR));
+		CHECK(card.SetFrameBufferFormat(NTV2_CHANNEL2, NTV2_FBF_ARGB));
+		CHECK(card.SetMode(NTV2_CHANNEL1, NTV2_MODE_DISPLAY));		//	Already display -- no-op
+		CHECK(card.StopRecordRegisterWrites());
+		NTV2RegisterWrites recording;
+		CHECK(card.GetRecordedRegisterWrites(recording));
+		REQUIRE(recording.size() >= 4);
+		NTV2PixelFormat pf(NTV2_FBF_INVALID);
+		CHECK(card.GetFrameBufferFormat(NTV2_CHANNEL2, pf));
+		CHECK_EQ(pf, NTV2_FBF_10BIT_YCBCR);		//	Not written
+
+		NTV2RegisterPreset preset;
+		CHECK(preset.Compile(recording, card.GetDeviceID()));
+		CHECK_EQ(preset.GetNumRecordedWrites(), recording.size());
+		CHECK(preset.GetNumWrites() < recording.size());
+
+		//	Persist & reload...
+		string path;
+		REQUIRE(AJA_SUCCESS(AJAFileIO::TempDirectory(path)));
+		path += "ut_ajantv2_regpreset.bin";
+		CHECK(preset.Save(path));
+		NTV2RegisterPreset loaded;
+		CHECK(loaded.Load(path));
+		AJAFileIO::Delete(path);
+		CHECK_EQ(loaded.GetDeviceID(), DEVICE_ID_CORVID88);
+		CHECK_EQ(loaded.GetNumRecordedWrites(), preset.GetNumRecordedWrites());
+		CHECK(loaded.GetWrites() == preset.GetWrites());
+		NTV2_RPC_BLOB_TYPE blob;
+		CHECK(preset.Serialize(blob));
+		blob.pop_back();
+		CHECK_FALSE(loaded.Deserialize(blob));		//	Truncated
+
+		//	Recall...
+		NTV2RegisterWrites delta;
+		CHECK(loaded.Apply(card, true, NTV2_CHANNEL1, &delta));
+		CHECK_EQ(delta.size(), 1);					//	Only kRegCh2Control changes
+		CHECK(card.GetFrameBufferFormat(NTV2_CHANNEL2, pf));
+		CHECK_EQ(pf, NTV2_FBF_ARGB);
+		NTV2Mode mode(NTV2_MODE_INVALID);
+		CHECK(card.GetMode(NTV2_CHANNEL2, mode));
+		CHECK_EQ(mode, NTV2_MODE_CAPTURE);
+		CHECK(loaded.Apply(card, false, NTV2_CHANNEL1, &delta));
+		CHECK(delta.empty());						//	Already applied
+
+		NTV2RegisterPreset wrongModel;
+		CHECK(wrongModel.Compile(recording, DEVICE_ID_KONA5));
+		CHECK_FALSE(wrongModel.Apply(card));
+	}	//	TEST_CASE("Record/Save/Load/Apply")
+}	//	TEST_SUITE("RegisterPreset")
+
+
+void routedelta_marker() {}
+TEST_SUITE("RouteDelta" * doctest::description("Diff-based ApplySignalRoute tests"))
+{
+	TEST_CASE("ApplySignalRouteDelta")
+	{
+		CNTV2Card card;
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		NTV2XptConnections routeA, routeB, actual;
+		routeA.insert(NTV2Connection(NTV2_XptFrameBuffer1Input, NTV2_XptSDIIn1));
+		routeA.insert(NTV2Connection(NTV2_XptFrameBuffer2Input, NTV2_XptSDIIn2));
+		routeA.insert(NTV2Connection(NTV2_XptSDIOut3Input, NTV2_XptFrameBuffer3YUV));
+		routeB.insert(NTV2Connection(NTV2_XptFrameBuffer1Input, NTV2_XptSDIIn1));		//	Unchanged
+		routeB.insert(NTV2Connection(NTV2_XptFrameBuffer2Input, NTV2_XptSDIIn3));		//	Changed
+		routeB.insert(NTV2Connection(NTV2_XptSDIOut4Input, NTV2_XptFrameBuffer4YUV));	//	New, SDIOut3Input removed
+
+		CHECK(card.ApplySignalRouteDelta(routeA, true));
+		CHECK(card.GetConnections(actual));
+		CHECK(actual == routeA);
+
+		//	Augment, then replace...
+		CHECK(card.StartRecordRegisterWrites());
+		CHECK(card.ApplySignalRouteDelta(routeB, false));
+		CHECK(card.GetConnections(actual));
+		CHECK_EQ(actual.size(), 4);		//	SDIOut3Input still connected
+		CHECK(card.ApplySignalRouteDelta(routeB, true));
+		CHECK(card.GetConnections(actual));
+		CHECK(actual == routeB);
+		CHECK(card.ApplySignalRouteDelta(routeB, true));		//	No change -- no writes
+		CHECK(card.StopRecordRegisterWrites());
+		NTV2RegisterWrites writes;
+		CHECK(card.GetRecordedRegisterWrites(writes));
+		CHECK_EQ(writes.size(), 3);		//	FB2 + SDIOut4 regs, then SDIOut3 reg
+		for (NTV2RegisterWritesConstIter it(writes.begin());  it != writes.end();  ++it)
+		{
+			uint32_t regNum(0), ndx(0);
+			CHECK(CNTV2RegisterExpert::GetCrosspointSelectGroupRegisterInfo(NTV2_XptFrameBuffer1Input, regNum, ndx));
+			if (it->registerNumber == regNum)
+				CHECK_EQ(it->registerMask & (0xFFUL << (ndx * 8)), 0);	//	FrameBuffer1Input never touched
+		}
+	}	//	TEST_CASE("ApplySignalRouteDelta")
+
+	//	A simulated device with a crosspoint connect ROM that won't connect anything to SDIIn3
+	class XptROMTestCard : public CNTV2Card
+	{
+		public:
+			using CNTV2Card::IsSupported;
+			virtual bool IsSupported (const NTV2BoolParamID inParamID)
+			{
+				return inParamID == kDeviceHasXptConnectROM  ?  true  :  CNTV2Card::IsSupported(inParamID);
+			}
+			virtual bool CanConnect (const NTV2InputCrosspointID inInputXpt, const NTV2OutputCrosspointID inOutputXpt, bool & outCanConnect)
+			{
+				(void) inInputXpt;
+				outCanConnect = inOutputXpt != NTV2_XptSDIIn3;
+				return true;
+			}
+	};
+
+	TEST_CASE("Validated Against Connect ROM")
+	{
+		XptROMTestCard card;
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		NTV2XptConnections routeA, routeB, actual;
+		routeA.insert(NTV2Connection(NTV2_XptFrameBuffer1Input, NTV2_XptSDIIn1));
+		routeA.insert(NTV2Connection(NTV2_XptFrameBuffer2Input, NTV2_XptSDIIn2));
+		CHECK(card.ApplySignalRouteDelta(routeA, true));
+		routeB.insert(NTV2Connection(NTV2_XptSDIOut4Input, NTV2_XptFrameBuffer4YUV));	//	Legal
+		routeB.insert(NTV2Connection(NTV2_XptFrameBuffer2Input, NTV2_XptSDIIn3));		//	Illegal
+		CHECK(card.StartRecordRegisterWrites());
+		CHECK_FALSE(card.ApplySignalRouteDelta(routeB, true));
+		CHECK(card.StopRecordRegisterWrites());
+		NTV2RegisterWrites writes;
+		CHECK(card.GetRecordedRegisterWrites(writes));
+		CHECK(writes.empty());			//	Nothing written, not even the legal connection
+		CHECK(card.GetConnections(actual));
+		CHECK(actual == routeA);
+	}	//	TEST_CASE("Validated Against Connect ROM")
+}	//	TEST_SUITE("RouteDelta")
+
+
+void routesolver_marker() {}
+class RouteSolverTestCard : public CNTV2Card	//	A Kona4 with a made-up crosspoint connect ROM
+{
+	public:
+		explicit RouteSolverTestCard (const NTV2PossibleConnections & inROM)	:	mROM(inROM)	{_boardOpened = true;}
+		~RouteSolverTestCard ()	{_boardOpened = false;}
+		NTV2DeviceID GetDeviceID (void)	{return DEVICE_ID_KONA4;}
+		bool IsSupported (const NTV2BoolParamID inParamID)	{return inParamID == kDeviceHasXptConnectROM;}
+		bool GetPossibleConnections (NTV2PossibleConnections & outConnections)	{outConnections = mROM;  return true;}
+		NTV2PossibleConnections	mROM;
+};
+
+TEST_SUITE("RouteSolver" * doctest::description("Signal path solver tests"))
+{
+	TEST_CASE("Solve")
+	{
+		NTV2RouteSolver::ClearCache();
+		NTV2XptConnections route, expected;
+
+		//	Direct...
+		CHECK(NTV2RouteSolver::Solve(DEVICE_ID_KONA4, NTV2_XptSDIIn1, NTV2_XptFrameBuffer1Input, route));
+		expected.insert(NTV2Connection(NTV2_XptFrameBuffer1Input, NTV2_XptSDIIn1));
+		CHECK(route == expected);
+
+		//	RGB FrameStore needs a CSC...
+		CHECK(NTV2RouteSolver::Solve(DEVICE_ID_KONA4, NTV2_XptSDIIn1, NTV2_XptFrameBuffer1Input, route,
+									NTV2RouteConstraints().SetSinkColor(NTV2RouteColor_RGB)));
+		expected.clear();
+		expected.insert(NTV2Connection(NTV2_XptCSC1VidInput, NTV2_XptSDIIn1));
+		expected.insert(NTV2Connection(NTV2_XptFrameBuffer1Input, NTV2_XptCSC1VidRGB));
+		CHECK(route == expected);
+
+		//	RGB playout through a LUT...
+		CHECK(NTV2RouteSolver::Solve(DEVICE_ID_KONA4, NTV2_XptFrameBuffer1RGB, NTV2_XptSDIOut1Input, route,
+									NTV2RouteConstraints().RequireLUT().SetSinkColor(NTV2RouteColor_YUV)));
+		CHECK_EQ(route.size(), 3);
+		CHECK_EQ(route[NTV2_XptLUT1Input], NTV2_XptFrameBuffer1RGB);
+		CHECK_EQ(route[NTV2_XptSDIOut1Input] & 0x80, 0);	//	YUV
+
+		//	Two-sample-interleave:  2nd link must use the 425 mux's other input...
+		NTV2XptConnections linkA, linkB;
+		CHECK(NTV2RouteSolver::Solve(DEVICE_ID_KONA4, NTV2_XptSDIIn1, NTV2_XptFrameBuffer1Input, linkA, NTV2RouteConstraints().Require425Mux()));
+		CHECK_EQ(linkA[NTV2_Xpt425Mux1AInput], NTV2_XptSDIIn1);
+		CHECK_EQ(linkA[NTV2_XptFrameBuffer1Input], NTV2_Xpt425Mux1AYUV);
+		CHECK(NTV2RouteSolver::Solve(DEVICE_ID_KONA4, NTV2_XptSDIIn2, NTV2_XptFrameBuffer1DS2Input, linkB,
+									NTV2RouteConstraints().Require425Mux().ExcludeInputsIn(linkA)));
+		CHECK_EQ(linkB[NTV2_Xpt425Mux1BInput], NTV2_XptSDIIn2);
+		CHECK_EQ(linkB[NTV2_XptFrameBuffer1DS2Input], NTV2_Xpt425Mux1BYUV);
+
+		//	Exclusions...
+		CHECK(NTV2RouteSolver::Solve(DEVICE_ID_KONA4, NTV2_XptSDIIn1, NTV2_XptFrameBuffer1Input, route,
+									NTV2RouteConstraints().SetSinkColor(NTV2RouteColor_RGB).Exclude(NTV2_WgtCSC1)));
+		CHECK_EQ(route[NTV2_XptCSC2VidInput], NTV2_XptSDIIn1);
+
+		//	Impossible...
+		CHECK_FALSE(NTV2RouteSolver::Solve(DEVICE_ID_IOX3, NTV2_XptSDIIn1, NTV2_XptFrameBuffer1Input, route, NTV2RouteConstraints().Require425Mux()));
+		CHECK(route.empty());
+		CHECK_FALSE(NTV2RouteSolver::Solve(DEVICE_ID_KONA4, NTV2_XptSDIIn1, NTV2_XptFrameBuffer1Input, route,
+									NTV2RouteConstraints().SetSinkColor(NTV2RouteColor_RGB).ExcludeType(NTV2WidgetType_CSC)));
+		CHECK_FALSE(NTV2RouteSolver::Solve(DEVICE_ID_IOX3, NTV2_XptSDIIn1, NTV2_XptFrameBuffer8Input, route));	//	No such input
+
+		//	Cached...
+		const size_t numCached (NTV2RouteSolver::GetNumCachedSolutions());
+		CHECK(NTV2RouteSolver::Solve(DEVICE_ID_KONA4, NTV2_XptSDIIn1, NTV2_XptFrameBuffer1Input, route, NTV2RouteConstraints().Require425Mux()));
+		CHECK(route == linkA);
+		CHECK_EQ(NTV2RouteSolver::GetNumCachedSolutions(), numCached);
+		NTV2RouteSolver::ClearCache();
+		CHECK_EQ(NTV2RouteSolver::GetNumCachedSolutions(), 0);
+	}	//	TEST_CASE("Solve")
+
+	TEST_CASE("Solve & Apply")
+	{
+		CNTV2Card card;
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		NTV2XptConnections route, actual;
+		CHECK(NTV2RouteSolver::Solve(card, NTV2_XptFrameBuffer2YUV, NTV2_XptSDIOut2Input, route, NTV2RouteConstraints().SetSinkColor(NTV2RouteColor_RGB)));
+		CHECK_EQ(route.size(), 2);
+		CHECK(card.ApplySignalRoute(route, true));
+		CHECK(card.GetConnections(actual));
+		CHECK(actual == route);
+	}	//	TEST_CASE("Solve & Apply")
+
+	TEST_CASE("Each Widget Once")
+	{
+		//	The shortest way to reach Mixer1's output goes through CSC1, but the only way to the sink is then back through
+		//	CSC1, so the route must reach the mixer the long way...
+		NTV2RouteSolver::ClearCache();
+		NTV2PossibleConnections rom;
+		rom.insert(NTV2PossibleConnections::value_type(NTV2_XptCSC1VidInput, NTV2_XptFrameBuffer1YUV));
+		rom.insert(NTV2PossibleConnections::value_type(NTV2_XptCSC1VidInput, NTV2_XptMixer1VidYUV));
+		rom.insert(NTV2PossibleConnections::value_type(NTV2_XptCSC2VidInput, NTV2_XptFrameBuffer1YUV));
+		rom.insert(NTV2PossibleConnections::value_type(NTV2_XptCSC3VidInput, NTV2_XptCSC2VidYUV));
+		rom.insert(NTV2PossibleConnections::value_type(NTV2_XptMixer1FGVidInput, NTV2_XptCSC1VidYUV));
+		rom.insert(NTV2PossibleConnections::value_type(NTV2_XptMixer1BGVidInput, NTV2_XptCSC3VidYUV));
+		rom.insert(NTV2PossibleConnections::value_type(NTV2_XptSDIOut1Input, NTV2_XptCSC1VidYUV));
+		RouteSolverTestCard card(rom);
+		NTV2RouteConstraints constraints;
+		constraints.requiredTypes.insert(NTV2WidgetType_Mixer);
+		NTV2XptConnections route, expected;
+		CHECK(NTV2RouteSolver::Solve(card, NTV2_XptFrameBuffer1YUV, NTV2_XptSDIOut1Input, route, constraints));
+		expected.insert(NTV2Connection(NTV2_XptCSC2VidInput, NTV2_XptFrameBuffer1YUV));
+		expected.insert(NTV2Connection(NTV2_XptCSC3VidInput, NTV2_XptCSC2VidYUV));
+		expected.insert(NTV2Connection(NTV2_XptMixer1BGVidInput, NTV2_XptCSC3VidYUV));
+		expected.insert(NTV2Connection(NTV2_XptCSC1VidInput, NTV2_XptMixer1VidYUV));
+		expected.insert(NTV2Connection(NTV2_XptSDIOut1Input, NTV2_XptCSC1VidYUV));
+		CHECK(route == expected);
+		constraints.Exclude(NTV2_WgtCSC3);
+		CHECK_FALSE(NTV2RouteSolver::Solve(card, NTV2_XptFrameBuffer1YUV, NTV2_XptSDIOut1Input, route, constraints));
+		NTV2RouteSolver::ClearCache();
+	}	//	TEST_CASE("Each Widget Once")
+}	//	TEST_SUITE("RouteSolver")
+
+
+#if defined(AJALinux)
+void mappedregreads_marker() {}
+TEST_SUITE("MappedRegReads" * doctest::description("Linux memory-mapped register read fast path tests"))
+{
+	TEST_CASE("IsMappedRegisterReadSafe")
+	{
+		CHECK(CNTV2LinuxDriverInterface::IsMappedRegisterReadSafe(kRegBoardID));
+		CHECK(CNTV2LinuxDriverInterface::IsMappedRegisterReadSafe(kRegGlobalControl));
+		CHECK(CNTV2LinuxDriverInterface::IsMappedRegisterReadSafe(kRegStatus));
+		CHECK(CNTV2LinuxDriverInterface::IsMappedRegisterReadSafe(kRegXptSelectGroup1));
+		CHECK_FALSE(CNTV2LinuxDriverInterface::IsMappedRegisterReadSafe(kRegRS422Receive));		//	Driver-serviced FIFO
+		CHECK_FALSE(CNTV2LinuxDriverInterface::IsMappedRegisterReadSafe(kRegRS422Control));
+		CHECK_FALSE(CNTV2LinuxDriverInterface::IsMappedRegisterReadSafe(kVRegDriverVersion));	//	Virtual
+		CHECK_FALSE(CNTV2LinuxDriverInterface::IsMappedRegisterReadSafe(kRegLUTV2Control));		//	Indirect
+	}	//	TEST_CASE("IsMappedRegisterReadSafe")
+
+	TEST_CASE("SetMappedRegisterReads")
+	{
+		CNTV2Card card;
+		CHECK_FALSE(card.SetMappedRegisterReads(true));		//	Not open
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		CHECK_FALSE(card.SetMappedRegisterReads(true));		//	Remote
+		CHECK_FALSE(card.IsMappedRegisterReadsEnabled());
+		CHECK(card.SetMappedRegisterReads(false));
+		ULWord value(0);
+		CHECK(card.ReadRegister(kRegBoardID, value));
+		CHECK_EQ(value, ULWord(DEVICE_ID_CORVID88));
+	}	//	TEST_CASE("SetMappedRegisterReads")
+
+	//	An "open" local device whose driver only answers kVRegBA0MemorySize, and whose BAR is a vector
+	class MappedRegsTestCard : public CNTV2Card
+	{
+		public:
+			MappedRegsTestCard (const ULWord inBoardID)
+				:	mBAR(kRegNumRegisters, 0),  mBARSizeReads(0)
+			{
+				_boardOpened = true;  _boardID = DEVICE_ID_CORVID88;  _hDevice = HANDLE(-2);	//	Bad fd:  every ioctl fails
+				mBAR[kRegBoardID] = inBoardID;
+				mBAR[kRegFlatMatteValue] = 0x12345678;
+			}
+			virtual ~MappedRegsTestCard ()
+			{
+				_pMappedRegisters = _pMappedRegisterBAR = AJA_NULL;
+				_hDevice = INVALID_HANDLE_VALUE;  _boardOpened = false;
+			}
+			virtual bool ReadRegister (const ULWord inRegNum, ULWord & outValue, const ULWord inMask = 0xFFFFFFFF, const ULWord inShift = 0)
+			{
+				if (inRegNum != kVRegBA0MemorySize)
+					return CNTV2Card::ReadRegister(inRegNum, outValue, inMask, inShift);
+				mBARSizeReads++;
+				outValue = ULWord(mBAR.size() * sizeof(ULWord));
+				return true;
+			}
+		protected:
+			virtual void * MapRegisterBAR (const ULWord inByteCount)
+			{
+				return inByteCount == mBAR.size() * sizeof(ULWord) ? &mBAR[0] : AJA_NULL;
+			}
+			virtual void UnmapRegisterBAR (void * pInBAR, const ULWord inByteCount)	{(void)pInBAR; (void)inByteCount;}
+		public:
+			vector<ULWord>	mBAR;
+			int				mBARSizeReads;
+	};
+
+	TEST_CASE("Enable Through Driver")
+	{
+		MappedRegsTestCard card (DEVICE_ID_CORVID88);
+		ULWord value(0);
+		CHECK_FALSE(card.ReadRegister(kRegFlatMatteValue, value));	//	ioctl fails
+		REQUIRE(card.SetMappedRegisterReads(true));
+		CHECK_EQ(card.mBARSizeReads, 1);
+		CHECK(card.IsMappedRegisterReadsEnabled());
+		CHECK(card.ReadRegister(kRegFlatMatteValue, value));
+		CHECK_EQ(value, ULWord(0x12345678));
+		CHECK(card.ReadRegister(kRegFlatMatteValue, value, 0x0000FF00, 8));
+		CHECK_EQ(value, ULWord(0x56));
+		CHECK_FALSE(card.ReadRegister(kRegRS422Receive, value));		//	Unsafe:  still goes to the driver
+		CHECK(card.SetMappedRegisterReads(false));
+		CHECK_FALSE(card.IsMappedRegisterReadsEnabled());
+		CHECK_FALSE(card.ReadRegister(kRegFlatMatteValue, value));
+		CHECK(card.SetMappedRegisterReads(true));						//	Re-enabled without asking the driver again
+		CHECK_EQ(card.mBARSizeReads, 1);
+
+		MappedRegsTestCard wrongBAR (DEVICE_ID_KONA5);					//	BAR0 without the video registers
+		CHECK_FALSE(wrongBAR.SetMappedRegisterReads(true));
+		CHECK_FALSE(wrongBAR.IsMappedRegisterReadsEnabled());
+	}	//	TEST_CASE("Enable Through Driver")
+}	//	TEST_SUITE("MappedRegReads")
+#endif	//	defined(AJALinux)
+
+
+void waitanyinterrupt_marker() {}
+TEST_SUITE("WaitAnyInterrupt" * doctest::description("Multi-source interrupt wait tests"))
+{
+	TEST_CASE("NTV2InterruptWaitSet")
+	{
+		NTV2InterruptWaitSet waitSet;
+		CHECK(waitSet.IsEmpty());
+		waitSet.Add(eOutput1).Add(eInput2).Add(eNumInterruptTypes);
+		CHECK_EQ(waitSet.GetMask(), (ULWord64(1) << eOutput1) | (ULWord64(1) << eInput2));
+		CHECK_EQ(waitSet.GetSources().size(), 2);
+		CHECK_FALSE(waitSet.SetResult(eOutput1, 10, 1000));		//	First result only establishes the baseline
+		CHECK(waitSet.HasBaseline(eOutput1));
+		CHECK_FALSE(waitSet.SetResult(eOutput1, 10, 1000));
+		CHECK(waitSet.SetResult(eOutput1, 12, 3000));
+		CHECK(waitSet.HasFired(eOutput1));
+		CHECK_FALSE(waitSet.HasFired(eInput2));
+		CHECK_EQ(waitSet.GetCount(eOutput1), 12);
+		CHECK_EQ(waitSet.GetTime(eOutput1), 3000);
+		waitSet.StartWait();
+		CHECK_EQ(waitSet.GetFiredMask(), 0);
+		waitSet.Remove(eOutput1);
+		CHECK_FALSE(waitSet.Contains(eOutput1));
+		CHECK_FALSE(waitSet.HasBaseline(eOutput1));
+		waitSet.Clear();
+		CHECK(waitSet.IsEmpty());
+	}	//	TEST_CASE("NTV2InterruptWaitSet")
+
+	TEST_CASE("WaitForAnyInterrupt")
+	{
+		CNTV2Card card;
+		NTV2InterruptWaitSet waitSet;
+		waitSet.Add(eOutput1).Add(eInput2);
+		CHECK_FALSE(card.WaitForAnyInterrupt(waitSet));		//	Not open
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		NTV2InterruptWaitSet emptySet;
+		CHECK_FALSE(card.WaitForAnyInterrupt(emptySet));
+		ULWord64 lastOut1 (0);
+		for (int n(0);  n < 5;  n++)
+		{
+			REQUIRE(card.WaitForAnyInterrupt(waitSet, 100));
+			CHECK(waitSet.GetFiredMask());
+			CHECK_EQ(waitSet.GetFiredMask() & ~waitSet.GetMask(), 0);
+			if (waitSet.HasFired(eOutput1))
+			{
+				CHECK(waitSet.GetCount(eOutput1) > lastOut1);
+				CHECK(waitSet.GetTime(eOutput1) > 0);
+				lastOut1 = waitSet.GetCount(eOutput1);
+			}
+		}
+		//	Interrupts that happen between waits are reported immediately
+		REQUIRE(card.WaitForAnyInterrupt(waitSet, 100));
+		AJATime::Sleep(40);
+		const uint64_t startMS (AJATime::GetSystemMilliseconds());
+		CHECK(card.WaitForAnyInterrupt(waitSet, 100));
+		CHECK(AJATime::GetSystemMilliseconds() - startMS < 10);
+		CHECK(waitSet.HasFired(eOutput1));
+		CHECK(waitSet.HasFired(eInput2));
+	}	//	TEST_CASE("WaitForAnyInterrupt")
+
+	TEST_CASE("NTV2InterruptSnapshot")
+	{
+		NTV2InterruptSnapshot snapshot;
+		CHECK(snapshot.GetRegisters().empty());
+		snapshot.AddRegister(kRegStatus).AddAutoCirculate(NTV2CROSSPOINT_CHANNEL1).AddAutoCirculate(NTV2CROSSPOINT_INVALID);
+		CHECK_EQ(snapshot.GetRegisters().size(), 1);
+		CHECK_EQ(snapshot.GetAutoCirculates().size(), 1);
+		NTV2RegNumSet regNums;
+		for (ULWord regNum(0);  regNum < 2 * NTV2_INTERRUPT_SNAPSHOT_MAX_REGISTERS;  regNum++)
+			regNums.insert(regNum);
+		snapshot.AddRegisters(regNums);
+		CHECK_EQ(snapshot.GetRegisters().size(), NTV2_INTERRUPT_SNAPSHOT_MAX_REGISTERS);
+		snapshot.Clear();
+		snapshot.AddRegister(kRegStatus).AddAutoCirculate(NTV2CROSSPOINT_CHANNEL1);
+		snapshot.StartCapture(eOutput1);
+		snapshot.SetRegisterValue(kRegStatus, 0x1234);
+		snapshot.SetRegisterValue(kRegGlobalControl, 0x5678);	//	Not requested -- ignored
+		ULWord value (0);
+		CHECK(snapshot.GetRegisterValue(kRegStatus, value));
+		CHECK_EQ(value, 0x1234);
+		CHECK_FALSE(snapshot.GetRegisterValue(kRegGlobalControl, value));
+		AUTOCIRCULATE_STATUS acStatus (NTV2CROSSPOINT_INPUT1);
+		CHECK_FALSE(snapshot.SetAutoCirculateStatus(acStatus));	//	Not requested
+		acStatus.acCrosspoint = NTV2CROSSPOINT_CHANNEL1;
+		acStatus.acFramesProcessed = 42;
+		CHECK(snapshot.SetAutoCirculateStatus(acStatus));
+		AUTOCIRCULATE_STATUS acResult;
+		CHECK(snapshot.GetAutoCirculateStatus(NTV2CROSSPOINT_CHANNEL1, acResult));
+		CHECK_EQ(acResult.acFramesProcessed, 42);
+		snapshot.SetInterrupt(7, 1000, true);
+		CHECK(snapshot.IsCoherent());
+		CHECK_EQ(snapshot.GetInterruptCount(), 7);
+		snapshot.StartCapture(eOutput1);
+		CHECK(snapshot.GetRegisterValues().empty());
+		CHECK_FALSE(snapshot.GetAutoCirculateStatus(NTV2CROSSPOINT_CHANNEL1, acResult));
+		CHECK_EQ(snapshot.GetRegisters().size(), 1);
+	}	//	TEST_CASE("NTV2InterruptSnapshot")
+
+	TEST_CASE("WaitForInterruptSnapshot")
+	{
+		CNTV2Card card;
+		NTV2InterruptSnapshot snapshot;
+		snapshot.AddRegister(kRegCh1OutputFrame).AddRegister(kRegCh1InputFrame).AddAutoCirculate(NTV2CROSSPOINT_CHANNEL1);
+		CHECK_FALSE(card.WaitForOutputVerticalInterrupt(NTV2_CHANNEL1, snapshot));	//	Not open
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		REQUIRE(card.SetOutputFrame(NTV2_CHANNEL1, 3));
+		CHECK_FALSE(card.WaitForOutputVerticalInterrupt(NTV2_MAX_NUM_CHANNELS, snapshot));
+		ULWord64 lastTime (0);
+		for (int n(0);  n < 3;  n++)
+		{
+			REQUIRE(card.WaitForOutputVerticalInterrupt(NTV2_CHANNEL1, snapshot));
+			CHECK_EQ(snapshot.GetInterrupt(), eOutput1);
+			CHECK_EQ(snapshot.GetRegisterValues().size(), 2);
+			ULWord frameNum (0);
+			CHECK(snapshot.GetRegisterValue(kRegCh1OutputFrame, frameNum));
+			CHECK_EQ(frameNum, 3);
+			AUTOCIRCULATE_STATUS acStatus;
+			CHECK(snapshot.GetAutoCirculateStatus(NTV2CROSSPOINT_CHANNEL1, acStatus));
+			CHECK(snapshot.GetInterruptTime() > lastTime);
+			lastTime = snapshot.GetInterruptTime();
+		}
+		REQUIRE(card.WaitForInputVerticalInterrupt(NTV2_CHANNEL1, snapshot));
+		CHECK_EQ(snapshot.GetInterrupt(), eInput1);
+	}	//	TEST_CASE("WaitForInterruptSnapshot")
+}	//	TEST_SUITE("WaitAnyInterrupt")
+
+
+class TCPServerTestCard : public CNTV2Card	//	Records what an NTV2TCPServer asks of it
+{
+	public:
+		TCPServerTestCard ()
+		{
+			_boardOpened = true;
+			_boardID = DEVICE_ID_CORVID88;
+		}
+		~TCPServerTestCard ()	{_boardOpened = false;}
+		bool AutoCirculate (AUTOCIRCULATE_DATA & autoCircData)
+		{
+			mACCommands.push_back(autoCircData.eCommand);
+			return true;
+		}
+		bool WaitForInterrupt (const INTERRUPT_ENUMS eInterrupt, const ULWord timeOutMs = 68)
+		{
+			(void) timeOutMs;
+			mInterrupts.push_back(eInterrupt);
+			return true;
+		}
+		std::vector<AUTO_CIRC_COMMAND>	mACCommands;
+		std::vector<INTERRUPT_ENUMS>	mInterrupts;
+};	//	TCPServerTestCard
+
+//	Sends one raw request frame to an NTV2TCPServer, bypassing NTV2TCPClient's own argument checks.
+//	Returns true if the server responded, and sets outOK to the response's success flag.
+static bool TCPRawRequest (const UWord inPort, const UWord inOpcode, const NTV2_RPC_BLOB_TYPE & inPayload, bool & outOK)
+{
+	outOK = false;
+	AJATCPSocket sock;
+	if (AJA_FAILURE(sock.Open("127.0.0.1", 0))  ||  AJA_FAILURE(sock.Connect("127.0.0.1", inPort)))
+		return false;
+	NTV2_RPC_BLOB_TYPE frame;	//	Magic, request ID, opcode, flags, payload size, payload
+	ntv2nub::PUSHU32(NTV2_FOURCC('N','T','C','P'), frame);
+	ntv2nub::PUSHU32(1, frame);
+	ntv2nub::PUSHU16(inOpcode, frame);
+	ntv2nub::PUSHU16(0, frame);
+	ntv2nub::PUSHU32(ULWord(inPayload.size()), frame);
+	frame.insert(frame.end(), inPayload.begin(), inPayload.end());
+	if (sock.Write(&frame[0], uint32_t(frame.size())) != uint32_t(frame.size()))
+		return false;
+	UByte header[16];
+	size_t have(0);
+	while (have < sizeof(header))
+	{
+		const uint32_t bytesRead (sock.Read(header + have, uint32_t(sizeof(header) - have)));
+		if (!bytesRead  ||  bytesRead > uint32_t(sizeof(header) - have))
+			return false;
+		have += bytesRead;
+	}
+	outOK = (header[11] & 0x01) != 0;	//	Low byte of the big-endian flags
+	return true;
+}
+
+void tcprpc_marker() {}
+TEST_SUITE("TCPRPC" * doctest::description("Pipelined TCP remote device client & server tests"))
+{
+	TEST_CASE("NTV2TCPServer")
+	{
+		CNTV2Card simDevice;
+		REQUIRE(simDevice.Open("ntv2sim://corvid88"));
+		NTV2ConfigParams config;
+		config.insert(kConnectParamHost, "127.0.0.1");
+		config.insert(kConnectParamPort, "0");
+		NTV2TCPServer server(simDevice, config);
+		REQUIRE(server.Start());
+		REQUIRE(server.GetPort() != 0);
+		const string url ("ntv2tcp://127.0.0.1:" + aja::to_string(server.GetPort()));
+
+		SUBCASE("Register I/O")
+		{
+			CNTV2Card remote;
+			REQUIRE(remote.Open(url));
+			CHECK(remote.IsRemote());
+			CHECK_EQ(remote.GetDeviceID(), simDevice.GetDeviceID());
+			ULWord value(0);
+			CHECK(remote.WriteRegister(kVRegAudioInputDelay, 0x1234));
+			CHECK(simDevice.ReadRegister(kVRegAudioInputDelay, value));
+			CHECK_EQ(value, 0x1234);
+			CHECK(simDevice.WriteRegister(kVRegAudioInputDelay, 0xABCD));
+			CHECK(remote.ReadRegister(kVRegAudioInputDelay, value));
+			CHECK_EQ(value, 0xABCD);
+			CHECK(remote.WriteRegister(kRegFlatMatteValue, 0x1234));
+			CHECK(remote.WriteRegister(kRegFlatMatteValue, 0x5, 0xF0, 4));
+			CHECK(remote.ReadRegister(kRegFlatMatteValue, value, 0xF0, 4));
+			CHECK_EQ(value, 0x5);
+			CHECK(simDevice.ReadRegister(kRegFlatMatteValue, value));
+			CHECK_EQ(value, 0x1254);
+
+			NTV2RegisterWrites writes;
+			writes.push_back(NTV2RegInfo(kVRegAudioInputDelay, 11));
+			writes.push_back(NTV2RegInfo(kVRegAudioOutputDelay, 22));
+			CHECK(remote.WriteRegisters(writes));
+			NTV2RegisterReads reads;
+			reads.push_back(NTV2RegInfo(kVRegAudioInputDelay));
+			reads.push_back(NTV2RegInfo(kVRegAudioOutputDelay));
+			CHECK(remote.ReadRegisters(reads));
+			CHECK_EQ(reads.at(0).registerValue, 11);
+			CHECK_EQ(reads.at(1).registerValue, 22);
+			CHECK(server.GetNumConnections() >= 1);
+		}
+
+		SUBCASE("Batching & Compression")
+		{
+			NTV2ConnectParams params;
+			params.insert(kConnectParamScheme, kLegalSchemeNTV2TCP);
+			params.insert(kConnectParamHost, "127.0.0.1");
+			params.insert(kConnectParamPort, aja::to_string(server.GetPort()));
+			params.insert(kConnectParamQuery, "batch=1&compress=1");
+			NTV2TCPClient * pClient (NTV2TCPClient::Create(params));
+			REQUIRE(pClient);
+			CHECK(pClient->IsWriteBatching());
+			CHECK(pClient->IsCompressing());
+			REQUIRE(pClient->NTV2Connect());
+			CHECK_EQ(pClient->DeviceID(), simDevice.GetDeviceID());
+			pClient->ResetStats();
+
+			//	Ten writes and a read go in one round trip
+			for (ULWord num(0);  num < 10;  num++)
+				CHECK(pClient->NTV2WriteRegisterRemote(kVRegAudioInputDelay, num, 0xFFFFFFFF, 0));
+			CHECK_EQ(pClient->GetStats().requests, 0);
+			ULWord value(0);
+			CHECK(pClient->NTV2ReadRegisterRemote(kVRegAudioInputDelay, value, 0xFFFFFFFF, 0));
+			CHECK_EQ(value, 9);
+			CHECK_EQ(pClient->GetStats().requests, 1);
+			CHECK_EQ(pClient->GetStats().registerOps, 11);
+			CHECK_EQ(pClient->GetStats().batchedWrites, 10);
+			CHECK(pClient->NTV2WriteRegisterRemote(kVRegAudioOutputDelay, 77, 0xFFFFFFFF, 0));
+			CHECK(pClient->Flush());
+			CHECK(simDevice.ReadRegister(kVRegAudioOutputDelay, value));
+			CHECK_EQ(value, 77);
+
+			//	DMA round trip of highly compressible data
+			NTV2Buffer writeBuffer(64 * 1024), readBuffer(64 * 1024);
+			writeBuffer.Fill(ULWord(0xDEADBEEF));
+			writeBuffer.U32(100) = 0x12345678;
+			readBuffer.Fill(ULWord(0));
+			CHECK(pClient->NTV2DMATransferRemote(NTV2_DMA1, false, 3, writeBuffer, 0, 1, 0, 0, true));
+			CHECK(pClient->NTV2DMATransferRemote(NTV2_DMA1, true, 3, readBuffer, 0, 1, 0, 0, true));
+			CHECK(readBuffer.IsContentEqual(writeBuffer));
+			const NTV2TCPStats stats (pClient->GetStats());
+			CHECK_EQ(stats.dmaBytes, 2 * writeBuffer.GetByteCount());
+			CHECK(stats.dmaWireBytes < stats.dmaBytes / 100);
+
+			//	Segmented DMA of incompressible data goes uncompressed
+			NTV2Buffer segBuffer(4 * 1024);
+			for (ULWord ndx(0);  ndx < segBuffer.GetByteCount() / 4;  ndx++)
+				segBuffer.U32(int(ndx)) = ndx * 2654435761UL;
+			NTV2Buffer segment (segBuffer.GetHostPointer(), 512);
+			CHECK(pClient->NTV2DMATransferRemote(NTV2_DMA1, false, 4, segment, 0, 4, 1024, 2048, true));
+			NTV2Buffer check(4 * 2048);
+			CHECK(simDevice.DMAReadFrame(4, reinterpret_cast<ULWord*>(check.GetHostPointer()), check.GetByteCount()));
+			CHECK_EQ(::memcmp(check.GetHostPointer(), segBuffer.GetHostPointer(), 512), 0);
+			CHECK_EQ(::memcmp(check.GetHostAddress(2048), segBuffer.GetHostAddress(1024), 512), 0);
+			CHECK(pClient->NTV2Disconnect());
+			CHECK_FALSE(pClient->IsConnected());
+			delete pClient;
+		}
+
+		SUBCASE("Shared memory")
+		{
+			CNTV2Card remote;
+			REQUIRE(remote.Open(url + "/?shm=16"));
+			NTV2TCPClient * pClient (NTV2TCPClient::FromDevice(remote));
+			REQUIRE(pClient);
+			REQUIRE(pClient->HasSharedMemory());
+			CHECK_EQ(pClient->GetSharedMemorySize(), 16ULL * 1024ULL * 1024ULL);
+			CHECK_FALSE(NTV2TCPClient::FromDevice(simDevice));
+			pClient->ResetStats();
+
+			//	A shared buffer is written in place, then read back through a staging block into a private buffer
+			const NTV2FormatDescriptor fd (NTV2_FORMAT_1080p_5994_A, NTV2_FBF_10BIT_YCBCR);
+			NTV2Buffer shared, video(fd.GetTotalBytes());
+			REQUIRE(pClient->AllocateSharedBuffer(video.GetByteCount(), shared));
+			for (ULWord ndx(0);  ndx < shared.GetByteCount() / 4;  ndx++)
+				shared.U32(int(ndx)) = ndx * 2654435761UL;
+			CHECK(remote.DMAWriteFrame(5, shared, shared.GetByteCount()));
+			CHECK(remote.DMAReadFrame(5, video, video.GetByteCount()));
+			CHECK(video.IsContentEqual(shared));
+			const NTV2TCPStats stats (pClient->GetStats());
+			CHECK_EQ(stats.sharedBytes, 2 * video.GetByteCount());
+			CHECK_EQ(stats.stagedBytes, video.GetByteCount());
+			CHECK_EQ(stats.dmaWireBytes, 0);
+			CHECK(stats.bytesSent + stats.bytesReceived < 64 * 1024);
+
+			//	AUTOCIRCULATE_TRANSFER only works with shared memory
+			CHECK(remote.AutoCirculateInitForOutput(NTV2_CHANNEL1, 0, NTV2_AUDIOSYSTEM_INVALID, 0, 1, 0, 3));
+			AUTOCIRCULATE_TRANSFER xfer;
+			xfer.SetVideoBuffer(shared, shared.GetByteCount());
+			CHECK(remote.AutoCirculateTransfer(NTV2_CHANNEL1, xfer));
+			CHECK_EQ(xfer.GetTransferFrameNumber(), 0);
+			NTV2Buffer frame(video.GetByteCount());
+			CHECK(simDevice.DMAReadFrame(0, frame, frame.GetByteCount()));
+			CHECK(frame.IsContentEqual(shared));
+			CHECK(remote.AutoCirculateStop(NTV2_CHANNEL1));
+
+			CHECK(pClient->FreeSharedBuffer(shared));
+			CHECK(shared.IsNULL());
+			CHECK_FALSE(pClient->FreeSharedBuffer(video));
+			NTV2Buffer tooBig;
+			CHECK_FALSE(pClient->AllocateSharedBuffer(17 * 1024 * 1024, tooBig));
+		}
+
+		SUBCASE("Concurrent interrupt waits")
+		{
+			CNTV2Card remote;
+			REQUIRE(remote.Open(url));
+			CHECK(remote.WaitForInterrupt(eOutput1, 200));
+			NTV2InterruptWaitSet waitSet;
+			waitSet.Add(eOutput1).Add(eInput2);
+			CHECK(remote.WaitForAnyInterrupt(waitSet, 200));
+			CHECK(waitSet.GetFiredMask());
+
+			//	Register reads complete while another thread waits
+			AJAThread waiter;
+			struct Waiter	{static void Run (AJAThread *, void * pCtx)	{reinterpret_cast<CNTV2Card*>(pCtx)->WaitForInterrupt(eInput8, 500);}};
+			waiter.Attach(Waiter::Run, &remote);
+			REQUIRE(AJA_SUCCESS(waiter.Start()));
+			AJATime::Sleep(20);
+			const uint64_t startMS (AJATime::GetSystemMilliseconds());
+			ULWord value(0);
+			for (int num(0);  num < 20;  num++)
+				CHECK(remote.ReadRegister(kRegBoardID, value));
+			CHECK(AJATime::GetSystemMilliseconds() - startMS < 400);
+			while (waiter.Active())
+				AJATime::Sleep(5);
+		}
+		server.Stop();
+		CHECK_FALSE(server.IsRunning());
+	}	//	TEST_CASE("NTV2TCPServer")
+
+	TEST_CASE("Listen Address")
+	{
+		CNTV2Card simDevice;
+		REQUIRE(simDevice.Open("ntv2sim://corvid88"));
+		NTV2ConfigParams config;
+		config.insert(kConnectParamPort, "0");
+		NTV2TCPServer server(simDevice, config);		//	No host:  loopback only
+		REQUIRE(server.Start());
+		CNTV2Card remote;
+		CHECK(remote.Open("ntv2tcp://127.0.0.1:" + aja::to_string(server.GetPort())));
+		remote.Close();
+		server.Stop();
+
+		config.insert(kConnectParamHost, "not.an.address");
+		NTV2TCPServer badServer(simDevice, config);
+		CHECK_FALSE(badServer.Start());
+	}	//	TEST_CASE("Listen Address")
+
+	TEST_CASE("Request Validation")
+	{
+		TCPServerTestCard device;
+		NTV2ConfigParams config;
+		config.insert(kConnectParamPort, "0");
+		NTV2TCPServer server(device, config);
+		REQUIRE(server.Start());
+		const UWord port (UWord(server.GetPort()));
+		const UWord kOpAutoCirculate(3), kOpWaitInterrupt(5);
+		bool ok(false);
+
+		//	AutoCirculate commands that need pointers must never reach the device...
+		const AUTO_CIRC_COMMAND cmds[] = {eStartAutoCirc, eGetFrameStamp, eTransferAutoCirculate, eTransferAutoCirculateEx,
+											eTransferAutoCirculateEx2, eGetFrameStampEx2, eSetCaptureTask, AUTO_CIRC_COMMAND(999)};
+		for (size_t ndx(0);  ndx < sizeof(cmds) / sizeof(AUTO_CIRC_COMMAND);  ndx++)
+		{
+			NTV2_RPC_BLOB_TYPE payload;
+			ntv2nub::PUSHU16(UWord(cmds[ndx]), payload);
+			ntv2nub::PUSHU16(UWord(NTV2CROSSPOINT_CHANNEL1), payload);
+			for (size_t num(0);  num < 6;  num++)
+				ntv2nub::PUSHU32(0, payload);
+			payload.insert(payload.end(), 8, 0);
+			REQUIRE(TCPRawRequest(port, kOpAutoCirculate, payload, ok));
+			CHECK_EQ(ok, cmds[ndx] == eStartAutoCirc);
+		}
+		REQUIRE_EQ(device.mACCommands.size(), 1);
+		CHECK_EQ(device.mACCommands.front(), eStartAutoCirc);
+
+		//	...nor may out-of-range interrupts
+		const ULWord intrs[] = {ULWord(eOutput1), ULWord(eNumInterruptTypes), 0xFFFFFFFF};
+		for (size_t ndx(0);  ndx < sizeof(intrs) / sizeof(ULWord);  ndx++)
+		{
+			NTV2_RPC_BLOB_TYPE payload;
+			ntv2nub::PUSHU32(intrs[ndx], payload);
+			ntv2nub::PUSHU32(10, payload);
+			REQUIRE(TCPRawRequest(port, kOpWaitInterrupt, payload, ok));
+			CHECK_EQ(ok, intrs[ndx] == ULWord(eOutput1));
+		}
+		REQUIRE_EQ(device.mInterrupts.size(), 1);
+		CHECK_EQ(device.mInterrupts.front(), eOutput1);
+		server.Stop();
+	}	//	TEST_CASE("Request Validation")
+}	//	TEST_SUITE("TCPRPC")
+
+
+class GetRegsTestCard : public CNTV2Card	//	Records the size of each NTV2GetRegisters message, then fails it
+{
+	public:
+		GetRegsTestCard ()
+			:	mNumMessages(0), mNumOversized(0), mNumReads(0)
+		{
+			_boardOpened = true;
+		}
+		~GetRegsTestCard ()	{_boardOpened = false;}
+		bool ReadRegister (const ULWord inRegNum, ULWord & outValue, const ULWord inMask = 0xFFFFFFFF, const ULWord inShift = 0)
+		{
+			(void) inMask;	(void) inShift;
+			mNumReads++;
+			outValue = inRegNum * 3;
+			return true;
+		}
+		bool NTV2Message (NTV2_HEADER * pInMessage)
+		{
+			if (!pInMessage  ||  pInMessage->GetType() != NTV2_TYPE_GETREGS)
+				return false;
+			NTV2RegNumSet regNums;
+			if (!reinterpret_cast<NTV2GetRegisters*>(pInMessage)->GetRequestedRegisterNumbers(regNums))
+				return false;
+			mNumMessages++;
+			if (regNums.size() * sizeof(ULWord) > 4096)
+				mNumOversized++;	//	The Linux driver would fail it with -ENOMEM
+			return false;			//	Like a driver without GETREGS:  the caller falls back to ReadRegister
+		}
+		ULWord	mNumMessages, mNumOversized, mNumReads;
+};	//	GetRegsTestCard
+
+void devicebroker_marker() {}
+TEST_SUITE("DeviceBroker" * doctest::description("Shared device session broker tests"))
+{
+	TEST_CASE("NTV2DeviceBroker")
+	{
+		CNTV2Card simDevice;
+		REQUIRE(simDevice.Open("ntv2sim://corvid88"));
+		const string name ("ut-" + aja::to_string(AJAProcess::GetPid()));
+		NTV2ConfigParams config;
+		CHECK_FALSE(NTV2DeviceBroker(simDevice, config).Start());		//	No name
+		config.insert(kNTV2BrokerParamName, name);
+		NTV2DeviceBroker broker(simDevice, config);
+		REQUIRE(broker.Start());
+		CHECK(broker.IsRunning());
+		CHECK(broker.GetSnapshotCount() > 0);
+		{
+			NTV2DeviceBroker duplicate(simDevice, config);
+			CHECK_FALSE(duplicate.Start());		//	Already listening
+		}
+		CNTV2Card notThere;
+		CHECK_FALSE(notThere.Open("ntv2broker://ut-no-such-broker"));
+
+		SUBCASE("Register snapshot")
+		{
+			CNTV2Card client;
+			REQUIRE(client.Open("ntv2broker://" + name));
+			CHECK_EQ(client.GetDeviceID(), simDevice.GetDeviceID());
+			NTV2BrokerClient * pBroker (NTV2BrokerClient::FromDevice(client));
+			REQUIRE(pBroker);
+			CHECK_FALSE(NTV2BrokerClient::FromDevice(simDevice));
+			CHECK(pBroker->HasSnapshot());
+			CHECK(pBroker->GetSnapshotRegCount() > ULWord(kRegFlatMatteValue));
+			CHECK(pBroker->HasSharedMemory());	//	By default
+
+			//	Reads come from shared memory -- no round trips
+			pBroker->ResetStats();
+			ULWord value(0);
+			for (int num(0);  num < 100;  num++)
+				CHECK(client.ReadRegister(kRegBoardID, value));
+			CHECK_EQ(NTV2DeviceID(value), simDevice.GetDeviceID());
+			CHECK_EQ(pBroker->GetStats().requests, 0);
+			CHECK_EQ(pBroker->GetStats().localReads, 100);
+			NTV2RegisterReads reads;
+			reads.push_back(NTV2RegInfo(kRegBoardID));
+			reads.push_back(NTV2RegInfo(kVRegAudioInputDelay));		//	Not in the snapshot
+			CHECK(client.ReadRegisters(reads));
+			CHECK_EQ(reads.at(0).registerValue, ULWord(simDevice.GetDeviceID()));
+			CHECK_EQ(pBroker->GetStats().requests, 1);
+
+			//	My own writes read back right away
+			CHECK(client.WriteRegister(kRegFlatMatteValue, 0x11223344));
+			CHECK(client.ReadRegister(kRegFlatMatteValue, value));
+			CHECK_EQ(value, 0x11223344);
+			CHECK(client.ReadRegister(kRegFlatMatteValue, value, 0xFF00, 8));
+			CHECK_EQ(value, 0x33);
+
+			//	Others' writes show up after the next refresh
+			CHECK(simDevice.WriteRegister(kRegFlatMatteValue, 0x55667788));
+			const ULWord64 count (pBroker->GetSnapshotCount());
+			for (int tries(0);  tries < 100  &&  pBroker->GetSnapshotCount() < count + 2;  tries++)
+				AJATime::Sleep(5);
+			CHECK(pBroker->GetSnapshotCount() >= count + 2);
+			CHECK(pBroker->ReadSnapshot(kRegFlatMatteValue, value));
+			CHECK_EQ(value, 0x55667788);
+			pBroker->ResetStats();
+			CHECK(client.ReadRegister(kRegFlatMatteValue, value));
+			CHECK_EQ(value, 0x55667788);
+			CHECK_EQ(pBroker->GetStats().requests, 0);
+			CHECK(pBroker->GetSnapshotTime() > 0);
+			CHECK_FALSE(pBroker->ReadSnapshot(kRegXenaxFlashDOUT, value));
+
+			//	Volatile registers, and those with read side-effects, always come from the device
+			CHECK_FALSE(pBroker->ReadSnapshot(kRegRS422Receive, value));
+			CHECK_FALSE(pBroker->ReadSnapshot(kRegRS4222Receive, value));
+			CHECK_FALSE(pBroker->ReadSnapshot(kRegStatus, value));
+			CHECK_FALSE(pBroker->ReadSnapshot(kRegCh1OutputFrame, value));
+			pBroker->ResetStats();
+			CHECK(client.ReadRegister(kRegStatus, value));
+			CHECK_EQ(pBroker->GetStats().requests, 1);
+			CHECK_EQ(pBroker->GetStats().localReads, 0);
+		}
+
+		SUBCASE("Channel reservations")
+		{
+			CNTV2Card clientA, clientB;
+			REQUIRE(clientA.Open("ntv2broker://" + name));
+			REQUIRE(clientB.Open("ntv2broker://" + name));
+			NTV2BrokerClient * pA (NTV2BrokerClient::FromDevice(clientA));
+			NTV2BrokerClient * pB (NTV2BrokerClient::FromDevice(clientB));
+			REQUIRE(pA);
+			REQUIRE(pB);
+			CHECK(pA->ReserveChannel(NTV2_CHANNEL1, "capture", 0, NTV2_FOURCC('C','a','p','t')));
+			CHECK(pA->ReserveChannel(NTV2_CHANNEL1, "capture"));		//	Already mine
+			CHECK_FALSE(pB->ReserveChannel(NTV2_CHANNEL1, "monitor"));
+			CHECK(pB->ReserveChannel(NTV2_CHANNEL2, "monitor"));
+			CHECK_FALSE(pB->ReleaseChannel(NTV2_CHANNEL1));			//	Not mine
+			NTV2BrokerReservations reservations;
+			CHECK(pB->GetReservations(reservations));
+			REQUIRE_EQ(reservations.size(), 2);
+			CHECK_EQ(reservations.at(0).channel, NTV2_CHANNEL1);
+			CHECK_EQ(reservations.at(0).owner, "capture");
+			CHECK_EQ(reservations.at(0).appType, NTV2_FOURCC('C','a','p','t'));
+			CHECK_EQ(reservations.at(0).processID, AJAProcess::GetPid());
+			CHECK_EQ(reservations.at(1).owner, "monitor");
+
+			//	Waiting for a release
+			const uint64_t startMS (AJATime::GetSystemMilliseconds());
+			CHECK_FALSE(pB->ReserveChannel(NTV2_CHANNEL1, "monitor", 50));
+			CHECK(AJATime::GetSystemMilliseconds() - startMS >= 40);
+			CHECK(pA->ReleaseChannel(NTV2_CHANNEL1));
+			CHECK(pB->ReserveChannel(NTV2_CHANNEL1, "monitor", 50));
+
+			//	Disconnecting releases everything
+			CHECK(clientB.Close());
+			for (int tries(0);  tries < 100  &&  !broker.GetReservations().empty();  tries++)
+				AJATime::Sleep(5);
+			CHECK(broker.GetReservations().empty());
+			CHECK(pA->ReserveChannel(NTV2_CHANNEL1, "capture"));
+		}
+		broker.Stop();
+		CHECK_FALSE(broker.IsRunning());
+		CNTV2Card afterStop;
+		CHECK_FALSE(afterStop.Open("ntv2broker://" + name));
+	}	//	TEST_CASE("NTV2DeviceBroker")
+
+	TEST_CASE("Chunked Reads")
+	{	//	A broker snapshot reads more registers than one NTV2GetRegisters message can carry
+		GetRegsTestCard card;
+		NTV2RegisterReads reads;
+		for (ULWord regNum(0);  regNum < 3000;  regNum++)
+			reads.push_back(NTV2RegInfo(regNum));
+		CHECK(card.ReadRegisters(reads));
+		CHECK_EQ(card.mNumMessages, 3);
+		CHECK_EQ(card.mNumOversized, 0);
+		CHECK_EQ(card.mNumReads, 2999);		//	All but kRegXenaxFlashDOUT
+		REQUIRE_EQ(reads.size(), 3000);
+		CHECK_EQ(reads.at(0).registerValue, 0);
+		CHECK_EQ(reads.at(1500).registerValue, 4500);
+		CHECK_EQ(reads.at(2999).registerValue, 8997);
+	}	//	TEST_CASE("Chunked Reads")
+}	//	TEST_SUITE("DeviceBroker")
+
+
+void drivertrace_marker() {}
+TEST_SUITE("DriverTrace" * doctest::description("NTV2DriverTrace tests"))
+{
+	TEST_CASE("NTV2DriverTrace")
+	{
+		NTV2DriverTrace trace(100);
+		CHECK_EQ(trace.GetCapacity(), 128);		//	Rounded up to power of 2
+		CHECK_EQ(trace.GetNumThreads(), 0);
+		NTV2DriverTraceRecords records;
+		CHECK(trace.GetRecords(records));
+		CHECK(records.empty());
+		for (ULWord n(0);  n < 200;  n++)
+		{
+			NTV2DriverTraceRecord rec (NTV2_TRACE_READ_REGISTER, n, 0xFFFFFFFF, n * 2);
+			rec.fStart = 1000 + n * 100;
+			rec.fDuration = n + 1;
+			rec.fSuccess = n % 10 != 0;
+			trace.Record(rec);
+		}
+		CHECK_EQ(trace.GetNumThreads(), 1);
+		CHECK(trace.GetRecords(records));
+		REQUIRE_EQ(records.size(), 128);			//	Oldest records overwritten
+		CHECK_EQ(records.front().fArgs[0], 72);
+		CHECK_EQ(records.back().fArgs[0], 199);
+		CHECK_EQ(records.back().fArgs[2], 398);
+		CHECK(records.front().fStart < records.back().fStart);
+		NTV2DriverTraceStats stats;
+		CHECK(trace.GetStats(NTV2_TRACE_READ_REGISTER, stats));
+		CHECK_EQ(stats.fCount, 128);
+		CHECK_EQ(stats.fMax, 200);
+		CHECK_EQ(stats.fP50, 136);
+		CHECK_EQ(stats.fP99, 199);
+		CHECK_EQ(stats.fNumFailures, 12);
+		CHECK(trace.GetStats(NTV2_TRACE_DMA_READ, stats));
+		CHECK_EQ(stats.fCount, 0);
+		CHECK_FALSE(trace.GetStats(NTV2_TRACE_NUM_OPS, stats));
+
+		//	Each thread gets its own track
+		struct Recorder	{static void Run (AJAThread *, void * pCtx)
+						{
+							NTV2DriverTrace & trc (*reinterpret_cast<NTV2DriverTrace*>(pCtx));
+							for (ULWord n(0);  n < 50;  n++)
+								{NTV2DriverTraceScope scope (&trc, NTV2_TRACE_WRITE_REGISTER, n);  scope.Done(true);}
+						}};
+		AJAThread threads[3];
+		for (size_t ndx(0);  ndx < 3;  ndx++)
+		{
+			threads[ndx].Attach(Recorder::Run, &trace);
+			CHECK(AJA_SUCCESS(threads[ndx].Start()));
+		}
+		for (size_t ndx(0);  ndx < 3;  ndx++)
+			threads[ndx].Stop();
+		CHECK_EQ(trace.GetNumThreads(), 4);
+		CHECK(trace.GetStats(NTV2_TRACE_WRITE_REGISTER, stats));
+		CHECK_EQ(stats.fCount, 150);
+		CHECK_EQ(stats.fNumFailures, 0);
+
+		std::ostringstream json;
+		CHECK(trace.WriteChromeTrace(json));
+		CHECK(json.str().find("\"traceEvents\"") != string::npos);
+		CHECK(json.str().find("\"thread_name\"") != string::npos);
+		CHECK(json.str().find("WriteRegister") != string::npos);
+		trace.Reset();
+		CHECK(trace.GetRecords(records));
+		CHECK(records.empty());
+		for (ULWord n(0);  n < 3;  n++)
+			trace.Record(NTV2DriverTraceRecord(NTV2_TRACE_DMA_READ, n));
+		CHECK(trace.GetRecords(records));
+		REQUIRE_EQ(records.size(), 3);			//	Only what was recorded since the Reset
+		CHECK_EQ(records.front().fArgs[0], 0);
+		CHECK_EQ(records.back().fArgs[0], 2);
+	}	//	TEST_CASE("NTV2DriverTrace")
+
+	TEST_CASE("SetDriverTraceEnable")
+	{
+		CNTV2Card card;
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		CHECK(card.GetDriverTrace() == AJA_NULL);
+		CHECK(card.SetDriverTraceEnable(true, 256));
+		NTV2DriverTrace * pTrace (card.GetDriverTrace());
+		REQUIRE(pTrace);
+		CHECK_EQ(pTrace->GetCapacity(), 256);
+		CHECK(card.SetDriverTraceEnable(true, 64));		//	Already big enough
+		CHECK_EQ(card.GetDriverTrace(), pTrace);
+
+		CHECK(card.WriteRegister(kRegFlatMatteValue, 0x12345678));
+		ULWord value (0);
+		CHECK(card.ReadRegister(kRegFlatMatteValue, value));
+		CHECK_EQ(value, 0x12345678);
+		CHECK(card.WaitForInterrupt(eOutput1, 100));
+
+		NTV2DriverTraceRecords records;
+		CHECK(pTrace->GetRecords(records));
+		bool foundRead(false), foundWrite(false), foundWait(false);
+		for (size_t ndx(0);  ndx < records.size();  ndx++)
+		{
+			const NTV2DriverTraceRecord & rec (records.at(ndx));
+			CHECK(NTV2_IS_VALID_TRACE_OP(rec.fOp));
+			CHECK(rec.fStart > 0);
+			if (rec.fOp == NTV2_TRACE_WRITE_REGISTER  &&  rec.fArgs[0] == kRegFlatMatteValue)
+				{foundWrite = true;  CHECK_EQ(rec.fArgs[2], 0x12345678);  CHECK(rec.fSuccess);}
+			if (rec.fOp == NTV2_TRACE_READ_REGISTER  &&  rec.fArgs[0] == kRegFlatMatteValue)
+				{foundRead = true;  CHECK_EQ(rec.fArgs[2], 0x12345678);  CHECK(rec.fSuccess);}
+			if (rec.fOp == NTV2_TRACE_WAIT_INTERRUPT)
+				{foundWait = true;  CHECK_EQ(rec.fArgs[0], eOutput1);  CHECK_EQ(rec.fArgs[1], 100);  CHECK(rec.fSuccess);}
+		}
+		CHECK(foundWrite);
+		CHECK(foundRead);
+		CHECK(foundWait);
+		NTV2DriverTraceStats stats;
+		CHECK(pTrace->GetStats(NTV2_TRACE_WAIT_INTERRUPT, stats));
+		CHECK(stats.fCount >= 1);
+		CHECK(stats.fMax >= stats.fP50);
+		std::ostringstream oss;
+		pTrace->Print(oss);
+		CHECK(oss.str().find("WaitForInterrupt") != string::npos);
+
+		CHECK(card.SetDriverTraceEnable(false));
+		CHECK(card.GetDriverTrace() == AJA_NULL);
+		CHECK(card.ReadRegister(kRegFlatMatteValue, value));	//	Still works untraced
+		CHECK(pTrace->GetRecords(records));						//	Retired, not deleted
+
+		CHECK(card.SetDriverTraceEnable(true, 128));			//	Reuses the retired trace, emptied
+		CHECK_EQ(card.GetDriverTrace(), pTrace);
+		CHECK(pTrace->GetRecords(records));
+		CHECK(records.empty());
+		CHECK(card.SetDriverTraceEnable(true, 1024));			//	Replaces it with a bigger one
+		REQUIRE(card.GetDriverTrace());
+		CHECK(card.GetDriverTrace() != pTrace);
+		CHECK_EQ(card.GetDriverTrace()->GetCapacity(), 1024);
+		CHECK(pTrace->GetRecords(records));						//	Retired, not deleted
+	}	//	TEST_CASE("SetDriverTraceEnable")
+
+	TEST_CASE("Concurrent SetDriverTraceEnable")
+	{	//	Threads that enable, resize and disable the trace while reading registers
+		CNTV2Card card;
+		REQUIRE(card.Open("ntv2sim://corvid88"));
+		struct Toggler	{static void Run (AJAThread *, void * pCtx)
+						{
+							CNTV2Card & crd (*reinterpret_cast<CNTV2Card*>(pCtx));
+							ULWord value(0);
+							for (ULWord n(0);  n < 200;  n++)
+							{
+								crd.SetDriverTraceEnable(n % 3 != 2, 64 << (n % 3));
+								crd.ReadRegister(kRegFlatMatteValue, value);
+							}
+						}};
+		AJAThread threads[4];
+		for (size_t ndx(0);  ndx < 4;  ndx++)
+		{
+			threads[ndx].Attach(Toggler::Run, &card);
+			CHECK(AJA_SUCCESS(threads[ndx].Start()));
+		}
+		for (size_t ndx(0);  ndx < 4;  ndx++)
+			threads[ndx].Stop();
+		CHECK(card.SetDriverTraceEnable(true, 64));
+		REQUIRE(card.GetDriverTrace());
+		ULWord value(0);
+		CHECK(card.ReadRegister(kRegFlatMatteValue, value));
+		NTV2DriverTraceRecords records;
+		CHECK(card.GetDriverTrace()->GetRecords(records));
+	}	//	TEST_CASE("Concurrent SetDriverTraceEnable")
+}	//	TEST_SUITE("DriverTrace")
+
+
+void deviceprofile_marker() {}
+TEST_SUITE("DeviceProfile" * doctest::description("NTV2DeviceProfile export & cache tests"))
+{
+	TEST_CASE("NTV2DeviceProfile")
+	{
+		NTV2DeviceProfile profile;
+		NTV2_RPC_BLOB_TYPE blob;
+		CHECK(profile.IsEmpty());
+		CHECK_FALSE(profile.Encode(blob));
+		CHECK_FALSE(profile.SetFromDeviceID(DEVICE_ID_NOTFOUND));
+		REQUIRE(profile.SetFromDeviceID(DEVICE_ID_CORVID88));
+		CHECK_EQ(profile.GetDeviceID(), DEVICE_ID_CORVID88);
+		CHECK_EQ(profile.GetFirmwareVersion(), 0);
+		CHECK_EQ(profile.GetNumSupported(kDeviceGetNumVideoChannels), ::NTV2DeviceGetNumVideoChannels(DEVICE_ID_CORVID88));
+		CHECK_EQ(profile.IsSupported(kDeviceCanDoPlayback), ::NTV2DeviceCanDoPlayback(DEVICE_ID_CORVID88));
+		NTV2PixelFormats pfs;  ::NTV2DeviceGetSupportedPixelFormats(DEVICE_ID_CORVID88, pfs);
+		CHECK_EQ(profile.GetSupportedItems(kNTV2EnumsID_PixelFormat).size(), pfs.size());
+		ULWord value(0);
+		CHECK_FALSE(profile.GetBoolParam(kDeviceCanDoAudioMixer, value));		//	Register-based:  no device to read
+		CHECK_FALSE(profile.GetBoolParam(kDeviceHasBreakoutBoard, value));		//	Never included
+		CHECK_EQ(profile.GetRegisterName(kRegGlobalControl), CNTV2RegisterExpert::GetDisplayName(kRegGlobalControl));
+		CHECK(profile.GetRouteROM().empty());
+		NTV2PossibleConnections connections;
+		CHECK_FALSE(profile.GetPossibleConnections(connections));
+
+		//	Encode & decode...
+		REQUIRE(profile.Encode(blob));
+		NTV2DeviceProfile decoded;
+		REQUIRE(decoded.Decode(blob));
+		CHECK(decoded == profile);
+		blob.resize(blob.size() - 1);
+		CHECK_FALSE(decoded.Decode(blob));
+		CHECK(decoded.IsEmpty());
+
+		//	Files...
+		string tmpDir;
+		REQUIRE(AJA_SUCCESS(AJAFileIO::TempDirectory(tmpDir)));
+		const string path (tmpDir + "/ut-profile-" + aja::to_string(AJAProcess::GetPid()) + ".bin");
+		REQUIRE(profile.WriteToFile(path));
+		CHECK(decoded.ReadFromFile(path));
+		CHECK(decoded == profile);
+		AJAFileIO::Delete(path);
+		CHECK_FALSE(decoded.ReadFromFile(path));
+		std::ostringstream oss;
+		oss << profile;
+		CHECK(oss.str().find("bools=") != string::npos);
+	}	//	TEST_CASE("NTV2DeviceProfile")
+
+	TEST_CASE("Profile Cache")
+	{
+		string tmpDir;
+		REQUIRE(AJA_SUCCESS(AJAFileIO::TempDirectory(tmpDir)));
+		CHECK(NTV2DeviceProfile::GetCacheFolder().empty());		//	Caching is opt-in
+		NTV2DeviceProfile::SetCacheFolder(tmpDir);
+		CNTV2Card simDevice;
+		REQUIRE(simDevice.Open("ntv2sim://corvid88"));
+		NTV2DeviceProfile live, other;
+		REQUIRE(live.SetFromDevice(simDevice));
+		ULWord value(0);
+		CHECK(live.GetBoolParam(kDeviceCanDoAudioMixer, value));	//	Register-based features come from the device
+		CHECK_FALSE(live.SaveToCache());							//	No firmware version
+		REQUIRE(other.SetFromDeviceID(DEVICE_ID_KONA5));
+		CHECK_FALSE(simDevice.ApplyDeviceProfile(other));			//	Wrong device
+
+		//	Give the simulated device a firmware version...
+		CHECK(simDevice.WriteRegister(kRegBitfileDate, 0x20241018));
+		CHECK(simDevice.WriteRegister(kRegBitfileTime, 0x00123456));
+		ULWord64 fwVersion(0);
+		REQUIRE(NTV2DeviceProfile::ReadFirmwareVersion(simDevice, fwVersion));
+		CHECK_EQ(fwVersion >> 32, 0x20241018);
+		CHECK_EQ((fwVersion >> 8) & 0xFFFFFF, 0x123456);
+		const string cachePath (NTV2DeviceProfile::GetCacheFilePath(DEVICE_ID_CORVID88, fwVersion));
+		REQUIRE_FALSE(cachePath.empty());
+		AJAFileIO::Delete(cachePath);
+
+		NTV2ConfigParams config;
+		config.insert(kConnectParamHost, "127.0.0.1");
+		config.insert(kConnectParamPort, "0");
+		NTV2TCPServer server(simDevice, config);
+		REQUIRE(server.Start());
+		const string url ("ntv2tcp://127.0.0.1:" + aja::to_string(server.GetPort()));
+		NTV2PixelFormats pfs;  ::NTV2DeviceGetSupportedPixelFormats(DEVICE_ID_CORVID88, pfs);
+		{	//	First open fetches the profile in one request, and caches it...
+			CNTV2Card remote;
+			REQUIRE(remote.Open(url));
+			CHECK(AJAFileIO::FileExists(cachePath));
+			NTV2TCPClient * pClient (NTV2TCPClient::FromDevice(remote));
+			REQUIRE(pClient);
+			pClient->ResetStats();
+			CHECK_EQ(remote.GetNumSupported(kDeviceGetNumVideoChannels), ::NTV2DeviceGetNumVideoChannels(DEVICE_ID_CORVID88));
+			CHECK_EQ(remote.IsSupported(kDeviceCanDoAudioMixer), bool(value));
+			CHECK_EQ(remote.GetSupportedItems(kNTV2EnumsID_PixelFormat).size(), pfs.size());
+			CHECK_EQ(pClient->GetStats().requests, 0);
+		}
+		NTV2DeviceProfile cached;
+		REQUIRE(cached.LoadFromCache(DEVICE_ID_CORVID88, fwVersion));
+		CHECK_EQ(cached.GetFirmwareVersion(), fwVersion);
+		CHECK_FALSE(cached.GetRegisterNames().empty());
+		CHECK_FALSE(cached.LoadFromCache(DEVICE_ID_CORVID88, fwVersion + 1));
+
+		//	Later opens use the cached profile instead of asking the server...
+		REQUIRE(cached.LoadFromCache(DEVICE_ID_CORVID88, fwVersion));
+		cached.SetNumericParam(kDeviceGetNumVideoChannels, 3);
+		REQUIRE(cached.SaveToCache());
+		{
+			CNTV2Card remote;
+			REQUIRE(remote.Open(url));
+			CHECK_EQ(remote.GetNumSupported(kDeviceGetNumVideoChannels), 3);
+		}
+		AJAFileIO::Delete(cachePath);
+		NTV2DeviceProfile::SetCacheFolder("");
+		CHECK(NTV2DeviceProfile::GetCacheFilePath(DEVICE_ID_CORVID88, fwVersion).empty());
+		CHECK_FALSE(cached.SaveToCache());
+	}	//	TEST_CASE("Profile Cache")
+}	//	TEST_SUITE("DeviceProfile")
+
+
+void devicescanner_marker() {}
+TEST_SUITE("DeviceScanner" * doctest::description("Parallel device scan & discovery cache tests"))
+{
+	TEST_CASE("Discovery Cache")
+	{
+		const bool wasEnabled (CNTV2DriverInterface::GetDiscoveryCache());
+		CNTV2DriverInterface::ClearDiscoveryCache();
+		CNTV2DriverInterface::SetDiscoveryCache(true);
+		CHECK(CNTV2DriverInterface::GetDiscoveryCache());
+
+		DevCapsTestCard first;
+		first.mRegs[kRegGlobalControl2] = kRegMaskAudioMixerPresent;
+		first.mRegs[kRegReserved54] = 0x12345678;	//	Serial number
+		first.mRegs[kRegReserved55] = 0x0BADF00D;
+		first.mRegs[kRegBitfileDate] = 0x20240418;	//	Firmware version
+		first.mRegs[kRegBitfileTime] = 0x00123456;
+		first.mRegs[kRegDMAControl] = 0x00001500;
+		first.FakeOpen();
+		CHECK(first.RefreshDeviceCapabilities());
+		CHECK(first.IsSupported(kDeviceCanDoAudioMixer));
+
+		//	Same serial number & firmware:  discoveries reused...
+		DevCapsTestCard second;
+		second.mRegs = first.mRegs;
+		second.mRegs[kRegGlobalControl2] = 0;
+		second.FakeOpen();
+		CHECK(second.RefreshDeviceCapabilities());
+		const ULWord numReads (second.mNumReads);
+		CHECK(numReads < 4);	//	One kRegBoardID read, plus one batch
+		CHECK(second.IsSupported(kDeviceCanDoAudioMixer));
+		CHECK_EQ(second.GetNumSupported(kDeviceGetNumVideoChannels), first.GetNumSupported(kDeviceGetNumVideoChannels));
+		CHECK_EQ(second.GetSupportedItems(kNTV2EnumsID_PixelFormat), first.GetSupportedItems(kNTV2EnumsID_PixelFormat));
+		CHECK_EQ(second.mNumReads, numReads);
+
+		//	New firmware:  rediscovered...
+		DevCapsTestCard third;
+		third.mRegs = second.mRegs;
+		third.mRegs[kRegBitfileTime] = 0x00123457;
+		third.FakeOpen();
+		CHECK(third.RefreshDeviceCapabilities());
+		CHECK_FALSE(third.IsSupported(kDeviceCanDoAudioMixer));
+
+		//	No serial number:  never reused...
+		DevCapsTestCard fourth;
+		fourth.mRegs = first.mRegs;
+		fourth.mRegs[kRegReserved54] = fourth.mRegs[kRegReserved55] = 0;
+		fourth.FakeOpen();
+		CHECK(fourth.RefreshDeviceCapabilities());
+		DevCapsTestCard fifth;
+		fifth.mRegs = fourth.mRegs;
+		fifth.mRegs[kRegGlobalControl2] = 0;
+		fifth.FakeOpen();
+		CHECK(fifth.RefreshDeviceCapabilities());
+		CHECK_FALSE(fifth.IsSupported(kDeviceCanDoAudioMixer));
+
+		//	Disabled:  always rediscovered...
+		CNTV2DriverInterface::SetDiscoveryCache(false);
+		CHECK_FALSE(CNTV2DriverInterface::GetDiscoveryCache());
+		DevCapsTestCard sixth;
+		sixth.mRegs = second.mRegs;
+		sixth.FakeOpen();
+		CHECK(sixth.RefreshDeviceCapabilities());
+		CHECK_FALSE(sixth.IsSupported(kDeviceCanDoAudioMixer));
+
+		CNTV2DriverInterface::ClearDiscoveryCache();
+		CNTV2DriverInterface::SetDiscoveryCache(wasEnabled);
+	}	//	TEST_CASE("Discovery Cache")
+
+	TEST_CASE("Scan Modes")
+	{
+		const bool wasCaching (CNTV2DriverInterface::GetDiscoveryCache());
+		CNTV2DeviceScanner::ScanHardware();
+		const size_t numDevices (CNTV2DeviceScanner::GetNumDevices());
+
+		//	Parallel scan finds the same devices...
+		CNTV2DeviceScanner::SetParallelScan(true);
+		CHECK(CNTV2DeviceScanner::IsParallelScan());
+		CHECK(CNTV2DriverInterface::GetDiscoveryCache());
+		CNTV2DeviceScanner::ScanHardware();
+		CHECK_EQ(CNTV2DeviceScanner::GetNumDevices(), numDevices);
+		CNTV2DeviceScanner::ScanHardware();	//	Again, reusing discoveries
+		CHECK_EQ(CNTV2DeviceScanner::GetNumDevices(), numDevices);
+		for (ULWord ndx(0);  ndx < ULWord(numDevices);  ndx++)
+		{	NTV2DeviceInfo info;
+			CHECK(CNTV2DeviceScanner::GetDeviceInfo(ndx, info));
+			CHECK_EQ(info.deviceIndex, ndx);
+		}
+
+		//	Hotplug refresh...
+		CHECK_FALSE(CNTV2DeviceScanner::GetHotplugRefresh());
+		CNTV2DeviceScanner::SetHotplugRefresh(true);
+		CHECK(CNTV2DeviceScanner::GetHotplugRefresh());
+		CNTV2DeviceScanner::HotplugCallback(AJA_Pnp_DeviceAdded, AJA_NULL);
+		CHECK_EQ(CNTV2DeviceScanner::GetNumDevices(), numDevices);
+		CNTV2DeviceScanner::HotplugCallback(AJA_Pnp_DeviceGoingToSleep, AJA_NULL);
+		CHECK_EQ(CNTV2DeviceScanner::GetNumDevices(), numDevices);
+		CNTV2Card card;
+		CHECK_EQ(CNTV2DeviceScanner::GetDeviceAtIndex(ULWord(numDevices), card), false);
+		CHECK_FALSE(card.IsOpen());
+
+		CNTV2DeviceScanner::SetHotplugRefresh(false);
+		CNTV2DeviceScanner::SetParallelScan(false);
+		CHECK_FALSE(CNTV2DeviceScanner::IsParallelScan());
+		CNTV2DriverInterface::SetDiscoveryCache(wasCaching);
+		CNTV2DriverInterface::ClearDiscoveryCache();
+	}	//	TEST_CASE("Scan Modes")
+}	//	TEST_SUITE("DeviceScanner")
@@ -8,6 +8,7 @@
 #include "ntv2llburn.h"
 #include "ntv2endian.h"
 #include "ntv2formatdescriptor.h"
+#include "ntv2audiostream.h"
 #include "ajabase/common/types.h"
 #include "ajaanc/includes/ancillarylist.h"
 #include <iostream>
@@ -37,8 +38,6 @@ NTV2LLBurn::NTV2LLBurn (const BurnConfig & inConfig)
 		mOutputDest				(NTV2_OUTPUTDESTINATION_INVALID),
 		mAudioSystem			(NTV2_AUDIOSYSTEM_1),
 		mGlobalQuit				(false),
-		mAudioInLastAddress		(0),
-		mAudioOutLastAddress	(0),
 		mFramesProcessed		(0),
 		mFramesDropped			(0)
 {
@@ -397,6 +396,14 @@ AJAStatus NTV2LLBurn::SetupAudio (void)
 	//	Ensure that the audio system will capture samples when the reset is removed
 	mDevice.SetAudioCaptureEnable (mAudioSystem, true);
 
+	//	Make sure the audio streams will work (ProcessFrames re-initializes them once audio capture starts)...
+	if (mConfig.WithAudio())
+	{
+		NTV2AudioStream	audioIn (mDevice, mAudioSystem, /*isCapture*/true),  audioOut (mDevice, mAudioSystem, /*isCapture*/false);
+		if (!audioIn.Initialize()  ||  !audioOut.Initialize())
+			{cerr << "## ERROR:  Unable to initialize audio streams for " << ::NTV2AudioSystemToString(mAudioSystem, true) << endl;  return AJA_STATUS_INITIALIZE;}
+	}
+
 	return AJA_STATUS_SUCCESS;
 
 }	//	SetupAudio
@@ -550,11 +557,9 @@ void NTV2LLBurn::ProcessFrames (void)
 	const bool	isInterlace				(!NTV2_VIDEO_FORMAT_HAS_PROGRESSIVE_PICTURE(mVideoFormat));
 	uint32_t	currentInFrame			(mInputStartFrame);
 	uint32_t	currentOutFrame			(mOutputStartFrame);
-	uint32_t	currentAudioInAddress	(0);
-	uint32_t	audioReadOffset			(0);
-	uint32_t	audioInWrapAddress		(0);
-	uint32_t	audioOutWrapAddress		(0);
-	uint32_t	audioBytesCaptured		(0);
+	ULWord		audioSamplesCaptured	(0);
+	NTV2AudioStream	audioIn		(mDevice, mAudioSystem, /*isCapture*/true);
+	NTV2AudioStream	audioOut	(mDevice, mAudioSystem, /*isCapture*/false);
 	uint32_t	ancBytesCapturedF1		(0);
 	uint32_t	ancBytesCapturedF2		(0);
 	bool		audioIsReset			(true);
@@ -632,9 +637,6 @@ void NTV2LLBurn::ProcessFrames (void)
 
 	mFramesProcessed = mFramesDropped = 0;	//	Start with a fresh frame count
 
-	mDevice.GetAudioReadOffset	(audioReadOffset,		mAudioSystem);
-	mDevice.GetAudioWrapAddress	(audioOutWrapAddress,	mAudioSystem);
-
 	//	Wait to make sure the next two SDK calls will be made during the same frame...
 	mDevice.WaitForInputFieldID (NTV2_FIELD0, mConfig.fInputChannel);
     mDevice.DMAWriteAnc (0, zeroesBuffer, zeroesBuffer);
@@ -660,9 +662,14 @@ void NTV2LLBurn::ProcessFrames (void)
 	mDevice.WaitForInputFieldID (NTV2_FIELD0, mConfig.fInputChannel);
 	mDevice.StartAudioInput	(mAudioSystem);
 
-	mAudioInLastAddress		= audioReadOffset;
-	audioInWrapAddress		= audioOutWrapAddress + audioReadOffset;
-	mAudioOutLastAddress	= 0;
+	if (mConfig.WithAudio())
+	{	//	The audio streams take care of the device audio buffer cursors & wraparound...
+		if (!audioIn.Initialize()  ||  !audioOut.Initialize())
+		{
+			cerr << "## ERROR:  Unable to initialize audio streams for " << ::NTV2AudioSystemToString(mAudioSystem, true) << endl;
+			mGlobalQuit = true;		//	Skip the frame loop, but still restore the device below
+		}
+	}
 
 	currentInFrame	^= 1;
 	currentOutFrame	^= 1;
@@ -686,41 +693,15 @@ void NTV2LLBurn::ProcessFrames (void)
 
 		if (mConfig.WithAudio())
 		{
-			//	Read the audio position registers as close to the interrupt as possible...
-			mDevice.ReadAudioLastIn (currentAudioInAddress, NTV2AudioSystem(mConfig.fInputChannel));
-			currentAudioInAddress &= ~0x3UL;	//	Force DWORD alignment
-			currentAudioInAddress += audioReadOffset;
-
-			if (audioIsReset && mAudioOutLastAddress)
+			if (audioIsReset && audioOut.GetTotalSampleFrames())
 			{
 				//	Now that the audio system has some samples to play, playback can be started...
 				mDevice.StartAudioOutput (mAudioSystem);
 				audioIsReset = false;
 			}
 
-			if (currentAudioInAddress < mAudioInLastAddress)
-			{
-				//	Audio address has wrapped around the end of the buffer.
-				//	Do the calculations and transfer from the last address to the end of the buffer...
-				audioBytesCaptured 	= audioInWrapAddress - mAudioInLastAddress;
-
-				mDevice.DMAReadAudio (mAudioSystem, mpHostAudioBuffer, mAudioInLastAddress, audioBytesCaptured);
-
-				//	Transfer the new samples from the start of the buffer to the current address...
-				mDevice.DMAReadAudio (mAudioSystem, AsULWordPtr(mpHostAudioBuffer.GetHostAddress(audioBytesCaptured)),
-										audioReadOffset, currentAudioInAddress - audioReadOffset);
-
-				audioBytesCaptured += currentAudioInAddress - audioReadOffset;
-			}
-			else
-			{
-				audioBytesCaptured = currentAudioInAddress - mAudioInLastAddress;
-
-				//	No wrap, so just perform a linear DMA from the buffer...
-				mDevice.DMAReadAudio (mAudioSystem, mpHostAudioBuffer, mAudioInLastAddress, audioBytesCaptured);
-			}
-
-			mAudioInLastAddress = currentAudioInAddress;
+			//	Transfer all newly-captured audio samples (as close to the interrupt as possible)...
+			audioIn.Read (mpHostAudioBuffer, audioSamplesCaptured);
 		}	//	if mConfig.WithAudio()
 
 		//	Transfer the new frame to system memory...
@@ -786,25 +767,8 @@ void NTV2LLBurn::ProcessFrames (void)
 
 		if (mConfig.WithAudio())
 		{
-			//	Calculate where the next audio samples should go in the buffer, taking wraparound into account...
-			if ((mAudioOutLastAddress + audioBytesCaptured) > audioOutWrapAddress)
-			{
-				//	The audio will wrap. Transfer enough bytes to fill the buffer to the end...
-				mDevice.DMAWriteAudio (mAudioSystem, mpHostAudioBuffer, mAudioOutLastAddress, audioOutWrapAddress - mAudioOutLastAddress);
-
-				//	Now transfer the remaining bytes to the front of the buffer...
-				mDevice.DMAWriteAudio (mAudioSystem, AsULWordPtr(mpHostAudioBuffer.GetHostAddress(audioOutWrapAddress - mAudioOutLastAddress)),
-									   0, audioBytesCaptured - (audioOutWrapAddress - mAudioOutLastAddress));
-
-				mAudioOutLastAddress = audioBytesCaptured - (audioOutWrapAddress - mAudioOutLastAddress);
-			}
-			else
-			{
-				//	No wrap, so just do a linear DMA from the buffer...
-				mDevice.DMAWriteAudio (mAudioSystem, mpHostAudioBuffer, mAudioOutLastAddress, audioBytesCaptured);
-
-				mAudioOutLastAddress += audioBytesCaptured;
-			}
+			//	Send the captured audio samples to the playout side of the audio system...
+			audioOut.Write (mpHostAudioBuffer, audioSamplesCaptured);
 		}	//	if mConfig.WithAudio()
 
 		//	Send the updated frame back to the board for display...
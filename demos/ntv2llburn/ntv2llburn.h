@@ -146,9 +146,6 @@ class NTV2LLBurn
 		NTV2Buffer			mpHostF1AncBuffer;		///< @brief My host Anc buffer (F1)
 		NTV2Buffer			mpHostF2AncBuffer;		///< @brief My host Anc buffer (F2)
 
-		uint32_t			mAudioInLastAddress;	///< @brief My record of the location of the last audio sample captured
-		uint32_t			mAudioOutLastAddress;	///< @brief My record of the location of the last audio sample played
-
 		uint32_t			mFramesProcessed;		///< @brief My count of the number of burned frames produced
 		uint32_t			mFramesDropped;			///< @brief My count of the number of dropped frames
 
@@ -208,6 +208,7 @@ static int DoMessageBufferLock(ULWord deviceNumber, PDMA_PAGE_ROOT pRoot, NTV2Bu
 static int DoMessageBitstream(ULWord deviceNumber, NTV2Bitstream* pBitstream);
 static int DoMessageStreamChannel(ULWord deviceNumber, PFILE_DATA pFile, NTV2StreamChannel* pStreamChannel);
 static int DoMessageStreamBuffer(ULWord deviceNumber, PFILE_DATA pFile, NTV2StreamBuffer* pStreamBuffer);
+static bool anyInterruptFired(NTV2PrivateParams* pNTV2Params, ULWord64 interruptMask, const ULWord64* pCounts);
 
 /* PCI Device Module functions */
 static int probe(struct pci_dev *pdev, const struct pci_device_id *id);	/* New device inserted */
@@ -1413,6 +1414,137 @@ int ntv2_ioctl(struct inode *inode, struct file *file, unsigned int cmd, unsigne
 		}
 		break;
 
+	case IOCTL_NTV2_WAITFOR_ANY_INTERRUPT:
+		{
+			NTV2_WAITFOR_ANY_INTERRUPT_STRUCT* pParam;
+			ULWord timeoutJiffies;
+			int result;
+			int intrIndex;
+
+			// Too big for the kernel stack
+			pParam = kmalloc(sizeof(NTV2_WAITFOR_ANY_INTERRUPT_STRUCT), GFP_KERNEL);
+			if (pParam == NULL)
+				return -ENOMEM;
+			if(copy_from_user((void*)pParam,(const void*) arg,sizeof(NTV2_WAITFOR_ANY_INTERRUPT_STRUCT)))
+			{
+				kfree(pParam);
+				return -EFAULT;
+			}
+			pParam->interruptMask &= (((ULWord64)1) << eNumInterruptTypes) - 1;
+			if (pParam->interruptMask == 0)
+			{
+				kfree(pParam);
+				return -EINVAL;
+			}
+
+			// Interrupts without a caller-supplied count wait for the next one
+			for (intrIndex = 0; intrIndex < eNumInterruptTypes; intrIndex++)
+				if ((pParam->interruptMask & ~pParam->baselineMask) & (((ULWord64)1) << intrIndex))
+					pParam->counts[intrIndex] = *((volatile ULWord64 *)&pNTV2Params->_interruptCount[intrIndex]);
+
+			timeoutJiffies = ntv2_getRoundedUpTimeoutJiffies(pParam->timeOutMs);
+			result = wait_event_interruptible_timeout(pNTV2Params->_anyInterruptWait,
+													  anyInterruptFired(pNTV2Params, pParam->interruptMask, pParam->counts),
+													  timeoutJiffies);
+			if (result < 0)
+			{
+				// Signal
+				kfree(pParam);
+				return result;
+			}
+
+			// Report every interrupt that fired, even if the wait timed out just as it did
+			pParam->firedMask = 0;
+			for (intrIndex = 0; intrIndex < eNumInterruptTypes; intrIndex++)
+			{
+				ULWord64 count;
+				if ((pParam->interruptMask & (((ULWord64)1) << intrIndex)) == 0)
+					continue;
+				count = *((volatile ULWord64 *)&pNTV2Params->_interruptCount[intrIndex]);
+				if (count != pParam->counts[intrIndex])
+					pParam->firedMask |= ((ULWord64)1) << intrIndex;
+				pParam->counts[intrIndex] = count;
+				pParam->times[intrIndex] = pNTV2Params->_interruptTime[intrIndex];
+			}
+			if(copy_to_user((void*)arg,(const void*) pParam,sizeof(NTV2_WAITFOR_ANY_INTERRUPT_STRUCT)))
+			{
+				kfree(pParam);
+				return -EFAULT;
+			}
+			result = pParam->firedMask ? 0 : -ETIMEDOUT;
+			kfree(pParam);
+			return result;
+		}
+		break;
+
+	case IOCTL_NTV2_WAITFOR_INTERRUPT_SNAPSHOT:
+		{
+			NTV2_WAITFOR_INTERRUPT_SNAPSHOT_STRUCT* pParam;
+			ULWord timeoutJiffies;
+			ULWord64 count;
+			int result;
+			ULWord i;
+
+			// Too big for the kernel stack
+			pParam = kmalloc(sizeof(NTV2_WAITFOR_INTERRUPT_SNAPSHOT_STRUCT), GFP_KERNEL);
+			if (pParam == NULL)
+				return -ENOMEM;
+			if(copy_from_user((void*)pParam,(const void*) arg,sizeof(NTV2_WAITFOR_INTERRUPT_SNAPSHOT_STRUCT)))
+			{
+				kfree(pParam);
+				return -EFAULT;
+			}
+			if ((pParam->eInterruptType >= eNumInterruptTypes) ||
+				(pParam->numRegisters > NTV2_INTERRUPT_SNAPSHOT_MAX_REGISTERS) ||
+				(pParam->numAutoCirculate > NTV2_INTERRUPT_SNAPSHOT_MAX_AUTOCIRCULATE))
+			{
+				kfree(pParam);
+				return -EINVAL;
+			}
+
+			count = *((volatile ULWord64 *)&pNTV2Params->_interruptCount[pParam->eInterruptType]);
+			timeoutJiffies = ntv2_getRoundedUpTimeoutJiffies(pParam->timeOutMs);
+			result = wait_event_interruptible_timeout((pNTV2Params->_interruptWait[pParam->eInterruptType]),
+													  count != *((volatile ULWord64 *)&pNTV2Params->_interruptCount[pParam->eInterruptType]),
+													  timeoutJiffies);
+			if (result <= 0)
+			{
+				// Signal or timeout
+				kfree(pParam);
+				return result < 0 ? result : -ETIMEDOUT;
+			}
+
+			// Capture everything right away, then check that no other interrupt happened meanwhile
+			count = *((volatile ULWord64 *)&pNTV2Params->_interruptCount[pParam->eInterruptType]);
+			pParam->interruptCount = count;
+			pParam->interruptTime = pNTV2Params->_interruptTime[pParam->eInterruptType];
+			for (i = 0; i < pParam->numRegisters; i++)
+			{
+				if (pParam->registers[i] != kRegXenaxFlashDOUT)	//	Prevent firmware erase/program/verify failures
+					pParam->values[i] = ReadRegister (deviceNumber, pParam->registers[i], NO_MASK, NO_SHIFT);
+				else
+					pParam->values[i] = 0;
+			}
+			for (i = 0; i < pParam->numAutoCirculate; i++)
+			{
+				result = AutoCirculateStatus(deviceNumber, &pParam->acStatus[i]);
+				if (result)
+				{
+					kfree(pParam);
+					return result;
+				}
+			}
+			pParam->coherent = (count == *((volatile ULWord64 *)&pNTV2Params->_interruptCount[pParam->eInterruptType]));
+
+			if(copy_to_user((void*)arg,(const void*) pParam,sizeof(NTV2_WAITFOR_INTERRUPT_SNAPSHOT_STRUCT)))
+			{
+				kfree(pParam);
+				return -EFAULT;
+			}
+			kfree(pParam);
+		}
+		break;
+
 	//
 	// Autocirculate IOCTLs
 	//
@@ -2280,12 +2412,25 @@ int ntv2_release(struct inode *minode, struct file *mfile) {
 	return 0;
 }
 
+static bool
+anyInterruptFired(NTV2PrivateParams* pNTV2Params, ULWord64 interruptMask, const ULWord64* pCounts)
+{
+	int intrIndex;
+	for (intrIndex = 0; intrIndex < eNumInterruptTypes; intrIndex++)
+		if ((interruptMask & (((ULWord64)1) << intrIndex))
+			&& pCounts[intrIndex] != *((volatile ULWord64 *)&pNTV2Params->_interruptCount[intrIndex]))
+			return true;
+	return false;
+}
+
 inline void
 interruptHousekeeping(NTV2PrivateParams* pNTV2Params, INTERRUPT_ENUMS interrupt)
 {
 	set_bit(0, (volatile unsigned long *)&pNTV2Params->_interruptHappened[interrupt]);
+	pNTV2Params->_interruptTime[interrupt] = ntv2Time100ns();
 	pNTV2Params->_interruptCount[interrupt]++;
 	wake_up(&pNTV2Params->_interruptWait[interrupt]);
+	wake_up(&pNTV2Params->_anyInterruptWait);
 }
 
 irqreturn_t
@@ -3350,8 +3495,10 @@ static int probe(struct pci_dev *pdev, const struct pci_device_id *id)	/* New de
 	{
 		ntv2pp->_interruptCount[intrIndex] = 0;
 		ntv2pp->_interruptHappened[intrIndex] = 0;
+		ntv2pp->_interruptTime[intrIndex] = 0;
 		init_waitqueue_head(&ntv2pp->_interruptWait[intrIndex]);
 	}
+	init_waitqueue_head(&ntv2pp->_anyInterruptWait);
 
 	// Initialize I2C semaphore
 	sema_init(&ntv2pp->_I2CMutex,1);
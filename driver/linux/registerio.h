@@ -410,9 +410,11 @@ typedef struct ntv2_private
 	NTV2DeviceID _DeviceID;		// device ID value
 
 	wait_queue_head_t       _interruptWait[eNumInterruptTypes];
+	wait_queue_head_t       _anyInterruptWait;		// woken on every interrupt, for IOCTL_NTV2_WAITFOR_ANY_INTERRUPT
 
 	ULWord64 				_interruptCount[eNumInterruptTypes];
 	unsigned long			_interruptHappened[eNumInterruptTypes];
+	int64_t					_interruptTime[eNumInterruptTypes];	// time of most recent interrupt (100ns units)
 
 	struct semaphore        _I2CMutex;
 
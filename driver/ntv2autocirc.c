@@ -3916,6 +3916,7 @@ bool AutoCircCanDoFieldMode(INTERNAL_AUTOCIRCULATE_STRUCT* pAuto)
 
 //	STUBS -
 //	Real device drivers and fake devices must implement:
+#if !defined(NTV2_DRIVER_SIM)	//	the driver simulator implements these in sim/ntv2simdevice.c
 Ntv2Status	AutoDmaTransfer(void* pContext, PAUTO_DMA_PARAMS pDmaParams)
 {
 	return NTV2_STATUS_SUCCESS;
@@ -3950,3 +3951,4 @@ uint64_t	AutoGetMessageAddress(void* pContext, NTV2Channel channel)
 {
 	return 0;
 }
+#endif	//	!defined(NTV2_DRIVER_SIM)
@@ -67,7 +67,12 @@
 
 	// virtual message abstraction
 
+#if defined(NTV2_DRIVER_SIM)
+	void ntv2SimMessage(const char* format, ...);
+	#define ntv2Message(string, ...) 			ntv2SimMessage(string, __VA_ARGS__)
+#else
 	#define ntv2Message(string, ...) 			printf(string, __VA_ARGS__); fflush(stdout)
+#endif
 
 	// virtual spinlock abstraction
 
@@ -0,0 +1,795 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (C) 2024 AJA Video Systems, Inc.
+ */
+//==========================================================================
+//
+//  ntv2drvsim.c
+//
+//  Runs the driver frame scheduling code (ntv2autocirc.c, ntv2stream.c and
+//  ntv2videoraster.c) against a simulated device and a simulated clock.
+//  Vertical interrupts and client wakeups are events on one timeline, so
+//  hours of capture or playout run in seconds and every run with the same
+//  options produces the same frame counts.  The host cpu time spent in the
+//  driver interrupt and transfer paths is measured for real.
+//
+//==========================================================================
+
+#include <getopt.h>
+#include <time.h>
+#include "ntv2simdevice.h"
+#include "ntv2autocirc.h"
+#include "ntv2audio.h"
+
+#define SIM_HISTOGRAM_BUCKETS		65536		// 10 us buckets
+#define SIM_HISTOGRAM_SCALE			100			// 100 ns units per bucket
+#define SIM_MAX_CHANNELS			3
+#define SIM_VIDEO_BYTES				(1920 * 1080 * 2)		// 8 bit ycbcr
+#define SIM_AUDIO_CHANNELS			8
+#define SIM_AUDIO_BYTES				(401 * 1024)			// capture audio buffer like the demos
+
+typedef struct sim_histogram
+{
+	uint64_t	buckets[SIM_HISTOGRAM_BUCKETS];
+	uint64_t	count;
+	int64_t		sum;
+	int64_t		max;
+} SimHistogram;
+
+typedef struct sim_cpu
+{
+	uint64_t	calls;
+	uint64_t	totalNs;
+	uint64_t	maxNs;
+	uint64_t	registerReads;
+	uint64_t	registerWrites;
+} SimCpu;
+
+typedef struct sim_channel
+{
+	const char*		name;
+	bool			input;
+	bool			stream;
+	NTV2Crosspoint	crosspoint;
+	NTV2Channel		channel;
+	int32_t			startFrame;
+	int32_t			endFrame;
+
+	// client
+	int64_t			wakeTime;				// -1 when waiting for the next vertical interrupt
+	bool			transferPending;		// dma in progress until wakeTime
+	int64_t			transferTime[NTV2_STREAM_NUM_BUFFERS];	// playout: when each frame reached the device
+	uint32_t		onAirFrame;
+	uint32_t		audioCadence;
+
+	// stream client
+	struct ntv2_stream*		pStream;
+	NTV2StreamChannel		streamChannel;
+	NTV2StreamBuffer		streamBuffer;
+	uint64_t				streamQueued;
+	uint64_t				streamReleased;
+	bool					streamStarted;
+	uint8_t					streamDummy[16];
+
+	// results
+	uint64_t		transfers;
+	uint64_t		transferErrors;
+	uint64_t		emptyWakes;
+	uint64_t		stalls;
+	SimHistogram	latency;
+	SimCpu			transferCpu;
+	SimCpu			statusCpu;
+} SimChannel;
+
+typedef struct sim_options
+{
+	bool		capture;
+	bool		playout;
+	double		hours;
+	NTV2FrameRate	frameRate;
+	uint32_t	numFrames;
+	int32_t		streamDepth;
+	bool		raster;
+	bool		audio;
+	int64_t		irqJitter;				// 100 ns units
+	int64_t		schedJitter;			// 100 ns units
+	double		stallProbability;
+	int64_t		stallTime;				// 100 ns units
+	uint32_t	dmaMBytesPerSec;
+	uint32_t	dmaErrorRate;
+	uint64_t	seed;
+	int64_t		maxDrops;
+	bool		verbose;
+} SimOptions;
+
+static Ntv2SimDevice	sDevice;
+static NTV2AutoCirc		sAutoCirc;
+static SimChannel		sChannels[SIM_MAX_CHANNELS];
+static uint32_t			sNumChannels = 0;
+static SimCpu			sIsrCpu;
+static SimHistogram		sIsrLatency;
+static uint8_t			sDummyBuffer[16];
+
+static uint64_t hostNs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000) + (uint64_t)ts.tv_nsec;
+}
+
+static void histogramAdd(SimHistogram* pHist, int64_t value)
+{
+	int64_t bucket = value / SIM_HISTOGRAM_SCALE;
+
+	if (value < 0) value = 0;
+	if (bucket < 0) bucket = 0;
+	if (bucket >= SIM_HISTOGRAM_BUCKETS) bucket = SIM_HISTOGRAM_BUCKETS - 1;
+	pHist->buckets[bucket]++;
+	pHist->count++;
+	pHist->sum += value;
+	if (value > pHist->max)
+		pHist->max = value;
+}
+
+static double histogramPercentile(const SimHistogram* pHist, double percent)
+{
+	uint64_t target = (uint64_t)(pHist->count * percent / 100.0);
+	uint64_t total = 0;
+	int i;
+
+	for (i = 0; i < SIM_HISTOGRAM_BUCKETS; i++)
+	{
+		total += pHist->buckets[i];
+		if (total > target)
+			break;
+	}
+	if (i < SIM_HISTOGRAM_BUCKETS - 1)
+	{
+		// upper edge of the bucket but never more than the worst case
+		int64_t value = (int64_t)(i + 1) * SIM_HISTOGRAM_SCALE;
+		return (double)((value < pHist->max)? value : pHist->max) / 10000.0;
+	}
+	return (double)pHist->max / 10000.0;
+}
+
+static void cpuBegin(uint64_t* pStart)
+{
+	sDevice.registerReads = 0;
+	sDevice.registerWrites = 0;
+	sDevice.countAccess = true;
+	*pStart = hostNs();
+}
+
+static void cpuEnd(SimCpu* pCpu, uint64_t start)
+{
+	uint64_t ns = hostNs() - start;
+
+	sDevice.countAccess = false;
+	pCpu->calls++;
+	pCpu->totalNs += ns;
+	if (ns > pCpu->maxNs)
+		pCpu->maxNs = ns;
+	pCpu->registerReads += sDevice.registerReads;
+	pCpu->registerWrites += sDevice.registerWrites;
+}
+
+static int64_t randomRange(int64_t range)
+{
+	if (range <= 0) return 0;
+	return (int64_t)(ntv2SimDeviceRandom(&sDevice) % (uint32_t)range);
+}
+
+static bool randomChance(double probability)
+{
+	if (probability <= 0.0) return false;
+	return ((double)ntv2SimDeviceRandom(&sDevice) / 4294967296.0) < probability;
+}
+
+//	autocirculate client
+
+static Ntv2Status clientStatus(SimChannel* pChan, AUTOCIRCULATE_STATUS* pStatus)
+{
+	Ntv2Status status;
+	uint64_t start;
+
+	memset(pStatus, 0, sizeof(AUTOCIRCULATE_STATUS));
+	pStatus->acCrosspoint = pChan->crosspoint;
+
+	cpuBegin(&start);
+	status = AutoCircGetStatus(&sAutoCirc, pStatus);
+	cpuEnd(&pChan->statusCpu, start);
+
+	return status;
+}
+
+static Ntv2Status clientControl(SimChannel* pChan, AUTO_CIRC_COMMAND command, const SimOptions* pOpt)
+{
+	AUTOCIRCULATE_DATA_64 control;
+
+	memset(&control, 0, sizeof(AUTOCIRCULATE_DATA_64));
+	control.eCommand = command;
+	control.channelSpec = pChan->crosspoint;
+	if (command == eInitAutoCirc)
+	{
+		control.lVal1 = pChan->startFrame;
+		control.lVal2 = pChan->endFrame;
+		control.lVal3 = pChan->input? NTV2_AUDIOSYSTEM_1 : NTV2_AUDIOSYSTEM_2;
+		control.lVal4 = 1;
+		control.bVal1 = pOpt->audio;
+	}
+
+	return AutoCircControl(&sAutoCirc, &control);
+}
+
+static void clientTransfer(SimChannel* pChan, const SimOptions* pOpt)
+{
+	AUTOCIRCULATE_TRANSFER transfer;
+	Ntv2Status status;
+	uint64_t start;
+	int64_t now = ntv2SimGetTime();
+
+	memset(&transfer, 0, sizeof(AUTOCIRCULATE_TRANSFER));
+	transfer.acCrosspoint = pChan->crosspoint;
+	transfer.acDesiredFrame = NTV2_INVALID_FRAME;
+	transfer.acFrameRepeatCount = 1;
+	transfer.acFrameBufferFormat = NTV2_FBF_8BIT_YCBCR;
+	transfer.acTransferStatus.acTransferFrame = NTV2_INVALID_FRAME;
+
+	// frame data is never touched by the non p2p transfer path
+	transfer.acVideoBuffer.fUserSpacePtr = (uint64_t)(uintptr_t)sDummyBuffer;
+	transfer.acVideoBuffer.fByteCount = SIM_VIDEO_BYTES;
+	if (pOpt->audio)
+	{
+		uint32_t samples = GetAudioSamplesPerFrame(&sDevice.systemContext, NTV2_AUDIOSYSTEM_2, pChan->audioCadence++, false);
+		transfer.acAudioBuffer.fUserSpacePtr = (uint64_t)(uintptr_t)sDummyBuffer;
+		transfer.acAudioBuffer.fByteCount = pChan->input? SIM_AUDIO_BYTES : samples * SIM_AUDIO_CHANNELS * 4;
+	}
+
+	cpuBegin(&start);
+	status = AutoCircTransfer(&sAutoCirc, &transfer);
+	cpuEnd(&pChan->transferCpu, start);
+
+	if (status != NTV2_STATUS_SUCCESS)
+	{
+		pChan->transferErrors++;
+		return;
+	}
+
+	if (transfer.acTransferStatus.acTransferFrame == NTV2_INVALID_FRAME)
+	{
+		pChan->emptyWakes++;
+		return;
+	}
+
+	pChan->transfers++;
+	if (pChan->input)
+	{
+		// the frame time stamp is the 32 bit interrupt time
+		int64_t age = (int64_t)(uint32_t)((uint32_t)now - (uint32_t)transfer.acTransferStatus.acFrameStamp.acFrameTime);
+		histogramAdd(&pChan->latency, age);
+	}
+	else
+	{
+		pChan->transferTime[transfer.acTransferStatus.acTransferFrame] = now;
+	}
+}
+
+static bool clientHasWork(SimChannel* pChan, const AUTOCIRCULATE_STATUS* pStatus)
+{
+	uint32_t range = (uint32_t)(pChan->endFrame - pChan->startFrame) + 1;
+
+	if (pChan->input)
+		return (pStatus->acState == NTV2_AUTOCIRCULATE_RUNNING) && (pStatus->acBufferLevel > 1);
+
+	if ((pStatus->acState != NTV2_AUTOCIRCULATE_INIT) &&
+		(pStatus->acState != NTV2_AUTOCIRCULATE_STARTING) &&
+		(pStatus->acState != NTV2_AUTOCIRCULATE_RUNNING))
+		return false;
+
+	return (range - pStatus->acBufferLevel) > 1;
+}
+
+//	stream client
+
+static void streamClient(SimChannel* pChan, const SimOptions* pOpt)
+{
+	NTV2StreamBuffer* pBuffer = &pChan->streamBuffer;
+	Ntv2Status status;
+	uint64_t start;
+	bool more = true;
+
+	// release everything that went off air
+	while (pChan->streamReleased < pChan->streamQueued)
+	{
+		memset(pBuffer, 0, sizeof(NTV2StreamBuffer));
+		cpuBegin(&start);
+		status = ntv2_stream_buffer_release(pChan->pStream, pChan, pBuffer);
+		cpuEnd(&pChan->statusCpu, start);
+		if ((status != NTV2_STATUS_SUCCESS) || ((pBuffer->mStatus & NTV2_STREAM_STATUS_SUCCESS) == 0))
+			break;
+
+		pChan->streamReleased++;
+		if (pBuffer->mActiveTime != 0)
+			histogramAdd(&pChan->latency, pBuffer->mActiveTime - pBuffer->mQueueTime);
+	}
+
+	// keep the queue full
+	while (more && ((pChan->streamQueued - pChan->streamReleased) < (uint64_t)pOpt->streamDepth))
+	{
+		memset(pBuffer, 0, sizeof(NTV2StreamBuffer));
+		pBuffer->mChannel = pChan->channel;
+		pBuffer->mBuffer.fUserSpacePtr = (uint64_t)(uintptr_t)pChan->streamDummy;
+		pBuffer->mBuffer.fByteCount = SIM_VIDEO_BYTES;
+		pBuffer->mBufferCookie = pChan->streamQueued;
+
+		cpuBegin(&start);
+		status = ntv2_stream_buffer_queue(pChan->pStream, pChan, pBuffer);
+		cpuEnd(&pChan->transferCpu, start);
+		if ((status != NTV2_STATUS_SUCCESS) || ((pBuffer->mStatus & NTV2_STREAM_STATUS_SUCCESS) == 0))
+		{
+			pChan->transferErrors++;
+			more = false;
+		}
+		else
+		{
+			pChan->streamQueued++;
+			pChan->transfers++;
+		}
+	}
+
+	if (!pChan->streamStarted)
+	{
+		ntv2_stream_channel_start(pChan->pStream, &pChan->streamChannel);
+		pChan->streamStarted = true;
+	}
+}
+
+static void clientWake(SimChannel* pChan, const SimOptions* pOpt)
+{
+	AUTOCIRCULATE_STATUS acStatus;
+
+	if (pChan->stream)
+	{
+		streamClient(pChan, pOpt);
+		pChan->wakeTime = -1;
+		return;
+	}
+
+	// the dma started at the last wakeup has finished
+	if (pChan->transferPending)
+	{
+		pChan->transferPending = false;
+		clientTransfer(pChan, pOpt);
+	}
+
+	if (clientStatus(pChan, &acStatus) != NTV2_STATUS_SUCCESS)
+	{
+		pChan->wakeTime = -1;
+		return;
+	}
+
+	if (clientHasWork(pChan, &acStatus))
+	{
+		uint32_t numBytes = SIM_VIDEO_BYTES + (pOpt->audio? 801 * SIM_AUDIO_CHANNELS * 4 : 0);
+		pChan->transferPending = true;
+		pChan->wakeTime = ntv2SimGetTime() + ntv2SimDeviceDmaTime(&sDevice, numBytes);
+		return;
+	}
+
+	// playout starts once the client can not preload any more frames
+	if (!pChan->input && (acStatus.acState == NTV2_AUTOCIRCULATE_INIT))
+		clientControl(pChan, eStartAutoCirc, pOpt);
+
+	pChan->wakeTime = -1;
+}
+
+//	vertical interrupt
+
+static void verticalInterrupt(const SimOptions* pOpt, int64_t scheduledTime)
+{
+	int64_t now = ntv2SimGetTime();
+	uint64_t start;
+	uint32_t i;
+
+	histogramAdd(&sIsrLatency, now - scheduledTime);
+
+	cpuBegin(&start);
+	ntv2SimDeviceVerticalInterrupt(&sDevice);
+	for (i = 0; i < sNumChannels; i++)
+	{
+		if (sChannels[i].stream)
+			ntv2_stream_channel_advance(sChannels[i].pStream);
+		else
+			AutoCirculate(&sAutoCirc, sChannels[i].crosspoint, (int32_t)now);
+	}
+	cpuEnd(&sIsrCpu, start);
+
+	for (i = 0; i < sNumChannels; i++)
+	{
+		SimChannel* pChan = &sChannels[i];
+
+		// playout latency is from transfer complete to on air
+		if (!pChan->input && !pChan->stream)
+		{
+			uint32_t frame = ntv2SimDeviceLatchedFrame(&sDevice, pChan->channel, false);
+			if ((frame != pChan->onAirFrame) && (frame < NTV2_STREAM_NUM_BUFFERS) && (pChan->transferTime[frame] != 0))
+			{
+				histogramAdd(&pChan->latency, now - pChan->transferTime[frame]);
+				pChan->transferTime[frame] = 0;
+			}
+			pChan->onAirFrame = frame;
+		}
+
+		// wake clients that are waiting for the interrupt
+		if (pChan->wakeTime < 0)
+		{
+			pChan->wakeTime = now + randomRange(pOpt->schedJitter);
+			if (randomChance(pOpt->stallProbability))
+			{
+				pChan->wakeTime += pOpt->stallTime;
+				pChan->stalls++;
+			}
+		}
+	}
+}
+
+//	setup and report
+
+static bool addAutoCircChannel(const char* name, bool input, NTV2Channel channel, uint32_t firstFrame, const SimOptions* pOpt)
+{
+	SimChannel* pChan = &sChannels[sNumChannels];
+
+	pChan->name = name;
+	pChan->input = input;
+	pChan->channel = channel;
+	pChan->crosspoint = input? GetNTV2CrosspointInputForIndex(channel) : GetNTV2CrosspointChannelForIndex(channel);
+	pChan->startFrame = (int32_t)firstFrame;
+	pChan->endFrame = (int32_t)(firstFrame + pOpt->numFrames - 1);
+	pChan->onAirFrame = 0xffffffff;
+	pChan->wakeTime = 0;
+
+	if (clientControl(pChan, eInitAutoCirc, pOpt) != NTV2_STATUS_SUCCESS)
+	{
+		fprintf(stderr, "## ERROR:  %s autocirculate init failed\n", name);
+		return false;
+	}
+	if (input && (clientControl(pChan, eStartAutoCirc, pOpt) != NTV2_STATUS_SUCCESS))
+	{
+		fprintf(stderr, "## ERROR:  %s autocirculate start failed\n", name);
+		return false;
+	}
+
+	sNumChannels++;
+	return true;
+}
+
+static bool addStreamChannel(NTV2Channel channel, const SimOptions* pOpt)
+{
+	SimChannel* pChan = &sChannels[sNumChannels];
+	struct ntv2_stream_ops ops;
+
+	pChan->name = "stream";
+	pChan->stream = true;
+	pChan->channel = channel;
+	pChan->wakeTime = 0;
+
+	ntv2SimDeviceStreamOps(&ops);
+	pChan->pStream = ntv2_stream_open(&sDevice.systemContext, "ntv2stream", (int)channel);
+	if ((pChan->pStream == NULL) ||
+		(ntv2_stream_configure(pChan->pStream, &ops, &sDevice, 3) != NTV2_STATUS_SUCCESS) ||
+		(ntv2_stream_enable(pChan->pStream) != NTV2_STATUS_SUCCESS))
+	{
+		fprintf(stderr, "## ERROR:  stream open failed\n");
+		return false;
+	}
+
+	pChan->streamChannel.mChannel = channel;
+	if ((ntv2_stream_channel_initialize(pChan->pStream, pChan, &pChan->streamChannel) != NTV2_STATUS_SUCCESS) ||
+		((pChan->streamChannel.mStatus & NTV2_STREAM_STATUS_SUCCESS) == 0))
+	{
+		fprintf(stderr, "## ERROR:  stream initialize failed\n");
+		return false;
+	}
+
+	sNumChannels++;
+	return true;
+}
+
+static void printCpu(const char* name, const SimCpu* pCpu)
+{
+	if (pCpu->calls == 0) return;
+
+	printf("    %-10s %12llu calls  %8.0f ns avg  %8llu ns max  %6.1f reg rd  %6.1f reg wr\n",
+		   name,
+		   (unsigned long long)pCpu->calls,
+		   (double)pCpu->totalNs / pCpu->calls,
+		   (unsigned long long)pCpu->maxNs,
+		   (double)pCpu->registerReads / pCpu->calls,
+		   (double)pCpu->registerWrites / pCpu->calls);
+}
+
+static void printLatency(const char* name, const SimHistogram* pHist)
+{
+	if (pHist->count == 0) return;
+
+	printf("    %-10s %12llu samples  avg %8.3f ms  p50 %8.3f ms  p99 %8.3f ms  max %8.3f ms\n",
+		   name,
+		   (unsigned long long)pHist->count,
+		   (double)pHist->sum / pHist->count / 10000.0,
+		   histogramPercentile(pHist, 50.0),
+		   histogramPercentile(pHist, 99.0),
+		   (double)pHist->max / 10000.0);
+}
+
+static int64_t report(const SimOptions* pOpt, int64_t simTime, uint64_t vbiCount, uint64_t wallNs)
+{
+	int64_t totalDrops = 0;
+	uint32_t i;
+
+	printf("simulated %.2f hours  %llu vertical interrupts  %.2f s host time  (%.0fx real time)\n",
+		   (double)simTime / 36000000000.0,
+		   (unsigned long long)vbiCount,
+		   (double)wallNs / 1e9,
+		   ((double)simTime * 100.0) / (double)(wallNs? wallNs : 1));
+	printLatency("irq", &sIsrLatency);
+	printCpu("isr", &sIsrCpu);
+
+	for (i = 0; i < sNumChannels; i++)
+	{
+		SimChannel* pChan = &sChannels[i];
+		uint64_t processed = 0;
+		int64_t dropped = 0;
+
+		if (pChan->stream)
+		{
+			ntv2_stream_channel_status(pChan->pStream, &pChan->streamChannel);
+			processed = pChan->streamChannel.mActiveCount;
+			dropped = (int64_t)pChan->streamChannel.mRepeatCount;
+		}
+		else
+		{
+			AUTOCIRCULATE_STATUS acStatus;
+			clientStatus(pChan, &acStatus);
+			processed = acStatus.acFramesProcessed;
+			dropped = acStatus.acFramesDropped;
+		}
+		totalDrops += dropped;
+
+		printf("%s:  %llu frames  %lld dropped  %llu transfers  %llu failed  %llu empty  %llu stalls\n",
+			   pChan->name,
+			   (unsigned long long)processed,
+			   (long long)dropped,
+			   (unsigned long long)pChan->transfers,
+			   (unsigned long long)pChan->transferErrors,
+			   (unsigned long long)pChan->emptyWakes,
+			   (unsigned long long)pChan->stalls);
+		printLatency("latency", &pChan->latency);
+		printCpu(pChan->stream? "queue" : "transfer", &pChan->transferCpu);
+		printCpu(pChan->stream? "release" : "status", &pChan->statusCpu);
+	}
+
+	printf("dma:  %llu transfers  %llu errors  %.1f GB  %.1f%% busy\n",
+		   (unsigned long long)sDevice.dmaTransfers,
+		   (unsigned long long)sDevice.dmaErrors,
+		   (double)sDevice.dmaBytes / 1e9,
+		   simTime? (100.0 * (double)sDevice.dmaTime / (double)simTime) : 0.0);
+	printf("driver messages:  %llu\n", (unsigned long long)ntv2SimMessageCount());
+
+	return totalDrops;
+}
+
+static void usage(const char* pName)
+{
+	printf("usage: %s [options]\n", pName);
+	printf("  -m, --mode <capture|playout|both>   autocirculate channels to run (default capture)\n");
+	printf("  -t, --hours <h>                     simulated run time (default 1)\n");
+	printf("  -r, --rate <fps>                    23.98 24 25 29.97 30 50 59.94 60 (default 59.94)\n");
+	printf("  -f, --frames <n>                    frames per autocirculate channel (default 7)\n");
+	printf("  -s, --stream <n>                    add a stream channel with n queued buffers\n");
+	printf("  -R, --raster                        enable the video raster widget model\n");
+	printf("  -a, --audio                         circulate with audio\n");
+	printf("  -i, --irq-jitter <us>               interrupt delivery jitter (default 20)\n");
+	printf("  -j, --sched-jitter <us>             client wakeup jitter (default 500)\n");
+	printf("  -p, --stall-prob <p>                probability a client wakeup stalls (default 0)\n");
+	printf("  -l, --stall-ms <ms>                 client stall time (default 50)\n");
+	printf("  -d, --dma-mbps <MB/s>               dma bandwidth (default 3000)\n");
+	printf("  -e, --dma-errors <n>                fail one dma in n (default 0 = never)\n");
+	printf("  -S, --seed <n>                      random seed\n");
+	printf("  -x, --max-drops <n>                 exit with an error if more frames drop\n");
+	printf("  -v, --verbose                       print driver messages\n");
+}
+
+static bool parseRate(const char* pRate, NTV2FrameRate* pFrameRate)
+{
+	static const struct { const char* name; NTV2FrameRate rate; } rates[] = {
+		{ "23.98", NTV2_FRAMERATE_2398 }, { "24", NTV2_FRAMERATE_2400 }, { "25", NTV2_FRAMERATE_2500 },
+		{ "29.97", NTV2_FRAMERATE_2997 }, { "30", NTV2_FRAMERATE_3000 }, { "50", NTV2_FRAMERATE_5000 },
+		{ "59.94", NTV2_FRAMERATE_5994 }, { "60", NTV2_FRAMERATE_6000 } };
+	uint32_t i;
+
+	for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+	{
+		if (strcmp(pRate, rates[i].name) == 0)
+		{
+			*pFrameRate = rates[i].rate;
+			return true;
+		}
+	}
+	return false;
+}
+
+int main(int argc, char** argv)
+{
+	static const struct option longOptions[] = {
+		{ "mode",			required_argument,	NULL, 'm' },
+		{ "hours",			required_argument,	NULL, 't' },
+		{ "rate",			required_argument,	NULL, 'r' },
+		{ "frames",			required_argument,	NULL, 'f' },
+		{ "stream",			required_argument,	NULL, 's' },
+		{ "raster",			no_argument,		NULL, 'R' },
+		{ "audio",			no_argument,		NULL, 'a' },
+		{ "irq-jitter",		required_argument,	NULL, 'i' },
+		{ "sched-jitter",	required_argument,	NULL, 'j' },
+		{ "stall-prob",		required_argument,	NULL, 'p' },
+		{ "stall-ms",		required_argument,	NULL, 'l' },
+		{ "dma-mbps",		required_argument,	NULL, 'd' },
+		{ "dma-errors",		required_argument,	NULL, 'e' },
+		{ "seed",			required_argument,	NULL, 'S' },
+		{ "max-drops",		required_argument,	NULL, 'x' },
+		{ "verbose",		no_argument,		NULL, 'v' },
+		{ "help",			no_argument,		NULL, 'h' },
+		{ NULL, 0, NULL, 0 } };
+	SimOptions opt;
+	int64_t period;
+	int64_t endTime;
+	int64_t nextVbi;
+	int64_t drops;
+	uint64_t vbiCount = 0;
+	uint64_t wallStart;
+	uint32_t i;
+	int c;
+
+	memset(&opt, 0, sizeof(SimOptions));
+	opt.capture = true;
+	opt.hours = 1.0;
+	opt.frameRate = NTV2_FRAMERATE_5994;
+	opt.numFrames = 7;
+	opt.irqJitter = 20 * 10;
+	opt.schedJitter = 500 * 10;
+	opt.stallTime = 50 * 10000;
+	opt.dmaMBytesPerSec = 3000;
+	opt.seed = 1;
+	opt.maxDrops = -1;
+
+	while ((c = getopt_long(argc, argv, "m:t:r:f:s:Rai:j:p:l:d:e:S:x:vh", longOptions, NULL)) != -1)
+	{
+		switch (c)
+		{
+		case 'm':
+			opt.capture = (strcmp(optarg, "capture") == 0) || (strcmp(optarg, "both") == 0);
+			opt.playout = (strcmp(optarg, "playout") == 0) || (strcmp(optarg, "both") == 0);
+			if (!opt.capture && !opt.playout)
+			{
+				fprintf(stderr, "## ERROR:  unknown mode '%s'\n", optarg);
+				return 2;
+			}
+			break;
+		case 't':	opt.hours = atof(optarg);									break;
+		case 'r':
+			if (!parseRate(optarg, &opt.frameRate))
+			{
+				fprintf(stderr, "## ERROR:  unsupported rate '%s'\n", optarg);
+				return 2;
+			}
+			break;
+		case 'f':	opt.numFrames = (uint32_t)atoi(optarg);						break;
+		case 's':	opt.streamDepth = atoi(optarg);								break;
+		case 'R':	opt.raster = true;											break;
+		case 'a':	opt.audio = true;											break;
+		case 'i':	opt.irqJitter = (int64_t)(atof(optarg) * 10.0);				break;
+		case 'j':	opt.schedJitter = (int64_t)(atof(optarg) * 10.0);			break;
+		case 'p':	opt.stallProbability = atof(optarg);						break;
+		case 'l':	opt.stallTime = (int64_t)(atof(optarg) * 10000.0);			break;
+		case 'd':	opt.dmaMBytesPerSec = (uint32_t)atoi(optarg);				break;
+		case 'e':	opt.dmaErrorRate = (uint32_t)atoi(optarg);					break;
+		case 'S':	opt.seed = strtoull(optarg, NULL, 0);						break;
+		case 'x':	opt.maxDrops = atoll(optarg);								break;
+		case 'v':	opt.verbose = true;											break;
+		case 'h':	usage(argv[0]);												return 0;
+		default:	usage(argv[0]);												return 2;
+		}
+	}
+
+	if ((opt.numFrames < 2) || (opt.numFrames > 64) || (opt.streamDepth < 0) || (opt.streamDepth > 64))
+	{
+		fprintf(stderr, "## ERROR:  frames must be 2..64 and stream depth 0..64\n");
+		return 2;
+	}
+
+	ntv2SimSetVerbose(opt.verbose);
+	ntv2SimSetTime(0);
+	if (!ntv2SimDeviceOpen(&sDevice, DEVICE_ID_CORVID88, opt.frameRate))
+	{
+		fprintf(stderr, "## ERROR:  simulated device open failed\n");
+		return 1;
+	}
+	sDevice.dmaMBytesPerSec = opt.dmaMBytesPerSec;
+	sDevice.dmaErrorRate = opt.dmaErrorRate;
+	sDevice.randomState += opt.seed * 0xbf58476d1ce4e5b9ULL;
+	if (opt.raster && !ntv2SimDeviceEnableRaster(&sDevice))
+	{
+		fprintf(stderr, "## ERROR:  video raster enable failed\n");
+		return 1;
+	}
+
+	memset(&sAutoCirc, 0, sizeof(NTV2AutoCirc));
+	sAutoCirc.pSysCon = &sDevice.systemContext;
+	sAutoCirc.pFunCon = &sDevice;
+	sAutoCirc.deviceID = sDevice.deviceID;
+	sAutoCirc.syncChannel1 = NTV2CROSSPOINT_FGKEY;
+	sAutoCirc.syncChannel2 = NTV2CROSSPOINT_FGKEY;
+
+	if (opt.capture && !addAutoCircChannel("capture", true, NTV2_CHANNEL1, 0, &opt))
+		return 1;
+	if (opt.playout && !addAutoCircChannel("playout", false, NTV2_CHANNEL2, opt.numFrames, &opt))
+		return 1;
+	if ((opt.streamDepth > 0) && !addStreamChannel(NTV2_CHANNEL3, &opt))
+		return 1;
+
+	period = ntv2SimDeviceFramePeriod(&sDevice);
+	endTime = (int64_t)(opt.hours * 36000000000.0);
+	nextVbi = period;
+	wallStart = hostNs();
+
+	while (nextVbi <= endTime)
+	{
+		int64_t vbiTime = nextVbi + randomRange(opt.irqJitter);
+
+		// run every client event due before the interrupt
+		for (;;)
+		{
+			SimChannel* pNext = NULL;
+			for (i = 0; i < sNumChannels; i++)
+			{
+				if ((sChannels[i].wakeTime >= 0) && (sChannels[i].wakeTime < vbiTime) &&
+					((pNext == NULL) || (sChannels[i].wakeTime < pNext->wakeTime)))
+					pNext = &sChannels[i];
+			}
+			if (pNext == NULL)
+				break;
+
+			ntv2SimSetTime(pNext->wakeTime);
+			clientWake(pNext, &opt);
+		}
+
+		ntv2SimSetTime(vbiTime);
+		verticalInterrupt(&opt, nextVbi);
+		vbiCount++;
+		nextVbi += period;
+	}
+
+	drops = report(&opt, ntv2SimGetTime(), vbiCount, hostNs() - wallStart);
+
+	for (i = 0; i < sNumChannels; i++)
+	{
+		if (sChannels[i].stream)
+		{
+			ntv2_stream_channel_release(sChannels[i].pStream, &sChannels[i], &sChannels[i].streamChannel);
+			ntv2_stream_disable(sChannels[i].pStream);
+			ntv2_stream_close(sChannels[i].pStream);
+		}
+		else
+		{
+			clientControl(&sChannels[i], eAbortAutoCirc, &opt);
+		}
+	}
+	ntv2SimDeviceClose(&sDevice);
+
+	if ((opt.maxDrops >= 0) && (drops > opt.maxDrops))
+	{
+		fprintf(stderr, "## ERROR:  %lld frames dropped (max %lld)\n", (long long)drops, (long long)opt.maxDrops);
+		return 1;
+	}
+
+	return 0;
+}
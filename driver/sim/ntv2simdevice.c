@@ -0,0 +1,489 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (C) 2024 AJA Video Systems, Inc.
+ */
+//==========================================================================
+//
+//  ntv2simdevice.c
+//
+//==========================================================================
+
+#include "ntv2simdevice.h"
+#include "ntv2autocirc.h"
+#include "ntv2autofunc.h"
+#include "ntv2video.h"
+#include "ntv2audiodefines.h"
+
+static const uint32_t	gChannelToGlobalControlRegNum[] = {
+	kRegGlobalControl, kRegGlobalControlCh2, kRegGlobalControlCh3, kRegGlobalControlCh4,
+	kRegGlobalControlCh5, kRegGlobalControlCh6, kRegGlobalControlCh7, kRegGlobalControlCh8, 0 };
+static const uint32_t	gChannelToControlRegNum[] = {
+	kRegCh1Control, kRegCh2Control, kRegCh3Control, kRegCh4Control,
+	kRegCh5Control, kRegCh6Control, kRegCh7Control, kRegCh8Control, 0 };
+static const uint32_t	gChannelToOutputFrameReg[] = {
+	kRegCh1OutputFrame, kRegCh2OutputFrame, kRegCh3OutputFrame, kRegCh4OutputFrame,
+	kRegCh5OutputFrame, kRegCh6OutputFrame, kRegCh7OutputFrame, kRegCh8OutputFrame, 0 };
+static const uint32_t	gChannelToInputFrameReg[] = {
+	kRegCh1InputFrame, kRegCh2InputFrame, kRegCh3InputFrame, kRegCh4InputFrame,
+	kRegCh5InputFrame, kRegCh6InputFrame, kRegCh7InputFrame, kRegCh8InputFrame, 0 };
+static const uint32_t	gAudioSystemToControlReg[] = {
+	kRegAud1Control, kRegAud2Control, kRegAud3Control, kRegAud4Control,
+	kRegAud5Control, kRegAud6Control, kRegAud7Control, kRegAud8Control, 0 };
+static const uint32_t	gAudioSystemToOutputLastReg[] = {
+	kRegAud1OutputLastAddr, kRegAud2OutputLastAddr, kRegAud3OutputLastAddr, kRegAud4OutputLastAddr,
+	kRegAud5OutputLastAddr, kRegAud6OutputLastAddr, kRegAud7OutputLastAddr, kRegAud8OutputLastAddr, 0 };
+static const uint32_t	gAudioSystemToInputLastReg[] = {
+	kRegAud1InputLastAddr, kRegAud2InputLastAddr, kRegAud3InputLastAddr, kRegAud4InputLastAddr,
+	kRegAud5InputLastAddr, kRegAud6InputLastAddr, kRegAud7InputLastAddr, kRegAud8InputLastAddr, 0 };
+
+#define NTV2_SIM_AUDIO_RATE		48000
+
+static int64_t audioSamples(int64_t time)
+{
+	return (time * NTV2_SIM_AUDIO_RATE) / 10000000;
+}
+
+static uint32_t audioAddress(Ntv2SimDevice* pDevice, uint32_t audioSystem, int64_t start)
+{
+	uint32_t control = pDevice->registers[gAudioSystemToControlReg[audioSystem]];
+	uint32_t numChannels = (control & BIT(20))? 16 : ((control & BIT(16))? 8 : 6);
+	uint32_t wrap = (((control & kK2RegMaskAudioBufferSize) >> kK2RegShiftAudioBufferSize) == NTV2_AUDIO_BUFFER_BIG)?
+						NTV2_AUDIO_WRAPADDRESS_BIG : NTV2_AUDIO_WRAPADDRESS;
+	int64_t samples = audioSamples(ntv2SimGetTime() - start);
+
+	return (uint32_t)((samples * numChannels * 4) % wrap);
+}
+
+static void audioControl(Ntv2SimDevice* pDevice, uint32_t audioSystem, uint32_t value)
+{
+	bool inRunning = ((value & BIT_0) != 0) && ((value & BIT_8) == 0);
+	bool outRunning = ((value & BIT_9) == 0) && ((value & BIT_11) == 0);
+	int64_t now = ntv2SimGetTime();
+
+	// capture and playback restart from the top of the buffer
+	if (inRunning != pDevice->audioInRunning[audioSystem])
+	{
+		if (!inRunning)
+			pDevice->registers[gAudioSystemToInputLastReg[audioSystem]] = audioAddress(pDevice, audioSystem, pDevice->audioInStart[audioSystem]);
+		pDevice->audioInStart[audioSystem] = now;
+		pDevice->audioInRunning[audioSystem] = inRunning;
+	}
+	if (outRunning != pDevice->audioOutRunning[audioSystem])
+	{
+		if (!outRunning)
+			pDevice->registers[gAudioSystemToOutputLastReg[audioSystem]] = audioAddress(pDevice, audioSystem, pDevice->audioOutStart[audioSystem]);
+		pDevice->audioOutStart[audioSystem] = now;
+		pDevice->audioOutRunning[audioSystem] = outRunning;
+	}
+}
+
+static void rasterUpdate(Ntv2SimDevice* pDevice, uint32_t regNum, uint32_t regValue)
+{
+	uint32_t i;
+
+	// mirrors the frame store update hook in linux/registerio.c
+	if ((regNum == kRegGlobalControl) || (regNum == kRegGlobalControl2) || (regNum == kRegGlobalControl3))
+	{
+		ntv2_videoraster_update_global(pDevice->pRaster, regNum, regValue);
+		return;
+	}
+	for (i = 0; i < NTV2_MAX_NUM_CHANNELS; i++)
+	{
+		if ((regNum == gChannelToControlRegNum[i]) || ((i > 0) && (regNum == gChannelToGlobalControlRegNum[i])))
+			ntv2_videoraster_update_channel(pDevice->pRaster, i);
+		else if (regNum == gChannelToOutputFrameReg[i])
+			ntv2_videoraster_update_frame(pDevice->pRaster, i, false, regValue);
+		else if (regNum == gChannelToInputFrameReg[i])
+			ntv2_videoraster_update_frame(pDevice->pRaster, i, true, regValue);
+		else
+			continue;
+		break;
+	}
+}
+
+bool ntv2SimDeviceOpen(Ntv2SimDevice* pDevice, NTV2DeviceID deviceID, NTV2FrameRate frameRate)
+{
+	uint32_t global = 0;
+	uint32_t i;
+
+	if (pDevice == NULL) return false;
+
+	memset(pDevice, 0, sizeof(Ntv2SimDevice));
+	pDevice->systemContext.pDevice = pDevice;
+	pDevice->deviceID = deviceID;
+	pDevice->randomState = 0x9e3779b97f4a7c15ULL;
+
+	// single format 1080p on all channels, channel 1 drives the timing
+	global |= (NTV2_STANDARD_1080p << kRegShiftStandard) & kRegMaskStandard;
+	global |= (NTV2_FG_1920x1080 << kRegShiftGeometry) & kRegMaskGeometry;
+	global |= (frameRate << kRegShiftFrameRate) & kRegMaskFrameRate;
+	global |= ((frameRate >> 3) << kRegShiftFrameRateHiBit) & kRegMaskFrameRateHiBit;
+
+	pDevice->registers[kRegBoardID] = deviceID;
+	for (i = 0; i < NTV2_MAX_NUM_CHANNELS; i++)
+		pDevice->registers[gChannelToGlobalControlRegNum[i]] = global;
+	for (i = 0; i < NTV2_SIM_NUM_AUDIO_SYSTEMS; i++)
+		pDevice->registers[gAudioSystemToControlReg[i]] = BIT_8 | BIT_9 | BIT(16);		// 8 channels, capture and playback reset
+
+	pDevice->registers[kVRegEveryFrameTaskFilter] = NTV2_OEM_TASKS;
+	pDevice->registers[kVRegAudioSyncTolerance] = 10000;
+
+	pDevice->dmaMBytesPerSec = 3000;
+	pDevice->dmaOverhead = 200;
+
+	return ntv2SimDeviceFramePeriod(pDevice) > 0;
+}
+
+void ntv2SimDeviceClose(Ntv2SimDevice* pDevice)
+{
+	if (pDevice == NULL) return;
+
+	if (pDevice->pRaster != NULL)
+	{
+		ntv2_videoraster_disable(pDevice->pRaster);
+		ntv2_videoraster_close(pDevice->pRaster);
+		pDevice->pRaster = NULL;
+	}
+}
+
+bool ntv2SimDeviceEnableRaster(Ntv2SimDevice* pDevice)
+{
+	if (pDevice == NULL) return false;
+
+	// same widget layout as the linux driver
+	pDevice->pRaster = ntv2_videoraster_open(&pDevice->systemContext, "ntv2videoraster", 0);
+	if (pDevice->pRaster == NULL) return false;
+
+	if (ntv2_videoraster_configure(pDevice->pRaster, 0x3400, 64, 4) != NTV2_STATUS_SUCCESS)
+	{
+		ntv2_videoraster_close(pDevice->pRaster);
+		pDevice->pRaster = NULL;
+		return false;
+	}
+
+	return ntv2_videoraster_enable(pDevice->pRaster) == NTV2_STATUS_SUCCESS;
+}
+
+void ntv2SimDeviceVerticalInterrupt(Ntv2SimDevice* pDevice)
+{
+	uint32_t i;
+
+	if (pDevice == NULL) return;
+
+	// frame register writes take effect at the frame boundary
+	for (i = 0; i < NTV2_MAX_NUM_CHANNELS; i++)
+	{
+		pDevice->latchedFrame[0][i] = pDevice->registers[gChannelToOutputFrameReg[i]];
+		pDevice->latchedFrame[1][i] = pDevice->registers[gChannelToInputFrameReg[i]];
+	}
+}
+
+uint32_t ntv2SimDeviceLatchedFrame(Ntv2SimDevice* pDevice, NTV2Channel channel, bool input)
+{
+	if ((pDevice == NULL) || !NTV2_IS_VALID_CHANNEL(channel)) return 0;
+
+	return pDevice->latchedFrame[input? 1 : 0][channel];
+}
+
+int64_t ntv2SimDeviceFramePeriod(Ntv2SimDevice* pDevice)
+{
+	int64_t period;
+	bool count;
+
+	if (pDevice == NULL) return 0;
+
+	count = pDevice->countAccess;
+	pDevice->countAccess = false;
+	period = GetFramePeriod(&pDevice->systemContext, NTV2_CHANNEL1);
+	pDevice->countAccess = count;
+
+	return period;
+}
+
+int64_t ntv2SimDeviceDmaTime(Ntv2SimDevice* pDevice, uint32_t numBytes)
+{
+	if ((pDevice == NULL) || (pDevice->dmaMBytesPerSec == 0)) return 0;
+
+	// MB/s is bytes/us so bytes*10/MBps is 100 ns units
+	return pDevice->dmaOverhead + ((int64_t)numBytes * 10) / pDevice->dmaMBytesPerSec;
+}
+
+uint32_t ntv2SimDeviceRandom(Ntv2SimDevice* pDevice)
+{
+	uint64_t x = pDevice->randomState;
+
+	// xorshift64* (the state must never be zero)
+	if (x == 0)
+		x = 0x9e3779b97f4a7c15ULL;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	pDevice->randomState = x;
+	return (uint32_t)((x * 0x2545f4914f6cdd1dULL) >> 32);
+}
+
+uint32_t ntv2SimDeviceReadRegister(Ntv2SimDevice* pDevice, uint32_t regNum)
+{
+	uint32_t i;
+
+	if ((pDevice == NULL) || (regNum >= NTV2_SIM_NUM_REGISTERS)) return 0;
+
+	if (pDevice->countAccess)
+		pDevice->registerReads++;
+
+	for (i = 0; i < NTV2_SIM_NUM_AUDIO_SYSTEMS; i++)
+	{
+		if ((regNum == gAudioSystemToOutputLastReg[i]) && pDevice->audioOutRunning[i])
+			return audioAddress(pDevice, i, pDevice->audioOutStart[i]);
+		if ((regNum == gAudioSystemToInputLastReg[i]) && pDevice->audioInRunning[i])
+			return audioAddress(pDevice, i, pDevice->audioInStart[i]);
+	}
+
+	return pDevice->registers[regNum];
+}
+
+bool ntv2SimDeviceWriteRegister(Ntv2SimDevice* pDevice, uint32_t regNum, uint32_t regValue)
+{
+	uint32_t i;
+
+	if ((pDevice == NULL) || (regNum >= NTV2_SIM_NUM_REGISTERS)) return false;
+
+	if (pDevice->countAccess)
+		pDevice->registerWrites++;
+
+	pDevice->registers[regNum] = regValue;
+
+	for (i = 0; i < NTV2_SIM_NUM_AUDIO_SYSTEMS; i++)
+	{
+		if (regNum == gAudioSystemToControlReg[i])
+		{
+			audioControl(pDevice, i, regValue);
+			break;
+		}
+	}
+
+	if (pDevice->pRaster != NULL)
+		rasterUpdate(pDevice, regNum, regValue);
+
+	return true;
+}
+
+//	Auto* functions required by ntv2autocirc.c -- the context is the simulated device
+
+Ntv2Status AutoDmaTransfer(void* pContext, PAUTO_DMA_PARAMS pDmaParams)
+{
+	Ntv2SimDevice* pDevice = (Ntv2SimDevice*)pContext;
+	uint32_t numBytes;
+
+	if ((pDevice == NULL) || (pDmaParams == NULL))
+		return NTV2_STATUS_BAD_PARAMETER;
+
+	pDevice->dmaTransfers++;
+	if ((pDevice->dmaErrorRate != 0) && ((ntv2SimDeviceRandom(pDevice) % pDevice->dmaErrorRate) == 0))
+	{
+		pDevice->dmaErrors++;
+		return NTV2_STATUS_IO_ERROR;
+	}
+
+	// the data is not moved, only accounted for
+	numBytes = pDmaParams->vidNumBytes + pDmaParams->audNumBytes + pDmaParams->ancF1NumBytes + pDmaParams->ancF2NumBytes;
+	pDevice->dmaBytes += numBytes;
+	pDevice->dmaTime += ntv2SimDeviceDmaTime(pDevice, numBytes);
+
+	return NTV2_STATUS_SUCCESS;
+}
+
+int64_t AutoGetAudioClock(void* pContext)
+{
+	// 48 kHz sample counter scaled to 100 ns units like the real drivers
+	return (audioSamples(ntv2SimGetTime()) * 10000) / 48;
+}
+
+bool AutoBoardCanDoP2P(void* pContext)
+{
+	return false;
+}
+
+uint64_t AutoGetFrameAperturePhysicalAddress(void* pContext)
+{
+	return 0;
+}
+
+uint32_t AutoGetFrameApertureBaseSize(void* pContext)
+{
+	return 0;
+}
+
+void AutoWriteFrameApertureOffset(void* pContext, uint32_t value)
+{
+	return;
+}
+
+uint64_t AutoGetMessageAddress(void* pContext, NTV2Channel channel)
+{
+	return 0;
+}
+
+//	stream operations -- these follow the linux xilinx dma stream operations without the page and descriptor handling
+
+static int simStreamInitialize(struct ntv2_stream *stream)
+{
+	stream->stream_state = ntv2_stream_state_initialized;
+	stream->engine_state = ntv2_stream_state_initialized;
+	return NTV2_STREAM_OPS_SUCCESS;
+}
+
+static int simStreamRelease(struct ntv2_stream *stream)
+{
+	stream->stream_state = ntv2_stream_state_released;
+	stream->engine_state = ntv2_stream_state_released;
+	return NTV2_STREAM_OPS_SUCCESS;
+}
+
+static int simStreamStart(struct ntv2_stream *stream)
+{
+	if (stream->engine_state == ntv2_stream_state_error)
+		return NTV2_STREAM_OPS_FAIL;
+
+	stream->stream_state = ntv2_stream_state_active;
+	return NTV2_STREAM_OPS_SUCCESS;
+}
+
+static int simStreamStop(struct ntv2_stream *stream)
+{
+	if (stream->engine_state == ntv2_stream_state_error)
+		return NTV2_STREAM_OPS_FAIL;
+
+	stream->stream_state = ntv2_stream_state_idle;
+	return NTV2_STREAM_OPS_SUCCESS;
+}
+
+static int simStreamAdvance(struct ntv2_stream *stream)
+{
+	if (stream->stream_state == ntv2_stream_state_error)
+		return NTV2_STREAM_OPS_FAIL;
+
+	if ((stream->stream_state != ntv2_stream_state_idle) &&
+		(stream->stream_state != ntv2_stream_state_active))
+		return NTV2_STREAM_OPS_FAIL;
+
+	stream->engine_state = stream->stream_state;
+	return NTV2_STREAM_OPS_SUCCESS;
+}
+
+static int simBufferQueue(struct ntv2_stream *stream, int index)
+{
+	struct ntv2_stream_buffer* buffer = &stream->stream_buffers[index];
+
+	if (buffer->queued)
+		return NTV2_STREAM_OPS_SUCCESS;
+
+	buffer->queued = false;
+	buffer->linked = false;
+	buffer->completed = false;
+	buffer->flushed = false;
+	buffer->released = false;
+	buffer->error = false;
+	buffer->dma_buffer = NULL;
+	buffer->ds_index = 0;
+	buffer->ds_count = 0;
+
+	if ((stream->owner == NULL) ||
+		(buffer->user_buffer.mBuffer.fUserSpacePtr == 0) ||
+		(buffer->user_buffer.mBuffer.fByteCount == 0))
+		return NTV2_STREAM_OPS_FAIL;
+
+	buffer->queued = true;
+	buffer->dma_buffer = (void*)(uintptr_t)buffer->user_buffer.mBuffer.fUserSpacePtr;
+	return NTV2_STREAM_OPS_SUCCESS;
+}
+
+static int simBufferLink(struct ntv2_stream *stream, int from_index, int to_index)
+{
+	struct ntv2_stream_buffer* buffer_from = &stream->stream_buffers[from_index];
+	struct ntv2_stream_buffer* buffer_to = &stream->stream_buffers[to_index];
+
+	if (stream->engine_state == ntv2_stream_state_error)
+		return NTV2_STREAM_OPS_FAIL;
+
+	if (!buffer_from->queued || buffer_from->flushed || buffer_from->completed ||
+		buffer_from->released || (buffer_from->dma_buffer == NULL))
+		return NTV2_STREAM_OPS_FAIL;
+	buffer_from->linked = true;
+
+	if (!buffer_to->queued || buffer_to->flushed || buffer_to->completed ||
+		buffer_to->released || (buffer_to->dma_buffer == NULL))
+		return NTV2_STREAM_OPS_FAIL;
+	buffer_to->linked = true;
+
+	return NTV2_STREAM_OPS_SUCCESS;
+}
+
+static int simBufferComplete(struct ntv2_stream *stream, int index)
+{
+	struct ntv2_stream_buffer* buffer = &stream->stream_buffers[index];
+
+	if (!buffer->queued || !buffer->linked || buffer->flushed || buffer->released)
+		return NTV2_STREAM_OPS_FAIL;
+
+	buffer->completed = true;
+	return NTV2_STREAM_OPS_SUCCESS;
+}
+
+static int simBufferFlush(struct ntv2_stream *stream, int index)
+{
+	struct ntv2_stream_buffer* buffer = &stream->stream_buffers[index];
+
+	if (buffer->flushed)
+		return NTV2_STREAM_OPS_SUCCESS;
+
+	if (!buffer->queued || buffer->completed || buffer->released)
+		return NTV2_STREAM_OPS_FAIL;
+
+	// do not flush linked buffers while the engine is running
+	if (((stream->engine_state == ntv2_stream_state_active) ||
+		 (stream->engine_state == ntv2_stream_state_idle)) && buffer->linked)
+		return NTV2_STREAM_OPS_FAIL;
+
+	buffer->flushed = true;
+	return NTV2_STREAM_OPS_SUCCESS;
+}
+
+static int simBufferRelease(struct ntv2_stream *stream, int index)
+{
+	struct ntv2_stream_buffer* buffer = &stream->stream_buffers[index];
+
+	if (buffer->released)
+		return NTV2_STREAM_OPS_SUCCESS;
+
+	// do not release a linked buffer that is not complete while the engine is running
+	if (((stream->engine_state == ntv2_stream_state_active) ||
+		 (stream->engine_state == ntv2_stream_state_idle)) &&
+		buffer->linked && !buffer->completed)
+		return NTV2_STREAM_OPS_FAIL;
+
+	buffer->dma_buffer = NULL;
+	buffer->queued = false;
+	buffer->linked = false;
+	buffer->completed = false;
+	buffer->flushed = false;
+	buffer->released = true;
+	buffer->error = false;
+	return NTV2_STREAM_OPS_SUCCESS;
+}
+
+void ntv2SimDeviceStreamOps(struct ntv2_stream_ops* pOps)
+{
+	if (pOps == NULL) return;
+
+	pOps->stream_initialize = simStreamInitialize;
+	pOps->stream_start = simStreamStart;
+	pOps->stream_stop = simStreamStop;
+	pOps->stream_release = simStreamRelease;
+	pOps->stream_advance = simStreamAdvance;
+	pOps->buffer_queue = simBufferQueue;
+	pOps->buffer_link = simBufferLink;
+	pOps->buffer_complete = simBufferComplete;
+	pOps->buffer_flush = simBufferFlush;
+	pOps->buffer_release = simBufferRelease;
+}
@@ -0,0 +1,94 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (C) 2024 AJA Video Systems, Inc.
+ */
+//==========================================================================
+//
+//  ntv2simdevice.h
+//
+//  Simulated NTV2 device for running the common driver modules in user space.
+//  It owns the register file, the simulated clock, the audio engines and the
+//  DMA engine model, and it implements the Auto* functions that
+//  ntv2autocirc.c expects every real or fake device to provide.
+//
+//==========================================================================
+
+#ifndef NTV2SIMDEVICE_H
+#define NTV2SIMDEVICE_H
+
+#include "ntv2system.h"
+#include "ntv2publicinterface.h"
+#include "ntv2stream.h"
+#include "ntv2videoraster.h"
+
+#define NTV2_SIM_NUM_REGISTERS		0x4000		// hardware and virtual registers (VIRTUALREG_START is 10000)
+#define NTV2_SIM_NUM_AUDIO_SYSTEMS	8
+
+typedef struct ntv2_sim_device
+{
+	Ntv2SystemContext			systemContext;
+	NTV2DeviceID				deviceID;
+	uint32_t					registers[NTV2_SIM_NUM_REGISTERS];
+
+	// frame register values latched by the last vertical interrupt
+	uint32_t					latchedFrame[2][NTV2_MAX_NUM_CHANNELS];		// [input][channel]
+
+	// audio engines free-run from the simulated clock
+	bool						audioInRunning[NTV2_SIM_NUM_AUDIO_SYSTEMS];
+	bool						audioOutRunning[NTV2_SIM_NUM_AUDIO_SYSTEMS];
+	int64_t						audioInStart[NTV2_SIM_NUM_AUDIO_SYSTEMS];
+	int64_t						audioOutStart[NTV2_SIM_NUM_AUDIO_SYSTEMS];
+
+	// frame raster monitor (optional)
+	struct ntv2_videoraster*	pRaster;
+
+	// register access accounting
+	bool						countAccess;
+	uint64_t					registerReads;
+	uint64_t					registerWrites;
+
+	// dma engine model
+	uint32_t					dmaMBytesPerSec;	// sustained bandwidth
+	uint32_t					dmaOverhead;		// per transfer setup time (100 ns units)
+	uint32_t					dmaErrorRate;		// fail one transfer in this many (0 = never)
+	uint64_t					dmaTransfers;
+	uint64_t					dmaBytes;
+	uint64_t					dmaErrors;
+	int64_t						dmaTime;			// total simulated transfer time (100 ns units)
+
+	uint64_t					randomState;
+} Ntv2SimDevice;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// device functions
+bool		ntv2SimDeviceOpen(Ntv2SimDevice* pDevice, NTV2DeviceID deviceID, NTV2FrameRate frameRate);
+void		ntv2SimDeviceClose(Ntv2SimDevice* pDevice);
+bool		ntv2SimDeviceEnableRaster(Ntv2SimDevice* pDevice);
+void		ntv2SimDeviceVerticalInterrupt(Ntv2SimDevice* pDevice);
+uint32_t	ntv2SimDeviceLatchedFrame(Ntv2SimDevice* pDevice, NTV2Channel channel, bool input);
+int64_t		ntv2SimDeviceFramePeriod(Ntv2SimDevice* pDevice);
+int64_t		ntv2SimDeviceDmaTime(Ntv2SimDevice* pDevice, uint32_t numBytes);
+uint32_t	ntv2SimDeviceRandom(Ntv2SimDevice* pDevice);
+void		ntv2SimDeviceStreamOps(struct ntv2_stream_ops* pOps);
+
+// register access from the simulated hardware
+uint32_t	ntv2SimDeviceReadRegister(Ntv2SimDevice* pDevice, uint32_t regNum);
+bool		ntv2SimDeviceWriteRegister(Ntv2SimDevice* pDevice, uint32_t regNum, uint32_t regValue);
+
+// simulated clock (100 ns units)
+void		ntv2SimSetTime(int64_t time);
+int64_t		ntv2SimGetTime(void);
+
+// driver message accounting
+void		ntv2SimSetVerbose(bool verbose);
+uint64_t	ntv2SimMessageCount(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
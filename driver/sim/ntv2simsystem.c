@@ -0,0 +1,470 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (C) 2024 AJA Video Systems, Inc.
+ */
+//==========================================================================
+//
+//  ntv2simsystem.c
+//
+//  ntv2system.h implementation for the driver simulator. The simulator runs
+//  the driver modules in a single thread against a simulated clock, so locks
+//  are no-ops, events and semaphores never block, and time only advances
+//  when the simulator says so.
+//
+//==========================================================================
+
+#include <stdarg.h>
+#include "ntv2system.h"
+#include "ntv2simdevice.h"
+
+static int64_t	sSimTime = 0;
+static bool		sVerbose = false;
+static uint64_t	sMessageCount = 0;
+
+void ntv2SimSetTime(int64_t time)
+{
+	sSimTime = time;
+}
+
+int64_t ntv2SimGetTime(void)
+{
+	return sSimTime;
+}
+
+void ntv2SimSetVerbose(bool verbose)
+{
+	sVerbose = verbose;
+}
+
+uint64_t ntv2SimMessageCount(void)
+{
+	return sMessageCount;
+}
+
+// sim message abstraction
+
+void ntv2SimMessage(const char* format, ...)
+{
+	va_list args;
+
+	sMessageCount++;
+	if (!sVerbose) return;
+
+	printf("%12.6f  ", (double)sSimTime / 10000000.0);
+	va_start(args, format);
+	vprintf(format, args);
+	va_end(args);
+	fflush(stdout);
+}
+
+// sim register functions
+
+uint32_t ntv2ReadRegister(Ntv2SystemContext* context, uint32_t regNum)
+{
+	if (context == NULL) return 0;
+
+	return ntv2SimDeviceReadRegister((Ntv2SimDevice*)context->pDevice, regNum);
+}
+
+bool ntv2ReadRegisterMS(Ntv2SystemContext* context, uint32_t regNum, uint32_t* regValue, uint32_t regMask, uint32_t regShift)
+{
+	if ((context == NULL) || (regValue == NULL)) return false;
+
+	*regValue = (ntv2SimDeviceReadRegister((Ntv2SimDevice*)context->pDevice, regNum) & regMask) >> regShift;
+	return true;
+}
+
+bool ntv2WriteRegister(Ntv2SystemContext* context, uint32_t regNum, uint32_t data)
+{
+	if (context == NULL) return false;
+
+	return ntv2SimDeviceWriteRegister((Ntv2SimDevice*)context->pDevice, regNum, data);
+}
+
+bool ntv2WriteRegisterMS(Ntv2SystemContext* context, uint32_t regNum, uint32_t data, uint32_t regMask, uint32_t regShift)
+{
+	uint32_t regValue;
+
+	if (context == NULL) return false;
+
+	if (regMask == 0xffffffff)
+		return ntv2SimDeviceWriteRegister((Ntv2SimDevice*)context->pDevice, regNum, data);
+
+	regValue = ntv2SimDeviceReadRegister((Ntv2SimDevice*)context->pDevice, regNum);
+	regValue = (regValue & ~regMask) | ((data << regShift) & regMask);
+	return ntv2SimDeviceWriteRegister((Ntv2SimDevice*)context->pDevice, regNum, regValue);
+}
+
+uint32_t ntv2ReadVirtualRegister(Ntv2SystemContext* context, uint32_t regNum)
+{
+	return ntv2ReadRegister(context, regNum);
+}
+
+bool ntv2WriteVirtualRegister(Ntv2SystemContext* context, uint32_t regNum, uint32_t data)
+{
+	return ntv2WriteRegister(context, regNum, data);
+}
+
+// register context functions used by ntv2commonreg.c
+
+uint32_t ntv2ReadRegCon32(Ntv2SystemContext* context, uint32_t regNum)
+{
+	return ntv2ReadRegister(context, regNum);
+}
+
+void ntv2WriteRegCon32(Ntv2SystemContext* context, uint32_t regNum, uint32_t regValue)
+{
+	ntv2WriteRegister(context, regNum, regValue);
+}
+
+bool ntv2WriteRegMSCon32(Ntv2SystemContext* context, uint32_t regNum, uint32_t regValue, RegisterMask mask, RegisterShift shift)
+{
+	return ntv2WriteRegisterMS(context, regNum, regValue, mask, shift);
+}
+
+// sim spinlock functions
+
+bool ntv2SpinLockOpen(Ntv2SpinLock* pSpinLock, Ntv2SystemContext* pSysCon)
+{
+	if ((pSpinLock == NULL) ||
+		(pSysCon == NULL)) return false;
+
+	pSpinLock->dummy = 0;
+	return true;
+}
+
+void ntv2SpinLockClose(Ntv2SpinLock* pSpinLock)
+{
+	if (pSpinLock == NULL) return;
+}
+
+void ntv2SpinLockAcquire(Ntv2SpinLock* pSpinLock)
+{
+	if (pSpinLock == NULL) return;
+}
+
+void ntv2SpinLockRelease(Ntv2SpinLock* pSpinLock)
+{
+	if (pSpinLock == NULL) return;
+}
+
+// sim interrupt lock functions
+
+bool ntv2InterruptLockOpen(Ntv2InterruptLock* pInterruptLock, Ntv2SystemContext* pSysCon)
+{
+	if ((pInterruptLock == NULL) ||
+		(pSysCon == NULL)) return false;
+
+	pInterruptLock->dummy = 0;
+	return true;
+}
+
+void ntv2InterruptLockClose(Ntv2InterruptLock* pInterruptLock)
+{
+	if (pInterruptLock == NULL) return;
+}
+
+void ntv2InterruptLockAcquire(Ntv2InterruptLock* pInterruptLock)
+{
+	if (pInterruptLock == NULL) return;
+}
+
+void ntv2InterruptLockRelease(Ntv2InterruptLock* pInterruptLock)
+{
+	if (pInterruptLock == NULL) return;
+}
+
+// sim memory functions
+
+void* ntv2MemoryAlloc(uint32_t size)
+{
+	if (size == 0) return NULL;
+
+	return malloc(size);
+}
+
+void ntv2MemoryFree(void* pAddress, uint32_t size)
+{
+	if (pAddress == NULL) return;
+
+	free(pAddress);
+}
+
+bool ntv2DmaMemoryAlloc(Ntv2DmaMemory* pDmaMemory, Ntv2SystemContext* pSysCon, uint32_t size)
+{
+	if ((pDmaMemory == NULL) ||
+		(pSysCon == NULL) ||
+		(size == 0)) return false;
+
+	pDmaMemory->pAddress = calloc(1, size);
+	if (pDmaMemory->pAddress == NULL) return false;
+
+	pDmaMemory->dmaAddress = pDmaMemory->pAddress;
+	pDmaMemory->size = size;
+	return true;
+}
+
+void ntv2DmaMemoryFree(Ntv2DmaMemory* pDmaMemory)
+{
+	if ((pDmaMemory == NULL) ||
+		(pDmaMemory->pAddress == NULL)) return;
+
+	free(pDmaMemory->pAddress);
+	memset(pDmaMemory, 0, sizeof(Ntv2DmaMemory));
+}
+
+void* ntv2DmaMemoryVirtual(Ntv2DmaMemory* pDmaMemory)
+{
+	if (pDmaMemory == NULL) return NULL;
+
+	return pDmaMemory->pAddress;
+}
+
+Ntv2DmaAddress ntv2DmaMemoryPhysical(Ntv2DmaMemory* pDmaMemory)
+{
+	if (pDmaMemory == NULL) return 0;
+
+	return pDmaMemory->dmaAddress;
+}
+
+uint32_t ntv2DmaMemorySize(Ntv2DmaMemory* pDmaMemory)
+{
+	if (pDmaMemory == NULL) return 0;
+
+	return pDmaMemory->size;
+}
+
+// sim user buffer functions
+
+bool ntv2UserBufferPrepare(Ntv2UserBuffer* pUserBuffer, Ntv2SystemContext* pSysCon,
+						   uint64_t address, uint32_t size, bool write)
+{
+	if ((pUserBuffer == NULL) ||
+		(pSysCon == NULL) ||
+		(address == 0) ||
+		(size == 0)) return false;
+
+	pUserBuffer->pAddress = (void*)(uintptr_t)address;
+	pUserBuffer->size = size;
+	pUserBuffer->write = write;
+	return true;
+}
+
+void ntv2UserBufferRelease(Ntv2UserBuffer* pUserBuffer)
+{
+	if (pUserBuffer == NULL) return;
+
+	memset(pUserBuffer, 0, sizeof(Ntv2UserBuffer));
+}
+
+bool ntv2UserBufferCopyTo(Ntv2UserBuffer* pDstBuffer, uint32_t dstOffset, void* pSrcAddress, uint32_t size)
+{
+	if ((pDstBuffer == NULL) ||
+		(pSrcAddress == NULL) ||
+		(pDstBuffer->pAddress == NULL) ||
+		!pDstBuffer->write ||
+		((dstOffset + size) > pDstBuffer->size)) return false;
+
+	memcpy((uint8_t*)pDstBuffer->pAddress + dstOffset, pSrcAddress, size);
+	return true;
+}
+
+bool ntv2UserBufferCopyFrom(Ntv2UserBuffer* pSrcBuffer, uint32_t srcOffset, void* pDstAddress, uint32_t size)
+{
+	if ((pSrcBuffer == NULL) ||
+		(pDstAddress == NULL) ||
+		(pSrcBuffer->pAddress == NULL) ||
+		((srcOffset + size) > pSrcBuffer->size)) return false;
+
+	memcpy(pDstAddress, (uint8_t*)pSrcBuffer->pAddress + srcOffset, size);
+	return true;
+}
+
+// sim dpc task functions (the simulator has no deferred work)
+
+bool ntv2DpcOpen(Ntv2Dpc* pDpc, Ntv2SystemContext* pSysCon, Ntv2DpcTask* pDpcTask, Ntv2DpcData dpcData)
+{
+	if ((pDpc == NULL) ||
+		(pSysCon == NULL) ||
+		(pDpcTask == NULL)) return false;
+
+	return false;
+}
+
+void ntv2DpcClose(Ntv2Dpc* pDpc)
+{
+	if (pDpc == NULL) return;
+}
+
+void ntv2DpcSchedule(Ntv2Dpc* pDpc)
+{
+	if (pDpc == NULL) return;
+}
+
+// sim event functions (waits never block, they report the signal state)
+
+bool ntv2EventOpen(Ntv2Event* pEvent, Ntv2SystemContext* pSysCon)
+{
+	if ((pEvent == NULL) ||
+		(pSysCon == NULL)) return false;
+
+	pEvent->dummy = 0;
+	return true;
+}
+
+void ntv2EventClose(Ntv2Event* pEvent)
+{
+	if (pEvent == NULL) return;
+}
+
+void ntv2EventSignal(Ntv2Event* pEvent)
+{
+	if (pEvent == NULL) return;
+
+	pEvent->dummy = 1;
+}
+
+void ntv2EventClear(Ntv2Event* pEvent)
+{
+	if (pEvent == NULL) return;
+
+	pEvent->dummy = 0;
+}
+
+bool ntv2EventWaitForSignal(Ntv2Event* pEvent, int64_t timeout, bool alert)
+{
+	if (pEvent == NULL) return false;
+
+	return pEvent->dummy != 0;
+}
+
+// sim semaphore functions (a down that would block fails instead)
+
+bool ntv2SemaphoreOpen(Ntv2Semaphore* pSemaphore, Ntv2SystemContext* pSysCon, uint32_t count)
+{
+	if ((pSemaphore == NULL) ||
+		(pSysCon == NULL)) return false;
+
+	pSemaphore->dummy = count;
+	return true;
+}
+
+void ntv2SemaphoreClose(Ntv2Semaphore* pSemaphore)
+{
+	if (pSemaphore == NULL) return;
+}
+
+bool ntv2SemaphoreDown(Ntv2Semaphore* pSemaphore, int64_t timeout)
+{
+	if ((pSemaphore == NULL) ||
+		(pSemaphore->dummy == 0)) return false;
+
+	pSemaphore->dummy--;
+	return true;
+}
+
+void ntv2SemaphoreUp(Ntv2Semaphore* pSemaphore)
+{
+	if (pSemaphore == NULL) return;
+
+	pSemaphore->dummy++;
+}
+
+// sim time functions
+
+int64_t ntv2TimeCounter(void)
+{
+	return sSimTime;
+}
+
+int64_t ntv2TimeFrequency(void)
+{
+	return 10000000;
+}
+
+int64_t ntv2Time100ns(void)
+{
+	return sSimTime;
+}
+
+void ntv2TimeSleep(int64_t microseconds)
+{
+	// the simulator owns the clock
+}
+
+// sim thread functions (the simulator runs everything on one thread)
+
+bool ntv2ThreadOpen(Ntv2Thread* pThread, Ntv2SystemContext* pSysCon, const char* pName)
+{
+	if ((pThread == NULL) ||
+		(pSysCon == NULL)) return false;
+
+	memset(pThread, 0, sizeof(Ntv2Thread));
+	pThread->pName = pName;
+	return true;
+}
+
+void ntv2ThreadClose(Ntv2Thread* pThread)
+{
+	if (pThread == NULL) return;
+
+	ntv2ThreadStop(pThread);
+}
+
+int ntv2ThreadFunc(void* pData)
+{
+	return 0;
+}
+
+bool ntv2ThreadRun(Ntv2Thread* pThread, Ntv2ThreadTask* pTask, void* pContext)
+{
+	if ((pThread == NULL) ||
+		(pTask == NULL)) return false;
+
+	return false;
+}
+
+void ntv2ThreadStop(Ntv2Thread* pThread)
+{
+	if (pThread == NULL) return;
+
+	pThread->run = false;
+}
+
+void ntv2ThreadExit(Ntv2Thread* pThread)
+{
+	if (pThread == NULL) return;
+}
+
+const char* ntv2ThreadGetName(Ntv2Thread* pThread)
+{
+	if (pThread == NULL) return NULL;
+
+	return pThread->pName;
+}
+
+bool ntv2ThreadShouldStop(Ntv2Thread* pThread)
+{
+	if (pThread == NULL) return true;
+
+	return !pThread->run;
+}
+
+// sim pci configuration space (there is none)
+
+Ntv2Status ntv2ReadPciConfig(Ntv2SystemContext* pSysCon, void* pData, int32_t offset, int32_t size)
+{
+	if ((pSysCon == NULL) ||
+		(pData == NULL)) return NTV2_STATUS_BAD_PARAMETER;
+
+	memset(pData, 0, size);
+	return NTV2_STATUS_SUCCESS;
+}
+
+Ntv2Status ntv2WritePciConfig(Ntv2SystemContext* pSysCon, void* pData, int32_t offset, int32_t size)
+{
+	if ((pSysCon == NULL) ||
+		(pData == NULL)) return NTV2_STATUS_BAD_PARAMETER;
+
+	return NTV2_STATUS_SUCCESS;
+}